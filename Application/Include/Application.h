@@ -2,6 +2,7 @@
 #include "Device/Context.h"
 #include "Window/GLFW_Window.h"
 #include "ShaderCompiler/ShaderCompiler.h"
+#include "ShaderCompiler/ShaderReloader.h"
 #include "Utils/EditorCamera.h"
 #include "DeferredRenderer/ImGui/ImGuiLib.h"
 #include "Layer.h"
@@ -15,11 +16,18 @@ struct ApplicationCreateInfo
 	std::string EngineName;
 	std::filesystem::path AssetDirectory = "../Aqua/Assets/";
 
+	// pipeline cache kept across runs, relative to the working directory like the assets
+	// empty keeps it in memory only
+	std::filesystem::path PipelineCachePath = "PipelineCache.bin";
+
 	uint32_t WorkerCount = 8;
 
 	float FramesPerSeconds = 60.0f;
 
 	bool EnableValidationLayers = false;
+
+	// watches the shaders below the asset directory and swaps rebuilt pipelines in between frames
+	bool EnableShaderReload = false;
 };
 
 struct CameraMovementKeys
@@ -95,6 +103,9 @@ public:
 
 	std::filesystem::path GetAssetDirectory() const { return std::filesystem::absolute(mCreateInfo.AssetDirectory); }
 
+	// nullptr unless EnableShaderReload is set, hand it to WavefrontEstimatorCreateInfo::ShaderReloader
+	std::shared_ptr<vkLib::ShaderReloadService> GetShaderReloader() const { return mShaderReloader; }
+
 	virtual ~Application() = default;
 
 protected:
@@ -109,6 +120,8 @@ protected:
 	std::shared_ptr<vkLib::InstanceMenagerie> mInstanceMenagerie;
 	std::shared_ptr<vkLib::PhysicalDeviceMenagerie> mPhysicalDevices;
 
+	std::shared_ptr<vkLib::ShaderReloadService> mShaderReloader;
+
 	std::atomic_bool mRunning = false;
 
 	std::vector<Aqua::SharedRef<Layer>> mLayers;
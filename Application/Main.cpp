@@ -138,6 +138,13 @@ int main()
 	createInfo.WorkerCount = -1;
 
 	createInfo.EnableValidationLayers = true;
+	createInfo.EnableShaderReload = true;
+
+	// built by the ShaderPrecompiler, shaders missing from it are compiled at runtime
+	auto shaderArchive = vkLib::ShaderArchive::Open(createInfo.AssetDirectory / "Shaders.vkar",
+		createInfo.AssetDirectory / "Shaders");
+
+	vkLib::ShaderArchive::SetDefault(shaderArchive);
 
 	Aqua::SharedRef<Application> app = Aqua::MakeRef<Sandbox>(createInfo);
 
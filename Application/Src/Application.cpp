@@ -30,6 +30,13 @@ Application::Application(const ApplicationCreateInfo& info)
 	mSwapchain = mContext->GetSwapchain();
 
 	Aqua::ImGuiInit(*mContext, mWindow->GetNativeHandle());
+
+	if (info.EnableShaderReload)
+	{
+		// looks the includes up in the default include cache, the one the pipelines compile through
+		mShaderReloader = std::make_shared<vkLib::ShaderReloadService>();
+		mShaderReloader->Watch(GetAssetDirectory() / "Shaders");
+	}
 }
 
 void Application::Run()
@@ -52,6 +59,10 @@ void Application::Run()
 		std::this_thread::sleep_until(nextSlice);
 		nextSlice = clock.now() + timeSlice;
 
+		// between two frames, so no update records with a pipeline while it's being swapped
+		if (mShaderReloader)
+			mShaderReloader->ApplyPending();
+
 		InvokeUpdate(duration);
 		OnUIUpdate(duration);
 		mWindow->PollUserEvents();
@@ -148,6 +159,9 @@ void Application::SetupContext(const ApplicationCreateInfo& info)
 		deviceInfo.Extensions = { VK_EXT_TOOLING_INFO_EXTENSION_NAME };
 	}
 
+	if (!info.PipelineCachePath.empty())
+		deviceInfo.PipelineCachePath = std::filesystem::absolute(info.PipelineCachePath);
+
 	deviceInfo.MaxQueueCount = info.WorkerCount;
 	deviceInfo.PhysicalDevice = (*mPhysicalDevices)[0];
 	deviceInfo.RequiredFeatures = deviceInfo.PhysicalDevice.Features;
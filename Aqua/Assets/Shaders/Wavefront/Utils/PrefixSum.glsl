@@ -1,6 +1,6 @@
 #version 440
 
-layout(local_size_x = WORKGROUP_SIZE) in;
+layout(local_size_x_id = 0) in;
 
 layout(std430, set = 0, binding = 0) buffer Elements
 {
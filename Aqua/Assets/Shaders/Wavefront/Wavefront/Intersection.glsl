@@ -2,7 +2,7 @@
 
 // This stage can be further optimized by using RT hardware extensions!
 
-layout(local_size_x = WORKGROUP_SIZE) in;
+layout(local_size_x_id = 0) in;
 
 #define STACK_SIZE 64
 
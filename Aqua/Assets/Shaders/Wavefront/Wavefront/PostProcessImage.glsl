@@ -1,6 +1,6 @@
 #version 440
 
-layout(local_size_x = WORKGROUP_SIZE_X, local_size_y = WORKGROUP_SIZE_Y) in;
+layout(local_size_x_id = 0, local_size_y_id = 1) in;
 
 layout(set = 0, binding = 0, rgba8) uniform image2D uImageOutput;
 
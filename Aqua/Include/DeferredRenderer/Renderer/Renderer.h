@@ -129,6 +129,7 @@ private:
 	void SetupFeatureInfos();
 
 	void UpdateMaterialData();
+	void FlushMaterialParameters();
 
 	void SetupShaders();
 };
@@ -80,6 +80,8 @@ bool AQUA_NAMESPACE::EXEC_NAMESPACE::ComputeNode::Update()
 {
 	bool success = true;
 
+	vkLib::DescriptorBatch batch(Cmp->GetDescriptorWriter());
+
 	for (const auto& [location, rsc] : Resources)
 	{
 		success &= UpdateResource(*Cmp, *rsc);
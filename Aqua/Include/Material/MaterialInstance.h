@@ -17,6 +17,9 @@ struct MaterialInstanceInfo
 	vkLib::DescriptorLocation ParameterLocation;
 	uint32_t Stride = 0;
 	MAT_NAMESPACE::Platform RendererType;
+
+	// persistently mapped and not host coherent, writes are flushed once per frame before submission
+	vkLib::GenericBuffer ShaderParBuffer;
 };
 
 using MaterialInstanceInfoRef = SharedRef<MaterialInstanceInfo>;
@@ -63,6 +66,13 @@ public:
 	std::expected<bool, ShaderParError> SetShaderParameter(const std::string& name, const T& parVal) const;
 
 	AQUA_API void UpdateShaderParBuffer() const;
+
+	// once per frame before submission, hands the written parameter ranges to the device
+	void FlushShaderParameters() const
+	{
+		if (mInfo && mInfo->ShaderParBuffer)
+			mInfo->ShaderParBuffer.FlushMappedRanges();
+	}
 	AQUA_API void SetOffset(size_t offset) const;
 
 	uint32_t GetOffset() const { return mOffset; }
@@ -85,7 +95,6 @@ public:
 protected:
 	MaterialInstanceInfoRef mInfo;
 	MAT_NAMESPACE::Material mCoreMaterial;
-	mutable vkLib::GenericBuffer mShaderParBuffer; // this should probably be in the material instance info
 	mutable uint32_t mOffset = 0;
 	uint32_t mInstanceID = 0; // Not yet being used
 
@@ -153,12 +162,14 @@ std::expected<bool, AQUA_NAMESPACE::ShaderParError> AQUA_NAMESPACE::MaterialInst
 	if (mInfo->ShaderParameters[name].TypeSize != sizeof(parVal))
 		return std::unexpected(ShaderParError::eSizeMismatch);
 
-	T* memory = (T*)mShaderParBuffer.MapMemory<uint8_t>(mInfo->ShaderParameters[name].TypeSize,
-		mInfo->ShaderParameters[name].Offset + mOffset * mInfo->Stride);
+	const auto& parameter = mInfo->ShaderParameters[name];
+	size_t offset = parameter.Offset + mOffset * mInfo->Stride;
 
-	*memory = parVal;
+	// the parameter buffer stays mapped, a write is a memcpy plus a dirty range
+	std::span<uint8_t> memory = mInfo->ShaderParBuffer.GetMappedSpan<uint8_t>();
+	std::memcpy(memory.data() + offset, &parVal, sizeof(parVal));
 
-	mShaderParBuffer.UnmapMemory();
+	mInfo->ShaderParBuffer.MarkDirty(sizeof(parVal), offset);
 
 	return true;
 }
@@ -131,6 +131,7 @@ private:
 	void RecordMaterialPipeline(vk::CommandBuffer cmd, uint32_t pMaterialRef, uint32_t pBounceIdx, uint32_t pActiveBuffer);
 
 	void UpdateMaterialDescriptors();
+	void FlushMaterialParameters();
 
 	friend class WavefrontEstimator;
 };
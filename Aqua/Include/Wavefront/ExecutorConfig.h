@@ -77,6 +77,11 @@ struct ExecutionInfo
 	std::vector<vkLib::Core::Worker> Workers;
 	vkLib::CommandBufferAllocator CmdAlloc;
 
+	// hot reload, the replaced pipelines are kept until the workers went idle
+	std::shared_ptr<vkLib::ShaderReloadService> ShaderReloader;
+	std::vector<uint64_t> ReloadTargets;
+	std::vector<vkLib::ComputePipeline> RetiredPipelines;
+
 	// Random stuff...
 	std::uniform_int_distribution<uint32_t> UniformDistribution;
 
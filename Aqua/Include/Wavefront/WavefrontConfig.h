@@ -7,6 +7,8 @@
 
 #include "../Material/MaterialConfig.h"
 
+#include "ShaderCompiler/ShaderReloader.h"
+
 AQUA_BEGIN
 PH_BEGIN
 
@@ -75,6 +77,10 @@ struct WavefrontEstimatorCreateInfo
 	uint32_t MaterialEvalWorkgroupSize = 256;
 
 	float Tolerance = 0.001f;
+
+	// rebuilds the executors' pipelines when their shaders are saved, nullptr disables hot reload
+	// ApplyPending has to be called between two traces for the rebuilt pipelines to be swapped in
+	std::shared_ptr<vkLib::ShaderReloadService> ShaderReloader;
 };
 
 PH_END
@@ -19,6 +19,8 @@ class WavefrontEstimator
 public:
 	AQUA_API WavefrontEstimator(const WavefrontEstimatorCreateInfo& createInfo);
 
+	AQUA_API ~WavefrontEstimator();
+
 	WavefrontEstimator(const WavefrontEstimator&) = delete;
 	WavefrontEstimator& operator=(const WavefrontEstimator&) = delete;
 
@@ -30,6 +32,9 @@ public:
 
 	std::string GetShaderDirectory() { return mCreateInfo.ShaderDirectory; }
 
+	// compile errors of the last hot reload that failed, its live pipeline was kept
+	AQUA_API std::vector<std::string> GetShaderReloadErrors();
+
 private:
 	// Resources...
 	vkLib::PipelineBuilder mPipelineBuilder;
@@ -47,6 +52,11 @@ private:
 
 	MaterialBuilder mMaterialSystem;
 
+	// every reload target registered for the executors, their rebuilds call back into this object
+	std::vector<uint64_t> mReloadTargets;
+	std::vector<std::string> mReloadErrors;
+	std::mutex mReloadLock;
+
 private:
 	// Helpers...
 	ExecutionPipelines CreatePipelines();
@@ -58,13 +68,21 @@ private:
 	void AddText(std::string& text, const std::string& filepath);
 	void RetrieveFrontAndBackEndShaders();
 
-	vkLib::PShader GetRayGenerationShader();
-	vkLib::PShader GetIntersectionShader();
-	vkLib::PShader GetRaySortEpilogueShader(RaySortEvent sortEvent);
-	vkLib::PShader GetRayRefCounterShader();
-	vkLib::PShader GetPrefixSumShader();
-	vkLib::PShader GetLuminanceMeanShader();
-	vkLib::PShader GetPostProcessImageShader();
+	void RegisterReloadTargets(const std::shared_ptr<ExecutionInfo>& executionInfo);
+
+	template <typename Pipeline>
+	void RegisterReloadTarget(const std::shared_ptr<ExecutionInfo>& executionInfo, Pipeline ExecutionPipelines::* pipeline,
+		std::function<vkLib::PShader(std::vector<vkLib::CompileError>*)> getShader);
+
+	// the getters assert on a compile error unless errors is given, a hot reload collects them
+	// and keeps its live pipeline instead
+	vkLib::PShader GetRayGenerationShader(std::vector<vkLib::CompileError>* errors = nullptr);
+	vkLib::PShader GetIntersectionShader(std::vector<vkLib::CompileError>* errors = nullptr);
+	vkLib::PShader GetRaySortEpilogueShader(RaySortEvent sortEvent, std::vector<vkLib::CompileError>* errors = nullptr);
+	vkLib::PShader GetRayRefCounterShader(std::vector<vkLib::CompileError>* errors = nullptr);
+	vkLib::PShader GetPrefixSumShader(std::vector<vkLib::CompileError>* errors = nullptr);
+	vkLib::PShader GetLuminanceMeanShader(std::vector<vkLib::CompileError>* errors = nullptr);
+	vkLib::PShader GetPostProcessImageShader(std::vector<vkLib::CompileError>* errors = nullptr);
 };
 
 PH_END
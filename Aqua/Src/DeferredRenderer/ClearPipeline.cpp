@@ -6,7 +6,7 @@ AQUA_BEGIN
 static std::string sClearShaderCode =
 R"(#version 440 core
 
-layout(local_size_x = LOCAL_SIZE_X, local_size_y = LOCAL_SIZE_Y) in;
+layout(local_size_x_id = 0, local_size_y_id = 1) in;
 layout(set = 0, binding = 0, IMAGE_FORMAT) writeonly uniform image2D uImage;
 
 layout(push_constant) uniform ShaderConstants
@@ -32,11 +32,12 @@ AQUA_NAMESPACE::ClearPipeline::ClearPipeline(const std::string& format, const gl
 	shader.SetShader("eCompute", sClearShaderCode);
 
 	shader.AddMacro("IMAGE_FORMAT", format);
-	shader.AddMacro("LOCAL_SIZE_X", std::to_string(workGroupSize.x));
-	shader.AddMacro("LOCAL_SIZE_Y", std::to_string(workGroupSize.y));
 
 	auto errors = shader.CompileShaders();
 
+	// specialized at pipeline creation, every size of a format shares one module
+	shader.SetWorkGroupSize({ workGroupSize.x, workGroupSize.y, 1 });
+
 	this->SetShader(shader);
 }
 
@@ -530,6 +530,7 @@ void AQUA_NAMESPACE::RenderableManagerie::SetCtx(vkLib::Context ctx)
 
 	mConfig->mPipelineBuilder = ctx.MakePipelineBuilder();
 	mConfig->mResourcePool = ctx.CreateResourcePool();
+	mConfig->mResourcePool.SetMemoryTag("Renderables");
 	mConfig->mCmdAlloc = ctx.CreateCommandPools()[0];
 
 	for (size_t i = 0; i < ctx.GetQueueCount(0); i++)
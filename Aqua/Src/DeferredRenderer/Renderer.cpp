@@ -177,6 +177,7 @@ void AQUA_NAMESPACE::Renderer::SetCtx(vkLib::Context ctx)
 
 	mConfig->mPipelineBuilder = ctx.MakePipelineBuilder();
 	mConfig->mResourcePool = mConfig->mCtx.CreateResourcePool();
+	mConfig->mResourcePool.SetMemoryTag("DeferredRenderer");
 	mConfig->mRenderCtxFactory.SetContextBuilder(ctx.FetchRenderContextBuilder(vk::PipelineBindPoint::eGraphics));
 
 	mConfig->mFrontEnd.SetCtx(ctx);
@@ -487,7 +488,20 @@ void AQUA_NAMESPACE::Renderer::UpdateDescriptors()
 void AQUA_NAMESPACE::Renderer::IssueDrawCall()
 {
 	// need a way to sync with the upload renderables routine
+	FlushMaterialParameters();
 	EXEC_NAMESPACE::Execute(mConfig->mDrawList, mConfig->mDrawWorkers);
+
+	// buffers dropped during the frame are reused once its draws are done
+	if (auto recycler = mConfig->mCtx.GetBufferRecycler())
+	{
+		std::vector<vk::Fence> fences;
+		fences.reserve(mConfig->mDrawWorkers.size());
+
+		for (const auto& unit : mConfig->mDrawWorkers)
+			fences.push_back(unit.Worker.GetFence());
+
+		recycler->Retire(fences);
+	}
 }
 
 vk::Result AQUA_NAMESPACE::Renderer::WaitIdle(std::chrono::nanoseconds timeOut /*= std::chrono::nanoseconds::max()*/)
@@ -824,6 +838,19 @@ void AQUA_NAMESPACE::Renderer::UpdateMaterialData()
 	}
 }
 
+void AQUA_NAMESPACE::Renderer::FlushMaterialParameters()
+{
+	// parameters written since the last frame become visible to the draws about to be submitted
+	auto flush = [](const Core::MaterialInfo& material)
+	{
+		if (material.Info && material.Info->ShaderParBuffer)
+			material.Info->ShaderParBuffer.FlushMappedRanges();
+	};
+
+	std::ranges::for_each(mConfig->mRenderableManagerie.GetDeferredMaterials(), flush);
+	std::ranges::for_each(mConfig->mRenderableManagerie.GetForwardMaterials(), flush);
+}
+
 void AQUA_NAMESPACE::Renderer::SetupShaders()
 {
 	mConfig->mGBufferShader.SetFilepath("eVertex", (mConfig->mShaderDirectory / "Defer.vert").string());
@@ -9,8 +9,8 @@ std::string AQUA_NAMESPACE::EXEC_NAMESPACE::GLSLCodeGenerator::Generate() const
 
 	finalCode << "#version " << mExts.GLSLVersion << "\n";
 
-	// the work group size string
-	finalCode << "layout(local_size_x = LOCAL_SIZE_X, local_size_y = LOCAL_SIZE_Y, local_size_z = LOCAL_SIZE_Z) in;\n";
+	// the work group size string, specialization constants 0, 1 and 2 set by the ComputeDraft
+	finalCode << "layout(local_size_x_id = 0, local_size_y_id = 1, local_size_z_id = 2) in;\n";
 
 	// push/kernel constants definition
 	
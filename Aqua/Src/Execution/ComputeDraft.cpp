@@ -54,11 +54,6 @@ vkLib::PShader AQUA_NAMESPACE::EXEC_NAMESPACE::ComputeDraft::ConstructShader(con
 
 	shader.SetShader("eCompute", code);
 
-	// read from the kernel extraction...
-	shader.AddMacro("LOCAL_SIZE_X", std::to_string(extraction.WorkGroupSize.x));
-	shader.AddMacro("LOCAL_SIZE_Y", std::to_string(extraction.WorkGroupSize.y));
-	shader.AddMacro("LOCAL_SIZE_Z", std::to_string(extraction.WorkGroupSize.z));
-
 	for (const auto& [type, str] : sNumericTypesToStrings)
 	{
 		if (type == TypeName::eInvalid || type == TypeName::eVoid || type == TypeName::eBoolean)
@@ -72,6 +67,9 @@ vkLib::PShader AQUA_NAMESPACE::EXEC_NAMESPACE::ComputeDraft::ConstructShader(con
 	CompileErrorChecker checker("");
 	checker.AssertOnError(results);
 
+	// read from the kernel extraction, applied when the pipeline is built
+	shader.SetWorkGroupSize(extraction.WorkGroupSize);
+
 	return shader;
 }
 
@@ -42,7 +42,7 @@ std::expected<AQUA_NAMESPACE::MAT_NAMESPACE::Material, vkLib::CompileError>
 	AQUA_NAMESPACE::MAT_NAMESPACE::MaterialAssembler::ConstructRayTracingMaterial(
 	const std::string& code, const vkLib::PreprocessorDirectives& directives /*= {}*/)
 {
-	auto OptimizerFlag = vkLib::OptimizerFlag::eO3;
+	auto OptimizerFlag = vkLib::OptimizerFlag::eO3 | vkLib::OptimizerFlag::eStripDebug;
 
 #if _DEBUG
 	OptimizerFlag = vkLib::OptimizerFlag::eNone;
@@ -81,7 +81,7 @@ std::expected<AQUA_NAMESPACE::MAT_NAMESPACE::Material, vkLib::CompileError>
 	AQUA_NAMESPACE::MAT_NAMESPACE::MaterialAssembler::ConstructDeferGFXMaterial(
 	const std::string& code, vkLib::GraphicsPipelineConfig config, const vkLib::PreprocessorDirectives& directives /*= {}*/)
 {
-	auto OptimizerFlag = vkLib::OptimizerFlag::eO3;
+	auto OptimizerFlag = vkLib::OptimizerFlag::eO3 | vkLib::OptimizerFlag::eStripDebug;
 
 #if _DEBUG
 	OptimizerFlag = vkLib::OptimizerFlag::eNone;
@@ -126,7 +126,7 @@ std::expected<AQUA_NAMESPACE::MAT_NAMESPACE::Material, vkLib::CompileError> AQUA
 	MaterialAssembler::ConstructDeferCmpMaterial(const std::string& code, 
 		const vkLib::PreprocessorDirectives& directives /*= {}*/)
 {
-	auto OptimizerFlag = vkLib::OptimizerFlag::eO3;
+	auto OptimizerFlag = vkLib::OptimizerFlag::eO3 | vkLib::OptimizerFlag::eStripDebug;
 
 #if _DEBUG
 	OptimizerFlag = vkLib::OptimizerFlag::eNone;
@@ -110,10 +110,11 @@ void AQUA_NAMESPACE::MaterialBuilder::InitializeInstance(MaterialInstance& insta
 
 	instance.mInfo->ShaderParameters = set;
 
-	instance.mShaderParBuffer = mResourcePool.CreateGenericBuffer(
-		vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eHostCoherent);
+	// written through the mapping and flushed per frame, host coherent memory isn't required
+	instance.mInfo->ShaderParBuffer = mResourcePool.CreateGenericBuffer(
+		vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eHostVisible);
 
-	instance.mShaderParBuffer.Reserve(64);
+	instance.mInfo->ShaderParBuffer.Reserve(64);
 
 	instance.mInstanceID = 0; // Not yet being used by any rendering system
 
@@ -3,11 +3,11 @@
 
 void AQUA_NAMESPACE::MaterialInstance::UpdateShaderParBuffer() const
 {
-	if (mShaderParBuffer.GetSize() == 0)
+	if (mInfo->ShaderParBuffer.GetSize() == 0)
 		return;
 
 	vkLib::StorageBufferWriteInfo bufferInfo{};
-	bufferInfo.Buffer = mShaderParBuffer.GetNativeHandles().Handle;
+	bufferInfo.Buffer = mInfo->ShaderParBuffer.GetNativeHandles().Handle;
 	const vkLib::BasicPipeline& pipeline = *GetBasicPipeline();
 
 	if (!pipeline.GetShader().IsEmpty(mInfo->ParameterLocation.SetIndex, mInfo->ParameterLocation.Binding))
@@ -18,8 +18,8 @@ void AQUA_NAMESPACE::MaterialInstance::SetOffset(size_t offset) const
 {
 	mOffset = static_cast<uint32_t>(offset);
 
-	if((offset + 1) * mInfo->Stride >= mShaderParBuffer.GetSize())
-		mShaderParBuffer.Resize((mOffset + 1) * mInfo->Stride);
+	if((offset + 1) * mInfo->Stride >= mInfo->ShaderParBuffer.GetSize())
+		mInfo->ShaderParBuffer.Resize((mOffset + 1) * mInfo->Stride);
 
 	UpdateShaderParBuffer();
 }
@@ -80,6 +80,9 @@ void AQUA_NAMESPACE::MaterialInstance::UpdateMaterialInfos(const MAT_NAMESPACE::
 			pipeline.UpdateDescriptor(location, uniformBuffer);
 	};
 
+	// one driver call for the whole material instead of one per binding
+	vkLib::DescriptorBatch batch(pipeline.GetDescriptorWriter());
+
 	for (const auto& [location, resource] : materialInfo.Resources)
 	{
 		if (resource.Type == GetSampledImageDescType())
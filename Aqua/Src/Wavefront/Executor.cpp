@@ -7,6 +7,12 @@ AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::~Executor()
 {
 	for (auto cmdBuf : mCmdBufs)
 		mExecutorInfo->CmdAlloc.Free(cmdBuf);
+
+	if (mExecutorInfo && mExecutorInfo->ShaderReloader)
+	{
+		for (uint64_t id : mExecutorInfo->ReloadTargets)
+			mExecutorInfo->ShaderReloader->Unregister(id);
+	}
 }
 
 AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceResult AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::Trace()
@@ -341,6 +347,7 @@ AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceResult AQUA_NAMESPACE::PH_FLUX_NAMESPACE
 	{
 		Reset();
 		UpdateSceneInfo();
+		FlushMaterialParameters();
 		ExecuteGraphList(mRayGenExecList);
 		mExecutionBlock.mBounceIdx++;
 		return TraceResult::ePending;
@@ -508,6 +515,15 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::ExecuteGraphList(const EXEC_NA
 {
 	auto executor = mExecutorInfo->Workers;
 
+	// pipelines replaced by a hot reload, nothing recorded with them is in flight once the workers are idle
+	if (!mExecutorInfo->RetiredPipelines.empty())
+	{
+		for (auto& worker : mExecutorInfo->Workers)
+			worker.WaitIdle();
+
+		mExecutorInfo->RetiredPipelines.clear();
+	}
+
 	for (size_t i = 0; i < execList.size(); i++)
 	{
 		auto& op = *execList[i];
@@ -616,3 +632,12 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::UpdateMaterialDescriptors()
 	mExecutorInfo->PipelineResources.InactiveRayShader.UpdateDescriptors();
 }
 
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor::FlushMaterialParameters()
+{
+	// once per trace, before the first submission reading the parameters
+	for (const auto& instance : mExecutorInfo->MaterialResources)
+		instance.FlushShaderParameters();
+
+	mExecutorInfo->PipelineResources.InactiveRayShader.FlushShaderParameters();
+}
+
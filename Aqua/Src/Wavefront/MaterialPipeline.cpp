@@ -59,6 +59,8 @@ void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::MaterialPipeline::UpdateDescriptors()
 {
 	auto setLayoutBindingMap = GetShader().GetPipelineLayoutInfo().first;
 
+	vkLib::DescriptorBatch batch(this->GetDescriptorWriter());
+
 	vkLib::StorageBufferWriteInfo storageInfo{};
 
 	storageInfo.Buffer = mHandle.mRays.GetNativeHandles().Handle;
@@ -9,6 +9,7 @@ AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::WavefrontEstimator(
 	: mCreateInfo(createInfo)
 {
 	mResourcePool = mCreateInfo.Context.CreateResourcePool();
+	mResourcePool.SetMemoryTag("Wavefront");
 	mPipelineBuilder = mCreateInfo.Context.MakePipelineBuilder();
 
 	MAT_NAMESPACE::MaterialAssembler assembler{};
@@ -20,6 +21,18 @@ AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::WavefrontEstimator(
 	RetrieveFrontAndBackEndShaders();
 }
 
+AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::~WavefrontEstimator()
+{
+	if (!mCreateInfo.ShaderReloader)
+		return;
+
+	// waits for the rebuilds in progress, they use this object
+	std::scoped_lock locker(mReloadLock);
+
+	for (uint64_t id : mReloadTargets)
+		mCreateInfo.ShaderReloader->Unregister(id);
+}
+
 AQUA_NAMESPACE::PH_FLUX_NAMESPACE::TraceSession AQUA_NAMESPACE::PH_FLUX_NAMESPACE::
 	WavefrontEstimator::CreateTraceSession()
 {
@@ -69,9 +82,115 @@ AQUA_NAMESPACE::PH_FLUX_NAMESPACE::Executor AQUA_NAMESPACE::PH_FLUX_NAMESPACE::W
 
 	executor.mCtx = mCreateInfo.Context;
 
+	if (mCreateInfo.ShaderReloader)
+		RegisterReloadTargets(executor.mExecutorInfo);
+
 	return executor;
 }
 
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::RegisterReloadTargets(
+	const std::shared_ptr<ExecutionInfo>& executionInfo)
+{
+	executionInfo->ShaderReloader = mCreateInfo.ShaderReloader;
+
+	RegisterReloadTarget(executionInfo, &ExecutionPipelines::RayGenerator,
+		[this](std::vector<vkLib::CompileError>* errors) { return GetRayGenerationShader(errors); });
+
+	RegisterReloadTarget(executionInfo, &ExecutionPipelines::IntersectionPipeline,
+		[this](std::vector<vkLib::CompileError>* errors) { return GetIntersectionShader(errors); });
+
+	RegisterReloadTarget(executionInfo, &ExecutionPipelines::RaySortPreparer,
+		[this](std::vector<vkLib::CompileError>* errors) { return GetRaySortEpilogueShader(RaySortEvent::ePrepare, errors); });
+
+	RegisterReloadTarget(executionInfo, &ExecutionPipelines::RaySortFinisher,
+		[this](std::vector<vkLib::CompileError>* errors) { return GetRaySortEpilogueShader(RaySortEvent::eFinish, errors); });
+
+	RegisterReloadTarget(executionInfo, &ExecutionPipelines::RayRefCounter,
+		[this](std::vector<vkLib::CompileError>* errors) { return GetRayRefCounterShader(errors); });
+
+	RegisterReloadTarget(executionInfo, &ExecutionPipelines::PrefixSummer,
+		[this](std::vector<vkLib::CompileError>* errors) { return GetPrefixSumShader(errors); });
+
+	RegisterReloadTarget(executionInfo, &ExecutionPipelines::LuminanceMean,
+		[this](std::vector<vkLib::CompileError>* errors) { return GetLuminanceMeanShader(errors); });
+
+	RegisterReloadTarget(executionInfo, &ExecutionPipelines::PostProcessor,
+		[this](std::vector<vkLib::CompileError>* errors) { return GetPostProcessImageShader(errors); });
+}
+
+template <typename Pipeline>
+void AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::RegisterReloadTarget(
+	const std::shared_ptr<ExecutionInfo>& executionInfo, Pipeline ExecutionPipelines::* pipeline,
+	std::function<vkLib::PShader(std::vector<vkLib::CompileError>*)> getShader)
+{
+	// written by Rebuild and consumed by Commit, the service never runs both at once
+	auto staged = std::make_shared<std::optional<Pipeline>>();
+	std::weak_ptr<ExecutionInfo> weakInfo = executionInfo;
+
+	vkLib::ShaderReloadTarget target;
+	target.Sources = (executionInfo->PipelineResources.*pipeline).GetShader().GetSourceFiles();
+
+	target.Rebuild = [this, staged, getShader]()
+		{
+			std::vector<vkLib::CompileError> errors;
+			vkLib::PShader shader = getShader(&errors);
+
+			// the failing source lands where the other shader paths put it, the service counts the failure
+			CompileErrorChecker checker("Logging/ShaderFails/Shader.glsl");
+			std::vector<std::string> messages;
+
+			for (const auto& error : errors)
+			{
+				if (error.Type != vkLib::ErrorType::eNone)
+					messages.push_back(checker.GetError(error));
+			}
+
+			if (!messages.empty())
+			{
+				std::scoped_lock locker(mReloadLock);
+				mReloadErrors = std::move(messages);
+
+				return false;
+			}
+
+			*staged = mPipelineBuilder.BuildComputePipeline<Pipeline>(shader);
+			return true;
+		};
+
+	target.Commit = [staged, weakInfo, pipeline]()
+		{
+			auto info = weakInfo.lock();
+
+			if (!info || !staged->has_value())
+				return;
+
+			auto& live = info->PipelineResources.*pipeline;
+
+			// recorded work may still use the old handles
+			info->RetiredPipelines.push_back(live);
+
+			// only the vkLib part is replaced, the resources the executor bound stay
+			static_cast<vkLib::ComputePipeline&>(live) = static_cast<vkLib::ComputePipeline&&>(std::move(**staged));
+			staged->reset();
+
+			if (info->TracingSession.mSessionInfo)
+				live.UpdateDescriptors();
+		};
+
+	uint64_t id = mCreateInfo.ShaderReloader->Register(std::move(target));
+
+	executionInfo->ReloadTargets.push_back(id);
+
+	std::scoped_lock locker(mReloadLock);
+	mReloadTargets.push_back(id);
+}
+
+std::vector<std::string> AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetShaderReloadErrors()
+{
+	std::scoped_lock locker(mReloadLock);
+	return mReloadErrors;
+}
+
 AQUA_NAMESPACE::PH_FLUX_NAMESPACE::ExecutionPipelines AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::CreatePipelines()
 {
 	RTMaterialCreateInfo inactiveMaterialInfo{};
@@ -262,7 +381,7 @@ void DispatchErrorMessage(AQUA_NAMESPACE::PH_FLUX_NAMESPACE::MaterialShaderError
 	_STL_ASSERT(false, errorMessage.c_str());
 }
 
-vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetRayGenerationShader()
+vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetRayGenerationShader(std::vector<vkLib::CompileError>* errors)
 {
 	vkLib::OptimizerFlag optimizerFlag = vkLib::OptimizerFlag::eO3;
 
@@ -272,18 +391,22 @@ vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetRayGene
 
 	vkLib::PShader shader{};
 
-	shader.AddMacro("WORKGROUP_SIZE", std::to_string(mCreateInfo.RayGenWorkgroupSize.x));
 	shader.SetFilepath("eCompute", GetShaderDirectory() + "Wavefront/RayGeneration.comp", optimizerFlag);
 
 	auto Errors = shader.CompileShaders();
 
-	CompileErrorChecker checker("Logging/ShaderFails/Shader.glsl");
-	checker.AssertOnError(Errors);
+	if (errors)
+		*errors = Errors;
+	else
+		CompileErrorChecker("Logging/ShaderFails/Shader.glsl").AssertOnError(Errors);
+
+	// the sizes are specialized at pipeline creation, every size shares one module
+	shader.SetWorkGroupSize({ static_cast<uint32_t>(mCreateInfo.RayGenWorkgroupSize.x), 1, 1 });
 
 	return shader;
 }
 
-vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetIntersectionShader()
+vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetIntersectionShader(std::vector<vkLib::CompileError>* errors)
 {
 	vkLib::OptimizerFlag optimizerFlag = vkLib::OptimizerFlag::eO3;
 
@@ -293,7 +416,6 @@ vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetInterse
 
 	vkLib::PShader shader;
 
-	shader.AddMacro("WORKGROUP_SIZE", std::to_string(mCreateInfo.IntersectionWorkgroupSize));
 	shader.AddMacro("TOLERANCE", std::to_string(mCreateInfo.Tolerance));
 	shader.AddMacro("MAX_DIS", std::to_string(FLT_MAX));
 	shader.AddMacro("FLT_MAX", std::to_string(FLT_MAX));
@@ -303,15 +425,21 @@ vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetInterse
 
 	auto Errors = shader.CompileShaders();
 
-	CompileErrorChecker checker("../vkEngineTester/Logging/ShaderFails/Shader.glsl");
+	if (errors)
+		*errors = Errors;
+	else
+	{
+		CompileErrorChecker checker("../vkEngineTester/Logging/ShaderFails/Shader.glsl");
+		checker.AssertOnError(checker.GetErrors(Errors));
+	}
 
-	auto ErrorInfos = checker.GetErrors(Errors);
-	checker.AssertOnError(ErrorInfos);
+	shader.SetWorkGroupSize({ mCreateInfo.IntersectionWorkgroupSize, 1, 1 });
 
 	return shader;
 }
 
-vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetRaySortEpilogueShader(RaySortEvent sortEvent)
+vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetRaySortEpilogueShader(
+	RaySortEvent sortEvent, std::vector<vkLib::CompileError>* errors)
 {
 	vkLib::OptimizerFlag optimizerFlag = vkLib::OptimizerFlag::eO3;
 
@@ -321,8 +449,6 @@ vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetRaySort
 
 	vkLib::PShader shader;
 
-	shader.AddMacro("WORKGROUP_SIZE", std::to_string(mCreateInfo.IntersectionWorkgroupSize));
-
 	std::string shaderPath;
 
 	switch (sortEvent)
@@ -341,15 +467,20 @@ vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetRaySort
 
 	auto Errors = shader.CompileShaders();
 
-	CompileErrorChecker checker("../vkEngineTester/Logging/ShaderFails/Shader.glsl");
+	if (errors)
+		*errors = Errors;
+	else
+	{
+		CompileErrorChecker checker("../vkEngineTester/Logging/ShaderFails/Shader.glsl");
+		checker.AssertOnError(checker.GetErrors(Errors));
+	}
 
-	auto ErrorInfos = checker.GetErrors(Errors);
-	checker.AssertOnError(ErrorInfos);
+	shader.SetWorkGroupSize({ mCreateInfo.IntersectionWorkgroupSize, 1, 1 });
 
 	return shader;
 }
 
-vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetRayRefCounterShader()
+vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetRayRefCounterShader(std::vector<vkLib::CompileError>* errors)
 {
 	vkLib::OptimizerFlag optimizerFlag = vkLib::OptimizerFlag::eO3;
 
@@ -359,22 +490,26 @@ vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetRayRefC
 
 	vkLib::PShader shader;
 
-	shader.AddMacro("WORKGROUP_SIZE", std::to_string(mCreateInfo.IntersectionWorkgroupSize));
 	shader.AddMacro("PRIMITIVE_TYPE", "uint");
 
 	shader.SetFilepath("eCompute", GetShaderDirectory() + "Utils/CountElements.glsl", optimizerFlag);
 
 	auto Errors = shader.CompileShaders();
 
-	CompileErrorChecker checker("../vkEngineTester/Logging/ShaderFails/Shader.glsl");
+	if (errors)
+		*errors = Errors;
+	else
+	{
+		CompileErrorChecker checker("../vkEngineTester/Logging/ShaderFails/Shader.glsl");
+		checker.AssertOnError(checker.GetErrors(Errors));
+	}
 
-	auto ErrorInfos = checker.GetErrors(Errors);
-	checker.AssertOnError(ErrorInfos);
+	shader.SetWorkGroupSize({ mCreateInfo.IntersectionWorkgroupSize, 1, 1 });
 
 	return shader;
 }
 
-vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetPrefixSumShader()
+vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetPrefixSumShader(std::vector<vkLib::CompileError>* errors)
 {
 	vkLib::OptimizerFlag optimizerFlag = vkLib::OptimizerFlag::eO3;
 
@@ -384,20 +519,24 @@ vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetPrefixS
 
 	vkLib::PShader shader;
 
-	shader.AddMacro("WORKGROUP_SIZE", std::to_string(mCreateInfo.IntersectionWorkgroupSize));
 	shader.SetFilepath("eCompute", GetShaderDirectory() + "Utils/PrefixSum.glsl", optimizerFlag);
 	
 	auto Errors = shader.CompileShaders();
 
-	CompileErrorChecker checker("Logging/ShaderFails/Shader.glsl");
+	if (errors)
+		*errors = Errors;
+	else
+	{
+		CompileErrorChecker checker("Logging/ShaderFails/Shader.glsl");
+		checker.AssertOnError(checker.GetErrors(Errors));
+	}
 
-	auto ErrorInfos = checker.GetErrors(Errors);
-	checker.AssertOnError(ErrorInfos);
+	shader.SetWorkGroupSize({ mCreateInfo.IntersectionWorkgroupSize, 1, 1 });
 
 	return shader;
 }
 
-vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetLuminanceMeanShader()
+vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetLuminanceMeanShader(std::vector<vkLib::CompileError>* errors)
 {
 	vkLib::OptimizerFlag optimizerFlag = vkLib::OptimizerFlag::eO3;
 
@@ -407,20 +546,24 @@ vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetLuminan
 
 	vkLib::PShader shader;
 
-	shader.AddMacro("WORKGROUP_SIZE", std::to_string(mCreateInfo.IntersectionWorkgroupSize));
 	shader.SetFilepath("eCompute", GetShaderDirectory() + "Wavefront/LuminanceMean.glsl", optimizerFlag);
 	
 	auto Errors = shader.CompileShaders();
 
-	CompileErrorChecker checker("Logging/ShaderFails/Shader.glsl");
+	if (errors)
+		*errors = Errors;
+	else
+	{
+		CompileErrorChecker checker("Logging/ShaderFails/Shader.glsl");
+		checker.AssertOnError(checker.GetErrors(Errors));
+	}
 
-	auto ErrorInfos = checker.GetErrors(Errors);
-	checker.AssertOnError(ErrorInfos);
+	shader.SetWorkGroupSize({ mCreateInfo.IntersectionWorkgroupSize, 1, 1 });
 
 	return shader;
 }
 
-vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetPostProcessImageShader()
+vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetPostProcessImageShader(std::vector<vkLib::CompileError>* errors)
 {
 	vkLib::OptimizerFlag optimizerFlag = vkLib::OptimizerFlag::eO3;
 
@@ -430,9 +573,6 @@ vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetPostPro
 
 	vkLib::PShader shader;
 
-	shader.AddMacro("WORKGROUP_SIZE_X", std::to_string(16));
-	shader.AddMacro("WORKGROUP_SIZE_Y", std::to_string(16));
-
 	shader.AddMacro("APPLY_TONE_MAP", std::to_string(static_cast<uint32_t>(PostProcessFlagBits::eToneMap)));
 
 	shader.AddMacro("APPLY_GAMMA_CORRECTION",
@@ -445,10 +585,15 @@ vkLib::PShader AQUA_NAMESPACE::PH_FLUX_NAMESPACE::WavefrontEstimator::GetPostPro
 
 	auto Errors = shader.CompileShaders();
 
-	CompileErrorChecker checker("../vkEngineTester/Logging/ShaderFails/Shader.glsl");
+	if (errors)
+		*errors = Errors;
+	else
+	{
+		CompileErrorChecker checker("../vkEngineTester/Logging/ShaderFails/Shader.glsl");
+		checker.AssertOnError(checker.GetErrors(Errors));
+	}
 
-	auto ErrorInfos = checker.GetErrors(Errors);
-	checker.AssertOnError(ErrorInfos);
+	shader.SetWorkGroupSize({ 16, 16, 1 });
 
 	return shader;
 }
@@ -0,0 +1,313 @@
+#include "ShaderCompiler/ShaderCompiler.h"
+#include "ShaderCompiler/ShaderArchive.h"
+#include "ShaderCompiler/CompilerUtils.h"
+
+#include <chrono>
+
+// Compiles every shader under a source root into one ShaderArchive
+// Usage: ShaderPrecompiler <shader root> <output archive> [permutation manifest] [-j <threads>]
+// Files with a stage extension are compiled without macros, the manifest adds the macro permutations
+// the runtime asks for (see Aqua/Assets/Shaders/Precompile.txt for its format)
+
+namespace
+{
+	struct Permutation
+	{
+		std::string Name;
+		vkLib::ShaderInput Input;
+		vkLib::PreprocessorDirectives Macros;
+
+		// discovered files may need macros the manifest provides, their failures are only warnings
+		bool Required = false;
+	};
+
+	const std::unordered_map<std::string, vk::ShaderStageFlagBits> sStageExtensions =
+	{
+		{ ".vert", vk::ShaderStageFlagBits::eVertex },
+		{ ".frag", vk::ShaderStageFlagBits::eFragment },
+		{ ".comp", vk::ShaderStageFlagBits::eCompute },
+		{ ".geom", vk::ShaderStageFlagBits::eGeometry },
+		{ ".tesc", vk::ShaderStageFlagBits::eTessellationControl },
+		{ ".tese", vk::ShaderStageFlagBits::eTessellationEvaluation },
+		{ ".task", vk::ShaderStageFlagBits::eTaskEXT },
+		{ ".mesh", vk::ShaderStageFlagBits::eMeshEXT },
+		{ ".rgen", vk::ShaderStageFlagBits::eRaygenKHR },
+		{ ".rmiss", vk::ShaderStageFlagBits::eMissKHR },
+		{ ".rchit", vk::ShaderStageFlagBits::eClosestHitKHR },
+		{ ".rahit", vk::ShaderStageFlagBits::eAnyHitKHR },
+		{ ".rint", vk::ShaderStageFlagBits::eIntersectionKHR },
+		{ ".rcall", vk::ShaderStageFlagBits::eCallableKHR },
+	};
+
+	const std::unordered_map<std::string, vkLib::OptimizerFlag> sOptimizerFlags =
+	{
+		{ "O0", vkLib::OptimizerFlag::eNone },
+		{ "O1", vkLib::OptimizerFlag::eO1 },
+		{ "O2", vkLib::OptimizerFlag::eO2 },
+		{ "O3", vkLib::OptimizerFlag::eO3 },
+		{ "Os", vkLib::OptimizerFlag::eSize },
+	};
+
+	const std::unordered_map<std::string, vkLib::OptimizerFlag> sOptimizerRecipes =
+	{
+		{ "strip", vkLib::OptimizerFlag::eStripDebug },
+		{ "branches", vkLib::OptimizerFlag::eDeadBranches },
+	};
+
+	// a level followed by recipes, e.g. O3+strip
+	std::optional<vkLib::OptimizerFlag> ParseOptimizerFlag(const std::string& string)
+	{
+		size_t separator = string.find('+');
+		auto level = sOptimizerFlags.find(string.substr(0, separator));
+
+		if (level == sOptimizerFlags.end())
+			return std::nullopt;
+
+		vkLib::OptimizerFlag flag = level->second;
+
+		while (separator != std::string::npos)
+		{
+			size_t next = string.find('+', separator + 1);
+			auto recipe = sOptimizerRecipes.find(string.substr(separator + 1, next - separator - 1));
+
+			if (recipe == sOptimizerRecipes.end())
+				return std::nullopt;
+
+			flag = flag | recipe->second;
+			separator = next;
+		}
+
+		return flag;
+	}
+
+	void DiscoverShaders(const std::filesystem::path& root, std::vector<Permutation>& permutations)
+	{
+		for (const auto& file : std::filesystem::recursive_directory_iterator(root))
+		{
+			if (!file.is_regular_file())
+				continue;
+
+			auto found = sStageExtensions.find(file.path().extension().string());
+
+			if (found == sStageExtensions.end())
+				continue;
+
+			auto& permutation = permutations.emplace_back();
+			permutation.Name = file.path().lexically_relative(root).generic_string();
+			permutation.Input = { "", found->second, file.path().string(), vkLib::OptimizerFlag::eO3 };
+		}
+	}
+
+	// the shader and every file it included, named the way ShaderArchive looks them up
+	std::vector<vkLib::ShaderArchiveSource> CollectSources(const std::filesystem::path& root,
+		const vkLib::IncludeCache& includeCache, const std::filesystem::path& shader)
+	{
+		std::vector<std::filesystem::path> files = { vkLib::IncludeCache::NormalizePath(shader) };
+
+		auto dependencies = includeCache.GetDependencies(shader);
+		files.insert(files.end(), dependencies.begin(), dependencies.end());
+
+		std::vector<vkLib::ShaderArchiveSource> sources;
+
+		for (const auto& file : files)
+		{
+			auto contents = vkLib::ReadFile(file.string());
+
+			if (!contents)
+				return {};
+
+			auto relative = file.lexically_relative(root);
+			bool inside = !relative.empty() && *relative.begin() != "..";
+
+			sources.push_back({ inside ? relative.generic_string() : file.generic_string(),
+				vkLib::ShaderArchive::HashSource(*contents) });
+		}
+
+		return sources;
+	}
+
+	bool ReadManifest(const std::filesystem::path& root, const std::filesystem::path& manifest,
+		std::vector<Permutation>& permutations)
+	{
+		std::ifstream file(manifest);
+
+		if (!file)
+		{
+			std::cerr << "Can't open the manifest at " << manifest.string() << "\n";
+			return false;
+		}
+
+		std::string line;
+		size_t lineNumber = 0;
+
+		while (std::getline(file, line))
+		{
+			lineNumber++;
+
+			std::istringstream stream(line);
+
+			std::string name, stage, optimizer;
+
+			if (!(stream >> name) || name.front() == '#')
+				continue;
+
+			std::optional<vkLib::OptimizerFlag> optimizerFlag;
+
+			if (stream >> stage >> optimizer)
+				optimizerFlag = ParseOptimizerFlag(optimizer);
+
+			if (!optimizerFlag)
+			{
+				std::cerr << manifest.string() << ":" << lineNumber << ": ill formed permutation\n";
+				return false;
+			}
+
+			auto& permutation = permutations.emplace_back();
+			permutation.Name = std::filesystem::path(name).generic_string();
+			permutation.Required = true;
+
+			try
+			{
+				permutation.Input = { "", vkLib::ShaderCompiler::GetShaderStageFlag(stage),
+					(root / name).string(), *optimizerFlag };
+			}
+			catch (const std::out_of_range&)
+			{
+				std::cerr << manifest.string() << ":" << lineNumber << ": unknown stage " << stage << "\n";
+				return false;
+			}
+
+			std::string macro;
+
+			while (stream >> macro)
+			{
+				size_t separator = macro.find('=');
+
+				if (separator == std::string::npos)
+					permutation.Macros[macro] = "";
+				else
+					permutation.Macros[macro.substr(0, separator)] = macro.substr(separator + 1);
+			}
+		}
+
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> args;
+	uint32_t threadCount = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+
+		if (arg == "-j" && i + 1 < argc)
+			threadCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else
+			args.push_back(arg);
+	}
+
+	if (args.size() < 2 || args.size() > 3)
+	{
+		std::cerr << "Usage: ShaderPrecompiler <shader root> <output archive> [permutation manifest] [-j <threads>]\n";
+		return 1;
+	}
+
+	std::filesystem::path root = std::filesystem::canonical(args[0]);
+	std::filesystem::path output = args[1];
+
+	std::vector<Permutation> permutations;
+	DiscoverShaders(root, permutations);
+
+	if (args.size() == 3 && !ReadManifest(root, args[2], permutations))
+		return 1;
+
+	// the same config PShader compiles with, entries of any other config would never be hit
+	vkLib::CompilerConfig config{
+		glslang::EShTargetClientVersion::EShTargetVulkan_1_3,
+		glslang::EShTargetLanguageVersion::EShTargetSpv_1_6,
+		440 };
+
+	// permutations sharing a macro set go through one batch
+	std::map<std::vector<std::pair<std::string, std::string>>, std::vector<size_t>> batches;
+
+	for (size_t i = 0; i < permutations.size(); i++)
+	{
+		const auto& macros = permutations[i].Macros;
+		batches[{ macros.begin(), macros.end() }].push_back(i);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	vkLib::ShaderArchiveWriter writer;
+
+	// one cache for every batch, the headers are read once and the dependency graph covers all shaders
+	auto includeCache = std::make_shared<vkLib::IncludeCache>();
+
+	size_t failures = 0;
+	size_t warnings = 0;
+
+	for (auto& [macroSet, indices] : batches)
+	{
+		vkLib::CompilerEnvironment env(config);
+		env.SetPreprocessorDirectives({ macroSet.begin(), macroSet.end() });
+		env.SetIncludeCache(includeCache);
+
+		std::vector<vkLib::ShaderInput> inputs;
+		inputs.reserve(indices.size());
+
+		for (size_t index : indices)
+			inputs.push_back(permutations[index].Input);
+
+		vkLib::ShaderCompiler compiler(env);
+		auto results = compiler.CompileBatch(inputs, threadCount);
+
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			const auto& permutation = permutations[indices[i]];
+			const auto& result = results[i];
+
+			if (result.Error.Type != vkLib::ErrorType::eNone || result.SPIR_V.ByteCode.empty())
+			{
+				(permutation.Required ? failures : warnings)++;
+
+				std::cerr << (permutation.Required ? "error: " : "warning: ") << permutation.Name << " ("
+					<< vkLib::ShaderCompiler::GetShaderStageString(permutation.Input.Stage) << "): "
+					<< result.Error.Info << "\n";
+
+				continue;
+			}
+
+			auto sources = CollectSources(root, *includeCache, permutation.Input.FilePath);
+
+			if (!writer.Add(permutation.Name, permutation.Macros, permutation.Input.OptimizationFlag,
+				config, result, sources))
+			{
+				(permutation.Required ? failures : warnings)++;
+				std::cerr << (permutation.Required ? "error: " : "warning: ") << permutation.Name
+					<< ": can't hash its sources\n";
+			}
+		}
+	}
+
+	if (failures != 0)
+	{
+		std::cerr << failures << " required permutation(s) failed, no archive written\n";
+		return 1;
+	}
+
+	if (!writer.Write(output))
+	{
+		std::cerr << "Can't write the archive to " << output.string() << "\n";
+		return 1;
+	}
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+	std::cout << "Wrote " << writer.GetEntryCount() << " shader(s) to " << output.string() << " in "
+		<< elapsed.count() << " ms, " << warnings << " skipped\n";
+
+	return 0;
+}
@@ -0,0 +1,378 @@
+#include "TestRunner.h"
+#include "Memory/BufferRecycler.h"
+
+// The recycler only talks to the device to destroy buffers and to poll fences
+// These tests keep every buffer within the caps, park them through Retire(nullptr) or MarkIdle
+// and take everything back out before the recycler goes away, so no device is needed
+
+namespace
+{
+	using vkLib::Core::Buffer;
+	using vkLib::Core::BufferConfig;
+	using vkLib::Core::BufferRecycler;
+	using vkLib::Core::BufferRecyclerConfig;
+
+	constexpr auto sStorageUsage = vk::BufferUsageFlagBits::eStorageBuffer;
+	constexpr auto sVertexUsage = vk::BufferUsageFlagBits::eVertexBuffer;
+
+	BufferConfig MakeConfig(vk::DeviceSize size, vk::BufferUsageFlags usage = sStorageUsage,
+		vk::MemoryPropertyFlags memProps = vk::MemoryPropertyFlagBits::eDeviceLocal, uint32_t owner = 0)
+	{
+		BufferConfig config{};
+		config.DeviceSize = size;
+		config.Usage = usage;
+		config.MemProps = memProps;
+		config.ResourceOwner = owner;
+
+		return config;
+	}
+
+	// what Utils::CreateBuffer would have produced, with a fake handle and no memory behind it
+	Buffer MakeBuffer(const BufferConfig& config)
+	{
+		static std::atomic<uint64_t> sNextHandle = 1;
+
+		Buffer buffer{};
+		buffer.Handle = Tests::MakeHandle<vk::Buffer>(sNextHandle++);
+		buffer.Config = config;
+		buffer.CreatedSize = config.DeviceSize;
+		buffer.MemReq.size = config.DeviceSize;
+		buffer.BufferSize = config.DeviceSize;
+
+		return buffer;
+	}
+
+	// takes every parked buffer of these classes back out so the destructor has nothing to destroy
+	size_t Drain(BufferRecycler& recycler, const std::vector<BufferConfig>& configs)
+	{
+		size_t drained = 0;
+
+		for (const auto& config : configs)
+		{
+			while (recycler.Acquire(config))
+				drained++;
+		}
+
+		return drained;
+	}
+}
+
+TEST(BufferRecycler, SizeClasses)
+{
+	BufferRecycler recycler({});
+	BufferRecyclerConfig config = recycler.GetConfig();
+
+	CHECK_EQ(recycler.GetSizeClass(1), config.MinSizeClass);
+	CHECK_EQ(recycler.GetSizeClass(config.MinSizeClass), config.MinSizeClass);
+
+	CHECK_EQ(recycler.GetSizeClass(257), vk::DeviceSize(320));
+	CHECK_EQ(recycler.GetSizeClass(1000), vk::DeviceSize(1024));
+	CHECK_EQ(recycler.GetSizeClass(5000), vk::DeviceSize(5120));
+
+	// too large to pool, left alone
+	CHECK_EQ(recycler.GetSizeClass(config.MaxSizeClass + 1), config.MaxSizeClass + 1);
+
+	std::mt19937_64 random(11);
+
+	for (uint32_t i = 0; i < 10'000; i++)
+	{
+		vk::DeviceSize size = config.MinSizeClass + random() % (config.MaxSizeClass - config.MinSizeClass);
+		vk::DeviceSize sizeClass = recycler.GetSizeClass(size);
+
+		// at most a quarter wasted, and a class maps onto itself
+		CHECK(sizeClass >= size && sizeClass - size <= size / 4);
+		CHECK_EQ(recycler.GetSizeClass(sizeClass), sizeClass);
+	}
+}
+
+TEST(BufferRecycler, ReusesOnlyAfterRetire)
+{
+	BufferRecycler recycler({});
+
+	BufferConfig config = MakeConfig(4096);
+	Buffer released = MakeBuffer(config);
+
+	CHECK(recycler.Release(released));
+	CHECK_EQ(recycler.GetStats().PendingBuffers, size_t(1));
+
+	// the GPU may still be reading it
+	CHECK(!recycler.Acquire(config));
+
+	recycler.Retire(nullptr);
+
+	auto stats = recycler.GetStats();
+	CHECK_EQ(stats.PendingBuffers, size_t(0));
+	CHECK_EQ(stats.PooledBuffers, size_t(1));
+	CHECK_EQ(stats.PooledSize, vk::DeviceSize(4096));
+
+	BufferConfig request = MakeConfig(4096);
+	request.Tag = "Reused";
+
+	auto reused = recycler.Acquire(request);
+
+	CHECK(reused.has_value());
+	CHECK(reused->Handle == released.Handle);
+	CHECK_EQ(reused->Config.Tag, std::string("Reused"));
+	CHECK_EQ(reused->BufferSize, size_t(0));
+
+	stats = recycler.GetStats();
+	CHECK_EQ(stats.Hits, uint64_t(1));
+	CHECK_EQ(stats.Misses, uint64_t(1));
+	CHECK_EQ(stats.PooledBuffers, size_t(0));
+	CHECK_EQ(stats.PooledSize, vk::DeviceSize(0));
+}
+
+TEST(BufferRecycler, KeyedByOwnerUsageMemoryAndSize)
+{
+	BufferRecycler recycler({});
+
+	BufferConfig config = MakeConfig(4096, sStorageUsage, vk::MemoryPropertyFlagBits::eDeviceLocal, 2);
+	Buffer released = MakeBuffer(config);
+
+	CHECK(recycler.Release(released));
+	recycler.Retire(nullptr);
+
+	CHECK(!recycler.Acquire(MakeConfig(4096, sVertexUsage, vk::MemoryPropertyFlagBits::eDeviceLocal, 2)));
+	CHECK(!recycler.Acquire(MakeConfig(4096, sStorageUsage, vk::MemoryPropertyFlagBits::eHostVisible, 2)));
+	CHECK(!recycler.Acquire(MakeConfig(4096, sStorageUsage, vk::MemoryPropertyFlagBits::eDeviceLocal, 0)));
+	CHECK(!recycler.Acquire(MakeConfig(5120, sStorageUsage, vk::MemoryPropertyFlagBits::eDeviceLocal, 2)));
+
+	auto reused = recycler.Acquire(config);
+	CHECK(reused && reused->Handle == released.Handle);
+}
+
+TEST(BufferRecycler, MarkIdleParksEarlierReleasesOnly)
+{
+	BufferRecycler recycler({});
+	BufferConfig config = MakeConfig(1024);
+
+	Buffer before = MakeBuffer(config);
+	CHECK(recycler.Release(before));
+
+	uint64_t serial = recycler.GetReleaseSerial();
+
+	// released after the device was seen idle, might be used by a later submission
+	Buffer after = MakeBuffer(config);
+	CHECK(recycler.Release(after));
+
+	recycler.MarkIdle(serial);
+
+	auto reused = recycler.Acquire(config);
+	CHECK(reused && reused->Handle == before.Handle);
+	CHECK(!recycler.Acquire(config));
+
+	recycler.Retire(nullptr);
+
+	reused = recycler.Acquire(config);
+	CHECK(reused && reused->Handle == after.Handle);
+}
+
+TEST(BufferRecycler, RejectsWhatItCannotServe)
+{
+	BufferRecyclerConfig config{};
+	config.MaxSizeClass = 1024 * 1024;
+
+	BufferRecycler recycler({}, config);
+
+	// no handle, not created at a size class, or too large to pool
+	CHECK(!recycler.Release(Buffer{}));
+	CHECK(!recycler.Release(MakeBuffer(MakeConfig(300))));
+	CHECK(!recycler.Release(MakeBuffer(MakeConfig(2 * 1024 * 1024))));
+
+	auto stats = recycler.GetStats();
+	CHECK_EQ(stats.Rejected, uint64_t(2));
+	CHECK_EQ(stats.Recycled, uint64_t(0));
+	CHECK_EQ(stats.PendingBuffers, size_t(0));
+}
+
+TEST(BufferRecycler, PooledSizeCapCountsPendingBuffers)
+{
+	BufferRecyclerConfig config{};
+	config.MaxPooledSize = 8192;
+
+	BufferRecycler recycler({}, config);
+	BufferConfig bufferConfig = MakeConfig(4096);
+
+	CHECK(recycler.Release(MakeBuffer(bufferConfig)));
+	recycler.Retire(nullptr);
+
+	// one parked and one pending fill the budget between them
+	CHECK(recycler.Release(MakeBuffer(bufferConfig)));
+	CHECK(!recycler.Release(MakeBuffer(bufferConfig)));
+
+	recycler.Retire(nullptr);
+	CHECK(!recycler.Release(MakeBuffer(bufferConfig)));
+
+	auto stats = recycler.GetStats();
+	CHECK_EQ(stats.PooledSize, vk::DeviceSize(8192));
+	CHECK_EQ(stats.Rejected, uint64_t(2));
+
+	// handing one out makes room again
+	CHECK(recycler.Acquire(bufferConfig));
+	CHECK(recycler.Release(MakeBuffer(bufferConfig)));
+
+	recycler.Retire(nullptr);
+	CHECK_EQ(Drain(recycler, { bufferConfig }), size_t(2));
+}
+
+TEST(BufferRecycler, ParkedBuffersDropTheirRecycler)
+{
+	auto recycler = std::make_shared<BufferRecycler>(vkLib::Core::Ref<vk::Device>());
+
+	BufferConfig config = MakeConfig(2048);
+	config.Recycler = recycler;
+
+	Buffer released = MakeBuffer(config);
+	config.Recycler.reset();
+
+	CHECK(recycler->Release(released));
+	released.Config.Recycler.reset();
+
+	// nothing parked inside the recycler keeps it alive
+	CHECK_EQ(recycler.use_count(), long(1));
+
+	recycler->Retire(nullptr);
+	CHECK_EQ(Drain(*recycler, { config }), size_t(1));
+}
+
+TEST(BufferRecycler, ConcurrentReleaseAndAcquire)
+{
+	constexpr uint32_t sThreadCount = 4;
+	constexpr uint32_t sIterations = 2000;
+
+	BufferRecycler recycler({});
+
+	std::vector<BufferConfig> configs = { MakeConfig(256), MakeConfig(1024), MakeConfig(4096) };
+	std::atomic<uint64_t> created = 0;
+
+	std::vector<std::jthread> threads;
+
+	for (uint32_t t = 0; t < sThreadCount; t++)
+	{
+		threads.emplace_back([&, t]()
+		{
+			std::optional<Buffer> held;
+
+			for (uint32_t i = 0; i < sIterations; i++)
+			{
+				const auto& config = configs[(t + i) % configs.size()];
+
+				if (held)
+					recycler.Release(*held);
+
+				recycler.Retire(nullptr);
+
+				held = recycler.Acquire(config);
+
+				if (!held)
+				{
+					held = MakeBuffer(config);
+					created++;
+				}
+			}
+
+			recycler.Release(*held);
+			recycler.Retire(nullptr);
+		});
+	}
+
+	threads.clear();
+
+	auto stats = recycler.GetStats();
+
+	// every buffer ever created is parked again, none got lost or handed out twice
+	CHECK_EQ(stats.PooledBuffers, size_t(created.load()));
+	CHECK_EQ(stats.Hits + stats.Misses, uint64_t(sThreadCount) * sIterations);
+	CHECK_EQ(Drain(recycler, configs), size_t(created.load()));
+}
+
+BENCHMARK(BufferRecycler, SceneLoadAllocations)
+{
+	// renderables reserve 64 vertices and grow by doubling, the way RenderableBuilder fills them
+	// the scene is loaded, unloaded and loaded again
+	constexpr uint32_t sRenderableCount = 2000;
+	constexpr vk::DeviceSize sVertexSize = 64;
+
+	BufferRecyclerConfig config{};
+	config.MaxBuffersPerClass = std::numeric_limits<uint32_t>::max();
+	config.MaxPooledSize = std::numeric_limits<vk::DeviceSize>::max();
+
+	BufferRecycler recycler({}, config);
+
+	std::mt19937 random(3);
+	std::vector<vk::DeviceSize> finalSizes(sRenderableCount);
+
+	for (auto& size : finalSizes)
+		size = (64 + random() % 16'000) * sVertexSize;
+
+	std::set<vk::DeviceSize> classes;
+
+	uint64_t coldAllocations = 0;
+	uint64_t pooledAllocations = 0;
+
+	auto load = [&](std::vector<Buffer>& loaded)
+	{
+		for (vk::DeviceSize finalSize : finalSizes)
+		{
+			Buffer current{};
+
+			for (vk::DeviceSize size = 64 * sVertexSize; ; size = std::min(size * 2, finalSize))
+			{
+				BufferConfig request = MakeConfig(recycler.GetSizeClass(size), sVertexUsage);
+				classes.insert(request.DeviceSize);
+
+				coldAllocations++;
+
+				auto reused = recycler.Acquire(request);
+
+				if (!reused)
+				{
+					reused = MakeBuffer(request);
+					pooledAllocations++;
+				}
+
+				// the old contents are copied over, then the old buffer is released
+				if (current.Handle)
+					recycler.Release(current);
+
+				recycler.Retire(nullptr);
+				current = *reused;
+
+				if (size == finalSize)
+					break;
+			}
+
+			loaded.push_back(current);
+		}
+	};
+
+	std::vector<Buffer> scene;
+
+	double seconds = Tests::MeasureSeconds([&]()
+	{
+		load(scene);
+
+		for (const auto& buffer : scene)
+			recycler.Release(buffer);
+
+		recycler.Retire(nullptr);
+		scene.clear();
+
+		load(scene);
+	});
+
+	for (const auto& buffer : scene)
+		recycler.Release(buffer);
+
+	recycler.Retire(nullptr);
+
+	std::vector<BufferConfig> drain;
+
+	for (vk::DeviceSize size : classes)
+		drain.push_back(MakeConfig(size, sVertexUsage));
+
+	Drain(recycler, drain);
+
+	std::cout << "\tbuffer creations over two loads: " << coldAllocations << " cold, "
+		<< pooledAllocations << " pooled (" << seconds * 1e3 << " ms of recycler bookkeeping)" << std::endl;
+}
@@ -0,0 +1,103 @@
+outputDir = "%{cfg.buildcfg}/%{cfg.architecture}"
+
+project "Tests"
+	location ""
+	kind "ConsoleApp"
+	language "C++"
+
+	targetdir ("../out/bin/" .. outputDir .. "/%{prj.name}")
+    objdir ("../out/int/" .. outputDir .. "/%{prj.name}")
+    flags {"MultiProcessorCompile"}
+
+	files
+	{
+		"%{prj.location}/**.h",
+		"%{prj.location}/**.cpp",
+		"%{prj.location}/**.lua",
+	}
+
+	includedirs
+	{
+        -- VulkanLibrary
+        "%{prj.location}/../VulkanLibrary/Include/",
+		"%{prj.location}/../VulkanLibrary/Dependencies/Include/",
+	}
+
+    libdirs
+    {
+    	"%{prj.location}/../Aqua/Dependencies/lib/",
+    }
+
+    links
+    {
+        "VulkanLibrary",
+        "vulkan-1.lib",
+    }
+
+    defines
+    {
+        "VKLIB_BUILD_DLL",
+    }
+
+    filter "toolset:msc*"
+        linkoptions { "/IGNORE:4099" }
+
+		filter "system:windows"
+        cppdialect "C++23"
+        staticruntime "On"
+        systemversion "10.0"
+
+        defines
+        {
+            "_CONSOLE",
+            "WIN32",
+        }
+
+        filter "configurations:Debug"
+            defines 
+            {
+                "_DEBUG"
+            }
+
+            links
+            {
+                "Vulkan/glslangd.lib",
+                "Vulkan/GenericCodeGend.lib",
+                "Vulkan/glslang-default-resource-limitsd.lib",
+                "Vulkan/SPIRVd.lib",
+                "Vulkan/SPIRV-Toolsd.lib",
+                "Vulkan/SPIRV-Tools-linkd.lib",
+                "Vulkan/SPIRV-Tools-optd.lib",
+                "Vulkan/spirv-cross-cored.lib",
+                "Vulkan/spirv-cross-glsld.lib",
+                "Vulkan/OSDependentd.lib",
+                "Vulkan/MachineIndependentd.lib",
+            }
+
+            inlining "Disabled"
+            symbols "On"
+            staticruntime "Off"
+            runtime "Debug"
+
+        filter "configurations:Release"
+
+            links
+            {
+                "Vulkan/glslang.lib",
+                "Vulkan/GenericCodeGen.lib",
+                "Vulkan/glslang-default-resource-limits.lib",
+                "Vulkan/SPIRV.lib",
+                "Vulkan/SPIRV-Tools.lib",
+                "Vulkan/SPIRV-Tools-link.lib",
+                "Vulkan/SPIRV-Tools-opt.lib",
+                "Vulkan/spirv-cross-core.lib",
+                "Vulkan/spirv-cross-glsl.lib",
+                "Vulkan/OSDependent.lib",
+                "Vulkan/MachineIndependent.lib",
+            }
+
+            defines "NDEBUG"
+            optimize "Full"
+            inlining "Auto"
+            staticruntime "Off"
+            runtime "Release"
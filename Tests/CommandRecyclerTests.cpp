@@ -0,0 +1,431 @@
+#include "TestRunner.h"
+#include "Process/CommandRecycler.h"
+
+namespace
+{
+	using vkLib::Core::MockCommandBackend;
+	using vkLib::Core::MockCommandRecycler;
+
+	constexpr auto sPrimary = vk::CommandBufferLevel::ePrimary;
+	constexpr auto sSecondary = vk::CommandBufferLevel::eSecondary;
+
+	// the queue the recycler's buffers are submitted to, every frame gets a fence
+	// which the GPU signals in submission order once it's a few frames behind the CPU
+	class FenceTimeline
+	{
+	public:
+		FenceTimeline(MockCommandBackend backend, uint32_t latency)
+			: mBackend(std::move(backend)), mLatency(latency) {}
+
+		MockCommandBackend::FenceType Submit()
+		{
+			auto fence = mBackend.CreateFence();
+			mPending.push_back(fence);
+
+			while (mPending.size() > mLatency)
+			{
+				mBackend.Signal(mPending.front());
+				mPending.pop_front();
+			}
+
+			return fence;
+		}
+
+		void Drain()
+		{
+			for (auto fence : mPending)
+				mBackend.Signal(fence);
+
+			mPending.clear();
+		}
+
+	private:
+		MockCommandBackend mBackend;
+		std::deque<MockCommandBackend::FenceType> mPending;
+		uint32_t mLatency = 0;
+	};
+
+	// one frame of the renderer, count buffers acquired on the calling thread
+	std::vector<uint64_t> RecordFrame(MockCommandRecycler& recycler, FenceTimeline& timeline, uint32_t count)
+	{
+		recycler.BeginFrame();
+
+		std::vector<uint64_t> buffers;
+
+		for (uint32_t i = 0; i < count; i++)
+			buffers.push_back(recycler.Acquire());
+
+		recycler.EndFrame(timeline.Submit());
+
+		return buffers;
+	}
+}
+
+TEST(CommandRecycler, WarmFramesDontAllocate)
+{
+	MockCommandBackend backend;
+	FenceTimeline timeline(backend, 2);
+
+	{
+		MockCommandRecycler recycler(backend, 3);
+
+		for (uint32_t frame = 0; frame < 3; frame++)
+			RecordFrame(recycler, timeline, 4);
+
+		// one pool and four buffers per frame in flight
+		CHECK_EQ(backend.GetCounters().PoolsCreated, uint64_t(3));
+		CHECK_EQ(backend.GetCounters().BuffersAllocated, uint64_t(12));
+
+		for (uint32_t frame = 0; frame < 100; frame++)
+			RecordFrame(recycler, timeline, 4);
+
+		auto counters = backend.GetCounters();
+
+		CHECK_EQ(counters.PoolsCreated, uint64_t(3));
+		CHECK_EQ(counters.BuffersAllocated, uint64_t(12));
+
+		// every frame after the first round resets its pool as a whole
+		CHECK_EQ(counters.PoolResets, uint64_t(100));
+
+		auto stats = recycler.GetStats();
+
+		CHECK_EQ(stats.Frames, uint64_t(103));
+		CHECK_EQ(stats.PoolResets, uint64_t(100));
+		CHECK_EQ(stats.Threads, size_t(1));
+
+		timeline.Drain();
+	}
+
+	// the pools die with the recycler
+	CHECK_EQ(backend.GetCounters().PoolsDestroyed, uint64_t(3));
+}
+
+TEST(CommandRecycler, FrameSlotHandsOutTheSameBuffers)
+{
+	MockCommandBackend backend;
+	FenceTimeline timeline(backend, 1);
+	MockCommandRecycler recycler(backend, 2);
+
+	auto first = RecordFrame(recycler, timeline, 3);
+	auto second = RecordFrame(recycler, timeline, 3);
+
+	// frames in flight never share a buffer
+	for (auto buffer : first)
+		CHECK(std::ranges::find(second, buffer) == second.end());
+
+	// the slot comes around again, its buffers are reset and reused in order
+	CHECK(RecordFrame(recycler, timeline, 3) == first);
+	CHECK(RecordFrame(recycler, timeline, 3) == second);
+
+	// a busier frame grows the slot's cache, a quieter one uses a prefix of it
+	auto busy = RecordFrame(recycler, timeline, 5);
+
+	CHECK(std::ranges::equal(std::span(busy).first(3), first));
+	CHECK(RecordFrame(recycler, timeline, 1)[0] == second[0]);
+	CHECK(RecordFrame(recycler, timeline, 5) == busy);
+
+	timeline.Drain();
+}
+
+TEST(CommandRecycler, LevelsHaveTheirOwnCache)
+{
+	MockCommandBackend backend;
+	FenceTimeline timeline(backend, 0);
+	MockCommandRecycler recycler(backend, 1);
+
+	recycler.BeginFrame();
+	auto primary = recycler.Acquire(sPrimary);
+	auto secondary = recycler.Acquire(sSecondary);
+	recycler.EndFrame(timeline.Submit());
+
+	recycler.BeginFrame();
+
+	// asking for the other level first still doesn't cross the caches
+	CHECK(recycler.Acquire(sSecondary) == secondary);
+	CHECK(recycler.Acquire(sPrimary) == primary);
+
+	recycler.EndFrame(timeline.Submit());
+}
+
+TEST(CommandRecycler, UntouchedFramesArentReset)
+{
+	MockCommandBackend backend;
+	FenceTimeline timeline(backend, 0);
+	MockCommandRecycler recycler(backend, 2);
+
+	RecordFrame(recycler, timeline, 1);
+	RecordFrame(recycler, timeline, 0);
+	RecordFrame(recycler, timeline, 0);
+	RecordFrame(recycler, timeline, 0);
+
+	// the first slot was reset once when it came around after recording, then stayed empty
+	CHECK_EQ(backend.GetCounters().PoolResets, uint64_t(1));
+	CHECK_EQ(recycler.GetStats().FenceWaits, uint64_t(0));
+}
+
+TEST(CommandRecycler, BeginFrameWaitsForTheFence)
+{
+	MockCommandBackend backend;
+	MockCommandRecycler recycler(backend, 1);
+
+	auto fence = backend.CreateFence();
+
+	recycler.BeginFrame();
+	auto buffer = recycler.Acquire();
+	recycler.EndFrame(fence);
+
+	std::atomic<bool> signaled = false;
+
+	std::thread gpu([&]()
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+		signaled = true;
+		backend.Signal(fence);
+	});
+
+	// the slot's buffers may still be executing, no reset before the fence
+	recycler.BeginFrame();
+	bool resetAfterSignal = signaled;
+
+	gpu.join();
+
+	CHECK(resetAfterSignal);
+	CHECK_EQ(recycler.GetStats().FenceWaits, uint64_t(1));
+	CHECK_EQ(backend.GetCounters().PoolResets, uint64_t(1));
+	CHECK(recycler.Acquire() == buffer);
+
+	recycler.EndFrame(backend.CreateFence(true));
+}
+
+TEST(CommandRecycler, DestructorWaitsForPendingFrames)
+{
+	MockCommandBackend backend;
+	auto fence = backend.CreateFence();
+
+	std::atomic<bool> signaled = false;
+	std::thread gpu;
+
+	{
+		MockCommandRecycler recycler(backend, 2);
+
+		recycler.BeginFrame();
+		recycler.Acquire();
+		recycler.EndFrame(fence);
+
+		gpu = std::thread([&]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+			signaled = true;
+			backend.Signal(fence);
+		});
+	}
+
+	bool destroyedAfterSignal = signaled;
+	gpu.join();
+
+	CHECK(destroyedAfterSignal);
+	CHECK_EQ(backend.GetCounters().PoolsDestroyed, uint64_t(1));
+}
+
+TEST(CommandRecycler, ThreadsOwnTheirPools)
+{
+	constexpr uint32_t sThreads = 4;
+	constexpr uint32_t sBuffersPerThread = 8;
+	constexpr uint32_t sFrames = 20;
+
+	MockCommandBackend backend;
+	FenceTimeline timeline(backend, 1);
+	MockCommandRecycler recycler(backend, 2);
+
+	bool disjoint = true;
+
+	for (uint32_t frame = 0; frame < sFrames; frame++)
+	{
+		recycler.BeginFrame();
+
+		// the wavefront executor records its passes on a worker per pass
+		std::vector<std::vector<uint64_t>> acquired(sThreads);
+		std::vector<std::thread> threads;
+
+		for (uint32_t t = 0; t < sThreads; t++)
+		{
+			threads.emplace_back([&, t]()
+			{
+				for (uint32_t i = 0; i < sBuffersPerThread; i++)
+					acquired[t].push_back(recycler.Acquire());
+			});
+		}
+
+		for (auto& thread : threads)
+			thread.join();
+
+		recycler.EndFrame(timeline.Submit());
+
+		// no thread got a buffer another thread got in the same frame
+		std::set<uint64_t> frameBuffers;
+
+		for (const auto& buffers : acquired)
+			frameBuffers.insert(buffers.begin(), buffers.end());
+
+		disjoint &= frameBuffers.size() == size_t(sThreads * sBuffersPerThread);
+	}
+
+	timeline.Drain();
+
+	CHECK(disjoint);
+
+	// one pool per thread and frame slot at most, however many threads came and went
+	auto stats = recycler.GetStats();
+
+	CHECK(stats.Threads >= sThreads);
+	CHECK(backend.GetCounters().PoolsCreated <= stats.Threads * 2);
+}
+
+TEST(CommandRecycler, LongLivedThreadsStayWarm)
+{
+	constexpr uint32_t sThreads = 3;
+	constexpr uint32_t sFrames = 50;
+
+	MockCommandBackend backend;
+	FenceTimeline timeline(backend, 1);
+	MockCommandRecycler recycler(backend, 2);
+
+	// persistent workers recording one buffer per frame, the main thread drives the frames
+	std::atomic<uint32_t> frameStarted = 0;
+	std::atomic<uint32_t> recorded = 0;
+	std::atomic<uint32_t> mismatches = 0;
+
+	std::vector<std::thread> workers;
+
+	for (uint32_t t = 0; t < sThreads; t++)
+	{
+		workers.emplace_back([&]()
+		{
+			std::vector<uint64_t> previous(2);
+
+			for (uint32_t frame = 1; frame <= sFrames; frame++)
+			{
+				while (frameStarted.load() < frame)
+					std::this_thread::yield();
+
+				uint64_t buffer = recycler.Acquire();
+
+				// the same slot hands the same buffer back to the same thread
+				if (frame > 2 && previous[frame % 2] != buffer)
+					mismatches++;
+
+				previous[frame % 2] = buffer;
+				recorded++;
+			}
+		});
+	}
+
+	for (uint32_t frame = 1; frame <= sFrames; frame++)
+	{
+		recycler.BeginFrame();
+		frameStarted = frame;
+
+		while (recorded.load() < frame * sThreads)
+			std::this_thread::yield();
+
+		recycler.EndFrame(timeline.Submit());
+	}
+
+	for (auto& worker : workers)
+		worker.join();
+
+	timeline.Drain();
+
+	auto counters = backend.GetCounters();
+
+	CHECK_EQ(mismatches.load(), uint32_t(0));
+	CHECK_EQ(counters.PoolsCreated, uint64_t(sThreads * 2));
+	CHECK_EQ(counters.BuffersAllocated, uint64_t(sThreads * 2));
+}
+
+TEST(CommandRecycler, RecyclersDontShareThreadSets)
+{
+	MockCommandBackend backend;
+	FenceTimeline timeline(backend, 0);
+
+	MockCommandRecycler first(backend, 1);
+	MockCommandRecycler second(backend, 1);
+
+	first.BeginFrame();
+	second.BeginFrame();
+
+	// alternating between both on the same thread, each keeps its own pool and buffers
+	auto a = first.Acquire();
+	auto b = second.Acquire();
+
+	first.EndFrame(timeline.Submit());
+	second.EndFrame(timeline.Submit());
+
+	CHECK(a != b);
+	CHECK_EQ(backend.GetCounters().PoolsCreated, uint64_t(2));
+
+	first.BeginFrame();
+	second.BeginFrame();
+
+	CHECK(second.Acquire() == b);
+	CHECK(first.Acquire() == a);
+
+	first.EndFrame(timeline.Submit());
+	second.EndFrame(timeline.Submit());
+}
+
+BENCHMARK(CommandRecycler, AcquisitionCost)
+{
+	constexpr uint32_t sFrames = 2000;
+	constexpr uint32_t sBuffersPerFrame = 32;
+
+	MockCommandBackend backend;
+	FenceTimeline timeline(backend, 2);
+	MockCommandRecycler recycler(backend, 3);
+
+	uint64_t sum = 0;
+
+	double recycled = Tests::MeasureSeconds([&]()
+	{
+		for (uint32_t frame = 0; frame < sFrames; frame++)
+		{
+			recycler.BeginFrame();
+
+			for (uint32_t i = 0; i < sBuffersPerFrame; i++)
+				sum += recycler.Acquire();
+
+			recycler.EndFrame(timeline.Submit());
+		}
+	});
+
+	timeline.Drain();
+
+	// the one time process path, a locked shared pool allocating a buffer per use
+	// the mock allocates for free, a driver's vkAllocateCommandBuffers comes on top of every one of them
+	std::mutex poolLock;
+	MockCommandBackend onDemand;
+	auto pool = onDemand.CreatePool();
+
+	double allocated = Tests::MeasureSeconds([&]()
+	{
+		for (uint32_t frame = 0; frame < sFrames; frame++)
+		{
+			for (uint32_t i = 0; i < sBuffersPerFrame; i++)
+			{
+				std::scoped_lock locker(poolLock);
+				sum += onDemand.Allocate(pool, sPrimary);
+			}
+		}
+	});
+
+	Tests::DoNotOptimize(sum);
+
+	constexpr double sAcquires = double(sFrames) * sBuffersPerFrame;
+
+	std::cout << "\trecycled: " << recycled * 1e9 / sAcquires << " ns per buffer ("
+		<< backend.GetCounters().BuffersAllocated << " allocations), locked pool: "
+		<< allocated * 1e9 / sAcquires << " ns per buffer (" << onDemand.GetCounters().BuffersAllocated
+		<< " allocations)" << std::endl;
+}
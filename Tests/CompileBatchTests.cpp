@@ -0,0 +1,164 @@
+#include "ShaderTestUtils.h"
+
+namespace
+{
+	// a compute shader whose group size and body depend on index, so every entry compiles to its own SPIR-V
+	vkLib::ShaderInput MakeComputeInput(uint32_t index)
+	{
+		std::string source =
+			"#version 440\n"
+			"layout(local_size_x = " + std::to_string(32 + index) + ") in;\n"
+			"layout(std430, set = 0, binding = 0) buffer Values { uint sValues[]; };\n"
+			"void main() { sValues[gl_GlobalInvocationID.x] += " + std::to_string(index) + "u; }\n";
+
+		return { source, vk::ShaderStageFlagBits::eCompute, "", vkLib::OptimizerFlag::eO3 };
+	}
+
+	vkLib::ShaderInput MakeBrokenInput(uint32_t index)
+	{
+		std::string source =
+			"#version 440\n"
+			"layout(local_size_x = 1) in;\n"
+			"void main() { undeclared" + std::to_string(index) + " = 1; }\n";
+
+		return { source, vk::ShaderStageFlagBits::eCompute, "", vkLib::OptimizerFlag::eNone };
+	}
+
+	// the Assets shaders a single environment can batch, the permutations carry their own macros
+	std::vector<vkLib::ShaderInput> CollectUnmacroedAssetInputs()
+	{
+		std::vector<vkLib::ShaderInput> inputs;
+
+		for (auto& shader : Tests::CollectAssetShaders())
+		{
+			if (shader.Macros.empty())
+				inputs.push_back(std::move(shader.Input));
+		}
+
+		return inputs;
+	}
+
+	void CheckSameResult(const vkLib::CompileResult& batched, const vkLib::CompileResult& serial)
+	{
+		CHECK(batched.Error.Type == serial.Error.Type);
+		CHECK(batched.SPIR_V.ByteCode == serial.SPIR_V.ByteCode);
+		CHECK(batched.SPIR_V.Stage == serial.SPIR_V.Stage);
+		CHECK(batched.MetaData.WorkGroupSize == serial.MetaData.WorkGroupSize);
+		CHECK_EQ(batched.LayoutData.DescInfos.size(), serial.LayoutData.DescInfos.size());
+		CHECK_EQ(batched.LayoutData.PushConstantsData.size(), serial.LayoutData.PushConstantsData.size());
+		CHECK_EQ(batched.SetLayoutBindingsMap.size(), serial.SetLayoutBindingsMap.size());
+	}
+}
+
+TEST(CompileBatch, EmptyBatch)
+{
+	auto env = Tests::MakeIsolatedEnvironment();
+
+	CHECK(vkLib::ShaderCompiler(env).CompileBatch({}, 4).empty());
+}
+
+TEST(CompileBatch, MatchesSerialCompilation)
+{
+	auto inputs = CollectUnmacroedAssetInputs();
+	CHECK(!inputs.empty());
+
+	// separate environments, the reflection cache of the first run must not serve the second
+	auto serialEnv = Tests::MakeIsolatedEnvironment();
+	std::vector<vkLib::CompileResult> serial;
+
+	for (const auto& input : inputs)
+		serial.push_back(vkLib::ShaderCompiler(serialEnv).Compile(input));
+
+	for (uint32_t threads : { 1u, 2u, 4u })
+	{
+		auto batchEnv = Tests::MakeIsolatedEnvironment();
+		auto batched = vkLib::ShaderCompiler(batchEnv).CompileBatch(inputs, threads);
+
+		CHECK_EQ(batched.size(), serial.size());
+
+		for (size_t i = 0; i < inputs.size(); i++)
+		{
+			CHECK(serial[i].Error.Type == vkLib::ErrorType::eNone);
+			CheckSameResult(batched[i], serial[i]);
+		}
+	}
+}
+
+TEST(CompileBatch, KeepsSubmissionOrderAndErrors)
+{
+	std::vector<vkLib::ShaderInput> inputs;
+
+	// every third entry fails, each with an error naming its own identifier
+	for (uint32_t i = 0; i < 24; i++)
+		inputs.push_back(i % 3 == 2 ? MakeBrokenInput(i) : MakeComputeInput(i));
+
+	auto env = Tests::MakeIsolatedEnvironment();
+	auto results = vkLib::ShaderCompiler(env).CompileBatch(inputs, 4);
+
+	CHECK_EQ(results.size(), inputs.size());
+
+	for (uint32_t i = 0; i < inputs.size(); i++)
+	{
+		const auto& result = results[i];
+
+		if (i % 3 == 2)
+		{
+			CHECK(result.Error.Type != vkLib::ErrorType::eNone);
+			CHECK(result.SPIR_V.ByteCode.empty());
+			CHECK(result.Error.Info.find("undeclared" + std::to_string(i)) != std::string::npos);
+			continue;
+		}
+
+		CHECK(result.Error.Type == vkLib::ErrorType::eNone);
+		CHECK_EQ(result.MetaData.WorkGroupSize.x, 32 + i);
+		CHECK(result.SPIR_V.ByteCode == vkLib::ShaderCompiler(env).Compile(inputs[i]).SPIR_V.ByteCode);
+	}
+}
+
+TEST(CompileBatch, MoreThreadsThanInputs)
+{
+	std::vector<vkLib::ShaderInput> inputs = { MakeComputeInput(0), MakeComputeInput(1) };
+
+	auto env = Tests::MakeIsolatedEnvironment();
+	auto results = vkLib::ShaderCompiler(env).CompileBatch(inputs, 16);
+
+	CHECK_EQ(results.size(), size_t(2));
+	CHECK_EQ(results[0].MetaData.WorkGroupSize.x, uint32_t(32));
+	CHECK_EQ(results[1].MetaData.WorkGroupSize.x, uint32_t(33));
+}
+
+BENCHMARK(CompileBatch, ThreadScaling)
+{
+	auto inputs = CollectUnmacroedAssetInputs();
+
+	// enough work for the threads to overlap even with few Assets shaders
+	for (uint32_t i = 0; i < 32; i++)
+		inputs.push_back(MakeComputeInput(i));
+
+	uint32_t hardware = std::max(std::thread::hardware_concurrency(), 1u);
+
+	std::vector<uint32_t> threadCounts = { 1, 2, 4, 8 };
+	std::erase_if(threadCounts, [hardware](uint32_t count) { return count > hardware; });
+
+	if (threadCounts.back() != hardware)
+		threadCounts.push_back(hardware);
+
+	double single = 0.0;
+
+	for (uint32_t threads : threadCounts)
+	{
+		// a fresh reflection cache every run, none of the runs is served by another
+		auto env = Tests::MakeIsolatedEnvironment();
+
+		std::vector<vkLib::CompileResult> results;
+		double seconds = Tests::MeasureSeconds([&]() { results = vkLib::ShaderCompiler(env).CompileBatch(inputs, threads); });
+
+		Tests::DoNotOptimize(results);
+
+		if (threads == 1)
+			single = seconds;
+
+		std::cout << "\t" << inputs.size() << " shaders on " << threads << " threads: " << seconds * 1e3 << " ms ("
+			<< single / seconds << "x)" << std::endl;
+	}
+}
@@ -0,0 +1,418 @@
+#include "ShaderTestUtils.h"
+#include "ShaderCompiler/CompileStats.h"
+
+namespace
+{
+	using namespace std::chrono_literals;
+
+	using vkLib::CompilePhase;
+	using vkLib::CompileRecord;
+	using vkLib::CompileSource;
+	using vkLib::CompileStatsRegistry;
+
+	constexpr size_t sParse = static_cast<size_t>(CompilePhase::eParse);
+	constexpr size_t sLink = static_cast<size_t>(CompilePhase::eLink);
+
+	CompileRecord MakeRecord(const std::string& name, uint64_t permutation, std::chrono::nanoseconds parse,
+		std::chrono::nanoseconds link)
+	{
+		CompileRecord record;
+		record.Name = name;
+		record.Stage = vk::ShaderStageFlagBits::eFragment;
+		record.PermutationHash = permutation;
+		record.Succeeded = true;
+		record.Phases[sParse] = parse;
+		record.Phases[sLink] = link;
+		record.Total = parse + link;
+		record.SourceSize = 100;
+		record.SPIRVSize = 400;
+		record.UnoptimizedInstructions = 50;
+		record.Instructions = 40;
+
+		return record;
+	}
+
+	// splits a CSV line, quoted fields may hold commas and doubled quotes
+	std::vector<std::string> SplitCSV(const std::string& line)
+	{
+		std::vector<std::string> fields(1);
+		bool quoted = false;
+
+		for (size_t i = 0; i < line.size(); i++)
+		{
+			if (line[i] == '"' && quoted && i + 1 < line.size() && line[i + 1] == '"')
+				fields.back() += line[++i];
+			else if (line[i] == '"')
+				quoted = !quoted;
+			else if (line[i] == ',' && !quoted)
+				fields.emplace_back();
+			else
+				fields.back() += line[i];
+		}
+
+		return fields;
+	}
+
+	// the brackets pair up outside of the strings and no string runs past its line
+	bool IsBalancedJSON(const std::string& json)
+	{
+		std::string open;
+		bool inString = false;
+
+		for (size_t i = 0; i < json.size(); i++)
+		{
+			char val = json[i];
+
+			if (inString)
+			{
+				if (val == '\\')
+					i++;
+				else if (val == '"')
+					inString = false;
+				else if (val == '\n')
+					return false;
+
+				continue;
+			}
+
+			if (val == '"')
+				inString = true;
+			else if (val == '{' || val == '[')
+				open += val;
+			else if (val == '}' || val == ']')
+			{
+				if (open.empty() || open.back() != (val == '}' ? '{' : '['))
+					return false;
+
+				open.pop_back();
+			}
+		}
+
+		return open.empty() && !inString;
+	}
+}
+
+TEST(CompileStats, FoldsRecordsPerPermutation)
+{
+	CompileStatsRegistry registry;
+
+	registry.Record(MakeRecord("A.frag", 1, 2ms, 1ms));
+	registry.Record(MakeRecord("A.frag", 1, 6ms, 1ms));
+
+	// another permutation and another stage of the same file are summaries of their own
+	registry.Record(MakeRecord("A.frag", 2, 1ms, 1ms));
+
+	auto vertex = MakeRecord("A.frag", 1, 1ms, 0ms);
+	vertex.Stage = vk::ShaderStageFlagBits::eVertex;
+	vertex.Succeeded = false;
+	registry.Record(vertex);
+
+	auto cached = MakeRecord("A.frag", 1, 0ms, 0ms);
+	cached.Source = CompileSource::eCache;
+	cached.UnoptimizedInstructions = 0;
+	cached.Instructions = 0;
+	registry.Record(cached);
+
+	auto archived = cached;
+	archived.Source = CompileSource::eArchive;
+	registry.Record(archived);
+
+	auto summaries = registry.GetSummaries();
+
+	CHECK_EQ(summaries.size(), size_t(3));
+	CHECK_EQ(registry.GetCompilationCount(), uint64_t(6));
+
+	const auto& folded = summaries[0];
+
+	CHECK(folded.Name == "A.frag" && folded.PermutationHash == 1);
+	CHECK(folded.Stage == vk::ShaderStageFlagBits::eFragment);
+	CHECK_EQ(folded.Compilations, uint64_t(4));
+	CHECK_EQ(folded.Failures, uint64_t(0));
+	CHECK_EQ(folded.CacheHits, uint64_t(1));
+	CHECK_EQ(folded.ArchiveHits, uint64_t(1));
+	CHECK(folded.Phases[sParse] == 8ms && folded.Phases[sLink] == 2ms);
+	CHECK(folded.Total == 10ms && folded.Slowest == 7ms);
+
+	// the hits carry no instruction counts, the last real compilation's stay
+	CHECK_EQ(folded.UnoptimizedInstructions, size_t(50));
+	CHECK_EQ(folded.Instructions, size_t(40));
+
+	// the largest total first, ties keep the key order
+	CHECK(summaries[1].Total == 2ms && summaries[2].Total == 1ms);
+	CHECK(summaries[2].Stage == vk::ShaderStageFlagBits::eVertex);
+	CHECK_EQ(summaries[2].Failures, uint64_t(1));
+
+	auto totals = registry.GetPhaseTotals();
+
+	CHECK(totals[sParse] == 10ms && totals[sLink] == 3ms);
+
+	registry.Clear();
+
+	CHECK(registry.GetSummaries().empty());
+	CHECK_EQ(registry.GetCompilationCount(), uint64_t(0));
+	CHECK(registry.GetPhaseTotals()[sParse] == 0ns);
+}
+
+TEST(CompileStats, SlowLogIsBounded)
+{
+	CompileStatsRegistry registry;
+
+	// no threshold, no slow log
+	registry.Record(MakeRecord("Slow.comp", 1, 1s, 0ms));
+
+	CHECK(registry.GetSlowCompiles().empty());
+
+	std::vector<std::string> handled;
+
+	// the handler may query the registry, it runs outside of the lock
+	registry.SetSlowCompileThreshold(5ms, [&](const CompileRecord& record)
+	{
+		handled.push_back(record.Name);
+		CHECK(!registry.GetSummaries().empty());
+	});
+
+	registry.Record(MakeRecord("Fast.comp", 1, 4ms, 0ms));
+	registry.Record(MakeRecord("Edge.comp", 1, 5ms, 0ms));
+
+	CHECK(handled == std::vector<std::string>{ "Edge.comp" });
+
+	for (size_t i = 0; i < CompileStatsRegistry::sMaxSlowRecords + 10; i++)
+		registry.Record(MakeRecord("Slow" + std::to_string(i), 1, 6ms, 0ms));
+
+	auto slow = registry.GetSlowCompiles();
+
+	// the latest records stay
+	CHECK_EQ(slow.size(), CompileStatsRegistry::sMaxSlowRecords);
+	CHECK(slow.back().Name == "Slow" + std::to_string(CompileStatsRegistry::sMaxSlowRecords + 9));
+	CHECK(slow.front().Name == "Slow10");
+	CHECK_EQ(handled.size(), CompileStatsRegistry::sMaxSlowRecords + 11);
+
+	// clearing empties the log but keeps the threshold
+	registry.Clear();
+	registry.Record(MakeRecord("Again.comp", 1, 6ms, 0ms));
+
+	CHECK_EQ(registry.GetSlowCompiles().size(), size_t(1));
+
+	registry.SetSlowCompileThreshold(0ns);
+	registry.Record(MakeRecord("Off.comp", 1, 1s, 0ms));
+
+	CHECK_EQ(registry.GetSlowCompiles().size(), size_t(1));
+}
+
+TEST(CompileStats, WritesCSV)
+{
+	CompileStatsRegistry registry;
+
+	auto quoted = MakeRecord("Shaders/A,\"x\".frag", 0xabc, 1500us, 0us);
+	quoted.Macros = "COUNT=4;NAME=a,b";
+	registry.Record(quoted);
+	registry.Record(MakeRecord("B.frag", 1, 1ms, 0us));
+
+	std::ostringstream stream;
+	registry.WriteCSV(stream);
+
+	std::istringstream lines(stream.str());
+	std::string line;
+	std::vector<std::vector<std::string>> rows;
+
+	while (std::getline(lines, line))
+		rows.push_back(SplitCSV(line));
+
+	CHECK_EQ(rows.size(), size_t(3));
+
+	const auto& header = rows[0];
+
+	for (const auto& row : rows)
+		CHECK_EQ(row.size(), header.size());
+
+	auto column = [&header](const std::string& name)
+	{
+		auto found = std::ranges::find(header, name);
+		CHECK(found != header.end());
+
+		return static_cast<size_t>(found - header.begin());
+	};
+
+	// the slowest permutation first, the escaped fields read back unchanged
+	CHECK(rows[1][column("Name")] == "Shaders/A,\"x\".frag");
+	CHECK(rows[1][column("Macros")] == "COUNT=4;NAME=a,b");
+	CHECK(rows[1][column("Permutation")] == "0000000000000abc");
+	CHECK(rows[1][column("Stage")] == vk::to_string(vk::ShaderStageFlagBits::eFragment));
+	CHECK(rows[1][column("ParseUs")] == "1500.0");
+	CHECK(rows[1][column("TotalUs")] == "1500.0");
+	CHECK(rows[1][column("SPIRVBytes")] == "400");
+	CHECK(rows[2][column("Name")] == "B.frag");
+	CHECK(rows[2][column("Compilations")] == "1");
+}
+
+TEST(CompileStats, WritesJSON)
+{
+	CompileStatsRegistry registry;
+
+	{
+		std::ostringstream stream;
+		registry.WriteJSON(stream);
+
+		CHECK(IsBalancedJSON(stream.str()));
+		CHECK(stream.str().find("\"Permutations\": []") != std::string::npos);
+		CHECK(stream.str().find("\"SlowCompiles\": []") != std::string::npos);
+	}
+
+	registry.SetSlowCompileThreshold(1ms);
+
+	auto path = MakeRecord("C:\\Shaders\\\"Odd\"\n.frag", 7, 2ms, 0ms);
+	path.Macros = std::string("TAB=\t;BELL=") + '\a';
+	path.Source = CompileSource::eCache;
+	registry.Record(path);
+	registry.Record(MakeRecord("B.frag", 1, 500us, 0ms));
+
+	std::ostringstream stream;
+	registry.WriteJSON(stream);
+
+	auto json = stream.str();
+
+	CHECK(IsBalancedJSON(json));
+	CHECK(json.find("\"Compilations\": 2") != std::string::npos);
+	CHECK(json.find("\"Name\": \"C:\\\\Shaders\\\\\\\"Odd\\\"\\n.frag\"") != std::string::npos);
+	CHECK(json.find("\"Macros\": \"TAB=\\t;BELL=\\u0007\"") != std::string::npos);
+	CHECK(json.find("\"Parse\": 2000.0") != std::string::npos);
+	CHECK(json.find("\"Source\": \"Cache\"") != std::string::npos);
+
+	// only the first compilation is slow
+	auto slowCompiles = json.substr(json.find("\"SlowCompiles\""));
+
+	CHECK(slowCompiles.find("Odd") != std::string::npos);
+	CHECK(slowCompiles.find("B.frag") == std::string::npos);
+}
+
+TEST(CompileStats, ConcurrentRecords)
+{
+	CompileStatsRegistry registry;
+
+	constexpr uint32_t sThreads = 4;
+	constexpr uint32_t sRecords = 1000;
+
+	std::atomic<uint32_t> handled = 0;
+	registry.SetSlowCompileThreshold(3ms, [&handled](const CompileRecord&) { handled++; });
+
+	std::vector<std::thread> threads;
+
+	for (uint32_t t = 0; t < sThreads; t++)
+	{
+		threads.emplace_back([&registry, t]()
+		{
+			for (uint32_t i = 0; i < sRecords; i++)
+				registry.Record(MakeRecord("Shader" + std::to_string(i % 8), t, std::chrono::milliseconds(i % 4), 0ms));
+		});
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	CHECK_EQ(registry.GetCompilationCount(), uint64_t(sThreads * sRecords));
+	CHECK_EQ(registry.GetSummaries().size(), size_t(8 * sThreads));
+	CHECK_EQ(handled.load(), sThreads * sRecords / 4);
+	CHECK(registry.GetPhaseTotals()[sParse] == std::chrono::milliseconds(sThreads * sRecords / 4 * 6));
+}
+
+TEST(CompileStats, CompilerRecordsPhases)
+{
+	auto shaders = Tests::CollectAssetShaders();
+	CHECK(!shaders.empty());
+
+	auto registry = std::make_shared<CompileStatsRegistry>();
+
+	auto env = Tests::MakeIsolatedEnvironment();
+	env.SetCompileStats(registry);
+
+	const auto& shader = shaders.front();
+	auto result = Tests::CompileAssetShader(env, shader);
+
+	CHECK(result.Error.Type == vkLib::ErrorType::eNone);
+
+	auto summaries = registry->GetSummaries();
+
+	CHECK_EQ(summaries.size(), size_t(1));
+	CHECK(summaries[0].Name == shader.Input.FilePath);
+	CHECK(summaries[0].Stage == shader.Input.Stage);
+	CHECK_EQ(summaries[0].SPIRVSize, result.SPIR_V.ByteCode.size() * sizeof(uint32_t));
+	CHECK(summaries[0].SourceSize > 0);
+	CHECK(summaries[0].Instructions > 0);
+
+	// a real compilation goes through every phase, and none of them outlasts the whole
+	for (size_t phase : { sParse, sLink, static_cast<size_t>(CompilePhase::eReflect) })
+		CHECK(summaries[0].Phases[phase] > 0ns);
+
+	std::chrono::nanoseconds phases{};
+
+	for (auto time : summaries[0].Phases)
+		phases += time;
+
+	CHECK(phases <= summaries[0].Total);
+
+	// failures are recorded as well
+	vkLib::ShaderCompiler(env).Compile({ "#version 440\nvoid main() { broken }\n",
+		vk::ShaderStageFlagBits::eCompute, "", vkLib::OptimizerFlag::eNone });
+
+	CHECK_EQ(registry->GetCompilationCount(), uint64_t(2));
+	CHECK_EQ(registry->GetSummaries().back().Failures, uint64_t(1));
+
+	// without a registry of its own the environment reports to the default
+	auto fallback = std::make_shared<CompileStatsRegistry>();
+	CompileStatsRegistry::SetDefault(fallback);
+
+	Tests::CompileAssetShader(Tests::MakeIsolatedEnvironment(), shader);
+
+	CompileStatsRegistry::SetDefault(nullptr);
+
+	CHECK_EQ(fallback->GetCompilationCount(), uint64_t(1));
+	CHECK_EQ(registry->GetCompilationCount(), uint64_t(2));
+}
+
+BENCHMARK(CompileStats, DisabledOverhead)
+{
+	constexpr uint32_t sIterations = 10'000'000;
+
+	auto perIteration = [](double seconds) { return seconds * 1e9 / sIterations; };
+
+	// what every phase of a compilation pays with and without a record
+	double disabled = Tests::MeasureSeconds([]()
+	{
+		for (uint32_t i = 0; i < sIterations; i++)
+		{
+			vkLib::CompilePhaseTimer timer(nullptr, CompilePhase::eParse);
+			Tests::DoNotOptimize(i);
+		}
+	});
+
+	CompileRecord record;
+
+	double enabled = Tests::MeasureSeconds([&record]()
+	{
+		for (uint32_t i = 0; i < sIterations; i++)
+		{
+			vkLib::CompilePhaseTimer timer(&record, CompilePhase::eParse);
+			Tests::DoNotOptimize(i);
+		}
+	});
+
+	// the lookup every compilation does before deciding to measure
+	double lookup = Tests::MeasureSeconds([]()
+	{
+		for (uint32_t i = 0; i < sIterations; i++)
+			Tests::DoNotOptimize(CompileStatsRegistry::GetDefault());
+	});
+
+	CompileStatsRegistry registry;
+	auto sample = MakeRecord("Shaders/Sample.frag", 1, 1ms, 1ms);
+
+	double recording = Tests::MeasureSeconds([&registry, &sample]()
+	{
+		for (uint32_t i = 0; i < sIterations / 10; i++)
+			registry.Record(sample);
+	});
+
+	std::cout << "\tphase timer disabled: " << perIteration(disabled) << " ns, enabled: " << perIteration(enabled)
+		<< " ns\n\tdefault registry lookup: " << perIteration(lookup) << " ns, Record: "
+		<< perIteration(recording) * 10 << " ns" << std::endl;
+}
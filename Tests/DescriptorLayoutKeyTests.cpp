@@ -0,0 +1,198 @@
+#include "TestRunner.h"
+#include "Descriptors/DescriptorLayoutCache.h"
+
+namespace
+{
+	using vkLib::Core::DescriptorSetLayoutKey;
+	using vkLib::Core::PipelineLayoutKey;
+	using Tests::MakeHandle;
+
+	vk::DescriptorSetLayoutBinding Binding(uint32_t binding, vk::DescriptorType type, uint32_t count = 1,
+		vk::ShaderStageFlags stages = vk::ShaderStageFlagBits::eCompute, const vk::Sampler* samplers = nullptr)
+	{
+		vk::DescriptorSetLayoutBinding layoutBinding{};
+		layoutBinding.binding = binding;
+		layoutBinding.descriptorType = type;
+		layoutBinding.descriptorCount = count;
+		layoutBinding.stageFlags = stages;
+		layoutBinding.pImmutableSamplers = samplers;
+
+		return layoutBinding;
+	}
+
+	vk::PushConstantRange PushRange(uint32_t offset, uint32_t size,
+		vk::ShaderStageFlags stages = vk::ShaderStageFlagBits::eCompute)
+	{
+		vk::PushConstantRange range{};
+		range.stageFlags = stages;
+		range.offset = offset;
+		range.size = size;
+
+		return range;
+	}
+
+	// what the wavefront estimator's compute nodes declare for set 0, every node listing them its own way
+	std::vector<vk::DescriptorSetLayoutBinding> WavefrontBindings()
+	{
+		return {
+			Binding(0, vk::DescriptorType::eStorageBuffer),
+			Binding(1, vk::DescriptorType::eStorageBuffer),
+			Binding(2, vk::DescriptorType::eUniformBuffer),
+			Binding(3, vk::DescriptorType::eCombinedImageSampler, 16),
+		};
+	}
+
+	template <typename Key>
+	struct KeyHasher
+	{
+		size_t operator ()(const Key& key) const { return key.GetHash(); }
+	};
+
+	bool SameKey(const DescriptorSetLayoutKey& left, const DescriptorSetLayoutKey& right)
+	{ return left == right && left.GetHash() == right.GetHash(); }
+
+	bool DifferentKey(const DescriptorSetLayoutKey& left, const DescriptorSetLayoutKey& right)
+	{ return !(left == right) && left.GetHash() != right.GetHash(); }
+}
+
+TEST(DescriptorSetLayoutKey, BindingOrderDoesNotMatter)
+{
+	auto bindings = WavefrontBindings();
+	DescriptorSetLayoutKey reference(bindings);
+
+	std::ranges::sort(bindings, [](const auto& left, const auto& right) { return left.binding < right.binding; });
+
+	do
+	{
+		CHECK(SameKey(DescriptorSetLayoutKey(bindings), reference));
+	} while (std::ranges::next_permutation(bindings, [](const auto& left, const auto& right)
+		{ return left.binding < right.binding; }).found);
+
+	// the key is sorted regardless of the input
+	for (size_t i = 0; i < reference.Bindings.size(); i++)
+		CHECK_EQ(reference.Bindings[i].binding, uint32_t(i));
+}
+
+TEST(DescriptorSetLayoutKey, EveryFieldTakesPart)
+{
+	DescriptorSetLayoutKey reference(WavefrontBindings());
+
+	auto changed = [](auto&& change)
+	{
+		auto bindings = WavefrontBindings();
+		change(bindings[2]);
+
+		return DescriptorSetLayoutKey(bindings);
+	};
+
+	CHECK(DifferentKey(reference, changed([](auto& binding) { binding.binding = 7; })));
+	CHECK(DifferentKey(reference, changed([](auto& binding) { binding.descriptorType = vk::DescriptorType::eStorageBuffer; })));
+	CHECK(DifferentKey(reference, changed([](auto& binding) { binding.descriptorCount = 2; })));
+	CHECK(DifferentKey(reference, changed([](auto& binding)
+		{ binding.stageFlags = vk::ShaderStageFlagBits::eCompute | vk::ShaderStageFlagBits::eRaygenKHR; })));
+
+	auto fewer = WavefrontBindings();
+	fewer.pop_back();
+
+	CHECK(DifferentKey(reference, DescriptorSetLayoutKey(fewer)));
+}
+
+TEST(DescriptorSetLayoutKey, ImmutableSamplersAreCopied)
+{
+	std::array<vk::Sampler, 2> samplers = { MakeHandle<vk::Sampler>(1), MakeHandle<vk::Sampler>(2) };
+
+	DescriptorSetLayoutKey key({ Binding(0, vk::DescriptorType::eCombinedImageSampler, 2,
+		vk::ShaderStageFlagBits::eFragment, samplers.data()) });
+
+	size_t hash = key.GetHash();
+
+	CHECK(key.Bindings[0].pImmutableSamplers == nullptr);
+	CHECK((key.ImmutableSamplers[0] == std::vector<vk::Sampler>{ samplers[0], samplers[1] }));
+
+	// the key no longer looks at the caller's array
+	samplers[0] = MakeHandle<vk::Sampler>(3);
+	CHECK_EQ(key.GetHash(), hash);
+}
+
+TEST(DescriptorSetLayoutKey, ImmutableSamplersStayWithTheirBinding)
+{
+	vk::Sampler sampler = MakeHandle<vk::Sampler>(1);
+	auto type = vk::DescriptorType::eCombinedImageSampler;
+
+	// the same sampler on a different binding is a different layout
+	DescriptorSetLayoutKey onFirst({ Binding(0, type, 1, vk::ShaderStageFlagBits::eFragment, &sampler),
+		Binding(1, type, 1, vk::ShaderStageFlagBits::eFragment) });
+	DescriptorSetLayoutKey onSecond({ Binding(0, type, 1, vk::ShaderStageFlagBits::eFragment),
+		Binding(1, type, 1, vk::ShaderStageFlagBits::eFragment, &sampler) });
+	DescriptorSetLayoutKey none({ Binding(0, type, 1, vk::ShaderStageFlagBits::eFragment),
+		Binding(1, type, 1, vk::ShaderStageFlagBits::eFragment) });
+
+	CHECK(DifferentKey(onFirst, onSecond));
+	CHECK(DifferentKey(onFirst, none));
+	CHECK(DifferentKey(onSecond, none));
+
+	// and they move along with their binding when the order changes
+	DescriptorSetLayoutKey reordered({ Binding(1, type, 1, vk::ShaderStageFlagBits::eFragment),
+		Binding(0, type, 1, vk::ShaderStageFlagBits::eFragment, &sampler) });
+
+	CHECK(SameKey(onFirst, reordered));
+}
+
+TEST(PipelineLayoutKey, PushConstantOrderDoesNotMatter)
+{
+	std::vector<vk::DescriptorSetLayout> sets = { MakeHandle<vk::DescriptorSetLayout>(1), MakeHandle<vk::DescriptorSetLayout>(2) };
+
+	PipelineLayoutKey first(sets, { PushRange(0, 16), PushRange(16, 32, vk::ShaderStageFlagBits::eFragment) });
+	PipelineLayoutKey second(sets, { PushRange(16, 32, vk::ShaderStageFlagBits::eFragment), PushRange(0, 16) });
+
+	CHECK(first == second);
+	CHECK_EQ(first.GetHash(), second.GetHash());
+}
+
+TEST(PipelineLayoutKey, SetOrderMatters)
+{
+	auto first = MakeHandle<vk::DescriptorSetLayout>(1);
+	auto second = MakeHandle<vk::DescriptorSetLayout>(2);
+
+	PipelineLayoutKey ordered({ first, second }, {});
+	PipelineLayoutKey swapped({ second, first }, {});
+
+	CHECK(!(ordered == swapped));
+	CHECK(ordered.GetHash() != swapped.GetHash());
+
+	// nor does a different push constant range hide behind the same sets
+	PipelineLayoutKey pushed({ first, second }, { PushRange(0, 16) });
+
+	CHECK(!(ordered == pushed));
+	CHECK(ordered.GetHash() != pushed.GetHash());
+}
+
+TEST(DescriptorSetLayoutKey, WavefrontPermutationsCollapse)
+{
+	// every permutation of the wavefront bindings, once for the compute nodes and once for the ray tracing ones
+	std::vector<std::vector<vk::DescriptorSetLayoutBinding>> requests;
+
+	for (vk::ShaderStageFlags stages : { vk::ShaderStageFlags(vk::ShaderStageFlagBits::eCompute),
+		vk::ShaderStageFlags(vk::ShaderStageFlagBits::eRaygenKHR) })
+	{
+		auto bindings = WavefrontBindings();
+
+		for (auto& binding : bindings)
+			binding.stageFlags = stages;
+
+		do
+		{
+			requests.push_back(bindings);
+		} while (std::ranges::next_permutation(bindings, [](const auto& left, const auto& right)
+			{ return left.binding < right.binding; }).found);
+	}
+
+	std::unordered_set<DescriptorSetLayoutKey, KeyHasher<DescriptorSetLayoutKey>> layouts;
+
+	for (const auto& bindings : requests)
+		layouts.emplace(bindings);
+
+	// one layout per request before the cache, one per distinct binding set with it
+	CHECK_EQ(requests.size(), size_t(48));
+	CHECK_EQ(layouts.size(), size_t(2));
+}
@@ -0,0 +1,230 @@
+#include "TestRunner.h"
+#include "Descriptors/DescriptorWriter.h"
+
+namespace
+{
+	using vkLib::DescriptorWriteBatch;
+	using Tests::MakeHandle;
+
+	vk::DescriptorBufferInfo BufferInfo(uint64_t buffer, vk::DeviceSize offset = 0, vk::DeviceSize range = 256)
+	{
+		vk::DescriptorBufferInfo info;
+		info.buffer = MakeHandle<vk::Buffer>(buffer);
+		info.offset = offset;
+		info.range = range;
+
+		return info;
+	}
+
+	vk::DescriptorImageInfo ImageInfo(uint64_t view, uint64_t sampler = 0)
+	{
+		vk::DescriptorImageInfo info;
+		info.imageView = MakeHandle<vk::ImageView>(view);
+		info.sampler = MakeHandle<vk::Sampler>(sampler);
+		info.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+
+		return info;
+	}
+
+	const vk::WriteDescriptorSet* FindWrite(const std::vector<vk::WriteDescriptorSet>& writes,
+		vk::DescriptorSet set, uint32_t binding, uint32_t arrayIndex = 0)
+	{
+		for (const auto& write : writes)
+		{
+			if (write.dstSet == set && write.dstBinding == binding && write.dstArrayElement == arrayIndex)
+				return &write;
+		}
+
+		return nullptr;
+	}
+}
+
+TEST(DescriptorWriteBatch, MixedResourceTypes)
+{
+	DescriptorWriteBatch batch;
+	auto set = MakeHandle<vk::DescriptorSet>(1);
+
+	batch.Write(set, 0, 0, vk::DescriptorType::eUniformBuffer, BufferInfo(10, 64, 128));
+	batch.Write(set, 1, 0, vk::DescriptorType::eCombinedImageSampler, ImageInfo(20, 30));
+	batch.Write(set, 2, 0, vk::DescriptorType::eStorageTexelBuffer, MakeHandle<vk::BufferView>(40));
+	batch.Write(set, 3, 0, vk::DescriptorType::eStorageBuffer, BufferInfo(11));
+	batch.Write(set, 4, 0, vk::DescriptorType::eStorageImage, ImageInfo(21));
+
+	CHECK_EQ(batch.GetWriteCount(), size_t(5));
+
+	const auto& writes = batch.Resolve();
+	CHECK_EQ(writes.size(), size_t(5));
+
+	for (const auto& write : writes)
+		CHECK_EQ(write.descriptorCount, 1u);
+
+	// exactly one info pointer per write, pointing at what was written
+	const auto* uniform = FindWrite(writes, set, 0);
+	CHECK(uniform && uniform->descriptorType == vk::DescriptorType::eUniformBuffer);
+	CHECK(uniform->pBufferInfo && !uniform->pImageInfo && !uniform->pTexelBufferView);
+	CHECK(uniform->pBufferInfo->buffer == MakeHandle<vk::Buffer>(10));
+	CHECK_EQ(uniform->pBufferInfo->offset, vk::DeviceSize(64));
+	CHECK_EQ(uniform->pBufferInfo->range, vk::DeviceSize(128));
+
+	const auto* sampler = FindWrite(writes, set, 1);
+	CHECK(sampler && sampler->descriptorType == vk::DescriptorType::eCombinedImageSampler);
+	CHECK(sampler->pImageInfo && !sampler->pBufferInfo && !sampler->pTexelBufferView);
+	CHECK(sampler->pImageInfo->imageView == MakeHandle<vk::ImageView>(20));
+	CHECK(sampler->pImageInfo->sampler == MakeHandle<vk::Sampler>(30));
+	CHECK(sampler->pImageInfo->imageLayout == vk::ImageLayout::eShaderReadOnlyOptimal);
+
+	const auto* texel = FindWrite(writes, set, 2);
+	CHECK(texel && texel->descriptorType == vk::DescriptorType::eStorageTexelBuffer);
+	CHECK(texel->pTexelBufferView && !texel->pBufferInfo && !texel->pImageInfo);
+	CHECK(*texel->pTexelBufferView == MakeHandle<vk::BufferView>(40));
+
+	const auto* storage = FindWrite(writes, set, 3);
+	CHECK(storage && storage->pBufferInfo->buffer == MakeHandle<vk::Buffer>(11));
+
+	const auto* image = FindWrite(writes, set, 4);
+	CHECK(image && image->pImageInfo->imageView == MakeHandle<vk::ImageView>(21));
+}
+
+TEST(DescriptorWriteBatch, LastWriteToALocationWins)
+{
+	DescriptorWriteBatch batch;
+	auto set = MakeHandle<vk::DescriptorSet>(1);
+
+	batch.Write(set, 0, 0, vk::DescriptorType::eStorageBuffer, BufferInfo(10));
+	batch.Write(set, 1, 0, vk::DescriptorType::eStorageBuffer, BufferInfo(11));
+	batch.Write(set, 0, 0, vk::DescriptorType::eStorageBuffer, BufferInfo(12));
+
+	CHECK_EQ(batch.GetWriteCount(), size_t(2));
+
+	const auto& writes = batch.Resolve();
+
+	// the replaced write keeps its place in the list
+	CHECK_EQ(writes[0].dstBinding, 0u);
+	CHECK(writes[0].pBufferInfo->buffer == MakeHandle<vk::Buffer>(12));
+	CHECK(writes[1].pBufferInfo->buffer == MakeHandle<vk::Buffer>(11));
+}
+
+TEST(DescriptorWriteBatch, ReplacingChangesTheInfoKind)
+{
+	DescriptorWriteBatch batch;
+	auto set = MakeHandle<vk::DescriptorSet>(1);
+
+	batch.Write(set, 0, 0, vk::DescriptorType::eStorageBuffer, BufferInfo(10));
+	batch.Write(set, 0, 0, vk::DescriptorType::eSampledImage, ImageInfo(20));
+
+	const auto& writes = batch.Resolve();
+
+	CHECK_EQ(writes.size(), size_t(1));
+	CHECK(writes[0].descriptorType == vk::DescriptorType::eSampledImage);
+	CHECK(writes[0].pImageInfo && !writes[0].pBufferInfo);
+	CHECK(writes[0].pImageInfo->imageView == MakeHandle<vk::ImageView>(20));
+}
+
+TEST(DescriptorWriteBatch, DistinctLocationsStayApart)
+{
+	DescriptorWriteBatch batch;
+	auto first = MakeHandle<vk::DescriptorSet>(1);
+	auto second = MakeHandle<vk::DescriptorSet>(2);
+
+	// same binding, different array element or set
+	batch.Write(first, 0, 0, vk::DescriptorType::eCombinedImageSampler, ImageInfo(20));
+	batch.Write(first, 0, 1, vk::DescriptorType::eCombinedImageSampler, ImageInfo(21));
+	batch.Write(second, 0, 0, vk::DescriptorType::eCombinedImageSampler, ImageInfo(22));
+
+	const auto& writes = batch.Resolve();
+	CHECK_EQ(writes.size(), size_t(3));
+
+	CHECK(FindWrite(writes, first, 0, 0)->pImageInfo->imageView == MakeHandle<vk::ImageView>(20));
+	CHECK(FindWrite(writes, first, 0, 1)->pImageInfo->imageView == MakeHandle<vk::ImageView>(21));
+	CHECK(FindWrite(writes, second, 0, 0)->pImageInfo->imageView == MakeHandle<vk::ImageView>(22));
+}
+
+TEST(DescriptorWriteBatch, InfosSurviveStorageGrowth)
+{
+	constexpr uint32_t sWriteCount = 1000;
+
+	DescriptorWriteBatch batch;
+	auto set = MakeHandle<vk::DescriptorSet>(1);
+
+	// the info vectors reallocate many times before the list is resolved
+	for (uint32_t i = 0; i < sWriteCount; i++)
+	{
+		if (i % 2 == 0)
+			batch.Write(set, i, 0, vk::DescriptorType::eStorageBuffer, BufferInfo(i + 1));
+		else
+			batch.Write(set, i, 0, vk::DescriptorType::eSampledImage, ImageInfo(i + 1));
+	}
+
+	const auto& writes = batch.Resolve();
+	CHECK_EQ(writes.size(), size_t(sWriteCount));
+
+	for (uint32_t i = 0; i < sWriteCount; i++)
+	{
+		CHECK_EQ(writes[i].dstBinding, i);
+
+		if (i % 2 == 0)
+			CHECK(writes[i].pBufferInfo->buffer == MakeHandle<vk::Buffer>(i + 1));
+		else
+			CHECK(writes[i].pImageInfo->imageView == MakeHandle<vk::ImageView>(i + 1));
+	}
+}
+
+TEST(DescriptorWriteBatch, ClearStartsOver)
+{
+	DescriptorWriteBatch batch;
+	auto set = MakeHandle<vk::DescriptorSet>(1);
+
+	batch.Write(set, 0, 0, vk::DescriptorType::eStorageBuffer, BufferInfo(10));
+	batch.Clear();
+
+	CHECK(batch.IsEmpty());
+	CHECK(batch.Resolve().empty());
+
+	// a location written before the clear is new again
+	batch.Write(set, 0, 0, vk::DescriptorType::eUniformBuffer, BufferInfo(11));
+
+	const auto& writes = batch.Resolve();
+	CHECK_EQ(writes.size(), size_t(1));
+	CHECK(writes[0].descriptorType == vk::DescriptorType::eUniformBuffer);
+	CHECK(writes[0].pBufferInfo->buffer == MakeHandle<vk::Buffer>(11));
+}
+
+BENCHMARK(DescriptorWriteBatch, DriverCallsPerMaterialUpdate)
+{
+	// a material instance rewriting its textures and parameter buffer, with the shared
+	// camera buffer written twice the way UpdateMaterialInfos and the renderer both do
+	constexpr uint32_t sTextureCount = 12;
+	constexpr uint32_t sUpdates = 100'000;
+
+	DescriptorWriteBatch batch;
+	auto set = MakeHandle<vk::DescriptorSet>(1);
+
+	uint32_t unbatchedCalls = 0;
+	uint32_t batchedCalls = 0;
+	size_t batchedWrites = 0;
+
+	double seconds = Tests::MeasureSeconds([&]()
+	{
+		for (uint32_t update = 0; update < sUpdates; update++)
+		{
+			batch.Write(set, 0, 0, vk::DescriptorType::eUniformBuffer, BufferInfo(1));
+			batch.Write(set, 1, 0, vk::DescriptorType::eStorageBuffer, BufferInfo(2));
+
+			for (uint32_t i = 0; i < sTextureCount; i++)
+				batch.Write(set, 2, i, vk::DescriptorType::eCombinedImageSampler, ImageInfo(100 + i, 1));
+
+			batch.Write(set, 0, 0, vk::DescriptorType::eUniformBuffer, BufferInfo(1));
+
+			unbatchedCalls += sTextureCount + 3;
+			batchedCalls += batch.IsEmpty() ? 0 : 1;
+			batchedWrites += batch.GetWriteCount();
+
+			Tests::DoNotOptimize(batch.Resolve().data());
+			batch.Clear();
+		}
+	});
+
+	std::cout << "\tdriver calls per update: " << double(unbatchedCalls) / sUpdates << " unbatched, "
+		<< double(batchedCalls) / sUpdates << " batched carrying " << double(batchedWrites) / sUpdates << " writes" << std::endl;
+	std::cout << "\tbatch + resolve: " << seconds * 1e9 / sUpdates << " ns per update" << std::endl;
+}
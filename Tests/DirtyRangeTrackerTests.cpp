@@ -0,0 +1,207 @@
+#include "TestRunner.h"
+#include "Memory/DirtyRangeTracker.h"
+
+namespace
+{
+	using vkLib::Core::DirtyRangeTracker;
+	using Range = DirtyRangeTracker::Range;
+}
+
+TEST(DirtyRangeTracker, WidensToWholeAtoms)
+{
+	DirtyRangeTracker tracker(64, 1000);
+
+	tracker.Mark(10, 4);
+
+	CHECK_EQ(tracker.GetRanges().size(), size_t(1));
+	CHECK((tracker.GetRanges()[0] == Range{ 0, 64 }));
+
+	// the last atom is cut short by the limit
+	tracker.Mark(990, 100);
+	CHECK((tracker.GetRanges().back() == Range{ 960, 1000 }));
+
+	// nothing past the limit, nothing empty
+	tracker.Mark(2000, 1);
+	tracker.Mark(100, 0);
+
+	CHECK_EQ(tracker.GetRanges().size(), size_t(2));
+}
+
+TEST(DirtyRangeTracker, MergesOverlappingAndTouchingRanges)
+{
+	DirtyRangeTracker tracker(64, 1000);
+
+	tracker.Mark(10, 4);
+	tracker.Mark(200, 10);
+	CHECK_EQ(tracker.GetRanges().size(), size_t(2));
+
+	// touches the first range, extends it without reaching the second one
+	tracker.Mark(64, 1);
+	CHECK_EQ(tracker.GetRanges().size(), size_t(2));
+	CHECK((tracker.GetRanges()[0] == Range{ 0, 128 }));
+
+	// bridges the gap between both
+	tracker.Mark(128, 72);
+	CHECK_EQ(tracker.GetRanges().size(), size_t(1));
+	CHECK((tracker.GetRanges()[0] == Range{ 0, 256 }));
+	CHECK_EQ(tracker.GetDirtySize(), uint64_t(256));
+
+	tracker.Clear();
+	CHECK(tracker.IsEmpty());
+}
+
+TEST(DirtyRangeTracker, KeepsRangesSorted)
+{
+	DirtyRangeTracker tracker(16, 4096);
+
+	for (uint64_t offset : { 3000, 100, 2000, 500, 1000 })
+		tracker.Mark(offset, 8);
+
+	const auto& ranges = tracker.GetRanges();
+	CHECK_EQ(ranges.size(), size_t(5));
+
+	for (size_t i = 1; i < ranges.size(); i++)
+		CHECK(ranges[i - 1].End < ranges[i].Begin);
+}
+
+TEST(DirtyRangeTracker, CollapsesPastTheRangeBudget)
+{
+	DirtyRangeTracker tracker(1, 1 << 20);
+
+	for (uint64_t i = 0; i <= DirtyRangeTracker::sMaxRanges; i++)
+		tracker.Mark(i * 100, 1);
+
+	// one range spanning everything rather than a flush with dozens of tiny ranges
+	CHECK_EQ(tracker.GetRanges().size(), size_t(1));
+	CHECK((tracker.GetRanges()[0] == Range{ 0, DirtyRangeTracker::sMaxRanges * 100 + 1 }));
+}
+
+TEST(DirtyRangeTracker, NoOverflowNearTheLimit)
+{
+	DirtyRangeTracker unbounded;
+	unbounded.Mark(5, std::numeric_limits<uint64_t>::max());
+
+	CHECK_EQ(unbounded.GetRanges()[0].End, std::numeric_limits<uint64_t>::max());
+
+	// rounding up to the atom would wrap around without the clamp
+	constexpr uint64_t sLimit = std::numeric_limits<uint64_t>::max() - 3;
+
+	DirtyRangeTracker bounded(256, sLimit);
+	bounded.Mark(sLimit - 10, 5);
+
+	CHECK_EQ(bounded.GetRanges()[0].End, sLimit);
+}
+
+TEST(DirtyRangeTracker, ResetAndMarkAll)
+{
+	DirtyRangeTracker tracker(64, 1000);
+
+	tracker.Mark(0, 10);
+	tracker.Reset(128, 4096);
+
+	CHECK(tracker.IsEmpty());
+	CHECK_EQ(tracker.GetAtomSize(), uint64_t(128));
+	CHECK_EQ(tracker.GetLimit(), uint64_t(4096));
+
+	tracker.Mark(0, 10);
+	tracker.MarkAll();
+
+	CHECK_EQ(tracker.GetRanges().size(), size_t(1));
+	CHECK((tracker.GetRanges()[0] == Range{ 0, 4096 }));
+}
+
+TEST(DirtyRangeTracker, MatchesAByteMapFuzz)
+{
+	std::mt19937 random(1);
+
+	for (uint32_t round = 0; round < 2000; round++)
+	{
+		uint64_t atomSize = 1ull << (random() % 5);
+		uint64_t limit = 500 + random() % 600;
+
+		DirtyRangeTracker tracker(atomSize, limit);
+		std::vector<bool> expected(limit, false);
+
+		uint32_t markCount = random() % 40;
+
+		for (uint32_t i = 0; i < markCount; i++)
+		{
+			uint64_t offset = random() % 1200;
+			uint64_t size = random() % 100;
+
+			tracker.Mark(offset, size);
+
+			if (size == 0 || offset >= limit)
+				continue;
+
+			uint64_t begin = offset / atomSize * atomSize;
+			uint64_t end = std::min((offset + size + atomSize - 1) / atomSize * atomSize, limit);
+
+			for (uint64_t byte = begin; byte < end; byte++)
+				expected[byte] = true;
+		}
+
+		const auto& ranges = tracker.GetRanges();
+
+		// past the budget the tracker over approximates on purpose
+		if (ranges.size() == 1 && markCount > DirtyRangeTracker::sMaxRanges)
+			continue;
+
+		std::vector<bool> covered(limit, false);
+
+		for (size_t i = 0; i < ranges.size(); i++)
+		{
+			CHECK(ranges[i].Begin < ranges[i].End);
+			CHECK(i == 0 || ranges[i - 1].End < ranges[i].Begin);
+
+			for (uint64_t byte = ranges[i].Begin; byte < ranges[i].End; byte++)
+				covered[byte] = true;
+		}
+
+		CHECK(covered == expected);
+	}
+}
+
+BENCHMARK(DirtyRangeTracker, ParameterUpdateCost)
+{
+	// a material's parameter block, updated one float at a time the way SetShaderParameter does
+	constexpr uint64_t sBlockSize = 64 * 1024;
+	constexpr uint32_t sUpdates = 1'000'000;
+
+	std::vector<std::byte> mapped(sBlockSize);
+	DirtyRangeTracker tracker(64, sBlockSize);
+
+	std::mt19937 random(5);
+	std::vector<uint64_t> offsets(4096);
+
+	for (auto& offset : offsets)
+		offset = (random() % (sBlockSize / sizeof(float))) * sizeof(float);
+
+	size_t flushedRanges = 0;
+	uint32_t frames = 0;
+
+	double seconds = Tests::MeasureSeconds([&]()
+	{
+		for (uint32_t i = 0; i < sUpdates; i++)
+		{
+			float value = static_cast<float>(i);
+			uint64_t offset = offsets[i % offsets.size()];
+
+			std::memcpy(mapped.data() + offset, &value, sizeof(value));
+			tracker.Mark(offset, sizeof(value));
+
+			// a frame worth of parameter updates, then the flush collects the ranges
+			if (i % 64 == 63)
+			{
+				flushedRanges += tracker.GetRanges().size();
+				tracker.Clear();
+				frames++;
+			}
+		}
+	});
+
+	Tests::DoNotOptimize(mapped.data());
+
+	std::cout << "\twrite + mark: " << seconds * 1e9 / sUpdates << " ns per parameter, "
+		<< double(flushedRanges) / frames << " ranges per flush for 64 updates" << std::endl;
+}
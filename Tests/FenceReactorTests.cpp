@@ -0,0 +1,332 @@
+#include "TestRunner.h"
+#include "Process/FenceReactor.h"
+#include "Process/AsyncProcess.h"
+
+namespace
+{
+	using Reactor = vkLib::Core::MockFenceReactor;
+	using Fence = vkLib::Core::MockFenceBackend::FenceType;
+	using vkLib::Core::AsyncProcess;
+
+	AsyncProcess AwaitFence(Reactor& reactor, Fence fence, std::atomic<uint32_t>& completed,
+		std::thread::id* resumedOn = nullptr)
+	{
+		co_await reactor.WaitFor(fence);
+
+		if (resumedOn)
+			*resumedOn = std::this_thread::get_id();
+
+		completed++;
+	}
+
+	AsyncProcess AwaitBoth(Reactor& reactor, Fence first, Fence second, std::vector<int>& steps)
+	{
+		steps.push_back(0);
+		co_await reactor.WaitFor(first);
+		steps.push_back(1);
+		co_await reactor.WaitFor(second);
+		steps.push_back(2);
+	}
+
+	AsyncProcess AwaitThenThrow(Reactor& reactor, Fence fence)
+	{
+		co_await reactor.WaitFor(fence);
+		throw std::runtime_error("process failed");
+	}
+
+	AsyncProcess AwaitProcess(AsyncProcess inner, std::atomic<uint32_t>& completed)
+	{
+		co_await inner;
+		completed++;
+	}
+
+	// the reactor hands waits over asynchronously, give it a bounded amount of time to get there
+	template <typename Fn>
+	bool Eventually(Fn&& predicate)
+	{
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+		while (!predicate())
+		{
+			if (std::chrono::steady_clock::now() > deadline)
+				return false;
+
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+
+		return true;
+	}
+}
+
+TEST(FenceReactor, SignaledFenceCompletesEagerly)
+{
+	Reactor reactor(vkLib::Core::MockFenceBackend{});
+	std::atomic<uint32_t> completed = 0;
+
+	std::thread::id resumedOn;
+	auto process = AwaitFence(reactor, reactor.GetBackend().CreateFence(true), completed, &resumedOn);
+
+	// await_ready short circuits, the body never left the calling thread
+	CHECK(process.IsDone());
+	CHECK_EQ(completed.load(), 1u);
+	CHECK(resumedOn == std::this_thread::get_id());
+	CHECK_EQ(reactor.GetInFlightCount(), size_t(0));
+}
+
+TEST(FenceReactor, ResumesOnTheReactorThreadAfterSignal)
+{
+	Reactor reactor(vkLib::Core::MockFenceBackend{});
+	const auto& backend = reactor.GetBackend();
+
+	std::atomic<uint32_t> completed = 0;
+	std::thread::id resumedOn;
+
+	Fence fence = backend.CreateFence();
+	auto process = AwaitFence(reactor, fence, completed, &resumedOn);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	CHECK(!process.IsDone());
+	CHECK_EQ(completed.load(), 0u);
+	CHECK_EQ(reactor.GetInFlightCount(), size_t(1));
+
+	backend.Signal(fence);
+	process.Wait();
+
+	CHECK_EQ(completed.load(), 1u);
+	CHECK(resumedOn != std::this_thread::get_id());
+	CHECK_EQ(reactor.GetInFlightCount(), size_t(0));
+}
+
+TEST(FenceReactor, ResumesInSignalOrder)
+{
+	constexpr uint32_t sProcessCount = 16;
+
+	Reactor reactor(vkLib::Core::MockFenceBackend{});
+	const auto& backend = reactor.GetBackend();
+
+	std::vector<Fence> fences;
+	std::vector<AsyncProcess> processes;
+	std::atomic<uint32_t> completed = 0;
+
+	for (uint32_t i = 0; i < sProcessCount; i++)
+	{
+		fences.push_back(backend.CreateFence());
+		processes.push_back(AwaitFence(reactor, fences.back(), completed));
+	}
+
+	// each signal must resume exactly its own waiter, nobody else
+	for (uint32_t i = sProcessCount; i-- > 0;)
+	{
+		backend.Signal(fences[i]);
+		processes[i].Wait();
+
+		CHECK_EQ(completed.load(), sProcessCount - i);
+
+		for (uint32_t j = 0; j < i; j++)
+			CHECK(!processes[j].IsDone());
+	}
+}
+
+TEST(FenceReactor, ChainedWaits)
+{
+	Reactor reactor(vkLib::Core::MockFenceBackend{});
+	const auto& backend = reactor.GetBackend();
+
+	Fence first = backend.CreateFence();
+	Fence second = backend.CreateFence();
+
+	std::vector<int> steps;
+	auto process = AwaitBoth(reactor, first, second, steps);
+
+	// signaling out of order doesn't skip the first wait
+	backend.Signal(second);
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	CHECK(!process.IsDone());
+
+	backend.Signal(first);
+	process.Wait();
+
+	CHECK((steps == std::vector<int>{ 0, 1, 2 }));
+}
+
+TEST(FenceReactor, AwaitingAProcessRunsTheContinuation)
+{
+	Reactor reactor(vkLib::Core::MockFenceBackend{});
+	const auto& backend = reactor.GetBackend();
+
+	std::atomic<uint32_t> completed = 0;
+
+	Fence fence = backend.CreateFence();
+	auto outer = AwaitProcess(AwaitFence(reactor, fence, completed), completed);
+
+	CHECK(!outer.IsDone());
+
+	backend.Signal(fence);
+	outer.Wait();
+
+	CHECK_EQ(completed.load(), 2u);
+}
+
+TEST(FenceReactor, ExceptionsReachTheWaiter)
+{
+	Reactor reactor(vkLib::Core::MockFenceBackend{});
+	const auto& backend = reactor.GetBackend();
+
+	Fence fence = backend.CreateFence();
+	auto process = AwaitThenThrow(reactor, fence);
+
+	backend.Signal(fence);
+
+	bool caught = false;
+
+	try { process.Wait(); }
+	catch (const std::runtime_error&) { caught = true; }
+
+	CHECK(caught);
+}
+
+TEST(FenceReactor, DroppedHandlesStillComplete)
+{
+	Reactor reactor(vkLib::Core::MockFenceBackend{});
+	const auto& backend = reactor.GetBackend();
+
+	std::atomic<uint32_t> completed = 0;
+	Fence fence = backend.CreateFence();
+
+	// the frame outlives the handle, the body frees it once it finishes
+	AwaitFence(reactor, fence, completed);
+	CHECK_EQ(reactor.GetInFlightCount(), size_t(1));
+
+	backend.Signal(fence);
+
+	CHECK(Eventually([&]() { return completed.load() == 1; }));
+	CHECK(Eventually([&]() { return reactor.GetInFlightCount() == 0; }));
+}
+
+TEST(FenceReactor, DestructorDrainsPendingWaits)
+{
+	vkLib::Core::MockFenceBackend backend;
+	std::atomic<uint32_t> completed = 0;
+
+	Fence fence = backend.CreateFence();
+	std::jthread signaler;
+
+	{
+		Reactor reactor(backend);
+		AwaitFence(reactor, fence, completed);
+
+		signaler = std::jthread([backend, fence]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			backend.Signal(fence);
+		});
+	}
+
+	// the reactor only let go of its thread after resuming the waiter
+	CHECK_EQ(completed.load(), 1u);
+}
+
+TEST(FenceReactor, ConcurrentSubmitAndSignalStress)
+{
+	constexpr uint32_t sThreadCount = 4;
+	constexpr uint32_t sProcessesPerThread = 500;
+
+	Reactor reactor(vkLib::Core::MockFenceBackend{});
+	const auto& backend = reactor.GetBackend();
+
+	std::atomic<uint32_t> completed = 0;
+
+	std::mutex lock;
+	std::vector<Fence> unsignaled;
+	std::atomic<uint32_t> submittersLeft = sThreadCount;
+
+	// signals whatever has been submitted in random order, until every submitter is done
+	std::jthread signaler([&]()
+	{
+		std::mt19937 random(7);
+		std::vector<Fence> batch;
+
+		while (true)
+		{
+			bool finished = submittersLeft.load() == 0;
+
+			{
+				std::scoped_lock locker(lock);
+				batch.swap(unsignaled);
+			}
+
+			std::shuffle(batch.begin(), batch.end(), random);
+
+			for (Fence fence : batch)
+				backend.Signal(fence);
+
+			batch.clear();
+
+			if (finished)
+				return;
+
+			std::this_thread::yield();
+		}
+	});
+
+	std::vector<std::jthread> submitters;
+
+	for (uint32_t t = 0; t < sThreadCount; t++)
+	{
+		submitters.emplace_back([&]()
+		{
+			for (uint32_t i = 0; i < sProcessesPerThread; i++)
+			{
+				Fence fence = backend.CreateFence();
+				AwaitFence(reactor, fence, completed);
+
+				std::scoped_lock locker(lock);
+				unsignaled.push_back(fence);
+			}
+
+			submittersLeft--;
+		});
+	}
+
+	submitters.clear();
+	signaler.join();
+
+	CHECK(Eventually([&]() { return completed.load() == sThreadCount * sProcessesPerThread; }));
+	CHECK(Eventually([&]() { return reactor.GetInFlightCount() == 0; }));
+}
+
+BENCHMARK(FenceReactor, InFlightThroughput)
+{
+	for (uint32_t inFlight : { 1u, 64u, 1024u })
+	{
+		Reactor reactor(vkLib::Core::MockFenceBackend{});
+		const auto& backend = reactor.GetBackend();
+
+		constexpr uint32_t sTotal = 16 * 1024;
+
+		std::atomic<uint32_t> completed = 0;
+		std::vector<Fence> fences(inFlight);
+		std::vector<AsyncProcess> processes(inFlight);
+
+		double seconds = Tests::MeasureSeconds([&]()
+		{
+			for (uint32_t done = 0; done < sTotal; done += inFlight)
+			{
+				for (uint32_t i = 0; i < inFlight; i++)
+				{
+					fences[i] = backend.CreateFence();
+					processes[i] = AwaitFence(reactor, fences[i], completed);
+				}
+
+				for (Fence fence : fences)
+					backend.Signal(fence);
+
+				for (const auto& process : processes)
+					process.Wait();
+			}
+		});
+
+		std::cout << "\t" << inFlight << " in flight: " << completed.load() / seconds
+			<< " processes/s" << std::endl;
+	}
+}
@@ -0,0 +1,368 @@
+#include "ShaderTestUtils.h"
+#include "ShaderCompiler/IncludeCache.h"
+#include "ShaderCompiler/ShaderIncluder.h"
+
+namespace
+{
+	using vkLib::IncludeCache;
+	using Tests::ScratchDirectory;
+
+	std::filesystem::path Normalized(const std::filesystem::path& path)
+	{
+		return IncludeCache::NormalizePath(path);
+	}
+
+	// moves the write time without touching the bytes, as an editor saving an unchanged file would
+	void Touch(const std::filesystem::path& path)
+	{
+		std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds(5));
+	}
+
+	// Main.frag pulls Common.glsl in twice, directly and through Lib/Lighting.glsl
+	// Lighting.glsl names it relative to its own directory, Shadows.frag only includes Lighting.glsl
+	void WriteShaderTree(const ScratchDirectory& scratch, std::string_view ambient = "0.1")
+	{
+		scratch.Write("Lib/Common.glsl",
+			"#ifndef COMMON_GLSL\n#define COMMON_GLSL\n"
+			"const float sAmbient = " + std::string(ambient) + ";\n"
+			"#endif\n");
+
+		scratch.Write("Lib/Lighting.glsl",
+			"#ifndef LIGHTING_GLSL\n#define LIGHTING_GLSL\n"
+			"#include \"Common.glsl\"\n"
+			"float Shade(float value) { return max(value, sAmbient); }\n"
+			"#endif\n");
+
+		scratch.Write("Main.frag",
+			"#version 440\n"
+			"#include \"Lib/Common.glsl\"\n"
+			"#include \"Lib/Lighting.glsl\"\n"
+			"layout(location = 0) in float vValue;\n"
+			"layout(location = 0) out vec4 oColor;\n"
+			"void main() { oColor = vec4(Shade(vValue) + sAmbient); }\n");
+
+		scratch.Write("Shadows.frag",
+			"#version 440\n"
+			"#include \"Lib/Lighting.glsl\"\n"
+			"layout(location = 0) in float vValue;\n"
+			"layout(location = 0) out vec4 oColor;\n"
+			"void main() { oColor = vec4(Shade(vValue)); }\n");
+	}
+
+	// what the compiler does for a header, the includer's stack expects the release in reverse order
+	std::string Include(vkLib::ShaderIncluder& includer, const std::string& header, const std::string& includerName)
+	{
+		auto result = includer.IncludeLocal(header, includerName, 0);
+		CHECK(result != nullptr);
+
+		std::string contents = result->Contents;
+		includer.ReleaseInclude(result);
+
+		return contents;
+	}
+}
+
+TEST(IncludeCache, ReadsOnceUntilTheFileMoves)
+{
+	ScratchDirectory scratch("IncludeCacheReads");
+	auto path = scratch.Write("Common.glsl", "const float sAmbient = 0.1;\n");
+
+	IncludeCache cache;
+
+	auto first = cache.Read(path);
+	auto second = cache.Read(path);
+
+	CHECK(first != nullptr && *first == "const float sAmbient = 0.1;\n");
+	CHECK(first == second);
+
+	auto stats = cache.GetStats();
+
+	CHECK_EQ(stats.Misses, uint64_t(1));
+	CHECK_EQ(stats.Hits, uint64_t(1));
+	CHECK_EQ(cache.GetEntryCount(), size_t(1));
+}
+
+TEST(IncludeCache, TouchedFilesRevalidate)
+{
+	ScratchDirectory scratch("IncludeCacheTouched");
+	auto path = scratch.Write("Common.glsl", "const float sAmbient = 0.1;\n");
+
+	IncludeCache cache;
+	auto first = cache.Read(path);
+
+	Touch(path);
+
+	// read again and hashed, the same bytes keep the same contents
+	auto touched = cache.Read(path);
+
+	CHECK(touched == first);
+	CHECK_EQ(cache.GetStats().Revalidations, uint64_t(1));
+
+	// the new write time is remembered
+	cache.Read(path);
+	CHECK_EQ(cache.GetStats().Hits, uint64_t(1));
+}
+
+TEST(IncludeCache, EditedFilesReload)
+{
+	ScratchDirectory scratch("IncludeCacheEdited");
+	auto path = scratch.Write("Common.glsl", "const float sAmbient = 0.1;\n");
+
+	IncludeCache cache;
+	auto before = cache.Read(path);
+
+	// the size moves even if the write time doesn't within the file system's resolution
+	scratch.Write("Common.glsl", "const float sAmbient = 0.25;\n");
+
+	auto after = cache.Read(path);
+
+	CHECK(after != nullptr && *after == "const float sAmbient = 0.25;\n");
+	CHECK_EQ(cache.GetStats().Reloads, uint64_t(1));
+
+	// readers holding the previous contents keep them
+	CHECK(*before == "const float sAmbient = 0.1;\n");
+	CHECK_EQ(cache.GetEntryCount(), size_t(1));
+}
+
+TEST(IncludeCache, MissingFilesArentCached)
+{
+	ScratchDirectory scratch("IncludeCacheMissing");
+
+	IncludeCache cache;
+
+	CHECK(cache.Read(scratch.GetPath() / "Missing.glsl") == nullptr);
+	CHECK_EQ(cache.GetEntryCount(), size_t(0));
+
+	// appearing later is an ordinary miss
+	auto path = scratch.Write("Missing.glsl", "// here now\n");
+
+	CHECK(cache.Read(path) != nullptr);
+	CHECK_EQ(cache.GetStats().Misses, uint64_t(1));
+}
+
+TEST(IncludeCache, InvalidateAndClear)
+{
+	ScratchDirectory scratch("IncludeCacheInvalidate");
+	auto common = scratch.Write("Common.glsl", "// common\n");
+	auto lighting = scratch.Write("Lighting.glsl", "// lighting\n");
+
+	IncludeCache cache;
+	cache.Read(common);
+	cache.Read(lighting);
+
+	cache.Invalidate(common);
+	CHECK_EQ(cache.GetEntryCount(), size_t(1));
+
+	cache.Read(common);
+	cache.Read(lighting);
+
+	CHECK_EQ(cache.GetStats().Misses, uint64_t(3));
+	CHECK_EQ(cache.GetStats().Hits, uint64_t(1));
+
+	cache.RecordDependencies(scratch.GetPath() / "Main.frag", { common });
+	cache.Clear();
+
+	CHECK_EQ(cache.GetEntryCount(), size_t(0));
+	CHECK(cache.GetDependents(common).empty());
+}
+
+TEST(IncludeCache, PathsAreNormalized)
+{
+	ScratchDirectory scratch("IncludeCacheNormalized");
+	auto path = scratch.Write("Lib/Common.glsl", "// common\n");
+
+	std::filesystem::create_directories(scratch.GetPath() / "Other");
+
+	IncludeCache cache;
+
+	auto first = cache.Read(path);
+	auto second = cache.Read(scratch.GetPath() / "Other" / ".." / "Lib" / "." / "Common.glsl");
+
+	CHECK(first == second);
+	CHECK_EQ(cache.GetEntryCount(), size_t(1));
+	CHECK_EQ(cache.GetStats().Hits, uint64_t(1));
+
+	// the graph goes through the same normalization
+	cache.RecordDependencies(scratch.GetPath() / "Other" / ".." / "Main.frag", { path });
+
+	auto dependents = cache.GetDependents(scratch.GetPath() / "Lib" / ".." / "Lib" / "Common.glsl");
+
+	CHECK_EQ(dependents.size(), size_t(1));
+	CHECK(dependents.front() == Normalized(scratch.GetPath() / "Main.frag"));
+}
+
+TEST(IncludeCache, DependencyGraph)
+{
+	ScratchDirectory scratch("IncludeCacheGraph");
+	WriteShaderTree(scratch);
+
+	auto root = scratch.GetPath();
+	auto main = Normalized(root / "Main.frag");
+	auto shadows = Normalized(root / "Shadows.frag");
+	auto common = Normalized(root / "Lib/Common.glsl");
+	auto lighting = Normalized(root / "Lib/Lighting.glsl");
+
+	IncludeCache cache;
+
+	// a header listed twice counts once
+	cache.RecordDependencies(main, { common, lighting, common });
+	cache.RecordDependencies(shadows, { lighting, common });
+
+	CHECK((cache.GetDependencies(main) == std::vector{ common, lighting }));
+	CHECK((cache.GetDependents(common) == std::vector{ main, shadows }));
+
+	// a recompilation replaces what the shader depended on
+	cache.RecordDependencies(shadows, { lighting });
+
+	CHECK((cache.GetDependents(common) == std::vector{ main }));
+	CHECK((cache.GetDependents(lighting) == std::vector{ main, shadows }));
+
+	cache.ForgetShader(main);
+
+	CHECK(cache.GetDependencies(main).empty());
+	CHECK(cache.GetDependents(common).empty());
+	CHECK((cache.GetDependents(lighting) == std::vector{ shadows }));
+
+	// forgetting twice, or a shader never recorded, is harmless
+	cache.ForgetShader(main);
+	cache.ForgetShader(root / "Unknown.frag");
+	CHECK((cache.GetDependencies(shadows) == std::vector{ lighting }));
+}
+
+TEST(IncludeCache, IncluderSharesNestedAndRepeatedHeaders)
+{
+	ScratchDirectory scratch("IncludeCacheIncluder");
+	WriteShaderTree(scratch);
+
+	auto cache = std::make_shared<IncludeCache>();
+	auto directory = std::filesystem::canonical(scratch.GetPath());
+
+	// the order Main.frag resolves its includes in, Lighting.glsl's nested include is relative to Lib
+	{
+		vkLib::ShaderIncluder includer(directory, {}, cache);
+
+		CHECK(Include(includer, "Lib/Common.glsl", "").find("sAmbient = 0.1") != std::string::npos);
+
+		auto lighting = includer.IncludeLocal("Lib/Lighting.glsl", "", 0);
+		CHECK(lighting != nullptr);
+
+		CHECK(Include(includer, "Common.glsl", "Lib").find("COMMON_GLSL") != std::string::npos);
+
+		includer.ReleaseInclude(lighting);
+
+		CHECK((includer.GetIncludedFiles() ==
+			std::vector{ Normalized(directory / "Lib/Common.glsl"), Normalized(directory / "Lib/Lighting.glsl") }));
+	}
+
+	auto stats = cache->GetStats();
+
+	CHECK_EQ(stats.Misses, uint64_t(2));
+	CHECK_EQ(stats.Hits, uint64_t(1));
+
+	// another shader's includer finds the headers already read
+	{
+		vkLib::ShaderIncluder includer(directory, {}, cache);
+
+		auto lighting = includer.IncludeLocal("Lib/Lighting.glsl", "", 0);
+		Include(includer, "Common.glsl", "Lib");
+		includer.ReleaseInclude(lighting);
+	}
+
+	CHECK_EQ(cache->GetStats().Misses, uint64_t(2));
+	CHECK_EQ(cache->GetStats().Hits, uint64_t(3));
+
+	// a header that doesn't exist, and one that isn't where the includer's directory says
+	vkLib::ShaderIncluder includer(directory, {}, cache);
+
+	CHECK(includer.IncludeLocal("Lib/Missing.glsl", "", 0) == nullptr);
+	CHECK(includer.IncludeLocal("Common.glsl", "", 0) == nullptr);
+}
+
+TEST(IncludeCache, ConcurrentReadsShareOneCopy)
+{
+	ScratchDirectory scratch("IncludeCacheConcurrent");
+
+	std::vector<std::filesystem::path> files;
+
+	for (uint32_t i = 0; i < 4; i++)
+		files.push_back(scratch.Write("Header" + std::to_string(i) + ".glsl", std::string(256 + i, 'a' + i)));
+
+	IncludeCache cache;
+
+	constexpr uint32_t sThreads = 4;
+	constexpr uint32_t sReads = 200;
+
+	std::atomic<uint32_t> wrong = 0;
+	std::vector<std::thread> threads;
+
+	for (uint32_t t = 0; t < sThreads; t++)
+	{
+		threads.emplace_back([&, t]()
+		{
+			for (uint32_t i = 0; i < sReads; i++)
+			{
+				uint32_t index = (i + t) % files.size();
+				auto contents = cache.Read(files[index]);
+
+				if (!contents || contents->size() != 256 + index || contents->front() != char('a' + index))
+					wrong++;
+			}
+		});
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	CHECK_EQ(wrong.load(), uint32_t(0));
+
+	// threads racing on a first read find each other's bytes, only one counts as the miss
+	auto stats = cache.GetStats();
+
+	CHECK_EQ(stats.Misses, uint64_t(files.size()));
+	CHECK_EQ(stats.Reloads, uint64_t(0));
+	CHECK_EQ(stats.Hits + stats.Revalidations + stats.Misses, uint64_t(sThreads * sReads));
+}
+
+TEST(IncludeCache, CompilerRecordsAffectedShaders)
+{
+	ScratchDirectory scratch("IncludeCacheCompiler");
+	WriteShaderTree(scratch);
+
+	auto env = Tests::MakeIsolatedEnvironment();
+	auto cache = env.GetIncludeCache();
+
+	auto compile = [&env, &scratch](const char* name)
+	{
+		vkLib::ShaderInput input{ "", vk::ShaderStageFlagBits::eFragment,
+			(scratch.GetPath() / name).string(), vkLib::OptimizerFlag::eNone };
+
+		return vkLib::ShaderCompiler(env).Compile(input);
+	};
+
+	auto main = compile("Main.frag");
+	auto shadows = compile("Shadows.frag");
+
+	CHECK(main.Error.Type == vkLib::ErrorType::eNone);
+	CHECK(shadows.Error.Type == vkLib::ErrorType::eNone);
+
+	// two shaders and two headers, each read from disk once
+	CHECK_EQ(cache->GetStats().Misses, uint64_t(4));
+
+	auto mainPath = Normalized(scratch.GetPath() / "Main.frag");
+	auto shadowsPath = Normalized(scratch.GetPath() / "Shadows.frag");
+
+	// the nested include is flattened into both shaders
+	CHECK((env.GetAffectedShaders(scratch.GetPath() / "Lib/Common.glsl") == std::vector{ mainPath, shadowsPath }));
+	CHECK((env.GetAffectedShaders(scratch.GetPath() / "Lib/Lighting.glsl") == std::vector{ mainPath, shadowsPath }));
+	CHECK(env.GetAffectedShaders(scratch.GetPath() / "Main.frag").empty());
+
+	// the edited header is reloaded by the next compilation, the rest still hits
+	WriteShaderTree(scratch, "0.125");
+
+	auto edited = compile("Main.frag");
+
+	CHECK(edited.Error.Type == vkLib::ErrorType::eNone);
+	CHECK(edited.Error.SrcCode.find("0.125") != std::string::npos);
+	CHECK_EQ(cache->GetStats().Reloads, uint64_t(1));
+	CHECK_EQ(cache->GetStats().Misses, uint64_t(4));
+}
@@ -0,0 +1,177 @@
+#include "TestRunner.h"
+#include "Core/IntrusiveRef.h"
+
+namespace
+{
+	struct Payload
+	{
+		int Value = 0;
+		std::string Name;
+	};
+}
+
+TEST(IntrusiveRef, DeleterRunsOnceWithTheLastReference)
+{
+	int deleted = 0;
+
+	{
+		auto ref = vkLib::Core::CreateIntrusiveRef<Payload>([&deleted](Payload&) { deleted++; }, 7, "seven");
+
+		CHECK_EQ(ref->Value, 7);
+		CHECK_EQ((*ref).Name, std::string("seven"));
+		CHECK_EQ(ref.GetUseCount(), 1u);
+
+		auto copy = ref;
+		CHECK_EQ(ref.GetUseCount(), 2u);
+		CHECK(copy == ref);
+
+		auto moved = std::move(copy);
+		CHECK(!copy);
+		CHECK_EQ(ref.GetUseCount(), 2u);
+
+		moved.Reset();
+		CHECK_EQ(deleted, 0);
+		CHECK_EQ(ref.GetUseCount(), 1u);
+	}
+
+	CHECK_EQ(deleted, 1);
+}
+
+TEST(IntrusiveRef, AssignmentKeepsCountsStraight)
+{
+	std::vector<int> deleted;
+
+	auto first = vkLib::Core::CreateIntrusiveRef<int>([&deleted](int& value) { deleted.push_back(value); }, 1);
+	auto second = vkLib::Core::CreateIntrusiveRef<int>([&deleted](int& value) { deleted.push_back(value); }, 2);
+
+	// self assignment must not drop the only reference
+	auto& alias = first;
+	first = alias;
+	CHECK_EQ(first.GetUseCount(), 1u);
+	CHECK(deleted.empty());
+
+	// the old payload of the target goes away, the source gains an owner
+	first = second;
+	CHECK_EQ(deleted, std::vector<int>{ 1 });
+	CHECK_EQ(second.GetUseCount(), 2u);
+
+	second = std::move(first);
+	CHECK(!first);
+	CHECK_EQ(second.GetUseCount(), 1u);
+
+	second.Reset();
+	CHECK_EQ(deleted, (std::vector<int>{ 1, 2 }));
+}
+
+TEST(IntrusiveRef, SetValueDeletesTheOldPayloadForEveryOwner)
+{
+	std::vector<int> deleted;
+
+	auto ref = vkLib::Core::CreateIntrusiveRef<int>([&deleted](int& value) { deleted.push_back(value); }, 1);
+	auto copy = ref;
+
+	ref.SetValue(2);
+
+	CHECK_EQ(deleted, std::vector<int>{ 1 });
+	CHECK_EQ(*copy, 2);
+
+	ref.Reset();
+	copy.Reset();
+
+	CHECK_EQ(deleted, (std::vector<int>{ 1, 2 }));
+}
+
+TEST(IntrusiveRef, DeleterLivesInTheBlock)
+{
+	// a stateless deleter adds nothing, a capturing one only its captures, there's no std::function
+	auto stateless = [](int&) {};
+	int* target = nullptr;
+	auto capturing = [target](int&) { (void) target; };
+
+	using StatelessBlock = vkLib::Core::IntrusiveBlockWithDeleter<int, decltype(stateless)>;
+	using CapturingBlock = vkLib::Core::IntrusiveBlockWithDeleter<int, decltype(capturing)>;
+
+	CHECK(sizeof(StatelessBlock) <= sizeof(vkLib::Core::IntrusiveBlock<int>) + alignof(std::max_align_t));
+	CHECK(sizeof(CapturingBlock) <= sizeof(vkLib::Core::IntrusiveBlock<int>) + sizeof(int*) + alignof(std::max_align_t));
+	CHECK(sizeof(CapturingBlock) < sizeof(vkLib::Core::IntrusiveBlock<int>) + sizeof(std::function<void(int&)>));
+}
+
+TEST(IntrusiveRef, ConcurrentCopiesDeleteOnce)
+{
+	constexpr uint32_t sThreadCount = 8;
+	constexpr uint32_t sRounds = 200;
+
+	for (uint32_t round = 0; round < sRounds; round++)
+	{
+		std::atomic<uint32_t> deleted = 0;
+		std::atomic<int> observed = 0;
+
+		auto ref = vkLib::Core::CreateIntrusiveRef<std::atomic<int>>([&deleted, &observed](std::atomic<int>& value)
+		{
+			// the writes of every other owner are visible to the deleter
+			observed = value.load(std::memory_order_relaxed);
+			deleted++;
+		}, 0);
+
+		std::vector<std::jthread> threads;
+
+		for (uint32_t t = 0; t < sThreadCount; t++)
+		{
+			threads.emplace_back([copy = ref]() mutable
+			{
+				for (int i = 0; i < 100; i++)
+				{
+					auto local = copy;
+					local->fetch_add(1, std::memory_order_relaxed);
+				}
+
+				copy.Reset();
+			});
+		}
+
+		ref.Reset();
+		threads.clear();
+
+		CHECK_EQ(deleted.load(), 1u);
+		CHECK_EQ(observed.load(), int(sThreadCount * 100));
+	}
+}
+
+BENCHMARK(IntrusiveRef, CopyAndDrop)
+{
+	constexpr uint32_t sIterations = 10'000'000;
+
+	auto intrusive = vkLib::Core::CreateIntrusiveRef<int>([](int&) {}, 0);
+	auto shared = std::shared_ptr<int>(new int(0), [](int* value) { delete value; });
+
+	double intrusiveSeconds = Tests::MeasureSeconds([&]()
+	{
+		for (uint32_t i = 0; i < sIterations; i++)
+		{
+			auto copy = intrusive;
+			Tests::DoNotOptimize(copy);
+		}
+	});
+
+	double sharedSeconds = Tests::MeasureSeconds([&]()
+	{
+		for (uint32_t i = 0; i < sIterations; i++)
+		{
+			auto copy = shared;
+			Tests::DoNotOptimize(copy);
+		}
+	});
+
+	double createSeconds = Tests::MeasureSeconds([]()
+	{
+		for (uint32_t i = 0; i < sIterations / 10; i++)
+		{
+			auto ref = vkLib::Core::CreateIntrusiveRef<int>([](int&) {}, int(i));
+			Tests::DoNotOptimize(ref);
+		}
+	});
+
+	std::cout << "\tcopy + drop: IntrusiveRef " << intrusiveSeconds / sIterations * 1e9 << " ns, std::shared_ptr "
+		<< sharedSeconds / sIterations * 1e9 << " ns\n\tcreate + destroy: " << createSeconds / (sIterations / 10) * 1e9
+		<< " ns" << std::endl;
+}
@@ -0,0 +1,352 @@
+#include "ShaderTestUtils.h"
+#include "ShaderCompiler/Lexer.h"
+
+namespace
+{
+	using vkLib::CharClassTable;
+	using vkLib::TokenScanner;
+
+	struct ReferenceToken
+	{
+		std::string Value;
+		size_t Position = 0;
+	};
+
+	// the lexer as it was before the table, searching the sets for every character
+	// its line and column counters were off, only the values and positions are worth comparing
+	std::vector<ReferenceToken> ReferenceLex(const std::string& source, size_t place,
+		const std::string& spaces, const std::string& delimiters)
+	{
+		auto isIn = [](char val, const std::string& str) { return std::find(str.begin(), str.end(), val) != str.end(); };
+
+		std::string allDelimiters = delimiters + spaces;
+		const char* src = source.c_str();
+
+		std::vector<ReferenceToken> tokens;
+
+		while (true)
+		{
+			while (isIn(src[place], spaces) && src[place] != 0)
+				place++;
+
+			size_t initial = place;
+			char current = src[place++];
+
+			while (!isIn(current, allDelimiters) && current != 0)
+				current = src[place++];
+
+			size_t length = place - initial;
+
+			if (length == 1)
+				tokens.push_back({ std::string(1, current), initial });
+			else
+				tokens.push_back({ source.substr(initial, --place - initial), initial });
+
+			if (tokens.back().Value.front() == 0)
+				return tokens;
+		}
+	}
+
+	struct TokenClasses
+	{
+		std::string Spaces;
+		std::string Delimiters;
+	};
+
+	// the include resolver's set, a set too large for the block scan, and the degenerate ones
+	const std::vector<TokenClasses> sTokenClasses =
+	{
+		{ " \t", "#<>\"\n" },
+		{ " \t\n\r", "(){}[];,.+-*/=<>!&|^%~?:#\"" },
+		{ " \t\r\n\v\f", "" },
+		{ " ", "" },
+		{ "", "" },
+	};
+
+	std::pair<int, int> LineAndColumn(std::string_view source, size_t position)
+	{
+		auto before = source.substr(0, position);
+		size_t lineStart = before.rfind('\n');
+
+		int line = static_cast<int>(std::ranges::count(before, '\n'));
+		int column = static_cast<int>(lineStart == std::string_view::npos ? position : position - lineStart - 1);
+
+		return { line, column };
+	}
+
+	// the wrapper, the scanner and the reference agree on every token, the wrapper's lines and columns are exact
+	void CheckSameTokens(const std::string& source, const TokenClasses& classes)
+	{
+		auto reference = ReferenceLex(source, 0, classes.Spaces, classes.Delimiters);
+
+		vkLib::Lexer lexer(source);
+		lexer.SetWhiteSpacesAndDelimiters(classes.Spaces, classes.Delimiters);
+
+		const auto& tokens = lexer.CreateTokenStream();
+
+		CHECK_EQ(tokens.size(), reference.size());
+
+		for (size_t i = 0; i < tokens.size(); i++)
+		{
+			CHECK(tokens[i].Value == reference[i].Value);
+			CHECK_EQ(tokens[i].Position, reference[i].Position);
+
+			auto [line, column] = LineAndColumn(source, tokens[i].Position);
+
+			CHECK_EQ(tokens[i].LineNumber, line);
+			CHECK_EQ(tokens[i].CharOffset, column);
+		}
+
+		// the scanner stops before the null token the wrapper hands out
+		size_t index = 0;
+
+		for (vkLib::TokenView token : TokenScanner(source, CharClassTable(classes.Spaces, classes.Delimiters)))
+		{
+			CHECK(index + 1 < tokens.size());
+			CHECK(token.Value == tokens[index].Value);
+			CHECK_EQ(token.Position, tokens[index].Position);
+			CHECK_EQ(token.LineNumber, tokens[index].LineNumber);
+			CHECK_EQ(token.CharOffset, tokens[index].CharOffset);
+
+			index++;
+		}
+
+		CHECK_EQ(index + 1, tokens.size());
+	}
+
+	std::string ReadSource(const std::filesystem::path& path)
+	{
+		std::ifstream stream(path, std::ios::binary);
+		return { std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
+	}
+
+	// every file of the Assets shaders, the includes too
+	std::vector<std::string> CollectAssetSources()
+	{
+		std::vector<std::string> sources;
+
+		std::error_code error;
+
+		for (const auto& file : std::filesystem::recursive_directory_iterator(Tests::sAssetShaderDirectory, error))
+		{
+			if (file.is_regular_file())
+				sources.push_back(ReadSource(file.path()));
+		}
+
+		return sources;
+	}
+
+	// runs of every length around the 16 byte blocks, mixing every class the sets know
+	std::string MakeRunSource(uint32_t seed, size_t size)
+	{
+		constexpr std::string_view sAlphabet = " \t\n#<>\"(){};,.=abcdefXYZ019_";
+
+		std::mt19937 random(seed);
+		std::uniform_int_distribution<size_t> pick(0, sAlphabet.size() - 1);
+		std::uniform_int_distribution<size_t> runLength(1, 40);
+
+		std::string source;
+
+		while (source.size() < size)
+			source.append(runLength(random), sAlphabet[pick(random)]);
+
+		source.resize(size);
+
+		return source;
+	}
+}
+
+TEST(Lexer, MatchesReferenceForAssetShaders)
+{
+	auto sources = CollectAssetSources();
+	CHECK(!sources.empty());
+
+	for (const auto& source : sources)
+	{
+		for (const auto& classes : sTokenClasses)
+			CheckSameTokens(source, classes);
+	}
+}
+
+TEST(Lexer, MatchesReferenceAcrossBlockBoundaries)
+{
+	CheckSameTokens("", sTokenClasses[0]);
+	CheckSameTokens("   \t  ", sTokenClasses[0]);
+	CheckSameTokens("#", sTokenClasses[0]);
+
+	// a token or a white space run ending on every offset of the first blocks
+	for (size_t length = 1; length <= 48; length++)
+	{
+		for (const auto& classes : sTokenClasses)
+		{
+			CheckSameTokens(std::string(length, 'x') + "#include <a>\n", classes);
+			CheckSameTokens(std::string(length, ' ') + "x" + std::string(length, '\t') + "\"y\"", classes);
+			CheckSameTokens(std::string(length, '\n') + std::string(length, 'z'), classes);
+		}
+	}
+
+	for (uint32_t seed = 0; seed < 64; seed++)
+	{
+		auto source = MakeRunSource(seed, 16 * (seed % 9) + seed % 17);
+
+		for (const auto& classes : sTokenClasses)
+			CheckSameTokens(source, classes);
+	}
+}
+
+TEST(Lexer, TableMatchesTheSets)
+{
+	for (const auto& classes : sTokenClasses)
+	{
+		CharClassTable table(classes.Spaces, classes.Delimiters);
+
+		for (int i = 0; i < 256; i++)
+		{
+			char val = static_cast<char>(i);
+
+			bool space = classes.Spaces.find(val) != std::string::npos;
+			bool delimiter = space || val == 0 || classes.Delimiters.find(val) != std::string::npos;
+
+			CHECK(table.IsWhiteSpace(val) == space);
+			CHECK(table.IsDelimiter(val) == delimiter);
+		}
+
+		// the block scans against a byte at a time from every starting point
+		auto source = MakeRunSource(classes.Delimiters.size(), 257);
+
+		for (size_t position = 0; position <= source.size(); position++)
+		{
+			size_t skipped = position;
+
+			while (skipped < source.size() && table.IsWhiteSpace(source[skipped]))
+				skipped++;
+
+			size_t delimiter = position;
+
+			while (delimiter < source.size() && !table.IsDelimiter(source[delimiter]))
+				delimiter++;
+
+			CHECK_EQ(table.SkipWhiteSpaces(source, position), skipped);
+			CHECK_EQ(table.FindDelimiter(source, position), delimiter);
+		}
+	}
+}
+
+TEST(Lexer, NullCharacterEndsTheSource)
+{
+	std::string source("ab #c\0d e", 9);
+
+	for (const auto& classes : sTokenClasses)
+	{
+		vkLib::Lexer lexer(source);
+		lexer.SetWhiteSpacesAndDelimiters(classes.Spaces, classes.Delimiters);
+
+		const auto& tokens = lexer.CreateTokenStream();
+		auto reference = ReferenceLex(source, 0, classes.Spaces, classes.Delimiters);
+
+		CHECK_EQ(tokens.size(), reference.size());
+		CHECK(tokens.back().Value == std::string(1, '\0'));
+		CHECK_EQ(tokens.back().Position, size_t(5));
+
+		for (size_t i = 0; i < tokens.size(); i++)
+			CHECK(tokens[i].Value == reference[i].Value);
+	}
+
+	// reading on past the end keeps handing out the end
+	vkLib::Lexer lexer("a");
+	lexer.SetWhiteSpacesAndDelimiters(" ", "");
+
+	CHECK(lexer.NextToken().Value == "a");
+
+	for (int i = 0; i < 3; i++)
+		CHECK(lexer.NextToken().Value == std::string(1, '\0'));
+}
+
+TEST(Lexer, SetCursorRecountsLines)
+{
+	const std::string source = "#version 440\n\n#include \"a.glsl\"\n  #include <b.glsl>\nvoid main() {}\n";
+	const auto& classes = sTokenClasses[0];
+
+	for (size_t position = 0; position <= source.size(); position++)
+	{
+		auto reference = ReferenceLex(source, position, classes.Spaces, classes.Delimiters);
+
+		vkLib::Lexer lexer(source);
+		lexer.SetWhiteSpacesAndDelimiters(classes.Spaces, classes.Delimiters);
+		lexer.SetCursor(position);
+
+		TokenScanner scanner(source, CharClassTable(classes.Spaces, classes.Delimiters));
+		scanner.SetCursor(position);
+
+		for (const auto& expected : reference)
+		{
+			const auto& token = lexer.NextToken();
+			auto [line, column] = LineAndColumn(source, expected.Position);
+
+			CHECK(token.Value == expected.Value);
+			CHECK_EQ(token.Position, expected.Position);
+			CHECK_EQ(token.LineNumber, line);
+			CHECK_EQ(token.CharOffset, column);
+
+			auto view = scanner.Next();
+
+			CHECK(view.Value == std::string_view(expected.Value).substr(0, expected.Value.front() ? std::string::npos : 0));
+			CHECK_EQ(view.LineNumber, line);
+		}
+	}
+
+	// positions past the end are clamped
+	TokenScanner scanner(source, CharClassTable(classes.Spaces, classes.Delimiters));
+	scanner.SetCursor(source.size() + 10);
+
+	CHECK_EQ(scanner.GetCursor().Position, source.size());
+	CHECK(scanner.Next().Value.empty());
+}
+
+BENCHMARK(Lexer, MBPerSecond)
+{
+	std::string source;
+
+	for (const auto& asset : CollectAssetSources())
+		source += asset;
+
+	if (source.empty())
+		source = MakeRunSource(0, 1 << 16);
+
+	while (source.size() < (16 << 20))
+		source += source;
+
+	for (const auto& classes : { sTokenClasses[0], sTokenClasses[1] })
+	{
+		auto rate = [&source](double seconds) { return source.size() / 1e6 / seconds; };
+
+		size_t referenceCount = 0, lexerCount = 0, scannerCount = 0;
+
+		double reference = Tests::MeasureSeconds([&]()
+		{
+			referenceCount = ReferenceLex(source, 0, classes.Spaces, classes.Delimiters).size();
+		});
+
+		double lexer = Tests::MeasureSeconds([&]()
+		{
+			vkLib::Lexer lexer(source);
+			lexer.SetWhiteSpacesAndDelimiters(classes.Spaces, classes.Delimiters);
+			lexerCount = lexer.CreateTokenStream().size();
+		});
+
+		double scanner = Tests::MeasureSeconds([&]()
+		{
+			for (vkLib::TokenView token : TokenScanner(source, CharClassTable(classes.Spaces, classes.Delimiters)))
+			{
+				Tests::DoNotOptimize(token);
+				scannerCount++;
+			}
+		});
+
+		CHECK(referenceCount == lexerCount && lexerCount == scannerCount + 1);
+
+		std::cout << "\t" << classes.Delimiters.size() + classes.Spaces.size() << " delimiters, "
+			<< source.size() / (1 << 20) << " MB: reference " << rate(reference) << " MB/s, lexer "
+			<< rate(lexer) << " MB/s, scanner " << rate(scanner) << " MB/s" << std::endl;
+	}
+}
@@ -0,0 +1,309 @@
+#include "TestRunner.h"
+#include "Memory/LinearRingAllocator.h"
+
+namespace
+{
+	using vkLib::Core::LinearRingAllocator;
+	constexpr uint64_t sInvalid = LinearRingAllocator::sInvalidOffset;
+
+	// stands in for the frame fences, the GPU finishes frames in submission order some frames behind the CPU
+	class FakeTimeline
+	{
+	public:
+		explicit FakeTimeline(uint32_t framesInFlight)
+			: mFramesInFlight(framesInFlight) {}
+
+		uint64_t Submit() { return mSubmitted++; }
+
+		// true if a frame is done that wasn't before, completed then holds the value of the last one
+		bool Advance(uint64_t& completed)
+		{
+			if (mSubmitted == 0 || mSubmitted - mCompleted < mFramesInFlight)
+				return false;
+
+			completed = mCompleted++;
+			return true;
+		}
+
+		// everything submitted so far has finished
+		uint64_t Drain()
+		{
+			mCompleted = mSubmitted;
+			return mSubmitted - 1;
+		}
+
+	private:
+		uint32_t mFramesInFlight = 0;
+		uint64_t mSubmitted = 0;
+		uint64_t mCompleted = 0;
+	};
+}
+
+TEST(LinearRingAllocator, AllocatesLinearlyWithAlignment)
+{
+	LinearRingAllocator ring(1024);
+
+	CHECK_EQ(ring.Allocate(10), uint64_t(0));
+	CHECK_EQ(ring.Allocate(16, 64), uint64_t(64));
+	CHECK_EQ(ring.Allocate(1, 256), uint64_t(256));
+
+	// padding counts towards the open frame
+	CHECK_EQ(ring.GetOpenFrameSize(), uint64_t(257));
+	CHECK_EQ(ring.GetUsedSize(), uint64_t(257));
+
+	CHECK_EQ(ring.Allocate(0), sInvalid);
+	CHECK_EQ(ring.Allocate(2048), sInvalid);
+}
+
+TEST(LinearRingAllocator, ReleasesFramesOnceTheirValueIsReached)
+{
+	LinearRingAllocator ring(1024);
+
+	ring.Allocate(100);
+	ring.EndFrame(1);
+
+	ring.Allocate(200);
+	ring.EndFrame(2);
+
+	CHECK_EQ(ring.GetPendingFrameCount(), size_t(2));
+	CHECK(ring.GetOldestPendingFrame() == std::optional<uint64_t>(1));
+
+	ring.Reclaim(0);
+	CHECK_EQ(ring.GetUsedSize(), uint64_t(300));
+
+	ring.Reclaim(1);
+	CHECK_EQ(ring.GetUsedSize(), uint64_t(200));
+	CHECK(ring.GetOldestPendingFrame() == std::optional<uint64_t>(2));
+
+	ring.Reclaim(5);
+	CHECK_EQ(ring.GetUsedSize(), uint64_t(0));
+	CHECK(!ring.GetOldestPendingFrame());
+}
+
+TEST(LinearRingAllocator, EmptyFramesAreNotTracked)
+{
+	LinearRingAllocator ring(1024);
+
+	ring.EndFrame(1);
+	ring.EndFrame(2);
+
+	CHECK_EQ(ring.GetPendingFrameCount(), size_t(0));
+}
+
+TEST(LinearRingAllocator, SkipsTheTailInsteadOfStraddling)
+{
+	LinearRingAllocator ring(1000);
+
+	CHECK_EQ(ring.Allocate(400), uint64_t(0));
+	ring.EndFrame(1);
+
+	CHECK_EQ(ring.Allocate(400), uint64_t(400));
+	ring.EndFrame(2);
+
+	ring.Reclaim(1);
+
+	// 200 bytes are left at the end, the allocation wraps to the front and the tail is wasted on it
+	CHECK_EQ(ring.Allocate(300), uint64_t(0));
+	CHECK_EQ(ring.GetOpenFrameSize(), uint64_t(500));
+
+	// the live frame at [400, 800) blocks anything bigger than the gap before it
+	CHECK_EQ(ring.Allocate(101), sInvalid);
+	CHECK_EQ(ring.Allocate(100), uint64_t(300));
+
+	ring.EndFrame(3);
+	ring.Reclaim(3);
+
+	// nothing live, the ring starts over at the front with its whole capacity
+	CHECK_EQ(ring.GetUsedSize(), uint64_t(0));
+	CHECK_EQ(ring.Allocate(1000), uint64_t(0));
+}
+
+TEST(LinearRingAllocator, SteadyStateWithFakeFences)
+{
+	constexpr uint32_t sFramesInFlight = 3;
+	constexpr uint64_t sFrameBytes = 3000;
+
+	// room for every frame in flight plus the worst case alignment and tail waste
+	LinearRingAllocator ring(sFramesInFlight * sFrameBytes + 2 * sFrameBytes);
+	FakeTimeline timeline(sFramesInFlight);
+
+	for (uint32_t frame = 0; frame < 1000; frame++)
+	{
+		uint64_t completed = 0;
+
+		if (timeline.Advance(completed))
+			ring.Reclaim(completed);
+
+		uint64_t allocated = 0;
+
+		while (allocated < sFrameBytes)
+		{
+			uint64_t size = 64 + (frame * 37 + allocated) % 200;
+
+			CHECK(ring.Allocate(size, 64) != sInvalid);
+			allocated += size;
+		}
+
+		ring.EndFrame(timeline.Submit());
+
+		CHECK(ring.GetPendingFrameCount() <= sFramesInFlight);
+	}
+
+	ring.Reclaim(timeline.Drain());
+	CHECK_EQ(ring.GetUsedSize(), uint64_t(0));
+}
+
+TEST(LinearRingAllocator, OwnershipFuzz)
+{
+	std::mt19937 random(7);
+
+	for (uint32_t round = 0; round < 200; round++)
+	{
+		const uint64_t capacity = 64 + random() % 2000;
+
+		LinearRingAllocator ring(capacity);
+
+		// frame owning every byte, -1 while it's free
+		std::vector<int64_t> owner(capacity, -1);
+
+		using Span = std::pair<uint64_t, uint64_t>;
+		std::deque<std::pair<uint64_t, std::vector<Span>>> closed;
+		std::vector<Span> open;
+
+		uint64_t frame = 0;
+		uint64_t completed = 0;
+
+		for (uint32_t step = 0; step < 2000; step++)
+		{
+			uint32_t action = random() % 10;
+
+			if (action < 6)
+			{
+				uint64_t size = 1 + random() % (capacity / 3 + 1);
+				uint64_t alignment = 1ull << (random() % 7);
+
+				uint64_t offset = ring.Allocate(size, alignment);
+
+				if (offset == sInvalid)
+					continue;
+
+				CHECK_EQ(offset % alignment, uint64_t(0));
+				CHECK(offset + size <= capacity);
+
+				// never hands out bytes a frame in flight still owns
+				for (uint64_t byte = offset; byte < offset + size; byte++)
+				{
+					CHECK_EQ(owner[byte], int64_t(-1));
+					owner[byte] = static_cast<int64_t>(frame);
+				}
+
+				open.push_back({ offset, size });
+			}
+			else if (action < 8)
+			{
+				ring.EndFrame(frame);
+
+				if (!open.empty())
+					closed.push_back({ frame, std::move(open) });
+
+				open.clear();
+				frame++;
+			}
+			else
+			{
+				completed = std::min<uint64_t>(completed + random() % 3, frame);
+
+				if (completed == 0)
+					continue;
+
+				ring.Reclaim(completed - 1);
+
+				while (!closed.empty() && closed.front().first <= completed - 1)
+				{
+					for (auto [offset, size] : closed.front().second)
+						std::fill_n(owner.begin() + offset, size, -1);
+
+					closed.pop_front();
+				}
+			}
+		}
+
+		// once everything is released the whole capacity is available again
+		ring.EndFrame(frame);
+		ring.Reclaim(frame);
+
+		CHECK_EQ(ring.GetUsedSize(), uint64_t(0));
+		CHECK_EQ(ring.Allocate(capacity), uint64_t(0));
+	}
+}
+
+BENCHMARK(LinearRingAllocator, PerFrameUploadOverhead)
+{
+	// what Environment::Update streams every frame, a camera, the model matrices and the light list
+	struct Camera { float View[16]; float Projection[16]; };
+	struct Light { float Position[4]; float Color[4]; };
+
+	constexpr uint32_t sFrames = 2000;
+	constexpr uint32_t sModelCount = 1000;
+	constexpr uint32_t sLightCount = 64;
+	constexpr uint32_t sFramesInFlight = 3;
+
+	std::vector<std::array<float, 16>> models(sModelCount);
+	std::vector<Light> lights(sLightCount);
+	Camera camera{};
+
+	constexpr uint64_t sFrameBytes = sizeof(Camera) + sModelCount * 64 + sLightCount * sizeof(Light) + 3 * 256;
+
+	std::vector<std::byte> mapped((sFramesInFlight + 1) * sFrameBytes);
+	LinearRingAllocator ring(mapped.size());
+	FakeTimeline timeline(sFramesInFlight);
+
+	auto push = [&](const void* data, uint64_t size)
+	{
+		uint64_t offset = ring.Allocate(size, 256);
+		std::memcpy(mapped.data() + offset, data, size);
+	};
+
+	double ringSeconds = Tests::MeasureSeconds([&]()
+	{
+		for (uint32_t frame = 0; frame < sFrames; frame++)
+		{
+			uint64_t completed = 0;
+
+			if (timeline.Advance(completed))
+				ring.Reclaim(completed);
+
+			push(&camera, sizeof(camera));
+			push(models.data(), models.size() * sizeof(models[0]));
+			push(lights.data(), lights.size() * sizeof(lights[0]));
+
+			ring.EndFrame(timeline.Submit());
+		}
+	});
+
+	// the previous path, every buffer cleared and streamed back into
+	std::vector<std::byte> cameraBuffer, modelBuffer, lightBuffer;
+
+	auto stream = [](std::vector<std::byte>& buffer, const void* data, uint64_t size)
+	{
+		buffer.clear();
+		buffer.shrink_to_fit();
+		buffer.insert(buffer.end(), static_cast<const std::byte*>(data), static_cast<const std::byte*>(data) + size);
+	};
+
+	double clearSeconds = Tests::MeasureSeconds([&]()
+	{
+		for (uint32_t frame = 0; frame < sFrames; frame++)
+		{
+			stream(cameraBuffer, &camera, sizeof(camera));
+			stream(modelBuffer, models.data(), models.size() * sizeof(models[0]));
+			stream(lightBuffer, lights.data(), lights.size() * sizeof(lights[0]));
+		}
+	});
+
+	Tests::DoNotOptimize(mapped.data());
+	Tests::DoNotOptimize(modelBuffer.data());
+
+	std::cout << "\tring: " << ringSeconds * 1e6 / sFrames << " us per frame, clear and restream: "
+		<< clearSeconds * 1e6 / sFrames << " us per frame" << std::endl;
+}
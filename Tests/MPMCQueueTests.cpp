@@ -0,0 +1,310 @@
+#include "TestRunner.h"
+#include "Core/MPMCQueue.h"
+
+namespace
+{
+	using Queue = vkLib::Core::MPMCQueue<uint64_t>;
+
+	uint64_t Encode(uint32_t producer, uint32_t sequence) { return (uint64_t(producer) << 32) | sequence; }
+	uint32_t ProducerOf(uint64_t value) { return static_cast<uint32_t>(value >> 32); }
+	uint32_t SequenceOf(uint64_t value) { return static_cast<uint32_t>(value); }
+
+	// the baseline the queue is meant to replace, a bounded deque behind one mutex
+	class LockedQueue
+	{
+	public:
+		explicit LockedQueue(size_t capacity)
+			: mCapacity(capacity) {}
+
+		void Push(uint64_t value)
+		{
+			std::unique_lock locker(mLock);
+			mNotFull.wait(locker, [this]() { return mItems.size() < mCapacity; });
+
+			mItems.push_back(value);
+
+			locker.unlock();
+			mNotEmpty.notify_one();
+		}
+
+		uint64_t Pop()
+		{
+			std::unique_lock locker(mLock);
+			mNotEmpty.wait(locker, [this]() { return !mItems.empty(); });
+
+			uint64_t value = mItems.front();
+			mItems.pop_front();
+
+			locker.unlock();
+			mNotFull.notify_one();
+
+			return value;
+		}
+
+	private:
+		size_t mCapacity;
+		std::mutex mLock;
+		std::condition_variable mNotFull;
+		std::condition_variable mNotEmpty;
+		std::deque<uint64_t> mItems;
+	};
+
+	// producers push through every entry point, consumers pop through every entry point
+	// each value must come out exactly once, and a consumer must see each producer's values in push order
+	void StressLinearizability(uint32_t producerCount, uint32_t consumerCount, uint32_t perProducer, size_t capacity)
+	{
+		Queue queue(capacity);
+
+		const uint64_t total = uint64_t(producerCount) * perProducer;
+		std::atomic<uint64_t> popped = 0;
+
+		std::vector<std::vector<uint64_t>> received(consumerCount);
+		std::vector<std::jthread> threads;
+
+		for (uint32_t p = 0; p < producerCount; p++)
+		{
+			threads.emplace_back([&queue, p, perProducer]()
+			{
+				uint32_t sequence = 0;
+
+				while (sequence < perProducer)
+				{
+					switch (sequence % 3)
+					{
+					case 0:
+						queue.Push(Encode(p, sequence++));
+						break;
+					case 1:
+						if (queue.TryPush(Encode(p, sequence)))
+							sequence++;
+						break;
+					default:
+					{
+						uint64_t batch[4];
+						uint32_t count = std::min(4u, perProducer - sequence);
+
+						for (uint32_t i = 0; i < count; i++)
+							batch[i] = Encode(p, sequence + i);
+
+						sequence += static_cast<uint32_t>(queue.TryPushBatch(batch, batch + count));
+						break;
+					}
+					}
+				}
+			});
+		}
+
+		for (uint32_t c = 0; c < consumerCount; c++)
+		{
+			threads.emplace_back([&queue, &popped, &received, c, total]()
+			{
+				auto& mine = received[c];
+				uint64_t batch[4];
+
+				while (popped.load(std::memory_order_relaxed) < total)
+				{
+					size_t count = 0;
+
+					if (mine.size() % 2 == 0)
+					{
+						count = queue.TryPopBatch(batch, 4);
+					}
+					else if (queue.TryPop(batch[0]))
+					{
+						count = 1;
+					}
+
+					if (count == 0)
+					{
+						std::this_thread::yield();
+						continue;
+					}
+
+					mine.insert(mine.end(), batch, batch + count);
+					popped.fetch_add(count, std::memory_order_relaxed);
+				}
+			});
+		}
+
+		threads.clear();
+
+		CHECK_EQ(popped.load(), total);
+		CHECK(queue.IsEmpty());
+
+		std::vector<uint32_t> seen(producerCount * perProducer, 0);
+
+		for (const auto& mine : received)
+		{
+			std::vector<int64_t> last(producerCount, -1);
+
+			for (uint64_t value : mine)
+			{
+				uint32_t producer = ProducerOf(value);
+				uint32_t sequence = SequenceOf(value);
+
+				CHECK(producer < producerCount && sequence < perProducer);
+				CHECK(int64_t(sequence) > last[producer]);
+
+				last[producer] = sequence;
+				seen[producer * perProducer + sequence]++;
+			}
+		}
+
+		CHECK(std::ranges::all_of(seen, [](uint32_t count) { return count == 1; }));
+	}
+
+	template <typename QueueType>
+	double MeasureThroughput(uint32_t producerCount, uint32_t consumerCount, uint32_t total)
+	{
+		QueueType queue(1024);
+
+		uint32_t perProducer = total / producerCount;
+		uint32_t perConsumer = (perProducer * producerCount) / consumerCount;
+
+		return Tests::MeasureSeconds([&]()
+		{
+			std::vector<std::jthread> threads;
+
+			for (uint32_t p = 0; p < producerCount; p++)
+			{
+				threads.emplace_back([&queue, perProducer, p]()
+				{
+					for (uint32_t i = 0; i < perProducer; i++)
+						queue.Push(Encode(p, i));
+				});
+			}
+
+			for (uint32_t c = 0; c < consumerCount; c++)
+			{
+				threads.emplace_back([&queue, perConsumer]()
+				{
+					for (uint32_t i = 0; i < perConsumer; i++)
+						Tests::DoNotOptimize(queue.Pop());
+				});
+			}
+		});
+	}
+}
+
+TEST(MPMCQueue, RoundsCapacityUp)
+{
+	CHECK_EQ(Queue(0).GetCapacity(), size_t(2));
+	CHECK_EQ(Queue(5).GetCapacity(), size_t(8));
+	CHECK_EQ(Queue(64).GetCapacity(), size_t(64));
+}
+
+TEST(MPMCQueue, FifoAcrossLaps)
+{
+	Queue queue(4);
+	uint64_t next = 0;
+	uint64_t expected = 0;
+
+	for (uint32_t lap = 0; lap < 5; lap++)
+	{
+		while (queue.TryPush(next))
+			next++;
+
+		CHECK_EQ(queue.GetSize(), size_t(4));
+
+		uint64_t value = 0;
+
+		while (queue.TryPop(value))
+			CHECK_EQ(value, expected++);
+
+		CHECK(queue.IsEmpty());
+	}
+
+	CHECK_EQ(expected, uint64_t(20));
+}
+
+TEST(MPMCQueue, BatchesStopAtTheBounds)
+{
+	Queue queue(8);
+
+	std::vector<uint64_t> values(10);
+	std::iota(values.begin(), values.end(), 0);
+
+	// only as many as fit
+	CHECK_EQ(queue.TryPushBatch(values.begin(), values.end()), size_t(8));
+	CHECK_EQ(queue.TryPushBatch(values.begin(), values.end()), size_t(0));
+
+	std::vector<uint64_t> out;
+
+	CHECK_EQ(queue.TryPopBatch(std::back_inserter(out), 3), size_t(3));
+	CHECK_EQ(queue.TryPushBatch(values.begin() + 8, values.end()), size_t(2));
+	CHECK_EQ(queue.TryPopBatch(std::back_inserter(out), 100), size_t(7));
+	CHECK_EQ(queue.TryPopBatch(std::back_inserter(out), 100), size_t(0));
+
+	CHECK((out == std::vector<uint64_t>{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+}
+
+TEST(MPMCQueue, DestroysWhatIsLeft)
+{
+	auto payload = std::make_shared<int>(0);
+
+	{
+		vkLib::Core::MPMCQueue<std::shared_ptr<int>> queue(8);
+
+		for (int i = 0; i < 5; i++)
+			queue.Push(payload);
+
+		std::shared_ptr<int> popped;
+		CHECK(queue.TryPop(popped));
+		popped.reset();
+
+		CHECK_EQ(payload.use_count(), long(5));
+	}
+
+	CHECK_EQ(payload.use_count(), long(1));
+}
+
+TEST(MPMCQueue, BlockedSidesWakeUp)
+{
+	Queue queue(2);
+	std::atomic<uint32_t> consumed = 0;
+	std::atomic<bool> inOrder = true;
+
+	// the consumer parks on an empty queue
+	std::jthread consumer([&]()
+	{
+		for (uint64_t i = 0; i < 64; i++)
+		{
+			if (queue.Pop() != i)
+				inOrder = false;
+
+			consumed++;
+		}
+	});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	CHECK_EQ(consumed.load(), 0u);
+
+	// and the producer parks on a full one whenever the consumer falls behind
+	for (uint64_t i = 0; i < 64; i++)
+		queue.Push(i);
+
+	consumer.join();
+	CHECK_EQ(consumed.load(), 64u);
+	CHECK(inOrder.load());
+}
+
+TEST(MPMCQueue, LinearizabilityStress)
+{
+	StressLinearizability(1, 1, 20'000, 16);
+	StressLinearizability(4, 4, 10'000, 64);
+	StressLinearizability(8, 2, 5'000, 8);
+}
+
+BENCHMARK(MPMCQueue, ThroughputVsLockedDeque)
+{
+	constexpr uint32_t sTotal = 400'000;
+
+	for (auto [producers, consumers] : { std::pair{ 1u, 1u }, std::pair{ 4u, 4u }, std::pair{ 16u, 1u } })
+	{
+		double queueSeconds = MeasureThroughput<Queue>(producers, consumers, sTotal);
+		double lockedSeconds = MeasureThroughput<LockedQueue>(producers, consumers, sTotal);
+
+		std::cout << "\t" << producers << ":" << consumers << " MPMCQueue " << sTotal / queueSeconds / 1e6
+			<< " M/s, mutex + deque " << sTotal / lockedSeconds / 1e6 << " M/s" << std::endl;
+	}
+}
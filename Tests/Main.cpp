@@ -0,0 +1,62 @@
+#include "TestRunner.h"
+
+// CPU side tests of vkLib, nothing here needs a device
+// Usage: Tests [filter] [--bench]
+// Runs every test whose "Suite.Name" contains filter, --bench runs the benchmarks instead of the tests
+
+int main(int argc, char** argv)
+{
+	std::string filter;
+	bool runBenchmarks = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+
+		if (arg == "--bench")
+			runBenchmarks = true;
+		else
+			filter = arg;
+	}
+
+	size_t passed = 0;
+	std::vector<std::string> failures;
+
+	for (const auto& test : Tests::GetRegistry())
+	{
+		std::string name = std::string(test.Suite) + "." + test.Name;
+
+		if (test.Benchmark != runBenchmarks)
+			continue;
+
+		if (!filter.empty() && name.find(filter) == std::string::npos)
+			continue;
+
+		std::cout << "[ RUN  ] " << name << std::endl;
+
+		try
+		{
+			test.Run();
+
+			std::cout << "[  OK  ] " << name << std::endl;
+			passed++;
+		}
+		catch (const Tests::TestFailure& failure)
+		{
+			std::cout << "[ FAIL ] " << name << "\n\t" << failure.Message << std::endl;
+			failures.push_back(name);
+		}
+		catch (const std::exception& exception)
+		{
+			std::cout << "[ FAIL ] " << name << "\n\tunexpected exception: " << exception.what() << std::endl;
+			failures.push_back(name);
+		}
+	}
+
+	std::cout << "\n" << passed << " passed, " << failures.size() << " failed" << std::endl;
+
+	for (const auto& name : failures)
+		std::cout << "\tfailed: " << name << std::endl;
+
+	return failures.empty() ? 0 : 1;
+}
@@ -0,0 +1,333 @@
+#include "TestRunner.h"
+#include "Memory/MemoryTelemetry.h"
+
+namespace
+{
+	using vkLib::Core::MemoryTelemetry;
+	using vkLib::Core::MemoryUsage;
+	using vkLib::Core::HeapBudget;
+
+	constexpr vk::DeviceSize sMiB = 1024 * 1024;
+
+	// a discrete gpu, types 0 and 1 in vram, types 2 and 3 in system memory
+	MemoryTelemetry MakeTelemetry()
+	{
+		HeapBudget vram{};
+		vram.Size = 8192 * sMiB;
+		vram.Budget = vram.Size;
+		vram.DeviceLocal = true;
+
+		HeapBudget system{};
+		system.Size = 16384 * sMiB;
+		system.Budget = system.Size;
+
+		return MemoryTelemetry({ 0, 0, 1, 1 }, { vram, system });
+	}
+
+	bool SameUsage(const MemoryUsage& usage, vk::DeviceSize current, vk::DeviceSize peak,
+		uint64_t live, uint64_t total)
+	{
+		return usage.Current == current && usage.Peak == peak
+			&& usage.LiveAllocations == live && usage.TotalAllocations == total;
+	}
+}
+
+TEST(MemoryTelemetry, TagsAreInterned)
+{
+	auto telemetry = MakeTelemetry();
+
+	uint32_t wavefront = telemetry.RegisterTag("Wavefront");
+	uint32_t shadows = telemetry.RegisterTag("ShadowMaps");
+
+	CHECK(wavefront != 0 && shadows != 0);
+	CHECK(wavefront != shadows);
+	CHECK_EQ(telemetry.RegisterTag(std::string("Wavefront")), wavefront);
+
+	// no name is the untagged bucket
+	CHECK_EQ(telemetry.RegisterTag(""), uint32_t(0));
+	CHECK_EQ(telemetry.RegisterTag(MemoryTelemetry::sUntagged), uint32_t(0));
+
+	auto usages = telemetry.GetTagUsages();
+
+	CHECK_EQ(usages.size(), size_t(3));
+	CHECK_EQ(usages[0].first, std::string(MemoryTelemetry::sUntagged));
+}
+
+TEST(MemoryTelemetry, AttributesToHeapsAndTags)
+{
+	auto telemetry = MakeTelemetry();
+
+	uint32_t wavefront = telemetry.RegisterTag("Wavefront");
+	uint32_t gbuffer = telemetry.RegisterTag("GBuffer");
+
+	telemetry.RecordAllocation(0, wavefront, 64 * sMiB);
+	telemetry.RecordAllocation(1, gbuffer, 32 * sMiB);
+	telemetry.RecordAllocation(3, wavefront, 4 * sMiB);
+	telemetry.RecordAllocation(2, 0, 1 * sMiB);
+
+	CHECK(SameUsage(telemetry.GetTotalUsage(), 101 * sMiB, 101 * sMiB, 4, 4));
+
+	// both memory types of a heap land in the same heap
+	CHECK(SameUsage(telemetry.GetHeapUsage(0), 96 * sMiB, 96 * sMiB, 2, 2));
+	CHECK(SameUsage(telemetry.GetHeapUsage(1), 5 * sMiB, 5 * sMiB, 2, 2));
+
+	CHECK(SameUsage(telemetry.GetTagUsage("Wavefront"), 68 * sMiB, 68 * sMiB, 2, 2));
+	CHECK(SameUsage(telemetry.GetTagUsage("GBuffer"), 32 * sMiB, 32 * sMiB, 1, 1));
+	CHECK(SameUsage(telemetry.GetTagUsage(""), 1 * sMiB, 1 * sMiB, 1, 1));
+
+	telemetry.RecordFree(0, wavefront, 64 * sMiB);
+
+	CHECK(SameUsage(telemetry.GetTagUsage("Wavefront"), 4 * sMiB, 68 * sMiB, 1, 2));
+	CHECK(SameUsage(telemetry.GetHeapUsage(0), 32 * sMiB, 96 * sMiB, 1, 2));
+	CHECK(SameUsage(telemetry.GetTotalUsage(), 37 * sMiB, 101 * sMiB, 3, 4));
+
+	// unknown names and heaps read as empty rather than failing
+	CHECK(SameUsage(telemetry.GetTagUsage("Unknown"), 0, 0, 0, 0));
+	CHECK(SameUsage(telemetry.GetHeapUsage(7), 0, 0, 0, 0));
+}
+
+TEST(MemoryTelemetry, PeaksRestartFromCurrent)
+{
+	auto telemetry = MakeTelemetry();
+	uint32_t tag = telemetry.RegisterTag("ResourcePool");
+
+	telemetry.RecordAllocation(0, tag, 100);
+	telemetry.RecordAllocation(0, tag, 200);
+	telemetry.RecordFree(0, tag, 200);
+	telemetry.RecordReservation(0, 1000);
+	telemetry.RecordRelease(0, 1000);
+
+	CHECK_EQ(telemetry.GetTotalUsage().Peak, vk::DeviceSize(300));
+	CHECK_EQ(telemetry.GetHeapReservation(0).Peak, vk::DeviceSize(1000));
+
+	telemetry.ResetPeaks();
+
+	CHECK_EQ(telemetry.GetTotalUsage().Peak, vk::DeviceSize(100));
+	CHECK_EQ(telemetry.GetHeapUsage(0).Peak, vk::DeviceSize(100));
+	CHECK_EQ(telemetry.GetTagUsage("ResourcePool").Peak, vk::DeviceSize(100));
+	CHECK_EQ(telemetry.GetHeapReservation(0).Peak, vk::DeviceSize(0));
+
+	// the allocation counters aren't touched
+	CHECK_EQ(telemetry.GetTotalUsage().TotalAllocations, uint64_t(2));
+}
+
+TEST(MemoryTelemetry, RetagMovesWithoutCountingAnAllocation)
+{
+	auto telemetry = MakeTelemetry();
+
+	uint32_t pool = telemetry.RegisterTag("Recycled");
+	uint32_t material = telemetry.RegisterTag("Material");
+
+	telemetry.RecordAllocation(2, pool, 4096);
+
+	auto total = telemetry.GetTotalUsage();
+	auto heap = telemetry.GetHeapUsage(1);
+
+	telemetry.RecordRetag(2, pool, material, 4096);
+
+	CHECK(SameUsage(telemetry.GetTagUsage("Recycled"), 0, 4096, 0, 1));
+	CHECK(SameUsage(telemetry.GetTagUsage("Material"), 4096, 4096, 1, 0));
+
+	// the buffer only changed hands, the totals don't see it
+	CHECK(SameUsage(telemetry.GetTotalUsage(), total.Current, total.Peak, total.LiveAllocations, total.TotalAllocations));
+	CHECK(SameUsage(telemetry.GetHeapUsage(1), heap.Current, heap.Peak, heap.LiveAllocations, heap.TotalAllocations));
+
+	// to the same tag is a no op
+	telemetry.RecordRetag(2, material, material, 4096);
+	CHECK(SameUsage(telemetry.GetTagUsage("Material"), 4096, 4096, 1, 0));
+
+	telemetry.RecordFree(2, material, 4096);
+	CHECK(SameUsage(telemetry.GetTotalUsage(), 0, 4096, 0, 1));
+}
+
+TEST(MemoryTelemetry, ReservationsAreSeparateFromResources)
+{
+	auto telemetry = MakeTelemetry();
+
+	// a block of the allocator with two buffers suballocated from it
+	telemetry.RecordReservation(0, 256 * sMiB);
+	telemetry.RecordAllocation(0, 0, 16 * sMiB);
+	telemetry.RecordAllocation(0, 0, 8 * sMiB);
+
+	CHECK(SameUsage(telemetry.GetHeapReservation(0), 256 * sMiB, 256 * sMiB, 1, 1));
+	CHECK(SameUsage(telemetry.GetHeapUsage(0), 24 * sMiB, 24 * sMiB, 2, 2));
+	CHECK(SameUsage(telemetry.GetHeapReservation(1), 0, 0, 0, 0));
+
+	// blocks aren't resources, the total only counts what was bound
+	CHECK_EQ(telemetry.GetTotalUsage().Current, 24 * sMiB);
+}
+
+TEST(MemoryTelemetry, BudgetUsageFallsBackToReservations)
+{
+	auto telemetry = MakeTelemetry();
+
+	telemetry.RecordReservation(0, 512 * sMiB);
+	telemetry.RecordReservation(2, 64 * sMiB);
+
+	auto budgets = telemetry.GetHeapBudgets();
+
+	CHECK_EQ(budgets.size(), size_t(2));
+	CHECK_EQ(budgets[0].Usage, 512 * sMiB);
+	CHECK_EQ(budgets[0].Budget, 8192 * sMiB);
+	CHECK(budgets[0].DeviceLocal && !budgets[1].DeviceLocal);
+	CHECK_EQ(budgets[1].Usage, 64 * sMiB);
+
+	// what VK_EXT_memory_budget reports wins, it includes other processes
+	auto reported = budgets;
+	reported[0].Budget = 6000 * sMiB;
+	reported[0].Usage = 1500 * sMiB;
+	reported[0].FromExtension = true;
+
+	telemetry.SetHeapBudgets(reported);
+	budgets = telemetry.GetHeapBudgets();
+
+	CHECK_EQ(budgets[0].Budget, 6000 * sMiB);
+	CHECK_EQ(budgets[0].Usage, 1500 * sMiB);
+	CHECK_EQ(budgets[1].Usage, 64 * sMiB);
+}
+
+TEST(MemoryTelemetry, FromMemoryProperties)
+{
+	vk::PhysicalDeviceMemoryProperties props{};
+
+	props.memoryHeapCount = 2;
+	props.memoryHeaps[0].size = 4096 * sMiB;
+	props.memoryHeaps[0].flags = vk::MemoryHeapFlagBits::eDeviceLocal;
+	props.memoryHeaps[1].size = 2048 * sMiB;
+
+	props.memoryTypeCount = 3;
+	props.memoryTypes[0].heapIndex = 1;
+	props.memoryTypes[1].heapIndex = 0;
+	props.memoryTypes[2].heapIndex = 1;
+
+	MemoryTelemetry telemetry(props);
+
+	CHECK_EQ(telemetry.GetHeapCount(), uint32_t(2));
+
+	telemetry.RecordAllocation(0, 0, 10);
+	telemetry.RecordAllocation(1, 0, 20);
+	telemetry.RecordAllocation(2, 0, 30);
+
+	CHECK_EQ(telemetry.GetHeapUsage(0).Current, vk::DeviceSize(20));
+	CHECK_EQ(telemetry.GetHeapUsage(1).Current, vk::DeviceSize(40));
+
+	auto budgets = telemetry.GetHeapBudgets();
+
+	CHECK(budgets[0].DeviceLocal && !budgets[1].DeviceLocal);
+	CHECK_EQ(budgets[0].Budget, 4096 * sMiB);
+	CHECK(!budgets[0].FromExtension);
+}
+
+TEST(MemoryTelemetry, DumpJson)
+{
+	auto telemetry = MakeTelemetry();
+
+	uint32_t tag = telemetry.RegisterTag("Shadow \"Maps\"\n");
+
+	telemetry.RecordReservation(0, 4096);
+	telemetry.RecordAllocation(0, tag, 1024);
+
+	std::string json = telemetry.DumpJson();
+
+	for (const char* key : { "\"total\"", "\"heaps\"", "\"tags\"", "\"index\"", "\"size\"", "\"budget\"",
+		"\"usage\"", "\"budget_source\"", "\"device_local\"", "\"reserved\"", "\"resources\"",
+		"\"current\"", "\"peak\"", "\"live_allocations\"", "\"total_allocations\"" })
+		CHECK(json.find(key) != std::string::npos);
+
+	CHECK(json.find("\"heap_size\"") != std::string::npos);
+	CHECK(json.find("\"device_local\": true") != std::string::npos);
+	CHECK(json.find("\"device_local\": false") != std::string::npos);
+
+	// the tag name is escaped, not pasted
+	CHECK(json.find("\"Shadow \\\"Maps\\\"\\n\"") != std::string::npos);
+	CHECK(json.find("Shadow \"Maps\"") == std::string::npos);
+
+	// balanced braces and brackets, a cheap stand in for a json parser
+	int64_t braces = 0, brackets = 0;
+	bool inString = false;
+
+	for (size_t i = 0; i < json.size(); i++)
+	{
+		if (inString)
+		{
+			if (json[i] == '\\')
+				i++;
+			else if (json[i] == '"')
+				inString = false;
+
+			continue;
+		}
+
+		switch (json[i])
+		{
+			case '"': inString = true; break;
+			case '{': braces++; break;
+			case '}': braces--; break;
+			case '[': brackets++; break;
+			case ']': brackets--; break;
+			default: break;
+		}
+
+		CHECK(braces >= 0 && brackets >= 0);
+	}
+
+	CHECK(!inString && braces == 0 && brackets == 0);
+}
+
+TEST(MemoryTelemetry, ConcurrentInjectedEvents)
+{
+	auto telemetry = MakeTelemetry();
+
+	constexpr uint32_t sThreads = 4;
+	constexpr uint32_t sEvents = 5000;
+
+	std::vector<std::thread> threads;
+
+	for (uint32_t t = 0; t < sThreads; t++)
+	{
+		threads.emplace_back([&telemetry, t]()
+		{
+			uint32_t tag = telemetry.RegisterTag("Thread" + std::to_string(t % 2));
+
+			// every allocation is freed again except the last one of each thread
+			for (uint32_t i = 0; i < sEvents; i++)
+			{
+				uint32_t type = (t + i) % 4;
+				vk::DeviceSize size = 256 * (1 + i % 8);
+
+				telemetry.RecordAllocation(type, tag, size);
+
+				if (i + 1 < sEvents)
+					telemetry.RecordFree(type, tag, size);
+			}
+		});
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	auto total = telemetry.GetTotalUsage();
+
+	CHECK_EQ(total.LiveAllocations, uint64_t(sThreads));
+	CHECK_EQ(total.TotalAllocations, uint64_t(sThreads * sEvents));
+
+	// the heaps and the tags add up to the total
+	MemoryUsage heaps{}, tags{};
+
+	for (uint32_t heap = 0; heap < telemetry.GetHeapCount(); heap++)
+	{
+		heaps.Current += telemetry.GetHeapUsage(heap).Current;
+		heaps.TotalAllocations += telemetry.GetHeapUsage(heap).TotalAllocations;
+	}
+
+	for (const auto& [name, usage] : telemetry.GetTagUsages())
+	{
+		tags.Current += usage.Current;
+		tags.TotalAllocations += usage.TotalAllocations;
+	}
+
+	CHECK_EQ(heaps.Current, total.Current);
+	CHECK_EQ(tags.Current, total.Current);
+	CHECK_EQ(heaps.TotalAllocations, total.TotalAllocations);
+	CHECK_EQ(tags.TotalAllocations, total.TotalAllocations);
+}
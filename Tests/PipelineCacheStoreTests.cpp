@@ -0,0 +1,167 @@
+#include "TestRunner.h"
+#include "Pipeline/PipelineCacheStore.h"
+
+namespace
+{
+	using vkLib::Core::PipelineCacheStore;
+	using vkLib::Core::PipelineCacheError;
+	using Tests::ScratchDirectory;
+
+	constexpr size_t sHeaderSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+
+	vk::PhysicalDeviceProperties DeviceProps()
+	{
+		vk::PhysicalDeviceProperties props{};
+		props.vendorID = 0x10DE;
+		props.deviceID = 0x2684;
+
+		for (uint32_t i = 0; i < VK_UUID_SIZE; i++)
+			props.pipelineCacheUUID[i] = static_cast<uint8_t>(i * 7 + 1);
+
+		return props;
+	}
+
+	// what a driver would hand back from getPipelineCacheData, a header followed by its own payload
+	std::vector<uint8_t> MakeBlob(const vk::PhysicalDeviceProperties& props, size_t payloadSize = 64,
+		uint32_t headerVersion = static_cast<uint32_t>(vk::PipelineCacheHeaderVersion::eOne),
+		uint32_t headerSize = static_cast<uint32_t>(sHeaderSize))
+	{
+		std::vector<uint8_t> blob(sHeaderSize + payloadSize);
+
+		std::memcpy(blob.data() + 0, &headerSize, sizeof(uint32_t));
+		std::memcpy(blob.data() + 4, &headerVersion, sizeof(uint32_t));
+		std::memcpy(blob.data() + 8, &props.vendorID, sizeof(uint32_t));
+		std::memcpy(blob.data() + 12, &props.deviceID, sizeof(uint32_t));
+		std::memcpy(blob.data() + 16, props.pipelineCacheUUID.data(), VK_UUID_SIZE);
+
+		for (size_t i = 0; i < payloadSize; i++)
+			blob[sHeaderSize + i] = static_cast<uint8_t>(i);
+
+		return blob;
+	}
+}
+
+TEST(PipelineCacheStore, ParsesTheHeader)
+{
+	auto props = DeviceProps();
+	auto header = PipelineCacheStore::ParseHeader(MakeBlob(props));
+
+	CHECK(header.has_value());
+	CHECK_EQ(header->HeaderSize, uint32_t(sHeaderSize));
+	CHECK_EQ(header->HeaderVersion, static_cast<uint32_t>(vk::PipelineCacheHeaderVersion::eOne));
+	CHECK_EQ(header->VendorID, props.vendorID);
+	CHECK_EQ(header->DeviceID, props.deviceID);
+	CHECK(std::ranges::equal(header->CacheUUID, props.pipelineCacheUUID));
+}
+
+TEST(PipelineCacheStore, RejectsTruncatedBlobs)
+{
+	auto props = DeviceProps();
+	auto blob = MakeBlob(props, 0);
+
+	// shorter than the header itself
+	for (size_t size : { size_t(0), size_t(4), sHeaderSize - 1 })
+	{
+		auto header = PipelineCacheStore::ParseHeader(std::span(blob.data(), size));
+		CHECK(!header && header.error() == PipelineCacheError::eTruncated);
+	}
+
+	// a header claiming to be smaller than the spec's or larger than the blob
+	auto tooSmall = PipelineCacheStore::ParseHeader(MakeBlob(props, 16,
+		static_cast<uint32_t>(vk::PipelineCacheHeaderVersion::eOne), 8));
+	CHECK(!tooSmall && tooSmall.error() == PipelineCacheError::eTruncated);
+
+	auto tooLarge = PipelineCacheStore::ParseHeader(MakeBlob(props, 16,
+		static_cast<uint32_t>(vk::PipelineCacheHeaderVersion::eOne), 4096));
+	CHECK(!tooLarge && tooLarge.error() == PipelineCacheError::eTruncated);
+}
+
+TEST(PipelineCacheStore, RejectsUnknownHeaderVersions)
+{
+	auto header = PipelineCacheStore::ParseHeader(MakeBlob(DeviceProps(), 64, 2));
+	CHECK(!header && header.error() == PipelineCacheError::eUnknownHeaderVersion);
+}
+
+TEST(PipelineCacheStore, ValidatesAgainstTheDevice)
+{
+	auto props = DeviceProps();
+	auto blob = MakeBlob(props);
+
+	CHECK(PipelineCacheStore::ValidateBlob(blob, props) == PipelineCacheError::eNone);
+
+	auto otherVendor = props;
+	otherVendor.vendorID = 0x1002;
+	CHECK(PipelineCacheStore::ValidateBlob(blob, otherVendor) == PipelineCacheError::eVendorMismatch);
+
+	auto otherDevice = props;
+	otherDevice.deviceID++;
+	CHECK(PipelineCacheStore::ValidateBlob(blob, otherDevice) == PipelineCacheError::eDeviceMismatch);
+
+	// same gpu after a driver update
+	auto otherDriver = props;
+	otherDriver.pipelineCacheUUID[VK_UUID_SIZE - 1] ^= 0xFF;
+	CHECK(PipelineCacheStore::ValidateBlob(blob, otherDriver) == PipelineCacheError::eUUIDMismatch);
+
+	CHECK(PipelineCacheStore::ValidateBlob({}, props) == PipelineCacheError::eTruncated);
+}
+
+TEST(PipelineCacheStore, MissingFile)
+{
+	ScratchDirectory scratch("PipelineCacheMissingFile");
+
+	auto blob = PipelineCacheStore::ReadBlob(scratch.GetPath() / "missing.bin");
+	CHECK(!blob && blob.error() == PipelineCacheError::eFileNotFound);
+}
+
+TEST(PipelineCacheStore, WriteThenReadRoundTrips)
+{
+	ScratchDirectory scratch("PipelineCacheRoundTrip");
+
+	auto props = DeviceProps();
+	auto path = scratch.GetPath() / "nested" / "pipeline.cache";
+
+	// missing parent directories are created on the way
+	auto first = MakeBlob(props, 1024);
+	auto written = PipelineCacheStore::WriteBlobAtomic(path, first);
+
+	CHECK(written && *written == first.size());
+
+	auto read = PipelineCacheStore::ReadBlob(path);
+	CHECK(read && *read == first);
+	CHECK(PipelineCacheStore::ValidateBlob(*read, props) == PipelineCacheError::eNone);
+
+	// saving again replaces the file as a whole, a shorter blob leaves nothing of the old one behind
+	auto second = MakeBlob(props, 8);
+	CHECK(PipelineCacheStore::WriteBlobAtomic(path, second).has_value());
+
+	read = PipelineCacheStore::ReadBlob(path);
+	CHECK(read && *read == second);
+
+	// and the temporary doesn't linger next to it
+	auto temporary = path;
+	temporary += ".tmp";
+
+	CHECK(!std::filesystem::exists(temporary));
+}
+
+TEST(PipelineCacheStore, FailedWriteKeepsThePreviousCache)
+{
+	ScratchDirectory scratch("PipelineCacheFailedWrite");
+
+	auto props = DeviceProps();
+	auto path = scratch.GetPath() / "pipeline.cache";
+
+	auto previous = MakeBlob(props, 32);
+	CHECK(PipelineCacheStore::WriteBlobAtomic(path, previous).has_value());
+
+	// the temporary can't be created where a directory of the same name already sits
+	auto blocker = path;
+	blocker += ".tmp";
+	std::filesystem::create_directories(blocker / "occupied");
+
+	auto written = PipelineCacheStore::WriteBlobAtomic(path, MakeBlob(props, 64));
+	CHECK(!written && written.error() == PipelineCacheError::eWriteFailed);
+
+	auto read = PipelineCacheStore::ReadBlob(path);
+	CHECK(read && *read == previous);
+}
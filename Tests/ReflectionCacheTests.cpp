@@ -0,0 +1,303 @@
+#include "ShaderTestUtils.h"
+#include "ShaderCompiler/ReflectionCache.h"
+#include "ShaderCompiler/SPIRVCache.h"
+#include "Pipeline/PShader.h"
+
+namespace
+{
+	using vkLib::ReflectionCache;
+	using vkLib::ReflectionData;
+
+	constexpr auto sCompute = vk::ShaderStageFlagBits::eCompute;
+	constexpr auto sFragment = vk::ShaderStageFlagBits::eFragment;
+
+	ReflectionData MakeData(uint32_t groupSize)
+	{
+		ReflectionData data;
+		data.MetaData.ShaderType = sCompute;
+		data.MetaData.WorkGroupSize = { groupSize, 1, 1 };
+
+		return data;
+	}
+
+	// everything ShaderCompiler reflects, the spirv_cross types by the fields the pipelines read
+	void CheckSameReflection(const vkLib::CompileResult& cached, const vkLib::CompileResult& fresh)
+	{
+		CHECK(cached.MetaData.ShaderType == fresh.MetaData.ShaderType);
+		CHECK(cached.MetaData.WorkGroupSize == fresh.MetaData.WorkGroupSize);
+		CHECK(cached.MetaData.WorkGroupSizeIDs == fresh.MetaData.WorkGroupSizeIDs);
+		CHECK_EQ(cached.MetaData.SpecConstants.size(), fresh.MetaData.SpecConstants.size());
+
+		for (size_t i = 0; i < fresh.MetaData.SpecConstants.size(); i++)
+		{
+			const auto& lhs = cached.MetaData.SpecConstants[i];
+			const auto& rhs = fresh.MetaData.SpecConstants[i];
+
+			CHECK(lhs.ConstantID == rhs.ConstantID && lhs.Name == rhs.Name);
+			CHECK(lhs.Type == rhs.Type && lhs.DefaultValue == rhs.DefaultValue);
+		}
+
+		CHECK_EQ(cached.LayoutData.DescInfos.size(), fresh.LayoutData.DescInfos.size());
+
+		for (size_t i = 0; i < fresh.LayoutData.DescInfos.size(); i++)
+		{
+			const auto& lhs = cached.LayoutData.DescInfos[i];
+			const auto& rhs = fresh.LayoutData.DescInfos[i];
+
+			CHECK(lhs.SetIndex == rhs.SetIndex && lhs.BindingIndex == rhs.BindingIndex);
+			CHECK(lhs.Name == rhs.Name && lhs.DescType == rhs.DescType);
+			CHECK(lhs.DescReflectionInfo.basetype == rhs.DescReflectionInfo.basetype);
+			CHECK(lhs.DescReflectionInfo.vecsize == rhs.DescReflectionInfo.vecsize);
+			CHECK(lhs.DescReflectionInfo.columns == rhs.DescReflectionInfo.columns);
+		}
+
+		CHECK(cached.LayoutData.PushConstantsData == fresh.LayoutData.PushConstantsData);
+		CHECK(cached.LayoutData.PushConstantSubrangeInfos == fresh.LayoutData.PushConstantSubrangeInfos);
+		CHECK(cached.SetLayoutBindingsMap == fresh.SetLayoutBindingsMap);
+	}
+
+	// exposes what CompileShaders merged out of the stages
+	class MergedShader : public vkLib::PShader
+	{
+	public:
+		const vkLib::DescSetLayoutBindingMap& GetMergedBindings() const { return mPipelineSetLayoutInfo; }
+	};
+
+	const vk::DescriptorSetLayoutBinding* FindBinding(const vkLib::DescSetLayoutBindingMap& map,
+		uint32_t set, uint32_t binding)
+	{
+		auto found = map.find(set);
+
+		if (found == map.end())
+			return nullptr;
+
+		for (const auto& entry : found->second)
+		{
+			if (entry.binding == binding)
+				return &entry;
+		}
+
+		return nullptr;
+	}
+}
+
+TEST(ReflectionCache, KeyCoversWordsAndStage)
+{
+	std::vector<uint32_t> words = { 0x07230203, 0x00010600, 0, 12, 0 };
+
+	auto key = ReflectionCache::ComputeKey(words, sCompute);
+
+	CHECK(key == ReflectionCache::ComputeKey(words, sCompute));
+	CHECK(!(key == ReflectionCache::ComputeKey(words, sFragment)));
+
+	// every word counts, and so does the length
+	for (size_t i = 0; i < words.size(); i++)
+	{
+		auto changed = words;
+		changed[i] ^= 1u << (i * 5);
+
+		CHECK(!(key == ReflectionCache::ComputeKey(changed, sCompute)));
+	}
+
+	auto longer = words;
+	longer.push_back(0);
+
+	CHECK(!(key == ReflectionCache::ComputeKey(longer, sCompute)));
+	CHECK(!(key == ReflectionCache::ComputeKey(std::span(words).first(4), sCompute)));
+}
+
+TEST(ReflectionCache, FindAndStore)
+{
+	ReflectionCache cache;
+
+	auto key = ReflectionCache::ComputeKey(std::vector<uint32_t>{ 1, 2, 3 }, sCompute);
+
+	CHECK(cache.Find(key) == nullptr);
+
+	auto stored = cache.Store(key, MakeData(64));
+
+	CHECK(cache.Find(key) == stored);
+	CHECK_EQ(stored->MetaData.WorkGroupSize.x, uint32_t(64));
+
+	// the same words reflect the same way, the first entry stays
+	auto second = cache.Store(key, MakeData(128));
+
+	CHECK(second == stored);
+	CHECK_EQ(cache.Find(key)->MetaData.WorkGroupSize.x, uint32_t(64));
+	CHECK_EQ(cache.GetEntryCount(), size_t(1));
+
+	auto stats = cache.GetStats();
+
+	CHECK_EQ(stats.Hits, uint64_t(2));
+	CHECK_EQ(stats.Misses, uint64_t(1));
+
+	// entries handed out survive a clear
+	cache.Clear();
+
+	CHECK(cache.Find(key) == nullptr);
+	CHECK_EQ(stored->MetaData.WorkGroupSize.x, uint32_t(64));
+}
+
+TEST(ReflectionCache, ConcurrentStoresAgree)
+{
+	ReflectionCache cache;
+
+	constexpr uint32_t sThreads = 4;
+	constexpr uint32_t sKeys = 64;
+
+	std::vector<std::vector<const ReflectionData*>> seen(sThreads, std::vector<const ReflectionData*>(sKeys));
+	std::vector<std::thread> threads;
+
+	for (uint32_t t = 0; t < sThreads; t++)
+	{
+		threads.emplace_back([&cache, &seen, t]()
+		{
+			for (uint32_t i = 0; i < sKeys; i++)
+			{
+				auto key = ReflectionCache::ComputeKey(std::vector<uint32_t>{ 0x07230203, i }, sCompute);
+				auto entry = cache.Find(key);
+
+				// racing threads reflect the same words, every one gets the entry that won
+				if (!entry)
+					entry = cache.Store(key, MakeData(i));
+
+				seen[t][i] = entry.get();
+			}
+		});
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	CHECK_EQ(cache.GetEntryCount(), size_t(sKeys));
+
+	for (uint32_t t = 1; t < sThreads; t++)
+		CHECK(seen[t] == seen[0]);
+}
+
+TEST(ReflectionCache, CachedMatchesFreshForAssetShaders)
+{
+	auto shaders = Tests::CollectAssetShaders();
+	CHECK(!shaders.empty());
+
+	auto cache = std::make_shared<ReflectionCache>();
+
+	auto cachedEnv = Tests::MakeIsolatedEnvironment();
+	cachedEnv.SetReflectionCache(cache);
+
+	// the first pass fills the cache
+	for (const auto& shader : shaders)
+		Tests::CompileAssetShader(cachedEnv, shader);
+
+	uint64_t missesAfterFirst = cache->GetStats().Misses;
+
+	for (const auto& shader : shaders)
+	{
+		auto cached = Tests::CompileAssetShader(cachedEnv, shader);
+
+		// its own empty cache, spirv-cross really runs
+		auto fresh = Tests::CompileAssetShader(Tests::MakeIsolatedEnvironment(), shader);
+
+		CHECK(fresh.Error.Type == vkLib::ErrorType::eNone);
+		CHECK(cached.SPIR_V.ByteCode == fresh.SPIR_V.ByteCode);
+		CheckSameReflection(cached, fresh);
+	}
+
+	// the second pass never reflected
+	CHECK_EQ(cache->GetStats().Misses, missesAfterFirst);
+	CHECK(cache->GetStats().Hits >= shaders.size());
+
+	// permutations compiling to the same code share an entry
+	CHECK(cache->GetEntryCount() <= shaders.size());
+}
+
+TEST(ReflectionCache, PipelineLayoutMergesStages)
+{
+	MergedShader shader;
+
+	shader.SetShader("eVertex",
+		"#version 440\n"
+		"layout(set = 0, binding = 0) uniform Camera { mat4 uProjection; };\n"
+		"layout(std430, set = 1, binding = 0) readonly buffer Positions { vec4 sPositions[]; };\n"
+		"void main() { gl_Position = uProjection * sPositions[gl_VertexIndex]; }\n");
+
+	shader.SetShader("eFragment",
+		"#version 440\n"
+		"layout(set = 0, binding = 0) uniform Camera { mat4 uProjection; };\n"
+		"layout(set = 0, binding = 1) uniform sampler2D uAlbedo[4];\n"
+		"layout(location = 0) out vec4 oColor;\n"
+		"void main() { oColor = uProjection[0] + texture(uAlbedo[1], vec2(0.5)); }\n");
+
+	auto errors = shader.CompileShaders();
+
+	for (const auto& error : errors)
+		CHECK(error.Type == vkLib::ErrorType::eNone);
+
+	const auto& bindings = shader.GetMergedBindings();
+
+	auto camera = FindBinding(bindings, 0, 0);
+	auto albedo = FindBinding(bindings, 0, 1);
+	auto positions = FindBinding(bindings, 1, 0);
+
+	// the shared uniform appears once, visible to both stages
+	CHECK(camera && albedo && positions);
+	CHECK_EQ(bindings.at(0).size(), size_t(2));
+	CHECK(camera->stageFlags == (vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment));
+
+	// the others keep their own stage only
+	CHECK(albedo->stageFlags == vk::ShaderStageFlags(vk::ShaderStageFlagBits::eFragment));
+	CHECK_EQ(albedo->descriptorCount, uint32_t(4));
+	CHECK(positions->stageFlags == vk::ShaderStageFlags(vk::ShaderStageFlagBits::eVertex));
+
+	CHECK_EQ(shader.GetCount(0, 1), uint32_t(4));
+	CHECK(shader.IsEmpty(2, 0));
+
+	// compiling again starts over rather than stacking the stages onto the old layout
+	shader.CompileShaders();
+
+	CHECK_EQ(shader.GetMergedBindings().at(0).size(), size_t(2));
+	CHECK(FindBinding(shader.GetMergedBindings(), 0, 0)->stageFlags == camera->stageFlags);
+}
+
+BENCHMARK(ReflectionCache, WavefrontReflectionSaved)
+{
+	Tests::ScratchDirectory scratch("ReflectionCacheBenchmark");
+
+	std::vector<Tests::AssetShader> wavefront;
+
+	for (auto& shader : Tests::CollectAssetShaders())
+	{
+		if (shader.Name.starts_with("Wavefront/"))
+			wavefront.push_back(std::move(shader));
+	}
+
+	CHECK(!wavefront.empty());
+
+	// the SPIR-V comes off disk, so a startup is mostly reading files and reflecting them
+	{
+		auto env = Tests::MakeIsolatedEnvironment();
+		env.SetSPIRVCache(std::make_shared<vkLib::SPIRVCache>(scratch.GetPath()));
+
+		for (const auto& shader : wavefront)
+			Tests::CompileAssetShader(env, shader);
+	}
+
+	auto reflectionCache = std::make_shared<ReflectionCache>();
+
+	auto startup = [&]()
+	{
+		auto env = Tests::MakeIsolatedEnvironment();
+		env.SetSPIRVCache(std::make_shared<vkLib::SPIRVCache>(scratch.GetPath()));
+		env.SetReflectionCache(reflectionCache);
+
+		for (const auto& shader : wavefront)
+			Tests::DoNotOptimize(Tests::CompileAssetShader(env, shader));
+	};
+
+	double cold = Tests::MeasureSeconds(startup);
+	double warm = Tests::MeasureSeconds(startup);
+
+	std::cout << "\t" << wavefront.size() << " wavefront pipelines from the SPIR-V cache's disk\n"
+		<< "\treflection cold: " << cold * 1e3 << " ms, warm: " << warm * 1e3 << " ms, saved "
+		<< (cold - warm) * 1e3 << " ms (" << reflectionCache->GetStats().Hits << " hits)" << std::endl;
+}
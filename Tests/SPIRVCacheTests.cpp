@@ -0,0 +1,341 @@
+#include "ShaderTestUtils.h"
+#include "ShaderCompiler/SPIRVCache.h"
+
+namespace
+{
+	using vkLib::SPIRVCache;
+	using vkLib::SPIRVCacheKey;
+	using Tests::ScratchDirectory;
+
+	constexpr auto sCompute = vk::ShaderStageFlagBits::eCompute;
+	constexpr auto sFragment = vk::ShaderStageFlagBits::eFragment;
+
+	constexpr const char* sSource = "#version 440\nlayout(local_size_x = 64) in;\nvoid main() {}\n";
+
+	SPIRVCacheKey Key(std::string_view source = sSource, vk::ShaderStageFlagBits stage = sCompute,
+		const vkLib::PreprocessorDirectives& macros = {}, vkLib::OptimizerFlag optimization = vkLib::OptimizerFlag::eO3,
+		const vkLib::CompilerConfig& config = Tests::GetShaderConfig())
+	{
+		return SPIRVCache::ComputeKey(source, stage, macros, optimization, config);
+	}
+
+	// a stored compilation, the cache doesn't look inside the words
+	vkLib::CompileResult MakeResult(std::vector<uint32_t> byteCode, vk::ShaderStageFlagBits stage = sCompute)
+	{
+		vkLib::CompileResult result;
+		result.SPIR_V.ByteCode = std::move(byteCode);
+		result.SPIR_V.Stage = stage;
+		result.MetaData.ShaderType = stage;
+		result.Error.SrcCode = sSource;
+		result.Error.PreprocessedCode = sSource;
+
+		return result;
+	}
+
+	std::filesystem::path EntryPath(const SPIRVCache& cache, const SPIRVCacheKey& key)
+	{
+		return cache.GetDirectory() / (key.ToString() + ".spv");
+	}
+
+	// a compute shader including a header of the same directory, the header decides the SPIR-V
+	std::filesystem::path WriteIncludingShader(const ScratchDirectory& scratch, uint32_t groupSize)
+	{
+		scratch.Write("Common.glsl", "#define GROUP_SIZE " + std::to_string(groupSize) + "\n");
+
+		return scratch.Write("Main.comp",
+			"#version 440\n"
+			"#include \"Common.glsl\"\n"
+			"layout(local_size_x = GROUP_SIZE) in;\n"
+			"layout(std430, set = 0, binding = 0) buffer Values { uint sValues[]; };\n"
+			"void main() { sValues[gl_GlobalInvocationID.x] *= 2; }\n");
+	}
+}
+
+TEST(SPIRVCache, KeyCoversEveryInput)
+{
+	auto reference = Key();
+
+	CHECK(reference == Key());
+	CHECK_EQ(reference.ToString().size(), size_t(32));
+
+	// the macro set is a set, the map's order doesn't matter
+	vkLib::PreprocessorDirectives macros = { { "A", "1" }, { "B", "2" } };
+	vkLib::PreprocessorDirectives reordered;
+	reordered["B"] = "2";
+	reordered["A"] = "1";
+
+	CHECK(Key(sSource, sCompute, macros) == Key(sSource, sCompute, reordered));
+
+	std::vector<SPIRVCacheKey> keys = {
+		reference,
+		Key("#version 440\nlayout(local_size_x = 32) in;\nvoid main() {}\n"),
+		Key(sSource, sFragment),
+		Key(sSource, sCompute, macros),
+		Key(sSource, sCompute, { { "A", "12" } }),
+		Key(sSource, sCompute, { { "A1", "2" } }),
+		Key(sSource, sCompute, {}, vkLib::OptimizerFlag::eNone),
+		Key(sSource, sCompute, {}, vkLib::OptimizerFlag::eO3 | vkLib::OptimizerFlag::eStripDebug),
+	};
+
+	auto config = Tests::GetShaderConfig();
+	config.SPV_Version = glslang::EShTargetLanguageVersion::EShTargetSpv_1_5;
+	keys.push_back(Key(sSource, sCompute, {}, vkLib::OptimizerFlag::eO3, config));
+
+	config = Tests::GetShaderConfig();
+	config.GlslVersion = 450;
+	keys.push_back(Key(sSource, sCompute, {}, vkLib::OptimizerFlag::eO3, config));
+
+	// "A"="12" and "A1"="2" concatenate the same way, the length prefixes keep them apart
+	for (size_t i = 0; i < keys.size(); i++)
+		for (size_t j = i + 1; j < keys.size(); j++)
+			CHECK(!(keys[i] == keys[j]));
+}
+
+TEST(SPIRVCache, MemoryOnly)
+{
+	SPIRVCache cache;
+
+	CHECK(cache.GetDirectory().empty());
+	CHECK(!cache.Find(Key()));
+	CHECK(!cache.Load(Key(), sCompute));
+
+	cache.Store(Key(), MakeResult({ 0x07230203, 1, 2, 3 }));
+
+	auto entry = cache.Find(Key());
+
+	CHECK(entry != nullptr);
+	CHECK((entry->SPIR_V.ByteCode == std::vector<uint32_t>{ 0x07230203, 1, 2, 3 }));
+
+	// the sources aren't kept
+	CHECK(entry->Error.SrcCode.empty() && entry->Error.PreprocessedCode.empty());
+
+	auto stats = cache.GetStats();
+
+	CHECK_EQ(stats.MemoryHits, uint64_t(1));
+	CHECK_EQ(stats.Misses, uint64_t(1));
+	CHECK_EQ(stats.Stores, uint64_t(1));
+	CHECK_EQ(stats.DiskWrites, uint64_t(0));
+}
+
+TEST(SPIRVCache, FailedCompilationsArentStored)
+{
+	SPIRVCache cache;
+
+	auto failed = MakeResult({ 0x07230203 });
+	failed.Error.Type = vkLib::ErrorType::eParsing;
+
+	cache.Store(Key(), failed);
+	cache.Store(Key(), MakeResult({}));
+
+	CHECK_EQ(cache.GetEntryCount(), size_t(0));
+}
+
+TEST(SPIRVCache, PersistsAcrossInstances)
+{
+	ScratchDirectory scratch("SPIRVCachePersists");
+
+	std::vector<uint32_t> byteCode = { 0x07230203, 0x00010600, 7, 8, 9 };
+
+	{
+		SPIRVCache cache(scratch.GetPath());
+
+		CHECK(cache.GetDirectory() == scratch.GetPath() / ("v" + std::to_string(SPIRVCache::sFormatVersion)));
+
+		cache.Store(Key(), MakeResult(byteCode));
+		CHECK_EQ(cache.GetStats().DiskWrites, uint64_t(1));
+
+		// written through a temporary that doesn't stay behind
+		size_t files = 0;
+
+		for (const auto& file : std::filesystem::directory_iterator(cache.GetDirectory()))
+			files += file.path().extension() == ".spv" ? 1 : 0;
+
+		CHECK_EQ(files, size_t(1));
+		CHECK(std::filesystem::exists(EntryPath(cache, Key())));
+	}
+
+	SPIRVCache cache(scratch.GetPath());
+
+	// a new process starts with an empty memory, the SPIR-V comes off disk
+	CHECK(!cache.Find(Key()));
+
+	auto loaded = cache.Load(Key(), sCompute);
+
+	CHECK(loaded && *loaded == byteCode);
+	CHECK_EQ(cache.GetStats().DiskHits, uint64_t(1));
+
+	// not persisting again what just came from disk
+	cache.Store(Key(), MakeResult(byteCode), false);
+	CHECK_EQ(cache.GetStats().DiskWrites, uint64_t(0));
+	CHECK(cache.Find(Key()) != nullptr);
+}
+
+TEST(SPIRVCache, RejectsDamagedEntries)
+{
+	ScratchDirectory scratch("SPIRVCacheRejects");
+	SPIRVCache cache(scratch.GetPath());
+
+	cache.Store(Key(), MakeResult({ 0x07230203, 1, 2, 3 }));
+
+	auto path = EntryPath(cache, Key());
+	auto size = std::filesystem::file_size(path);
+
+	// asked for as another stage
+	CHECK(!cache.Load(Key(), sFragment));
+	CHECK_EQ(cache.GetStats().Rejected, uint64_t(1));
+
+	// a torn write, cut in the words and in the header
+	std::filesystem::resize_file(path, size - 2);
+	CHECK(!cache.Load(Key(), sCompute));
+
+	std::filesystem::resize_file(path, 8);
+	CHECK(!cache.Load(Key(), sCompute));
+
+	// trailing garbage, the header doesn't describe the file
+	cache.Store(Key(), MakeResult({ 0x07230203, 1, 2, 3 }));
+	std::filesystem::resize_file(path, size + 4);
+	CHECK(!cache.Load(Key(), sCompute));
+
+	// another key's entry under this key's name
+	auto other = Key(sSource, sFragment);
+	cache.Store(other, MakeResult({ 0x07230203, 4 }, sFragment));
+	std::filesystem::copy_file(EntryPath(cache, other), path, std::filesystem::copy_options::overwrite_existing);
+	CHECK(!cache.Load(Key(), sCompute));
+
+	CHECK_EQ(cache.GetStats().Rejected, uint64_t(5));
+	CHECK_EQ(cache.GetStats().DiskHits, uint64_t(0));
+}
+
+TEST(SPIRVCache, OtherFormatVersionsAreIgnored)
+{
+	ScratchDirectory scratch("SPIRVCacheVersions");
+
+	// an older layout left behind by a previous build
+	scratch.Write("v0/" + Key().ToString() + ".spv", "stale");
+
+	SPIRVCache cache(scratch.GetPath());
+
+	CHECK(!cache.Load(Key(), sCompute));
+	CHECK_EQ(cache.GetStats().Rejected, uint64_t(0));
+
+	cache.Store(Key(), MakeResult({ 0x07230203, 1 }));
+
+	// Clear only removes the files of its own version
+	cache.Clear(true);
+
+	CHECK_EQ(cache.GetEntryCount(), size_t(0));
+	CHECK(std::filesystem::is_empty(cache.GetDirectory()));
+	CHECK(std::filesystem::exists(scratch.GetPath() / "v0" / (Key().ToString() + ".spv")));
+}
+
+TEST(SPIRVCache, EditedIncludeInvalidates)
+{
+	ScratchDirectory scratch("SPIRVCacheIncludes");
+
+	auto cache = std::make_shared<SPIRVCache>(scratch.GetPath() / "Cache");
+
+	auto env = Tests::MakeIsolatedEnvironment();
+	env.SetSPIRVCache(cache);
+
+	auto shader = WriteIncludingShader(scratch, 64);
+	vkLib::ShaderInput input{ "", sCompute, shader.string(), vkLib::OptimizerFlag::eO3 };
+
+	auto first = vkLib::ShaderCompiler(env).Compile(input);
+
+	CHECK(first.Error.Type == vkLib::ErrorType::eNone);
+	CHECK_EQ(first.MetaData.WorkGroupSize.x, uint32_t(64));
+	CHECK_EQ(cache->GetStats().Stores, uint64_t(1));
+
+	// nothing changed, the second compilation is served from memory
+	auto second = vkLib::ShaderCompiler(env).Compile(input);
+
+	CHECK_EQ(cache->GetStats().MemoryHits, uint64_t(1));
+	CHECK(second.SPIR_V.ByteCode == first.SPIR_V.ByteCode);
+	CHECK_EQ(second.MetaData.WorkGroupSize.x, uint32_t(64));
+
+	// only the header changes, the key follows the preprocessed source
+	// the write time may not move within the file system's resolution, the size does
+	WriteIncludingShader(scratch, 128);
+
+	auto edited = vkLib::ShaderCompiler(env).Compile(input);
+
+	CHECK(edited.Error.Type == vkLib::ErrorType::eNone);
+	CHECK_EQ(edited.MetaData.WorkGroupSize.x, uint32_t(128));
+	CHECK(edited.SPIR_V.ByteCode != first.SPIR_V.ByteCode);
+	CHECK_EQ(cache->GetStats().MemoryHits, uint64_t(1));
+	CHECK_EQ(cache->GetStats().Stores, uint64_t(2));
+
+	// reverting the header hits the first entry again
+	WriteIncludingShader(scratch, 64);
+
+	auto reverted = vkLib::ShaderCompiler(env).Compile(input);
+
+	CHECK(reverted.SPIR_V.ByteCode == first.SPIR_V.ByteCode);
+	CHECK_EQ(cache->GetStats().MemoryHits, uint64_t(2));
+}
+
+TEST(SPIRVCache, DiskHitsReflectLikeACompilation)
+{
+	ScratchDirectory scratch("SPIRVCacheDiskHits");
+
+	auto shader = WriteIncludingShader(scratch, 32);
+	vkLib::ShaderInput input{ "", sCompute, shader.string(), vkLib::OptimizerFlag::eO3 };
+
+	auto env = Tests::MakeIsolatedEnvironment();
+	env.SetSPIRVCache(std::make_shared<SPIRVCache>(scratch.GetPath() / "Cache"));
+
+	auto compiled = vkLib::ShaderCompiler(env).Compile(input);
+
+	// the next launch, a new memory and a new reflection cache over the same directory
+	auto cache = std::make_shared<SPIRVCache>(scratch.GetPath() / "Cache");
+
+	auto relaunched = Tests::MakeIsolatedEnvironment();
+	relaunched.SetSPIRVCache(cache);
+
+	auto loaded = vkLib::ShaderCompiler(relaunched).Compile(input);
+
+	CHECK_EQ(cache->GetStats().DiskHits, uint64_t(1));
+	CHECK(loaded.SPIR_V.ByteCode == compiled.SPIR_V.ByteCode);
+	CHECK(loaded.MetaData.WorkGroupSize == compiled.MetaData.WorkGroupSize);
+	CHECK(loaded.SetLayoutBindingsMap.size() == compiled.SetLayoutBindingsMap.size());
+	CHECK_EQ(loaded.LayoutData.DescInfos.size(), compiled.LayoutData.DescInfos.size());
+}
+
+BENCHMARK(SPIRVCache, AssetShadersColdVsWarm)
+{
+	ScratchDirectory scratch("SPIRVCacheBenchmark");
+
+	auto shaders = Tests::CollectAssetShaders();
+	CHECK(!shaders.empty());
+
+	auto compileAll = [&shaders](const vkLib::CompilerEnvironment& env)
+	{
+		size_t compiled = 0;
+
+		for (const auto& shader : shaders)
+			compiled += Tests::CompileAssetShader(env, shader).Error.Type == vkLib::ErrorType::eNone ? 1 : 0;
+
+		return compiled;
+	};
+
+	size_t compiled = 0;
+
+	auto env = Tests::MakeIsolatedEnvironment();
+	double uncached = Tests::MeasureSeconds([&]() { compiled = compileAll(env); });
+
+	auto cache = std::make_shared<SPIRVCache>(scratch.GetPath());
+	env.SetSPIRVCache(cache);
+
+	double cold = Tests::MeasureSeconds([&]() { compileAll(env); });
+	double warm = Tests::MeasureSeconds([&]() { compileAll(env); });
+
+	// a fresh process finding the files of the previous one
+	auto relaunched = Tests::MakeIsolatedEnvironment();
+	relaunched.SetSPIRVCache(std::make_shared<SPIRVCache>(scratch.GetPath()));
+
+	double disk = Tests::MeasureSeconds([&]() { compileAll(relaunched); });
+
+	std::cout << "\t" << compiled << " of " << shaders.size() << " Assets shaders compiled\n"
+		<< "\tno cache: " << uncached * 1e3 << " ms, cold: " << cold * 1e3 << " ms, warm (memory): "
+		<< warm * 1e3 << " ms, warm (disk): " << disk * 1e3 << " ms" << std::endl;
+}
@@ -0,0 +1,352 @@
+#include "ShaderTestUtils.h"
+#include "ShaderCompiler/SPIRVOptimizer.h"
+
+namespace
+{
+	using vkLib::OptimizerFlag;
+	using vkLib::SPIRVOptimizer;
+
+	// hand assembled modules, only what Measure and StripDebugInfo look at
+	class ModuleBuilder
+	{
+	public:
+		ModuleBuilder() : mWords{ 0x07230203, 0x00010600, 0, 100, 0 } {}
+
+		ModuleBuilder& Add(spv::Op opcode, std::vector<uint32_t> operands, std::string_view literal = {})
+		{
+			// a literal string is null terminated and padded to whole words
+			if (!literal.empty())
+			{
+				size_t first = operands.size();
+				operands.resize(first + literal.size() / sizeof(uint32_t) + 1);
+				std::memcpy(operands.data() + first, literal.data(), literal.size());
+			}
+
+			mWords.push_back(static_cast<uint32_t>(operands.size() + 1) << 16 | opcode);
+			mWords.insert(mWords.end(), operands.begin(), operands.end());
+
+			return *this;
+		}
+
+		const std::vector<uint32_t>& GetWords() const { return mWords; }
+
+	private:
+		std::vector<uint32_t> mWords;
+	};
+
+	// a uniform block array, a push constant block and a specialization constant with names worth keeping,
+	// an input variable and a function whose names are not
+	ModuleBuilder MakeNamedModule()
+	{
+		ModuleBuilder module;
+
+		module.Add(spv::OpSource, { 2, 450 })
+			.Add(spv::OpString, { 1 }, "Shader.frag")
+			.Add(spv::OpName, { 10 }, "Block")
+			.Add(spv::OpMemberName, { 10, 0 }, "uValue")
+			.Add(spv::OpName, { 11 }, "uBlocks")
+			.Add(spv::OpName, { 20 }, "vInput")
+			.Add(spv::OpName, { 30 }, "Push")
+			.Add(spv::OpName, { 40 }, "uPush")
+			.Add(spv::OpName, { 50 }, "cCount")
+			.Add(spv::OpName, { 60 }, "main")
+			.Add(spv::OpDecorate, { 50, spv::DecorationSpecId, 0 })
+			.Add(spv::OpTypeStruct, { 10, 1 })
+			.Add(spv::OpTypeArray, { 12, 10, 3 })
+			.Add(spv::OpTypePointer, { 13, spv::StorageClassUniform, 12 })
+			.Add(spv::OpVariable, { 13, 11, spv::StorageClassUniform })
+			.Add(spv::OpTypePointer, { 14, spv::StorageClassInput, 1 })
+			.Add(spv::OpVariable, { 14, 20, spv::StorageClassInput })
+			.Add(spv::OpTypeStruct, { 30, 1 })
+			.Add(spv::OpTypePointer, { 15, spv::StorageClassPushConstant, 30 })
+			.Add(spv::OpVariable, { 15, 40, spv::StorageClassPushConstant })
+			.Add(spv::OpLine, { 1, 2, 3 })
+			.Add(spv::OpNoLine, {});
+
+		return module;
+	}
+
+	// the ids named by OpName and OpMemberName, in order
+	std::vector<uint32_t> CollectNamedIDs(const std::vector<uint32_t>& words)
+	{
+		std::vector<uint32_t> named;
+
+		for (size_t position = 5; position < words.size(); position += words[position] >> 16)
+		{
+			auto opcode = words[position] & 0xffff;
+
+			if (opcode == spv::OpName || opcode == spv::OpMemberName)
+				named.push_back(words[position + 1]);
+		}
+
+		return named;
+	}
+
+	// the recipes the precompiler manifest and the material assembler can ask for
+	const std::vector<OptimizerFlag> sRecipes =
+	{
+		OptimizerFlag::eO1,
+		OptimizerFlag::eO3,
+		OptimizerFlag::eSize,
+		OptimizerFlag::eStripDebug,
+		OptimizerFlag::eDeadBranches,
+		OptimizerFlag::eO3 | OptimizerFlag::eStripDebug,
+		OptimizerFlag::eO3 | OptimizerFlag::eSize | OptimizerFlag::eStripDebug,
+		OptimizerFlag::eDeadBranches | OptimizerFlag::eStripDebug,
+	};
+
+	vkLib::CompileResult CompileWith(const Tests::AssetShader& shader, OptimizerFlag recipe)
+	{
+		auto variant = shader;
+		variant.Input.OptimizationFlag = recipe;
+
+		return Tests::CompileAssetShader(Tests::MakeIsolatedEnvironment(), variant);
+	}
+
+	// what the pipelines read, by name where PShader looks things up by name
+	void CheckSameReflection(const vkLib::CompileResult& stripped, const vkLib::CompileResult& named)
+	{
+		CHECK(stripped.MetaData.WorkGroupSize == named.MetaData.WorkGroupSize);
+		CHECK_EQ(stripped.MetaData.SpecConstants.size(), named.MetaData.SpecConstants.size());
+
+		for (size_t i = 0; i < named.MetaData.SpecConstants.size(); i++)
+		{
+			CHECK(stripped.MetaData.SpecConstants[i].Name == named.MetaData.SpecConstants[i].Name);
+			CHECK_EQ(stripped.MetaData.SpecConstants[i].ConstantID, named.MetaData.SpecConstants[i].ConstantID);
+		}
+
+		CHECK_EQ(stripped.LayoutData.DescInfos.size(), named.LayoutData.DescInfos.size());
+
+		for (size_t i = 0; i < named.LayoutData.DescInfos.size(); i++)
+		{
+			const auto& lhs = stripped.LayoutData.DescInfos[i];
+			const auto& rhs = named.LayoutData.DescInfos[i];
+
+			CHECK(lhs.Name == rhs.Name && lhs.DescType == rhs.DescType);
+			CHECK(lhs.SetIndex == rhs.SetIndex && lhs.BindingIndex == rhs.BindingIndex);
+		}
+
+		CHECK(stripped.LayoutData.PushConstantsData == named.LayoutData.PushConstantsData);
+		CHECK(stripped.LayoutData.PushConstantSubrangeInfos == named.LayoutData.PushConstantSubrangeInfos);
+		CHECK(stripped.SetLayoutBindingsMap == named.SetLayoutBindingsMap);
+	}
+}
+
+TEST(SPIRVOptimizer, MeasureCountsInstructions)
+{
+	auto words = MakeNamedModule().GetWords();
+	auto stats = SPIRVOptimizer::Measure(words);
+
+	CHECK_EQ(stats.Words, words.size());
+	CHECK_EQ(stats.Instructions, size_t(22));
+	CHECK_EQ(stats.DebugInstructions, size_t(12));
+
+	// counting stops at an instruction claiming more words than there are, or none
+	auto truncated = words;
+	truncated.push_back(uint32_t(8) << 16 | spv::OpName);
+
+	CHECK_EQ(SPIRVOptimizer::Measure(truncated).Instructions, size_t(22));
+
+	auto empty = words;
+	empty.insert(empty.begin() + 5, 0);
+
+	CHECK_EQ(SPIRVOptimizer::Measure(empty).Instructions, size_t(0));
+	CHECK_EQ(SPIRVOptimizer::Measure(std::span(words).first(5)).Instructions, size_t(0));
+}
+
+TEST(SPIRVOptimizer, StripKeepsReflectedNames)
+{
+	auto words = MakeNamedModule().GetWords();
+	auto before = SPIRVOptimizer::Measure(words);
+
+	SPIRVOptimizer::StripDebugInfo(words);
+
+	auto after = SPIRVOptimizer::Measure(words);
+
+	// the block and its member, the descriptor array, the push constant block and variable, the spec constant
+	CHECK((CollectNamedIDs(words) == std::vector<uint32_t>{ 10, 10, 11, 30, 40, 50 }));
+	CHECK_EQ(after.DebugInstructions, size_t(6));
+	CHECK_EQ(after.Instructions - after.DebugInstructions, before.Instructions - before.DebugInstructions);
+
+	// nothing left to strip the second time
+	auto again = words;
+	SPIRVOptimizer::StripDebugInfo(again);
+
+	CHECK(again == words);
+
+	// too short to be a module
+	std::vector<uint32_t> header = { 0x07230203, 0x00010600 };
+	SPIRVOptimizer::StripDebugInfo(header);
+
+	CHECK_EQ(header.size(), size_t(2));
+}
+
+TEST(SPIRVOptimizer, StripKeepsStringsOfNonSemanticInfo)
+{
+	auto module = MakeNamedModule();
+	module.Add(spv::OpExtInstImport, { 70 }, "NonSemantic.Shader.DebugInfo.100");
+
+	auto words = module.GetWords();
+	SPIRVOptimizer::StripDebugInfo(words);
+
+	// the debug info refers to the file name string, the line info still goes
+	size_t strings = 0, lines = 0;
+
+	for (size_t position = 5; position < words.size(); position += words[position] >> 16)
+	{
+		strings += (words[position] & 0xffff) == spv::OpString ? 1 : 0;
+		lines += (words[position] & 0xffff) == spv::OpLine ? 1 : 0;
+	}
+
+	CHECK_EQ(strings, size_t(1));
+	CHECK_EQ(lines, size_t(0));
+}
+
+TEST(SPIRVOptimizer, RecipesKeepAssetShadersValid)
+{
+	auto shaders = Tests::CollectAssetShaders();
+	CHECK(!shaders.empty());
+
+	for (const auto& shader : shaders)
+	{
+		auto unoptimized = CompileWith(shader, OptimizerFlag::eNone);
+
+		CHECK(unoptimized.Error.Type == vkLib::ErrorType::eNone);
+		CHECK(SPIRVOptimizer::Validate(unoptimized.SPIR_V.ByteCode));
+
+		for (auto recipe : sRecipes)
+		{
+			auto byteCode = unoptimized.SPIR_V.ByteCode;
+			auto report = SPIRVOptimizer::Optimize(byteCode, recipe);
+
+			CHECK(report.Succeeded);
+			CHECK(SPIRVOptimizer::Validate(byteCode));
+			CHECK_EQ(report.After.Words, byteCode.size());
+
+			if (recipe & OptimizerFlag::eStripDebug)
+				CHECK(report.After.DebugInstructions <= report.Before.DebugInstructions);
+
+			// nothing but stripping and folding, the module can only shrink
+			if (!(recipe & (OptimizerFlag::ePerformanceMask | OptimizerFlag::eSize)))
+				CHECK(report.After.Instructions <= report.Before.Instructions);
+		}
+	}
+}
+
+TEST(SPIRVOptimizer, StrippingKeepsReflection)
+{
+	for (const auto& shader : Tests::CollectAssetShaders())
+	{
+		auto named = CompileWith(shader, OptimizerFlag::eO3);
+		auto stripped = CompileWith(shader, OptimizerFlag::eO3 | OptimizerFlag::eStripDebug);
+
+		CHECK(stripped.Error.Type == vkLib::ErrorType::eNone);
+		CHECK(SPIRVOptimizer::Measure(stripped.SPIR_V.ByteCode).DebugInstructions <=
+			SPIRVOptimizer::Measure(named.SPIR_V.ByteCode).DebugInstructions);
+
+		CheckSameReflection(stripped, named);
+	}
+}
+
+TEST(SPIRVOptimizer, MacroBranchesFold)
+{
+	const std::string source =
+		"#version 440\n"
+		"layout(local_size_x = 64) in;\n"
+		"layout(constant_id = 0) const bool cExtra = false;\n"
+		"layout(std430, set = 0, binding = 0) buffer Values { float sValues[]; };\n"
+		"void main()\n"
+		"{\n"
+		"	uint index = gl_GlobalInvocationID.x;\n"
+		"	if (USE_SLOW_PATH == 1)\n"
+		"		for (int i = 0; i < 16; i++) sValues[index] = sin(sValues[index]) * cos(sValues[index + i]);\n"
+		"	if (cExtra)\n"
+		"		sValues[index] += 1.0;\n"
+		"}\n";
+
+	auto compile = [&source](OptimizerFlag recipe)
+	{
+		auto env = Tests::MakeIsolatedEnvironment();
+		env.SetPreprocessorDirectives({ { "USE_SLOW_PATH", "0" } });
+
+		return vkLib::ShaderCompiler(env).Compile({ source, vk::ShaderStageFlagBits::eCompute, "", recipe });
+	};
+
+	auto unoptimized = compile(OptimizerFlag::eNone);
+	auto folded = compile(OptimizerFlag::eDeadBranches);
+
+	CHECK(folded.Error.Type == vkLib::ErrorType::eNone);
+	CHECK(SPIRVOptimizer::Measure(folded.SPIR_V.ByteCode).Instructions <
+		SPIRVOptimizer::Measure(unoptimized.SPIR_V.ByteCode).Instructions);
+
+	// the macro's branch is gone, the specialization constant's stays for the pipelines to set
+	CHECK_EQ(folded.MetaData.SpecConstants.size(), size_t(1));
+	CHECK(folded.MetaData.SpecConstants[0].Name == "cExtra");
+	CHECK(folded.LayoutData.DescInfos.size() == unoptimized.LayoutData.DescInfos.size());
+}
+
+TEST(SPIRVOptimizer, BrokenModulesAreKept)
+{
+	auto shaders = Tests::CollectAssetShaders();
+	CHECK(!shaders.empty());
+
+	auto byteCode = CompileWith(shaders.front(), OptimizerFlag::eNone).SPIR_V.ByteCode;
+
+	// every id is out of bounds now
+	byteCode[3] = 1;
+
+	auto broken = byteCode;
+	auto report = SPIRVOptimizer::Optimize(broken, OptimizerFlag::eO3 | OptimizerFlag::eStripDebug);
+
+	CHECK(!report.Succeeded);
+	CHECK(broken == byteCode);
+	CHECK(!SPIRVOptimizer::Validate(byteCode));
+
+	// nothing asked for, nothing run
+	report = SPIRVOptimizer::Optimize(broken, OptimizerFlag::eNone);
+
+	CHECK(report.Succeeded && broken == byteCode);
+	CHECK_EQ(report.After.Words, report.Before.Words);
+}
+
+BENCHMARK(SPIRVOptimizer, AssetShaderSizes)
+{
+	std::vector<std::vector<uint32_t>> modules;
+
+	for (const auto& shader : Tests::CollectAssetShaders())
+		modules.push_back(CompileWith(shader, OptimizerFlag::eNone).SPIR_V.ByteCode);
+
+	CHECK(!modules.empty());
+
+	size_t words = 0, instructions = 0;
+
+	for (const auto& module : modules)
+	{
+		auto stats = SPIRVOptimizer::Measure(module);
+		words += stats.Words;
+		instructions += stats.Instructions;
+	}
+
+	std::cout << "\t" << modules.size() << " shaders unoptimized: " << words * sizeof(uint32_t) / 1024.0
+		<< " KB, " << instructions << " instructions" << std::endl;
+
+	for (auto recipe : sRecipes)
+	{
+		size_t optimizedWords = 0, optimizedInstructions = 0;
+
+		double seconds = Tests::MeasureSeconds([&]()
+		{
+			for (auto module : modules)
+			{
+				auto report = SPIRVOptimizer::Optimize(module, recipe);
+
+				optimizedWords += report.After.Words;
+				optimizedInstructions += report.After.Instructions;
+			}
+		});
+
+		std::cout << "\trecipe " << static_cast<uint32_t>(recipe) << ": " << optimizedWords * sizeof(uint32_t) / 1024.0
+			<< " KB (" << 100.0 * optimizedWords / words << "%), " << optimizedInstructions << " instructions, "
+			<< seconds * 1e3 << " ms" << std::endl;
+	}
+}
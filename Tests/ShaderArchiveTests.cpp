@@ -0,0 +1,509 @@
+#include "ShaderTestUtils.h"
+#include "ShaderCompiler/ShaderArchive.h"
+
+namespace
+{
+	using vkLib::ShaderArchive;
+	using vkLib::ShaderArchiveWriter;
+	using vkLib::ShaderArchiveSource;
+	using Tests::ScratchDirectory;
+
+	constexpr auto sCompute = vk::ShaderStageFlagBits::eCompute;
+	constexpr auto sFragment = vk::ShaderStageFlagBits::eFragment;
+	constexpr auto sO3 = vkLib::OptimizerFlag::eO3;
+
+	constexpr const char* sShaderSource = "#version 440\nvoid main() {}\n";
+	constexpr const char* sHeaderSource = "const float sAmbient = 0.1;\n";
+
+	// every field the archive stores, filled with values that can't be mistaken for defaults
+	vkLib::CompileResult MakeResult(vk::ShaderStageFlagBits stage = sCompute, uint32_t seed = 0)
+	{
+		vkLib::CompileResult result;
+
+		result.SPIR_V.Stage = stage;
+		result.SPIR_V.ByteCode = { 0x07230203, 0x00010600, 0, 42 + seed, 5 };
+
+		result.MetaData.ShaderType = stage;
+		result.MetaData.WorkGroupSize = { 64 + seed, 2, 1 };
+		result.MetaData.WorkGroupSizeIDs = { 7, vkLib::ShaderMetaData::sNoConstantID, vkLib::ShaderMetaData::sNoConstantID };
+
+		result.MetaData.SpecConstants.push_back({ 3, "sSampleCount", vkLib::SpecializationType::eUInt, 16 });
+		result.MetaData.SpecConstants.push_back({ 7, "", vkLib::SpecializationType::eUInt, 64 });
+		result.MetaData.SpecConstants.push_back({ 9, "sExposure", vkLib::SpecializationType::eDouble, 0x3ff8000000000000ull });
+
+		auto& uniforms = result.LayoutData.DescInfos.emplace_back();
+		uniforms.SetIndex = 0;
+		uniforms.BindingIndex = 1;
+		uniforms.Name = "Camera";
+		uniforms.DescType = vk::DescriptorType::eUniformBuffer;
+
+		auto& storage = result.LayoutData.DescInfos.emplace_back();
+		storage.SetIndex = 2;
+		storage.BindingIndex = 0;
+		storage.Name = "Rays";
+		storage.DescType = vk::DescriptorType::eStorageBuffer;
+
+		vk::PushConstantRange range{};
+		range.stageFlags = stage;
+		range.offset = 0;
+		range.size = 16;
+
+		result.LayoutData.PushConstantsData.push_back(range);
+
+		range.size = 4;
+		result.LayoutData.PushConstantSubrangeInfos["sFrame"] = range;
+
+		range.offset = 4;
+		range.size = 12;
+		result.LayoutData.PushConstantSubrangeInfos["sOrigin"] = range;
+
+		vk::DescriptorSetLayoutBinding binding{};
+		binding.binding = 1;
+		binding.descriptorType = vk::DescriptorType::eUniformBuffer;
+		binding.descriptorCount = 1;
+		binding.stageFlags = stage;
+
+		result.SetLayoutBindingsMap[0].push_back(binding);
+
+		binding.binding = 0;
+		binding.descriptorType = vk::DescriptorType::eStorageBuffer;
+		binding.descriptorCount = 4;
+
+		result.SetLayoutBindingsMap[2].push_back(binding);
+
+		return result;
+	}
+
+	void CheckSameResult(const vkLib::CompileResult& loaded, const vkLib::CompileResult& stored)
+	{
+		CHECK(loaded.SPIR_V.ByteCode == stored.SPIR_V.ByteCode);
+		CHECK(loaded.SPIR_V.Stage == stored.SPIR_V.Stage);
+		CHECK(loaded.MetaData.ShaderType == stored.MetaData.ShaderType);
+		CHECK(loaded.MetaData.WorkGroupSize == stored.MetaData.WorkGroupSize);
+		CHECK(loaded.MetaData.WorkGroupSizeIDs == stored.MetaData.WorkGroupSizeIDs);
+
+		CHECK_EQ(loaded.MetaData.SpecConstants.size(), stored.MetaData.SpecConstants.size());
+
+		for (size_t i = 0; i < stored.MetaData.SpecConstants.size(); i++)
+		{
+			const auto& lhs = loaded.MetaData.SpecConstants[i];
+			const auto& rhs = stored.MetaData.SpecConstants[i];
+
+			CHECK(lhs.ConstantID == rhs.ConstantID && lhs.Name == rhs.Name);
+			CHECK(lhs.Type == rhs.Type && lhs.DefaultValue == rhs.DefaultValue);
+		}
+
+		CHECK_EQ(loaded.LayoutData.DescInfos.size(), stored.LayoutData.DescInfos.size());
+
+		for (size_t i = 0; i < stored.LayoutData.DescInfos.size(); i++)
+		{
+			const auto& lhs = loaded.LayoutData.DescInfos[i];
+			const auto& rhs = stored.LayoutData.DescInfos[i];
+
+			CHECK(lhs.SetIndex == rhs.SetIndex && lhs.BindingIndex == rhs.BindingIndex);
+			CHECK(lhs.Name == rhs.Name && lhs.DescType == rhs.DescType);
+		}
+
+		CHECK(loaded.LayoutData.PushConstantsData == stored.LayoutData.PushConstantsData);
+		CHECK(loaded.LayoutData.PushConstantSubrangeInfos == stored.LayoutData.PushConstantSubrangeInfos);
+		CHECK(loaded.SetLayoutBindingsMap == stored.SetLayoutBindingsMap);
+	}
+
+	// the shader and its header inside scratch, with the sources the precompiler would record for them
+	std::vector<ShaderArchiveSource> WriteSources(const ScratchDirectory& scratch)
+	{
+		scratch.Write("Shaders/Trace.comp", sShaderSource);
+		scratch.Write("Shaders/Lib/Common.glsl", sHeaderSource);
+
+		return {
+			{ "Trace.comp", ShaderArchive::HashSource(sShaderSource) },
+			{ "Lib/Common.glsl", ShaderArchive::HashSource(sHeaderSource) },
+		};
+	}
+
+	std::filesystem::path WriteArchive(const ScratchDirectory& scratch, const ShaderArchiveWriter& writer)
+	{
+		auto path = scratch.GetPath() / "Shaders.vkar";
+		CHECK(writer.Write(path));
+
+		return path;
+	}
+
+	std::optional<vkLib::CompileResult> Find(const ShaderArchive& archive, std::string_view name,
+		vk::ShaderStageFlagBits stage = sCompute, const vkLib::PreprocessorDirectives& macros = {},
+		vkLib::OptimizerFlag optimization = sO3)
+	{
+		return archive.Find(name, stage, macros, optimization, Tests::GetShaderConfig());
+	}
+}
+
+TEST(ShaderArchive, RoundTripsEveryField)
+{
+	ScratchDirectory scratch("ShaderArchiveRoundTrip");
+	auto sources = WriteSources(scratch);
+
+	auto stored = MakeResult();
+
+	ShaderArchiveWriter writer;
+	CHECK(writer.Add("Trace.comp", {}, sO3, Tests::GetShaderConfig(), stored, sources));
+
+	auto archive = ShaderArchive::Open(WriteArchive(scratch, writer), scratch.GetPath() / "Shaders");
+
+	CHECK(archive != nullptr);
+	CHECK_EQ(archive->GetEntryCount(), uint32_t(1));
+
+	auto loaded = Find(*archive, "Trace.comp");
+
+	CHECK(loaded.has_value());
+	CheckSameResult(*loaded, stored);
+
+	// the lookup's config and stage come back with the result
+	CHECK(loaded->Config.GlslVersion == Tests::GetShaderConfig().GlslVersion);
+	CHECK(loaded->Error.Type == vkLib::ErrorType::eNone);
+	CHECK(loaded->Error.ShaderStage == sCompute);
+
+	CHECK_EQ(archive->GetStats().Hits, uint64_t(1));
+}
+
+TEST(ShaderArchive, LooksUpByNameAndPermutation)
+{
+	ScratchDirectory scratch("ShaderArchiveLookup");
+	auto sources = WriteSources(scratch);
+	auto config = Tests::GetShaderConfig();
+
+	vkLib::PreprocessorDirectives macros = { { "SAMPLES", "16" }, { "USE_BVH", "" } };
+
+	ShaderArchiveWriter writer;
+	writer.Add("Trace.comp", {}, sO3, config, MakeResult(sCompute, 0), sources);
+	writer.Add("Trace.comp", macros, sO3, config, MakeResult(sCompute, 1), sources);
+	writer.Add("Trace.comp", {}, vkLib::OptimizerFlag::eNone, config, MakeResult(sCompute, 2), sources);
+
+	// a hundred names around it, the index is searched rather than scanned
+	for (uint32_t i = 0; i < 100; i++)
+		writer.Add("Other" + std::to_string(i) + ".frag", {}, sO3, config, MakeResult(sFragment, 100 + i), sources);
+
+	CHECK_EQ(writer.GetEntryCount(), size_t(103));
+
+	auto archive = ShaderArchive::Open(WriteArchive(scratch, writer), scratch.GetPath() / "Shaders");
+	CHECK(archive != nullptr);
+
+	CHECK_EQ(Find(*archive, "Trace.comp")->MetaData.WorkGroupSize.x, uint32_t(64));
+	CHECK_EQ(Find(*archive, "Trace.comp", sCompute, macros)->MetaData.WorkGroupSize.x, uint32_t(65));
+	CHECK_EQ(Find(*archive, "Trace.comp", sCompute, {}, vkLib::OptimizerFlag::eNone)->MetaData.WorkGroupSize.x, uint32_t(66));
+
+	for (uint32_t i = 0; i < 100; i += 9)
+		CHECK_EQ(Find(*archive, "Other" + std::to_string(i) + ".frag", sFragment)->MetaData.WorkGroupSize.x, 164 + i);
+
+	// the macros are a set
+	vkLib::PreprocessorDirectives reordered;
+	reordered["USE_BVH"] = "";
+	reordered["SAMPLES"] = "16";
+
+	CHECK(Find(*archive, "Trace.comp", sCompute, reordered).has_value());
+
+	// anything else of the permutation is a miss
+	CHECK(!Find(*archive, "Trace.comp", sCompute, { { "SAMPLES", "8" } }));
+	CHECK(!Find(*archive, "Trace.comp", sFragment));
+	CHECK(!Find(*archive, "Trace.comp", sCompute, {}, vkLib::OptimizerFlag::eO2));
+	CHECK(!Find(*archive, "Lib/Common.glsl"));
+
+	config.SPV_Version = glslang::EShTargetLanguageVersion::EShTargetSpv_1_5;
+	CHECK(!archive->Find("Trace.comp", sCompute, {}, sO3, config));
+
+	auto stats = archive->GetStats();
+
+	CHECK_EQ(stats.Misses, uint64_t(5));
+	CHECK_EQ(stats.Rejected, uint64_t(0));
+}
+
+TEST(ShaderArchive, NamesAreRelativeToTheSourceRoot)
+{
+	ScratchDirectory scratch("ShaderArchiveNames");
+	auto sources = WriteSources(scratch);
+
+	ShaderArchiveWriter writer;
+	writer.Add("Trace.comp", {}, sO3, Tests::GetShaderConfig(), MakeResult(), sources);
+
+	auto root = scratch.GetPath() / "Shaders";
+	auto archive = ShaderArchive::Open(WriteArchive(scratch, writer), root / "Lib" / "..");
+
+	CHECK(archive->GetName(root / "Trace.comp") == "Trace.comp");
+	CHECK(archive->GetName(root / "Lib" / "Common.glsl") == "Lib/Common.glsl");
+	CHECK(archive->GetName(root / "Lib" / ".." / "Trace.comp") == "Trace.comp");
+
+	CHECK(!archive->GetName(scratch.GetPath() / "Outside.comp"));
+}
+
+TEST(ShaderArchive, EditedSourcesAreMisses)
+{
+	ScratchDirectory scratch("ShaderArchiveOutdated");
+	auto sources = WriteSources(scratch);
+
+	ShaderArchiveWriter writer;
+	writer.Add("Trace.comp", {}, sO3, Tests::GetShaderConfig(), MakeResult(), sources);
+
+	auto archive = ShaderArchive::Open(WriteArchive(scratch, writer), scratch.GetPath() / "Shaders");
+
+	CHECK(Find(*archive, "Trace.comp").has_value());
+
+	// the included header changed since the archive was built
+	scratch.Write("Shaders/Lib/Common.glsl", "const float sAmbient = 0.25;\n");
+
+	CHECK(!Find(*archive, "Trace.comp"));
+	CHECK_EQ(archive->GetStats().Outdated, uint64_t(1));
+
+	// reverting it makes the entry current again
+	scratch.Write("Shaders/Lib/Common.glsl", sHeaderSource);
+	CHECK(Find(*archive, "Trace.comp").has_value());
+
+	// so does a missing source
+	std::filesystem::remove(scratch.GetPath() / "Shaders/Lib/Common.glsl");
+
+	CHECK(!Find(*archive, "Trace.comp"));
+	CHECK_EQ(archive->GetStats().Outdated, uint64_t(2));
+}
+
+TEST(ShaderArchive, StaleShadersAreMisses)
+{
+	ScratchDirectory scratch("ShaderArchiveStale");
+	auto sources = WriteSources(scratch);
+
+	ShaderArchiveWriter writer;
+	writer.Add("Trace.comp", {}, sO3, Tests::GetShaderConfig(), MakeResult(), sources);
+	writer.Add("Lib/Common.glsl", {}, sO3, Tests::GetShaderConfig(), MakeResult(), sources);
+
+	auto archive = ShaderArchive::Open(WriteArchive(scratch, writer), scratch.GetPath() / "Shaders");
+
+	archive->MarkStale(scratch.GetPath() / "Shaders/Trace.comp");
+
+	// even with its sources unchanged, the other entry stays
+	CHECK(!Find(*archive, "Trace.comp"));
+	CHECK(Find(*archive, "Lib/Common.glsl").has_value());
+
+	// paths outside of the root are ignored
+	archive->MarkStale(scratch.GetPath() / "Trace.comp");
+	CHECK_EQ(archive->GetStats().Outdated, uint64_t(0));
+}
+
+TEST(ShaderArchive, WriterRefusesUnusableResults)
+{
+	ScratchDirectory scratch("ShaderArchiveWriter");
+	auto sources = WriteSources(scratch);
+	auto config = Tests::GetShaderConfig();
+
+	ShaderArchiveWriter writer;
+
+	auto failed = MakeResult();
+	failed.Error.Type = vkLib::ErrorType::eParsing;
+
+	auto empty = MakeResult();
+	empty.SPIR_V.ByteCode.clear();
+
+	CHECK(!writer.Add("Trace.comp", {}, sO3, config, failed, sources));
+	CHECK(!writer.Add("Trace.comp", {}, sO3, config, empty, sources));
+	CHECK(!writer.Add("Trace.comp", {}, sO3, config, MakeResult(), {}));
+	CHECK_EQ(writer.GetEntryCount(), size_t(0));
+
+	// a permutation added twice keeps the later result
+	CHECK(writer.Add("Trace.comp", {}, sO3, config, MakeResult(sCompute, 1), sources));
+	CHECK(writer.Add("Trace.comp", {}, sO3, config, MakeResult(sCompute, 2), sources));
+	CHECK_EQ(writer.GetEntryCount(), size_t(1));
+
+	auto archive = ShaderArchive::Open(WriteArchive(scratch, writer), scratch.GetPath() / "Shaders");
+
+	CHECK_EQ(Find(*archive, "Trace.comp")->MetaData.WorkGroupSize.x, uint32_t(66));
+
+	// an empty writer still makes a valid archive
+	CHECK(ShaderArchiveWriter().Write(scratch.GetPath() / "Empty.vkar"));
+
+	auto empties = ShaderArchive::Open(scratch.GetPath() / "Empty.vkar", scratch.GetPath());
+
+	CHECK(empties != nullptr && empties->GetEntryCount() == 0);
+	CHECK(!Find(*empties, "Trace.comp"));
+}
+
+TEST(ShaderArchive, RejectsDamagedFiles)
+{
+	ScratchDirectory scratch("ShaderArchiveDamaged");
+	auto sources = WriteSources(scratch);
+	auto root = scratch.GetPath() / "Shaders";
+
+	ShaderArchiveWriter writer;
+	writer.Add("Trace.comp", {}, sO3, Tests::GetShaderConfig(), MakeResult(), sources);
+
+	auto path = WriteArchive(scratch, writer);
+	auto size = std::filesystem::file_size(path);
+
+	CHECK(!ShaderArchive::Open(scratch.GetPath() / "Missing.vkar", root));
+
+	// the header's file size catches a truncation, the version an older layout
+	auto truncated = scratch.GetPath() / "Truncated.vkar";
+	std::filesystem::copy_file(path, truncated);
+	std::filesystem::resize_file(truncated, size - 1);
+
+	CHECK(!ShaderArchive::Open(truncated, root));
+
+	std::string bytes;
+	{
+		std::ifstream file(path, std::ios::in | std::ios::binary);
+		bytes.assign(std::istreambuf_iterator<char>(file), {});
+	}
+
+	auto patched = [&scratch, &bytes](size_t offset, uint32_t value)
+	{
+		std::string copy = bytes;
+		std::memcpy(copy.data() + offset, &value, sizeof(value));
+
+		return scratch.Write("Patched.vkar", copy);
+	};
+
+	CHECK(!ShaderArchive::Open(patched(4, ShaderArchive::sFormatVersion - 1), root));
+	CHECK(!ShaderArchive::Open(patched(0, 0), root));
+
+	// an index claiming more entries than the file holds
+	CHECK(!ShaderArchive::Open(patched(8, 1000), root));
+
+	// the entry's stored name no longer matches, it is rejected rather than served under the wrong name
+	size_t entry = 32 + 32;
+	auto archive = ShaderArchive::Open(patched(entry + 4, 0x454b4146), root);
+
+	CHECK(archive != nullptr);
+	CHECK(!Find(*archive, "Trace.comp"));
+	CHECK_EQ(archive->GetStats().Rejected, uint64_t(1));
+}
+
+TEST(ShaderArchive, ConcurrentLookups)
+{
+	ScratchDirectory scratch("ShaderArchiveConcurrent");
+	auto sources = WriteSources(scratch);
+	auto config = Tests::GetShaderConfig();
+
+	ShaderArchiveWriter writer;
+
+	for (uint32_t i = 0; i < 16; i++)
+		writer.Add("Trace.comp", { { "VARIANT", std::to_string(i) } }, sO3, config, MakeResult(sCompute, i), sources);
+
+	auto archive = ShaderArchive::Open(WriteArchive(scratch, writer), scratch.GetPath() / "Shaders");
+
+	constexpr uint32_t sThreads = 4;
+	constexpr uint32_t sLookups = 200;
+
+	std::atomic<uint32_t> wrong = 0;
+	std::vector<std::thread> threads;
+
+	for (uint32_t t = 0; t < sThreads; t++)
+	{
+		threads.emplace_back([&, t]()
+		{
+			for (uint32_t i = 0; i < sLookups; i++)
+			{
+				uint32_t variant = (i * 7 + t) % 16;
+				auto found = Find(*archive, "Trace.comp", sCompute, { { "VARIANT", std::to_string(variant) } });
+
+				if (!found || found->MetaData.WorkGroupSize.x != 64 + variant)
+					wrong++;
+			}
+		});
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	CHECK_EQ(wrong.load(), uint32_t(0));
+	CHECK_EQ(archive->GetStats().Hits, uint64_t(sThreads * sLookups));
+}
+
+TEST(ShaderArchive, ServesFileCompilations)
+{
+	ScratchDirectory scratch("ShaderArchiveCompiler");
+
+	auto shader = scratch.Write("Shaders/Scale.comp",
+		"#version 440\n"
+		"layout(local_size_x = 128) in;\n"
+		"layout(std430, set = 0, binding = 0) buffer Values { float sValues[]; };\n"
+		"layout(push_constant) uniform Constants { float sScale; };\n"
+		"void main() { sValues[gl_GlobalInvocationID.x] *= sScale; }\n");
+
+	vkLib::ShaderInput input{ "", sCompute, shader.string(), sO3 };
+
+	auto env = Tests::MakeIsolatedEnvironment();
+	auto compiled = vkLib::ShaderCompiler(env).Compile(input);
+
+	CHECK(compiled.Error.Type == vkLib::ErrorType::eNone);
+
+	ShaderArchiveWriter writer;
+	CHECK(writer.Add("Scale.comp", {}, sO3, Tests::GetShaderConfig(), compiled,
+		{ { "Scale.comp", ShaderArchive::HashSource(*vkLib::ReadFile(shader.string())) } }));
+
+	auto archive = ShaderArchive::Open(WriteArchive(scratch, writer), scratch.GetPath() / "Shaders");
+
+	auto archived = Tests::MakeIsolatedEnvironment();
+	archived.SetShaderArchive(archive);
+
+	auto loaded = vkLib::ShaderCompiler(archived).Compile(input);
+
+	CHECK_EQ(archive->GetStats().Hits, uint64_t(1));
+	CHECK(loaded.Error.Type == vkLib::ErrorType::eNone);
+	CHECK(loaded.Error.FilePath == shader.string());
+	CheckSameResult(loaded, compiled);
+
+	// the edited shader falls back to a runtime compilation
+	scratch.Write("Shaders/Scale.comp", *vkLib::ReadFile(shader.string()) + "// edited\n");
+
+	auto edited = vkLib::ShaderCompiler(archived).Compile(input);
+
+	CHECK(edited.Error.Type == vkLib::ErrorType::eNone);
+	CHECK(edited.SPIR_V.ByteCode == compiled.SPIR_V.ByteCode);
+	CHECK_EQ(archive->GetStats().Outdated, uint64_t(1));
+}
+
+BENCHMARK(ShaderArchive, AssetShadersStartup)
+{
+	ScratchDirectory scratch("ShaderArchiveBenchmark");
+
+	auto shaders = Tests::CollectAssetShaders();
+	auto root = vkLib::IncludeCache::NormalizePath(Tests::sAssetShaderDirectory);
+
+	// what the ShaderPrecompiler does, every permutation with the shader and its includes as sources
+	auto env = Tests::MakeIsolatedEnvironment();
+	ShaderArchiveWriter writer;
+
+	for (const auto& shader : shaders)
+	{
+		auto result = Tests::CompileAssetShader(env, shader);
+
+		std::vector<ShaderArchiveSource> sources;
+		auto files = env.GetIncludeCache()->GetDependencies(shader.Input.FilePath);
+		files.insert(files.begin(), vkLib::IncludeCache::NormalizePath(shader.Input.FilePath));
+
+		for (const auto& file : files)
+			sources.push_back({ file.lexically_relative(root).generic_string(),
+				ShaderArchive::HashSource(*vkLib::ReadFile(file.string())) });
+
+		writer.Add(vkLib::IncludeCache::NormalizePath(shader.Input.FilePath).lexically_relative(root).generic_string(),
+			shader.Macros, shader.Input.OptimizationFlag, Tests::GetShaderConfig(), result, sources);
+	}
+
+	auto path = WriteArchive(scratch, writer);
+
+	auto startup = [&shaders](std::shared_ptr<ShaderArchive> archive)
+	{
+		auto env = Tests::MakeIsolatedEnvironment();
+		env.SetShaderArchive(std::move(archive));
+
+		for (const auto& shader : shaders)
+			Tests::DoNotOptimize(Tests::CompileAssetShader(env, shader));
+	};
+
+	double runtime = Tests::MeasureSeconds([&]() { startup(nullptr); });
+
+	std::shared_ptr<ShaderArchive> archive;
+	double archived = Tests::MeasureSeconds([&]() { startup(archive = ShaderArchive::Open(path, root)); });
+
+	CHECK(archive != nullptr);
+
+	std::cout << "\t" << writer.GetEntryCount() << " of " << shaders.size() << " Assets shaders archived, "
+		<< std::filesystem::file_size(path) / 1024 << " KiB\n"
+		<< "\truntime compilation: " << runtime * 1e3 << " ms, archive: " << archived * 1e3 << " ms ("
+		<< archive->GetStats().Hits << " hits, " << archive->GetStats().Misses << " misses)" << std::endl;
+}
@@ -0,0 +1,432 @@
+#include "TestRunner.h"
+#include "ShaderCompiler/ShaderReloader.h"
+
+namespace
+{
+	using namespace std::chrono_literals;
+
+	using vkLib::ManualClock;
+	using vkLib::MockReloadScheduler;
+	using vkLib::IncludeCache;
+	using Tests::ScratchDirectory;
+
+	using Path = std::filesystem::path;
+
+	const Path sRoot = std::filesystem::temp_directory_path() / "vkLibTests" / "ReloadScheduler";
+
+	// header --> the shaders including it, what IncludeCache::GetDependents answers in the service
+	struct FakeIncludeGraph
+	{
+		std::map<Path, std::vector<Path>> Dependents;
+
+		MockReloadScheduler::DependentsFn GetFunction() const
+		{
+			return [this](const Path& header)
+			{
+				auto found = Dependents.find(header);
+				return found == Dependents.end() ? std::vector<Path>() : found->second;
+			};
+		}
+	};
+
+	Path Normalized(const Path& path) { return IncludeCache::NormalizePath(path); }
+
+	std::vector<uint64_t> Targets(const std::optional<vkLib::ReloadBurst>& burst)
+	{
+		CHECK(burst.has_value());
+		return burst->Targets;
+	}
+
+	// a condition met by the service's thread, the polls and the quiet period take real time
+	template <typename Fn>
+	bool WaitFor(Fn&& condition, std::chrono::milliseconds timeout = 5s)
+	{
+		auto deadline = std::chrono::steady_clock::now() + timeout;
+
+		while (!condition())
+		{
+			if (std::chrono::steady_clock::now() > deadline)
+				return false;
+
+			std::this_thread::sleep_for(2ms);
+		}
+
+		return true;
+	}
+}
+
+TEST(ShaderReloader, ManualClockIsShared)
+{
+	ManualClock clock;
+	ManualClock copy = clock;
+
+	copy.Advance(5ms);
+
+	CHECK(clock.now() == copy.now());
+	CHECK(clock.now().time_since_epoch() == 5ms);
+}
+
+TEST(ShaderReloader, BurstWaitsForTheQuietPeriod)
+{
+	ManualClock clock;
+	MockReloadScheduler scheduler(clock, 150ms);
+
+	uint64_t id = scheduler.Register({ sRoot / "Intersection.glsl" });
+
+	CHECK(!scheduler.CollectReady());
+
+	// an editor writing the file three times for one save
+	scheduler.OnFileChanged(sRoot / "Intersection.glsl");
+	clock.Advance(50ms);
+	scheduler.OnFileChanged(sRoot / "Intersection.glsl");
+	clock.Advance(50ms);
+	scheduler.OnFileChanged(sRoot / "Intersection.glsl");
+
+	// every event restarts the quiet period
+	clock.Advance(149ms);
+	CHECK(!scheduler.CollectReady());
+	CHECK(scheduler.HasPending());
+
+	clock.Advance(1ms);
+
+	auto burst = scheduler.CollectReady();
+
+	CHECK((Targets(burst) == std::vector{ id }));
+	CHECK((burst->Affected == std::vector{ Normalized(sRoot / "Intersection.glsl") }));
+
+	// handed out once
+	CHECK(!scheduler.HasPending());
+	CHECK(!scheduler.CollectReady());
+
+	clock.Advance(1s);
+	CHECK(!scheduler.CollectReady());
+}
+
+TEST(ShaderReloader, OneBurstCoversSeveralFiles)
+{
+	ManualClock clock;
+	MockReloadScheduler scheduler(clock, 100ms);
+
+	uint64_t sort = scheduler.Register({ sRoot / "PrepareRaySort.glsl", sRoot / "FinishRaySort.glsl" });
+	uint64_t mean = scheduler.Register({ sRoot / "LuminanceMean.glsl" });
+	scheduler.Register({ sRoot / "PostProcessImage.glsl" });
+
+	// a save touching both sort passes, a target listed once even with two of its sources changed
+	scheduler.OnFileChanged(sRoot / "PrepareRaySort.glsl");
+	clock.Advance(20ms);
+	scheduler.OnFileChanged(sRoot / "FinishRaySort.glsl");
+	scheduler.OnFileChanged(sRoot / "LuminanceMean.glsl");
+	clock.Advance(100ms);
+
+	auto burst = scheduler.CollectReady();
+
+	CHECK((Targets(burst) == std::vector{ sort, mean }));
+	CHECK_EQ(burst->Affected.size(), size_t(3));
+
+	// a file no target compiles is still reported
+	scheduler.OnFileChanged(sRoot / "Notes.txt");
+	clock.Advance(100ms);
+
+	burst = scheduler.CollectReady();
+
+	CHECK(Targets(burst).empty());
+	CHECK((burst->Affected == std::vector{ Normalized(sRoot / "Notes.txt") }));
+}
+
+TEST(ShaderReloader, IncludesResolveToTheirShaders)
+{
+	FakeIncludeGraph graph;
+
+	auto common = Normalized(sRoot / "Lib/Common.glsl");
+	auto lighting = Normalized(sRoot / "Lib/Lighting.glsl");
+	auto main = Normalized(sRoot / "Main.frag");
+	auto shadows = Normalized(sRoot / "Shadows.frag");
+
+	// the graph is already flattened, Common.glsl reaches Main.frag through Lighting.glsl as well
+	graph.Dependents[common] = { main, shadows };
+	graph.Dependents[lighting] = { main };
+
+	ManualClock clock;
+	MockReloadScheduler scheduler(clock, 100ms, graph.GetFunction());
+
+	uint64_t mainID = scheduler.Register({ sRoot / "Main.vert", main });
+	uint64_t shadowsID = scheduler.Register({ shadows });
+	scheduler.Register({ sRoot / "Sky.frag" });
+
+	scheduler.OnFileChanged(lighting);
+	clock.Advance(100ms);
+
+	auto burst = scheduler.CollectReady();
+
+	CHECK((Targets(burst) == std::vector{ mainID }));
+	CHECK((burst->Affected == std::vector{ lighting, main }));
+
+	scheduler.OnFileChanged(common);
+	clock.Advance(100ms);
+
+	burst = scheduler.CollectReady();
+
+	CHECK((Targets(burst) == std::vector{ mainID, shadowsID }));
+	CHECK((burst->Affected == std::vector{ common, main, shadows }));
+}
+
+TEST(ShaderReloader, PathsAreNormalized)
+{
+	ManualClock clock;
+	MockReloadScheduler scheduler(clock, 10ms);
+
+	uint64_t id = scheduler.Register({ sRoot / "Wavefront" / ".." / "Intersection.glsl" });
+
+	scheduler.OnFileChanged(sRoot / "." / "Intersection.glsl");
+	clock.Advance(10ms);
+
+	CHECK((Targets(scheduler.CollectReady()) == std::vector{ id }));
+}
+
+TEST(ShaderReloader, UnregisteredTargetsArentReported)
+{
+	ManualClock clock;
+	MockReloadScheduler scheduler(clock, 10ms);
+
+	uint64_t first = scheduler.Register({ sRoot / "Shared.glsl" });
+	uint64_t second = scheduler.Register({ sRoot / "Shared.glsl" });
+
+	CHECK(first != second);
+
+	scheduler.OnFileChanged(sRoot / "Shared.glsl");
+	scheduler.Unregister(first);
+	clock.Advance(10ms);
+
+	CHECK((Targets(scheduler.CollectReady()) == std::vector{ second }));
+}
+
+TEST(ShaderReloader, ResolvesThroughARealIncludeCache)
+{
+	IncludeCache cache;
+	cache.RecordDependencies(sRoot / "Intersection.glsl", { sRoot / "Utils" / "Ray.glsl", sRoot / "Utils" / "BVH.glsl" });
+	cache.RecordDependencies(sRoot / "RayGeneration.comp", { sRoot / "Utils" / "Ray.glsl" });
+
+	ManualClock clock;
+	MockReloadScheduler scheduler(clock, 10ms,
+		[&cache](const Path& header) { return cache.GetDependents(header); });
+
+	uint64_t intersection = scheduler.Register({ sRoot / "Intersection.glsl" });
+	uint64_t generation = scheduler.Register({ sRoot / "RayGeneration.comp" });
+
+	scheduler.OnFileChanged(sRoot / "Utils" / "BVH.glsl");
+	clock.Advance(10ms);
+
+	CHECK((Targets(scheduler.CollectReady()) == std::vector{ intersection }));
+
+	scheduler.OnFileChanged(sRoot / "Utils" / "Ray.glsl");
+	clock.Advance(10ms);
+
+	CHECK((Targets(scheduler.CollectReady()) == std::vector{ intersection, generation }));
+}
+
+TEST(ShaderReloader, DirectoryWatcherReportsChanges)
+{
+	ScratchDirectory scratch("DirectoryWatcher");
+
+	auto existing = scratch.Write("Existing.glsl", "// here from the start\n");
+	auto nested = scratch.Write("Lib/Nested.glsl", "// nested\n");
+
+	vkLib::DirectoryWatcher watcher;
+	watcher.Watch(scratch.GetPath());
+
+	// the snapshot isn't a change
+	CHECK(watcher.Poll().empty());
+
+	std::filesystem::last_write_time(nested, std::filesystem::last_write_time(nested) + 1s);
+	auto created = scratch.Write("Lib/Created.glsl", "// new\n");
+
+	auto changed = watcher.Poll();
+	std::ranges::sort(changed);
+
+	CHECK_EQ(changed.size(), size_t(2));
+	CHECK(Normalized(changed[0]) == Normalized(created));
+	CHECK(Normalized(changed[1]) == Normalized(nested));
+
+	// reported once, and removals count too
+	CHECK(watcher.Poll().empty());
+
+	std::filesystem::remove(existing);
+	changed = watcher.Poll();
+
+	CHECK_EQ(changed.size(), size_t(1));
+	CHECK(Normalized(changed[0]) == Normalized(existing));
+}
+
+TEST(ShaderReloader, ServiceCommitsOnlyBetweenFrames)
+{
+	ScratchDirectory scratch("ShaderReloadService");
+	auto shader = scratch.Write("Trace.comp", "// version 1\n");
+
+	vkLib::ShaderReloadService service(std::make_shared<IncludeCache>(), 20ms, 5ms);
+	service.Watch(scratch.GetPath());
+
+	std::atomic<uint32_t> rebuilds = 0;
+	std::atomic<uint32_t> commits = 0;
+	std::atomic<bool> failNext = false;
+
+	vkLib::ShaderReloadTarget target;
+	target.Sources = { shader };
+	target.Rebuild = [&]() { rebuilds++; return !failNext.load(); };
+	target.Commit = [&]() { commits++; };
+
+	uint64_t id = service.Register(std::move(target));
+
+	std::filesystem::last_write_time(shader, std::filesystem::last_write_time(shader) + 1s);
+
+	CHECK(WaitFor([&]() { return service.GetStats().Rebuilds == 1; }));
+	CHECK_EQ(rebuilds.load(), uint32_t(1));
+
+	// rebuilt on the service's thread, nothing is swapped until the frame boundary
+	CHECK_EQ(commits.load(), uint32_t(0));
+	CHECK_EQ(service.ApplyPending(), size_t(1));
+	CHECK_EQ(commits.load(), uint32_t(1));
+	CHECK_EQ(service.ApplyPending(), size_t(0));
+
+	// a failed rebuild keeps the live object
+	failNext = true;
+	std::filesystem::last_write_time(shader, std::filesystem::last_write_time(shader) + 1s);
+
+	CHECK(WaitFor([&]() { return service.GetStats().Failures == 1; }));
+	CHECK_EQ(service.ApplyPending(), size_t(0));
+	CHECK_EQ(commits.load(), uint32_t(1));
+
+	service.Unregister(id);
+
+	// an unregistered target is never called again
+	failNext = false;
+	std::filesystem::last_write_time(shader, std::filesystem::last_write_time(shader) + 1s);
+
+	CHECK(WaitFor([&]() { return service.GetStats().Bursts == 3; }));
+	CHECK_EQ(rebuilds.load(), uint32_t(2));
+
+	auto stats = service.GetStats();
+
+	CHECK_EQ(stats.Rebuilds, uint64_t(2));
+	CHECK_EQ(stats.Commits, uint64_t(1));
+}
+
+TEST(ShaderReloader, CommitWaitsForARebuildInProgress)
+{
+	ScratchDirectory scratch("ShaderReloadDeferred");
+	auto shader = scratch.Write("Trace.comp", "// version 1\n");
+
+	vkLib::ShaderReloadService service(std::make_shared<IncludeCache>(), 10ms, 5ms);
+	service.Watch(scratch.GetPath());
+
+	std::atomic<uint32_t> rebuilds = 0;
+	std::atomic<bool> holdRebuild = false;
+	std::atomic<bool> inRebuild = false;
+
+	// the staging slot holds the version the rebuild produced, the commit copies it out
+	std::atomic<uint32_t> staged = 0;
+	std::atomic<uint32_t> live = 0;
+	std::atomic<bool> tornCommit = false;
+
+	vkLib::ShaderReloadTarget target;
+	target.Sources = { shader };
+	target.Rebuild = [&]()
+	{
+		inRebuild = true;
+
+		uint32_t version = ++rebuilds;
+
+		while (holdRebuild)
+			std::this_thread::sleep_for(1ms);
+
+		staged = version;
+		inRebuild = false;
+
+		return true;
+	};
+
+	target.Commit = [&]()
+	{
+		tornCommit = tornCommit || inRebuild;
+		live = staged.load();
+	};
+
+	service.Register(std::move(target));
+
+	std::filesystem::last_write_time(shader, std::filesystem::last_write_time(shader) + 1s);
+	CHECK(WaitFor([&]() { return service.GetStats().Rebuilds == 1; }));
+
+	// the next save starts rebuilding while the first result waits for its frame
+	holdRebuild = true;
+	std::filesystem::last_write_time(shader, std::filesystem::last_write_time(shader) + 1s);
+	CHECK(WaitFor([&]() { return inRebuild.load(); }));
+
+	CHECK_EQ(service.ApplyPending(), size_t(0));
+	CHECK_EQ(service.GetStats().Deferred, uint64_t(1));
+
+	holdRebuild = false;
+	CHECK(WaitFor([&]() { return service.GetStats().Rebuilds == 2; }));
+
+	// the newer rebuild is the one committed
+	CHECK_EQ(service.ApplyPending(), size_t(1));
+	CHECK_EQ(live.load(), uint32_t(2));
+	CHECK(!tornCommit);
+}
+
+BENCHMARK(ShaderReloader, FrameBoundaryCost)
+{
+	ScratchDirectory scratch("ShaderReloadBenchmark");
+
+	std::vector<Path> shaders;
+
+	for (uint32_t i = 0; i < 8; i++)
+		shaders.push_back(scratch.Write("Pass" + std::to_string(i) + ".comp", "// pass\n"));
+
+	vkLib::ShaderReloadService service(std::make_shared<IncludeCache>(), 10ms, 5ms);
+	service.Watch(scratch.GetPath());
+
+	std::atomic<uint32_t> commits = 0;
+
+	// a rebuild takes a compilation's time on the service's thread, the commit only swaps a pointer
+	for (const auto& shader : shaders)
+	{
+		vkLib::ShaderReloadTarget target;
+		target.Sources = { shader };
+		target.Rebuild = []() { std::this_thread::sleep_for(20ms); return true; };
+		target.Commit = [&commits]() { commits++; };
+
+		service.Register(std::move(target));
+	}
+
+	// frames of about a millisecond, each ending in ApplyPending, with and without reloads going on
+	auto runFrames = [&service](uint32_t frameCount, const std::function<void(uint32_t)>& onFrame)
+	{
+		std::vector<double> costs;
+
+		for (uint32_t frame = 0; frame < frameCount; frame++)
+		{
+			onFrame(frame);
+			std::this_thread::sleep_for(1ms);
+
+			costs.push_back(Tests::MeasureSeconds([&service]() { service.ApplyPending(); }));
+		}
+
+		std::ranges::sort(costs);
+		return std::pair{ costs[costs.size() / 2], costs.back() };
+	};
+
+	auto [idleMedian, idleMax] = runFrames(200, [](uint32_t) {});
+
+	auto [reloadMedian, reloadMax] = runFrames(400, [&shaders](uint32_t frame)
+	{
+		// a save every 50 frames touching every pass
+		if (frame % 50 != 0)
+			return;
+
+		for (const auto& shader : shaders)
+			std::filesystem::last_write_time(shader, std::filesystem::last_write_time(shader) + 1s);
+	});
+
+	std::cout << "\tApplyPending without reloads: median " << idleMedian * 1e6 << " us, max " << idleMax * 1e6 << " us\n"
+		<< "\twhile rebuilding: median " << reloadMedian * 1e6 << " us, max " << reloadMax * 1e6 << " us, "
+		<< commits.load() << " commits, " << service.GetStats().Deferred << " deferred" << std::endl;
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "TestRunner.h"
+#include "ShaderCompiler/ShaderCompiler.h"
+
+// Shared by the shader compiler tests, they run glslang and spirv-cross for real but never touch a device
+// The Assets shaders are found relative to the working directory, the same way Application finds its assets
+
+namespace Tests
+{
+	inline const std::filesystem::path sAssetShaderDirectory = "../Aqua/Assets/Shaders";
+
+	// the config PShader and the ShaderPrecompiler compile with
+	inline vkLib::CompilerConfig GetShaderConfig()
+	{
+		return { glslang::EShTargetClientVersion::EShTargetVulkan_1_3,
+			glslang::EShTargetLanguageVersion::EShTargetSpv_1_6, 440 };
+	}
+
+	struct AssetShader
+	{
+		std::string Name;
+		vkLib::ShaderInput Input;
+		vkLib::PreprocessorDirectives Macros;
+	};
+
+	// what the ShaderPrecompiler builds, every file with a stage extension without macros
+	// and the permutations of Precompile.txt with theirs
+	inline std::vector<AssetShader> CollectAssetShaders()
+	{
+		const std::unordered_map<std::string, vk::ShaderStageFlagBits> stageExtensions =
+		{
+			{ ".vert", vk::ShaderStageFlagBits::eVertex },
+			{ ".frag", vk::ShaderStageFlagBits::eFragment },
+			{ ".comp", vk::ShaderStageFlagBits::eCompute },
+			{ ".geom", vk::ShaderStageFlagBits::eGeometry },
+		};
+
+		const std::unordered_map<std::string, vkLib::OptimizerFlag> optimizerFlags =
+		{
+			{ "O0", vkLib::OptimizerFlag::eNone },
+			{ "O1", vkLib::OptimizerFlag::eO1 },
+			{ "O2", vkLib::OptimizerFlag::eO2 },
+			{ "O3", vkLib::OptimizerFlag::eO3 },
+			{ "Os", vkLib::OptimizerFlag::eSize },
+		};
+
+		std::vector<AssetShader> shaders;
+
+		std::error_code error;
+
+		for (const auto& file : std::filesystem::recursive_directory_iterator(sAssetShaderDirectory, error))
+		{
+			auto found = stageExtensions.find(file.path().extension().string());
+
+			if (!file.is_regular_file() || found == stageExtensions.end())
+				continue;
+
+			auto& shader = shaders.emplace_back();
+			shader.Name = file.path().lexically_relative(sAssetShaderDirectory).generic_string();
+			shader.Input = { "", found->second, file.path().string(), vkLib::OptimizerFlag::eO3 };
+		}
+
+		std::ifstream manifest(sAssetShaderDirectory / "Precompile.txt");
+		std::string line;
+
+		while (std::getline(manifest, line))
+		{
+			std::istringstream stream(line);
+			std::string name, stage, optimizer;
+
+			if (!(stream >> name >> stage >> optimizer) || name.front() == '#')
+				continue;
+
+			// the recipes after a '+' don't matter to the tests
+			auto level = optimizerFlags.find(optimizer.substr(0, optimizer.find('+')));
+
+			if (level == optimizerFlags.end())
+				continue;
+
+			auto& shader = shaders.emplace_back();
+			shader.Name = name + " " + optimizer;
+			shader.Input = { "", vkLib::ShaderCompiler::GetShaderStageFlag(stage),
+				(sAssetShaderDirectory / name).string(), level->second };
+
+			std::string macro;
+
+			while (stream >> macro)
+			{
+				size_t separator = macro.find('=');
+
+				if (separator == std::string::npos)
+					shader.Macros[macro] = "";
+				else
+					shader.Macros[macro.substr(0, separator)] = macro.substr(separator + 1);
+			}
+		}
+
+		std::ranges::stable_sort(shaders, {}, &AssetShader::Name);
+
+		return shaders;
+	}
+
+	inline vkLib::CompileResult CompileAssetShader(vkLib::CompilerEnvironment env, const AssetShader& shader)
+	{
+		env.SetPreprocessorDirectives(shader.Macros);
+		return vkLib::ShaderCompiler(env).Compile(shader.Input);
+	}
+
+	// an environment that shares none of the process wide caches, so every compilation really runs
+	inline vkLib::CompilerEnvironment MakeIsolatedEnvironment()
+	{
+		vkLib::CompilerEnvironment env(GetShaderConfig());
+
+		env.SetSPIRVCache(nullptr);
+		env.SetShaderArchive(nullptr);
+		env.SetReflectionCache(std::make_shared<vkLib::ReflectionCache>());
+		env.SetIncludeCache(std::make_shared<vkLib::IncludeCache>());
+
+		return env;
+	}
+}
@@ -0,0 +1,416 @@
+#include "ShaderTestUtils.h"
+#include "Pipeline/PShader.h"
+
+namespace
+{
+	using vkLib::SpecializationType;
+	using vkLib::ShaderMetaData;
+
+	constexpr auto sCompute = vk::ShaderStageFlagBits::eCompute;
+	constexpr auto sNoID = ShaderMetaData::sNoConstantID;
+
+	// takes a reflection as CompileShaders would have saved it, no compiler involved
+	class ReflectedShader : public vkLib::PShader
+	{
+	public:
+		void AddStage(const vkLib::CompileResult& result)
+		{
+			mCompileResults.push_back(result);
+
+			if (result.MetaData.ShaderType == sCompute)
+			{
+				mWorkGroupSize = result.MetaData.WorkGroupSize;
+				mWorkGroupSizeIDs = result.MetaData.WorkGroupSizeIDs;
+			}
+		}
+	};
+
+	// local_size_x_id = 0, local_size_y_id = 1, a literal z and four named constants
+	vkLib::CompileResult MakeComputeReflection()
+	{
+		vkLib::CompileResult result;
+		result.MetaData.ShaderType = sCompute;
+		result.MetaData.WorkGroupSize = { 64, 1, 1 };
+		result.MetaData.WorkGroupSizeIDs = { 0, 1, sNoID };
+		result.MetaData.SpecConstants =
+		{
+			{ 0, "", SpecializationType::eUInt, 64 },
+			{ 1, "", SpecializationType::eUInt, 1 },
+			{ 5, "cScale", SpecializationType::eFloat, std::bit_cast<uint32_t>(1.0f) },
+			{ 6, "cSeed", SpecializationType::eUInt64, 0 },
+			{ 7, "cEnabled", SpecializationType::eBool, 1 },
+			{ 8, "cOffset", SpecializationType::eInt, 0 },
+		};
+
+		return result;
+	}
+
+	vkLib::CompileResult MakeFragmentReflection()
+	{
+		vkLib::CompileResult result;
+		result.MetaData.ShaderType = vk::ShaderStageFlagBits::eFragment;
+		result.MetaData.SpecConstants = { { 5, "cScale", SpecializationType::eFloat, 0 } };
+
+		return result;
+	}
+
+	template <typename T>
+	T ReadValue(const vkLib::SpecializationData& data, size_t entry)
+	{
+		T value{};
+
+		CHECK_EQ(data.Entries[entry].size, sizeof(T));
+		std::memcpy(&value, data.Data.data() + data.Entries[entry].offset, sizeof(T));
+
+		return value;
+	}
+
+	// the spirv-cross order of the constants is the module's, look them up by id
+	template <typename T>
+	T ReadConstant(const vkLib::SpecializationData& data, uint32_t constantID)
+	{
+		auto found = std::ranges::find(data.Entries, constantID, &vk::SpecializationMapEntry::constantID);
+		CHECK(found != data.Entries.end());
+
+		return ReadValue<T>(data, static_cast<size_t>(found - data.Entries.begin()));
+	}
+
+	const vkLib::SpecializationConstantInfo* FindConstant(const vkLib::CompileResult& result, uint32_t constantID)
+	{
+		for (const auto& constant : result.MetaData.SpecConstants)
+		{
+			if (constant.ConstantID == constantID)
+				return &constant;
+		}
+
+		return nullptr;
+	}
+
+	std::string MakeSweepSource(const std::string& localSize)
+	{
+		return
+			"#version 440\n"
+			"layout(" + localSize + ") in;\n"
+			"layout(std430, set = 0, binding = 0) buffer Values { float sValues[]; };\n"
+			"void main() { sValues[gl_GlobalInvocationID.x] = sqrt(sValues[gl_GlobalInvocationID.x]) * 2.0; }\n";
+	}
+}
+
+TEST(Specialization, ValuesByIDAndName)
+{
+	ReflectedShader shader;
+	shader.AddStage(MakeComputeReflection());
+
+	shader.SetSpecializationConstant(6, uint64_t(1) << 40);
+
+	CHECK(shader.SetSpecializationConstant("cScale", 2.5f));
+	CHECK(shader.SetSpecializationConstant("cEnabled", false));
+	CHECK(!shader.SetSpecializationConstant("cMissing", 1));
+
+	const auto& values = shader.GetSpecializationConstants();
+
+	CHECK_EQ(values.size(), size_t(3));
+	CHECK(values.at(5).Type == SpecializationType::eFloat && values.at(5).Bits == std::bit_cast<uint32_t>(2.5f));
+	CHECK(values.at(6).Type == SpecializationType::eUInt64 && values.at(6).Bits == uint64_t(1) << 40);
+	CHECK(values.at(7).Type == SpecializationType::eBool && values.at(7).Bits == 0);
+
+	// negative ints keep their 32 bits only
+	shader.SetSpecializationConstant(8, -2);
+
+	CHECK(shader.GetSpecializationConstants().at(8).Type == SpecializationType::eInt);
+	CHECK_EQ(shader.GetSpecializationConstants().at(8).Bits, uint64_t(0xfffffffe));
+
+	shader.RemoveSpecializationConstant(6);
+
+	CHECK(!shader.GetSpecializationConstants().contains(6));
+
+	shader.ClearSpecializationConstants();
+
+	CHECK(shader.GetSpecializationConstants().empty());
+	CHECK(shader.ValidateSpecializations().empty());
+}
+
+TEST(Specialization, WorkGroupSizeOnlyThroughIDs)
+{
+	ReflectedShader shader;
+
+	// nothing compiled, nothing to specialize
+	CHECK(!shader.SetWorkGroupSize({ 8, 8, 1 }));
+
+	shader.AddStage(MakeComputeReflection());
+
+	CHECK(shader.GetWorkGroupSize() == glm::uvec3(64, 1, 1));
+
+	// z is a literal one
+	CHECK(!shader.SetWorkGroupSize({ 8, 8, 2 }));
+	CHECK(shader.GetSpecializationConstants().empty());
+
+	CHECK(shader.SetWorkGroupSize({ 16, 8, 1 }));
+	CHECK(shader.GetWorkGroupSize() == glm::uvec3(16, 8, 1));
+	CHECK_EQ(shader.GetSpecializationConstants().at(0).Bits, uint64_t(16));
+
+	// the sizes are plain constants, setting them by id works the same
+	shader.SetSpecializationConstant(1, 4u);
+
+	CHECK(shader.GetWorkGroupSize() == glm::uvec3(16, 4, 1));
+
+	// a value the size can't take leaves the reflected one
+	shader.SetSpecializationConstant(0, 2.0f);
+
+	CHECK(shader.GetWorkGroupSize() == glm::uvec3(64, 4, 1));
+}
+
+TEST(Specialization, ValidateReportsMismatches)
+{
+	ReflectedShader shader;
+	shader.AddStage(MakeComputeReflection());
+	shader.AddStage(MakeFragmentReflection());
+
+	// int and uint of the same size stand in for each other
+	shader.SetSpecializationConstant(8, 3u);
+	shader.SetSpecializationConstant(5, 1.5f);
+	shader.SetSpecializationConstant(7, 1);
+
+	CHECK(shader.ValidateSpecializations().empty());
+
+	shader.SetSpecializationConstant(5, 3);
+	shader.SetSpecializationConstant(6, 3u);
+	shader.SetSpecializationConstant(9, 3u);
+	shader.SetSpecializationConstant(1, 0u);
+
+	auto messages = shader.ValidateSpecializations();
+
+	auto mentions = [&messages](const std::string& text)
+	{
+		return std::ranges::count_if(messages, [&text](const std::string& message)
+			{ return message.find(text) != std::string::npos; });
+	};
+
+	// the float is wrong in both stages, the 64 bit one has the wrong size
+	CHECK_EQ(messages.size(), size_t(5));
+	CHECK_EQ(mentions("constant_id 5 (cScale) is declared as float"), 2);
+	CHECK_EQ(mentions("constant_id 6 (cSeed) is declared as uint64_t"), 1);
+	CHECK_EQ(mentions("constant_id 9 is set but no compiled stage declares it"), 1);
+	CHECK_EQ(mentions("the work group size y (constant_id 1) is zero"), 1);
+}
+
+TEST(Specialization, DataHoldsTheDeclaredValues)
+{
+	ReflectedShader shader;
+	shader.AddStage(MakeComputeReflection());
+	shader.AddStage(MakeFragmentReflection());
+
+	// nothing set, no specialization info at all
+	CHECK(shader.GetSpecializationData(sCompute).Entries.empty());
+
+	shader.SetWorkGroupSize({ 128, 2, 1 });
+	shader.SetSpecializationConstant("cScale", 0.25f);
+	shader.SetSpecializationConstant("cSeed", uint64_t(0x0123456789abcdef));
+	shader.SetSpecializationConstant("cEnabled", true);
+
+	// mismatched and undeclared values are left out
+	shader.SetSpecializationConstant("cOffset", 1.0f);
+	shader.SetSpecializationConstant(9, 1u);
+
+	auto compute = shader.GetSpecializationData(sCompute);
+
+	CHECK_EQ(compute.Entries.size(), size_t(5));
+	CHECK_EQ(compute.Data.size(), size_t(4 * 4 + 8));
+
+	// in the order of the reflection, packed back to back
+	uint32_t offset = 0;
+
+	for (const auto& entry : compute.Entries)
+	{
+		CHECK_EQ(entry.offset, offset);
+		offset += static_cast<uint32_t>(entry.size);
+	}
+
+	CHECK_EQ(compute.Entries[0].constantID, uint32_t(0));
+	CHECK_EQ(ReadValue<uint32_t>(compute, 0), uint32_t(128));
+	CHECK_EQ(ReadValue<uint32_t>(compute, 1), uint32_t(2));
+	CHECK_EQ(ReadValue<float>(compute, 2), 0.25f);
+	CHECK_EQ(ReadValue<uint64_t>(compute, 3), uint64_t(0x0123456789abcdef));
+
+	// a VkBool32
+	CHECK_EQ(compute.Entries[4].constantID, uint32_t(7));
+	CHECK_EQ(ReadValue<uint32_t>(compute, 4), uint32_t(1));
+
+	// every stage gets the constants it declares only
+	auto fragment = shader.GetSpecializationData(vk::ShaderStageFlagBits::eFragment);
+
+	CHECK_EQ(fragment.Entries.size(), size_t(1));
+	CHECK_EQ(ReadValue<float>(fragment, 0), 0.25f);
+	CHECK(shader.GetSpecializationData(vk::ShaderStageFlagBits::eVertex).Entries.empty());
+}
+
+TEST(Specialization, ReflectsDeclarations)
+{
+	const std::string source =
+		"#version 440\n"
+		"layout(local_size_x_id = 3, local_size_y = 4) in;\n"
+		"layout(constant_id = 0) const float cScale = 1.5;\n"
+		"layout(constant_id = 1) const bool cEnabled = true;\n"
+		"layout(constant_id = 2) const int cOffset = -2;\n"
+		"layout(std430, set = 0, binding = 0) buffer Values { float sValues[]; };\n"
+		"void main()\n"
+		"{\n"
+		"	if (cEnabled)\n"
+		"		sValues[gl_GlobalInvocationID.x + cOffset] *= cScale;\n"
+		"}\n";
+
+	for (auto recipe : { vkLib::OptimizerFlag::eNone, vkLib::OptimizerFlag::eO3 | vkLib::OptimizerFlag::eStripDebug })
+	{
+		auto env = Tests::MakeIsolatedEnvironment();
+		auto result = vkLib::ShaderCompiler(env).Compile({ source, sCompute, "", recipe });
+
+		CHECK(result.Error.Type == vkLib::ErrorType::eNone);
+
+		// the unspecialized size is the default of the constant
+		CHECK(result.MetaData.WorkGroupSize == glm::uvec3(1, 4, 1));
+		CHECK(result.MetaData.WorkGroupSizeIDs == glm::uvec3(3, sNoID, sNoID));
+
+		auto scale = FindConstant(result, 0);
+		auto enabled = FindConstant(result, 1);
+		auto offset = FindConstant(result, 2);
+		auto sizeX = FindConstant(result, 3);
+
+		// the names survive stripping, PShader looks them up
+		CHECK(scale && enabled && offset && sizeX);
+		CHECK(scale->Name == "cScale" && scale->Type == SpecializationType::eFloat);
+		CHECK_EQ(scale->DefaultValue, uint64_t(std::bit_cast<uint32_t>(1.5f)));
+		CHECK(enabled->Name == "cEnabled" && enabled->Type == SpecializationType::eBool);
+		CHECK_EQ(enabled->DefaultValue, uint64_t(1));
+		CHECK(offset->Name == "cOffset" && offset->Type == SpecializationType::eInt);
+		CHECK_EQ(offset->DefaultValue, uint64_t(0xfffffffe));
+		CHECK(sizeX->Type == SpecializationType::eUInt);
+		CHECK_EQ(sizeX->DefaultValue, uint64_t(1));
+	}
+}
+
+TEST(Specialization, ShaderFollowsItsReflection)
+{
+	vkLib::PShader shader;
+	shader.SetShader("eCompute",
+		"#version 440\n"
+		"layout(local_size_x_id = 0) in;\n"
+		"layout(constant_id = 1) const uint cRepeat = 1;\n"
+		"layout(std430, set = 0, binding = 0) buffer Values { uint sValues[]; };\n"
+		"void main() { for (uint i = 0; i < cRepeat; i++) sValues[gl_GlobalInvocationID.x] += i; }\n");
+
+	// set before the first compilation, by id, names need the reflection
+	shader.SetSpecializationConstant(0, 256u);
+
+	CHECK(!shader.SetSpecializationConstant("cRepeat", 4u));
+
+	for (const auto& error : shader.CompileShaders())
+		CHECK(error.Type == vkLib::ErrorType::eNone);
+
+	CHECK(shader.SetSpecializationConstant("cRepeat", 4u));
+	CHECK(shader.GetWorkGroupSize() == glm::uvec3(256, 1, 1));
+	CHECK(shader.ValidateSpecializations().empty());
+
+	// the values outlive a recompilation
+	shader.CompileShaders();
+
+	auto data = shader.GetSpecializationData(sCompute);
+
+	CHECK_EQ(data.Entries.size(), size_t(2));
+	CHECK_EQ(ReadConstant<uint32_t>(data, 0), uint32_t(256));
+	CHECK_EQ(ReadConstant<uint32_t>(data, 1), uint32_t(4));
+	CHECK(shader.GetWorkGroupSize() == glm::uvec3(256, 1, 1));
+}
+
+TEST(Specialization, AssetShadersDeclareConsistently)
+{
+	for (const auto& shader : Tests::CollectAssetShaders())
+	{
+		auto result = Tests::CompileAssetShader(Tests::MakeIsolatedEnvironment(), shader);
+
+		CHECK(result.Error.Type == vkLib::ErrorType::eNone);
+
+		std::set<uint32_t> ids;
+
+		for (const auto& constant : result.MetaData.SpecConstants)
+			CHECK(ids.insert(constant.ConstantID).second);
+
+		// every specialized size is a uint constant whose default is the reflected size
+		for (glm::length_t i = 0; i < 3; i++)
+		{
+			uint32_t constantID = result.MetaData.WorkGroupSizeIDs[i];
+
+			if (constantID == sNoID)
+				continue;
+
+			auto constant = FindConstant(result, constantID);
+
+			CHECK(constant && constant->Type == SpecializationType::eUInt);
+			CHECK_EQ(constant->DefaultValue, uint64_t(result.MetaData.WorkGroupSize[i]));
+		}
+
+		// and a shader setting every declared constant to its default validates
+		ReflectedShader specialized;
+		specialized.AddStage(result);
+
+		for (const auto& constant : result.MetaData.SpecConstants)
+		{
+			if (constant.Type == SpecializationType::eFloat)
+				specialized.SetSpecializationConstant(constant.ConstantID, std::bit_cast<float>(uint32_t(constant.DefaultValue)));
+			else if (constant.Type == SpecializationType::eBool)
+				specialized.SetSpecializationConstant(constant.ConstantID, constant.DefaultValue != 0);
+			else if (constant.Type == SpecializationType::eUInt || constant.Type == SpecializationType::eInt)
+				specialized.SetSpecializationConstant(constant.ConstantID, uint32_t(constant.DefaultValue));
+		}
+
+		CHECK(specialized.ValidateSpecializations().empty());
+		CHECK(specialized.GetWorkGroupSize() == result.MetaData.WorkGroupSize);
+	}
+}
+
+BENCHMARK(Specialization, WorkGroupSizeSweep)
+{
+	const std::vector<uint32_t> sizes = { 32, 64, 128, 256, 512, 1024 };
+
+	// a module per size, the way the macros used to pick it
+	size_t macroWords = 0;
+
+	double macros = Tests::MeasureSeconds([&]()
+	{
+		for (uint32_t size : sizes)
+		{
+			auto env = Tests::MakeIsolatedEnvironment();
+			env.SetPreprocessorDirectives({ { "WORKGROUP_SIZE", std::to_string(size) } });
+
+			auto result = vkLib::ShaderCompiler(env).Compile({ MakeSweepSource("local_size_x = WORKGROUP_SIZE"),
+				sCompute, "", vkLib::OptimizerFlag::eO3 });
+
+			CHECK(result.Error.Type == vkLib::ErrorType::eNone);
+			macroWords += result.SPIR_V.ByteCode.size();
+		}
+	});
+
+	// one module, the size handed over at pipeline creation
+	ReflectedShader shader;
+	size_t specializedWords = 0;
+
+	double specialization = Tests::MeasureSeconds([&]()
+	{
+		auto env = Tests::MakeIsolatedEnvironment();
+		auto result = vkLib::ShaderCompiler(env).Compile({ MakeSweepSource("local_size_x_id = 0"),
+			sCompute, "", vkLib::OptimizerFlag::eO3 });
+
+		CHECK(result.Error.Type == vkLib::ErrorType::eNone);
+		specializedWords = result.SPIR_V.ByteCode.size();
+		shader.AddStage(result);
+
+		for (uint32_t size : sizes)
+		{
+			CHECK(shader.SetWorkGroupSize({ size, 1, 1 }));
+			Tests::DoNotOptimize(shader.GetSpecializationData(sCompute));
+		}
+	});
+
+	std::cout << "\t" << sizes.size() << " work group sizes, recompiled: " << macros * 1e3 << " ms, "
+		<< macroWords * sizeof(uint32_t) << " bytes of SPIR-V\n\tspecialized: " << specialization * 1e3 << " ms, "
+		<< specializedWords * sizeof(uint32_t) << " bytes" << std::endl;
+}
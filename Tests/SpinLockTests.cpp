@@ -0,0 +1,234 @@
+#include "TestRunner.h"
+#include "Core/SpinLock.h"
+
+namespace
+{
+	// every thread bumps a plain counter under the lock, a lost update means two owners at once
+	template <typename Lock>
+	void StressMutualExclusion(uint32_t threadCount, uint32_t iterations)
+	{
+		Lock lock;
+		uint64_t counter = 0;
+
+		std::vector<std::jthread> threads;
+
+		for (uint32_t i = 0; i < threadCount; i++)
+		{
+			threads.emplace_back([&]()
+			{
+				for (uint32_t j = 0; j < iterations; j++)
+				{
+					std::scoped_lock locker(lock);
+					counter++;
+				}
+			});
+		}
+
+		threads.clear();
+
+		CHECK_EQ(counter, uint64_t(threadCount) * iterations);
+	}
+
+	// stands in for the work done while the lock is held
+	void SpinFor(std::chrono::nanoseconds duration)
+	{
+		if (duration.count() == 0)
+			return;
+
+		auto end = std::chrono::steady_clock::now() + duration;
+
+		while (std::chrono::steady_clock::now() < end)
+			VK_CPU_RELAX();
+	}
+
+	// seconds per acquisition with every holder working for the given time
+	template <typename Lock>
+	double MeasureContended(uint32_t threadCount, uint32_t iterations, std::chrono::nanoseconds workload)
+	{
+		Lock lock;
+		uint64_t counter = 0;
+
+		double seconds = Tests::MeasureSeconds([&]()
+		{
+			std::vector<std::jthread> threads;
+
+			for (uint32_t i = 0; i < threadCount; i++)
+			{
+				threads.emplace_back([&]()
+				{
+					for (uint32_t j = 0; j < iterations; j++)
+					{
+						std::scoped_lock locker(lock);
+						SpinFor(workload);
+						counter++;
+					}
+				});
+			}
+		});
+
+		CHECK_EQ(counter, uint64_t(threadCount) * iterations);
+
+		return seconds / counter;
+	}
+
+	// the owner sleeps far past the spin budget, so every waiter ends up parked
+	template <typename Lock>
+	void StressParkedWaiters(uint32_t threadCount)
+	{
+		Lock lock;
+		std::atomic<uint32_t> entered = 0;
+
+		lock.lock();
+
+		std::vector<std::jthread> threads;
+
+		for (uint32_t i = 0; i < threadCount; i++)
+		{
+			threads.emplace_back([&]()
+			{
+				std::scoped_lock locker(lock);
+				entered++;
+			});
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		CHECK_EQ(entered.load(), 0u);
+
+		lock.unlock();
+		threads.clear();
+
+		CHECK_EQ(entered.load(), threadCount);
+	}
+}
+
+TEST(SpinBackoff, ExhaustsAndResets)
+{
+	vkLib::Core::SpinBackoff backoff;
+	CHECK(!backoff.Exhausted());
+
+	uint32_t pauses = 0;
+
+	while (!backoff.Exhausted())
+	{
+		backoff.Pause();
+		pauses++;
+	}
+
+	// doubling up to the cap, the budget can't take more rounds than pauses it allows
+	CHECK(pauses > 1 && pauses <= vkLib::Core::SpinBackoff::sSpinBudget);
+
+	backoff.Reset();
+	CHECK(!backoff.Exhausted());
+}
+
+TEST(SpinLock, TryLock)
+{
+	vkLib::SpinLock lock;
+
+	CHECK(lock.try_lock());
+	CHECK(!lock.try_lock());
+
+	lock.unlock();
+
+	CHECK(lock.try_lock());
+	lock.unlock();
+}
+
+TEST(SpinLock, MutualExclusion)
+{
+	StressMutualExclusion<vkLib::SpinLock>(8, 100'000);
+}
+
+TEST(SpinLock, ParkedWaitersWakeUp)
+{
+	StressParkedWaiters<vkLib::SpinLock>(8);
+}
+
+TEST(TicketLock, TryLock)
+{
+	vkLib::TicketLock lock;
+
+	CHECK(lock.try_lock());
+	CHECK(!lock.try_lock());
+
+	lock.unlock();
+
+	CHECK(lock.try_lock());
+	lock.unlock();
+}
+
+TEST(TicketLock, MutualExclusion)
+{
+	StressMutualExclusion<vkLib::TicketLock>(8, 5'000);
+}
+
+TEST(TicketLock, ParkedWaitersWakeUp)
+{
+	StressParkedWaiters<vkLib::TicketLock>(8);
+}
+
+TEST(TicketLock, AcquiresInArrivalOrder)
+{
+	constexpr uint32_t sThreadCount = 6;
+
+	vkLib::TicketLock lock;
+	std::vector<uint32_t> order;
+
+	lock.lock();
+
+	std::vector<std::jthread> threads;
+
+	for (uint32_t i = 0; i < sThreadCount; i++)
+	{
+		threads.emplace_back([&lock, &order, i]()
+		{
+			std::scoped_lock locker(lock);
+			order.push_back(i);
+		});
+
+		// long enough for the thread to draw its ticket before the next one starts
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+
+	lock.unlock();
+	threads.clear();
+
+	CHECK_EQ(order.size(), size_t(sThreadCount));
+
+	for (uint32_t i = 0; i < sThreadCount; i++)
+		CHECK_EQ(order[i], i);
+}
+
+// empty, short and long critical sections, the longer ones push the spinning waiters into parking
+BENCHMARK(SpinLock, ContendedThroughput)
+{
+	struct Workload
+	{
+		const char* Name;
+		std::chrono::nanoseconds Duration;
+		uint32_t Iterations;
+	};
+
+	const Workload workloads[] =
+	{
+		{ "empty", std::chrono::nanoseconds(0), 50'000 },
+		{ "100 ns", std::chrono::nanoseconds(100), 20'000 },
+		{ "1 us", std::chrono::microseconds(1), 5'000 },
+		{ "10 us", std::chrono::microseconds(10), 500 },
+	};
+
+	for (const auto& workload : workloads)
+	{
+		std::cout << "\t" << workload.Name << " critical section, ns per acquisition:" << std::endl;
+
+		for (uint32_t threadCount : { 1u, 2u, 4u, 8u })
+		{
+			double spin = MeasureContended<vkLib::SpinLock>(threadCount, workload.Iterations, workload.Duration);
+			double ticket = MeasureContended<vkLib::TicketLock>(threadCount, workload.Iterations, workload.Duration);
+			double mutex = MeasureContended<std::mutex>(threadCount, workload.Iterations, workload.Duration);
+
+			std::cout << "\t\t" << threadCount << " threads: SpinLock " << spin * 1e9 << ", TicketLock "
+				<< ticket * 1e9 << ", std::mutex " << mutex * 1e9 << std::endl;
+		}
+	}
+}
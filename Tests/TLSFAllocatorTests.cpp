@@ -0,0 +1,230 @@
+#include "TestRunner.h"
+#include "Memory/TLSFAllocator.h"
+
+namespace
+{
+	using vkLib::Core::TLSFAllocator;
+
+	// shadow of the live ranges, any overlap between two allocations is a bookkeeping bug
+	class RangeShadow
+	{
+	public:
+		bool Insert(const TLSFAllocator::Allocation& allocation)
+		{
+			auto next = mRanges.lower_bound(allocation.Offset);
+
+			if (next != mRanges.end() && next->first < allocation.Offset + allocation.Size)
+				return false;
+
+			if (next != mRanges.begin() && std::prev(next)->second > allocation.Offset)
+				return false;
+
+			mRanges[allocation.Offset] = allocation.Offset + allocation.Size;
+			return true;
+		}
+
+		void Erase(const TLSFAllocator::Allocation& allocation) { mRanges.erase(allocation.Offset); }
+
+	private:
+		// offset -> end
+		std::map<uint64_t, uint64_t> mRanges;
+	};
+}
+
+TEST(TLSFAllocator, StartsAsOneFreeRange)
+{
+	TLSFAllocator allocator(4096);
+
+	CHECK(allocator.IsEmpty());
+	CHECK(allocator.Validate());
+	CHECK_EQ(allocator.GetFreeSize(), uint64_t(4096));
+	CHECK_EQ(allocator.GetFreeRangeCount(), 1u);
+	CHECK_EQ(allocator.GetLargestFreeRange(), uint64_t(4096));
+}
+
+TEST(TLSFAllocator, ExactFitAndExhaustion)
+{
+	TLSFAllocator allocator(1024);
+	std::vector<TLSFAllocator::Allocation> allocations;
+
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		allocations.push_back(allocator.Allocate(256, 256));
+
+		CHECK(allocations.back());
+		CHECK_EQ(allocations.back().Offset % 256, uint64_t(0));
+	}
+
+	CHECK(!allocator.Allocate(1));
+	CHECK_EQ(allocator.GetFreeSize(), uint64_t(0));
+	CHECK_EQ(allocator.GetAllocationCount(), 4u);
+	CHECK(allocator.Validate());
+
+	for (const auto& allocation : allocations)
+		allocator.Free(allocation.Node);
+
+	CHECK(allocator.IsEmpty());
+	CHECK_EQ(allocator.GetFreeRangeCount(), 1u);
+}
+
+TEST(TLSFAllocator, RespectsAlignment)
+{
+	TLSFAllocator allocator(1 << 20);
+
+	// an odd sized allocation first so every later one starts misaligned
+	auto odd = allocator.Allocate(17);
+	CHECK(odd);
+
+	for (uint64_t alignment = 1; alignment <= 4096; alignment *= 2)
+	{
+		auto allocation = allocator.Allocate(100, alignment);
+
+		CHECK(allocation);
+		CHECK_EQ(allocation.Offset % alignment, uint64_t(0));
+		CHECK(allocation.Size >= 100);
+	}
+
+	CHECK(allocator.Validate());
+}
+
+TEST(TLSFAllocator, FragmentationAndCoalescing)
+{
+	TLSFAllocator allocator(1024);
+
+	auto first = allocator.Allocate(256, 256);
+	auto second = allocator.Allocate(256, 256);
+	auto third = allocator.Allocate(256, 256);
+	auto fourth = allocator.Allocate(256, 256);
+
+	// two holes of 256 that aren't neighbours
+	allocator.Free(second.Node);
+	allocator.Free(fourth.Node);
+
+	CHECK_EQ(allocator.GetFreeSize(), uint64_t(512));
+	CHECK_EQ(allocator.GetFreeRangeCount(), 2u);
+	CHECK_EQ(allocator.GetLargestFreeRange(), uint64_t(256));
+	CHECK(!allocator.Allocate(512));
+
+	// freeing the range between them merges all three
+	allocator.Free(third.Node);
+
+	CHECK_EQ(allocator.GetFreeRangeCount(), 1u);
+	CHECK_EQ(allocator.GetLargestFreeRange(), uint64_t(768));
+
+	auto merged = allocator.Allocate(768, 256);
+	CHECK(merged);
+	CHECK_EQ(merged.Offset, second.Offset);
+
+	allocator.Free(merged.Node);
+	allocator.Free(first.Node);
+
+	CHECK(allocator.IsEmpty());
+	CHECK_EQ(allocator.GetFreeRangeCount(), 1u);
+	CHECK(allocator.Validate());
+}
+
+TEST(TLSFAllocator, FreeOrderDoesNotMatter)
+{
+	TLSFAllocator allocator(64 * 1024);
+	std::vector<TLSFAllocator::Allocation> allocations;
+
+	for (uint32_t i = 0; i < 64; i++)
+		allocations.push_back(allocator.Allocate(512 + i * 8, 64));
+
+	std::mt19937 random(3);
+	std::shuffle(allocations.begin(), allocations.end(), random);
+
+	for (const auto& allocation : allocations)
+	{
+		allocator.Free(allocation.Node);
+		CHECK(allocator.Validate());
+	}
+
+	CHECK_EQ(allocator.GetFreeRangeCount(), 1u);
+	CHECK_EQ(allocator.GetLargestFreeRange(), uint64_t(64 * 1024));
+}
+
+TEST(TLSFAllocator, RandomizedFuzz)
+{
+	std::mt19937_64 random(1);
+
+	for (uint32_t round = 0; round < 10; round++)
+	{
+		const uint64_t size = 1ull << (16 + round);
+
+		TLSFAllocator allocator(size);
+		RangeShadow shadow;
+		std::vector<TLSFAllocator::Allocation> live;
+
+		for (uint32_t step = 0; step < 10'000; step++)
+		{
+			if (live.empty() || random() % 100 < 55)
+			{
+				uint64_t requested = 1 + random() % (random() % 4 == 0 ? size / 8 : 512);
+				uint64_t alignment = 1ull << (random() % 9);
+
+				auto allocation = allocator.Allocate(requested, alignment);
+
+				if (allocation)
+				{
+					CHECK_EQ(allocation.Offset % alignment, uint64_t(0));
+					CHECK(allocation.Size >= requested);
+					CHECK(allocation.Offset + allocation.Size <= size);
+					CHECK(shadow.Insert(allocation));
+
+					live.push_back(allocation);
+				}
+			}
+			else
+			{
+				size_t index = random() % live.size();
+
+				allocator.Free(live[index].Node);
+				shadow.Erase(live[index]);
+
+				live[index] = live.back();
+				live.pop_back();
+			}
+
+			if (step % 500 == 0)
+				CHECK(allocator.Validate());
+		}
+
+		for (const auto& allocation : live)
+			allocator.Free(allocation.Node);
+
+		// everything coalesces back into the initial range
+		CHECK(allocator.Validate());
+		CHECK_EQ(allocator.GetFreeSize(), size);
+		CHECK_EQ(allocator.GetFreeRangeCount(), 1u);
+		CHECK_EQ(allocator.GetLargestFreeRange(), size);
+	}
+}
+
+BENCHMARK(TLSFAllocator, AllocationRate)
+{
+	constexpr uint32_t sRounds = 10;
+	constexpr uint32_t sAllocations = 100'000;
+
+	TLSFAllocator allocator(1ull << 30);
+
+	std::vector<TLSFAllocator::NodeHandle> nodes;
+	nodes.reserve(sAllocations);
+
+	double seconds = Tests::MeasureSeconds([&]()
+	{
+		for (uint32_t round = 0; round < sRounds; round++)
+		{
+			for (uint32_t i = 0; i < sAllocations; i++)
+				nodes.push_back(allocator.Allocate(64 + (i % 1000) * 16, 256).Node);
+
+			for (auto node : nodes)
+				allocator.Free(node);
+
+			nodes.clear();
+		}
+	});
+
+	std::cout << "\tallocate + free: " << seconds * 1e9 / (2.0 * sRounds * sAllocations)
+		<< " ns per operation" << std::endl;
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include "Core/Config.h"
+
+#include <chrono>
+#include <random>
+#include <numeric>
+
+// Minimal self registering test runner, every TEST in any file of the project is run by Main.cpp
+// CHECK failures throw, so a test stops at its first broken expectation
+// BENCHMARK bodies only run with --bench, they print their numbers instead of asserting on timings
+
+namespace Tests
+{
+	struct TestCase
+	{
+		const char* Suite = nullptr;
+		const char* Name = nullptr;
+		void (*Run)() = nullptr;
+
+		bool Benchmark = false;
+	};
+
+	struct TestFailure
+	{
+		std::string Message;
+	};
+
+	inline std::vector<TestCase>& GetRegistry()
+	{
+		static std::vector<TestCase> sRegistry;
+		return sRegistry;
+	}
+
+	struct TestRegistrar
+	{
+		TestRegistrar(const char* suite, const char* name, void (*run)(), bool benchmark)
+		{ GetRegistry().push_back({ suite, name, run, benchmark }); }
+	};
+
+	[[noreturn]] inline void Fail(const char* file, int line, const std::string& expression)
+	{
+		std::string message = file;
+		message += "(" + std::to_string(line) + "): " + expression;
+
+		throw TestFailure{ message };
+	}
+
+	// keeps the optimizer from discarding the work a benchmark measures
+	template <typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+		[[maybe_unused]] static const void* volatile sSink;
+		sSink = &value;
+	}
+
+	// non null stand in for a vulkan handle, for code that only stores, compares and hashes them
+	template <typename Handle>
+	Handle MakeHandle(uint64_t value)
+	{ return Handle(reinterpret_cast<typename Handle::CType>(static_cast<uintptr_t>(value))); }
+
+	template <typename Fn>
+	double MeasureSeconds(Fn&& fn)
+	{
+		auto begin = std::chrono::steady_clock::now();
+		fn();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	// a fresh directory per test, removed again when the test is done
+	class ScratchDirectory
+	{
+	public:
+		explicit ScratchDirectory(const std::string& name)
+			: mPath(std::filesystem::temp_directory_path() / "vkLibTests" / name)
+		{
+			std::filesystem::remove_all(mPath);
+			std::filesystem::create_directories(mPath);
+		}
+
+		~ScratchDirectory()
+		{
+			std::error_code error;
+			std::filesystem::remove_all(mPath, error);
+		}
+
+		ScratchDirectory(const ScratchDirectory&) = delete;
+		ScratchDirectory& operator=(const ScratchDirectory&) = delete;
+
+		const std::filesystem::path& GetPath() const { return mPath; }
+
+		// writes relativePath below the directory, creating its parents on the way
+		std::filesystem::path Write(const std::filesystem::path& relativePath, std::string_view contents) const
+		{
+			auto path = mPath / relativePath;
+			std::filesystem::create_directories(path.parent_path());
+
+			std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+			file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+
+			return path;
+		}
+
+	private:
+		std::filesystem::path mPath;
+	};
+}
+
+#define TESTS_REGISTER(suite, name, benchmark) \
+	static void suite##_##name(); \
+	static ::Tests::TestRegistrar suite##_##name##_Registrar(#suite, #name, &suite##_##name, benchmark); \
+	static void suite##_##name()
+
+#define TEST(suite, name)         TESTS_REGISTER(suite, name, false)
+#define BENCHMARK(suite, name)    TESTS_REGISTER(suite, name, true)
+
+#define CHECK(expression) \
+	do { if (!(expression)) ::Tests::Fail(__FILE__, __LINE__, #expression); } while (false)
+
+#define CHECK_EQ(left, right) \
+	do { if (!((left) == (right))) ::Tests::Fail(__FILE__, __LINE__, #left " == " #right); } while (false)
@@ -0,0 +1,431 @@
+#include "TestRunner.h"
+#include "Memory/UploadBatcher.h"
+
+namespace
+{
+	// destinations are plain ids here, the uploader uses its buffers
+	using Batcher = vkLib::Core::BasicUploadBatcher<uint32_t>;
+	using Copy = Batcher::Copy;
+
+	// stands in for the transfer queue of the TransferUploader, executes the copies of a submitted batch
+	// from the staging bytes into its destinations and completes batches in order some submissions later
+	class MockTransferQueue
+	{
+	public:
+		MockTransferQueue(uint32_t destinationCount, uint64_t destinationSize, uint32_t latency)
+			: mDestinations(destinationCount, std::vector<std::byte>(destinationSize)), mLatency(latency) {}
+
+		void Submit(const Batcher::Batch& batch, const std::vector<std::byte>& staging)
+		{
+			for (const auto& copy : batch.Copies)
+			{
+				CHECK(copy.DstOffset + copy.Size <= mDestinations[copy.Dst].size());
+				CHECK(copy.SrcOffset + copy.Size <= staging.size());
+
+				std::memcpy(mDestinations[copy.Dst].data() + copy.DstOffset, staging.data() + copy.SrcOffset, copy.Size);
+			}
+
+			mSubmitted.push_back(batch.Value);
+			mSubmissionCount++;
+			mCopyCount += batch.Copies.size();
+		}
+
+		// the value of the newest batch the GPU is done with, zero while none is
+		uint64_t Poll()
+		{
+			while (mSubmitted.size() > mLatency)
+			{
+				mCompleted = mSubmitted.front();
+				mSubmitted.pop_front();
+			}
+
+			return mCompleted;
+		}
+
+		uint64_t Drain()
+		{
+			if (!mSubmitted.empty())
+				mCompleted = mSubmitted.back();
+
+			mSubmitted.clear();
+			return mCompleted;
+		}
+
+		const std::vector<std::byte>& GetDestination(uint32_t index) const { return mDestinations[index]; }
+
+		size_t GetSubmissionCount() const { return mSubmissionCount; }
+		size_t GetCopyCount() const { return mCopyCount; }
+
+	private:
+		std::vector<std::vector<std::byte>> mDestinations;
+		std::deque<uint64_t> mSubmitted;
+
+		uint32_t mLatency = 0;
+		uint64_t mCompleted = 0;
+		size_t mSubmissionCount = 0;
+		size_t mCopyCount = 0;
+	};
+
+	// what TransferUploader::Upload does with the mapped staging ring, minus the device
+	std::optional<uint64_t> Upload(Batcher& batcher, std::vector<std::byte>& staging,
+		uint32_t dst, uint64_t dstOffset, std::span<const std::byte> data)
+	{
+		auto ticket = batcher.Reserve(dst, dstOffset, data.size());
+
+		if (!ticket)
+			return std::nullopt;
+
+		std::memcpy(staging.data() + ticket->StagingOffset, data.data(), data.size());
+		batcher.Commit(*ticket);
+
+		return ticket->Value;
+	}
+
+	std::vector<std::byte> Pattern(size_t size, uint32_t seed)
+	{
+		std::vector<std::byte> bytes(size);
+
+		for (size_t i = 0; i < size; i++)
+			bytes[i] = static_cast<std::byte>((seed * 131 + i * 7) & 0xFF);
+
+		return bytes;
+	}
+}
+
+TEST(UploadBatcher, BatchesRequestsUnderOneValue)
+{
+	Batcher batcher(4096, 16);
+
+	CHECK(!batcher.Close());
+	CHECK_EQ(batcher.GetOpenValue(), uint64_t(1));
+
+	auto first = batcher.Reserve(0, 0, 10);
+	auto second = batcher.Reserve(1, 64, 20);
+
+	CHECK(first && second);
+	CHECK_EQ(first->Value, uint64_t(1));
+	CHECK_EQ(second->Value, uint64_t(1));
+
+	// each request starts on the staging alignment
+	CHECK_EQ(first->StagingOffset, uint64_t(0));
+	CHECK_EQ(second->StagingOffset, uint64_t(16));
+	CHECK_EQ(batcher.GetOpenRequestCount(), size_t(2));
+
+	batcher.Commit(*first);
+	batcher.Commit(*second);
+
+	auto batch = batcher.Close();
+
+	CHECK(batch.has_value());
+	CHECK_EQ(batch->Value, uint64_t(1));
+	CHECK_EQ(batch->RequestCount, size_t(2));
+	CHECK_EQ(batch->StagingSize, uint64_t(36));
+	CHECK_EQ(batch->Copies.size(), size_t(2));
+
+	// the next request joins the next batch
+	CHECK_EQ(batcher.GetOpenValue(), uint64_t(2));
+	CHECK_EQ(batcher.GetPendingBatchCount(), size_t(1));
+
+	batcher.Retire(batch->Value);
+
+	CHECK_EQ(batcher.GetRetiredValue(), uint64_t(1));
+	CHECK_EQ(batcher.GetUsedSize(), uint64_t(0));
+}
+
+TEST(UploadBatcher, MergesNeighbouringRequests)
+{
+	Batcher batcher(4096, 1);
+
+	// one buffer filled in three consecutive pieces, the staging bytes line up as well
+	for (uint64_t offset : { 0, 100, 200 })
+		batcher.Commit(*batcher.Reserve(5, offset, 100));
+
+	// a second buffer with a gap in its destination range
+	batcher.Commit(*batcher.Reserve(3, 0, 50));
+	batcher.Commit(*batcher.Reserve(3, 60, 50));
+
+	auto batch = batcher.Close();
+
+	CHECK_EQ(batch->RequestCount, size_t(5));
+	CHECK_EQ(batch->Copies.size(), size_t(3));
+
+	// sorted by destination
+	CHECK((batch->Copies[0].Dst == 3 && batch->Copies[0].DstOffset == 0 && batch->Copies[0].Size == 50));
+	CHECK((batch->Copies[1].Dst == 3 && batch->Copies[1].DstOffset == 60 && batch->Copies[1].Size == 50));
+	CHECK((batch->Copies[2].Dst == 5 && batch->Copies[2].DstOffset == 0 && batch->Copies[2].Size == 300));
+	CHECK_EQ(batch->Copies[2].SrcOffset, uint64_t(0));
+}
+
+TEST(UploadBatcher, LaterRequestsWinOverlaps)
+{
+	std::vector<Copy> copies = {
+		{ 0, 0, 0, 100 },
+		{ 0, 1000, 40, 20 },
+	};
+
+	Batcher::MergeCopies(copies);
+
+	// the first request is split around the second one
+	CHECK_EQ(copies.size(), size_t(3));
+	CHECK((copies[0].SrcOffset == 0 && copies[0].DstOffset == 0 && copies[0].Size == 40));
+	CHECK((copies[1].SrcOffset == 1000 && copies[1].DstOffset == 40 && copies[1].Size == 20));
+	CHECK((copies[2].SrcOffset == 60 && copies[2].DstOffset == 60 && copies[2].Size == 40));
+
+	// a later request covering an earlier one entirely hides it
+	copies = { { 0, 0, 10, 10 }, { 0, 500, 0, 40 } };
+	Batcher::MergeCopies(copies);
+
+	CHECK_EQ(copies.size(), size_t(1));
+	CHECK((copies[0].SrcOffset == 500 && copies[0].DstOffset == 0 && copies[0].Size == 40));
+}
+
+TEST(UploadBatcher, MergeMatchesAByteMapFuzz)
+{
+	std::mt19937 random(1);
+
+	for (uint32_t round = 0; round < 5000; round++)
+	{
+		std::vector<Copy> copies;
+		uint64_t srcOffset = 0;
+
+		uint32_t count = 1 + random() % 12;
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			Copy copy{ static_cast<uint32_t>(random() % 3), srcOffset, random() % 64, 1 + random() % 20 };
+
+			// sometimes contiguous in the staging ring, sometimes not
+			srcOffset += copy.Size + (random() % 2 ? 0 : 4);
+			copies.push_back(copy);
+		}
+
+		// destination byte -> staging byte it ends up with, in request order
+		std::map<std::pair<uint32_t, uint64_t>, uint64_t> expected;
+
+		for (const auto& copy : copies)
+			for (uint64_t i = 0; i < copy.Size; i++)
+				expected[{ copy.Dst, copy.DstOffset + i }] = copy.SrcOffset + i;
+
+		auto merged = copies;
+		Batcher::MergeCopies(merged);
+
+		std::map<std::pair<uint32_t, uint64_t>, uint64_t> actual;
+
+		for (size_t i = 0; i < merged.size(); i++)
+		{
+			const auto& copy = merged[i];
+
+			if (i > 0)
+			{
+				const auto& prev = merged[i - 1];
+
+				// sorted, free of overlaps and nothing left that could have been folded
+				CHECK(prev.Dst < copy.Dst || (prev.Dst == copy.Dst && prev.DstOffset + prev.Size <= copy.DstOffset));
+				CHECK(!(prev.Dst == copy.Dst && prev.DstOffset + prev.Size == copy.DstOffset
+					&& prev.SrcOffset + prev.Size == copy.SrcOffset));
+			}
+
+			for (uint64_t j = 0; j < copy.Size; j++)
+				actual[{ copy.Dst, copy.DstOffset + j }] = copy.SrcOffset + j;
+		}
+
+		CHECK(actual == expected);
+	}
+}
+
+TEST(UploadBatcher, FullRingWaitsForRetirement)
+{
+	Batcher batcher(256, 16);
+
+	batcher.Commit(*batcher.Reserve(0, 0, 200));
+	auto first = batcher.Close();
+
+	// the batch in flight still owns its staging bytes
+	CHECK(!batcher.Reserve(0, 0, 100));
+
+	batcher.Retire(first->Value);
+
+	auto ticket = batcher.Reserve(0, 0, 100);
+	CHECK(ticket.has_value());
+	CHECK_EQ(ticket->Value, uint64_t(2));
+
+	batcher.Commit(*ticket);
+}
+
+TEST(UploadBatcher, CloseWaitsForWriters)
+{
+	Batcher batcher(4096, 16);
+
+	auto ticket = batcher.Reserve(0, 0, 64);
+
+	std::atomic<bool> closed = false;
+	std::optional<Batcher::Batch> batch;
+
+	std::thread flusher([&]()
+	{
+		batch = batcher.Close();
+		closed = true;
+	});
+
+	// a reserved request keeps its batch from going out while its bytes are being written
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	bool closedEarly = closed;
+
+	// requests made meanwhile already go into the next batch
+	auto next = batcher.Reserve(0, 64, 64);
+
+	batcher.Commit(*ticket);
+	flusher.join();
+
+	CHECK(!closedEarly);
+	CHECK(batch && batch->Value == 1 && batch->RequestCount == 1);
+	CHECK(next && next->Value == 2);
+
+	batcher.Commit(*next);
+}
+
+TEST(UploadBatcher, ConcurrentUploadsThroughAMockQueue)
+{
+	constexpr uint32_t sThreads = 4;
+	constexpr uint32_t sUploadsPerThread = 500;
+	constexpr uint64_t sChunk = 48;
+
+	// every thread owns one destination, filled chunk by chunk
+	constexpr uint64_t sDestinationSize = sUploadsPerThread * sChunk;
+
+	Batcher batcher(8192, 16);
+	std::vector<std::byte> staging(batcher.GetCapacity());
+	MockTransferQueue queue(sThreads, sDestinationSize, 2);
+
+	std::atomic<uint32_t> finished = 0;
+	std::atomic<uint64_t> lastValues[sThreads] = {};
+	std::vector<std::thread> threads;
+
+	for (uint32_t t = 0; t < sThreads; t++)
+	{
+		threads.emplace_back([&, t]()
+		{
+			auto bytes = Pattern(sDestinationSize, t);
+
+			for (uint32_t i = 0; i < sUploadsPerThread; i++)
+			{
+				std::span<const std::byte> chunk(bytes.data() + i * sChunk, sChunk);
+				std::optional<uint64_t> value;
+
+				while (!(value = Upload(batcher, staging, t, i * sChunk, chunk)))
+					std::this_thread::yield();
+
+				lastValues[t] = *value;
+			}
+
+			finished++;
+		});
+	}
+
+	// the uploader's flush loop, close, submit, retire what the queue finished
+	uint64_t lastBatch = 0;
+	bool ordered = true;
+
+	auto flush = [&]()
+	{
+		if (auto batch = batcher.Close())
+		{
+			ordered &= batch->Value > lastBatch;
+			lastBatch = batch->Value;
+
+			queue.Submit(*batch, staging);
+		}
+		else
+		{
+			// nothing new to submit, the GPU catches up meanwhile
+			batcher.Retire(queue.Drain());
+		}
+
+		if (uint64_t completed = queue.Poll())
+			batcher.Retire(completed);
+	};
+
+	while (finished < sThreads)
+	{
+		flush();
+		std::this_thread::yield();
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	flush();
+	batcher.Retire(queue.Drain());
+
+	CHECK(ordered);
+	CHECK_EQ(batcher.GetUsedSize(), uint64_t(0));
+	CHECK_EQ(batcher.GetPendingBatchCount(), size_t(0));
+
+	// every value handed out was closed and submitted
+	for (const auto& value : lastValues)
+		CHECK(value <= lastBatch);
+
+	for (uint32_t t = 0; t < sThreads; t++)
+		CHECK(queue.GetDestination(t) == Pattern(sDestinationSize, t));
+}
+
+BENCHMARK(UploadBatcher, SmallUploadThroughput)
+{
+	// material parameter blocks and instance data, thousands of small uploads while a scene loads
+	constexpr uint32_t sUploads = 20000;
+	constexpr uint64_t sUploadSize = 64;
+	constexpr uint32_t sBatchSize = 256;
+	constexpr uint32_t sDestinations = 16;
+	constexpr uint32_t sUploadsPerDestination = sUploads / sDestinations;
+
+	auto bytes = Pattern(sUploadSize, 3);
+
+	auto run = [&](uint32_t batchSize, size_t& submissions, size_t& copies)
+	{
+		Batcher batcher(1 << 20, 16);
+		std::vector<std::byte> staging(batcher.GetCapacity());
+		MockTransferQueue queue(sDestinations, sUploadsPerDestination * sUploadSize, 2);
+
+		double seconds = Tests::MeasureSeconds([&]()
+		{
+			for (uint32_t i = 0; i < sUploads; i++)
+			{
+				// one buffer after the other, consecutive uploads fold into one copy
+				uint32_t dst = i / sUploadsPerDestination;
+				uint64_t dstOffset = (i % sUploadsPerDestination) * sUploadSize;
+
+				while (!Upload(batcher, staging, dst, dstOffset, bytes))
+					batcher.Retire(queue.Drain());
+
+				if (i % batchSize == batchSize - 1)
+				{
+					queue.Submit(*batcher.Close(), staging);
+					batcher.Retire(queue.Poll());
+				}
+			}
+
+			if (auto batch = batcher.Close())
+				queue.Submit(*batch, staging);
+
+			batcher.Retire(queue.Drain());
+		});
+
+		submissions = queue.GetSubmissionCount();
+		copies = queue.GetCopyCount();
+
+		Tests::DoNotOptimize(queue.GetDestination(0).data());
+
+		return seconds;
+	};
+
+	size_t batchedSubmissions = 0, batchedCopies = 0;
+	size_t singleSubmissions = 0, singleCopies = 0;
+
+	double batched = run(sBatchSize, batchedSubmissions, batchedCopies);
+	double single = run(1, singleSubmissions, singleCopies);
+
+	std::cout << "\tbatched: " << sUploads / batched / 1e6 << " M uploads/s, " << batchedSubmissions
+		<< " submissions, " << batchedCopies << " copy regions" << std::endl;
+	std::cout << "\tone per upload: " << sUploads / single / 1e6 << " M uploads/s, " << singleSubmissions
+		<< " submissions, " << singleCopies << " copy regions" << std::endl;
+}
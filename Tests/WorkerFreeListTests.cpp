@@ -0,0 +1,291 @@
+#include "TestRunner.h"
+#include "Process/WorkerFreeList.h"
+
+namespace
+{
+	using WorkerFreeList = vkLib::Core::WorkerFreeList;
+
+	// fence i belongs to worker i, the handle value is offset so no fence is null
+	vk::Fence FenceOf(uint32_t index) { return Tests::MakeHandle<vk::Fence>(index + 1); }
+	uint32_t IndexOf(vk::Fence fence) { return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(static_cast<VkFence>(fence)) - 1); }
+}
+
+TEST(WorkerFreeList, AcquiresEveryWorkerOnce)
+{
+	WorkerFreeList freeList;
+	freeList.Reset(4);
+
+	std::set<uint32_t> acquired;
+
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		uint32_t index = freeList.Acquire();
+
+		CHECK(index < 4);
+		CHECK(acquired.insert(index).second);
+		CHECK(freeList.GetState(index) == WorkerFreeList::SlotState::eAcquired);
+	}
+
+	CHECK_EQ(freeList.Acquire(), WorkerFreeList::sInvalidIndex);
+
+	freeList.Release(2);
+
+	CHECK(freeList.GetState(2) == WorkerFreeList::SlotState::eIdle);
+	CHECK_EQ(freeList.Acquire(), 2u);
+}
+
+TEST(WorkerFreeList, EmptyFamily)
+{
+	WorkerFreeList freeList;
+	freeList.Reset(0);
+
+	CHECK_EQ(freeList.Acquire(), WorkerFreeList::sInvalidIndex);
+	CHECK_EQ(freeList.Reclaim([](vk::Fence) { return true; }), 0u);
+}
+
+TEST(WorkerFreeList, ReclaimsOnlySignaledFences)
+{
+	WorkerFreeList freeList;
+	freeList.Reset(3);
+
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		uint32_t index = freeList.Acquire();
+		freeList.MarkInFlight(index, FenceOf(index));
+	}
+
+	CHECK_EQ(freeList.Acquire(), WorkerFreeList::sInvalidIndex);
+
+	std::vector<bool> signaled = { false, true, false };
+	auto isSignaled = [&signaled](vk::Fence fence) { return bool(signaled[IndexOf(fence)]); };
+
+	CHECK_EQ(freeList.Reclaim(isSignaled), 1u);
+	CHECK(freeList.GetState(1) == WorkerFreeList::SlotState::eIdle);
+	CHECK(freeList.GetState(0) == WorkerFreeList::SlotState::eInFlight);
+
+	// a fence seen twice hands the worker back once
+	CHECK_EQ(freeList.Reclaim(isSignaled), 0u);
+
+	CHECK_EQ(freeList.Acquire(), 1u);
+	CHECK_EQ(freeList.Acquire(), WorkerFreeList::sInvalidIndex);
+}
+
+TEST(WorkerFreeList, CollectsAndPinsInFlightFences)
+{
+	WorkerFreeList freeList;
+	freeList.Reset(3);
+
+	uint32_t first = freeList.Acquire();
+	uint32_t second = freeList.Acquire();
+
+	freeList.MarkInFlight(first, FenceOf(first));
+
+	std::vector<vk::Fence> fences;
+	std::vector<uint32_t> pinned;
+	freeList.CollectInFlightFences(fences, pinned);
+
+	// the acquired but not yet submitted worker has no fence to wait on
+	CHECK_EQ(fences.size(), 1u);
+	CHECK(fences.front() == FenceOf(first));
+	CHECK_EQ(pinned, std::vector<uint32_t>{ first });
+
+	freeList.UnpinAll(pinned);
+	freeList.Release(second);
+
+	// no pins left, this returns right away
+	freeList.WaitForPins(first);
+}
+
+// Submitters race for workers while the fences are reset under the readers' feet, mirroring WorkerQueue:
+// acquire, wait for pins, reset the fence, submit, and whoever sees the fence signaled hands the worker back
+// A reader touching a fence while its owner resets it, or two owners of one worker, fail the test
+TEST(WorkerFreeList, MockedFenceStress)
+{
+	constexpr uint32_t sWorkerCount = 4;
+	constexpr uint32_t sThreadCount = 8;
+	constexpr uint32_t sSubmissions = 5'000;
+
+	WorkerFreeList freeList;
+	freeList.Reset(sWorkerCount);
+
+	std::array<std::atomic<uint32_t>, sWorkerCount> owners{};
+	std::array<std::atomic<bool>, sWorkerCount> signaled{};
+	std::array<std::atomic<bool>, sWorkerCount> resetting{};
+
+	for (auto& fence : signaled)
+		fence = true;
+
+	std::atomic<bool> violated = false;
+	std::atomic<uint64_t> submitted = 0;
+
+	auto isSignaled = [&](vk::Fence fence)
+	{
+		uint32_t index = IndexOf(fence);
+
+		if (resetting[index].load())
+			violated = true;
+
+		return signaled[index].load();
+	};
+
+	std::vector<std::jthread> threads;
+
+	for (uint32_t t = 0; t < sThreadCount; t++)
+	{
+		threads.emplace_back([&]()
+		{
+			for (uint32_t k = 0; k < sSubmissions; k++)
+			{
+				uint32_t index = WorkerFreeList::sInvalidIndex;
+
+				while ((index = freeList.Acquire()) == WorkerFreeList::sInvalidIndex)
+				{
+					if (freeList.Reclaim(isSignaled) > 0)
+						continue;
+
+					std::vector<vk::Fence> fences;
+					std::vector<uint32_t> pinned;
+					freeList.CollectInFlightFences(fences, pinned);
+
+					for (auto fence : fences)
+						isSignaled(fence);
+
+					freeList.UnpinAll(pinned);
+					std::this_thread::yield();
+				}
+
+				if (owners[index].fetch_add(1) != 0)
+					violated = true;
+
+				freeList.WaitForPins(index);
+
+				// resetFences
+				resetting[index] = true;
+				signaled[index] = false;
+				resetting[index] = false;
+
+				owners[index].fetch_sub(1);
+				freeList.MarkInFlight(index, FenceOf(index));
+
+				// the GPU finishes right away
+				signaled[index] = true;
+				submitted++;
+			}
+		});
+	}
+
+	threads.clear();
+
+	CHECK(!violated.load());
+	CHECK_EQ(submitted.load(), uint64_t(sThreadCount) * sSubmissions);
+
+	freeList.Reclaim(isSignaled);
+
+	std::set<uint32_t> idle;
+	uint32_t index = WorkerFreeList::sInvalidIndex;
+
+	while ((index = freeList.Acquire()) != WorkerFreeList::sInvalidIndex)
+		idle.insert(index);
+
+	// nothing lost, nothing duplicated
+	CHECK_EQ(idle.size(), size_t(sWorkerCount));
+}
+
+// Time a submitter waits for a worker, with every submission keeping its worker busy for a while
+// Exclusive submitters spin until a fence signals, shared ones take the next worker round robin
+// once a reclaim finds nothing, the way Worker::SubmitRange does without ExclusiveSubmission
+BENCHMARK(WorkerFreeList, AcquireLatency)
+{
+	constexpr uint32_t sWorkerCount = 4;
+	constexpr uint32_t sSubmitterCount = 16;
+	constexpr uint32_t sSubmissions = 2'000;
+	constexpr std::chrono::nanoseconds sGpuTime = std::chrono::microseconds(20);
+
+	using Clock = std::chrono::steady_clock;
+
+	for (bool exclusive : { true, false })
+	{
+		WorkerFreeList freeList;
+		freeList.Reset(sWorkerCount);
+
+		// the mocked GPU signals a fence once the clock passes its retire time
+		std::array<std::atomic<int64_t>, sWorkerCount> retireTimes{};
+		std::atomic<uint32_t> nextWorker = 0;
+		std::atomic<uint64_t> sharedCount = 0;
+
+		auto isSignaled = [&retireTimes](vk::Fence fence)
+		{
+			return Clock::now().time_since_epoch().count() >= retireTimes[IndexOf(fence)].load();
+		};
+
+		std::vector<std::vector<double>> latencies(sSubmitterCount);
+		std::vector<std::jthread> threads;
+
+		for (uint32_t t = 0; t < sSubmitterCount; t++)
+		{
+			threads.emplace_back([&, t]()
+			{
+				latencies[t].reserve(sSubmissions);
+
+				for (uint32_t k = 0; k < sSubmissions; k++)
+				{
+					auto begin = Clock::now();
+
+					uint32_t index = freeList.Acquire();
+
+					if (index == WorkerFreeList::sInvalidIndex && freeList.Reclaim(isSignaled) != 0)
+						index = freeList.Acquire();
+
+					bool shared = index == WorkerFreeList::sInvalidIndex && !exclusive;
+
+					if (shared)
+						index = nextWorker.fetch_add(1) % sWorkerCount;
+
+					vkLib::Core::SpinBackoff backoff;
+
+					while (index == WorkerFreeList::sInvalidIndex)
+					{
+						if (freeList.Reclaim(isSignaled) == 0)
+						{
+							if (backoff.Exhausted())
+								std::this_thread::yield();
+							else
+								backoff.Pause();
+						}
+
+						index = freeList.Acquire();
+					}
+
+					latencies[t].push_back(std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+
+					// shared submissions queue up behind the work already on the worker, the free list isn't involved
+					if (shared)
+					{
+						sharedCount++;
+						continue;
+					}
+
+					freeList.WaitForPins(index);
+					retireTimes[index] = (Clock::now() + sGpuTime).time_since_epoch().count();
+					freeList.MarkInFlight(index, FenceOf(index));
+				}
+			});
+		}
+
+		threads.clear();
+
+		std::vector<double> all;
+
+		for (const auto& perThread : latencies)
+			all.insert(all.end(), perThread.begin(), perThread.end());
+
+		std::ranges::sort(all);
+
+		double mean = std::accumulate(all.begin(), all.end(), 0.0) / all.size();
+
+		std::cout << "\t" << (exclusive ? "exclusive" : "shared") << ", " << sSubmitterCount << " submitters on "
+			<< sWorkerCount << " workers: mean " << mean << " us, p50 " << all[all.size() / 2] << " us, p99 "
+			<< all[all.size() * 99 / 100] << " us, max " << all.back() << " us, "
+			<< sharedCount.load() << " round robin" << std::endl;
+	}
+}
@@ -0,0 +1,192 @@
+#pragma once
+#include "Config.h"
+
+VK_BEGIN
+VK_CORE_BEGIN
+
+// Drop in alternative to Core::Ref that keeps the payload, the reference count and
+// the deleter in a single allocation. The deleter's concrete type lives in the derived
+// block, the handle only sees a function pointer, so capturing lambdas cost no extra
+// allocation and no std::function
+template <typename T>
+class IntrusiveBlock
+{
+public:
+	using MyType = T;
+	using DestroyFn = void(*)(IntrusiveBlock*);
+	using DeleteObjectFn = void(*)(IntrusiveBlock*);
+
+public:
+	template <typename ...ARGS>
+	IntrusiveBlock(DestroyFn destroy, DeleteObjectFn deleteObject, ARGS&&... args)
+		: mDestroy(destroy), mDeleteObject(deleteObject), mHandle(std::forward<ARGS>(args)...) {}
+
+	// copies only need to keep the block alive, no ordering required
+	void Inc() { mRefCount.fetch_add(1, std::memory_order_relaxed); }
+
+	// returns true if the caller dropped the last reference
+	bool Dec()
+	{
+		if (mRefCount.fetch_sub(1, std::memory_order_release) != 1)
+			return false;
+
+		// make every write done through the other references visible to the deleter
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return true;
+	}
+
+	void DeleteObject() { mDeleteObject(this); }
+	void Destroy() { mDestroy(this); }
+
+	size_t GetCount() const { return mRefCount.load(std::memory_order_relaxed); }
+
+	T& GetHandle() { return mHandle; }
+	const T& GetHandle() const { return mHandle; }
+
+private:
+	std::atomic<uint32_t> mRefCount{ 1 };
+
+	DestroyFn mDestroy = nullptr;
+	DeleteObjectFn mDeleteObject = nullptr;
+
+	T mHandle;
+};
+
+template <typename T, typename Deleter>
+class IntrusiveBlockWithDeleter : public IntrusiveBlock<T>
+{
+public:
+	using MyBase = IntrusiveBlock<T>;
+
+public:
+	template <typename Fn, typename ...ARGS>
+	IntrusiveBlockWithDeleter(Fn&& deleter, ARGS&&... args)
+		: MyBase(&Destroy, &DeleteObject, std::forward<ARGS>(args)...),
+		mDeleter(std::forward<Fn>(deleter)) {}
+
+private:
+	[[no_unique_address]] Deleter mDeleter;
+
+private:
+	static void DeleteObject(MyBase* base)
+	{
+		auto* block = static_cast<IntrusiveBlockWithDeleter*>(base);
+		block->mDeleter(block->GetHandle());
+	}
+
+	static void Destroy(MyBase* base)
+	{
+		auto* block = static_cast<IntrusiveBlockWithDeleter*>(base);
+		block->mDeleter(block->GetHandle());
+		delete block;
+	}
+};
+
+template <typename T>
+class IntrusiveRef
+{
+public:
+	using MyBlock = IntrusiveBlock<T>;
+	using MyHandle = typename MyBlock::MyType;
+
+public:
+	IntrusiveRef() = default;
+
+	IntrusiveRef(const IntrusiveRef& Other)
+		: mBlock(Other.mBlock) { if (mBlock) mBlock->Inc(); }
+
+	IntrusiveRef(IntrusiveRef&& Other) noexcept
+		: mBlock(std::exchange(Other.mBlock, nullptr)) {}
+
+	IntrusiveRef& operator =(const IntrusiveRef& Other);
+	IntrusiveRef& operator =(IntrusiveRef&& Other) noexcept;
+
+	// Runs the deleter on the current payload and stores the new one in its place
+	// Every owner observes the change
+	void SetValue(const T& handle);
+
+	void Reset();
+
+	MyHandle* operator->() const { return &mBlock->GetHandle(); }
+
+	MyHandle& operator*() { return mBlock->GetHandle(); }
+	const MyHandle& operator*() const { return mBlock->GetHandle(); }
+
+	bool operator==(const IntrusiveRef& Other) const { return mBlock == Other.mBlock; }
+	bool operator!=(const IntrusiveRef& Other) const { return mBlock != Other.mBlock; }
+
+	explicit operator bool() const { return mBlock; }
+
+	size_t GetUseCount() const { return mBlock ? mBlock->GetCount() : 0; }
+
+	~IntrusiveRef() { Reset(); }
+
+private:
+	MyBlock* mBlock = nullptr;
+
+private:
+	// only accessible by [IntrusiveRef CreateIntrusiveRef(...)] function
+	explicit IntrusiveRef(MyBlock* block)
+		: mBlock(block) {}
+
+	template <typename Var, typename Fn, typename ...ARGS>
+	friend IntrusiveRef<Var> CreateIntrusiveRef(Fn&&, ARGS&&...);
+};
+
+// Same signature as Core::CreateRef, so call sites can switch over by name alone
+template <typename T, typename Fn, typename ...ARGS>
+IntrusiveRef<T> CreateIntrusiveRef(Fn&& deleter, ARGS&&... args)
+{
+	using BlockType = IntrusiveBlockWithDeleter<T, std::decay_t<Fn>>;
+
+	return IntrusiveRef<T>(new BlockType(std::forward<Fn>(deleter), std::forward<ARGS>(args)...));
+}
+
+template <typename T>
+void IntrusiveRef<T>::SetValue(const T& handle)
+{
+	// IntrusiveRef must already exist in order for this to work
+	_STL_ASSERT(mBlock, "Core::IntrusiveRef must already exist for IntrusiveRef::SetValue(const T&) to work!");
+
+	mBlock->DeleteObject();
+	mBlock->GetHandle() = handle;
+}
+
+template <typename T>
+void IntrusiveRef<T>::Reset()
+{
+	if (mBlock && mBlock->Dec())
+		mBlock->Destroy();
+
+	mBlock = nullptr;
+}
+
+template <typename T>
+IntrusiveRef<T>& IntrusiveRef<T>::operator=(const IntrusiveRef& Other)
+{
+	// increment first so self assignment can't drop the last reference
+	MyBlock* block = Other.mBlock;
+
+	if (block)
+		block->Inc();
+
+	Reset();
+	mBlock = block;
+
+	return *this;
+}
+
+template <typename T>
+IntrusiveRef<T>& IntrusiveRef<T>::operator=(IntrusiveRef&& Other) noexcept
+{
+	if (this != &Other)
+	{
+		Reset();
+		mBlock = std::exchange(Other.mBlock, nullptr);
+	}
+
+	return *this;
+}
+
+VK_CORE_END
+VK_END
@@ -0,0 +1,335 @@
+#pragma once
+#include "Config.h"
+#include "SpinLock.h"
+
+VK_BEGIN
+VK_CORE_BEGIN
+
+// Bounded multi producer multi consumer ring queue (Vyukov)
+// Every cell carries a sequence number telling which lap of the ring it's ready for,
+// producers and consumers only contend on their own position counter
+// The capacity is rounded up to the next power of two
+// Blocking operations spin with backoff before parking, the other side only pays for
+// the wake up when somebody is actually parked
+// Thread safe
+template <typename T>
+class MPMCQueue
+{
+public:
+	using MyType = T;
+
+public:
+	explicit MPMCQueue(size_t capacity)
+		: mMask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+		mCells(std::make_unique<Cell[]>(mMask + 1))
+	{
+		for (size_t i = 0; i <= mMask; i++)
+			mCells[i].Sequence.store(i, std::memory_order_relaxed);
+	}
+
+	// Not thread safe, destroys whatever is left in the queue
+	~MPMCQueue()
+	{
+		size_t end = mEnqueuePos.load(std::memory_order_relaxed);
+
+		for (size_t pos = mDequeuePos.load(std::memory_order_relaxed); pos != end; pos++)
+			mCells[pos & mMask].GetPtr()->~T();
+	}
+
+	MPMCQueue(const MPMCQueue&) = delete;
+	MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+	// Non blocking, returns false if the queue is full
+	template <typename U>
+	bool TryPush(U&& value);
+
+	// Non blocking, returns false if the queue is empty
+	bool TryPop(T& value);
+
+	// Blocks until there is room for the value
+	template <typename U>
+	void Push(U&& value);
+
+	// Blocks until a value is available
+	T Pop();
+
+	// Claims as many consecutive cells as are free, up to the range size, with a single CAS
+	// Returns how many elements were moved into the queue, never blocks
+	template <typename It>
+	size_t TryPushBatch(It first, It last);
+
+	// Pops up to maxCount elements into out with a single CAS, returns how many were popped
+	template <typename OutIt>
+	size_t TryPopBatch(OutIt out, size_t maxCount);
+
+	// Approximate under contention
+	size_t GetSize() const
+	{
+		size_t enqueued = mEnqueuePos.load(std::memory_order_relaxed);
+		size_t dequeued = mDequeuePos.load(std::memory_order_relaxed);
+
+		return enqueued >= dequeued ? enqueued - dequeued : 0;
+	}
+
+	size_t GetCapacity() const { return mMask + 1; }
+	bool IsEmpty() const { return GetSize() == 0; }
+
+private:
+	struct alignas(64) Cell
+	{
+		std::atomic<size_t> Sequence{ 0 };
+		alignas(T) std::byte Storage[sizeof(T)];
+
+		T* GetPtr() { return std::launder(reinterpret_cast<T*>(Storage)); }
+	};
+
+	// parking spot for one side of the queue, bumped by the other side
+	struct alignas(64) WaitPoint
+	{
+		std::atomic<uint32_t> Epoch{ 0 };
+		std::atomic<uint32_t> Waiters{ 0 };
+
+		void Notify()
+		{
+			// pairs with the fence in Park so either we see the waiter or it sees our cell
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			if (Waiters.load(std::memory_order_relaxed) == 0)
+				return;
+
+			Epoch.fetch_add(1, std::memory_order_release);
+			Epoch.notify_all();
+		}
+
+		template <typename Fn>
+		void Park(Fn&& TryAgain)
+		{
+			Waiters.fetch_add(1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			while (true)
+			{
+				uint32_t epoch = Epoch.load(std::memory_order_acquire);
+
+				if (TryAgain())
+					break;
+
+				Epoch.wait(epoch, std::memory_order_acquire);
+			}
+
+			Waiters.fetch_sub(1, std::memory_order_relaxed);
+		}
+	};
+
+	const size_t mMask;
+	std::unique_ptr<Cell[]> mCells;
+
+	alignas(64) std::atomic<size_t> mEnqueuePos{ 0 };
+	alignas(64) std::atomic<size_t> mDequeuePos{ 0 };
+
+	// producers park on mNotFull, consumers on mNotEmpty
+	WaitPoint mNotFull;
+	WaitPoint mNotEmpty;
+
+private:
+	static ptrdiff_t Distance(size_t lhs, size_t rhs) { return static_cast<ptrdiff_t>(lhs - rhs); }
+};
+
+template <typename T>
+template <typename U>
+bool MPMCQueue<T>::TryPush(U&& value)
+{
+	size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+	Cell* cell = nullptr;
+
+	while (true)
+	{
+		cell = &mCells[pos & mMask];
+		ptrdiff_t diff = Distance(cell->Sequence.load(std::memory_order_acquire), pos);
+
+		if (diff == 0)
+		{
+			if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+			return false; // the consumer of the previous lap hasn't freed the cell yet
+		else
+			pos = mEnqueuePos.load(std::memory_order_relaxed);
+	}
+
+	new (cell->Storage) T(std::forward<U>(value));
+	cell->Sequence.store(pos + 1, std::memory_order_release);
+
+	mNotEmpty.Notify();
+	return true;
+}
+
+template <typename T>
+bool MPMCQueue<T>::TryPop(T& value)
+{
+	size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+	Cell* cell = nullptr;
+
+	while (true)
+	{
+		cell = &mCells[pos & mMask];
+		ptrdiff_t diff = Distance(cell->Sequence.load(std::memory_order_acquire), pos + 1);
+
+		if (diff == 0)
+		{
+			if (mDequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+			return false; // nothing published at this position yet
+		else
+			pos = mDequeuePos.load(std::memory_order_relaxed);
+	}
+
+	T* ptr = cell->GetPtr();
+	value = std::move(*ptr);
+	ptr->~T();
+
+	// hand the cell to the producer of the next lap
+	cell->Sequence.store(pos + mMask + 1, std::memory_order_release);
+
+	mNotFull.Notify();
+	return true;
+}
+
+template <typename T>
+template <typename U>
+void MPMCQueue<T>::Push(U&& value)
+{
+	SpinBackoff backoff;
+
+	while (!backoff.Exhausted())
+	{
+		if (TryPush(std::forward<U>(value)))
+			return;
+
+		backoff.Pause();
+	}
+
+	mNotFull.Park([this, &value]() { return TryPush(std::forward<U>(value)); });
+}
+
+template <typename T>
+T MPMCQueue<T>::Pop()
+{
+	T value;
+	SpinBackoff backoff;
+
+	while (!backoff.Exhausted())
+	{
+		if (TryPop(value))
+			return value;
+
+		backoff.Pause();
+	}
+
+	mNotEmpty.Park([this, &value]() { return TryPop(value); });
+	return value;
+}
+
+template <typename T>
+template <typename It>
+size_t MPMCQueue<T>::TryPushBatch(It first, It last)
+{
+	size_t requested = static_cast<size_t>(std::distance(first, last));
+
+	if (requested == 0)
+		return 0;
+
+	size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+	size_t count = 0;
+
+	while (true)
+	{
+		// a cell ready for this lap can only be taken by whoever moves mEnqueuePos past it
+		count = 0;
+
+		while (count < requested && count <= mMask &&
+			Distance(mCells[(pos + count) & mMask].Sequence.load(std::memory_order_acquire), pos + count) == 0)
+			count++;
+
+		if (count == 0)
+		{
+			ptrdiff_t diff = Distance(mCells[pos & mMask].Sequence.load(std::memory_order_acquire), pos);
+
+			if (diff < 0)
+				return 0;
+
+			pos = mEnqueuePos.load(std::memory_order_relaxed);
+			continue;
+		}
+
+		if (mEnqueuePos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+			break;
+	}
+
+	for (size_t i = 0; i < count; i++, ++first)
+	{
+		Cell& cell = mCells[(pos + i) & mMask];
+
+		new (cell.Storage) T(std::move(*first));
+		cell.Sequence.store(pos + i + 1, std::memory_order_release);
+	}
+
+	mNotEmpty.Notify();
+	return count;
+}
+
+template <typename T>
+template <typename OutIt>
+size_t MPMCQueue<T>::TryPopBatch(OutIt out, size_t maxCount)
+{
+	if (maxCount == 0)
+		return 0;
+
+	size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+	size_t count = 0;
+
+	while (true)
+	{
+		// stops at the first cell a producer has claimed but not yet published
+		count = 0;
+
+		while (count < maxCount && count <= mMask &&
+			Distance(mCells[(pos + count) & mMask].Sequence.load(std::memory_order_acquire), pos + count + 1) == 0)
+			count++;
+
+		if (count == 0)
+		{
+			ptrdiff_t diff = Distance(mCells[pos & mMask].Sequence.load(std::memory_order_acquire), pos + 1);
+
+			if (diff < 0)
+				return 0;
+
+			pos = mDequeuePos.load(std::memory_order_relaxed);
+			continue;
+		}
+
+		if (mDequeuePos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+			break;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		Cell& cell = mCells[(pos + i) & mMask];
+		T* ptr = cell.GetPtr();
+
+		*out = std::move(*ptr);
+		++out;
+
+		ptr->~T();
+		cell.Sequence.store(pos + i + mMask + 1, std::memory_order_release);
+	}
+
+	mNotFull.Notify();
+	return count;
+}
+
+VK_CORE_END
+VK_END
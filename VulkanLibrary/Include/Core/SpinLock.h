@@ -1,14 +1,60 @@
 #pragma once
 #include "Config.h"
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define VK_CPU_RELAX() _mm_pause()
+#elif defined(_M_ARM64) || defined(_M_ARM)
+	#include <intrin.h>
+	#define VK_CPU_RELAX() __yield()
+#elif defined(__aarch64__) || defined(__arm__)
+	#define VK_CPU_RELAX() __asm__ __volatile__("yield")
+#else
+	#define VK_CPU_RELAX() std::this_thread::yield()
+#endif
+
 VK_BEGIN
+VK_CORE_BEGIN
 
-class SpinLock
+// Exponential backoff used by the spinning locks below
+// Tracks how many pause instructions have been burnt so the caller
+// can decide when to stop spinning and park the thread instead
+class SpinBackoff
 {
 public:
-	SpinLock()
-		: mSignal(false) {}
+	constexpr static uint32_t sMaxPauses = 64;
+	constexpr static uint32_t sSpinBudget = 1024;
+
+public:
+	SpinBackoff() = default;
+
+	void Pause()
+	{
+		for (uint32_t i = 0; i < mPauses; i++)
+			VK_CPU_RELAX();
+
+		mSpent += mPauses;
+		mPauses = std::min(mPauses << 1, sMaxPauses);
+	}
+
+	bool Exhausted() const { return mSpent >= sSpinBudget; }
+	void Reset() { mPauses = 1; mSpent = 0; }
+
+private:
+	uint32_t mPauses = 1;
+	uint32_t mSpent = 0;
+};
+
+VK_CORE_END
 
+// Test-and-test-and-set lock with exponential backoff
+// After the spin budget runs out, the thread parks on the lock word (futex on linux,
+// WaitOnAddress on windows) instead of burning the core
+// Not fair, use TicketLock if starvation is a concern
+class SpinLock
+{
+public:
+	SpinLock() = default;
 	~SpinLock() = default;
 
 	SpinLock(const SpinLock&) = delete;
@@ -16,25 +62,118 @@ public:
 
 	void lock()
 	{
-		while (true)
+		if (try_lock())
+			return;
+
+		Core::SpinBackoff backoff;
+
+		while (!backoff.Exhausted())
 		{
-			if (!try_lock()) return;
+			backoff.Pause();
 
-			for (volatile int i = 0; i < 4; i++)
-				_mm_pause();
+			// only attempt the RMW once the lock looks free to keep the cache line shared
+			if (mState.load(std::memory_order_relaxed) == eUnlocked && try_lock())
+				return;
+		}
 
-			while (!mSignal.load());
+		// Spin budget exhausted, mark the lock contended so unlock knows it has to wake someone
+		while (mState.exchange(eContended, std::memory_order_acquire) != eUnlocked)
+			mState.wait(eContended, std::memory_order_relaxed);
+	}
+
+	bool try_lock()
+	{
+		uint32_t expected = eUnlocked;
+		return mState.compare_exchange_strong(expected, eLocked,
+			std::memory_order_acquire, std::memory_order_relaxed);
+	}
+
+	void unlock()
+	{
+		if (mState.exchange(eUnlocked, std::memory_order_release) == eContended)
+			mState.notify_one();
+	}
+
+private:
+	enum State : uint32_t
+	{
+		eUnlocked       = 0,
+		eLocked         = 1,
+		eContended      = 2,
+	};
+
+	std::atomic<uint32_t> mState{ eUnlocked };
+};
+
+// FIFO ticket lock, threads acquire the lock in the order they arrived
+// Spins with backoff proportional to the queue distance, then parks on the serving counter
+// Strict hand-off order costs a context switch per acquisition once threads outnumber cores
+class TicketLock
+{
+public:
+	TicketLock() = default;
+	~TicketLock() = default;
+
+	TicketLock(const TicketLock&) = delete;
+	TicketLock& operator=(const TicketLock&) = delete;
+
+	void lock()
+	{
+		const uint32_t ticket = mNextTicket.fetch_add(1, std::memory_order_relaxed);
+
+		Core::SpinBackoff backoff;
+		uint32_t serving = mNowServing.load(std::memory_order_acquire);
+
+		while (serving != ticket)
+		{
+			if (backoff.Exhausted())
+			{
+				mWaiters.fetch_add(1, std::memory_order_seq_cst);
+
+				// seq_cst pairs with the waiter check in unlock so a wake up can't be missed
+				serving = mNowServing.load(std::memory_order_seq_cst);
+
+				while (serving != ticket)
+				{
+					mNowServing.wait(serving, std::memory_order_acquire);
+					serving = mNowServing.load(std::memory_order_acquire);
+				}
+
+				mWaiters.fetch_sub(1, std::memory_order_relaxed);
+				return;
+			}
+
+			// threads further back in the queue back off for longer
+			for (uint32_t i = serving; i != ticket; i++)
+				VK_CPU_RELAX();
+
+			backoff.Pause();
+			serving = mNowServing.load(std::memory_order_acquire);
 		}
+	}
+
+	bool try_lock()
+	{
+		uint32_t serving = mNowServing.load(std::memory_order_relaxed);
+		uint32_t expected = serving;
 
-		std::mutex mtx;
+		return mNextTicket.compare_exchange_strong(expected, serving + 1,
+			std::memory_order_acquire, std::memory_order_relaxed);
 	}
 
-	bool try_lock() { return mSignal.exchange(true); }
+	void unlock()
+	{
+		mNowServing.fetch_add(1, std::memory_order_seq_cst);
 
-	void unlock() { mSignal.store(false); }
+		// every waiter parks on the same word, only the next ticket holder will proceed
+		if (mWaiters.load(std::memory_order_seq_cst) != 0)
+			mNowServing.notify_all();
+	}
 
 private:
-	std::atomic_bool mSignal;
+	alignas(64) std::atomic<uint32_t> mNextTicket{ 0 };
+	alignas(64) std::atomic<uint32_t> mNowServing{ 0 };
+	std::atomic<uint32_t> mWaiters{ 0 };
 };
 
 VK_END
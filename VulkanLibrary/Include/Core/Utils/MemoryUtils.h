@@ -1,6 +1,7 @@
 #pragma once
 #include "../Config.h"
 #include "DeviceCreation.h"
+#include "../../Memory/DirtyRangeTracker.h"
 
 VK_BEGIN
 
@@ -29,8 +30,42 @@ struct ImageViewCreateInfo
 	}
 };
 
+// Category the memory of a resource is attributed to in the telemetry, e.g. "Wavefront"
+// Passed as a property to ResourcePool::CreateBuffer, overrides the pool's tag
+struct MemoryTag
+{
+	std::string Name;
+};
+
 VK_CORE_BEGIN
 
+class DeviceMemoryAllocator;
+class BufferRecycler;
+
+// Where a resource lives inside vk::DeviceMemory
+// Either a dedicated allocation or a sub range of a block owned by a DeviceMemoryAllocator
+struct MemoryAllocation
+{
+	vk::DeviceMemory Memory{};
+	vk::DeviceSize Offset = 0;
+	vk::DeviceSize Size = 0;
+
+	uint32_t MemoryTypeIndex = -1;
+
+	// bookkeeping of the sub allocator, left at -1 for dedicated allocations
+	uint32_t PoolIndex = -1;
+	uint32_t BlockIndex = -1;
+	uint32_t Node = -1;
+
+	// points at Offset inside a persistently mapped block, null otherwise
+	std::byte* MappedData = nullptr;
+
+	// telemetry tag id of the allocator the allocation came from
+	uint32_t Tag = 0;
+
+	bool IsDedicated() const { return BlockIndex == static_cast<uint32_t>(-1); }
+};
+
 // Buffer structs
 struct BufferConfig
 {
@@ -45,11 +80,20 @@ struct BufferConfig
 	vk::DeviceSize DeviceSize = 0;
 	vk::MemoryPropertyFlags MemProps = vk::MemoryPropertyFlagBits::eDeviceLocal;
 
+	// sub allocates the memory when set, dedicated allocation otherwise
+	std::shared_ptr<DeviceMemoryAllocator> Allocator;
+	// released buffers are parked and reused by later creations when set
+	std::shared_ptr<BufferRecycler> Recycler;
+
+	// telemetry category of the memory, see MemoryTag
+	std::string Tag;
+
 	void SetProperty(vk::BufferUsageFlags flags)
 	{ Usage = flags | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eTransferSrc; }
 
 	void SetProperty(size_t elemCount) { DeviceSize = elemCount; }
 	void SetProperty(vk::MemoryPropertyFlags flags) { MemProps = flags; }
+	void SetProperty(const MemoryTag& tag) { Tag = tag.Name; }
 };
 
 struct Buffer
@@ -61,6 +105,18 @@ struct Buffer
 	size_t BufferSize = 0;
 
 	BufferConfig Config{};
+
+	MemoryAllocation Allocation{};
+
+	// Set once the buffer is mapped for good, either the sub allocator's block mapping
+	// or a mapping of the dedicated memory that lives until the buffer is destroyed
+	std::byte* PersistentData = nullptr;
+
+	// writes through the persistent mapping waiting for a flush, only used for non coherent memory
+	DirtyRangeTracker DirtyRanges;
+
+	// size the handle was created with, Config.DeviceSize may already describe its replacement
+	vk::DeviceSize CreatedSize = 0;
 };
 
 struct BufferOwnershipTransferInfo
@@ -98,6 +154,11 @@ struct ImageConfig
 
 	vk::MemoryPropertyFlags MemProps = vk::MemoryPropertyFlagBits::eDeviceLocal;
 
+	// sub allocates the memory when set, dedicated allocation otherwise
+	std::shared_ptr<DeviceMemoryAllocator> Allocator;
+
+	// telemetry category of the memory, see MemoryTag
+	std::string Tag;
 };
 
 struct Image
@@ -113,6 +174,8 @@ struct Image
 
 	// Keeps track of the layout transitions during scoped operations
 	mutable ImageLayoutInfo RecordedLayout;
+
+	MemoryAllocation Allocation{};
 };
 
 struct ImageLayoutTransitionInfo
@@ -141,10 +204,38 @@ VKLIB_API uint32_t FindMemoryTypeIndex(vk::PhysicalDevice device,
 VKLIB_API vk::DeviceMemory AllocateMemory(const vk::MemoryRequirements& memReq, vk::MemoryPropertyFlags props,
 	vk::Device logicalDevice, vk::PhysicalDevice physicalDevice);
 
+// Goes through the allocator if there's one, dedicated vkAllocateMemory otherwise
+VKLIB_API MemoryAllocation AllocateMemory(const vk::MemoryRequirements& memReq, vk::MemoryPropertyFlags props,
+	vk::Device logicalDevice, vk::PhysicalDevice physicalDevice, DeviceMemoryAllocator* allocator, bool linear,
+	std::string_view tag = {});
+
+VKLIB_API void FreeMemory(vk::Device logicalDevice, const MemoryAllocation& allocation, DeviceMemoryAllocator* allocator);
+
 // Buffer functionality
 
 VKLIB_API Buffer CreateBuffer(BufferConfig& bufferInput);
 
+// Destroys the handle and hands the memory back to wherever it came from
+VKLIB_API void DestroyBuffer(vk::Device device, const Buffer& buffer);
+
+// Maps a range of the buffer, relative to the start of the buffer
+VKLIB_API void* MapBufferMemory(vk::Device device, const Buffer& buffer, vk::DeviceSize offset, vk::DeviceSize size);
+
+// Flushes the buffer if it isn't host coherent and unmaps it unless it lives in a persistently mapped block
+VKLIB_API void UnmapBufferMemory(vk::Device device, const Buffer& buffer);
+
+// Maps the whole buffer once, later calls hand out the same pointer
+VKLIB_API std::byte* MapBufferPersistent(vk::Device device, Buffer& buffer);
+
+// Records a write through the persistent mapping, no-op for host coherent memory
+VKLIB_API void MarkBufferDirty(Buffer& buffer, vk::DeviceSize offset, vk::DeviceSize size);
+
+// Hands every dirty range to the driver in a single vkFlushMappedMemoryRanges call
+VKLIB_API void FlushBufferRanges(vk::Device device, Buffer& buffer);
+
+// Discards the host's view of non coherent memory after the device wrote to it, no-op for host coherent memory
+VKLIB_API void InvalidateBufferMemory(vk::Device device, const Buffer& buffer);
+
 VKLIB_API void RecordBufferTransferBarrier(const BufferOwnershipTransferInfo& barrierInfo);
 
 VKLIB_API vk::AccessFlags GetAllBufferAccessFlags(vk::QueueFlagBits flag);
@@ -157,6 +248,9 @@ VKLIB_API void FillBufferAcquireMasks(BufferOwnershipTransferInfo& Info, vk::Que
 
 VKLIB_API Image CreateImage(ImageConfig& config);
 
+// Destroys the identity view, the image and hands the memory back
+VKLIB_API void DestroyImage(vk::Device device, const Image& image);
+
 VKLIB_API void RecordImageLayoutTransition(const ImageLayoutTransitionInfo& transitionInfo);
 VKLIB_API void RecordImageLayoutTransition(const ImageLayoutTransitionInfo& transitionInfo,
 	uint32_t srcQueueFamily, uint32_t dstQueueFamily);
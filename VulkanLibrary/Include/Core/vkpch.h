@@ -23,12 +23,14 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <shared_mutex>
 #include <future>
 #include <condition_variable>
 #include <latch>
 #include <barrier>
 #include <stop_token>
 #include <semaphore>
+#include <coroutine>
 
 // data structures
 #include <string>
@@ -50,6 +52,7 @@
 
 // algorithms
 #include <algorithm>
+#include <bit>
 #include <functional>
 #include <memory>
 #include <exception>
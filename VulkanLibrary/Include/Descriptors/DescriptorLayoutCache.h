@@ -0,0 +1,92 @@
+#pragma once
+#include "../Core/Config.h"
+#include "../Core/Ref.h"
+
+VK_BEGIN
+VK_CORE_BEGIN
+
+// Binding descriptions sorted by binding index, two layouts built from the same bindings
+// in a different order compare and hash equal
+struct DescriptorSetLayoutKey
+{
+	std::vector<vk::DescriptorSetLayoutBinding> Bindings;
+	// per binding, empty for bindings without immutable samplers
+	std::vector<std::vector<vk::Sampler>> ImmutableSamplers;
+
+	DescriptorSetLayoutKey() = default;
+	VKLIB_API explicit DescriptorSetLayoutKey(const std::vector<vk::DescriptorSetLayoutBinding>& bindings);
+
+	VKLIB_API bool operator ==(const DescriptorSetLayoutKey& Other) const;
+	VKLIB_API size_t GetHash() const;
+};
+
+// Set layouts in set order, push constant ranges sorted by offset
+struct PipelineLayoutKey
+{
+	std::vector<vk::DescriptorSetLayout> SetLayouts;
+	std::vector<vk::PushConstantRange> PushConstantRanges;
+
+	PipelineLayoutKey() = default;
+	VKLIB_API PipelineLayoutKey(const std::vector<vk::DescriptorSetLayout>& setLayouts,
+		const std::vector<vk::PushConstantRange>& pushConstantRanges);
+
+	VKLIB_API bool operator ==(const PipelineLayoutKey& Other) const;
+	VKLIB_API size_t GetHash() const;
+};
+
+struct LayoutCacheStats
+{
+	uint32_t SetLayoutsCreated = 0;
+	uint32_t SetLayoutHits = 0;
+
+	uint32_t PipelineLayoutsCreated = 0;
+	uint32_t PipelineLayoutHits = 0;
+};
+
+// Dedups descriptor set layouts and pipeline layouts across every pipeline of a context
+// The cache owns the handles it hands out, they live until the cache itself is destroyed,
+// so whoever keeps a handle around has to keep the cache alive as well
+// Thread safe
+class DescriptorLayoutCache
+{
+public:
+	VKLIB_API explicit DescriptorLayoutCache(Ref<vk::Device> device);
+	VKLIB_API ~DescriptorLayoutCache();
+
+	DescriptorLayoutCache(const DescriptorLayoutCache&) = delete;
+	DescriptorLayoutCache& operator=(const DescriptorLayoutCache&) = delete;
+
+	VKLIB_API vk::DescriptorSetLayout FetchSetLayout(const std::vector<vk::DescriptorSetLayoutBinding>& bindings);
+
+	VKLIB_API vk::PipelineLayout FetchPipelineLayout(const std::vector<vk::DescriptorSetLayout>& setLayouts,
+		const std::vector<vk::PushConstantRange>& pushConstantRanges);
+
+	VKLIB_API LayoutCacheStats GetStats() const;
+
+	VKLIB_API size_t GetSetLayoutCount() const;
+	VKLIB_API size_t GetPipelineLayoutCount() const;
+
+private:
+	template <typename Key>
+	struct KeyHasher
+	{
+		size_t operator ()(const Key& key) const { return key.GetHash(); }
+	};
+
+	Ref<vk::Device> mDevice;
+
+	std::unordered_map<DescriptorSetLayoutKey, vk::DescriptorSetLayout, KeyHasher<DescriptorSetLayoutKey>> mSetLayouts;
+	std::unordered_map<PipelineLayoutKey, vk::PipelineLayout, KeyHasher<PipelineLayoutKey>> mPipelineLayouts;
+
+	uint32_t mSetLayoutsCreated = 0;
+	uint32_t mPipelineLayoutsCreated = 0;
+
+	// hits are counted under the shared lock
+	std::atomic<uint32_t> mSetLayoutHits = 0;
+	std::atomic<uint32_t> mPipelineLayoutHits = 0;
+
+	mutable std::shared_mutex mLock;
+};
+
+VK_CORE_END
+VK_END
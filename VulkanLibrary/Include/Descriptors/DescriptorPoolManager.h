@@ -2,6 +2,7 @@
 #include "DescriptorsConfig.h"
 #include "DescriptorSetAllocator.h"
 #include "DescriptorPoolBuilder.h"
+#include "DescriptorLayoutCache.h"
 
 VK_BEGIN
 
@@ -19,9 +20,11 @@ public:
 		size_t batchSize = 100) const;
 
 	Core::DescriptorPoolBuilder GetBuilder() const { return mPoolBuilder; }
+	std::shared_ptr<Core::DescriptorLayoutCache> GetLayoutCache() const { return mLayoutCache; }
 
 private:
 	Core::DescriptorPoolBuilder mPoolBuilder;
+	std::shared_ptr<Core::DescriptorLayoutCache> mLayoutCache;
 
 	friend class Context;
 };
@@ -18,6 +18,82 @@ VKLIB_API bool operator !=(const DescriptorLocation& left, const DescriptorLocat
 VKLIB_API size_t CreateHash(const DescriptorLocation& location);
 VKLIB_API size_t ConvertIntoMapKey(const DescriptorLocation& location);
 
+// Accumulates descriptor writes and hands them to the driver in a single updateDescriptorSets call
+// Infos are stored by index so the write list is only resolved into pointers when it's flushed
+// A second write to the same (set, binding, array element) replaces the first one
+// Not thread safe
+class DescriptorWriteBatch
+{
+public:
+	DescriptorWriteBatch() = default;
+
+	VKLIB_API void Write(vk::DescriptorSet set, uint32_t binding, uint32_t arrayIndex,
+		vk::DescriptorType type, const vk::DescriptorBufferInfo& bufferInfo);
+	VKLIB_API void Write(vk::DescriptorSet set, uint32_t binding, uint32_t arrayIndex,
+		vk::DescriptorType type, const vk::DescriptorImageInfo& imageInfo);
+	VKLIB_API void Write(vk::DescriptorSet set, uint32_t binding, uint32_t arrayIndex,
+		vk::DescriptorType type, vk::BufferView texelBufferView);
+
+	// The returned writes point into the batch, they stay valid until the next Write, Flush or Clear
+	VKLIB_API const std::vector<vk::WriteDescriptorSet>& Resolve();
+
+	// Returns the number of writes handed to the driver, the batch is empty afterwards
+	VKLIB_API uint32_t Flush(vk::Device device);
+
+	VKLIB_API void Clear();
+
+	size_t GetWriteCount() const { return mPendingWrites.size(); }
+	bool IsEmpty() const { return mPendingWrites.empty(); }
+
+private:
+	enum class InfoType
+	{
+		eBuffer           = 0,
+		eImage            = 1,
+		eTexelBufferView  = 2,
+	};
+
+	struct PendingWrite
+	{
+		vk::DescriptorSet Set;
+		uint32_t Binding = 0;
+		uint32_t ArrayIndex = 0;
+		vk::DescriptorType Type = vk::DescriptorType::eStorageBuffer;
+
+		InfoType Info = InfoType::eBuffer;
+		uint32_t InfoIndex = 0;
+	};
+
+	struct WriteKey
+	{
+		vk::DescriptorSet Set;
+		uint32_t Binding = 0;
+		uint32_t ArrayIndex = 0;
+
+		bool operator ==(const WriteKey&) const = default;
+	};
+
+	struct WriteKeyHasher
+	{
+		size_t operator ()(const WriteKey& key) const;
+	};
+
+	std::vector<PendingWrite> mPendingWrites;
+	std::unordered_map<WriteKey, uint32_t, WriteKeyHasher> mWriteSlots;
+
+	std::vector<vk::DescriptorBufferInfo> mBufferInfos;
+	std::vector<vk::DescriptorImageInfo> mImageInfos;
+	std::vector<vk::BufferView> mTexelBufferViews;
+
+	std::vector<vk::WriteDescriptorSet> mResolvedWrites;
+
+private:
+	PendingWrite& FindOrInsert(vk::DescriptorSet set, uint32_t binding, uint32_t arrayIndex,
+		vk::DescriptorType type, InfoType info);
+};
+
+class DescriptorBatch;
+
 class DescriptorWriter 
 {
 public:
@@ -50,5 +126,44 @@ private:
 		: mDevice(device), mDescriptorSets(descriptorSets) {}
 
 	friend class PipelineBuilder;
+	friend class DescriptorBatch;
+
+	template <typename Info>
+	void Submit(const DescriptorLocation& location, vk::DescriptorType type, const Info& info) const;
+};
+
+// Caller owned batch, while it's alive every update the constructing thread issues through the writer
+// is queued here and handed to the driver in one call by Flush or the destructor
+// The writer itself holds no batch state, updates of other threads are applied right away
+// A batch nested in another one of the same writer queues into the outer one
+// Batches of a thread have to be destroyed in reverse order of construction
+class DescriptorBatch
+{
+public:
+	VKLIB_API explicit DescriptorBatch(const DescriptorWriter& writer);
+	VKLIB_API ~DescriptorBatch();
+
+	DescriptorBatch(const DescriptorBatch&) = delete;
+	DescriptorBatch& operator =(const DescriptorBatch&) = delete;
+
+	// Returns the number of writes handed to the driver, zero for nested batches
+	VKLIB_API uint32_t Flush();
+
+	size_t GetWriteCount() const { return mTarget->mWrites.GetWriteCount(); }
+
+private:
+	const DescriptorWriter& mWriter;
+	DescriptorWriteBatch mWrites;
+
+	// the batch collecting the writes, this one unless it's nested
+	DescriptorBatch* mTarget = this;
+	// the batch that was innermost on this thread before this one
+	DescriptorBatch* mPrevious = nullptr;
+
+	// the batch of the writer innermost on the calling thread, if any
+	static DescriptorBatch* FindActive(const DescriptorWriter& writer);
+
+	friend class DescriptorWriter;
 };
+
 VK_END
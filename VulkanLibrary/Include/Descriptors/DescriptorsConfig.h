@@ -12,6 +12,8 @@ struct DescriptorResource
 
 VK_CORE_BEGIN
 
+class DescriptorLayoutCache;
+
 struct DescriptorSetAllocatorInfo
 {
 	vk::DescriptorPoolCreateFlags Flags;
@@ -46,10 +48,13 @@ struct DescriptorSetAllocatorData
 
 	Core::Ref<vk::Device> Device;
 
+	// set layouts are fetched from here instead of being created per allocation when present
+	std::shared_ptr<DescriptorLayoutCache> LayoutCache;
+
 	DescriptorSetAllocatorData() = default;
 
 	DescriptorSetAllocatorData(const DescriptorSetAllocatorData& Other)
-		: PoolBuffer(Other.PoolBuffer), Info(Other.Info), Device(Other.Device) {}
+		: PoolBuffer(Other.PoolBuffer), Info(Other.Info), Device(Other.Device), LayoutCache(Other.LayoutCache) {}
 };
 
 struct DescriptorSetAllocatorDataDeleter
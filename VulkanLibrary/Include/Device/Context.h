@@ -6,6 +6,8 @@
 
 #include "../Process/WorkerQueue.h"
 #include "../Process/WorkingClass.h"
+#include "../Process/FenceReactor.h"
+#include "../Process/CommandRecycler.h"
 
 #include "ContextConfig.h"
 #include "Swapchain.h"
@@ -14,6 +16,7 @@
 
 #include "../Memory/RenderContextBuilder.h"
 #include "../Pipeline/PipelineBuilder.h"
+#include "../Pipeline/PipelineCacheStore.h"
 
 VK_BEGIN
 
@@ -40,15 +43,41 @@ public:
 	// Commands...
 	VKLIB_API CommandPools CreateCommandPools(bool IsTransient = false, bool IsProtected = false) const;
 
+	// Per thread, per frame pools of one family for recording every frame without locks or allocations
+	VKLIB_API std::shared_ptr<Core::CommandRecycler> CreateCommandRecycler(
+		uint32_t familyIndex, uint32_t framesInFlight) const;
+
+	// Resumes coroutines awaiting fences of this device, see RecordableResource::InvokeOneTimeProcessAsync
+	VKLIB_API std::shared_ptr<Core::FenceReactor> CreateFenceReactor(
+		std::chrono::nanoseconds pollInterval = std::chrono::microseconds(200)) const;
+
 	// Pipelines and RenderTargets...
 	VKLIB_API PipelineBuilder MakePipelineBuilder() const;
 
+	// Writes the pipeline cache shared by every builder to ContextCreateInfo::PipelineCachePath
+	// Also happens on its own once the last builder and the context are gone
+	VKLIB_API std::expected<size_t, Core::PipelineCacheError> SavePipelineCache() const;
+
+	std::shared_ptr<Core::PipelineCacheStore> GetPipelineCache() const { return mPipelineCache; }
+
 	// Vulkan RenderPass wrapped in VK_NAMESPACE::RenderContext
 	VKLIB_API RenderContextBuilder FetchRenderContextBuilder(vk::PipelineBindPoint bindPoint);
 
 	// Descriptors...
 	VKLIB_API DescriptorPoolManager FetchDescriptorPoolManager() const;
 
+	std::shared_ptr<Core::DescriptorLayoutCache> GetLayoutCache() const { return mLayoutCache; }
+
+	// caps and trimming of the buffers parked for reuse, see Core::BufferRecycler
+	// null unless ContextCreateInfo::RecycleBuffers was set
+	std::shared_ptr<Core::BufferRecycler> GetBufferRecycler() const { return mBufferRecycler; }
+
+	// per heap, per tag and peak usage of the memory allocated through the context
+	std::shared_ptr<Core::MemoryTelemetry> GetMemoryTelemetry() const { return mMemoryAllocator->GetTelemetry(); }
+
+	// pulls the heap budgets from VK_EXT_memory_budget if the device enabled it, heap sizes otherwise
+	VKLIB_API void UpdateMemoryBudget() const;
+
 	// Resources and memory...
 	VKLIB_API ResourcePool CreateResourcePool() const;
 
@@ -81,7 +110,20 @@ public:
 	VKLIB_API void InvalidateSwapchain(const SwapchainInvalidateInfo& newInfo);
 	VKLIB_API void CreateSwapchain(const SwapchainInfo& info);
 
-	void WaitIdle() const { mWorkingClass->WaitIdle(); }
+	void WaitIdle() const
+	{
+		if (!mBufferRecycler)
+		{
+			mWorkingClass->WaitIdle();
+			return;
+		}
+
+		// only the buffers released before the wait are known to be out of use after it
+		uint64_t releaseSerial = mBufferRecycler->GetReleaseSerial();
+
+		mWorkingClass->WaitIdle();
+		mBufferRecycler->MarkIdle(releaseSerial);
+	}
 
 	explicit operator bool() const { return static_cast<bool>(mHandle); }
 
@@ -94,6 +136,15 @@ private:
 
 	std::shared_ptr<ContextCreateInfo> mDeviceInfo;
 	std::shared_ptr<WorkingClass> mWorkingClass;
+
+	// every resource pool of the context sub allocates from here
+	std::shared_ptr<Core::DeviceMemoryAllocator> mMemoryAllocator;
+	// released buffers of every resource pool of the context
+	std::shared_ptr<Core::BufferRecycler> mBufferRecycler;
+	// set and pipeline layouts shared by every pipeline builder of the context
+	std::shared_ptr<Core::DescriptorLayoutCache> mLayoutCache;
+	// every pipeline builder compiles through this one
+	std::shared_ptr<Core::PipelineCacheStore> mPipelineCache;
 	// Swapchain Stuff
 	std::shared_ptr<Swapchain> mSwapchain;
 
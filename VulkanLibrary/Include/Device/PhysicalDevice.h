@@ -49,6 +49,18 @@ struct ContextCreateInfo
 
 	std::vector<const char*> Extensions;
 	std::vector<const char*> Layers;
+
+	// every submission waits for an idle queue of its family, they're shared round robin
+	// whenever all of them are busy otherwise
+	bool ExclusiveQueueSubmission = false;
+
+	// pipeline cache persisted across runs, empty keeps it in memory only
+	std::filesystem::path PipelineCachePath;
+
+	// parks released buffers for reuse instead of destroying them, see Core::BufferRecycler
+	// they're only handed out again once one time processes, InvokeProcess or the renderer's
+	// draw call retired them, keep it off if buffers are dropped while other queues may read them
+	bool RecycleBuffers = false;
 };
 
 VK_END
@@ -27,6 +27,15 @@ public:
 	T* MapMemory(size_t Count, size_t Offset = 0) const;
 	void UnmapMemory() const;
 
+	// Persistent mapping, the buffer is mapped once and stays mapped until it's destroyed or reallocated
+	// Spans cover the whole capacity and are invalidated by Reserve/Resize
+	std::span<T> GetMappedSpan() const;
+
+	// Writes through the span have to be marked for non coherent memory,
+	// FlushMappedRanges then hands them to the driver merged in a single call
+	void MarkDirty(size_t Count, size_t Offset = 0) const;
+	void FlushMappedRanges() const;
+
 	void InsertMemoryBarrier(vk::CommandBuffer commandBuffer, const MemoryBarrierInfo& pipelineBarrierInfo);
 
 	// TODO: Routine can be optimized further
@@ -200,25 +209,34 @@ void Buffer<T>::FetchMemory(Iter Begin, Iter End, size_t Offset)
 template<typename T>
 T* Buffer<T>::MapMemory(size_t Count, size_t Offset) const
 {
-	return (T*) mChunk.Device->mapMemory(mChunk.BufferHandles->Memory,
+	return (T*) Core::Utils::MapBufferMemory(*mChunk.Device, *mChunk.BufferHandles,
 		Offset * sizeof(T), Count * sizeof(T));
 }
 
 template<typename T>
 void Buffer<T>::UnmapMemory() const
 {
-	mChunk.Device->unmapMemory(mChunk.BufferHandles->Memory);
+	// Synchronizes manually in case the underlying memory isn't HostCoherent
+	Core::Utils::UnmapBufferMemory(*mChunk.Device, *mChunk.BufferHandles);
+}
 
-	if (mChunk.BufferHandles->Config.MemProps & vk::MemoryPropertyFlagBits::eHostCoherent)
-		return;
+template<typename T>
+std::span<T> Buffer<T>::GetMappedSpan() const
+{
+	std::byte* data = Core::Utils::MapBufferPersistent(*mChunk.Device, *mChunk.BufferHandles);
+	return { reinterpret_cast<T*>(data), GetCapacity() };
+}
 
-	// Synchronize manually in case the underlying memory isn't HostCoherent
-	vk::MappedMemoryRange range{};
-	range.setMemory(mChunk.BufferHandles->Memory);
-	range.setOffset(0);
-	range.setSize(mChunk.BufferHandles->BufferSize);
+template<typename T>
+void Buffer<T>::MarkDirty(size_t Count, size_t Offset) const
+{
+	Core::Utils::MarkBufferDirty(*mChunk.BufferHandles, Offset * sizeof(T), Count * sizeof(T));
+}
 
-	mChunk.Device->flushMappedMemoryRanges(range);
+template<typename T>
+void Buffer<T>::FlushMappedRanges() const
+{
+	Core::Utils::FlushBufferRanges(*mChunk.Device, *mChunk.BufferHandles);
 }
 
 template<typename T>
@@ -309,8 +327,14 @@ void Buffer<T>::ScaleCapacityWithoutLoss(size_t NewSize)
 	vk::BufferCopy CopyRegion{};
 	CopyRegion.setSize(mChunk.BufferHandles->BufferSize);
 
+	// pending writes through the persistent mapping have to land before the GPU copies them over
+	FlushMappedRanges();
 	CopyGPU(NewBuffer, *mChunk.BufferHandles, CopyRegion);
 
+	// stale host lines of non coherent memory would be flushed back over the copy otherwise
+	if (CopyRegion.size != 0)
+		Core::Utils::InvalidateBufferMemory(*mChunk.Device, NewBuffer);
+
 	auto Device = mChunk.Device;
 
 	NewBuffer.BufferSize = mChunk.BufferHandles->BufferSize;
@@ -470,8 +494,7 @@ Buffer<T> Buffer<T>::StageBuffer(size_t count)
 	buffer.mChunk.BufferHandles = Core::CreateRef<Core::Buffer>(
 		[device](Core::Buffer& buffer)
 	{
-		device->destroyBuffer(buffer.Handle);
-		device->freeMemory(buffer.Memory);
+		Core::Utils::DestroyBuffer(*device, buffer);
 	}, Core::Utils::CreateBuffer(hostConfig));
 
 	buffer.mChunk.Device = device;
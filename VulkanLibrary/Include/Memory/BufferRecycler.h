@@ -0,0 +1,155 @@
+#pragma once
+#include "../Core/Config.h"
+#include "../Core/Utils/MemoryUtils.h"
+#include "../Core/Ref.h"
+
+VK_BEGIN
+VK_CORE_BEGIN
+
+struct BufferRecyclerConfig
+{
+	// upper bound of the memory parked in the free lists, releases past it are destroyed
+	vk::DeviceSize MaxPooledSize = 256ull * 1024 * 1024;
+	uint32_t MaxBuffersPerClass = 16;
+
+	// requests are rounded up to a size class within these bounds, larger ones are never pooled
+	vk::DeviceSize MinSizeClass = 256;
+	vk::DeviceSize MaxSizeClass = 64ull * 1024 * 1024;
+};
+
+struct BufferRecyclerStats
+{
+	// Acquire served from a free list vs. fresh buffers
+	uint64_t Hits = 0;
+	uint64_t Misses = 0;
+
+	// Release parked the buffer vs. the caps turned it away
+	uint64_t Recycled = 0;
+	uint64_t Rejected = 0;
+
+	uint64_t Trimmed = 0;
+
+	vk::DeviceSize PooledSize = 0;
+	size_t PooledBuffers = 0;
+
+	// released buffers the GPU may still be reading, not handed out yet
+	vk::DeviceSize PendingSize = 0;
+	size_t PendingBuffers = 0;
+};
+
+// Free lists of released buffers keyed by (owner queue family, usage, memory properties, size class)
+// Core::Utils::CreateBuffer draws from here and Core::Utils::DestroyBuffer hands buffers back
+// whenever BufferConfig::Recycler is set, so growing a buffer reuses a previously dropped one
+// instead of going through vkCreateBuffer and the memory allocator again
+// A released buffer is only reused once the fences passed to the Retire following its release
+// have signaled, or after MarkIdle, until then it waits in the pending list
+// One time processes, RecordableResource::InvokeProcess and the renderer's draw call retire
+// with the fences of their submissions, see ContextCreateInfo::RecycleBuffers
+// Buffers keep their memory and mapping while parked, their contents are undefined on reuse
+// Thread safe
+class BufferRecycler
+{
+public:
+	// telemetry category of the parked buffers
+	constexpr static const char* sMemoryTag = "BufferRecycler";
+
+public:
+	VKLIB_API BufferRecycler(Ref<vk::Device> device, const BufferRecyclerConfig& config = {});
+	VKLIB_API ~BufferRecycler();
+
+	BufferRecycler(const BufferRecycler&) = delete;
+	BufferRecycler& operator=(const BufferRecycler&) = delete;
+
+	// the size a buffer of this many bytes is created with, sizes past MaxSizeClass are left as is
+	// classes step by a quarter of the power of two below the size, at most 25% is wasted
+	VKLIB_API vk::DeviceSize GetSizeClass(vk::DeviceSize size) const;
+
+	// a parked buffer matching config, config.DeviceSize has to be a size class already
+	VKLIB_API std::optional<Buffer> Acquire(const BufferConfig& config);
+
+	// false if the buffer can't be pooled, the caller destroys it then
+	// the buffer stays pending until the next Retire's fence signals
+	VKLIB_API bool Release(const Buffer& buffer);
+
+	// every buffer released since the last call waits on these fences before it's reused
+	// the fences must be signaled by the last submissions that may access them, they may be reset
+	// and reused once they have signaled, null fences are skipped and none at all parks them right away
+	VKLIB_API void Retire(vk::ArrayProxy<vk::Fence> fences);
+
+	// identifies the buffers released so far, see MarkIdle
+	VKLIB_API uint64_t GetReleaseSerial() const;
+
+	// the device went idle after serial was read, every buffer released before becomes reusable
+	VKLIB_API void MarkIdle(uint64_t serial);
+
+	// destroys parked buffers, the largest classes first, until at most maxPooledSize remains
+	VKLIB_API void Trim(vk::DeviceSize maxPooledSize = 0);
+
+	// the new caps apply to the buffers already parked as well
+	VKLIB_API void SetConfig(const BufferRecyclerConfig& config);
+	VKLIB_API BufferRecyclerConfig GetConfig() const;
+
+	VKLIB_API BufferRecyclerStats GetStats() const;
+
+private:
+	struct ClassKey
+	{
+		uint32_t Owner = 0;
+		vk::BufferUsageFlags Usage;
+		vk::MemoryPropertyFlags MemProps;
+		vk::DeviceSize Size = 0;
+
+		bool operator ==(const ClassKey&) const = default;
+	};
+
+	struct ClassKeyHasher
+	{
+		size_t operator()(const ClassKey& key) const;
+	};
+
+	Ref<vk::Device> mDevice;
+
+	std::unordered_map<ClassKey, std::vector<Buffer>, ClassKeyHasher> mFreeLists;
+
+	struct PendingBuffer
+	{
+		Buffer Handle;
+		uint64_t Serial = 0;
+	};
+
+	struct RetireBatch
+	{
+		std::vector<vk::Fence> Fences;
+		std::vector<PendingBuffer> Buffers;
+	};
+
+	// released since the last Retire
+	std::vector<PendingBuffer> mPending;
+	// waiting on the fence of their last submission
+	std::vector<RetireBatch> mInFlight;
+
+	uint64_t mReleaseSerial = 0;
+
+	BufferRecyclerConfig mConfig;
+	BufferRecyclerStats mStats;
+
+	mutable std::mutex mLock;
+
+private:
+	void TrimUnlocked(vk::DeviceSize maxPooledSize);
+	void Destroy(Buffer& buffer);
+
+	// moves the batches whose fence has signaled over to the free lists
+	void ReclaimUnlocked();
+	void Park(Buffer&& buffer);
+	void DestroyPending(Buffer& buffer);
+
+	// moves the buffer's memory over to another telemetry tag
+	static void Retag(Buffer& buffer, std::string_view tag);
+
+	static ClassKey MakeKey(const Buffer& buffer)
+	{ return { buffer.Config.ResourceOwner, buffer.Config.Usage, buffer.Config.MemProps, buffer.CreatedSize }; }
+};
+
+VK_CORE_END
+VK_END
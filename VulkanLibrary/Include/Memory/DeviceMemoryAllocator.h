@@ -0,0 +1,95 @@
+#pragma once
+#include "../Core/Config.h"
+#include "../Core/Ref.h"
+#include "../Core/Utils/MemoryUtils.h"
+#include "TLSFAllocator.h"
+#include "MemoryTelemetry.h"
+
+VK_BEGIN
+VK_CORE_BEGIN
+
+// Sub allocates buffers and images out of large vk::DeviceMemory blocks
+// One pool per (memory type, linear/optimal tiling) so buffers and optimal images never share a block
+// and bufferImageGranularity can't bite, every block is managed by a TLSFAllocator
+// Resources larger than half a block get a dedicated allocation
+// Host visible blocks stay mapped for their whole lifetime, a single vk::DeviceMemory can't be mapped twice
+// Thread safe
+class DeviceMemoryAllocator
+{
+public:
+	constexpr static vk::DeviceSize sDefaultBlockSize = 64ull * 1024 * 1024;
+
+public:
+	VKLIB_API DeviceMemoryAllocator(Ref<vk::Device> device, vk::PhysicalDevice physicalDevice,
+		vk::DeviceSize blockSize = sDefaultBlockSize);
+
+	VKLIB_API ~DeviceMemoryAllocator();
+
+	DeviceMemoryAllocator(const DeviceMemoryAllocator&) = delete;
+	DeviceMemoryAllocator& operator=(const DeviceMemoryAllocator&) = delete;
+
+	// linear: buffers and linearly tiled images, false for optimally tiled images
+	// tag attributes the allocation in the telemetry, empty counts as untagged
+	VKLIB_API MemoryAllocation Allocate(const vk::MemoryRequirements& memReq,
+		vk::MemoryPropertyFlags props, bool linear, std::string_view tag = {});
+
+	VKLIB_API void Free(const MemoryAllocation& allocation);
+
+	VKLIB_API size_t GetBlockCount() const;
+	VKLIB_API vk::DeviceSize GetReservedSize() const;
+	VKLIB_API vk::DeviceSize GetUsedSize() const;
+
+	uint32_t GetDedicatedAllocationCount() const { return mDedicatedCount.load(std::memory_order_relaxed); }
+
+	vk::DeviceSize GetBlockSize() const { return mBlockSize; }
+
+	// every allocation and block of this allocator is accounted here
+	std::shared_ptr<MemoryTelemetry> GetTelemetry() const { return mTelemetry; }
+
+private:
+	struct MemoryBlock
+	{
+		vk::DeviceMemory Memory{};
+		TLSFAllocator Bookkeeping;
+
+		std::byte* MappedData = nullptr;
+
+		uint32_t MemoryTypeIndex = -1;
+	};
+
+	struct MemoryPool
+	{
+		// indices into the vector are baked into the allocations, slots are nulled instead of erased
+		std::vector<std::unique_ptr<MemoryBlock>> Blocks;
+
+		uint32_t MemoryTypeIndex = -1;
+		vk::DeviceSize BlockSize = 0;
+	};
+
+	Ref<vk::Device> mDevice;
+	vk::PhysicalDevice mPhysicalDevice;
+
+	vk::PhysicalDeviceMemoryProperties mMemoryProps;
+	vk::DeviceSize mNonCoherentAtomSize = 1;
+	vk::DeviceSize mBlockSize = sDefaultBlockSize;
+
+	std::vector<MemoryPool> mPools;
+	std::atomic<uint32_t> mDedicatedCount = 0;
+
+	std::shared_ptr<MemoryTelemetry> mTelemetry;
+
+	mutable std::mutex mLock;
+
+private:
+	MemoryAllocation AllocateDedicated(vk::DeviceSize size, uint32_t memoryTypeIndex);
+	MemoryAllocation AllocateFromPool(MemoryPool& pool, uint32_t poolIndex, vk::DeviceSize size, vk::DeviceSize alignment);
+
+	MemoryBlock* CreateBlock(MemoryPool& pool, uint32_t& blockIndex);
+	void DestroyBlock(MemoryBlock& block);
+
+	bool IsHostVisible(uint32_t memoryTypeIndex) const;
+	bool IsHostCoherent(uint32_t memoryTypeIndex) const;
+};
+
+VK_CORE_END
+VK_END
@@ -0,0 +1,106 @@
+#pragma once
+#include "../Core/Config.h"
+
+VK_BEGIN
+VK_CORE_BEGIN
+
+// Collects the byte ranges written through a persistent mapping of non coherent memory
+// Ranges are widened to whole atoms and clamped to the limit, overlapping or touching ranges
+// are merged on insertion so a flush never hands the driver more ranges than necessary
+// Not thread safe
+class DirtyRangeTracker
+{
+public:
+	struct Range
+	{
+		uint64_t Begin = 0;
+		uint64_t End = 0;
+
+		uint64_t GetSize() const { return End - Begin; }
+
+		bool operator ==(const Range&) const = default;
+	};
+
+	// past this many disjoint ranges everything collapses into a single one
+	constexpr static size_t sMaxRanges = 32;
+
+public:
+	DirtyRangeTracker() = default;
+
+	DirtyRangeTracker(uint64_t atomSize, uint64_t limit)
+		: mAtomSize(std::max<uint64_t>(atomSize, 1)), mLimit(limit) {}
+
+	void Mark(uint64_t offset, uint64_t size)
+	{
+		if (size == 0 || offset >= mLimit)
+			return;
+
+		size = std::min(size, mLimit - offset);
+
+		Range range{};
+		range.Begin = offset / mAtomSize * mAtomSize;
+		range.End = offset + size;
+
+		// rounds up to the next atom without overflowing past the limit
+		uint64_t remainder = range.End % mAtomSize;
+
+		if (remainder != 0)
+			range.End = mLimit - range.End < mAtomSize - remainder ? mLimit : range.End + mAtomSize - remainder;
+
+		// first range that ends at or after the new one begins, touching ranges merge too
+		auto first = std::ranges::lower_bound(mRanges, range.Begin, {}, &Range::End);
+		auto last = first;
+
+		while (last != mRanges.end() && last->Begin <= range.End)
+		{
+			range.Begin = std::min(range.Begin, last->Begin);
+			range.End = std::max(range.End, last->End);
+			++last;
+		}
+
+		first = mRanges.erase(first, last);
+		mRanges.insert(first, range);
+
+		if (mRanges.size() > sMaxRanges)
+			mRanges = { Range{ mRanges.front().Begin, mRanges.back().End } };
+	}
+
+	void MarkAll() { mRanges = { Range{ 0, mLimit } }; }
+
+	void Clear() { mRanges.clear(); }
+
+	// the size changes when the memory behind the mapping is reallocated
+	void Reset(uint64_t atomSize, uint64_t limit)
+	{
+		mAtomSize = std::max<uint64_t>(atomSize, 1);
+		mLimit = limit;
+		mRanges.clear();
+	}
+
+	// sorted by offset, disjoint and never touching
+	const std::vector<Range>& GetRanges() const { return mRanges; }
+
+	uint64_t GetDirtySize() const
+	{
+		uint64_t size = 0;
+
+		for (const auto& range : mRanges)
+			size += range.GetSize();
+
+		return size;
+	}
+
+	bool IsEmpty() const { return mRanges.empty(); }
+
+	uint64_t GetAtomSize() const { return mAtomSize; }
+	uint64_t GetLimit() const { return mLimit; }
+
+private:
+	std::vector<Range> mRanges;
+
+	uint64_t mAtomSize = 1;
+	uint64_t mLimit = std::numeric_limits<uint64_t>::max();
+};
+
+VK_CORE_END
+VK_END
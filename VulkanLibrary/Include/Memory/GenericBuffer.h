@@ -35,6 +35,13 @@ public:
 	T* MapMemory(size_t Count, size_t Offset = 0) const;
 	VKLIB_API void UnmapMemory() const;
 
+	// Persistent mapping, see Buffer<T>::GetMappedSpan, offsets and counts here are in bytes
+	template <typename T>
+	std::span<T> GetMappedSpan() const;
+
+	VKLIB_API void MarkDirty(size_t Count, size_t Offset = 0) const;
+	VKLIB_API void FlushMappedRanges() const;
+
 	VKLIB_API void InsertMemoryBarrier(vk::CommandBuffer commandBuffer, const MemoryBarrierInfo& pipelineBarrierInfo);
 
 	// TODO: Routine can be further optimized
@@ -252,8 +259,15 @@ void Buffer<bool>::FetchMemory(Iter Begin, Iter End, size_t Offset /*= 0*/)
 template<typename T>
 T* Buffer<bool>::MapMemory(size_t Count, size_t Offset) const
 {
-	return (T*)mChunk.Device->mapMemory(mChunk.BufferHandles->Memory,
+	return (T*) Core::Utils::MapBufferMemory(*mChunk.Device, *mChunk.BufferHandles,
 		Offset * sizeof(T), Count * sizeof(T));
 }
 
+template<typename T>
+std::span<T> Buffer<bool>::GetMappedSpan() const
+{
+	std::byte* data = Core::Utils::MapBufferPersistent(*mChunk.Device, *mChunk.BufferHandles);
+	return { reinterpret_cast<T*>(data), GetCapacity() / sizeof(T) };
+}
+
 VK_END
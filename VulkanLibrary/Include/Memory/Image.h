@@ -22,6 +22,10 @@ public:
 	VKLIB_API void TransitionLayout(vk::ImageLayout newLayout,
 		vk::PipelineStageFlags usageStage = vk::PipelineStageFlagBits::eTopOfPipe) const;
 
+	// Doesn't block, the new layout is tracked as soon as the transition is submitted
+	VKLIB_API Core::AsyncProcess TransitionLayoutAsync(Core::FenceReactor& reactor, vk::ImageLayout newLayout,
+		vk::PipelineStageFlags usageStage = vk::PipelineStageFlagBits::eTopOfPipe) const;
+
 	/* -------------------- Scoped operations ---------------------- */
 
 	VKLIB_API virtual void BeginCommands(vk::CommandBuffer commandBuffer) const override;
@@ -0,0 +1,67 @@
+#pragma once
+#include "../Core/Config.h"
+
+VK_BEGIN
+VK_CORE_BEGIN
+
+// CPU side bookkeeping of a ring of bytes handed out linearly and released a frame at a time
+// Every allocation made between two EndFrame calls belongs to that frame, the frame is tagged
+// with a monotonically increasing value (a frame index, a fence slot, a timeline semaphore value)
+// and Reclaim releases all frames whose value the GPU has reached
+// An allocation never straddles the end of the ring, the tail is skipped instead
+// Not thread safe
+class LinearRingAllocator
+{
+public:
+	constexpr static uint64_t sInvalidOffset = std::numeric_limits<uint64_t>::max();
+
+public:
+	LinearRingAllocator() = default;
+	VKLIB_API explicit LinearRingAllocator(uint64_t capacity);
+
+	// alignment must be a power of two, returns sInvalidOffset if the live frames leave no room
+	VKLIB_API uint64_t Allocate(uint64_t size, uint64_t alignment = 1);
+
+	// closes the open frame, frameValue must not be smaller than the previous one
+	VKLIB_API void EndFrame(uint64_t frameValue);
+
+	// releases every closed frame tagged with a value <= completedValue
+	VKLIB_API void Reclaim(uint64_t completedValue);
+
+	uint64_t GetCapacity() const { return mCapacity; }
+	uint64_t GetUsedSize() const { return mUsed; }
+	uint64_t GetFreeSize() const { return mCapacity - mUsed; }
+
+	// bytes handed out (padding included) since the last EndFrame
+	uint64_t GetOpenFrameSize() const { return mOpenFrameSize; }
+	size_t GetPendingFrameCount() const { return mFrames.size(); }
+
+	// value of the oldest frame still waiting for the GPU, nothing to wait on if there's none
+	std::optional<uint64_t> GetOldestPendingFrame() const
+	{ return mFrames.empty() ? std::nullopt : std::optional<uint64_t>(mFrames.front().Value); }
+
+private:
+	struct Frame
+	{
+		uint64_t Value = 0;
+		uint64_t End = 0;
+		uint64_t Size = 0;
+	};
+
+	std::deque<Frame> mFrames;
+
+	uint64_t mCapacity = 0;
+	uint64_t mHead = 0;
+	uint64_t mTail = 0;
+	uint64_t mUsed = 0;
+
+	uint64_t mOpenFrameSize = 0;
+
+private:
+	static uint64_t AlignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+	uint64_t Commit(uint64_t offset, uint64_t size, uint64_t consumed);
+};
+
+VK_CORE_END
+VK_END
@@ -37,6 +37,9 @@ struct ImageCreateInfo
 	vk::Extent3D Extent = { 0, 0, 0 };
 	vk::ImageUsageFlags Usage = vk::ImageUsageFlagBits::eColorAttachment;
 	vk::MemoryPropertyFlags MemProps = vk::MemoryPropertyFlagBits::eDeviceLocal;
+
+	// telemetry category, the pool's tag is used if empty
+	std::string Tag;
 };
 
 struct ImageBlitInfo
@@ -0,0 +1,111 @@
+#pragma once
+#include "../Core/Config.h"
+
+VK_BEGIN
+VK_CORE_BEGIN
+
+struct MemoryUsage
+{
+	vk::DeviceSize Current = 0;
+	vk::DeviceSize Peak = 0;
+
+	uint64_t LiveAllocations = 0;
+	uint64_t TotalAllocations = 0;
+};
+
+struct HeapBudget
+{
+	vk::DeviceSize Size = 0;
+
+	// what the driver is willing to give the process and what the process uses right now
+	// the heap size and our own reservations unless VK_EXT_memory_budget reported them
+	vk::DeviceSize Budget = 0;
+	vk::DeviceSize Usage = 0;
+
+	bool FromExtension = false;
+	bool DeviceLocal = false;
+};
+
+// Accounting of device memory, fed by the DeviceMemoryAllocator
+// Resources are attributed to a heap and a tag (a caller provided category like "Wavefront"),
+// vk::DeviceMemory objects (blocks and dedicated allocations) to a heap only
+// The accounting itself never touches the device, events can be injected through the Record functions
+// Thread safe
+class MemoryTelemetry
+{
+public:
+	// tag 0, anything allocated without a tag
+	constexpr static const char* sUntagged = "Untagged";
+
+public:
+	// memoryTypeHeaps maps every memory type to the heap it lives in
+	VKLIB_API MemoryTelemetry(std::vector<uint32_t> memoryTypeHeaps, std::vector<HeapBudget> heaps);
+	VKLIB_API explicit MemoryTelemetry(const vk::PhysicalDeviceMemoryProperties& memoryProps);
+
+	// interns the tag, the same name always yields the same id
+	VKLIB_API uint32_t RegisterTag(std::string_view name);
+
+	// a resource bound to memory of the given type
+	VKLIB_API void RecordAllocation(uint32_t memoryTypeIndex, uint32_t tag, vk::DeviceSize size);
+	VKLIB_API void RecordFree(uint32_t memoryTypeIndex, uint32_t tag, vk::DeviceSize size);
+
+	// moves a live resource over to another tag, e.g. when a recycled buffer changes hands
+	VKLIB_API void RecordRetag(uint32_t memoryTypeIndex, uint32_t fromTag, uint32_t toTag, vk::DeviceSize size);
+
+	// a vk::DeviceMemory object of the given type
+	VKLIB_API void RecordReservation(uint32_t memoryTypeIndex, vk::DeviceSize size);
+	VKLIB_API void RecordRelease(uint32_t memoryTypeIndex, vk::DeviceSize size);
+
+	// heap sizes, budgets and usage, see QueryHeapBudgets
+	VKLIB_API void SetHeapBudgets(std::vector<HeapBudget> heaps);
+
+	// peaks restart from the current values
+	VKLIB_API void ResetPeaks();
+
+	VKLIB_API MemoryUsage GetTotalUsage() const;
+	VKLIB_API MemoryUsage GetHeapUsage(uint32_t heapIndex) const;
+	VKLIB_API MemoryUsage GetHeapReservation(uint32_t heapIndex) const;
+	VKLIB_API MemoryUsage GetTagUsage(std::string_view name) const;
+
+	VKLIB_API std::vector<std::pair<std::string, MemoryUsage>> GetTagUsages() const;
+	VKLIB_API std::vector<HeapBudget> GetHeapBudgets() const;
+
+	uint32_t GetHeapCount() const { return static_cast<uint32_t>(mHeaps.size()); }
+
+	// {"total", "heaps": [...], "tags": {...}}, sizes in bytes
+	VKLIB_API std::string DumpJson() const;
+
+	// VK_EXT_memory_budget has to be enabled on the device for budgetExtension
+	VKLIB_API static std::vector<HeapBudget> QueryHeapBudgets(vk::PhysicalDevice physicalDevice, bool budgetExtension);
+
+private:
+	struct HeapState
+	{
+		HeapBudget Budget;
+
+		MemoryUsage Resources;
+		MemoryUsage Reserved;
+	};
+
+	std::vector<uint32_t> mMemoryTypeHeaps;
+	std::vector<HeapState> mHeaps;
+
+	std::vector<std::string> mTagNames;
+	std::vector<MemoryUsage> mTagUsages;
+	std::unordered_map<std::string, uint32_t> mTagIDs;
+
+	MemoryUsage mTotal;
+
+	mutable std::mutex mLock;
+
+private:
+	uint32_t GetHeapIndex(uint32_t memoryTypeIndex) const;
+
+	static void Add(MemoryUsage& usage, vk::DeviceSize size);
+	static void Remove(MemoryUsage& usage, vk::DeviceSize size);
+	// the allocation changes hands, it isn't a new one
+	static void Move(MemoryUsage& from, MemoryUsage& to, vk::DeviceSize size);
+};
+
+VK_CORE_END
+VK_END
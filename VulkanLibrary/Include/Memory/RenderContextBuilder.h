@@ -58,6 +58,7 @@ public:
 		context.mWorkingClass = GetQueueManager();
 		context.mCommandPools = mCommandPools;
 		context.mAttachmentFlags = attachmentFlags;
+		context.mMemoryAllocator = mMemoryAllocator;
 
 		return context;
 	}
@@ -73,6 +74,8 @@ private:
 	WorkingClassRef mQueueManager;
 	CommandPools mCommandPools;
 
+	std::shared_ptr<Core::DeviceMemoryAllocator> mMemoryAllocator;
+
 	vk::PipelineBindPoint mBindPoint = vk::PipelineBindPoint::eGraphics;
 
 	friend class Context;
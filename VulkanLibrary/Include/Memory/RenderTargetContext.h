@@ -16,6 +16,10 @@ enum class FramebufferConstructError
 
 class RenderTargetContext
 {
+public:
+	// telemetry category of the attachments
+	constexpr static const char* sMemoryTag = "RenderTarget";
+
 public:
 	RenderTargetContext() = default;
 
@@ -57,6 +61,9 @@ private:
 
 	AttachmentTypeFlags mAttachmentFlags;
 
+	// attachments are sub allocated and show up in the telemetry under sMemoryTag
+	std::shared_ptr<Core::DeviceMemoryAllocator> mMemoryAllocator;
+
 	friend class RenderContextBuilder;
 	friend class Swapchain;
 
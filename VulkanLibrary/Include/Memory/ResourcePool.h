@@ -1,9 +1,13 @@
 #pragma once
 #include "MemoryConfig.h"
 #include "GenericBuffer.h"
+#include "TransientAllocator.h"
+#include "TransferUploader.h"
 #include "Image.h"
 #include "ImageView.h"
 #include "../Process/Commands.h"
+#include "DeviceMemoryAllocator.h"
+#include "BufferRecycler.h"
 
 VK_BEGIN
 
@@ -20,11 +24,22 @@ public:
 
 	VKLIB_API Image CreateImage(const ImageCreateInfo& info) const;
 
+	// Per frame ring of host visible memory usable as uniform, storage, vertex and index data
+	VKLIB_API TransientAllocator CreateTransientAllocator(vk::DeviceSize capacity) const;
+
+	// Batched staging uploads on the transfer family, see TransferUploader
+	VKLIB_API std::shared_ptr<TransferUploader> CreateTransferUploader(vk::DeviceSize stagingCapacity) const;
+
 	VKLIB_API Core::Ref<vk::Sampler> CreateSampler(const SamplerInfo& samplerInfo, SamplerCache cache = {}) const;
 
 	VKLIB_API SamplerCache CreateSamplerCache() const;
 
 	std::shared_ptr<const WorkingClass> GetWorkingClass() const { return mWorkingClass; }
+	std::shared_ptr<Core::BufferRecycler> GetBufferRecycler() const { return mBufferRecycler; }
+
+	// telemetry category of everything created through this pool from now on, a MemoryTag property overrides it
+	void SetMemoryTag(std::string_view tag) { mMemoryTag = tag; }
+	const std::string& GetMemoryTag() const { return mMemoryTag; }
 
 	explicit operator bool() const { return static_cast<bool>(mDevice); }
 
@@ -37,6 +52,14 @@ private:
 
 	std::shared_ptr<const WorkingClass> mWorkingClass;
 
+	// shared by every pool of the context, buffers and images are carved out of its blocks
+	std::shared_ptr<Core::DeviceMemoryAllocator> mMemoryAllocator;
+	// buffers dropped by Reserve/Resize and destruction wait here to be handed out again
+	// null unless the context was created with RecycleBuffers
+	std::shared_ptr<Core::BufferRecycler> mBufferRecycler;
+
+	std::string mMemoryTag;
+
 	friend class Context;
 };
 
@@ -54,6 +77,9 @@ VK_NAMESPACE::Buffer<T> VK_NAMESPACE::ResourcePool::CreateBuffer(Properties&&...
 	Config.DeviceSize = 0;
 	Config.LogicalDevice = *Device;
 	Config.PhysicalDevice = mPhysicalDevice.Handle;
+	Config.Allocator = mMemoryAllocator;
+	Config.Recycler = mBufferRecycler;
+	Config.Tag = mMemoryTag;
 	(Config.SetProperty(std::forward<Properties>(props)),...);
 
 	Config.DeviceSize *= Buffer<T>::sTypeSize; // correct scaling
@@ -62,10 +88,7 @@ VK_NAMESPACE::Buffer<T> VK_NAMESPACE::ResourcePool::CreateBuffer(Properties&&...
 	Chunk.BufferHandles = Core::CreateRef<Core::Buffer>([Device](Core::Buffer& buffer)
 	{
 		if (buffer.Handle)
-		{
-			Device->destroyBuffer(buffer.Handle);
-			Device->freeMemory(buffer.Memory);
-		}
+			Core::Utils::DestroyBuffer(*Device, buffer);
 	}, vkLib::Core::Buffer());
 
 	Chunk.Device = Device;
@@ -0,0 +1,103 @@
+#pragma once
+#include "../Core/Config.h"
+
+VK_BEGIN
+VK_CORE_BEGIN
+
+// CPU side bookkeeping of a two level segregated fit allocator over the range [0, size)
+// Doesn't touch any memory itself, the device allocator maps the offsets into vk::DeviceMemory blocks
+// Free ranges are bucketed by (power of two, linear subdivision) so both allocation and free are O(1),
+// neighbouring free ranges are coalesced on free
+// Not thread safe
+class TLSFAllocator
+{
+public:
+	using NodeHandle = uint32_t;
+	constexpr static NodeHandle sInvalidNode = std::numeric_limits<NodeHandle>::max();
+
+	struct Allocation
+	{
+		uint64_t Offset = 0;
+		uint64_t Size = 0;
+
+		NodeHandle Node = sInvalidNode;
+
+		explicit operator bool() const { return Node != sInvalidNode; }
+	};
+
+public:
+	TLSFAllocator() = default;
+	VKLIB_API explicit TLSFAllocator(uint64_t size);
+
+	// alignment must be a power of two, returns an empty allocation if nothing fits
+	VKLIB_API Allocation Allocate(uint64_t size, uint64_t alignment = 1);
+	VKLIB_API void Free(NodeHandle node);
+
+	uint64_t GetSize() const { return mSize; }
+	uint64_t GetFreeSize() const { return mFreeSize; }
+	uint64_t GetUsedSize() const { return mSize - mFreeSize; }
+	uint32_t GetAllocationCount() const { return mAllocationCount; }
+	bool IsEmpty() const { return mAllocationCount == 0; }
+
+	VKLIB_API uint64_t GetLargestFreeRange() const;
+	VKLIB_API uint32_t GetFreeRangeCount() const;
+
+	// Walks the whole physical chain and the free lists, checks every invariant
+	// Meant for debugging and tests, O(n)
+	VKLIB_API bool Validate() const;
+
+private:
+	constexpr static uint32_t sSecondLevelLog2 = 5;
+	constexpr static uint32_t sSecondLevelCount = 1u << sSecondLevelLog2;
+	constexpr static uint32_t sFirstLevelCount = 64 - sSecondLevelLog2 + 1;
+
+	// leftovers smaller than this stay inside the allocation instead of becoming free ranges
+	constexpr static uint64_t sMinSplitSize = 16;
+
+	struct Node
+	{
+		uint64_t Offset = 0;
+		uint64_t Size = 0;
+
+		NodeHandle PrevPhysical = sInvalidNode;
+		NodeHandle NextPhysical = sInvalidNode;
+
+		NodeHandle PrevFree = sInvalidNode;
+		NodeHandle NextFree = sInvalidNode;
+
+		bool Free = false;
+	};
+
+	std::vector<Node> mNodes;
+	std::vector<NodeHandle> mRecycledNodes;
+
+	NodeHandle mFirstNode = sInvalidNode;
+
+	uint64_t mFirstLevelBitmap = 0;
+	std::array<uint32_t, sFirstLevelCount> mSecondLevelBitmaps{};
+	std::array<std::array<NodeHandle, sSecondLevelCount>, sFirstLevelCount> mFreeHeads{};
+
+	uint64_t mSize = 0;
+	uint64_t mFreeSize = 0;
+	uint32_t mAllocationCount = 0;
+
+private:
+	static void Mapping(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+
+	// rounds the size up to the next bucket so any range found there is big enough
+	static uint64_t RoundUpToBucket(uint64_t size);
+
+	NodeHandle FindFreeNode(uint64_t size) const;
+	NodeHandle FindAlignedInBucket(uint64_t size, uint64_t alignment) const;
+
+	void InsertFree(NodeHandle node);
+	void RemoveFree(NodeHandle node);
+
+	NodeHandle CreateNode();
+	void RecycleNode(NodeHandle node);
+
+	static uint64_t AlignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+};
+
+VK_CORE_END
+VK_END
@@ -0,0 +1,141 @@
+#pragma once
+#include "GenericBuffer.h"
+#include "UploadBatcher.h"
+#include "../Process/Commands.h"
+#include "../Process/Worker.h"
+
+VK_BEGIN
+
+struct TransferUploaderStats
+{
+	uint64_t Requests = 0;
+	uint64_t Batches = 0;
+
+	// vk::BufferCopy regions recorded after neighbouring requests got merged
+	uint64_t Copies = 0;
+	uint64_t BytesUploaded = 0;
+
+	// batches that had to hand buffers over to and back from the transfer family
+	uint64_t OwnershipTransfers = 0;
+
+	// Upload found the staging ring full and waited on the GPU
+	uint64_t StagingStalls = 0;
+};
+
+// Uploads into device local buffers without stalling the caller
+// Bytes are copied into one persistently mapped staging ring, requests of many threads are batched
+// and go out together on the dedicated transfer family (the graphics family if there is none)
+// Every Upload returns the value of the batch it joined, a batch is done once GetCompletedValue reaches it
+// Destinations owned by another family are handed over to the transfer family for the copies and back
+// The destination has to outlive the upload and mustn't be used, reserved or resized until its batch is done
+// Thread safe
+class TransferUploader
+{
+public:
+	VKLIB_API ~TransferUploader();
+
+	TransferUploader(const TransferUploader&) = delete;
+	TransferUploader& operator=(const TransferUploader&) = delete;
+
+	// returns the batch value of the upload, zero if there was nothing to upload
+	// Blocks on the oldest batch in flight when the staging ring is full
+	VKLIB_API uint64_t Upload(const GenericBuffer& dst, std::span<const std::byte> data, vk::DeviceSize dstOffset = 0);
+
+	template <typename T>
+	uint64_t Upload(const Buffer<T>& dst, std::span<const T> values, size_t dstIndex = 0);
+
+	// submits the open batch, returns its value or the last submitted one if nothing was pending
+	VKLIB_API uint64_t Flush();
+
+	// retires the finished batches, every value up to the returned one is done
+	VKLIB_API uint64_t GetCompletedValue();
+
+	// flushes the batch of value if it's still open, false on timeout
+	VKLIB_API bool Wait(uint64_t value, std::chrono::nanoseconds timeOut = std::chrono::nanoseconds::max());
+
+	VKLIB_API void WaitIdle();
+
+	VKLIB_API uint64_t GetSubmittedValue() const;
+	VKLIB_API TransferUploaderStats GetStats() const;
+
+	// the open batch is flushed on its own once it holds this many bytes
+	void SetFlushThreshold(vk::DeviceSize threshold) { mFlushThreshold = threshold; }
+	vk::DeviceSize GetFlushThreshold() const { return mFlushThreshold; }
+
+	uint32_t GetTransferFamily() const { return mTransferFamily; }
+	vk::DeviceSize GetStagingCapacity() const { return mBatcher.GetCapacity(); }
+
+private:
+	struct UploadDestination
+	{
+		vk::Buffer Buffer;
+		uint32_t OwnerFamily = 0;
+
+		auto operator<=>(const UploadDestination&) const = default;
+	};
+
+	using Batcher = Core::BasicUploadBatcher<UploadDestination>;
+
+	struct BatchInFlight
+	{
+		uint64_t Value = 0;
+
+		// owner releases, the copies, owner acquires, the batch is done once all of them are
+		std::vector<std::pair<Core::Worker, vk::CommandBuffer>> Submissions;
+		std::vector<vk::Semaphore> Semaphores;
+	};
+
+	Core::Ref<vk::Device> mDevice;
+	std::shared_ptr<const WorkingClass> mWorkingClass;
+	CommandPools mCommandPools;
+
+	GenericBuffer mStaging;
+	std::byte* mMappedData = nullptr;
+
+	Batcher mBatcher;
+	uint32_t mTransferFamily = 0;
+
+	std::atomic<vk::DeviceSize> mFlushThreshold = 0;
+
+	std::deque<BatchInFlight> mInFlight;
+	uint64_t mSubmittedValue = 0;
+	uint64_t mCompletedValue = 0;
+
+	// idle workers per family, fetching new ones would create a fence every batch
+	std::map<uint32_t, std::vector<Core::Worker>> mIdleWorkers;
+
+	TransferUploaderStats mStats;
+
+	// serializes Flush and the retirement of batches, uploads only take the batcher's lock
+	mutable std::mutex mSubmitLock;
+	mutable std::mutex mStatsLock;
+
+	TransferUploader(Core::Ref<vk::Device> device, std::shared_ptr<const WorkingClass> workingClass,
+		CommandPools commandPools, GenericBuffer staging, uint32_t transferFamily);
+
+	friend class ResourcePool;
+
+private:
+	uint64_t FlushUnlocked();
+	uint64_t RetireUnlocked();
+
+	// waits on the oldest batch in flight, false if there's nothing left to wait on
+	bool RetireOldestBatchUnlocked(std::chrono::nanoseconds timeOut);
+
+	Core::Worker FetchWorker(uint32_t family);
+
+	// one barrier call handing every buffer of dsts from srcFamily over to dstFamily
+	// recordingFamily is the side the barrier is recorded on, it picks the release or the acquire half
+	void RecordOwnershipBarriers(vk::CommandBuffer cmdBuffer, const std::vector<UploadDestination>& dsts,
+		uint32_t srcFamily, uint32_t dstFamily, uint32_t recordingFamily) const;
+
+	void Recycle(BatchInFlight& batch);
+};
+
+template <typename T>
+uint64_t TransferUploader::Upload(const Buffer<T>& dst, std::span<const T> values, size_t dstIndex)
+{
+	return Upload(GenericBuffer(dst), std::as_bytes(values), dstIndex * sizeof(T));
+}
+
+VK_END
@@ -0,0 +1,106 @@
+#pragma once
+#include "GenericBuffer.h"
+#include "LinearRingAllocator.h"
+
+VK_BEGIN
+
+// Sub range of the transient ring, valid for the frame it was allocated in
+struct TransientAllocation
+{
+	vk::Buffer Buffer;
+	vk::DeviceSize Offset = 0;
+	vk::DeviceSize Size = 0;
+
+	// persistently mapped, write before the frame is submitted
+	std::byte* Data = nullptr;
+
+	template <typename T>
+	T* As() const { return reinterpret_cast<T*>(Data); }
+
+	explicit operator bool() const { return Data != nullptr; }
+};
+
+// Per frame upload memory for uniforms, per draw data and the likes
+// One large persistently mapped buffer is carved up linearly, every frame closed with EndFrame is
+// released as a whole once its fence signals, nothing is cleared, resized or remapped per frame
+// Typical frame: wait on the frame fence, BeginFrame, Allocate/Push, submit, EndFrame(fence)
+// Not thread safe
+class TransientAllocator
+{
+public:
+	TransientAllocator() = default;
+
+	// alignment of zero picks the device's uniform/storage buffer offset alignment, a size of zero yields an empty allocation
+	// Blocks on the oldest frame in flight when the ring is full, asserts if size can never fit
+	VKLIB_API TransientAllocation Allocate(vk::DeviceSize size, vk::DeviceSize alignment = 0);
+
+	template <typename T>
+	TransientAllocation Push(const T& value, vk::DeviceSize alignment = 0);
+
+	template <typename T>
+	TransientAllocation Push(std::span<const T> values, vk::DeviceSize alignment = 0);
+
+	// Releases every frame whose fence has signaled, call before the frame's fence is reset
+	VKLIB_API void BeginFrame();
+
+	// Closes the frame, the fence must be signaled by the last submission reading its data
+	VKLIB_API void EndFrame(vk::Fence fence);
+
+	vk::DeviceSize GetCapacity() const { return mRing.GetCapacity(); }
+	vk::DeviceSize GetUsedSize() const { return mRing.GetUsedSize(); }
+	size_t GetFramesInFlight() const { return mInFlight.size(); }
+
+	vk::DeviceSize GetDefaultAlignment() const { return mDefaultAlignment; }
+
+	GenericBuffer GetBuffer() const { return mBuffer; }
+
+	explicit operator bool() const { return static_cast<bool>(mBuffer); }
+
+private:
+	Core::Ref<vk::Device> mDevice;
+
+	GenericBuffer mBuffer;
+	std::byte* mMappedData = nullptr;
+
+	Core::LinearRingAllocator mRing;
+	vk::DeviceSize mDefaultAlignment = 1;
+
+	struct FrameInFlight
+	{
+		uint64_t Value = 0;
+		vk::Fence Fence;
+	};
+
+	std::deque<FrameInFlight> mInFlight;
+	uint64_t mFrameValue = 0;
+
+	TransientAllocator(Core::Ref<vk::Device> device, GenericBuffer buffer, vk::DeviceSize defaultAlignment);
+
+	friend class ResourcePool;
+
+private:
+	// waits on the oldest frame in flight, false if there's nothing left to wait on
+	bool RetireOldestFrame();
+};
+
+template <typename T>
+TransientAllocation TransientAllocator::Push(const T& value, vk::DeviceSize alignment)
+{
+	TransientAllocation allocation = Allocate(sizeof(T), alignment);
+	std::memcpy(allocation.Data, &value, sizeof(T));
+
+	return allocation;
+}
+
+template <typename T>
+TransientAllocation TransientAllocator::Push(std::span<const T> values, vk::DeviceSize alignment)
+{
+	TransientAllocation allocation = Allocate(values.size_bytes(), alignment);
+
+	if (allocation)
+		std::memcpy(allocation.Data, values.data(), values.size_bytes());
+
+	return allocation;
+}
+
+VK_END
@@ -0,0 +1,237 @@
+#pragma once
+#include "../Core/Config.h"
+#include "LinearRingAllocator.h"
+
+VK_BEGIN
+VK_CORE_BEGIN
+
+// CPU side of the staging uploads, packs copy requests of many threads into one staging ring
+// and hands them out in batches tagged with monotonically increasing values
+// Typical flow: Reserve, write the staging bytes, Commit, ..., Close, submit the batch, Retire once the GPU is done
+// Destination is anything ordered and comparable identifying the copy target (a vk::Buffer in practice),
+// the batcher never touches the device so it can be driven without one
+// Thread safe
+template <typename Destination>
+class BasicUploadBatcher
+{
+public:
+	struct Copy
+	{
+		Destination Dst{};
+
+		uint64_t SrcOffset = 0;
+		uint64_t DstOffset = 0;
+		uint64_t Size = 0;
+	};
+
+	struct Ticket
+	{
+		// where the caller writes its bytes inside the staging ring
+		uint64_t StagingOffset = 0;
+
+		// the batch the request belongs to
+		uint64_t Value = 0;
+	};
+
+	struct Batch
+	{
+		uint64_t Value = 0;
+
+		// sorted by destination and offset, neighbouring requests merged into one copy
+		std::vector<Copy> Copies;
+
+		size_t RequestCount = 0;
+		uint64_t StagingSize = 0;
+	};
+
+public:
+	explicit BasicUploadBatcher(uint64_t stagingCapacity, uint64_t alignment = 16)
+		: mRing(stagingCapacity), mAlignment(alignment) {}
+
+	BasicUploadBatcher(const BasicUploadBatcher&) = delete;
+	BasicUploadBatcher& operator=(const BasicUploadBatcher&) = delete;
+
+	// nullopt if the batches in flight leave no room, close and retire some and try again
+	std::optional<Ticket> Reserve(Destination dst, uint64_t dstOffset, uint64_t size)
+	{
+		std::scoped_lock locker(mLock);
+
+		uint64_t offset = mRing.Allocate(size, mAlignment);
+
+		if (offset == LinearRingAllocator::sInvalidOffset)
+			return std::nullopt;
+
+		mOpenCopies.push_back({ dst, offset, dstOffset, size });
+		mWriters[mOpenValue]++;
+
+		return Ticket{ offset, mOpenValue };
+	}
+
+	// the staging bytes of the ticket are written, its batch may be submitted
+	void Commit(const Ticket& ticket)
+	{
+		{
+			std::scoped_lock locker(mLock);
+
+			auto found = mWriters.find(ticket.Value);
+
+			_STL_ASSERT(found != mWriters.end() && found->second > 0, "UploadBatcher ticket committed twice");
+
+			if (--found->second != 0)
+				return;
+
+			mWriters.erase(found);
+		}
+
+		mWritersDone.notify_all();
+	}
+
+	// closes the open batch and waits for its writers, nullopt if nothing was requested
+	// requests made in the meantime already go into the next batch
+	std::optional<Batch> Close()
+	{
+		std::unique_lock locker(mLock);
+
+		if (mOpenCopies.empty())
+			return std::nullopt;
+
+		Batch batch{};
+		batch.Value = mOpenValue++;
+		batch.Copies = std::move(mOpenCopies);
+		batch.RequestCount = batch.Copies.size();
+		batch.StagingSize = mRing.GetOpenFrameSize();
+
+		mOpenCopies.clear();
+		mRing.EndFrame(batch.Value);
+
+		mWritersDone.wait(locker, [this, value = batch.Value]() { return !mWriters.contains(value); });
+
+		locker.unlock();
+
+		MergeCopies(batch.Copies);
+
+		return batch;
+	}
+
+	// releases the staging space of every batch up to and including completedValue
+	void Retire(uint64_t completedValue)
+	{
+		std::scoped_lock locker(mLock);
+
+		mRing.Reclaim(completedValue);
+		mRetiredValue = std::max(mRetiredValue, completedValue);
+	}
+
+	// the value the next request joins, every value below it has been closed
+	uint64_t GetOpenValue() const { std::scoped_lock locker(mLock); return mOpenValue; }
+	uint64_t GetRetiredValue() const { std::scoped_lock locker(mLock); return mRetiredValue; }
+
+	size_t GetOpenRequestCount() const { std::scoped_lock locker(mLock); return mOpenCopies.size(); }
+	uint64_t GetOpenSize() const { std::scoped_lock locker(mLock); return mRing.GetOpenFrameSize(); }
+	uint64_t GetUsedSize() const { std::scoped_lock locker(mLock); return mRing.GetUsedSize(); }
+
+	// closed batches whose staging space hasn't been retired yet
+	size_t GetPendingBatchCount() const { std::scoped_lock locker(mLock); return mRing.GetPendingFrameCount(); }
+
+	uint64_t GetCapacity() const { return mRing.GetCapacity(); }
+	uint64_t GetAlignment() const { return mAlignment; }
+
+	// copies come in request order, where destinations overlap the later request wins
+	// the result is sorted by destination and offset, free of overlaps and copies contiguous on
+	// both ends are folded into one
+	static void MergeCopies(std::vector<Copy>& copies)
+	{
+		std::vector<Copy> visible;
+		visible.reserve(copies.size());
+
+		// begin -> end of the bytes already claimed by later requests, per destination
+		std::map<Destination, std::map<uint64_t, uint64_t>> claimed;
+
+		for (auto copy = copies.rbegin(); copy != copies.rend(); ++copy)
+		{
+			auto& ranges = claimed[copy->Dst];
+
+			uint64_t begin = copy->DstOffset;
+			uint64_t end = begin + copy->Size;
+
+			// first claimed range that could touch [begin, end)
+			auto range = ranges.upper_bound(begin);
+
+			if (range != ranges.begin() && std::prev(range)->second >= begin)
+				--range;
+
+			uint64_t newBegin = begin;
+			uint64_t newEnd = end;
+			uint64_t cursor = begin;
+
+			// keep the gaps between the claimed ranges and fold the claimed ones into the new range
+			while (range != ranges.end() && range->first <= end)
+			{
+				if (range->first > cursor)
+					visible.push_back({ copy->Dst, copy->SrcOffset + cursor - begin, cursor, range->first - cursor });
+
+				cursor = std::max(cursor, range->second);
+
+				newBegin = std::min(newBegin, range->first);
+				newEnd = std::max(newEnd, range->second);
+
+				range = ranges.erase(range);
+			}
+
+			if (cursor < end)
+				visible.push_back({ copy->Dst, copy->SrcOffset + cursor - begin, cursor, end - cursor });
+
+			ranges.emplace(newBegin, newEnd);
+		}
+
+		std::ranges::sort(visible, [](const Copy& lhs, const Copy& rhs)
+		{
+			if (lhs.Dst != rhs.Dst)
+				return lhs.Dst < rhs.Dst;
+
+			return lhs.DstOffset < rhs.DstOffset;
+		});
+
+		copies.clear();
+
+		for (const auto& copy : visible)
+		{
+			if (!copies.empty())
+			{
+				Copy& prev = copies.back();
+
+				bool contiguous = prev.Dst == copy.Dst &&
+					prev.DstOffset + prev.Size == copy.DstOffset &&
+					prev.SrcOffset + prev.Size == copy.SrcOffset;
+
+				if (contiguous)
+				{
+					prev.Size += copy.Size;
+					continue;
+				}
+			}
+
+			copies.push_back(copy);
+		}
+	}
+
+private:
+	LinearRingAllocator mRing;
+	uint64_t mAlignment = 16;
+
+	std::vector<Copy> mOpenCopies;
+
+	// requests reserved but not yet committed, per batch value
+	std::unordered_map<uint64_t, uint32_t> mWriters;
+
+	uint64_t mOpenValue = 1;
+	uint64_t mRetiredValue = 0;
+
+	mutable std::mutex mLock;
+	std::condition_variable mWritersDone;
+};
+
+using UploadBatcher = BasicUploadBatcher<vk::Buffer>;
+
+VK_CORE_END
+VK_END
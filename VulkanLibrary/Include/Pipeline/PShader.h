@@ -7,6 +7,23 @@ VK_BEGIN
 using ShaderMap = std::unordered_map<std::string, ShaderInput>;
 using ShaderFiles = std::unordered_map<std::string, std::string>;
 
+// bools are stored as a VkBool32, the bits of every other value as they are
+struct SpecializationValue
+{
+	SpecializationType Type = SpecializationType::eUInt;
+	uint64_t Bits = 0;
+};
+
+// constant_id --> value
+using SpecializationMap = std::map<uint32_t, SpecializationValue>;
+
+// the map entries and the values of one stage, ready for a vk::SpecializationInfo
+struct SpecializationData
+{
+	std::vector<vk::SpecializationMapEntry> Entries;
+	std::vector<uint8_t> Data;
+};
+
 // Works as a state machine, so be careful when using it across multiple threads
 // todo: may create its own pipeline layout and descriptor sets
 // but then it will loss its independence from #VK_NAMESPACE::#Context
@@ -29,6 +46,10 @@ public:
 	void RemoveMacro(const std::string& macro)
 	{ mEnv.RemoveMacro(macro); }
 
+	// nullptr uses SPIRVCache::GetDefault()
+	void SetSPIRVCache(std::shared_ptr<SPIRVCache> cache)
+	{ mEnv.SetSPIRVCache(std::move(cache)); }
+
 	void Clear() { mShaders.clear(); }
 
 	// TODO: Implementing it only after adjusting that compiler method
@@ -55,6 +76,39 @@ public:
 	inline uint32_t GetCount(uint32_t setNo, uint32_t bindingNo) const;
 	inline std::vector<ShaderSPIR_V> GetShaderByteCodes() const;
 
+	// the files of the stages set through SetFilepath, what a hot reload has to watch
+	inline std::vector<std::filesystem::path> GetSourceFiles() const;
+
+	// Specialization constants are applied at pipeline creation, so one compiled module
+	// serves every value and changing them needs no recompilation
+	// A value goes to every stage declaring its constant_id, it outlives CompileShaders
+	template <typename T>
+	void SetSpecializationConstant(uint32_t constantID, T value)
+	{ mSpecializations[constantID] = MakeSpecializationValue(value); }
+
+	// by the name of the constant in the source, false if no compiled stage declares it
+	template <typename T>
+	bool SetSpecializationConstant(const std::string& name, T value);
+
+	void RemoveSpecializationConstant(uint32_t constantID) { mSpecializations.erase(constantID); }
+	void ClearSpecializationConstants() { mSpecializations.clear(); }
+
+	const SpecializationMap& GetSpecializationConstants() const { return mSpecializations; }
+
+	// the sizes of a compiled compute shader declared through local_size_*_id
+	// false and nothing set if a literal size would have to change
+	inline bool SetWorkGroupSize(const glm::uvec3& workGroupSize);
+
+	// the reflected size with the specialized components applied
+	inline glm::uvec3 GetWorkGroupSize() const;
+
+	// one message per value that no compiled stage declares, whose type doesn't match the
+	// declaration or that zeroes a work group size, the builder leaves the mismatched ones out
+	inline std::vector<std::string> ValidateSpecializations() const;
+
+	// the values declared by the compiled stage, nothing if it declares none
+	inline SpecializationData GetSpecializationData(vk::ShaderStageFlagBits stage) const;
+
 protected:
 	// The fields below is going to be set by the CompileShaders function...
 	DescSetLayoutBindingMap mPipelineSetLayoutInfo;
@@ -63,9 +117,16 @@ protected:
 
 	std::vector<CompileResult> mCompileResults;
 
+	// binding, type, count --> index into the set's bindings, merges the stages without rescanning them
+	using BindingKey = std::tuple<uint32_t, vk::DescriptorType, uint32_t>;
+	std::unordered_map<uint32_t, std::map<BindingKey, size_t>> mBindingLookup;
+
 	CompilerEnvironment mEnv;
 
 	glm::uvec3 mWorkGroupSize{};
+	glm::uvec3 mWorkGroupSizeIDs = glm::uvec3(ShaderMetaData::sNoConstantID);
+
+	SpecializationMap mSpecializations;
 
 	ShaderMap mShaders;
 
@@ -87,8 +148,14 @@ private:
 	inline void SavePushConstantRanges(const CompileResult& result);
 	inline void SaveShaderMetaData(CompileResult Result);
 
-	inline bool CheckIfSameBindings(const vk::DescriptorSetLayoutBinding& first,
-		const vk::DescriptorSetLayoutBinding& second) const;
+	template <typename T>
+	static constexpr SpecializationValue MakeSpecializationValue(T value);
+
+	// Vulkan wants the exact size, int and uint values may still stand in for each other
+	static constexpr bool IsCompatible(SpecializationType declared, SpecializationType value);
+
+	static constexpr uint32_t GetSpecializationSize(SpecializationType type);
+	static constexpr const char* GetSpecializationTypeName(SpecializationType type);
 };
 
 void PShader::SaveLayoutInfos(const CompileResult& result)
@@ -96,30 +163,29 @@ void PShader::SaveLayoutInfos(const CompileResult& result)
 	for (const auto& [SetIndex, Bindings] : result.SetLayoutBindingsMap)
 	{
 		auto& SetInfo = mPipelineSetLayoutInfo[SetIndex];
+		auto& SetLookup = mBindingLookup[SetIndex];
+
 		size_t SetInfoSize = SetInfo.size();
 
 		SetInfo.reserve(SetInfo.size() + Bindings.size());
 
 		for (const auto& Binding : Bindings)
 		{
-			bool Found = false;
+			// TODO: Trigger an assert or throw an exception if two bindings 
+			// have same binding and set index but difference name, types or data types!
+			BindingKey Key{ Binding.binding, Binding.descriptorType, Binding.descriptorCount };
 
-			std::for_each(SetInfo.begin(), SetInfo.begin() + SetInfoSize,
-				[this, &Binding, &Found, &result](vk::DescriptorSetLayoutBinding& current)
-			{
-				// TODO: Trigger an assert or throw an exception if two bindings 
-				// have same binding and set index but difference name, types or data types!
-				Found |= CheckIfSameBindings(current, Binding);
-				if (Found)
-					current.stageFlags |= result.MetaData.ShaderType;
-			});
-
-			if(!Found)
-				SetInfo.emplace_back(Binding);
-			else
+			auto Found = SetLookup.find(Key);
+
+			// only bindings of the earlier stages are shared with this one
+			if (Found != SetLookup.end() && Found->second < SetInfoSize)
 			{
-				// TODO:
+				SetInfo[Found->second].stageFlags |= result.MetaData.ShaderType;
+				continue;
 			}
+
+			SetLookup.try_emplace(Key, SetInfo.size());
+			SetInfo.emplace_back(Binding);
 		}
 	}
 }
@@ -155,7 +221,209 @@ std::vector<ShaderSPIR_V> PShader::GetShaderByteCodes() const
 inline void PShader::SaveShaderMetaData(CompileResult Result)
 {
 	if (Result.MetaData.ShaderType == vk::ShaderStageFlagBits::eCompute)
+	{
 		mWorkGroupSize = Result.MetaData.WorkGroupSize;
+		mWorkGroupSizeIDs = Result.MetaData.WorkGroupSizeIDs;
+	}
+}
+
+template <typename T>
+bool PShader::SetSpecializationConstant(const std::string& name, T value)
+{
+	bool found = false;
+
+	for (const auto& result : mCompileResults)
+	{
+		for (const auto& constant : result.MetaData.SpecConstants)
+		{
+			if (constant.Name != name)
+				continue;
+
+			mSpecializations[constant.ConstantID] = MakeSpecializationValue(value);
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+bool PShader::SetWorkGroupSize(const glm::uvec3& workGroupSize)
+{
+	if (mWorkGroupSize == glm::uvec3(0))
+		return false;
+
+	for (glm::length_t i = 0; i < 3; i++)
+	{
+		if (mWorkGroupSizeIDs[i] == ShaderMetaData::sNoConstantID && workGroupSize[i] != mWorkGroupSize[i])
+			return false;
+	}
+
+	for (glm::length_t i = 0; i < 3; i++)
+	{
+		if (mWorkGroupSizeIDs[i] != ShaderMetaData::sNoConstantID)
+			SetSpecializationConstant(mWorkGroupSizeIDs[i], workGroupSize[i]);
+	}
+
+	return true;
+}
+
+std::vector<std::filesystem::path> PShader::GetSourceFiles() const
+{
+	std::vector<std::filesystem::path> files;
+
+	for (const auto& [stage, input] : mShaders)
+	{
+		if (!input.FilePath.empty())
+			files.emplace_back(input.FilePath);
+	}
+
+	return files;
+}
+
+glm::uvec3 PShader::GetWorkGroupSize() const
+{
+	glm::uvec3 workGroupSize = mWorkGroupSize;
+
+	for (glm::length_t i = 0; i < 3; i++)
+	{
+		auto found = mSpecializations.find(mWorkGroupSizeIDs[i]);
+
+		if (mWorkGroupSizeIDs[i] != ShaderMetaData::sNoConstantID && found != mSpecializations.end() &&
+			IsCompatible(SpecializationType::eUInt, found->second.Type))
+			workGroupSize[i] = static_cast<uint32_t>(found->second.Bits);
+	}
+
+	return workGroupSize;
+}
+
+std::vector<std::string> PShader::ValidateSpecializations() const
+{
+	std::vector<std::string> messages;
+
+	for (const auto& [constantID, value] : mSpecializations)
+	{
+		bool declared = false;
+
+		for (const auto& result : mCompileResults)
+		{
+			for (const auto& constant : result.MetaData.SpecConstants)
+			{
+				if (constant.ConstantID != constantID)
+					continue;
+
+				declared = true;
+
+				if (IsCompatible(constant.Type, value.Type))
+					continue;
+
+				messages.push_back("constant_id " + std::to_string(constantID) + " (" +
+					(constant.Name.empty() ? "unnamed" : constant.Name) + ") is declared as " +
+					GetSpecializationTypeName(constant.Type) + " in the " + vk::to_string(result.MetaData.ShaderType) +
+					" stage but set as " + GetSpecializationTypeName(value.Type));
+			}
+		}
+
+		if (!declared)
+			messages.push_back("constant_id " + std::to_string(constantID) + " is set but no compiled stage declares it");
+	}
+
+	glm::uvec3 workGroupSize = GetWorkGroupSize();
+
+	for (glm::length_t i = 0; i < 3; i++)
+	{
+		if (mWorkGroupSizeIDs[i] != ShaderMetaData::sNoConstantID && workGroupSize[i] == 0)
+			messages.push_back(std::string("the work group size ") + "xyz"[i] + " (constant_id " +
+				std::to_string(mWorkGroupSizeIDs[i]) + ") is zero");
+	}
+
+	return messages;
+}
+
+SpecializationData PShader::GetSpecializationData(vk::ShaderStageFlagBits stage) const
+{
+	SpecializationData specialization;
+
+	if (mSpecializations.empty())
+		return specialization;
+
+	for (const auto& result : mCompileResults)
+	{
+		if (result.MetaData.ShaderType != stage)
+			continue;
+
+		for (const auto& constant : result.MetaData.SpecConstants)
+		{
+			auto found = mSpecializations.find(constant.ConstantID);
+
+			if (found == mSpecializations.end() || !IsCompatible(constant.Type, found->second.Type))
+				continue;
+
+			uint32_t size = GetSpecializationSize(constant.Type);
+			uint32_t offset = static_cast<uint32_t>(specialization.Data.size());
+
+			specialization.Entries.emplace_back(constant.ConstantID, offset, size);
+
+			// little endian, the low bytes hold the value of the 32 bit types
+			specialization.Data.resize(offset + size);
+			std::memcpy(specialization.Data.data() + offset, &found->second.Bits, size);
+		}
+	}
+
+	return specialization;
+}
+
+template <typename T>
+constexpr SpecializationValue PShader::MakeSpecializationValue(T value)
+{
+	if constexpr (std::is_same_v<T, bool>)
+		return { SpecializationType::eBool, value ? 1u : 0u };
+	else if constexpr (std::is_same_v<T, float>)
+		return { SpecializationType::eFloat, std::bit_cast<uint32_t>(value) };
+	else if constexpr (std::is_same_v<T, double>)
+		return { SpecializationType::eDouble, std::bit_cast<uint64_t>(value) };
+	else if constexpr (std::is_integral_v<T> && sizeof(T) <= sizeof(uint32_t))
+		return { std::is_signed_v<T> ? SpecializationType::eInt : SpecializationType::eUInt,
+			static_cast<uint32_t>(static_cast<std::conditional_t<std::is_signed_v<T>, int32_t, uint32_t>>(value)) };
+	else if constexpr (std::is_integral_v<T> && sizeof(T) == sizeof(uint64_t))
+		return { std::is_signed_v<T> ? SpecializationType::eInt64 : SpecializationType::eUInt64, static_cast<uint64_t>(value) };
+	else
+		static_assert(sizeof(T) == 0, "specialization constants are bools, 32 or 64 bit integers, floats or doubles");
+}
+
+constexpr bool PShader::IsCompatible(SpecializationType declared, SpecializationType value)
+{
+	auto isInteger = [](SpecializationType type)
+	{ return type != SpecializationType::eFloat && type != SpecializationType::eDouble; };
+
+	return GetSpecializationSize(declared) == GetSpecializationSize(value) && isInteger(declared) == isInteger(value);
+}
+
+constexpr uint32_t PShader::GetSpecializationSize(SpecializationType type)
+{
+	switch (type)
+	{
+		case SpecializationType::eInt64:
+		case SpecializationType::eUInt64:
+		case SpecializationType::eDouble:
+			return 8;
+		default:
+			return 4;
+	}
+}
+
+constexpr const char* PShader::GetSpecializationTypeName(SpecializationType type)
+{
+	switch (type)
+	{
+		case SpecializationType::eBool:         return "bool";
+		case SpecializationType::eInt:          return "int";
+		case SpecializationType::eUInt:         return "uint";
+		case SpecializationType::eFloat:        return "float";
+		case SpecializationType::eInt64:        return "int64_t";
+		case SpecializationType::eUInt64:       return "uint64_t";
+		case SpecializationType::eDouble:       return "double";
+		default:                                return "unknown";
+	}
 }
 
 std::vector<CompileError> PShader::CompileShaders()
@@ -163,6 +431,7 @@ std::vector<CompileError> PShader::CompileShaders()
 	ShaderCompiler compiler(mEnv);
 
 	mPipelineSetLayoutInfo.clear();
+	mBindingLookup.clear();
 	mPushConstantSubranges.clear();
 	mPushConstantRanges.clear();
 
@@ -172,9 +441,17 @@ std::vector<CompileError> PShader::CompileShaders()
 	std::vector<CompileError> Errors;
 	Errors.reserve(mShaders.size());
 
+	std::vector<ShaderInput> Inputs;
+	Inputs.reserve(mShaders.size());
+
 	for (const auto& [stage, shader] : mShaders)
+		Inputs.push_back(shader);
+
+	// the stages don't depend on each other, they're compiled side by side
+	auto Results = compiler.CompileBatch(Inputs);
+
+	for (auto& Result : Results)
 	{
-		auto Result = compiler.Compile(shader);
 		Errors.push_back(Result.Error);
 
 		// Retrieve the reflection results...
@@ -188,14 +465,6 @@ std::vector<CompileError> PShader::CompileShaders()
 	return Errors;
 }
 
-bool PShader::CheckIfSameBindings(const vk::DescriptorSetLayoutBinding& first, 
-	const vk::DescriptorSetLayoutBinding& second) const
-{
-	return first.binding == second.binding && 
-		first.descriptorCount == second.descriptorCount &&
-		first.descriptorType == second.descriptorType;
-}
-
 void PShader::SetShader(const std::string& stage, const std::string& shaderCode, 
 	vkLib::OptimizerFlag opt /*= vkLib::OptimizerFlag::eO3*/)
 {
@@ -48,14 +48,25 @@ private:
 	ResourcePool mResourcePool;
 	DescriptorPoolManager mDescPoolManager;
 
+	// pipeline layouts come from here when set, the cache keeps ownership of them
+	std::shared_ptr<Core::DescriptorLayoutCache> mLayoutCache;
+
 private:
 	friend class Context;
 
+	// the specializations of every stage, the stage infos point into them until the pipeline is created
+	struct StageSpecializations
+	{
+		std::vector<SpecializationData> Data;
+		std::vector<vk::SpecializationInfo> Infos;
+	};
+
 private:
 	// Helper methods...
 	inline vk::PipelineInputAssemblyStateCreateInfo GetAssemblyStateInfo(const GraphicsPipelineConfig& config) const;
 	inline vk::PipelineVertexInputStateCreateInfo GetVertexInputStateInfo(const GraphicsPipelineConfig& config) const;
-	inline std::vector<vk::PipelineShaderStageCreateInfo> GetPipelineStages(PipelineInfo& Info, const PShader& shader) const;
+	inline std::vector<vk::PipelineShaderStageCreateInfo> GetPipelineStages(PipelineInfo& Info, const PShader& shader,
+		StageSpecializations& specializations) const;
 	inline vk::PipelineRasterizationStateCreateInfo GetRasterizerStateInfo(const GraphicsPipelineConfig& config) const;
 	inline vk::PipelineDepthStencilStateCreateInfo GetDepthStencilStateInfo(const GraphicsPipelineConfig& config) const;
 	inline vk::PipelineMultisampleStateCreateInfo GetSampleStateInfo(const GraphicsPipelineConfig& config) const;
@@ -76,9 +87,10 @@ UComputePipeline VK_NAMESPACE::PipelineBuilder::BuildComputePipeline(Args&& ...a
 	const PShader& shader = pipeline.GetShader();
 
 	ComputePipelineHandles handles;
-	handles.WorkGroupSize = shader.mWorkGroupSize;
+	handles.WorkGroupSize = shader.GetWorkGroupSize();
 
-	std::vector<vk::PipelineShaderStageCreateInfo> pipelineStages = GetPipelineStages(handles, shader);
+	StageSpecializations specializations;
+	std::vector<vk::PipelineShaderStageCreateInfo> pipelineStages = GetPipelineStages(handles, shader, specializations);
 
 	auto layoutData = CreatePipelineLayout(shader);
 
@@ -99,11 +111,14 @@ UComputePipeline VK_NAMESPACE::PipelineBuilder::BuildComputePipeline(Args&& ...a
 	}
 
 	auto Data = mData;
+	auto LayoutCache = mLayoutCache;
 
-	pipeline.mHandles = Core::CreateRef<ComputePipelineHandles>([Data](ComputePipelineHandles& info)
+	pipeline.mHandles = Core::CreateRef<ComputePipelineHandles>([Data, LayoutCache](ComputePipelineHandles& info)
 	{
 		info.Device->destroyPipeline(info.Handle);
-		info.Device->destroyPipelineLayout(info.LayoutData.Layout);
+
+		if (!LayoutCache)
+			info.Device->destroyPipelineLayout(info.LayoutData.Layout);
 	}, handles);
 
 	// Init the Base Pipeline...
@@ -127,7 +142,8 @@ UGraphicsPipeline VK_NAMESPACE::PipelineBuilder::BuildGraphicsPipeline(Args&&...
 
 	vk::PipelineInputAssemblyStateCreateInfo assemblyInfo = GetAssemblyStateInfo(pConfig);
 	vk::PipelineVertexInputStateCreateInfo vertexInputInfo = GetVertexInputStateInfo(pConfig);
-	std::vector<vk::PipelineShaderStageCreateInfo> pipelineStages = GetPipelineStages(handles, pShader);
+	StageSpecializations specializations;
+	std::vector<vk::PipelineShaderStageCreateInfo> pipelineStages = GetPipelineStages(handles, pShader, specializations);
 	vk::PipelineRasterizationStateCreateInfo rasterizer = GetRasterizerStateInfo(pConfig);
 	vk::PipelineDepthStencilStateCreateInfo depthStencilState = GetDepthStencilStateInfo(pConfig);
 	vk::PipelineMultisampleStateCreateInfo sampleState = GetSampleStateInfo(pConfig);
@@ -170,11 +186,14 @@ UGraphicsPipeline VK_NAMESPACE::PipelineBuilder::BuildGraphicsPipeline(Args&&...
 	}
 
 	auto hData = mData;
+	auto LayoutCache = mLayoutCache;
 
-	pipeline.mHandles = Core::CreateRef<GraphicsPipelineHandles>([hData](GraphicsPipelineHandles& info)
+	pipeline.mHandles = Core::CreateRef<GraphicsPipelineHandles>([hData, LayoutCache](GraphicsPipelineHandles& info)
 	{ 
 		info.Device->destroyPipeline(info.Handle);
-		info.Device->destroyPipelineLayout(info.LayoutData.Layout);
+
+		if (!LayoutCache)
+			info.Device->destroyPipelineLayout(info.LayoutData.Layout);
 	}, handles);
 
 	// Init the Base Pipeline...
@@ -210,17 +229,35 @@ vk::PipelineVertexInputStateCreateInfo PipelineBuilder::GetVertexInputStateInfo(
 }
 
 std::vector <vk::PipelineShaderStageCreateInfo>
-	PipelineBuilder::GetPipelineStages(PipelineInfo& Info, const PShader& shader) const
+	PipelineBuilder::GetPipelineStages(PipelineInfo& Info, const PShader& shader,
+		StageSpecializations& specializations) const
 {
 	Info.ShaderStages = shader.GetShaderByteCodes();
 
 	std::vector<vk::PipelineShaderStageCreateInfo> result;
 	result.reserve(Info.ShaderStages.size());
 
+	// reserved up front, the stage infos keep pointers into both
+	specializations.Data.reserve(Info.ShaderStages.size());
+	specializations.Infos.reserve(Info.ShaderStages.size());
+
 	for (const auto& stage : Info.ShaderStages)
 	{
 		vk::ShaderModule Module = Core::Utils::CreateShaderModule(*mDevice, stage);
-		result.push_back({ {}, stage.Stage, Module, "main", nullptr, nullptr });
+		const vk::SpecializationInfo* Specialization = nullptr;
+
+		auto& StageData = specializations.Data.emplace_back(shader.GetSpecializationData(stage.Stage));
+
+		if (!StageData.Entries.empty())
+		{
+			auto& SpecInfo = specializations.Infos.emplace_back();
+			SpecInfo.setMapEntries(StageData.Entries);
+			SpecInfo.setData<uint8_t>(StageData.Data);
+
+			Specialization = &SpecInfo;
+		}
+
+		result.push_back({ {}, stage.Stage, Module, "main", Specialization, nullptr });
 	}
 
 	return result;
@@ -342,6 +379,9 @@ PipelineLayoutData PipelineBuilder::CreatePipelineLayout(const PShader& shader)
 		setLayouts[setInfo.first] = setResource->Layout;
 	}
 
+	if (mLayoutCache)
+		return { mLayoutCache->FetchPipelineLayout(setLayouts, pushConstantInfos), resources, pushConstantInfos };
+
 	vk::PipelineLayoutCreateInfo layoutInfo{};
 	layoutInfo.setSetLayouts(setLayouts);
 	layoutInfo.setPushConstantRanges(pushConstantInfos);
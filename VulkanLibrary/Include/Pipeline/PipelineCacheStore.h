@@ -0,0 +1,84 @@
+#pragma once
+#include "../Core/Config.h"
+#include "../Core/Ref.h"
+
+VK_BEGIN
+VK_CORE_BEGIN
+
+enum class PipelineCacheError
+{
+	eNone                     = 0,
+	eFileNotFound             = 1,
+	eTruncated                = 2,
+	eUnknownHeaderVersion     = 3,
+	eVendorMismatch           = 4,
+	eDeviceMismatch           = 5,
+	eUUIDMismatch             = 6,
+	eWriteFailed              = 7,
+};
+
+// Mirrors the VK_PIPELINE_CACHE_HEADER_VERSION_ONE header every driver puts in front of its blob
+struct PipelineCacheHeader
+{
+	uint32_t HeaderSize = 0;
+	uint32_t HeaderVersion = 0;
+	uint32_t VendorID = 0;
+	uint32_t DeviceID = 0;
+	std::array<uint8_t, VK_UUID_SIZE> CacheUUID{};
+};
+
+// Owns a vk::PipelineCache seeded from disk and writes it back out
+// A blob from another driver, device or driver version is dropped instead of handed to the driver
+// The file is replaced by writing a sibling temporary and renaming it over, a crash mid save
+// leaves the previous cache intact
+// Thread safe, vk::PipelineCache is internally synchronized
+class PipelineCacheStore
+{
+public:
+	// an empty path keeps the cache in memory only
+	VKLIB_API PipelineCacheStore(Ref<vk::Device> device, const vk::PhysicalDeviceProperties& props,
+		const std::filesystem::path& path = {});
+
+	// saves the cache before destroying it
+	VKLIB_API ~PipelineCacheStore();
+
+	PipelineCacheStore(const PipelineCacheStore&) = delete;
+	PipelineCacheStore& operator=(const PipelineCacheStore&) = delete;
+
+	// writes the current cache contents to the path given at construction
+	VKLIB_API std::expected<size_t, PipelineCacheError> Save() const;
+
+	// folds other caches into this one, they stay valid and owned by the caller
+	VKLIB_API void Merge(vk::ArrayProxy<const vk::PipelineCache> caches) const;
+
+	vk::PipelineCache GetHandle() const { return mHandle; }
+	const std::filesystem::path& GetPath() const { return mPath; }
+
+	// what happened to the blob on disk at construction, eNone if it seeded the cache
+	PipelineCacheError GetLoadResult() const { return mLoadResult; }
+	size_t GetLoadedSize() const { return mLoadedSize; }
+
+	// Blob and file handling, independent of any device
+	VKLIB_API static std::expected<PipelineCacheHeader, PipelineCacheError> ParseHeader(std::span<const uint8_t> blob);
+	VKLIB_API static PipelineCacheError ValidateBlob(std::span<const uint8_t> blob, const vk::PhysicalDeviceProperties& props);
+
+	VKLIB_API static std::expected<std::vector<uint8_t>, PipelineCacheError> ReadBlob(const std::filesystem::path& path);
+	VKLIB_API static std::expected<size_t, PipelineCacheError> WriteBlobAtomic(
+		const std::filesystem::path& path, std::span<const uint8_t> blob);
+
+private:
+	Ref<vk::Device> mDevice;
+	vk::PipelineCache mHandle;
+
+	std::filesystem::path mPath;
+	vk::PhysicalDeviceProperties mProps;
+
+	PipelineCacheError mLoadResult = PipelineCacheError::eNone;
+	size_t mLoadedSize = 0;
+
+	// serializes savers so two of them don't race on the temporary file
+	mutable std::mutex mSaveLock;
+};
+
+VK_CORE_END
+VK_END
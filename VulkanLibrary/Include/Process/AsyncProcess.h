@@ -0,0 +1,147 @@
+#pragma once
+#include "../Core/Config.h"
+
+VK_BEGIN
+VK_CORE_BEGIN
+
+// Coroutine handle returned by the asynchronous one time processes
+// The body starts running eagerly on the calling thread and resumes on the fence reactor
+// once the GPU work it awaits has finished
+// The handle can be co_awaited from another coroutine, blocked on through Wait() or
+// simply dropped, the coroutine frame outlives the handle in that case
+class AsyncProcess
+{
+public:
+	struct promise_type;
+	using HandleType = std::coroutine_handle<promise_type>;
+
+	struct promise_type
+	{
+		// eRunning, eCompleted or the address of the coroutine awaiting the process
+		std::atomic<uintptr_t> State{ eRunning };
+
+		// the frame is destroyed by whoever lets go of it last, the handle or the body itself
+		std::atomic<uint32_t> Owners{ 2 };
+
+		std::exception_ptr Exception;
+
+		AsyncProcess get_return_object() { return AsyncProcess(HandleType::from_promise(*this)); }
+
+		std::suspend_never initial_suspend() noexcept { return {}; }
+
+		struct FinalAwaiter
+		{
+			bool await_ready() const noexcept { return false; }
+			void await_resume() const noexcept {}
+
+			std::coroutine_handle<> await_suspend(HandleType handle) const noexcept
+			{
+				auto& promise = handle.promise();
+
+				uintptr_t continuation = promise.State.exchange(eCompleted, std::memory_order_acq_rel);
+				promise.State.notify_all();
+
+				// the frame may be gone past this point
+				if (promise.Owners.fetch_sub(1, std::memory_order_acq_rel) == 1)
+					handle.destroy();
+
+				if (continuation != eRunning)
+					return std::coroutine_handle<>::from_address(reinterpret_cast<void*>(continuation));
+
+				return std::noop_coroutine();
+			}
+		};
+
+		FinalAwaiter final_suspend() noexcept { return {}; }
+
+		void return_void() {}
+		void unhandled_exception() { Exception = std::current_exception(); }
+	};
+
+public:
+	AsyncProcess() = default;
+
+	AsyncProcess(const AsyncProcess&) = delete;
+	AsyncProcess& operator=(const AsyncProcess&) = delete;
+
+	AsyncProcess(AsyncProcess&& Other) noexcept
+		: mHandle(std::exchange(Other.mHandle, nullptr)) {}
+
+	AsyncProcess& operator=(AsyncProcess&& Other) noexcept
+	{
+		if (this != &Other)
+		{
+			Release();
+			mHandle = std::exchange(Other.mHandle, nullptr);
+		}
+
+		return *this;
+	}
+
+	~AsyncProcess() { Release(); }
+
+	bool IsDone() const
+	{ return !mHandle || mHandle.promise().State.load(std::memory_order_acquire) == eCompleted; }
+
+	// Blocks the calling thread until the process completes, rethrows anything the body threw
+	// Must not be called from the reactor thread
+	void Wait() const
+	{
+		if (!mHandle)
+			return;
+
+		auto& state = mHandle.promise().State;
+		uintptr_t current = state.load(std::memory_order_acquire);
+
+		while (current != eCompleted)
+		{
+			state.wait(current, std::memory_order_acquire);
+			current = state.load(std::memory_order_acquire);
+		}
+
+		Rethrow();
+	}
+
+	// Awaiting a process resumes the awaiting coroutine on the thread that completed it
+	bool await_ready() const noexcept { return IsDone(); }
+
+	bool await_suspend(std::coroutine_handle<> awaiter) const noexcept
+	{
+		uintptr_t expected = eRunning;
+
+		// fails only if the process completed in between, carry on without suspending
+		return mHandle.promise().State.compare_exchange_strong(expected,
+			reinterpret_cast<uintptr_t>(awaiter.address()), std::memory_order_acq_rel, std::memory_order_acquire);
+	}
+
+	void await_resume() const { Rethrow(); }
+
+	explicit operator bool() const { return static_cast<bool>(mHandle); }
+
+private:
+	constexpr static uintptr_t eRunning = 0;
+	constexpr static uintptr_t eCompleted = 1;
+
+	HandleType mHandle = nullptr;
+
+private:
+	explicit AsyncProcess(HandleType handle)
+		: mHandle(handle) {}
+
+	void Rethrow() const
+	{
+		if (mHandle && mHandle.promise().Exception)
+			std::rethrow_exception(mHandle.promise().Exception);
+	}
+
+	void Release()
+	{
+		if (mHandle && mHandle.promise().Owners.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			mHandle.destroy();
+
+		mHandle = nullptr;
+	}
+};
+
+VK_CORE_END
+VK_END
@@ -0,0 +1,401 @@
+#pragma once
+#include "../Core/Config.h"
+#include "../Core/Ref.h"
+
+VK_BEGIN
+VK_CORE_BEGIN
+
+// Command backends decide where the recycler's pools and buffers come from
+// A backend provides PoolType, BufferType, FenceType,
+// CreatePool(), ResetPool(PoolType), DestroyPool(PoolType), Allocate(PoolType, vk::CommandBufferLevel),
+// IsSignaled(FenceType) and Wait(FenceType)
+
+// vk::CommandPools of one queue family, reset as a whole, never per buffer
+struct DeviceCommandBackend
+{
+	using PoolType = vk::CommandPool;
+	using BufferType = vk::CommandBuffer;
+	using FenceType = vk::Fence;
+
+	Ref<vk::Device> Device;
+	uint32_t FamilyIndex = 0;
+
+	vk::CommandPool CreatePool() const
+	{
+		vk::CommandPoolCreateInfo createInfo{};
+		createInfo.setFlags(vk::CommandPoolCreateFlagBits::eTransient);
+		createInfo.setQueueFamilyIndex(FamilyIndex);
+
+		return Device->createCommandPool(createInfo);
+	}
+
+	// hands every buffer of the pool back to the initial state in one call
+	void ResetPool(vk::CommandPool pool) const { Device->resetCommandPool(pool); }
+	void DestroyPool(vk::CommandPool pool) const { Device->destroyCommandPool(pool); }
+
+	vk::CommandBuffer Allocate(vk::CommandPool pool, vk::CommandBufferLevel level) const
+	{
+		vk::CommandBufferAllocateInfo allocInfo{};
+		allocInfo.setCommandPool(pool);
+		allocInfo.setCommandBufferCount(1);
+		allocInfo.setLevel(level);
+
+		return Device->allocateCommandBuffers(allocInfo).front();
+	}
+
+	bool IsSignaled(vk::Fence fence) const
+	{ return Device->getFenceStatus(fence) == vk::Result::eSuccess; }
+
+	void Wait(vk::Fence fence) const
+	{
+		auto result = Device->waitForFences(fence, VK_TRUE, UINT64_MAX);
+		_STL_VERIFY(result == vk::Result::eSuccess, "CommandRecycler couldn't wait on a frame's fence");
+	}
+};
+
+// CPU only stand in for pools, buffers and fences, fences are signaled by hand
+// Counts what the recycler asked for so its state machine can be checked without a device
+class MockCommandBackend
+{
+public:
+	using PoolType = uint64_t;
+	using BufferType = uint64_t;
+	using FenceType = uint64_t;
+
+	struct Counters
+	{
+		uint64_t PoolsCreated = 0;
+		uint64_t PoolsDestroyed = 0;
+		uint64_t PoolResets = 0;
+		uint64_t BuffersAllocated = 0;
+	};
+
+public:
+	MockCommandBackend()
+		: mState(std::make_shared<State>()) {}
+
+	PoolType CreatePool() const
+	{
+		std::scoped_lock locker(mState->Lock);
+
+		mState->Stats.PoolsCreated++;
+		return mState->NextHandle++;
+	}
+
+	void ResetPool(PoolType) const
+	{
+		std::scoped_lock locker(mState->Lock);
+
+		mState->Stats.PoolResets++;
+	}
+
+	void DestroyPool(PoolType) const
+	{
+		std::scoped_lock locker(mState->Lock);
+
+		mState->Stats.PoolsDestroyed++;
+	}
+
+	BufferType Allocate(PoolType, vk::CommandBufferLevel) const
+	{
+		std::scoped_lock locker(mState->Lock);
+
+		mState->Stats.BuffersAllocated++;
+		return mState->NextHandle++;
+	}
+
+	FenceType CreateFence(bool signaled = false) const
+	{
+		std::scoped_lock locker(mState->Lock);
+
+		FenceType fence = mState->NextHandle++;
+		mState->Signaled[fence] = signaled;
+
+		return fence;
+	}
+
+	void Signal(FenceType fence) const
+	{
+		{
+			std::scoped_lock locker(mState->Lock);
+			mState->Signaled[fence] = true;
+		}
+
+		mState->Notifier.notify_all();
+	}
+
+	bool IsSignaled(FenceType fence) const
+	{
+		std::scoped_lock locker(mState->Lock);
+		return mState->Signaled[fence];
+	}
+
+	void Wait(FenceType fence) const
+	{
+		std::unique_lock locker(mState->Lock);
+		mState->Notifier.wait(locker, [this, fence]() { return mState->Signaled[fence]; });
+	}
+
+	Counters GetCounters() const
+	{
+		std::scoped_lock locker(mState->Lock);
+		return mState->Stats;
+	}
+
+private:
+	struct State
+	{
+		std::mutex Lock;
+		std::condition_variable Notifier;
+
+		std::unordered_map<FenceType, bool> Signaled;
+
+		uint64_t NextHandle = 1;
+		Counters Stats;
+	};
+
+	// copies of the backend share the same objects
+	std::shared_ptr<State> mState;
+};
+
+struct CommandRecyclerStats
+{
+	uint64_t Frames = 0;
+	uint64_t PoolResets = 0;
+
+	// Acquire served by a buffer of an earlier frame vs. a fresh allocation
+	uint64_t BuffersRecycled = 0;
+	uint64_t BuffersAllocated = 0;
+
+	// BeginFrame found the frame's fence unsignaled and blocked on it
+	uint64_t FenceWaits = 0;
+
+	size_t Threads = 0;
+};
+
+// Per thread, per frame command pools
+// Every recording thread owns one pool per frame in flight, so Acquire never contends with other threads
+// and never calls into the driver once the pools are warm. Buffers aren't freed, BeginFrame resets the
+// whole pool of the frame coming around again once its fence has signaled and hands its buffers out anew
+// Frame states: recording (BeginFrame) -> pending (EndFrame with a fence) -> reset on its next BeginFrame
+// Typical frame: BeginFrame, Acquire and record on any thread, submit, EndFrame(fence)
+// Acquire is thread safe, BeginFrame and EndFrame must not overlap with recording
+// Pools live as long as the recycler, record from long lived threads (a worker pool) rather than short lived ones
+template <typename Backend>
+class BasicCommandRecycler
+{
+public:
+	using PoolType = typename Backend::PoolType;
+	using BufferType = typename Backend::BufferType;
+	using FenceType = typename Backend::FenceType;
+
+public:
+	BasicCommandRecycler(Backend backend, uint32_t framesInFlight)
+		: mBackend(std::move(backend)), mFrameCount(std::max(framesInFlight, 1u)),
+		mID(sNextID.fetch_add(1, std::memory_order_relaxed)) {}
+
+	~BasicCommandRecycler()
+	{
+		for (auto& [id, thread] : mThreads)
+		{
+			for (auto& frame : thread->Frames)
+			{
+				if (frame.Pending)
+					mBackend.Wait(frame.Fence);
+
+				if (frame.Pool)
+					mBackend.DestroyPool(frame.Pool);
+			}
+		}
+	}
+
+	BasicCommandRecycler(const BasicCommandRecycler&) = delete;
+	BasicCommandRecycler& operator=(const BasicCommandRecycler&) = delete;
+
+	// a buffer of the calling thread's pool for the current frame, in the initial state
+	BufferType Acquire(vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary)
+	{
+		FrameSet& frame = FetchThread().Frames[mFrameIndex];
+
+		if (!frame.Pool)
+			frame.Pool = mBackend.CreatePool();
+
+		auto& cache = level == vk::CommandBufferLevel::ePrimary ? frame.Primaries : frame.Secondaries;
+
+		if (cache.Used < cache.Buffers.size())
+		{
+			frame.Recycled++;
+			return cache.Buffers[cache.Used++];
+		}
+
+		frame.Allocated++;
+
+		cache.Used++;
+		return cache.Buffers.emplace_back(mBackend.Allocate(frame.Pool, level));
+	}
+
+	// moves on to the next frame slot, blocks until the fence of its previous use signaled
+	void BeginFrame()
+	{
+		mFrameIndex = (mFrameIndex + 1) % mFrameCount;
+		mStats.Frames++;
+
+		std::shared_lock locker(mThreadsLock);
+
+		for (auto& [id, thread] : mThreads)
+		{
+			FrameSet& frame = thread->Frames[mFrameIndex];
+
+			mStats.BuffersRecycled += std::exchange(frame.Recycled, 0);
+			mStats.BuffersAllocated += std::exchange(frame.Allocated, 0);
+
+			if (frame.Pending)
+			{
+				if (!mBackend.IsSignaled(frame.Fence))
+				{
+					mStats.FenceWaits++;
+					mBackend.Wait(frame.Fence);
+				}
+
+				frame.Pending = false;
+			}
+
+			// untouched since its last reset, nothing to hand back
+			if (frame.Primaries.Used == 0 && frame.Secondaries.Used == 0)
+				continue;
+
+			mBackend.ResetPool(frame.Pool);
+			mStats.PoolResets++;
+
+			frame.Primaries.Used = 0;
+			frame.Secondaries.Used = 0;
+		}
+	}
+
+	// the buffers acquired this frame are in flight until fence signals
+	void EndFrame(FenceType fence)
+	{
+		std::shared_lock locker(mThreadsLock);
+
+		for (auto& [id, thread] : mThreads)
+		{
+			FrameSet& frame = thread->Frames[mFrameIndex];
+
+			if (frame.Primaries.Used == 0 && frame.Secondaries.Used == 0)
+				continue;
+
+			frame.Fence = fence;
+			frame.Pending = true;
+		}
+	}
+
+	uint32_t GetFrameIndex() const { return mFrameIndex; }
+	uint32_t GetFrameCount() const { return mFrameCount; }
+
+	// the counters of a frame are folded in once its slot comes around again
+	CommandRecyclerStats GetStats() const
+	{
+		std::shared_lock locker(mThreadsLock);
+
+		CommandRecyclerStats stats = mStats;
+		stats.Threads = mThreads.size();
+
+		return stats;
+	}
+
+	const Backend& GetBackend() const { return mBackend; }
+
+private:
+	struct BufferCache
+	{
+		std::vector<BufferType> Buffers;
+		size_t Used = 0;
+	};
+
+	struct FrameSet
+	{
+		PoolType Pool{};
+
+		BufferCache Primaries;
+		BufferCache Secondaries;
+
+		FenceType Fence{};
+		bool Pending = false;
+
+		uint64_t Recycled = 0;
+		uint64_t Allocated = 0;
+	};
+
+	struct ThreadSet
+	{
+		std::vector<FrameSet> Frames;
+	};
+
+	Backend mBackend;
+
+	const uint32_t mFrameCount = 1;
+	uint32_t mFrameIndex = 0;
+
+	// never reused, unlike the address, so a thread's cached set can't outlive its recycler unnoticed
+	const uint64_t mID = 0;
+	inline static std::atomic<uint64_t> sNextID = 1;
+
+	// only registration takes the lock exclusively, the thread sets never move once created
+	std::unordered_map<std::thread::id, std::unique_ptr<ThreadSet>> mThreads;
+	mutable std::shared_mutex mThreadsLock;
+
+	CommandRecyclerStats mStats;
+
+private:
+	ThreadSet& FetchThread()
+	{
+		// the recycler this thread acquired from last, the hot path doesn't touch the lock at all
+		struct CachedThreadSet
+		{
+			uint64_t RecyclerID = 0;
+			ThreadSet* Set = nullptr;
+		};
+
+		static thread_local CachedThreadSet sCached;
+
+		if (sCached.RecyclerID == mID)
+			return *sCached.Set;
+
+		auto id = std::this_thread::get_id();
+
+		ThreadSet* set = nullptr;
+
+		{
+			std::shared_lock locker(mThreadsLock);
+
+			auto found = mThreads.find(id);
+
+			if (found != mThreads.end())
+				set = found->second.get();
+		}
+
+		if (!set)
+		{
+			std::unique_lock locker(mThreadsLock);
+
+			auto& thread = mThreads[id];
+
+			if (!thread)
+			{
+				thread = std::make_unique<ThreadSet>();
+				thread->Frames.resize(mFrameCount);
+			}
+
+			set = thread.get();
+		}
+
+		sCached = { mID, set };
+		return *set;
+	}
+};
+
+using CommandRecycler = BasicCommandRecycler<DeviceCommandBackend>;
+using MockCommandRecycler = BasicCommandRecycler<MockCommandBackend>;
+
+VK_CORE_END
+VK_END
@@ -8,6 +8,10 @@ VK_BEGIN
 class CommandPools;
 class CommandBufferAllocator;
 
+VK_CORE_BEGIN
+class BufferRecycler;
+VK_CORE_END
+
 // keeps a reference to the cmd buf creator so 
 // you don't have to worry about manually freeing it up
 // be careful when using the command buffer outside of 
@@ -39,6 +43,13 @@ public:
 	VKLIB_API vk::CommandBuffer Allocate(vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary) const;
 	VKLIB_API void Free(vk::CommandBuffer CmdBuffer) const;
 
+	// Parks a primary buffer that finished executing for the next Allocate instead of freeing it
+	// The pools are created with eResetCommandBuffer, beginning it again resets it
+	VKLIB_API void Recycle(vk::CommandBuffer CmdBuffer) const;
+
+	// buffers released so far wait on the fence of a submission made right before, no-op without a recycler
+	VKLIB_API void RetireReleasedBuffers(vk::Fence fence) const;
+
 	VKLIB_API ExecutionUnit CreateExecUnit(vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary) const;
 	VKLIB_API std::vector<ExecutionUnit> CreateExecUnits(uint32_t count, vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary) const;
 
@@ -58,6 +69,9 @@ public:
 
 	explicit operator bool() const { return static_cast<bool>(mCommandPool); }
 
+	// upper bound of the buffers parked per pool, the rest is freed
+	constexpr static size_t sMaxRecycledBuffers = 8;
+
 private:
 	// Fields...
 	Core::Ref<Core::CommandPoolData> mCommandPool;
@@ -68,6 +82,8 @@ private:
 	Core::Ref<vk::Device> mDevice;
 	WorkingClassRef mWorkingClass;
 
+	std::shared_ptr<Core::BufferRecycler> mBufferRecycler;
+
 private:
 	// Debug...
 #if _DEBUG
@@ -115,8 +131,11 @@ private:
 	Core::Ref<vk::Device> mDevice;
 	WorkingClassRef mWorkingClass;
 
+	std::shared_ptr<Core::BufferRecycler> mBufferRecycler;
+
 private:
-	CommandPools(Core::Ref<vk::Device> device, const Core::QueueFamilyIndices& indices, vk::CommandPoolCreateFlags flags, WorkingClassRef workingClass);
+	CommandPools(Core::Ref<vk::Device> device, const Core::QueueFamilyIndices& indices, vk::CommandPoolCreateFlags flags,
+		WorkingClassRef workingClass, std::shared_ptr<Core::BufferRecycler> bufferRecycler);
 
 	Core::Ref<Core::CommandPoolData> CreateCommandPool(uint32_t index);
 
@@ -0,0 +1,237 @@
+#pragma once
+#include "../Core/Config.h"
+#include "../Core/Ref.h"
+
+VK_BEGIN
+VK_CORE_BEGIN
+
+// Fence backends decide how the reactor observes completion
+// A backend provides FenceType, IsSignaled(FenceType) and WaitAny(span<FenceType>, timeOut)
+
+// Polls real vk::Fence objects of a device
+struct DeviceFenceBackend
+{
+	using FenceType = vk::Fence;
+
+	Ref<vk::Device> Device;
+
+	bool IsSignaled(vk::Fence fence) const
+	{ return Device->getFenceStatus(fence) == vk::Result::eSuccess; }
+
+	// parks the reactor inside the driver instead of sleeping for a fixed interval
+	void WaitAny(std::span<const vk::Fence> fences, std::chrono::nanoseconds timeOut) const
+	{
+		auto result = Device->waitForFences(static_cast<uint32_t>(fences.size()),
+			fences.data(), VK_FALSE, timeOut.count());
+
+		_STL_VERIFY(result == vk::Result::eSuccess || result == vk::Result::eTimeout,
+			"FenceReactor couldn't wait on the in flight fences");
+	}
+};
+
+// CPU only stand in for vk::Fence, signaled by hand
+// Lets the reactor and the coroutines built on top of it run without a device
+class MockFenceBackend
+{
+public:
+	using FenceType = uint64_t;
+
+public:
+	MockFenceBackend()
+		: mState(std::make_shared<State>()) {}
+
+	FenceType CreateFence(bool signaled = false) const
+	{
+		std::scoped_lock locker(mState->Lock);
+
+		FenceType fence = mState->NextFence++;
+		mState->Signaled[fence] = signaled;
+
+		return fence;
+	}
+
+	void Signal(FenceType fence) const
+	{
+		{
+			std::scoped_lock locker(mState->Lock);
+			mState->Signaled[fence] = true;
+		}
+
+		mState->Notifier.notify_all();
+	}
+
+	void Reset(FenceType fence) const
+	{
+		std::scoped_lock locker(mState->Lock);
+		mState->Signaled[fence] = false;
+	}
+
+	bool IsSignaled(FenceType fence) const
+	{
+		std::scoped_lock locker(mState->Lock);
+		return mState->Signaled[fence];
+	}
+
+	void WaitAny(std::span<const FenceType> fences, std::chrono::nanoseconds timeOut) const
+	{
+		std::unique_lock locker(mState->Lock);
+
+		mState->Notifier.wait_for(locker, timeOut, [this, fences]()
+		{
+			return std::ranges::any_of(fences, [this](FenceType fence) { return mState->Signaled[fence]; });
+		});
+	}
+
+private:
+	struct State
+	{
+		std::mutex Lock;
+		std::condition_variable Notifier;
+
+		std::unordered_map<FenceType, bool> Signaled;
+		FenceType NextFence = 1;
+	};
+
+	// copies of the backend share the same fences
+	std::shared_ptr<State> mState;
+};
+
+// Owns a thread that watches fences and resumes the coroutines waiting on them
+// Coroutines are resumed on the reactor thread, keep the work after the co_await short
+// or hop onto another executor from there
+// The reactor drains every pending wait before its thread exits, so it must outlive
+// the processes scheduled on it and must not be destroyed from a resumed coroutine
+// Thread safe
+template <typename Backend>
+class BasicFenceReactor
+{
+public:
+	using FenceType = typename Backend::FenceType;
+
+	struct Awaitable
+	{
+		BasicFenceReactor* Reactor = nullptr;
+		FenceType Fence{};
+
+		bool await_ready() const { return Reactor->mBackend.IsSignaled(Fence); }
+		void await_suspend(std::coroutine_handle<> handle) const { Reactor->Schedule(Fence, handle); }
+		void await_resume() const noexcept {}
+	};
+
+public:
+	explicit BasicFenceReactor(Backend backend,
+		std::chrono::nanoseconds pollInterval = std::chrono::microseconds(200))
+		: mBackend(std::move(backend)), mPollInterval(pollInterval)
+	{
+		mThread = std::thread([this]() { Run(); });
+	}
+
+	~BasicFenceReactor()
+	{
+		{
+			std::scoped_lock locker(mLock);
+			mStopRequested = true;
+		}
+
+		mNotifier.notify_one();
+		mThread.join();
+	}
+
+	BasicFenceReactor(const BasicFenceReactor&) = delete;
+	BasicFenceReactor& operator=(const BasicFenceReactor&) = delete;
+
+	// co_await reactor.WaitFor(fence) suspends until the fence is signaled
+	Awaitable WaitFor(FenceType fence) { return { this, fence }; }
+
+	size_t GetInFlightCount() const { return mInFlight.load(std::memory_order_relaxed); }
+	const Backend& GetBackend() const { return mBackend; }
+
+private:
+	struct PendingWait
+	{
+		FenceType Fence{};
+		std::coroutine_handle<> Handle;
+	};
+
+	Backend mBackend;
+	std::chrono::nanoseconds mPollInterval;
+
+	std::mutex mLock;
+	std::condition_variable mNotifier;
+	std::vector<PendingWait> mIncoming;
+	bool mStopRequested = false;
+
+	std::atomic<size_t> mInFlight = 0;
+
+	std::thread mThread;
+
+private:
+	void Schedule(FenceType fence, std::coroutine_handle<> handle)
+	{
+		mInFlight.fetch_add(1, std::memory_order_relaxed);
+
+		{
+			std::scoped_lock locker(mLock);
+			mIncoming.push_back({ fence, handle });
+		}
+
+		mNotifier.notify_one();
+	}
+
+	void Run()
+	{
+		std::vector<PendingWait> active;
+		std::vector<PendingWait> ready;
+		std::vector<FenceType> fences;
+
+		while (true)
+		{
+			{
+				std::unique_lock locker(mLock);
+
+				// nothing to watch, sleep until someone schedules a wait
+				if (active.empty())
+					mNotifier.wait(locker, [this]() { return mStopRequested || !mIncoming.empty(); });
+
+				if (mStopRequested && active.empty() && mIncoming.empty())
+					return;
+
+				active.insert(active.end(), mIncoming.begin(), mIncoming.end());
+				mIncoming.clear();
+			}
+
+			auto split = std::partition(active.begin(), active.end(),
+				[this](const PendingWait& wait) { return !mBackend.IsSignaled(wait.Fence); });
+
+			ready.assign(split, active.end());
+			active.erase(split, active.end());
+
+			if (ready.empty())
+			{
+				fences.clear();
+
+				for (const auto& wait : active)
+					fences.push_back(wait.Fence);
+
+				// bounded so newly scheduled waits are picked up within one interval
+				mBackend.WaitAny(fences, mPollInterval);
+				continue;
+			}
+
+			// resumed without holding the lock, the coroutine may schedule its next wait right away
+			for (const auto& wait : ready)
+			{
+				mInFlight.fetch_sub(1, std::memory_order_relaxed);
+				wait.Handle.resume();
+			}
+
+			ready.clear();
+		}
+	}
+};
+
+using FenceReactor = BasicFenceReactor<DeviceFenceBackend>;
+using MockFenceReactor = BasicFenceReactor<MockFenceBackend>;
+
+VK_CORE_END
+VK_END
@@ -2,6 +2,7 @@
 // Vulkan configuration and queue structures...
 #include "../Core/Config.h"
 #include "../Core/Ref.h"
+#include "WorkerFreeList.h"
 
 VK_BEGIN
 class WorkingClass;
@@ -27,6 +28,12 @@ struct WorkerFamily
 
 	mutable std::atomic_uint32_t mActiveQueue = 0;
 
+	// idle workers, acquired by Worker::SubmitRange without locking the whole family
+	mutable WorkerFreeList FreeWorkers;
+
+	// submitters wait for an idle worker instead of falling back to Next() when none is free
+	bool ExclusiveSubmission = false;
+
 	std::vector<WorkerLock*> mMutexes;
 	std::vector<Core::Ref<WorkerQueue>> Workers;
 
@@ -44,13 +51,19 @@ struct CommandPoolData
 	vk::CommandPool Handle;
 	std::mutex Lock;
 
+	// primaries handed back through CommandBufferAllocator::Recycle, reused by the next Allocate
+	std::vector<vk::CommandBuffer> Recycled;
+
 	CommandPoolData() = default;
 
 	CommandPoolData(const CommandPoolData& Other)
 		: Handle(Other.Handle) {}
 
 	CommandPoolData& operator =(const CommandPoolData& Other)
-	{ Handle = Other.Handle; }
+	{
+		Handle = Other.Handle;
+		return *this;
+	}
 
 	bool operator ==(const CommandPoolData& Other) const { return Handle == Other.Handle; }
 };
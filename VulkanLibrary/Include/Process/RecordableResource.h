@@ -1,6 +1,8 @@
 #pragma once
 #include "ProcessConfig.h"
 #include "Commands.h"
+#include "AsyncProcess.h"
+#include "FenceReactor.h"
 
 VK_BEGIN
 
@@ -22,6 +24,11 @@ public:
 	template <typename Fn>
 	void InvokeProcess(uint32_t index, Fn&& fn) const;
 
+	// Records and submits right away, then hands the wait over to the reactor
+	// The resource only has to outlive the recording, the frame keeps the pool and the worker alive
+	template <typename Fn>
+	Core::AsyncProcess InvokeOneTimeProcessAsync(Core::FenceReactor& reactor, uint32_t index, Fn fn) const;
+
 	virtual ~RecordableResource() = default;
 
 protected:
@@ -68,9 +75,10 @@ void VK_NAMESPACE::RecordableResource::InvokeProcess(uint32_t index, Fn&& fn) co
 
 	// maybe we've to wrap this guy in too
 	executor.Enqueue(cmdBuf);
+	cmdBufAlloc.RetireReleasedBuffers(executor.GetFence());
 	executor.WaitIdle();
 
-	cmdBufAlloc.Free(cmdBuf);
+	cmdBufAlloc.Recycle(cmdBuf);
 }
 
 template<typename Fn>
@@ -89,4 +97,35 @@ void VK_NAMESPACE::RecordableResource::InvokeOneTimeProcess(uint32_t index, Fn&&
 	cmdBufAlloc.EndOneTimeCommands(cmdBuf, executor);
 }
 
+template <typename Fn>
+VK_NAMESPACE::Core::AsyncProcess VK_NAMESPACE::RecordableResource::InvokeOneTimeProcessAsync(
+	Core::FenceReactor& reactor, uint32_t index, Fn fn) const
+{
+	auto cmdBufAlloc = mCommandPools[index];
+	auto executor = mWorkingClass->FetchWorker(index);
+
+	vk::CommandBuffer cmdBuf;
+	uint32_t queueIndex = -1;
+
+	{
+		std::scoped_lock locker(cmdBufAlloc);
+
+		cmdBuf = cmdBufAlloc.BeginOneTimeCommands();
+
+		// Recording done inside this function
+		fn(cmdBuf);
+
+		cmdBuf.end();
+		queueIndex = executor.Enqueue(cmdBuf);
+	}
+
+	_STL_VERIFY(queueIndex != std::numeric_limits<uint32_t>::max(), "Couldn't submit the one time process");
+
+	// never hold the pool lock across the suspension point
+	co_await reactor.WaitFor(executor.GetFence());
+
+	std::scoped_lock locker(cmdBufAlloc);
+	cmdBufAlloc.Recycle(cmdBuf);
+}
+
 VK_END
@@ -2,8 +2,6 @@
 #include "WorkerQueue.h"
 #include "WorkingClass.h"
 
-#include "../Core/MultiUniqueLock.h"
-
 #include "../Core/Ref.h"
 
 VK_BEGIN
@@ -79,48 +77,96 @@ private:
 		}, device->createFence({ vk::FenceCreateFlagBits::eSignaled }));
 	}
 
-	size_t GetBeginIdx() const
-	{ return 0; }
+	std::span<const Ref<WorkerQueue>> GetActiveWorkers() const;
 
-	size_t GetEndIdx() const
-	{ return mFamilyData->Workers.size(); }
+	// Blocks until at least one busy worker of the family retires its work
+	// eNotReady without blocking if none is in flight
+	vk::Result WaitForBusyWorkers(std::chrono::nanoseconds timeOut) const;
+	uint32_t ReclaimFreeWorkers() const;
 
-	std::span<const Ref<WorkerQueue>> GetActiveWorkers() const;
-	vk::Result WaitForQueues(size_t beginSpan, size_t endSpan, bool waitForAll, std::chrono::nanoseconds timeOut) const;
+	// an idle worker off the free list after at most one reclaim, sInvalidIndex if every one is busy
+	uint32_t TryAcquireFreeWorker() const;
 
 	uint32_t SubmitRange(const vk::ArrayProxy<vk::SubmitInfo>& submitInfos, std::chrono::nanoseconds timeOut) const;
 
 	template <typename Fn>
 	uint32_t PollFreeWorkers(const std::chrono::nanoseconds timeOut, Fn&& fn) const;
+
+	template <typename Fn>
+	uint32_t SubmitToFreeWorker(uint32_t index, Fn&& fn) const;
 };
 
 template <typename Fn>
 uint32_t VK_NAMESPACE::VK_CORE::Worker::PollFreeWorkers(std::chrono::nanoseconds timeOut, Fn&& fn) const
 {
-	// make sure no external process can submit to any worker while this routine isn't complete
-	// a centralized mutex is slightly worse for the performance...
-	auto workers = GetActiveWorkers();
-
-	std::span mtxSpan(mFamilyData->mMutexes.begin() + GetBeginIdx(),
-		mFamilyData->mMutexes.begin() + GetEndIdx());
+	// idle workers are popped off the family's free list, no family wide lock is taken
+	// busy workers push themselves back once their idle fence is observed signaled
+	auto& freeList = mFamilyData->FreeWorkers;
 
-	UniqueLockRange lockRange(mtxSpan);
+	const bool infinite = timeOut == std::chrono::nanoseconds::max();
+	const auto deadline = infinite ? std::chrono::steady_clock::time_point::max() :
+		std::chrono::steady_clock::now() + timeOut;
 
-	if (WaitForQueues(GetBeginIdx(), GetEndIdx(), false, timeOut) != vk::Result::eSuccess)
-		return std::numeric_limits<uint32_t>::max();
+	SpinBackoff backoff;
 
-	// polling the workers to submit the work
-	for (auto worker : workers)
+	while (true)
 	{
-		// checkout which fence/worker was freed
-		if (worker->WaitIdleAsync(0) != vk::Result::eSuccess)
+		uint32_t index = freeList.Acquire();
+
+		if (index == WorkerFreeList::sInvalidIndex)
+		{
+			if (ReclaimFreeWorkers() != 0)
+				continue;
+
+			auto now = std::chrono::steady_clock::now();
+
+			if (now >= deadline)
+				return std::numeric_limits<uint32_t>::max();
+
+			auto remaining = infinite ? timeOut :
+				std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now);
+
+			auto result = WaitForBusyWorkers(remaining);
+
+			// every worker is claimed but none submitted yet, back off until one of them does
+			if (result == vk::Result::eNotReady)
+			{
+				if (backoff.Exhausted())
+					std::this_thread::yield();
+				else
+					backoff.Pause();
+
+				continue;
+			}
+
+			if (result != vk::Result::eSuccess && result != vk::Result::eTimeout)
+				return std::numeric_limits<uint32_t>::max();
+
+			backoff.Reset();
 			continue;
+		}
+
+		return SubmitToFreeWorker(index, std::forward<Fn>(fn));
+	}
+}
 
-		if (fn(worker))
-			return static_cast<uint32_t>(worker->GetWorkerID());
+template <typename Fn>
+uint32_t VK_NAMESPACE::VK_CORE::Worker::SubmitToFreeWorker(uint32_t index, Fn&& fn) const
+{
+	auto& freeList = mFamilyData->FreeWorkers;
+
+	// a reclaimer may still be reading the idle fence the submission is about to reset
+	freeList.WaitForPins(index);
+
+	const auto& worker = mFamilyData->Workers[index];
+
+	if (fn(worker))
+	{
+		freeList.MarkInFlight(index, worker->mIdleFence);
+		return index;
 	}
 
-	// if everything goes right, we should never hit this line of code...
+	freeList.Release(index);
 	return std::numeric_limits<uint32_t>::max();
 }
 
@@ -0,0 +1,221 @@
+#pragma once
+#include "../Core/Config.h"
+#include "../Core/SpinLock.h"
+
+VK_BEGIN
+VK_CORE_BEGIN
+
+// Lock free stack of idle worker indices inside a worker family
+// A worker is popped when a submitter claims it, marked in flight along with the fence
+// that signals its completion and pushed back by whoever observes that fence signaled
+// The head carries a generation tag in its upper half to defeat ABA between pop and push
+// Whoever looks at a slot's fence pins the slot first and only touches the fence while the slot
+// is in flight, the new owner of a slot waits for the pins to drop before it resets the fence
+// Thread safe
+class WorkerFreeList
+{
+public:
+	constexpr static uint32_t sInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+	enum class SlotState : uint32_t
+	{
+		eIdle          = 0,
+		eAcquired      = 1,
+		eInFlight      = 2,
+	};
+
+public:
+	WorkerFreeList() = default;
+
+	WorkerFreeList(const WorkerFreeList&) = delete;
+	WorkerFreeList& operator=(const WorkerFreeList&) = delete;
+
+	// Not thread safe, must be called before the list is shared
+	void Reset(uint32_t count)
+	{
+		mSlots = std::make_unique<Slot[]>(count);
+		mCount = count;
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			mSlots[i].Next.store(i + 1 < count ? i + 1 : sInvalidIndex, std::memory_order_relaxed);
+			mSlots[i].State.store(SlotState::eIdle, std::memory_order_relaxed);
+		}
+
+		mHead.store(Pack(0, count == 0 ? sInvalidIndex : 0), std::memory_order_release);
+	}
+
+	// O(1), returns sInvalidIndex if every worker is busy
+	uint32_t Acquire()
+	{
+		uint64_t head = mHead.load(std::memory_order_acquire);
+
+		while (true)
+		{
+			uint32_t index = IndexOf(head);
+
+			if (index == sInvalidIndex)
+				return sInvalidIndex;
+
+			uint32_t next = mSlots[index].Next.load(std::memory_order_relaxed);
+
+			if (mHead.compare_exchange_weak(head, Pack(TagOf(head) + 1, next),
+				std::memory_order_acq_rel, std::memory_order_acquire))
+			{
+				// sequentially consistent against the pin in PinInFlight, a pinner that comes later sees it
+				mSlots[index].State.store(SlotState::eAcquired, std::memory_order_seq_cst);
+				return index;
+			}
+		}
+	}
+
+	// Blocks until nobody looks at the fence of an acquired slot anymore, call it before resetting the fence
+	// The pinners saw the fence signaled or are about to, so the wait is short
+	void WaitForPins(uint32_t index) const
+	{
+		Core::SpinBackoff backoff;
+
+		while (mSlots[index].Pins.load(std::memory_order_seq_cst) != 0)
+		{
+			if (backoff.Exhausted())
+				std::this_thread::yield();
+			else
+				backoff.Pause();
+		}
+	}
+
+	// Hands an acquired worker back without having submitted anything
+	void Release(uint32_t index)
+	{
+		mSlots[index].State.store(SlotState::eIdle, std::memory_order_relaxed);
+		Push(index);
+	}
+
+	// The worker stays out of the list until someone sees the fence signaled in Reclaim
+	void MarkInFlight(uint32_t index, vk::Fence fence)
+	{
+		mSlots[index].Fence.store(fence, std::memory_order_relaxed);
+		mSlots[index].State.store(SlotState::eInFlight, std::memory_order_release);
+	}
+
+	// Returns every in flight worker whose fence has signaled to the free list
+	// IsSignaled: bool(vk::Fence), injected so the list can be driven without a device
+	template <typename Fn>
+	uint32_t Reclaim(Fn&& IsSignaled)
+	{
+		uint32_t reclaimed = 0;
+
+		for (uint32_t i = 0; i < mCount; i++)
+		{
+			auto& slot = mSlots[i];
+
+			if (slot.State.load(std::memory_order_acquire) != SlotState::eInFlight)
+				continue;
+
+			auto fence = PinInFlight(i);
+
+			if (!fence)
+				continue;
+
+			bool signaled = IsSignaled(*fence);
+
+			// several reclaimers may observe the same fence, only one of them gets to push
+			// the slot can't have been handed out again in between, its owner would wait for our pin
+			SlotState expected = SlotState::eInFlight;
+
+			if (signaled && slot.State.compare_exchange_strong(expected, SlotState::eIdle,
+				std::memory_order_acq_rel, std::memory_order_relaxed))
+			{
+				Push(i);
+				reclaimed++;
+			}
+
+			Unpin(i);
+		}
+
+		return reclaimed;
+	}
+
+	// Slow path helper for blocking until any of the busy workers finishes
+	// The slots of the collected fences stay pinned until UnpinAll, don't hold them across more than one wait
+	void CollectInFlightFences(std::vector<vk::Fence>& fences, std::vector<uint32_t>& pinned) const
+	{
+		for (uint32_t i = 0; i < mCount; i++)
+		{
+			if (mSlots[i].State.load(std::memory_order_acquire) != SlotState::eInFlight)
+				continue;
+
+			if (auto fence = PinInFlight(i))
+			{
+				fences.push_back(*fence);
+				pinned.push_back(i);
+			}
+		}
+	}
+
+	void UnpinAll(std::span<const uint32_t> pinned) const
+	{
+		for (uint32_t index : pinned)
+			Unpin(index);
+	}
+
+	SlotState GetState(uint32_t index) const { return mSlots[index].State.load(std::memory_order_acquire); }
+	uint32_t GetCount() const { return mCount; }
+
+private:
+	struct Slot
+	{
+		std::atomic<uint32_t> Next{ sInvalidIndex };
+		std::atomic<SlotState> State{ SlotState::eIdle };
+
+		// written by the owner before publishing eInFlight, only read while pinned
+		std::atomic<vk::Fence> Fence{};
+
+		// threads currently looking at the fence
+		mutable std::atomic<uint32_t> Pins{ 0 };
+	};
+
+	alignas(64) std::atomic<uint64_t> mHead{ Pack(0, sInvalidIndex) };
+
+	std::unique_ptr<Slot[]> mSlots;
+	uint32_t mCount = 0;
+
+private:
+	// the fence of an in flight slot with the slot pinned, nullopt and nothing pinned otherwise
+	std::optional<vk::Fence> PinInFlight(uint32_t index) const
+	{
+		auto& slot = mSlots[index];
+
+		// sequentially consistent against the state store in Acquire, either the owner sees the pin
+		// or we see the slot acquired
+		slot.Pins.fetch_add(1, std::memory_order_seq_cst);
+
+		if (slot.State.load(std::memory_order_seq_cst) != SlotState::eInFlight)
+		{
+			Unpin(index);
+			return std::nullopt;
+		}
+
+		return slot.Fence.load(std::memory_order_relaxed);
+	}
+
+	void Unpin(uint32_t index) const { mSlots[index].Pins.fetch_sub(1, std::memory_order_release); }
+
+	void Push(uint32_t index)
+	{
+		uint64_t head = mHead.load(std::memory_order_relaxed);
+
+		do
+		{
+			mSlots[index].Next.store(IndexOf(head), std::memory_order_relaxed);
+		} while (!mHead.compare_exchange_weak(head, Pack(TagOf(head) + 1, index),
+			std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	constexpr static uint64_t Pack(uint32_t tag, uint32_t index) { return (uint64_t(tag) << 32) | index; }
+	constexpr static uint32_t IndexOf(uint64_t head) { return static_cast<uint32_t>(head); }
+	constexpr static uint32_t TagOf(uint64_t head) { return static_cast<uint32_t>(head >> 32); }
+};
+
+VK_CORE_END
+VK_END
@@ -48,10 +48,19 @@ private:
 	// sync stuff
 	mutable WorkerLock mLock;
 
+	// declared before the idle fence, which is created from it
 	vk::Device mDevice;
 
+	// signaled once everything submitted through SubmitTracked has retired,
+	// that's when the queue goes back into the family's free list
+	vk::Fence mIdleFence{};
+
 	WorkerQueue(vk::Queue handle, uint32_t queueIndex, vk::Device device)
-		: mHandle(handle), mWorkerID(queueIndex), mDevice(device) {}
+		: mHandle(handle), mWorkerID(queueIndex), mDevice(device),
+		mIdleFence(device.createFence({ vk::FenceCreateFlagBits::eSignaled })) {}
+
+	// Submits and then signals the idle fence behind the work, the caller must own the queue
+	vk::Result SubmitTracked(vk::ArrayProxy<vk::SubmitInfo> submitInfos, vk::Fence fence, std::chrono::nanoseconds timeOut) const;
 
 	void SubmitInternal(vk::ArrayProxy<vk::SubmitInfo> submitInfos, vk::Fence fence = nullptr) const;
 	void BindSparseInternal(const vk::BindSparseInfo& bindSparseInfo, vk::Fence fence = nullptr) const;
@@ -43,7 +43,7 @@ private:
 		const Core::QueueFamilyIndices& queueIndices,
 		const Core::QueueIndexMap& queueCaps,
 		const std::vector<vk::QueueFamilyProperties> queueProps,
-		Core::Ref<vk::Device> device);
+		Core::Ref<vk::Device> device, bool exclusiveSubmission);
 
 	WorkingClass(const WorkingClass&) = delete;
 	WorkingClass& operator =(const WorkingClass&) = delete;
@@ -0,0 +1,167 @@
+#pragma once
+#include "../Core/Config.h"
+#include "ShaderConfig.h"
+
+VK_BEGIN
+
+enum class CompilePhase : uint32_t
+{
+	eIncludes          = 0, // reading the file and resolving its #include directives
+	ePreprocess        = 1,
+	eParse             = 2,
+	eLink              = 3, // linking and generating the SPIR-V
+	eOptimize          = 4,
+	eReflect           = 5,
+	eCount             = 6,
+};
+
+// where a compilation got its SPIR-V from
+enum class CompileSource
+{
+	eCompiled          = 0,
+	eArchive           = 1,
+	eCache             = 2,
+};
+
+using CompilePhaseTimes = std::array<std::chrono::nanoseconds, static_cast<size_t>(CompilePhase::eCount)>;
+
+// One call to ShaderCompiler::Compile
+struct CompileRecord
+{
+	// the shader path, empty for sources compiled from a string
+	std::string Name;
+	vk::ShaderStageFlagBits Stage = vk::ShaderStageFlagBits::eVertex;
+
+	// ShaderArchive::HashPermutation of the compilation and its macros as NAME=VALUE;...
+	uint64_t PermutationHash = 0;
+	std::string Macros;
+
+	CompileSource Source = CompileSource::eCompiled;
+	bool Succeeded = false;
+
+	CompilePhaseTimes Phases{};
+	std::chrono::nanoseconds Total{};
+
+	// bytes of source with its includes resolved and bytes of SPIR-V produced
+	size_t SourceSize = 0;
+	size_t SPIRVSize = 0;
+
+	// SPIR-V instructions before and after the optimizer, zero when nothing was compiled
+	size_t UnoptimizedInstructions = 0;
+	size_t Instructions = 0;
+};
+
+// Every compilation of one shader permutation folded together
+struct CompileSummary
+{
+	std::string Name;
+	vk::ShaderStageFlagBits Stage = vk::ShaderStageFlagBits::eVertex;
+
+	uint64_t PermutationHash = 0;
+	std::string Macros;
+
+	uint64_t Compilations = 0;
+	uint64_t Failures = 0;
+	uint64_t ArchiveHits = 0;
+	uint64_t CacheHits = 0;
+
+	CompilePhaseTimes Phases{};
+	std::chrono::nanoseconds Total{};
+	std::chrono::nanoseconds Slowest{};
+
+	// of the latest compilation
+	size_t SourceSize = 0;
+	size_t SPIRVSize = 0;
+	size_t UnoptimizedInstructions = 0;
+	size_t Instructions = 0;
+};
+
+// Collects what ShaderCompiler::Compile spends its time on, per shader permutation and per phase
+// Compilers only measure while a registry is set on their environment or as the default, so leaving
+// both unset costs one pointer check per compilation
+// Compilations slower than the threshold are also kept in a bounded slow log and handed to the handler
+// Thread safe
+class CompileStatsRegistry
+{
+public:
+	using SlowCompileHandler = std::function<void(const CompileRecord&)>;
+
+	// the slow log keeps the latest records up to this count
+	constexpr static size_t sMaxSlowRecords = 256;
+
+public:
+	CompileStatsRegistry() = default;
+
+	CompileStatsRegistry(const CompileStatsRegistry&) = delete;
+	CompileStatsRegistry& operator=(const CompileStatsRegistry&) = delete;
+
+	// a zero threshold turns the slow log off, the handler runs on the compiling thread
+	VKLIB_API void SetSlowCompileThreshold(std::chrono::nanoseconds threshold, SlowCompileHandler handler = {});
+
+	VKLIB_API void Record(const CompileRecord& record);
+
+	// one summary per permutation, the largest total time first
+	VKLIB_API std::vector<CompileSummary> GetSummaries() const;
+	VKLIB_API std::vector<CompileRecord> GetSlowCompiles() const;
+
+	VKLIB_API CompilePhaseTimes GetPhaseTotals() const;
+	VKLIB_API uint64_t GetCompilationCount() const;
+
+	VKLIB_API void Clear();
+
+	// one row per permutation, times in microseconds
+	VKLIB_API void WriteCSV(std::ostream& stream) const;
+
+	// the phase totals, the summaries and the slow log, times in microseconds
+	VKLIB_API void WriteJSON(std::ostream& stream) const;
+
+	VKLIB_API static const char* GetPhaseName(CompilePhase phase);
+	VKLIB_API static const char* GetSourceName(CompileSource source);
+
+	// used by every ShaderCompiler whose environment doesn't carry a registry of its own, none by default
+	VKLIB_API static void SetDefault(std::shared_ptr<CompileStatsRegistry> registry);
+	VKLIB_API static std::shared_ptr<CompileStatsRegistry> GetDefault();
+
+private:
+	// name, stage, permutation hash
+	using SummaryKey = std::tuple<std::string, uint32_t, uint64_t>;
+
+	std::map<SummaryKey, CompileSummary> mSummaries;
+	std::deque<CompileRecord> mSlowCompiles;
+
+	CompilePhaseTimes mPhaseTotals{};
+	uint64_t mCompilations = 0;
+
+	std::chrono::nanoseconds mSlowThreshold{};
+	std::shared_ptr<SlowCompileHandler> mSlowHandler;
+
+	mutable std::mutex mLock;
+};
+
+// Adds the time until its destruction to one phase of a record, does nothing without a record
+class CompilePhaseTimer
+{
+public:
+	CompilePhaseTimer(CompileRecord* record, CompilePhase phase)
+		: mRecord(record), mPhase(phase)
+	{
+		if (mRecord)
+			mStart = std::chrono::steady_clock::now();
+	}
+
+	~CompilePhaseTimer()
+	{
+		if (mRecord)
+			mRecord->Phases[static_cast<size_t>(mPhase)] += std::chrono::steady_clock::now() - mStart;
+	}
+
+	CompilePhaseTimer(const CompilePhaseTimer&) = delete;
+	CompilePhaseTimer& operator=(const CompilePhaseTimer&) = delete;
+
+private:
+	CompileRecord* mRecord;
+	CompilePhase mPhase;
+	std::chrono::steady_clock::time_point mStart;
+};
+
+VK_END
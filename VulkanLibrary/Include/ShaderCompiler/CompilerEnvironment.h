@@ -1,6 +1,10 @@
 #pragma once
 #include "ShaderIncluder.h"
 #include "ShaderConfig.h"
+#include "SPIRVCache.h"
+#include "ShaderArchive.h"
+#include "ReflectionCache.h"
+#include "CompileStats.h"
 
 VK_BEGIN
 
@@ -30,11 +34,48 @@ public:
 	const std::unordered_map<std::string, std::string> GetMacroDefines() const
 	{ return mMacrosDefines; }
 
+	// compilations through this environment look up and store their SPIR-V here,
+	// nullptr falls back to SPIRVCache::GetDefault()
+	void SetSPIRVCache(std::shared_ptr<SPIRVCache> cache) { mSPIRVCache = std::move(cache); }
+	std::shared_ptr<SPIRVCache> GetSPIRVCache() const { return mSPIRVCache; }
+
+	// reflection results by SPIR-V digest, nullptr falls back to ReflectionCache::GetDefault()
+	void SetReflectionCache(std::shared_ptr<ReflectionCache> cache) { mReflectionCache = std::move(cache); }
+	std::shared_ptr<ReflectionCache> GetReflectionCache() const { return mReflectionCache; }
+
+	// file based compilations are looked up here first, nullptr falls back to ShaderArchive::GetDefault()
+	void SetShaderArchive(std::shared_ptr<ShaderArchive> archive) { mShaderArchive = std::move(archive); }
+	std::shared_ptr<ShaderArchive> GetShaderArchive() const { return mShaderArchive; }
+
+	// compilations through this environment report their timings here,
+	// nullptr falls back to CompileStatsRegistry::GetDefault()
+	void SetCompileStats(std::shared_ptr<CompileStatsRegistry> stats) { mCompileStats = std::move(stats); }
+	std::shared_ptr<CompileStatsRegistry> GetCompileStats() const { return mCompileStats; }
+
+	// sources and headers are read through this cache, which also records the dependency graph
+	// nullptr falls back to IncludeCache::GetDefault(), the getter returns the one actually used
+	void SetIncludeCache(std::shared_ptr<IncludeCache> cache) { mIncludeCache = std::move(cache); }
+	std::shared_ptr<IncludeCache> GetIncludeCache() const
+	{ return mIncludeCache ? mIncludeCache : IncludeCache::GetDefault(); }
+
+	// the shaders compiled through this environment's cache that include header, directly or not
+	std::vector<std::filesystem::path> GetAffectedShaders(const std::filesystem::path& header) const
+	{
+		auto cache = GetIncludeCache();
+		return cache ? cache->GetDependents(header) : std::vector<std::filesystem::path>();
+	}
+
 private:
 	std::set<std::filesystem::path> mSystemPaths;
 	CompilerConfig mConfig;
 
 	PreprocessorDirectives mMacrosDefines;
+
+	std::shared_ptr<SPIRVCache> mSPIRVCache;
+	std::shared_ptr<ShaderArchive> mShaderArchive;
+	std::shared_ptr<ReflectionCache> mReflectionCache;
+	std::shared_ptr<CompileStatsRegistry> mCompileStats;
+	std::shared_ptr<IncludeCache> mIncludeCache;
 };
 
 VK_END
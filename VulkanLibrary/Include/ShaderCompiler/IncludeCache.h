@@ -0,0 +1,86 @@
+#pragma once
+#include "../Core/Config.h"
+
+VK_BEGIN
+
+struct IncludeCacheStats
+{
+	uint64_t Hits = 0;
+	uint64_t Misses = 0;
+
+	// the file's time stamp or size moved, Reloads had new contents, Revalidations the same bytes
+	uint64_t Reloads = 0;
+	uint64_t Revalidations = 0;
+};
+
+// Shared store of the shader sources and headers read by ShaderIncluder and ShaderCompiler
+// Every read checks the file's last write time and size, a file is only read again once either moved,
+// and the contents are only replaced if their hash differs
+// Also records which files every compiled shader pulled in (nested includes flattened), so the shaders
+// affected by an edited header can be looked up
+// Paths are kept in their absolute, normalized form
+// Environments without their own cache share the default one, so the graph covers every compiled shader
+// Thread safe
+class IncludeCache
+{
+public:
+	IncludeCache() = default;
+
+	IncludeCache(const IncludeCache&) = delete;
+	IncludeCache& operator=(const IncludeCache&) = delete;
+
+	// the contents of the file, nullptr if it can't be read
+	VKLIB_API std::shared_ptr<const std::string> Read(const std::filesystem::path& path);
+
+	// forgets the contents, the next read goes to disk
+	VKLIB_API void Invalidate(const std::filesystem::path& path);
+	VKLIB_API void Clear();
+
+	// replaces what shader depended on during its last compilation
+	VKLIB_API void RecordDependencies(const std::filesystem::path& shader, const std::vector<std::filesystem::path>& includes);
+	VKLIB_API void ForgetShader(const std::filesystem::path& shader);
+
+	// every file shader included, directly or through another header
+	VKLIB_API std::vector<std::filesystem::path> GetDependencies(const std::filesystem::path& shader) const;
+
+	// every recorded shader that includes header, directly or through another header
+	VKLIB_API std::vector<std::filesystem::path> GetDependents(const std::filesystem::path& header) const;
+
+	VKLIB_API IncludeCacheStats GetStats() const;
+	VKLIB_API size_t GetEntryCount() const;
+
+	VKLIB_API static std::filesystem::path NormalizePath(const std::filesystem::path& path);
+
+	// the cache used by environments without their own, present from the start
+	// nullptr makes those environments read straight from disk
+	VKLIB_API static void SetDefault(std::shared_ptr<IncludeCache> cache);
+	VKLIB_API static std::shared_ptr<IncludeCache> GetDefault();
+
+private:
+	struct FileEntry
+	{
+		std::shared_ptr<const std::string> Contents;
+		uint64_t Hash = 0;
+
+		std::filesystem::file_time_type WriteTime;
+		uintmax_t Size = 0;
+	};
+
+	std::map<std::filesystem::path, FileEntry> mEntries;
+
+	std::map<std::filesystem::path, std::set<std::filesystem::path>> mDependencies;
+	std::map<std::filesystem::path, std::set<std::filesystem::path>> mDependents;
+
+	mutable std::shared_mutex mEntriesLock;
+	mutable std::shared_mutex mGraphLock;
+
+	std::atomic<uint64_t> mHits = 0;
+	std::atomic<uint64_t> mMisses = 0;
+	std::atomic<uint64_t> mReloads = 0;
+	std::atomic<uint64_t> mRevalidations = 0;
+
+private:
+	void ForgetShaderUnlocked(const std::filesystem::path& shader);
+};
+
+VK_END
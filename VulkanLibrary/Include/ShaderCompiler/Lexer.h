@@ -12,6 +12,120 @@ struct Token
 	size_t Position = -1;
 };
 
+// A token pointing into the scanned source, valid as long as the source is
+struct TokenView
+{
+	std::string_view Value;
+	int LineNumber = 0;
+	int CharOffset = 0;
+
+	size_t Position = -1;
+};
+
+struct LexerCursor
+{
+	size_t Position = 0;
+	size_t LineNumber = 0;
+	size_t LineStart = 0;
+};
+
+// Classifies every byte with one table lookup instead of searching the white space and delimiter strings
+// White spaces separate tokens and are skipped, every other delimiter is a token of its own,
+// a null character ends the source
+// Runs longer than a block are scanned 16 bytes at a time with SSE2 while the sets are small
+class CharClassTable
+{
+public:
+	// the block scan compares against every character of a set, past this size the table is faster
+	constexpr static size_t sMaxBlockScanSet = 8;
+
+public:
+	VKLIB_API CharClassTable();
+	VKLIB_API CharClassTable(std::string_view spaces, std::string_view delimiters);
+
+	bool IsWhiteSpace(char val) const { return mClasses[static_cast<uint8_t>(val)] & eWhiteSpace; }
+	bool IsDelimiter(char val) const { return mClasses[static_cast<uint8_t>(val)] & eDelimiter; }
+
+	// the first character at or after position that isn't a white space
+	VKLIB_API size_t SkipWhiteSpaces(std::string_view source, size_t position) const;
+
+	// the first delimiter at or after position, the size of the source if there is none
+	VKLIB_API size_t FindDelimiter(std::string_view source, size_t position) const;
+
+	// skips the white spaces at the cursor and reads the next token, an empty one once the source is consumed
+	VKLIB_API TokenView Scan(std::string_view source, LexerCursor& cursor) const;
+
+private:
+	enum CharClass : uint8_t
+	{
+		eWhiteSpace = 1,
+		eDelimiter = 2,
+	};
+
+	std::array<uint8_t, 256> mClasses{};
+
+	// the sets spelled out for the block scan, the delimiters include the white spaces and the null
+	// only filled up to sMaxBlockScanSet, a larger count disables the block scan
+	std::array<char, sMaxBlockScanSet> mWhiteSpaces{};
+	std::array<char, sMaxBlockScanSet> mDelimiters{};
+
+	size_t mWhiteSpaceCount = 0;
+	size_t mDelimiterCount = 0;
+};
+
+// Lazy, non allocating token stream over a source that must outlive it, cheap to copy
+// for (TokenView token : TokenScanner(source, classes)) visits the tokens up to the end of the source
+class TokenScanner
+{
+public:
+	class Iterator
+	{
+	public:
+		using value_type = TokenView;
+		using difference_type = std::ptrdiff_t;
+
+	public:
+		Iterator() = default;
+		explicit Iterator(TokenScanner* scanner)
+			: mScanner(scanner), mCurrent(scanner->Next()) {}
+
+		const TokenView& operator*() const { return mCurrent; }
+		const TokenView* operator->() const { return &mCurrent; }
+
+		Iterator& operator++() { mCurrent = mScanner->Next(); return *this; }
+		void operator++(int) { ++*this; }
+
+		bool operator==(std::default_sentinel_t) const { return mCurrent.Value.empty(); }
+
+	private:
+		TokenScanner* mScanner = nullptr;
+		TokenView mCurrent;
+	};
+
+public:
+	TokenScanner() = default;
+	TokenScanner(std::string_view source, const CharClassTable& classes)
+		: mSource(source), mClasses(classes) {}
+
+	TokenView Next() { return mClasses.Scan(mSource, mCursor); }
+
+	// recounts the lines up to position, clamped to the source
+	VKLIB_API void SetCursor(size_t position);
+
+	const LexerCursor& GetCursor() const { return mCursor; }
+	std::string_view GetSource() const { return mSource; }
+
+	Iterator begin() { return Iterator(this); }
+	std::default_sentinel_t end() const { return std::default_sentinel; }
+
+private:
+	std::string_view mSource;
+	CharClassTable mClasses;
+	LexerCursor mCursor;
+};
+
+// Owns its source and hands out owning tokens, built on CharClassTable
+// The end of the source comes out as a token holding a single null character
 class Lexer
 {
 public:
@@ -29,21 +143,11 @@ private:
 	std::string mSource;
 	std::vector<Token> mTokens;
 
-	size_t mPlace = 0;
-	size_t mLineNumber = 0;
-	size_t mCharOffset = 0;
-
-	std::string mDelimiters;
-	std::string mWhiteSpaces;
+	CharClassTable mClasses;
+	LexerCursor mCursor;
 
 private:
 	void Lex();
-	void SkipWhiteSpaces();
-	Token ReadUntilDelimiterHits();
-	bool IsInString(char val, const std::string& str);
-
-	const char& Increment();
-	void UpdateState(char Current);
 };
 
 VK_END
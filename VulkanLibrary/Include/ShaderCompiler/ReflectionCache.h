@@ -0,0 +1,58 @@
+#pragma once
+#include "../Core/Config.h"
+#include "ShaderConfig.h"
+#include "SPIRVCache.h"
+
+VK_BEGIN
+
+// What ShaderCompiler reflects out of a stage's SPIR-V
+struct ReflectionData
+{
+	ShaderMetaData MetaData;
+	LayoutInfo LayoutData;
+	DescSetLayoutBindingMap SetLayoutBindingsMap;
+};
+
+struct ReflectionCacheStats
+{
+	uint64_t Hits = 0;
+	uint64_t Misses = 0;
+};
+
+// Reflection results keyed by a digest of the SPIR-V words and the stage
+// Identical SPIR-V reflects identically, so recompiling an unchanged shader, loading one from the
+// SPIR-V cache's disk or producing the same code out of another macro set skips spirv-cross entirely
+// Thread safe
+class ReflectionCache
+{
+public:
+	ReflectionCache() = default;
+
+	ReflectionCache(const ReflectionCache&) = delete;
+	ReflectionCache& operator=(const ReflectionCache&) = delete;
+
+	VKLIB_API static SPIRVCacheKey ComputeKey(std::span<const uint32_t> byteCode, vk::ShaderStageFlagBits stage);
+
+	// nullptr on a miss
+	VKLIB_API std::shared_ptr<const ReflectionData> Find(const SPIRVCacheKey& key) const;
+
+	// a second store of the same key keeps the first entry, both reflect the same words
+	VKLIB_API std::shared_ptr<const ReflectionData> Store(const SPIRVCacheKey& key, ReflectionData data);
+
+	VKLIB_API void Clear();
+
+	VKLIB_API ReflectionCacheStats GetStats() const;
+	VKLIB_API size_t GetEntryCount() const;
+
+	// shared by every ShaderCompiler whose environment doesn't carry a cache of its own, always present
+	VKLIB_API static std::shared_ptr<ReflectionCache> GetDefault();
+
+private:
+	std::unordered_map<SPIRVCacheKey, std::shared_ptr<const ReflectionData>, SPIRVCacheKeyHasher> mEntries;
+	mutable std::shared_mutex mLock;
+
+	mutable std::atomic<uint64_t> mHits = 0;
+	mutable std::atomic<uint64_t> mMisses = 0;
+};
+
+VK_END
@@ -0,0 +1,95 @@
+#pragma once
+#include "../Core/Config.h"
+#include "ShaderConfig.h"
+
+VK_BEGIN
+
+// 128 bit digest of everything that decides the SPIR-V of a compilation
+struct SPIRVCacheKey
+{
+	uint64_t High = 0;
+	uint64_t Low = 0;
+
+	bool operator ==(const SPIRVCacheKey&) const = default;
+
+	// 32 hex digits, the file name of the entry on disk
+	VKLIB_API std::string ToString() const;
+};
+
+struct SPIRVCacheKeyHasher
+{
+	size_t operator()(const SPIRVCacheKey& key) const { return static_cast<size_t>(key.High ^ key.Low); }
+};
+
+struct SPIRVCacheStats
+{
+	uint64_t MemoryHits = 0;
+	uint64_t DiskHits = 0;
+	uint64_t Misses = 0;
+
+	uint64_t Stores = 0;
+	uint64_t DiskWrites = 0;
+
+	// entries on disk that were truncated, of another format version or didn't match their key
+	uint64_t Rejected = 0;
+};
+
+// Content addressed store of compiled shaders for ShaderCompiler
+// Keyed by the fully preprocessed source (includes resolved, so editing an included file is a miss),
+// the stage, the macro set, the optimizer level and the target versions
+// Entries stay in memory with their reflection data, and their SPIR-V is written to
+// <directory>/v<sFormatVersion>/<key>.spv, reflection is redone from the SPIR-V when an entry comes from disk
+// Files are replaced through a temporary and a rename, a torn write never looks like a valid entry
+// Thread safe
+class SPIRVCache
+{
+public:
+	// bump whenever the key or the file layout changes, older directories are simply ignored
+	constexpr static uint32_t sFormatVersion = 1;
+
+public:
+	// an empty directory keeps the cache in memory only
+	VKLIB_API explicit SPIRVCache(const std::filesystem::path& directory = {});
+
+	SPIRVCache(const SPIRVCache&) = delete;
+	SPIRVCache& operator=(const SPIRVCache&) = delete;
+
+	VKLIB_API static SPIRVCacheKey ComputeKey(std::string_view preprocessedCode, vk::ShaderStageFlagBits stage,
+		const PreprocessorDirectives& macros, OptimizerFlag optimization, const CompilerConfig& config);
+
+	// the in memory entry, nullptr on a miss
+	VKLIB_API std::shared_ptr<const CompileResult> Find(const SPIRVCacheKey& key);
+
+	// the SPIR-V stored on disk, nullopt on a miss
+	VKLIB_API std::optional<std::vector<uint32_t>> Load(const SPIRVCacheKey& key, vk::ShaderStageFlagBits stage);
+
+	// persist also writes the SPIR-V to disk, sources and error strings aren't kept
+	VKLIB_API void Store(const SPIRVCacheKey& key, const CompileResult& result, bool persist = true);
+
+	// drops the in memory entries, and the files of this format version if removeFiles is set
+	VKLIB_API void Clear(bool removeFiles = false);
+
+	VKLIB_API SPIRVCacheStats GetStats() const;
+	VKLIB_API size_t GetEntryCount() const;
+
+	// the versioned directory the entries live in, empty if the cache is memory only
+	const std::filesystem::path& GetDirectory() const { return mDirectory; }
+
+	// used by every ShaderCompiler whose environment doesn't carry a cache of its own, none by default
+	VKLIB_API static void SetDefault(std::shared_ptr<SPIRVCache> cache);
+	VKLIB_API static std::shared_ptr<SPIRVCache> GetDefault();
+
+private:
+	std::filesystem::path mDirectory;
+
+	std::unordered_map<SPIRVCacheKey, std::shared_ptr<const CompileResult>, SPIRVCacheKeyHasher> mEntries;
+	SPIRVCacheStats mStats;
+
+	mutable std::mutex mLock;
+
+private:
+	std::filesystem::path GetEntryPath(const SPIRVCacheKey& key) const;
+	bool WriteEntry(const SPIRVCacheKey& key, const ShaderSPIR_V& spirv) const;
+};
+
+VK_END
@@ -0,0 +1,44 @@
+#pragma once
+#include "../Core/Config.h"
+#include "ShaderConfig.h"
+
+VK_BEGIN
+
+struct SPIRVModuleStats
+{
+	size_t Words = 0;
+	size_t Instructions = 0;
+
+	// names, line info and sources
+	size_t DebugInstructions = 0;
+};
+
+struct SPIRVOptimizationReport
+{
+	// false when a pass failed or produced an invalid module, the code is left as it was
+	bool Succeeded = true;
+
+	SPIRVModuleStats Before;
+	SPIRVModuleStats After;
+};
+
+// Runs the optimizer recipes of an OptimizerFlag over a SPIR-V module
+// Every result is validated, a module the passes broke is never handed out
+class SPIRVOptimizer
+{
+public:
+	VKLIB_API static SPIRVModuleStats Measure(std::span<const uint32_t> byteCode);
+
+	// replaces byteCode with the optimized module
+	VKLIB_API static SPIRVOptimizationReport Optimize(std::vector<uint32_t>& byteCode, OptimizerFlag recipe,
+		spv_target_env targetEnv = SPV_ENV_VULKAN_1_3);
+
+	// drops OpLine, OpSource and friends and every name the reflection doesn't read, names of
+	// descriptors, push constant blocks and their members are kept so the reflection stays the same
+	// and so are the names of specialization constants
+	VKLIB_API static void StripDebugInfo(std::vector<uint32_t>& byteCode);
+
+	VKLIB_API static bool Validate(std::span<const uint32_t> byteCode, spv_target_env targetEnv = SPV_ENV_VULKAN_1_3);
+};
+
+VK_END
@@ -0,0 +1,133 @@
+#pragma once
+#include "../Core/Config.h"
+#include "ShaderConfig.h"
+
+VK_BEGIN
+
+struct ShaderArchiveStats
+{
+	uint64_t Hits = 0;
+	uint64_t Misses = 0;
+
+	// entries whose name didn't match their hash or whose data ran past the file
+	uint64_t Rejected = 0;
+
+	// entries whose shader or includes changed since the archive was built
+	uint64_t Outdated = 0;
+};
+
+// A file an archived entry was compiled from, the shader itself or one of its includes
+struct ShaderArchiveSource
+{
+	// relative to the source root with '/' separators, absolute for files outside of it
+	std::string Name;
+	uint64_t Hash = 0;
+};
+
+// Read only, memory mapped pack of precompiled shaders, written by ShaderArchiveWriter (see the ShaderPrecompiler tool)
+// Entries are looked up by their name, the shader's path relative to the source root with '/' separators,
+// and by a hash of the permutation (stage, sorted macros, optimizer level, target versions)
+// An entry holds the SPIR-V and the reflection the pipelines need, descriptor infos lack their spirv_cross type
+// Every entry also keeps the content hash of the shader and of each file it included, an entry whose
+// sources changed since the archive was built is a miss, so edited shaders are compiled at runtime
+// Thread safe
+class ShaderArchive
+{
+public:
+	// bump whenever the layout of the file changes
+	constexpr static uint32_t sFormatVersion = 3;
+
+public:
+	VKLIB_API ~ShaderArchive();
+
+	ShaderArchive(const ShaderArchive&) = delete;
+	ShaderArchive& operator=(const ShaderArchive&) = delete;
+
+	// nullptr if the file is missing, truncated or of another format version
+	// sourceRoot is the directory the entry names are relative to
+	VKLIB_API static std::shared_ptr<ShaderArchive> Open(
+		const std::filesystem::path& archivePath, const std::filesystem::path& sourceRoot);
+
+	VKLIB_API static uint64_t HashName(std::string_view name);
+	VKLIB_API static uint64_t HashPermutation(vk::ShaderStageFlagBits stage, const PreprocessorDirectives& macros,
+		OptimizerFlag optimization, const CompilerConfig& config);
+
+	VKLIB_API static uint64_t HashSource(std::string_view contents);
+
+	// the name of shaderPath inside the archive, nullopt if it lies outside of the source root
+	VKLIB_API std::optional<std::string> GetName(const std::filesystem::path& shaderPath) const;
+
+	// the stored result with its SPIR-V and reflection, nullopt on a miss or if the sources changed
+	VKLIB_API std::optional<CompileResult> Find(std::string_view name, vk::ShaderStageFlagBits stage,
+		const PreprocessorDirectives& macros, OptimizerFlag optimization, const CompilerConfig& config) const;
+
+	// the shader is compiled at runtime from now on, the hot reloader marks the sources it sees edited
+	VKLIB_API void MarkStale(const std::filesystem::path& shaderPath);
+
+	uint32_t GetEntryCount() const { return mEntryCount; }
+	const std::filesystem::path& GetSourceRoot() const { return mSourceRoot; }
+
+	VKLIB_API ShaderArchiveStats GetStats() const;
+
+	// consulted by every ShaderCompiler whose environment doesn't carry an archive of its own, none by default
+	VKLIB_API static void SetDefault(std::shared_ptr<ShaderArchive> archive);
+	VKLIB_API static std::shared_ptr<ShaderArchive> GetDefault();
+
+private:
+	struct MappedFile;
+
+	// the hash of a source file as of its last write time and size
+	struct SourceStamp
+	{
+		std::filesystem::file_time_type WriteTime;
+		uintmax_t Size = 0;
+		uint64_t Hash = 0;
+	};
+
+	std::unique_ptr<MappedFile> mFile;
+	std::filesystem::path mSourceRoot;
+
+	const std::byte* mData = nullptr;
+	size_t mSize = 0;
+	uint32_t mEntryCount = 0;
+
+	std::set<std::string> mStale;
+	mutable std::shared_mutex mStaleLock;
+
+	// the shared headers are hashed once per edit rather than once per lookup
+	mutable std::map<std::filesystem::path, SourceStamp> mSourceStamps;
+	mutable std::mutex mSourceLock;
+
+	mutable std::atomic<uint64_t> mHits = 0;
+	mutable std::atomic<uint64_t> mMisses = 0;
+	mutable std::atomic<uint64_t> mRejected = 0;
+	mutable std::atomic<uint64_t> mOutdated = 0;
+
+	ShaderArchive() = default;
+
+	bool IsCurrent(const std::vector<ShaderArchiveSource>& sources) const;
+	std::optional<uint64_t> HashFile(const std::filesystem::path& path) const;
+};
+
+// Collects compiled shaders and writes them out as one ShaderArchive
+class ShaderArchiveWriter
+{
+public:
+	ShaderArchiveWriter() = default;
+
+	// false if the result carries an error or no sources, a permutation added twice keeps the later result
+	// sources are the shader and every file it included, hashed with ShaderArchive::HashSource
+	VKLIB_API bool Add(std::string_view name, const PreprocessorDirectives& macros, OptimizerFlag optimization,
+		const CompilerConfig& config, const CompileResult& result, const std::vector<ShaderArchiveSource>& sources);
+
+	// written through a temporary and a rename, false on an I/O failure
+	VKLIB_API bool Write(const std::filesystem::path& archivePath) const;
+
+	size_t GetEntryCount() const { return mEntries.size(); }
+
+private:
+	// name hash, permutation hash --> serialized entry
+	std::map<std::pair<uint64_t, uint64_t>, std::vector<std::byte>> mEntries;
+};
+
+VK_END
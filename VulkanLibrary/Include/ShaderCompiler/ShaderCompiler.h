@@ -3,6 +3,7 @@
 #include "ShaderConfig.h"
 #include "CompilerEnvironment.h"
 #include "Lexer.h"
+#include "SPIRVOptimizer.h"
 
 VK_BEGIN
 
@@ -21,6 +22,11 @@ public:
 	VKLIB_API CompileResult Compile(const ShaderInput& Input);
 	VKLIB_API CompileResult Compile(ShaderInput&& Input);
 
+	// Compiles every input concurrently, results come back in the order of Inputs with their own errors
+	// Each thread works on its own copy of the compiler and its own glslang context, the calling thread joins in
+	// ThreadCount zero uses every hardware thread, an exception thrown by any compilation is rethrown here
+	VKLIB_API std::vector<CompileResult> CompileBatch(std::span<const ShaderInput> Inputs, uint32_t ThreadCount = 0);
+
 	VKLIB_API CompileResult PreprocessString(const std::string& shaderString, vk::ShaderStageFlagBits stage);
 
 	VKLIB_API static vk::ShaderStageFlagBits ConvertShaderStage(EShLanguage Stage);
@@ -35,25 +41,37 @@ private:
 
 private:
 	// Helper Functions...
+	// Record is nullptr unless the compilation is being measured
+	CompileResult CompileInternal(ShaderInput&& Input, CompileRecord* Record);
+
 	bool PreprocessShader(CompileResult& SrcCode,  EShLanguage stage);
-	bool ParseShader(CompileResult& Result, EShLanguage stage);
-	bool GenerateSPIR_V(CompileResult& Result, EShLanguage Stage, glslang::TShader& shader);
+	bool ParseShader(CompileResult& Result, EShLanguage stage, CompileRecord* Record = nullptr);
+	bool GenerateSPIR_V(CompileResult& Result, EShLanguage Stage, glslang::TShader& shader, CompileRecord* Record = nullptr);
+
+	// reflects through the reflection cache, spirv-cross only runs for SPIR-V it hasn't seen
+	void Reflect(CompileResult& Result);
 
 	void ReflectDescriptorLayouts(CompileResult& Result);
 	VKLIB_API void ResetInternal(const CompilerConfig& in);
 
-	void OptimizeCode(CompileResult& Result, OptimizerFlag Flag);
+	SPIRVOptimizationReport OptimizeCode(CompileResult& Result, OptimizerFlag Flag);
 
 
 	glslang::TShader MakeGLSLangShader(const CompilerEnvironment& Env, EShLanguage Stage);
 	void ReflectShaderMetaData(CompileResult& Result);
 	bool ReadAndPreprocess(CompileResult& Result, const ShaderInput& Input);
 
+	// fills Result from the precompiled archive, false on a miss
+	bool FetchArchived(CompileResult& Result, const ShaderInput& Input);
+
+	// fills Result from the cache, false on a miss
+	bool FetchCached(CompileResult& Result, SPIRVCache& Cache, const SPIRVCacheKey& Key);
+
 	void ResolveIncludeRecursive(CompileResult& Result, IncludeResult& Base, 
 		std::shared_ptr<ShaderIncluder> Includer, uint32_t RecursionDepth);
 
-	void ParseIncludeDirective(CompileResult& Result, Lexer& lexer, IncludeResult& Base, 
-		std::shared_ptr<ShaderIncluder> Includer, uint32_t RecursionDepth, Token& token);
+	void ParseIncludeDirective(CompileResult& Result, TokenScanner& scanner, IncludeResult& Base, 
+		std::shared_ptr<ShaderIncluder> Includer, uint32_t RecursionDepth, TokenView& token);
 
 };
 
@@ -19,14 +19,31 @@ enum class ErrorType
 	eLinking         = 3,
 };
 
+// The low bits pick a performance level, every level runs the performance passes
+// The recipes above them combine with a level and with each other, e.g. eO3 | eStripDebug
 enum OptimizerFlag
 {
 	eNone            = 0,
 	eO1              = 1,
 	eO2              = 2,
 	eO3              = 3,
+
+	// spirv-opt's size passes, after the performance passes when both are asked for
+	eSize            = 4,
+
+	// drops line info, sources and the names of everything but the reflected resources
+	eStripDebug      = 8,
+
+	// constant propagation and dead branch elimination only, branches on macro constants fold away
+	// the performance and size passes already include it
+	eDeadBranches    = 16,
+
+	ePerformanceMask = 3,
 };
 
+inline OptimizerFlag operator|(OptimizerFlag first, OptimizerFlag second)
+{ return static_cast<OptimizerFlag>(static_cast<uint32_t>(first) | static_cast<uint32_t>(second)); }
+
 struct CompileError
 {
 	ErrorType Type = ErrorType::eNone;
@@ -78,10 +95,38 @@ struct LayoutInfo
 	PushConstantSubrangeInfos PushConstantSubrangeInfos;
 };
 
+enum class SpecializationType : uint32_t
+{
+	eBool            = 0,
+	eInt             = 1,
+	eUInt            = 2,
+	eFloat           = 3,
+	eInt64           = 4,
+	eUInt64          = 5,
+	eDouble          = 6,
+};
+
+// A scalar declared as layout(constant_id = N) const, or one of the local_size_*_id sizes
+struct SpecializationConstantInfo
+{
+	uint32_t ConstantID = -1;
+	std::string Name; // empty for the work group sizes and stripped modules
+	SpecializationType Type = SpecializationType::eUInt;
+
+	// the bits of the value in the shader source, zero extended
+	uint64_t DefaultValue = 0;
+};
+
 struct ShaderMetaData
 {
 	vk::ShaderStageFlagBits ShaderType;
 	glm::uvec3 WorkGroupSize{}; // For compute shader...
+
+	// constant ids of the sizes declared through local_size_*_id, sNoConstantID for the literal ones
+	constexpr static uint32_t sNoConstantID = -1;
+	glm::uvec3 WorkGroupSizeIDs = glm::uvec3(sNoConstantID);
+
+	std::vector<SpecializationConstantInfo> SpecConstants;
 };
 
 struct CompileResult
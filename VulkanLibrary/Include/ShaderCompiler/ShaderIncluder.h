@@ -1,6 +1,7 @@
 #pragma once
 #include "CompilerUtils.h"
 #include "ShaderConfig.h"
+#include "IncludeCache.h"
 
 VK_BEGIN
 
@@ -17,9 +18,10 @@ struct IncludeResult
 class ShaderIncluder
 {
 public:
+	// a null cache reads every header straight from disk
 	ShaderIncluder(const std::filesystem::path& shaderDirectory,
-		const std::vector<std::filesystem::path>& Paths)
-		: mShaderDirectory(shaderDirectory), mSystemPaths(Paths) {}
+		const std::vector<std::filesystem::path>& Paths, std::shared_ptr<IncludeCache> cache = nullptr)
+		: mShaderDirectory(shaderDirectory), mSystemPaths(Paths), mCache(std::move(cache)) {}
 
 	VKLIB_API IncludeResult* IncludeSystem(const std::string& headerName,
 		const std::string& includerName, size_t recursionDepth);
@@ -29,13 +31,20 @@ public:
 
 	VKLIB_API void ReleaseInclude(IncludeResult* result);
 
+	// every header opened so far, in the order they were first included
+	const std::vector<std::filesystem::path>& GetIncludedFiles() const { return mIncludedFiles; }
+
 private:
 	std::filesystem::path mShaderDirectory;
 	std::vector<std::filesystem::path> mSystemPaths;
 
 	std::vector<std::filesystem::path> mRecursionStack;
 
+	std::shared_ptr<IncludeCache> mCache;
+	std::vector<std::filesystem::path> mIncludedFiles;
+
 private:
+	IncludeResult* LoadHeader(const std::string& headerName, const std::filesystem::path& path);
 	std::filesystem::path ResolveLocalPath(const std::filesystem::path& Header, const std::filesystem::path& IncludePath);
 };
 
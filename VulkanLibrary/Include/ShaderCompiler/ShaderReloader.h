@@ -0,0 +1,261 @@
+#pragma once
+#include "../Core/Config.h"
+#include "IncludeCache.h"
+
+VK_BEGIN
+
+// Clocks provide time_point and now(), std::chrono::steady_clock is one
+
+// Stand in for steady_clock that only moves when told to
+// Copies share the same time, so a test can hold one while the scheduler holds another
+class ManualClock
+{
+public:
+	using duration = std::chrono::nanoseconds;
+	using time_point = std::chrono::time_point<std::chrono::steady_clock, duration>;
+
+public:
+	ManualClock()
+		: mNow(std::make_shared<std::atomic<int64_t>>(0)) {}
+
+	time_point now() const { return time_point(duration(mNow->load())); }
+
+	void Advance(duration step) const { mNow->fetch_add(step.count()); }
+
+private:
+	std::shared_ptr<std::atomic<int64_t>> mNow;
+};
+
+struct ReloadBurst
+{
+	std::vector<uint64_t> Targets;
+
+	// the changed files and every source including them, with or without a target registered
+	std::vector<std::filesystem::path> Affected;
+};
+
+// Debounces file change events and resolves the reload targets they affect
+// Editors write a file several times per save and a save can touch several files, so nothing is
+// handed out until no event came in for the whole quiet period, then the burst is resolved at once
+// A target is affected when one of its sources changed or includes a changed file, the includes are
+// looked up through the dependents function (IncludeCache::GetDependents in practice)
+// Thread safe
+template <typename Clock>
+class BasicReloadScheduler
+{
+public:
+	using TimePoint = typename Clock::time_point;
+	using DependentsFn = std::function<std::vector<std::filesystem::path>(const std::filesystem::path&)>;
+
+public:
+	BasicReloadScheduler(Clock clock, std::chrono::nanoseconds quietPeriod, DependentsFn dependents = {})
+		: mClock(std::move(clock)), mQuietPeriod(quietPeriod), mDependents(std::move(dependents)) {}
+
+	uint64_t Register(const std::vector<std::filesystem::path>& sources)
+	{
+		std::scoped_lock locker(mLock);
+
+		auto& target = mTargets[mNextID];
+
+		for (const auto& source : sources)
+			target.insert(IncludeCache::NormalizePath(source));
+
+		return mNextID++;
+	}
+
+	void Unregister(uint64_t id)
+	{
+		std::scoped_lock locker(mLock);
+		mTargets.erase(id);
+	}
+
+	void OnFileChanged(const std::filesystem::path& file)
+	{
+		std::scoped_lock locker(mLock);
+
+		mPending.insert(IncludeCache::NormalizePath(file));
+		mLastEvent = mClock.now();
+	}
+
+	// the burst once it has been quiet long enough, nullopt until then
+	std::optional<ReloadBurst> CollectReady()
+	{
+		std::set<std::filesystem::path> changed;
+
+		{
+			std::scoped_lock locker(mLock);
+
+			if (mPending.empty() || mClock.now() - mLastEvent < mQuietPeriod)
+				return std::nullopt;
+
+			changed.swap(mPending);
+		}
+
+		// outside of the lock, the dependents come from another object's lock
+		std::set<std::filesystem::path> affected = changed;
+
+		if (mDependents)
+		{
+			for (const auto& file : changed)
+			{
+				for (const auto& dependent : mDependents(file))
+					affected.insert(IncludeCache::NormalizePath(dependent));
+			}
+		}
+
+		ReloadBurst burst;
+		burst.Affected.assign(affected.begin(), affected.end());
+
+		std::scoped_lock locker(mLock);
+
+		for (const auto& [id, sources] : mTargets)
+		{
+			bool hit = std::ranges::any_of(sources, [&affected](const std::filesystem::path& source)
+				{ return affected.contains(source); });
+
+			if (hit)
+				burst.Targets.push_back(id);
+		}
+
+		return burst;
+	}
+
+	bool HasPending() const
+	{
+		std::scoped_lock locker(mLock);
+		return !mPending.empty();
+	}
+
+	const Clock& GetClock() const { return mClock; }
+
+private:
+	Clock mClock;
+	std::chrono::nanoseconds mQuietPeriod;
+	DependentsFn mDependents;
+
+	std::map<uint64_t, std::set<std::filesystem::path>> mTargets;
+	uint64_t mNextID = 1;
+
+	std::set<std::filesystem::path> mPending;
+	TimePoint mLastEvent{};
+
+	mutable std::mutex mLock;
+};
+
+using ReloadScheduler = BasicReloadScheduler<std::chrono::steady_clock>;
+using MockReloadScheduler = BasicReloadScheduler<ManualClock>;
+
+// Polls the write times of every file below a set of directories
+// Polling keeps it portable, a shader tree is small enough to stat a few times a second
+class DirectoryWatcher
+{
+public:
+	DirectoryWatcher() = default;
+
+	// takes a snapshot, files already present aren't reported as changed
+	VKLIB_API void Watch(const std::filesystem::path& directory);
+
+	// files written, created or removed since the last poll
+	VKLIB_API std::vector<std::filesystem::path> Poll();
+
+private:
+	std::vector<std::filesystem::path> mDirectories;
+	std::map<std::filesystem::path, std::filesystem::file_time_type> mFiles;
+
+private:
+	void Scan(std::map<std::filesystem::path, std::filesystem::file_time_type>& files) const;
+};
+
+// Something rebuilt from shaders, usually a pipeline
+struct ShaderReloadTarget
+{
+	// the shader files it compiles, their includes are found through the include cache
+	std::vector<std::filesystem::path> Sources;
+
+	// runs on the reload thread, recompiles and builds the replacement into a staging slot
+	// false leaves the live object untouched
+	std::function<bool()> Rebuild;
+
+	// runs inside ApplyPending on the frame thread, swaps the staged object in
+	// must not wait on the device, retire the old object once the frames using it are done
+	// never runs while Rebuild of the same target does, so both can share one staging slot
+	std::function<void()> Commit;
+};
+
+struct ShaderReloadStats
+{
+	uint64_t Bursts = 0;
+	uint64_t Rebuilds = 0;
+	uint64_t Failures = 0;
+	uint64_t Commits = 0;
+
+	// commits put off to the next ApplyPending because the target was rebuilding again
+	uint64_t Deferred = 0;
+};
+
+// Watches shader directories and rebuilds the targets a change affects on a background thread
+// Successful rebuilds wait until ApplyPending, called between two frames, commits them,
+// a failed one keeps the live object, the next save retries
+// Changed sources are also marked stale in the default ShaderArchive so they aren't served from it
+// The includes are looked up in the cache the compilations record into, nullptr follows IncludeCache::GetDefault()
+// Thread safe
+class ShaderReloadService
+{
+public:
+	VKLIB_API explicit ShaderReloadService(std::shared_ptr<IncludeCache> includes = nullptr,
+		std::chrono::milliseconds quietPeriod = std::chrono::milliseconds(150),
+		std::chrono::milliseconds pollInterval = std::chrono::milliseconds(100));
+
+	VKLIB_API ~ShaderReloadService();
+
+	ShaderReloadService(const ShaderReloadService&) = delete;
+	ShaderReloadService& operator=(const ShaderReloadService&) = delete;
+
+	VKLIB_API void Watch(const std::filesystem::path& directory);
+
+	VKLIB_API uint64_t Register(ShaderReloadTarget target);
+
+	// waits for a rebuild of the target in progress, its functions are never called afterwards
+	VKLIB_API void Unregister(uint64_t id);
+
+	// commits every target rebuilt since the last call, returns how many
+	// Only takes locks and runs the commits, never compiles or waits, a target rebuilding
+	// again right now is left for the next call
+	VKLIB_API size_t ApplyPending();
+
+	VKLIB_API ShaderReloadStats GetStats() const;
+
+private:
+	// the lock keeps Rebuild and Commit of one target apart, they share its staging slot
+	struct TargetSlot
+	{
+		ShaderReloadTarget Target;
+		std::mutex Lock;
+	};
+
+	std::shared_ptr<IncludeCache> mIncludes;
+
+	DirectoryWatcher mWatcher;
+	ReloadScheduler mScheduler;
+
+	std::chrono::milliseconds mPollInterval;
+
+	std::map<uint64_t, std::shared_ptr<TargetSlot>> mTargets;
+	std::vector<uint64_t> mRebuilt;
+
+	ShaderReloadStats mStats;
+
+	mutable std::mutex mLock;
+	std::mutex mWatcherLock;
+
+	std::condition_variable mNotifier;
+	bool mStopRequested = false;
+
+	std::thread mThread;
+
+private:
+	void Run();
+	void RebuildTargets(const std::vector<uint64_t>& ids);
+};
+
+VK_END
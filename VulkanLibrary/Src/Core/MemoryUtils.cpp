@@ -1,5 +1,7 @@
 #include "Core/vkpch.h"
 #include "Core/Utils/MemoryUtils.h"
+#include "Memory/DeviceMemoryAllocator.h"
+#include "Memory/BufferRecycler.h"
 
 VK_BEGIN
 struct MemoryUtilsHelper {
@@ -136,6 +138,15 @@ uint32_t VK_NAMESPACE::VK_CORE::VK_UTILS::FindMemoryTypeIndex(vk::PhysicalDevice
 
 VK_NAMESPACE::VK_CORE::Buffer VK_NAMESPACE::VK_CORE::VK_UTILS::CreateBuffer(BufferConfig& bufferInput)
 {
+	// rounding up to a size class lets the buffer serve later requests once it's released
+	if (bufferInput.Recycler)
+	{
+		bufferInput.DeviceSize = bufferInput.Recycler->GetSizeClass(bufferInput.DeviceSize);
+
+		if (auto recycled = bufferInput.Recycler->Acquire(bufferInput))
+			return *recycled;
+	}
+
 	vk::BufferCreateInfo bufferInfo;
 	bufferInfo.setSharingMode(vk::SharingMode::eExclusive);
 	bufferInfo.setSize(bufferInput.DeviceSize);
@@ -147,12 +158,136 @@ VK_NAMESPACE::VK_CORE::Buffer VK_NAMESPACE::VK_CORE::VK_UTILS::CreateBuffer(Buff
 
 	//bufferInput.ElemCount = memReq.size / bufferInput.TypeSize;
 
-	auto Memory = AllocateMemory(memReq, bufferInput.MemProps, 
-		bufferInput.LogicalDevice, bufferInput.PhysicalDevice);
+	auto Allocation = AllocateMemory(memReq, bufferInput.MemProps, bufferInput.LogicalDevice,
+		bufferInput.PhysicalDevice, bufferInput.Allocator.get(), true, bufferInput.Tag);
+
+	bufferInput.LogicalDevice.bindBufferMemory(Handle, Allocation.Memory, Allocation.Offset);
+
+	Buffer buffer{ Handle, Allocation.Memory, memReq, 0, bufferInput, Allocation };
+	buffer.CreatedSize = bufferInput.DeviceSize;
+
+	return buffer;
+}
+
+void VK_NAMESPACE::VK_CORE::VK_UTILS::DestroyBuffer(vk::Device device, const Buffer& buffer)
+{
+	// parked buffers keep their memory and mapping for the next CreateBuffer
+	if (buffer.Config.Recycler && buffer.Config.Recycler->Release(buffer))
+		return;
+
+	// a block mapping of the sub allocator stays with the block
+	if (buffer.PersistentData && !buffer.Allocation.MappedData)
+		device.unmapMemory(buffer.Memory);
+
+	device.destroyBuffer(buffer.Handle);
+	FreeMemory(device, buffer.Allocation, buffer.Config.Allocator.get());
+}
+
+void* VK_NAMESPACE::VK_CORE::VK_UTILS::MapBufferMemory(vk::Device device, const Buffer& buffer,
+	vk::DeviceSize offset, vk::DeviceSize size)
+{
+	// blocks of the sub allocator are mapped once for good
+	if (buffer.Allocation.MappedData)
+		return buffer.Allocation.MappedData + offset;
+
+	// vk::DeviceMemory can't be mapped twice
+	if (buffer.PersistentData)
+		return buffer.PersistentData + offset;
 
-	bufferInput.LogicalDevice.bindBufferMemory(Handle, Memory, 0);
+	return device.mapMemory(buffer.Memory, buffer.Allocation.Offset + offset, size);
+}
+
+void VK_NAMESPACE::VK_CORE::VK_UTILS::UnmapBufferMemory(vk::Device device, const Buffer& buffer)
+{
+	// flushing has to happen while the memory is still mapped
+	if (!(buffer.Config.MemProps & vk::MemoryPropertyFlagBits::eHostCoherent))
+	{
+		// sub allocations of non coherent memory are padded out to whole atoms by the allocator
+		vk::MappedMemoryRange range{};
+		range.setMemory(buffer.Memory);
+		range.setOffset(buffer.Allocation.Offset);
+		range.setSize(buffer.Allocation.IsDedicated() ? VK_WHOLE_SIZE : buffer.Allocation.Size);
+
+		device.flushMappedMemoryRanges(range);
+	}
+
+	if (!buffer.Allocation.MappedData && !buffer.PersistentData)
+		device.unmapMemory(buffer.Memory);
+}
+
+std::byte* VK_NAMESPACE::VK_CORE::VK_UTILS::MapBufferPersistent(vk::Device device, Buffer& buffer)
+{
+	if (buffer.PersistentData)
+		return buffer.PersistentData;
+
+	if (buffer.Allocation.MappedData)
+		buffer.PersistentData = buffer.Allocation.MappedData;
+	else
+		buffer.PersistentData = static_cast<std::byte*>(device.mapMemory(
+			buffer.Memory, buffer.Allocation.Offset, VK_WHOLE_SIZE));
+
+	// flush ranges are relative to the buffer, the allocation is already atom aligned
+	vk::DeviceSize atomSize = buffer.Config.PhysicalDevice.getProperties().limits.nonCoherentAtomSize;
+	buffer.DirtyRanges.Reset(atomSize, buffer.Allocation.Size);
+
+	return buffer.PersistentData;
+}
+
+void VK_NAMESPACE::VK_CORE::VK_UTILS::MarkBufferDirty(Buffer& buffer, vk::DeviceSize offset, vk::DeviceSize size)
+{
+	if (buffer.Config.MemProps & vk::MemoryPropertyFlagBits::eHostCoherent)
+		return;
 
-	return { Handle, Memory, memReq, 0, bufferInput };
+	buffer.DirtyRanges.Mark(offset, size);
+}
+
+void VK_NAMESPACE::VK_CORE::VK_UTILS::FlushBufferRanges(vk::Device device, Buffer& buffer)
+{
+	if (buffer.DirtyRanges.IsEmpty())
+		return;
+
+	const auto& dirtyRanges = buffer.DirtyRanges.GetRanges();
+
+	std::vector<vk::MappedMemoryRange> ranges;
+	ranges.reserve(dirtyRanges.size());
+
+	for (const auto& dirty : dirtyRanges)
+	{
+		vk::MappedMemoryRange& range = ranges.emplace_back();
+		range.setMemory(buffer.Memory);
+		range.setOffset(buffer.Allocation.Offset + dirty.Begin);
+
+		// the tail of a dedicated allocation may not be a whole atom, only VK_WHOLE_SIZE is valid there
+		bool reachesEnd = buffer.Allocation.IsDedicated() && dirty.End == buffer.Allocation.Size;
+		range.setSize(reachesEnd ? VK_WHOLE_SIZE : dirty.GetSize());
+	}
+
+	device.flushMappedMemoryRanges(ranges);
+	buffer.DirtyRanges.Clear();
+}
+
+void VK_NAMESPACE::VK_CORE::VK_UTILS::InvalidateBufferMemory(vk::Device device, const Buffer& buffer)
+{
+	vk::MemoryPropertyFlags memProps = buffer.Config.MemProps;
+
+	if (!(memProps & vk::MemoryPropertyFlagBits::eHostVisible) || (memProps & vk::MemoryPropertyFlagBits::eHostCoherent))
+		return;
+
+	// the range has to be mapped while it's invalidated
+	bool mapped = buffer.Allocation.MappedData || buffer.PersistentData;
+
+	if (!mapped)
+		device.mapMemory(buffer.Memory, buffer.Allocation.Offset, VK_WHOLE_SIZE);
+
+	vk::MappedMemoryRange range{};
+	range.setMemory(buffer.Memory);
+	range.setOffset(buffer.Allocation.Offset);
+	range.setSize(buffer.Allocation.IsDedicated() ? VK_WHOLE_SIZE : buffer.Allocation.Size);
+
+	device.invalidateMappedMemoryRanges(range);
+
+	if (!mapped)
+		device.unmapMemory(buffer.Memory);
 }
 
 vk::DeviceMemory VK_NAMESPACE::VK_CORE::VK_UTILS::AllocateMemory(
@@ -167,6 +302,30 @@ vk::DeviceMemory VK_NAMESPACE::VK_CORE::VK_UTILS::AllocateMemory(
 	return logicalDevice.allocateMemory(allocInfo);
 }
 
+VK_NAMESPACE::VK_CORE::MemoryAllocation VK_NAMESPACE::VK_CORE::VK_UTILS::AllocateMemory(
+	const vk::MemoryRequirements& memReq, vk::MemoryPropertyFlags props, vk::Device logicalDevice,
+	vk::PhysicalDevice physicalDevice, DeviceMemoryAllocator* allocator, bool linear, std::string_view tag /*= {}*/)
+{
+	if (allocator)
+		return allocator->Allocate(memReq, props, linear, tag);
+
+	MemoryAllocation allocation{};
+	allocation.Memory = AllocateMemory(memReq, props, logicalDevice, physicalDevice);
+	allocation.Size = memReq.size;
+	allocation.MemoryTypeIndex = FindMemoryTypeIndex(physicalDevice, memReq.memoryTypeBits, props);
+
+	return allocation;
+}
+
+void VK_NAMESPACE::VK_CORE::VK_UTILS::FreeMemory(vk::Device logicalDevice,
+	const MemoryAllocation& allocation, DeviceMemoryAllocator* allocator)
+{
+	if (allocator)
+		allocator->Free(allocation);
+	else if (allocation.Memory)
+		logicalDevice.freeMemory(allocation.Memory);
+}
+
 void VK_NAMESPACE::VK_CORE::VK_UTILS::RecordBufferTransferBarrier(const BufferOwnershipTransferInfo& barrierInfo)
 {
 	vk::BufferMemoryBarrier barrier{};
@@ -302,10 +461,10 @@ VK_NAMESPACE::VK_CORE::Image VK_NAMESPACE::VK_CORE::VK_UTILS::CreateImage(ImageC
 	vk::Image image = config.LogicalDevice.createImage(createInfo);
 	vk::MemoryRequirements memreq = config.LogicalDevice.getImageMemoryRequirements(image);
 
-	vk::DeviceMemory Memory = AllocateMemory(memreq, config.MemProps,
-		config.LogicalDevice, config.PhysicalDevice);
+	auto Allocation = AllocateMemory(memreq, config.MemProps, config.LogicalDevice,
+		config.PhysicalDevice, config.Allocator.get(), config.Tiling == vk::ImageTiling::eLinear, config.Tag);
 
-	config.LogicalDevice.bindImageMemory(image, Memory, 0);
+	config.LogicalDevice.bindImageMemory(image, Allocation.Memory, Allocation.Offset);
 
 	ImageViewCreateInfo viewInfo{};
 	viewInfo.Format = config.Format;
@@ -327,7 +486,17 @@ VK_NAMESPACE::VK_CORE::Image VK_NAMESPACE::VK_CORE::VK_UTILS::CreateImage(ImageC
 
 	auto ViewHandle = CreateImageView(config.LogicalDevice, image, viewInfo);
 
-	return { image, Memory, memreq, config, ViewHandle, viewInfo };
+	Image Handles{ image, Allocation.Memory, memreq, config, ViewHandle, viewInfo };
+	Handles.Allocation = Allocation;
+
+	return Handles;
+}
+
+void VK_NAMESPACE::VK_CORE::VK_UTILS::DestroyImage(vk::Device device, const Image& image)
+{
+	device.destroyImageView(image.IdentityView);
+	device.destroyImage(image.Handle);
+	FreeMemory(device, image.Allocation, image.Config.Allocator.get());
 }
 
 void VK_NAMESPACE::VK_CORE::VK_UTILS::RecordImageLayoutTransition(const ImageLayoutTransitionInfo& transitionInfo)
@@ -0,0 +1,232 @@
+#include "Core/vkpch.h"
+#include "Descriptors/DescriptorLayoutCache.h"
+
+#include "Core/Utils/Utils.h"
+
+namespace
+{
+	template <typename Flags>
+	size_t HashFlags(Flags flags)
+	{
+		return std::hash<typename Flags::MaskType>()(static_cast<typename Flags::MaskType>(flags));
+	}
+
+	template <typename Handle>
+	size_t HashHandle(Handle handle)
+	{
+		return std::hash<typename Handle::CType>()(static_cast<typename Handle::CType>(handle));
+	}
+}
+
+VK_NAMESPACE::VK_CORE::DescriptorSetLayoutKey::DescriptorSetLayoutKey(
+	const std::vector<vk::DescriptorSetLayoutBinding>& bindings)
+	: Bindings(bindings)
+{
+	std::ranges::sort(Bindings, [](const vk::DescriptorSetLayoutBinding& left, const vk::DescriptorSetLayoutBinding& right)
+	{
+		return left.binding < right.binding;
+	});
+
+	// immutable samplers are copied in so the key doesn't point into the caller's memory
+	// they stay with their binding, the same samplers on another binding make another layout
+	ImmutableSamplers.resize(Bindings.size());
+
+	for (size_t i = 0; i < Bindings.size(); i++)
+	{
+		auto& binding = Bindings[i];
+
+		if (!binding.pImmutableSamplers)
+			continue;
+
+		ImmutableSamplers[i].assign(binding.pImmutableSamplers, binding.pImmutableSamplers + binding.descriptorCount);
+		binding.pImmutableSamplers = nullptr;
+	}
+}
+
+bool VK_NAMESPACE::VK_CORE::DescriptorSetLayoutKey::operator==(const DescriptorSetLayoutKey& Other) const
+{
+	if (Bindings.size() != Other.Bindings.size() || ImmutableSamplers != Other.ImmutableSamplers)
+		return false;
+
+	for (size_t i = 0; i < Bindings.size(); i++)
+	{
+		const auto& left = Bindings[i];
+		const auto& right = Other.Bindings[i];
+
+		if (left.binding != right.binding || left.descriptorType != right.descriptorType ||
+			left.descriptorCount != right.descriptorCount || left.stageFlags != right.stageFlags)
+			return false;
+	}
+
+	return true;
+}
+
+size_t VK_NAMESPACE::VK_CORE::DescriptorSetLayoutKey::GetHash() const
+{
+	size_t hash = Bindings.size();
+
+	for (size_t i = 0; i < Bindings.size(); i++)
+	{
+		const auto& binding = Bindings[i];
+
+		hash = Utils::CombineHash(hash, binding.binding);
+		hash = Utils::CombineHash(hash, static_cast<size_t>(binding.descriptorType));
+		hash = Utils::CombineHash(hash, binding.descriptorCount);
+		hash = Utils::CombineHash(hash, HashFlags(binding.stageFlags));
+
+		// (count, samplers...) so a binding without samplers can't alias the next one's
+		hash = Utils::CombineHash(hash, ImmutableSamplers[i].size());
+
+		for (auto sampler : ImmutableSamplers[i])
+			hash = Utils::CombineHash(hash, HashHandle(sampler));
+	}
+
+	return hash;
+}
+
+VK_NAMESPACE::VK_CORE::PipelineLayoutKey::PipelineLayoutKey(const std::vector<vk::DescriptorSetLayout>& setLayouts,
+	const std::vector<vk::PushConstantRange>& pushConstantRanges)
+	: SetLayouts(setLayouts), PushConstantRanges(pushConstantRanges)
+{
+	// set order is meaningful, push constant order isn't
+	std::ranges::sort(PushConstantRanges, [](const vk::PushConstantRange& left, const vk::PushConstantRange& right)
+	{
+		return std::tie(left.offset, left.size) < std::tie(right.offset, right.size);
+	});
+}
+
+bool VK_NAMESPACE::VK_CORE::PipelineLayoutKey::operator==(const PipelineLayoutKey& Other) const
+{
+	return SetLayouts == Other.SetLayouts && PushConstantRanges == Other.PushConstantRanges;
+}
+
+size_t VK_NAMESPACE::VK_CORE::PipelineLayoutKey::GetHash() const
+{
+	size_t hash = Utils::CombineHash(SetLayouts.size(), PushConstantRanges.size());
+
+	for (auto layout : SetLayouts)
+		hash = Utils::CombineHash(hash, HashHandle(layout));
+
+	for (const auto& range : PushConstantRanges)
+	{
+		hash = Utils::CombineHash(hash, HashFlags(range.stageFlags));
+		hash = Utils::CombineHash(hash, Utils::CombineHash(range.offset, range.size));
+	}
+
+	return hash;
+}
+
+VK_NAMESPACE::VK_CORE::DescriptorLayoutCache::DescriptorLayoutCache(Ref<vk::Device> device)
+	: mDevice(device) {}
+
+VK_NAMESPACE::VK_CORE::DescriptorLayoutCache::~DescriptorLayoutCache()
+{
+	for (const auto& [key, layout] : mPipelineLayouts)
+		mDevice->destroyPipelineLayout(layout);
+
+	for (const auto& [key, layout] : mSetLayouts)
+		mDevice->destroyDescriptorSetLayout(layout);
+}
+
+vk::DescriptorSetLayout VK_NAMESPACE::VK_CORE::DescriptorLayoutCache::FetchSetLayout(
+	const std::vector<vk::DescriptorSetLayoutBinding>& bindings)
+{
+	DescriptorSetLayoutKey key(bindings);
+
+	{
+		std::shared_lock reader(mLock);
+
+		auto found = mSetLayouts.find(key);
+
+		if (found != mSetLayouts.end())
+		{
+			mSetLayoutHits.fetch_add(1, std::memory_order_relaxed);
+			return found->second;
+		}
+	}
+
+	std::unique_lock writer(mLock);
+
+	// somebody might have beaten us to it while the lock was released
+	auto found = mSetLayouts.find(key);
+
+	if (found != mSetLayouts.end())
+	{
+		mSetLayoutHits.fetch_add(1, std::memory_order_relaxed);
+		return found->second;
+	}
+
+	vk::DescriptorSetLayoutCreateInfo createInfo{};
+	createInfo.setBindings(bindings);
+
+	vk::DescriptorSetLayout layout = mDevice->createDescriptorSetLayout(createInfo);
+
+	mSetLayouts.emplace(std::move(key), layout);
+	mSetLayoutsCreated++;
+
+	return layout;
+}
+
+vk::PipelineLayout VK_NAMESPACE::VK_CORE::DescriptorLayoutCache::FetchPipelineLayout(
+	const std::vector<vk::DescriptorSetLayout>& setLayouts, const std::vector<vk::PushConstantRange>& pushConstantRanges)
+{
+	PipelineLayoutKey key(setLayouts, pushConstantRanges);
+
+	{
+		std::shared_lock reader(mLock);
+
+		auto found = mPipelineLayouts.find(key);
+
+		if (found != mPipelineLayouts.end())
+		{
+			mPipelineLayoutHits.fetch_add(1, std::memory_order_relaxed);
+			return found->second;
+		}
+	}
+
+	std::unique_lock writer(mLock);
+
+	auto found = mPipelineLayouts.find(key);
+
+	if (found != mPipelineLayouts.end())
+	{
+		mPipelineLayoutHits.fetch_add(1, std::memory_order_relaxed);
+		return found->second;
+	}
+
+	vk::PipelineLayoutCreateInfo layoutInfo{};
+	layoutInfo.setSetLayouts(setLayouts);
+	layoutInfo.setPushConstantRanges(pushConstantRanges);
+
+	vk::PipelineLayout layout = mDevice->createPipelineLayout(layoutInfo);
+
+	mPipelineLayouts.emplace(std::move(key), layout);
+	mPipelineLayoutsCreated++;
+
+	return layout;
+}
+
+VK_NAMESPACE::VK_CORE::LayoutCacheStats VK_NAMESPACE::VK_CORE::DescriptorLayoutCache::GetStats() const
+{
+	std::shared_lock locker(mLock);
+
+	LayoutCacheStats stats{};
+	stats.SetLayoutsCreated = mSetLayoutsCreated;
+	stats.SetLayoutHits = mSetLayoutHits.load(std::memory_order_relaxed);
+	stats.PipelineLayoutsCreated = mPipelineLayoutsCreated;
+	stats.PipelineLayoutHits = mPipelineLayoutHits.load(std::memory_order_relaxed);
+
+	return stats;
+}
+
+size_t VK_NAMESPACE::VK_CORE::DescriptorLayoutCache::GetSetLayoutCount() const
+{
+	std::shared_lock locker(mLock);
+	return mSetLayouts.size();
+}
+
+size_t VK_NAMESPACE::VK_CORE::DescriptorLayoutCache::GetPipelineLayoutCount() const
+{
+	std::shared_lock locker(mLock);
+	return mPipelineLayouts.size();
+}
@@ -31,6 +31,7 @@ VK_NAMESPACE::VK_CORE::DescriptorSetAllocator VK_NAMESPACE::DescriptorPoolManage
 	Core::DescriptorSetAllocatorData AllocatorData{};
 	AllocatorData.Device = mPoolBuilder.GetDevice();
 	AllocatorData.Info = allocatorInfo;
+	AllocatorData.LayoutCache = mLayoutCache;
 
 	Core::Ref<Core::DescriptorSetAllocatorData> allocatorInfoRef =
 		Core::CreateRef<Core::DescriptorSetAllocatorData>(Core::DescriptorSetAllocatorDataDeleter(), AllocatorData);
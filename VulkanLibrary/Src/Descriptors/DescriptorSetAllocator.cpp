@@ -1,16 +1,26 @@
 #include "Core/vkpch.h"
 #include "Descriptors/DescriptorSetAllocator.h"
+#include "Descriptors/DescriptorLayoutCache.h"
 
 
 VK_NAMESPACE::Core::Ref<VK_NAMESPACE::DescriptorResource> 
 	VK_NAMESPACE::VK_CORE::DescriptorSetAllocator::Allocate(
 		const std::vector<vk::DescriptorSetLayoutBinding>& bindings)
 {
-	vk::DescriptorSetLayoutCreateInfo createInfo{};
-	createInfo.setBindings(bindings);
-
 	DescriptorResource Resource;
-	Resource.Layout = mData->Device->createDescriptorSetLayout(createInfo);
+
+	// cached layouts belong to the cache, only layouts we created ourselves get destroyed with the set
+	bool ownsLayout = !mData->LayoutCache;
+
+	if (ownsLayout)
+	{
+		vk::DescriptorSetLayoutCreateInfo createInfo{};
+		createInfo.setBindings(bindings);
+
+		Resource.Layout = mData->Device->createDescriptorSetLayout(createInfo);
+	}
+	else
+		Resource.Layout = mData->LayoutCache->FetchSetLayout(bindings);
 
 	auto pool = GetEmptyDescriptorPool();
 	auto allocatorData = mData;
@@ -24,9 +34,10 @@ VK_NAMESPACE::Core::Ref<VK_NAMESPACE::DescriptorResource>
 
 	mData->PoolBuffer.back().Inc();
 
-	return Core::CreateRef<DescriptorResource>([allocatorData, pool](DescriptorResource& resource)
+	return Core::CreateRef<DescriptorResource>([allocatorData, pool, ownsLayout](DescriptorResource& resource)
 	{
-		allocatorData->Device->destroyDescriptorSetLayout(resource.Layout);
+		if (ownsLayout)
+			allocatorData->Device->destroyDescriptorSetLayout(resource.Layout);
 
 		if (allocatorData->Info.Flags & vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet)
 			allocatorData->Device->freeDescriptorSets(pool, resource.Set);
@@ -5,6 +5,180 @@
 
 VK_BEGIN
 
+namespace
+{
+	void SetWriteInfo(vk::WriteDescriptorSet& write, const vk::DescriptorBufferInfo& info) { write.pBufferInfo = &info; }
+	void SetWriteInfo(vk::WriteDescriptorSet& write, const vk::DescriptorImageInfo& info) { write.pImageInfo = &info; }
+	void SetWriteInfo(vk::WriteDescriptorSet& write, const vk::BufferView& info) { write.pTexelBufferView = &info; }
+
+	// innermost batch of the calling thread, the others are linked through DescriptorBatch::mPrevious
+	thread_local DescriptorBatch* sActiveBatch = nullptr;
+}
+
+size_t DescriptorWriteBatch::WriteKeyHasher::operator()(const WriteKey& key) const
+{
+	size_t setHash = std::hash<VkDescriptorSet>()(static_cast<VkDescriptorSet>(key.Set));
+	return Utils::CombineHash(setHash, Utils::CombineHash(key.Binding, key.ArrayIndex));
+}
+
+void DescriptorWriteBatch::Write(vk::DescriptorSet set, uint32_t binding, uint32_t arrayIndex,
+	vk::DescriptorType type, const vk::DescriptorBufferInfo& bufferInfo)
+{
+	PendingWrite& write = FindOrInsert(set, binding, arrayIndex, type, InfoType::eBuffer);
+	mBufferInfos[write.InfoIndex] = bufferInfo;
+}
+
+void DescriptorWriteBatch::Write(vk::DescriptorSet set, uint32_t binding, uint32_t arrayIndex,
+	vk::DescriptorType type, const vk::DescriptorImageInfo& imageInfo)
+{
+	PendingWrite& write = FindOrInsert(set, binding, arrayIndex, type, InfoType::eImage);
+	mImageInfos[write.InfoIndex] = imageInfo;
+}
+
+void DescriptorWriteBatch::Write(vk::DescriptorSet set, uint32_t binding, uint32_t arrayIndex,
+	vk::DescriptorType type, vk::BufferView texelBufferView)
+{
+	PendingWrite& write = FindOrInsert(set, binding, arrayIndex, type, InfoType::eTexelBufferView);
+	mTexelBufferViews[write.InfoIndex] = texelBufferView;
+}
+
+const std::vector<vk::WriteDescriptorSet>& DescriptorWriteBatch::Resolve()
+{
+	mResolvedWrites.clear();
+	mResolvedWrites.reserve(mPendingWrites.size());
+
+	for (const auto& pending : mPendingWrites)
+	{
+		vk::WriteDescriptorSet& write = mResolvedWrites.emplace_back();
+		write.dstSet = pending.Set;
+		write.dstBinding = pending.Binding;
+		write.dstArrayElement = pending.ArrayIndex;
+		write.descriptorType = pending.Type;
+		write.descriptorCount = 1;
+
+		switch (pending.Info)
+		{
+			case InfoType::eBuffer:
+				SetWriteInfo(write, mBufferInfos[pending.InfoIndex]);
+				break;
+			case InfoType::eImage:
+				SetWriteInfo(write, mImageInfos[pending.InfoIndex]);
+				break;
+			case InfoType::eTexelBufferView:
+				SetWriteInfo(write, mTexelBufferViews[pending.InfoIndex]);
+				break;
+		}
+	}
+
+	return mResolvedWrites;
+}
+
+uint32_t DescriptorWriteBatch::Flush(vk::Device device)
+{
+	if (mPendingWrites.empty())
+		return 0;
+
+	const auto& writes = Resolve();
+	uint32_t count = static_cast<uint32_t>(writes.size());
+
+	device.updateDescriptorSets(count, writes.data(), 0, nullptr);
+
+	Clear();
+	return count;
+}
+
+void DescriptorWriteBatch::Clear()
+{
+	// keeps the capacity around, the same batch usually gets refilled with a similar amount of writes
+	mPendingWrites.clear();
+	mWriteSlots.clear();
+	mBufferInfos.clear();
+	mImageInfos.clear();
+	mTexelBufferViews.clear();
+	mResolvedWrites.clear();
+}
+
+DescriptorWriteBatch::PendingWrite& DescriptorWriteBatch::FindOrInsert(vk::DescriptorSet set,
+	uint32_t binding, uint32_t arrayIndex, vk::DescriptorType type, InfoType info)
+{
+	auto [found, inserted] = mWriteSlots.try_emplace(WriteKey{ set, binding, arrayIndex },
+		static_cast<uint32_t>(mPendingWrites.size()));
+
+	if (inserted)
+	{
+		PendingWrite& write = mPendingWrites.emplace_back();
+		write.Set = set;
+		write.Binding = binding;
+		write.ArrayIndex = arrayIndex;
+	}
+
+	PendingWrite& write = mPendingWrites[found->second];
+
+	// the last write wins, its info slot is reused unless the kind of info changed
+	if (!inserted && write.Info == info)
+	{
+		write.Type = type;
+		return write;
+	}
+
+	write.Type = type;
+	write.Info = info;
+
+	switch (info)
+	{
+		case InfoType::eBuffer:
+			write.InfoIndex = static_cast<uint32_t>(mBufferInfos.size());
+			mBufferInfos.emplace_back();
+			break;
+		case InfoType::eImage:
+			write.InfoIndex = static_cast<uint32_t>(mImageInfos.size());
+			mImageInfos.emplace_back();
+			break;
+		case InfoType::eTexelBufferView:
+			write.InfoIndex = static_cast<uint32_t>(mTexelBufferViews.size());
+			mTexelBufferViews.emplace_back();
+			break;
+	}
+
+	return write;
+}
+
+DescriptorBatch::DescriptorBatch(const DescriptorWriter& writer)
+	: mWriter(writer), mPrevious(sActiveBatch)
+{
+	if (DescriptorBatch* outer = FindActive(writer))
+		mTarget = outer->mTarget;
+
+	sActiveBatch = this;
+}
+
+DescriptorBatch::~DescriptorBatch()
+{
+	_STL_ASSERT(sActiveBatch == this, "DescriptorBatch destroyed out of order or on another thread");
+
+	sActiveBatch = mPrevious;
+	Flush();
+}
+
+uint32_t DescriptorBatch::Flush()
+{
+	if (mTarget != this)
+		return 0;
+
+	return mWrites.Flush(*mWriter.mDevice);
+}
+
+DescriptorBatch* DescriptorBatch::FindActive(const DescriptorWriter& writer)
+{
+	for (DescriptorBatch* batch = sActiveBatch; batch; batch = batch->mPrevious)
+	{
+		if (&batch->mWriter == &writer)
+			return batch;
+	}
+
+	return nullptr;
+}
+
 DescriptorWriter::DescriptorWriter(DescriptorWriter&& Other) noexcept
 	: mDevice(Other.mDevice), mDescriptorSets(std::move(Other.mDescriptorSets))
 {
@@ -20,6 +194,28 @@ DescriptorWriter& DescriptorWriter::operator=(DescriptorWriter&& Other) noexcept
 	return *this;
 }
 
+template <typename Info>
+void DescriptorWriter::Submit(const DescriptorLocation& location, vk::DescriptorType type, const Info& info) const
+{
+	vk::DescriptorSet set = mDescriptorSets[location.SetIndex];
+
+	if (DescriptorBatch* batch = DescriptorBatch::FindActive(*this))
+	{
+		batch->mTarget->mWrites.Write(set, location.Binding, location.ArrayIndex, type, info);
+		return;
+	}
+
+	vk::WriteDescriptorSet writeDescriptorSet;
+	writeDescriptorSet.dstSet = set;
+	writeDescriptorSet.dstBinding = location.Binding;
+	writeDescriptorSet.dstArrayElement = location.ArrayIndex;
+	writeDescriptorSet.descriptorType = type;
+	writeDescriptorSet.descriptorCount = 1;
+	SetWriteInfo(writeDescriptorSet, info);
+
+	mDevice->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
+}
+
 void DescriptorWriter::Update(
 	const DescriptorLocation& info,
 	const StorageBufferWriteInfo& bufferInfo) const
@@ -29,15 +225,7 @@ void DescriptorWriter::Update(
 	bufferDescriptor.offset = bufferInfo.Offset;
 	bufferDescriptor.range = bufferInfo.Range;
 
-	vk::WriteDescriptorSet writeDescriptorSet;
-	writeDescriptorSet.dstSet = mDescriptorSets[info.SetIndex];
-	writeDescriptorSet.dstBinding = info.Binding;
-	writeDescriptorSet.dstArrayElement = info.ArrayIndex;
-	writeDescriptorSet.descriptorType = vk::DescriptorType::eStorageBuffer;
-	writeDescriptorSet.descriptorCount = 1;
-	writeDescriptorSet.pBufferInfo = &bufferDescriptor;
-
-	mDevice->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
+	Submit(info, vk::DescriptorType::eStorageBuffer, bufferDescriptor);
 }
 
 void DescriptorWriter::Update(
@@ -49,15 +237,7 @@ void DescriptorWriter::Update(
 	bufferDescriptor.offset = bufferInfo.Offset;
 	bufferDescriptor.range = bufferInfo.Range;
 
-	vk::WriteDescriptorSet writeDescriptorSet;
-	writeDescriptorSet.dstSet = mDescriptorSets[info.SetIndex];
-	writeDescriptorSet.dstBinding = info.Binding;
-	writeDescriptorSet.dstArrayElement = info.ArrayIndex;
-	writeDescriptorSet.descriptorType = vk::DescriptorType::eUniformBuffer;
-	writeDescriptorSet.descriptorCount = 1;
-	writeDescriptorSet.pBufferInfo = &bufferDescriptor;
-
-	mDevice->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
+	Submit(info, vk::DescriptorType::eUniformBuffer, bufferDescriptor);
 }
 
 void DescriptorWriter::Update(
@@ -68,15 +248,7 @@ void DescriptorWriter::Update(
 	imageDescriptor.imageView = imageInfo.ImageView;
 	imageDescriptor.imageLayout = imageInfo.ImageLayout;
 
-	vk::WriteDescriptorSet writeDescriptorSet;
-	writeDescriptorSet.dstSet = mDescriptorSets[info.SetIndex];
-	writeDescriptorSet.dstBinding = info.Binding;
-	writeDescriptorSet.dstArrayElement = info.ArrayIndex;
-	writeDescriptorSet.descriptorType = vk::DescriptorType::eStorageImage;
-	writeDescriptorSet.descriptorCount = 1;
-	writeDescriptorSet.pImageInfo = &imageDescriptor;
-
-	mDevice->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
+	Submit(info, vk::DescriptorType::eStorageImage, imageDescriptor);
 }
 
 void DescriptorWriter::Update(
@@ -88,15 +260,7 @@ void DescriptorWriter::Update(
 	imageDescriptor.imageView = samplerInfo.ImageView;
 	imageDescriptor.imageLayout = samplerInfo.ImageLayout;
 
-	vk::WriteDescriptorSet writeDescriptorSet;
-	writeDescriptorSet.dstSet = mDescriptorSets[info.SetIndex];
-	writeDescriptorSet.dstBinding = info.Binding;
-	writeDescriptorSet.dstArrayElement = info.ArrayIndex;
-	writeDescriptorSet.descriptorType = vk::DescriptorType::eCombinedImageSampler;
-	writeDescriptorSet.descriptorCount = 1;
-	writeDescriptorSet.pImageInfo = &imageDescriptor;
-
-	mDevice->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
+	Submit(info, vk::DescriptorType::eCombinedImageSampler, imageDescriptor);
 }
 
 void DescriptorWriter::Update(
@@ -108,15 +272,7 @@ void DescriptorWriter::Update(
 	imageDescriptor.imageLayout = imageInfo.ImageLayout;
 	imageDescriptor.sampler = imageInfo.Sampler;
 
-	vk::WriteDescriptorSet writeDescriptorSet;
-	writeDescriptorSet.dstSet = mDescriptorSets[info.SetIndex];
-	writeDescriptorSet.dstBinding = info.Binding;
-	writeDescriptorSet.dstArrayElement = info.ArrayIndex;
-	writeDescriptorSet.descriptorType = vk::DescriptorType::eCombinedImageSampler;
-	writeDescriptorSet.descriptorCount = 1;
-	writeDescriptorSet.pImageInfo = &imageDescriptor;
-
-	mDevice->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
+	Submit(info, vk::DescriptorType::eCombinedImageSampler, imageDescriptor);
 }
 
 void DescriptorWriter::Update(
@@ -126,15 +282,7 @@ void DescriptorWriter::Update(
 	vk::DescriptorImageInfo imageDescriptor;
 	imageDescriptor.sampler = samplerInfo.Sampler;
 
-	vk::WriteDescriptorSet writeDescriptorSet;
-	writeDescriptorSet.dstSet = mDescriptorSets[info.SetIndex];
-	writeDescriptorSet.dstBinding = info.Binding;
-	writeDescriptorSet.dstArrayElement = info.ArrayIndex;
-	writeDescriptorSet.descriptorType = vk::DescriptorType::eSampler;
-	writeDescriptorSet.descriptorCount = 1;
-	writeDescriptorSet.pImageInfo = &imageDescriptor;
-
-	mDevice->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
+	Submit(info, vk::DescriptorType::eSampler, imageDescriptor);
 }
 
 void DescriptorWriter::Update(
@@ -145,46 +293,23 @@ void DescriptorWriter::Update(
 	imageDescriptor.imageView = attachmentInfo.ImageView;
 	imageDescriptor.imageLayout = attachmentInfo.ImageLayout;
 
-	vk::WriteDescriptorSet writeDescriptorSet;
-	writeDescriptorSet.dstSet = mDescriptorSets[info.SetIndex];
-	writeDescriptorSet.dstBinding = info.Binding;
-	writeDescriptorSet.dstArrayElement = info.ArrayIndex;
-	writeDescriptorSet.descriptorType = vk::DescriptorType::eInputAttachment;
-	writeDescriptorSet.descriptorCount = 1;
-	writeDescriptorSet.pImageInfo = &imageDescriptor;
-
-	mDevice->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
+	Submit(info, vk::DescriptorType::eInputAttachment, imageDescriptor);
 }
 
 void DescriptorWriter::Update(
 	const DescriptorLocation& info,
 	const UniformTexelBufferWriteInfo& bufferInfo) const
 {
-	vk::WriteDescriptorSet writeDescriptorSet;
-	writeDescriptorSet.dstSet = mDescriptorSets[info.SetIndex];
-	writeDescriptorSet.dstBinding = info.Binding;
-	writeDescriptorSet.dstArrayElement = info.ArrayIndex;
-	writeDescriptorSet.descriptorType = vk::DescriptorType::eUniformTexelBuffer;
-	writeDescriptorSet.descriptorCount = 1;
-	writeDescriptorSet.pTexelBufferView = &bufferInfo.BufferView;
-
-	mDevice->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
+	Submit(info, vk::DescriptorType::eUniformTexelBuffer, bufferInfo.BufferView);
 }
 
 void DescriptorWriter::Update(
 	const DescriptorLocation& info,
 	const StorageTexelBufferWriteInfo& bufferInfo) const
 {
-	vk::WriteDescriptorSet writeDescriptorSet;
-	writeDescriptorSet.dstSet = mDescriptorSets[info.SetIndex];
-	writeDescriptorSet.dstBinding = info.Binding;
-	writeDescriptorSet.dstArrayElement = info.ArrayIndex;
-	writeDescriptorSet.descriptorType = vk::DescriptorType::eStorageTexelBuffer;
-	writeDescriptorSet.descriptorCount = 1;
-	writeDescriptorSet.pTexelBufferView = &bufferInfo.BufferView;
-
-	mDevice->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
+	Submit(info, vk::DescriptorType::eStorageTexelBuffer, bufferInfo.BufferView);
 }
+
 void DescriptorWriter::Update(
 	const DescriptorLocation& info,
 	const DynamicStorageBufferWriteInfo& bufferInfo) const
@@ -194,15 +319,7 @@ void DescriptorWriter::Update(
 	bufferDescriptor.offset = bufferInfo.Offset;
 	bufferDescriptor.range = bufferInfo.Range;
 
-	vk::WriteDescriptorSet writeDescriptorSet;
-	writeDescriptorSet.dstSet = mDescriptorSets[info.SetIndex];
-	writeDescriptorSet.dstBinding = info.Binding;
-	writeDescriptorSet.dstArrayElement = info.ArrayIndex;
-	writeDescriptorSet.descriptorType = vk::DescriptorType::eStorageBufferDynamic;
-	writeDescriptorSet.descriptorCount = 1;
-	writeDescriptorSet.pBufferInfo = &bufferDescriptor;
-
-	mDevice->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
+	Submit(info, vk::DescriptorType::eStorageBufferDynamic, bufferDescriptor);
 }
 
 void DescriptorWriter::Update(
@@ -214,15 +331,7 @@ void DescriptorWriter::Update(
 	bufferDescriptor.offset = bufferInfo.Offset;
 	bufferDescriptor.range = bufferInfo.Range;
 
-	vk::WriteDescriptorSet writeDescriptorSet;
-	writeDescriptorSet.dstSet = mDescriptorSets[info.SetIndex];
-	writeDescriptorSet.dstBinding = info.Binding;
-	writeDescriptorSet.dstArrayElement = info.ArrayIndex;
-	writeDescriptorSet.descriptorType = vk::DescriptorType::eUniformBufferDynamic;
-	writeDescriptorSet.descriptorCount = 1;
-	writeDescriptorSet.pBufferInfo = &bufferDescriptor;
-
-	mDevice->updateDescriptorSets(1, &writeDescriptorSet, 0, nullptr);
+	Submit(info, vk::DescriptorType::eUniformBufferDynamic, bufferDescriptor);
 }
 
 bool operator==(const DescriptorLocation& left, const DescriptorLocation& right)
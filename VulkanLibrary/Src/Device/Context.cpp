@@ -34,7 +34,15 @@ VK_NAMESPACE::Context::Context(const ContextCreateInfo& info)
 
 		for (size_t i = 0; i < count; i++)
 		{
-			auto familyRef = Core::CreateRef<Core::WorkerQueue>([device](Core::WorkerQueue& worker) { }, 
+			auto familyRef = Core::CreateRef<Core::WorkerQueue>([device](Core::WorkerQueue& worker)
+			{
+				// the queue may still be chewing on tracked work
+				auto result = device->waitForFences(worker.mIdleFence, VK_TRUE, UINT64_MAX);
+
+				_STL_VERIFY(result == vk::Result::eSuccess, "WorkerQueue idle fence couldn't be waited on");
+
+				device->destroyFence(worker.mIdleFence);
+			}, 
 				mHandle->getQueue(index, static_cast<uint32_t>(i)), static_cast<uint32_t>(i), *mHandle);
 
 			familyRefList.emplace_back(familyRef);
@@ -42,9 +50,20 @@ VK_NAMESPACE::Context::Context(const ContextCreateInfo& info)
 	}
 
 	// Creating a working class...
-	mWorkingClass = std::shared_ptr<WorkingClass>(new WorkingClass(workers, indices, queueCapabilities, mDeviceInfo->PhysicalDevice.QueueProps, mHandle));
+	mWorkingClass = std::shared_ptr<WorkingClass>(new WorkingClass(workers, indices, queueCapabilities,
+		mDeviceInfo->PhysicalDevice.QueueProps, mHandle, mDeviceInfo->ExclusiveQueueSubmission));
 
 	mDescPoolBuilder = { mHandle };
+
+	mMemoryAllocator = std::make_shared<Core::DeviceMemoryAllocator>(mHandle, mDeviceInfo->PhysicalDevice.Handle);
+
+	if (mDeviceInfo->RecycleBuffers)
+		mBufferRecycler = std::make_shared<Core::BufferRecycler>(mHandle);
+
+	mLayoutCache = std::make_shared<Core::DescriptorLayoutCache>(mHandle);
+
+	mPipelineCache = std::make_shared<Core::PipelineCacheStore>(mHandle,
+		mDeviceInfo->PhysicalDevice.Props, mDeviceInfo->PipelineCachePath);
 }
 
 VK_NAMESPACE::Core::Ref<vk::Semaphore> VK_NAMESPACE::Context::CreateSemaphore() const
@@ -63,6 +82,12 @@ VK_NAMESPACE::Core::Ref<vk::Fence> VK_NAMESPACE::Context::CreateFence(bool Signa
 	{ Device->destroyFence(fence); }, Core::Utils::CreateFence(*mHandle, Signaled));
 }
 
+std::shared_ptr<VK_NAMESPACE::Core::FenceReactor> VK_NAMESPACE::Context::CreateFenceReactor(
+	std::chrono::nanoseconds pollInterval /*= std::chrono::microseconds(200)*/) const
+{
+	return std::make_shared<Core::FenceReactor>(Core::DeviceFenceBackend{ mHandle }, pollInterval);
+}
+
 VK_NAMESPACE::Core::Ref<vk::Event> VK_NAMESPACE::Context::CreateEvent() const
 {
 	auto Device = mHandle;
@@ -98,7 +123,13 @@ VK_NAMESPACE::CommandPools VK_NAMESPACE::Context::CreateCommandPools(
 	if (IsProtected)
 		CreationFlags |= vk::CommandPoolCreateFlagBits::eProtected;
 
-	return { mHandle, mWorkingClass->GetWorkerFamilyIndices(), CreationFlags, GetWorkingClass()};
+	return { mHandle, mWorkingClass->GetWorkerFamilyIndices(), CreationFlags, GetWorkingClass(), mBufferRecycler };
+}
+
+std::shared_ptr<VK_NAMESPACE::Core::CommandRecycler> VK_NAMESPACE::Context::CreateCommandRecycler(
+	uint32_t familyIndex, uint32_t framesInFlight) const
+{
+	return std::make_shared<Core::CommandRecycler>(Core::DeviceCommandBackend{ mHandle, familyIndex }, framesInFlight);
 }
 
 VK_NAMESPACE::PipelineBuilder VK_NAMESPACE::Context::MakePipelineBuilder() const
@@ -108,26 +139,30 @@ VK_NAMESPACE::PipelineBuilder VK_NAMESPACE::Context::MakePipelineBuilder() const
 	builder.mResourcePool = CreateResourcePool();
 
 	PipelineBuilderData data{};
-	vk::PipelineCacheCreateInfo cacheInfo{};
-	data.Cache = mHandle->createPipelineCache(cacheInfo);
+	data.Cache = mPipelineCache->GetHandle();
 
-	auto Device = mHandle;
+	auto PipelineCache = mPipelineCache;
 
-	builder.mData = Core::CreateRef<PipelineBuilderData>([Device](const PipelineBuilderData& builderData)
-	{
-		Device->destroyPipelineCache(builderData.Cache);
-	}, data);
+	// the cache is owned by the store, the builder only keeps it alive
+	builder.mData = Core::CreateRef<PipelineBuilderData>([PipelineCache](const PipelineBuilderData&) {}, data);
 
 	builder.mDevice = mHandle;
 	builder.mDescPoolManager = FetchDescriptorPoolManager();
+	builder.mLayoutCache = mLayoutCache;
 
 	return builder;
 }
 
+std::expected<size_t, VK_NAMESPACE::Core::PipelineCacheError> VK_NAMESPACE::Context::SavePipelineCache() const
+{
+	return mPipelineCache->Save();
+}
+
 VK_NAMESPACE::DescriptorPoolManager VK_NAMESPACE::Context::FetchDescriptorPoolManager() const
 {
 	DescriptorPoolManager manager;
 	manager.mPoolBuilder = mDescPoolBuilder;
+	manager.mLayoutCache = mLayoutCache;
 
 	return manager;
 }
@@ -140,10 +175,23 @@ VK_NAMESPACE::ResourcePool VK_NAMESPACE::Context::CreateResourcePool() const
 	pool.mBufferCommandPools = CreateCommandPools(true);
 	pool.mImageCommandPools = CreateCommandPools(true);
 	pool.mWorkingClass = mWorkingClass;
+	pool.mMemoryAllocator = mMemoryAllocator;
+	pool.mBufferRecycler = mBufferRecycler;
 
 	return pool;
 }
 
+void VK_NAMESPACE::Context::UpdateMemoryBudget() const
+{
+	bool budgetExtension = std::ranges::any_of(mDeviceInfo->Extensions, [](const char* extension)
+	{
+		return std::strcmp(extension, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0;
+	});
+
+	GetMemoryTelemetry()->SetHeapBudgets(Core::MemoryTelemetry::QueryHeapBudgets(
+		mDeviceInfo->PhysicalDevice.Handle, budgetExtension));
+}
+
 VK_NAMESPACE::RenderContextBuilder VK_NAMESPACE::Context::FetchRenderContextBuilder(vk::PipelineBindPoint bindPoint)
 {
 	RenderContextBuilder Context;
@@ -152,6 +200,7 @@ VK_NAMESPACE::RenderContextBuilder VK_NAMESPACE::Context::FetchRenderContextBuil
 	Context.mQueueManager = GetWorkingClass();
 	Context.mCommandPools = CreateCommandPools(true);
 	Context.mBindPoint = bindPoint;
+	Context.mMemoryAllocator = mMemoryAllocator;
 
 	return Context;
 }
@@ -182,4 +231,18 @@ void VK_NAMESPACE::Context::DoSanityChecks()
 
 	if (found == extensions.end())
 		extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+
+	// optional, UpdateMemoryBudget falls back to the heap sizes without it
+	// the budget is read through vkGetPhysicalDeviceMemoryProperties2 which is core since 1.1
+	auto physicalDevice = mDeviceInfo->PhysicalDevice.Handle;
+	bool budgetQueryable = physicalDevice.getProperties().apiVersion >= VK_API_VERSION_1_1;
+
+	auto isBudgetExtension = [](const char* extension)
+	{ return std::strcmp(extension, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0; };
+
+	bool budgetSupported = std::ranges::any_of(physicalDevice.enumerateDeviceExtensionProperties(),
+		[&isBudgetExtension](const vk::ExtensionProperties& props) { return isBudgetExtension(props.extensionName); });
+
+	if (budgetQueryable && budgetSupported && std::ranges::none_of(extensions, isBudgetExtension))
+		extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
 }
@@ -0,0 +1,334 @@
+#include "Core/vkpch.h"
+#include "Memory/BufferRecycler.h"
+#include "Memory/MemoryConfig.h"
+#include "Memory/DeviceMemoryAllocator.h"
+
+namespace
+{
+	vk::DeviceSize ComputeSizeClass(const VK_NAMESPACE::VK_CORE::BufferRecyclerConfig& config, vk::DeviceSize size)
+	{
+		if (size > config.MaxSizeClass)
+			return size;
+
+		if (size <= config.MinSizeClass)
+			return config.MinSizeClass;
+
+		vk::DeviceSize step = std::max<vk::DeviceSize>(std::bit_floor(size) / 4, 1);
+
+		return (size + step - 1) / step * step;
+	}
+}
+
+size_t VK_NAMESPACE::VK_CORE::BufferRecycler::ClassKeyHasher::operator()(const ClassKey& key) const
+{
+	size_t seed = 0;
+
+	HashCombine(seed, key.Owner);
+	HashCombine(seed, static_cast<VkBufferUsageFlags>(key.Usage));
+	HashCombine(seed, static_cast<VkMemoryPropertyFlags>(key.MemProps));
+	HashCombine(seed, key.Size);
+
+	return seed;
+}
+
+VK_NAMESPACE::VK_CORE::BufferRecycler::BufferRecycler(Ref<vk::Device> device,
+	const BufferRecyclerConfig& config /*= {}*/)
+	: mDevice(device), mConfig(config) {}
+
+VK_NAMESPACE::VK_CORE::BufferRecycler::~BufferRecycler()
+{
+	std::scoped_lock locker(mLock);
+	TrimUnlocked(0);
+
+	// the recycler goes down with its context, nothing in flight is left at this point
+	for (auto& pending : mPending)
+		DestroyPending(pending.Handle);
+
+	for (auto& batch : mInFlight)
+	{
+		for (auto& pending : batch.Buffers)
+			DestroyPending(pending.Handle);
+	}
+}
+
+vk::DeviceSize VK_NAMESPACE::VK_CORE::BufferRecycler::GetSizeClass(vk::DeviceSize size) const
+{
+	std::scoped_lock locker(mLock);
+	return ComputeSizeClass(mConfig, size);
+}
+
+std::optional<VK_NAMESPACE::VK_CORE::Buffer> VK_NAMESPACE::VK_CORE::BufferRecycler::Acquire(const BufferConfig& config)
+{
+	std::scoped_lock locker(mLock);
+
+	ReclaimUnlocked();
+
+	auto found = mFreeLists.find({ config.ResourceOwner, config.Usage, config.MemProps, config.DeviceSize });
+
+	if (found == mFreeLists.end() || found->second.empty())
+	{
+		mStats.Misses++;
+		return std::nullopt;
+	}
+
+	Buffer buffer = std::move(found->second.back());
+	found->second.pop_back();
+
+	mStats.Hits++;
+	mStats.PooledSize -= buffer.MemReq.size;
+	mStats.PooledBuffers--;
+
+	// the memory was taken from the parked buffer's allocator, it has to go back there
+	auto allocator = buffer.Config.Allocator;
+
+	buffer.Config = config;
+	buffer.Config.Allocator = allocator;
+
+	Retag(buffer, config.Tag);
+
+	return buffer;
+}
+
+bool VK_NAMESPACE::VK_CORE::BufferRecycler::Release(const Buffer& buffer)
+{
+	if (!buffer.Handle)
+		return false;
+
+	std::scoped_lock locker(mLock);
+
+	// only buffers created at a size class can serve a later request
+	if (ComputeSizeClass(mConfig, buffer.CreatedSize) != buffer.CreatedSize ||
+		buffer.CreatedSize > mConfig.MaxSizeClass)
+	{
+		mStats.Rejected++;
+		return false;
+	}
+
+	// pending buffers hold on to their memory just as much as parked ones do
+	if (mStats.PooledSize + mStats.PendingSize + buffer.MemReq.size > mConfig.MaxPooledSize)
+	{
+		mStats.Rejected++;
+		return false;
+	}
+
+	// the GPU may still read it, it's parked once the fence of its last submission signals
+	Buffer& parked = mPending.emplace_back(buffer, mReleaseSerial++).Handle;
+
+	// a parked buffer referencing its recycler would keep it alive forever
+	parked.Config.Recycler.reset();
+	parked.BufferSize = 0;
+	parked.DirtyRanges.Clear();
+
+	Retag(parked, sMemoryTag);
+
+	mStats.Recycled++;
+	mStats.PendingSize += parked.MemReq.size;
+	mStats.PendingBuffers++;
+
+	return true;
+}
+
+void VK_NAMESPACE::VK_CORE::BufferRecycler::Retire(vk::ArrayProxy<vk::Fence> fences)
+{
+	std::scoped_lock locker(mLock);
+
+	if (mPending.empty())
+		return;
+
+	std::vector<vk::Fence> waitFences;
+
+	for (vk::Fence fence : fences)
+	{
+		if (fence)
+			waitFences.push_back(fence);
+	}
+
+	if (waitFences.empty())
+	{
+		for (auto& pending : mPending)
+			Park(std::move(pending.Handle));
+
+		mPending.clear();
+		return;
+	}
+
+	mInFlight.emplace_back(std::move(waitFences), std::move(mPending));
+	mPending.clear();
+}
+
+uint64_t VK_NAMESPACE::VK_CORE::BufferRecycler::GetReleaseSerial() const
+{
+	std::scoped_lock locker(mLock);
+	return mReleaseSerial;
+}
+
+void VK_NAMESPACE::VK_CORE::BufferRecycler::MarkIdle(uint64_t serial)
+{
+	std::scoped_lock locker(mLock);
+
+	// anything released after serial may belong to a submission made after the device went idle
+	auto parkReleased = [this, serial](std::vector<PendingBuffer>& buffers)
+	{
+		std::erase_if(buffers, [this, serial](PendingBuffer& pending)
+		{
+			if (pending.Serial >= serial)
+				return false;
+
+			Park(std::move(pending.Handle));
+			return true;
+		});
+	};
+
+	parkReleased(mPending);
+
+	for (auto& batch : mInFlight)
+		parkReleased(batch.Buffers);
+
+	std::erase_if(mInFlight, [](const RetireBatch& batch) { return batch.Buffers.empty(); });
+}
+
+void VK_NAMESPACE::VK_CORE::BufferRecycler::Trim(vk::DeviceSize maxPooledSize /*= 0*/)
+{
+	std::scoped_lock locker(mLock);
+
+	ReclaimUnlocked();
+	TrimUnlocked(maxPooledSize);
+}
+
+void VK_NAMESPACE::VK_CORE::BufferRecycler::SetConfig(const BufferRecyclerConfig& config)
+{
+	std::scoped_lock locker(mLock);
+
+	mConfig = config;
+
+	for (auto& [key, freeList] : mFreeLists)
+	{
+		// classes that no longer exist would never be handed out again
+		size_t keep = ComputeSizeClass(mConfig, key.Size) == key.Size && key.Size <= mConfig.MaxSizeClass ?
+			mConfig.MaxBuffersPerClass : 0;
+
+		while (freeList.size() > keep)
+		{
+			Destroy(freeList.back());
+			freeList.pop_back();
+		}
+	}
+
+	TrimUnlocked(mConfig.MaxPooledSize);
+}
+
+VK_NAMESPACE::VK_CORE::BufferRecyclerConfig VK_NAMESPACE::VK_CORE::BufferRecycler::GetConfig() const
+{
+	std::scoped_lock locker(mLock);
+	return mConfig;
+}
+
+VK_NAMESPACE::VK_CORE::BufferRecyclerStats VK_NAMESPACE::VK_CORE::BufferRecycler::GetStats() const
+{
+	std::scoped_lock locker(mLock);
+	return mStats;
+}
+
+void VK_NAMESPACE::VK_CORE::BufferRecycler::TrimUnlocked(vk::DeviceSize maxPooledSize)
+{
+	if (mStats.PooledSize <= maxPooledSize)
+		return;
+
+	std::vector<ClassKey> keys;
+	keys.reserve(mFreeLists.size());
+
+	for (const auto& [key, freeList] : mFreeLists)
+		keys.push_back(key);
+
+	// fewest destructions for the most memory
+	std::ranges::sort(keys, std::ranges::greater{}, &ClassKey::Size);
+
+	for (const auto& key : keys)
+	{
+		auto& freeList = mFreeLists[key];
+
+		while (!freeList.empty() && mStats.PooledSize > maxPooledSize)
+		{
+			Destroy(freeList.back());
+			freeList.pop_back();
+		}
+
+		if (freeList.empty())
+			mFreeLists.erase(key);
+
+		if (mStats.PooledSize <= maxPooledSize)
+			return;
+	}
+}
+
+void VK_NAMESPACE::VK_CORE::BufferRecycler::Destroy(Buffer& buffer)
+{
+	mStats.Trimmed++;
+	mStats.PooledSize -= buffer.MemReq.size;
+	mStats.PooledBuffers--;
+
+	// the recycler reference was dropped when the buffer got parked, this really destroys it
+	Utils::DestroyBuffer(*mDevice, buffer);
+}
+
+void VK_NAMESPACE::VK_CORE::BufferRecycler::ReclaimUnlocked()
+{
+	// batches of different queues may complete out of order
+	std::erase_if(mInFlight, [this](RetireBatch& batch)
+	{
+		bool signaled = std::ranges::all_of(batch.Fences, [this](vk::Fence fence)
+			{ return mDevice->getFenceStatus(fence) == vk::Result::eSuccess; });
+
+		if (!signaled)
+			return false;
+
+		for (auto& pending : batch.Buffers)
+			Park(std::move(pending.Handle));
+
+		return true;
+	});
+}
+
+void VK_NAMESPACE::VK_CORE::BufferRecycler::Park(Buffer&& buffer)
+{
+	mStats.PendingSize -= buffer.MemReq.size;
+	mStats.PendingBuffers--;
+
+	ClassKey key = MakeKey(buffer);
+	auto& freeList = mFreeLists[key];
+
+	// the caps may have changed while the buffer was pending
+	if (freeList.size() >= mConfig.MaxBuffersPerClass ||
+		ComputeSizeClass(mConfig, key.Size) != key.Size || key.Size > mConfig.MaxSizeClass)
+	{
+		mStats.Trimmed++;
+		Utils::DestroyBuffer(*mDevice, buffer);
+		return;
+	}
+
+	mStats.PooledSize += buffer.MemReq.size;
+	mStats.PooledBuffers++;
+
+	freeList.push_back(std::move(buffer));
+}
+
+void VK_NAMESPACE::VK_CORE::BufferRecycler::DestroyPending(Buffer& buffer)
+{
+	mStats.Trimmed++;
+	mStats.PendingSize -= buffer.MemReq.size;
+	mStats.PendingBuffers--;
+
+	Utils::DestroyBuffer(*mDevice, buffer);
+}
+
+void VK_NAMESPACE::VK_CORE::BufferRecycler::Retag(Buffer& buffer, std::string_view tag)
+{
+	if (!buffer.Config.Allocator)
+		return;
+
+	auto telemetry = buffer.Config.Allocator->GetTelemetry();
+	uint32_t tagID = telemetry->RegisterTag(tag);
+
+	telemetry->RecordRetag(buffer.Allocation.MemoryTypeIndex, buffer.Allocation.Tag, tagID, buffer.Allocation.Size);
+	buffer.Allocation.Tag = tagID;
+}
@@ -0,0 +1,269 @@
+#include "Core/vkpch.h"
+#include "Memory/DeviceMemoryAllocator.h"
+
+VK_NAMESPACE::VK_CORE::DeviceMemoryAllocator::DeviceMemoryAllocator(Ref<vk::Device> device,
+	vk::PhysicalDevice physicalDevice, vk::DeviceSize blockSize /*= sDefaultBlockSize*/)
+	: mDevice(device), mPhysicalDevice(physicalDevice), mBlockSize(blockSize)
+{
+	mMemoryProps = physicalDevice.getMemoryProperties();
+	mNonCoherentAtomSize = std::max<vk::DeviceSize>(physicalDevice.getProperties().limits.nonCoherentAtomSize, 1);
+	mTelemetry = std::make_shared<MemoryTelemetry>(mMemoryProps);
+
+	// two pools per memory type, linear and optimal resources
+	mPools.resize(mMemoryProps.memoryTypeCount * 2);
+
+	for (uint32_t i = 0; i < mMemoryProps.memoryTypeCount; i++)
+	{
+		vk::DeviceSize heapSize = mMemoryProps.memoryHeaps[mMemoryProps.memoryTypes[i].heapIndex].size;
+
+		// small heaps (BAR memory and the likes) get smaller blocks so one block can't eat the heap
+		vk::DeviceSize poolBlockSize = std::min(mBlockSize, std::bit_floor(std::max<vk::DeviceSize>(heapSize / 8, 1)));
+
+		for (uint32_t linear = 0; linear < 2; linear++)
+		{
+			mPools[i * 2 + linear].MemoryTypeIndex = i;
+			mPools[i * 2 + linear].BlockSize = poolBlockSize;
+		}
+	}
+}
+
+VK_NAMESPACE::VK_CORE::DeviceMemoryAllocator::~DeviceMemoryAllocator()
+{
+	for (auto& pool : mPools)
+	{
+		for (auto& block : pool.Blocks)
+		{
+			if (!block)
+				continue;
+
+			_STL_ASSERT(block->Bookkeeping.IsEmpty(), "DeviceMemoryAllocator destroyed while sub allocations are still alive");
+			DestroyBlock(*block);
+		}
+	}
+}
+
+VK_NAMESPACE::VK_CORE::MemoryAllocation VK_NAMESPACE::VK_CORE::DeviceMemoryAllocator::Allocate(
+	const vk::MemoryRequirements& memReq, vk::MemoryPropertyFlags props, bool linear, std::string_view tag /*= {}*/)
+{
+	uint32_t memoryTypeIndex = Utils::FindMemoryTypeIndex(mPhysicalDevice, memReq.memoryTypeBits, props);
+
+	_STL_VERIFY(memoryTypeIndex != static_cast<uint32_t>(-1), "No memory type satisfies the requested properties");
+
+	vk::DeviceSize alignment = std::max<vk::DeviceSize>(memReq.alignment, 1);
+	vk::DeviceSize size = memReq.size;
+
+	// flushes of non coherent memory have to cover whole atoms, keep neighbours out of ours
+	if (IsHostVisible(memoryTypeIndex) && !IsHostCoherent(memoryTypeIndex))
+	{
+		alignment = std::max(alignment, mNonCoherentAtomSize);
+		size = (size + mNonCoherentAtomSize - 1) / mNonCoherentAtomSize * mNonCoherentAtomSize;
+	}
+
+	uint32_t poolIndex = memoryTypeIndex * 2 + (linear ? 1 : 0);
+	MemoryPool& pool = mPools[poolIndex];
+
+	MemoryAllocation allocation{};
+
+	if (size > pool.BlockSize / 2)
+		allocation = AllocateDedicated(memReq.size, memoryTypeIndex);
+	else
+	{
+		std::scoped_lock locker(mLock);
+		allocation = AllocateFromPool(pool, poolIndex, size, alignment);
+	}
+
+	allocation.Tag = mTelemetry->RegisterTag(tag);
+	mTelemetry->RecordAllocation(memoryTypeIndex, allocation.Tag, allocation.Size);
+
+	return allocation;
+}
+
+void VK_NAMESPACE::VK_CORE::DeviceMemoryAllocator::Free(const MemoryAllocation& allocation)
+{
+	if (!allocation.Memory)
+		return;
+
+	mTelemetry->RecordFree(allocation.MemoryTypeIndex, allocation.Tag, allocation.Size);
+
+	if (allocation.IsDedicated())
+	{
+		mTelemetry->RecordRelease(allocation.MemoryTypeIndex, allocation.Size);
+
+		mDevice->freeMemory(allocation.Memory);
+		mDedicatedCount.fetch_sub(1, std::memory_order_relaxed);
+		return;
+	}
+
+	std::scoped_lock locker(mLock);
+
+	MemoryPool& pool = mPools[allocation.PoolIndex];
+	MemoryBlock& block = *pool.Blocks[allocation.BlockIndex];
+
+	block.Bookkeeping.Free(allocation.Node);
+
+	if (!block.Bookkeeping.IsEmpty())
+		return;
+
+	// keep one empty block around per pool so a free/allocate ping pong doesn't hit the driver
+	size_t emptyBlocks = std::ranges::count_if(pool.Blocks, [](const std::unique_ptr<MemoryBlock>& other)
+	{
+		return other && other->Bookkeeping.IsEmpty();
+	});
+
+	if (emptyBlocks > 1)
+	{
+		DestroyBlock(block);
+		pool.Blocks[allocation.BlockIndex].reset();
+	}
+}
+
+size_t VK_NAMESPACE::VK_CORE::DeviceMemoryAllocator::GetBlockCount() const
+{
+	std::scoped_lock locker(mLock);
+
+	size_t count = 0;
+
+	for (const auto& pool : mPools)
+		count += std::ranges::count_if(pool.Blocks, [](const auto& block) { return static_cast<bool>(block); });
+
+	return count;
+}
+
+vk::DeviceSize VK_NAMESPACE::VK_CORE::DeviceMemoryAllocator::GetReservedSize() const
+{
+	std::scoped_lock locker(mLock);
+
+	vk::DeviceSize size = 0;
+
+	for (const auto& pool : mPools)
+		for (const auto& block : pool.Blocks)
+			size += block ? block->Bookkeeping.GetSize() : 0;
+
+	return size;
+}
+
+vk::DeviceSize VK_NAMESPACE::VK_CORE::DeviceMemoryAllocator::GetUsedSize() const
+{
+	std::scoped_lock locker(mLock);
+
+	vk::DeviceSize size = 0;
+
+	for (const auto& pool : mPools)
+		for (const auto& block : pool.Blocks)
+			size += block ? block->Bookkeeping.GetUsedSize() : 0;
+
+	return size;
+}
+
+VK_NAMESPACE::VK_CORE::MemoryAllocation VK_NAMESPACE::VK_CORE::DeviceMemoryAllocator::AllocateDedicated(
+	vk::DeviceSize size, uint32_t memoryTypeIndex)
+{
+	vk::MemoryAllocateInfo allocInfo{};
+	allocInfo.setAllocationSize(size);
+	allocInfo.setMemoryTypeIndex(memoryTypeIndex);
+
+	MemoryAllocation allocation{};
+	allocation.Memory = mDevice->allocateMemory(allocInfo);
+	allocation.Offset = 0;
+	allocation.Size = size;
+	allocation.MemoryTypeIndex = memoryTypeIndex;
+
+	mDedicatedCount.fetch_add(1, std::memory_order_relaxed);
+	mTelemetry->RecordReservation(memoryTypeIndex, size);
+
+	return allocation;
+}
+
+VK_NAMESPACE::VK_CORE::MemoryAllocation VK_NAMESPACE::VK_CORE::DeviceMemoryAllocator::AllocateFromPool(
+	MemoryPool& pool, uint32_t poolIndex, vk::DeviceSize size, vk::DeviceSize alignment)
+{
+	TLSFAllocator::Allocation range{};
+	MemoryBlock* block = nullptr;
+	uint32_t blockIndex = 0;
+
+	for (; blockIndex < pool.Blocks.size(); blockIndex++)
+	{
+		if (!pool.Blocks[blockIndex])
+			continue;
+
+		range = pool.Blocks[blockIndex]->Bookkeeping.Allocate(size, alignment);
+
+		if (range)
+		{
+			block = pool.Blocks[blockIndex].get();
+			break;
+		}
+	}
+
+	if (!block)
+	{
+		block = CreateBlock(pool, blockIndex);
+		range = block->Bookkeeping.Allocate(size, alignment);
+
+		_STL_ASSERT(range, "A fresh memory block couldn't satisfy the sub allocation");
+	}
+
+	MemoryAllocation allocation{};
+	allocation.Memory = block->Memory;
+	allocation.Offset = range.Offset;
+	allocation.Size = range.Size;
+	allocation.MemoryTypeIndex = pool.MemoryTypeIndex;
+	allocation.PoolIndex = poolIndex;
+	allocation.BlockIndex = blockIndex;
+	allocation.Node = range.Node;
+	allocation.MappedData = block->MappedData ? block->MappedData + range.Offset : nullptr;
+
+	return allocation;
+}
+
+VK_NAMESPACE::VK_CORE::DeviceMemoryAllocator::MemoryBlock* VK_NAMESPACE::VK_CORE::DeviceMemoryAllocator::CreateBlock(
+	MemoryPool& pool, uint32_t& blockIndex)
+{
+	vk::MemoryAllocateInfo allocInfo{};
+	allocInfo.setAllocationSize(pool.BlockSize);
+	allocInfo.setMemoryTypeIndex(pool.MemoryTypeIndex);
+
+	auto block = std::make_unique<MemoryBlock>();
+	block->Memory = mDevice->allocateMemory(allocInfo);
+	block->Bookkeeping = TLSFAllocator(pool.BlockSize);
+	block->MemoryTypeIndex = pool.MemoryTypeIndex;
+
+	mTelemetry->RecordReservation(pool.MemoryTypeIndex, pool.BlockSize);
+
+	if (IsHostVisible(pool.MemoryTypeIndex))
+		block->MappedData = static_cast<std::byte*>(mDevice->mapMemory(block->Memory, 0, VK_WHOLE_SIZE));
+
+	// reuse a slot released earlier so the indices stay small
+	auto found = std::ranges::find_if(pool.Blocks, [](const auto& slot) { return !slot; });
+
+	blockIndex = static_cast<uint32_t>(found - pool.Blocks.begin());
+
+	if (found == pool.Blocks.end())
+		pool.Blocks.emplace_back();
+
+	pool.Blocks[blockIndex] = std::move(block);
+
+	return pool.Blocks[blockIndex].get();
+}
+
+void VK_NAMESPACE::VK_CORE::DeviceMemoryAllocator::DestroyBlock(MemoryBlock& block)
+{
+	if (block.MappedData)
+		mDevice->unmapMemory(block.Memory);
+
+	mDevice->freeMemory(block.Memory);
+	mTelemetry->RecordRelease(block.MemoryTypeIndex, block.Bookkeeping.GetSize());
+
+	block.Memory = nullptr;
+	block.MappedData = nullptr;
+}
+
+bool VK_NAMESPACE::VK_CORE::DeviceMemoryAllocator::IsHostVisible(uint32_t memoryTypeIndex) const
+{
+	return static_cast<bool>(mMemoryProps.memoryTypes[memoryTypeIndex].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible);
+}
+
+bool VK_NAMESPACE::VK_CORE::DeviceMemoryAllocator::IsHostCoherent(uint32_t memoryTypeIndex) const
+{
+	return static_cast<bool>(mMemoryProps.memoryTypes[memoryTypeIndex].propertyFlags & vk::MemoryPropertyFlagBits::eHostCoherent);
+}
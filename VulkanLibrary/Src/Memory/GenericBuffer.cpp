@@ -3,18 +3,18 @@
 
 void VK_NAMESPACE::Buffer<bool>::UnmapMemory() const
 {
-	mChunk.Device->unmapMemory(mChunk.BufferHandles->Memory);
-
-	if (mChunk.BufferHandles->Config.MemProps & vk::MemoryPropertyFlagBits::eHostCoherent)
-		return;
+	// Synchronizes manually in case the underlying memory isn't HostCoherent
+	Core::Utils::UnmapBufferMemory(*mChunk.Device, *mChunk.BufferHandles);
+}
 
-	// Synchronize manually in case the underlying memory isn't HostCoherent
-	vk::MappedMemoryRange range{};
-	range.setMemory(mChunk.BufferHandles->Memory);
-	range.setOffset(0);
-	range.setSize(mChunk.BufferHandles->BufferSize);
+void VK_NAMESPACE::Buffer<bool>::MarkDirty(size_t Count, size_t Offset) const
+{
+	Core::Utils::MarkBufferDirty(*mChunk.BufferHandles, Offset, Count);
+}
 
-	mChunk.Device->flushMappedMemoryRanges(range);
+void VK_NAMESPACE::Buffer<bool>::FlushMappedRanges() const
+{
+	Core::Utils::FlushBufferRanges(*mChunk.Device, *mChunk.BufferHandles);
 }
 
 void VK_NAMESPACE::Buffer<bool>::InsertMemoryBarrier(vk::CommandBuffer commandBuffer, const MemoryBarrierInfo& pipelineBarrierInfo)
@@ -91,9 +91,14 @@ void VK_NAMESPACE::Buffer<bool>::ScaleCapacityWithoutLoss(size_t NewSize)
 	vk::BufferCopy CopyRegion{};
 	CopyRegion.setSize(mChunk.BufferHandles->BufferSize);
 
-	// Recover the past
+	// Recover the past, pending writes through the persistent mapping go first
+	FlushMappedRanges();
 	CopyGPU(NewBuffer, *mChunk.BufferHandles, CopyRegion);
 
+	// stale host lines of non coherent memory would be flushed back over the copy otherwise
+	if (CopyRegion.size != 0)
+		Core::Utils::InvalidateBufferMemory(*mChunk.Device, NewBuffer);
+
 	mChunk.BufferHandles.SetValue(NewBuffer);
 }
 
@@ -192,8 +197,7 @@ VK_NAMESPACE::Buffer<bool> VK_NAMESPACE::Buffer<bool>::StageBuffer(size_t count)
 	buffer.mChunk.BufferHandles = Core::CreateRef<Core::Buffer>(
 		[device](Core::Buffer& buffer)
 	{
-		device->destroyBuffer(buffer.Handle);
-		device->freeMemory(buffer.Memory);
+		Core::Utils::DestroyBuffer(*device, buffer);
 	}, Core::Utils::CreateBuffer(hostConfig));
 
 	buffer.mChunk.Device = device;
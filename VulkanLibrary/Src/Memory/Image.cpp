@@ -86,6 +86,36 @@ void VK_NAMESPACE::Image::TransitionLayout(vk::ImageLayout NewLayout, vk::Pipeli
 		mChunk->ImageHandles.Config.PrevStage };
 }
 
+VK_NAMESPACE::Core::AsyncProcess VK_NAMESPACE::Image::TransitionLayoutAsync(Core::FenceReactor& reactor,
+	vk::ImageLayout NewLayout, vk::PipelineStageFlags usageStage) const
+{
+	_STL_ASSERT(NewLayout != vk::ImageLayout::eUndefined && NewLayout != vk::ImageLayout::ePreinitialized,
+		"Can't transition image layout to Undefined or Preinitialized format!");
+
+	if (mChunk->ImageHandles.Config.CurrLayout == NewLayout)
+		return {};
+
+	uint32_t Owner = mChunk->ImageHandles.Config.ResourceOwner;
+
+	auto QueueCaps = mWorkingClass->GetFamilyCapabilities(Owner);
+
+	// the process records and submits before returning, so the tracked layout can be updated right after
+	auto Process = InvokeOneTimeProcessAsync(reactor, Owner, [this, NewLayout, usageStage, QueueCaps](vk::CommandBuffer CmdBuffer)
+		{
+			RecordTransitionLayoutInternal(NewLayout, usageStage,
+				mChunk->ImageHandles.Config.CurrLayout, mChunk->ImageHandles.Config.PrevStage,
+				CmdBuffer, QueueCaps);
+		});
+
+	mChunk->ImageHandles.Config.CurrLayout = NewLayout;
+	mChunk->ImageHandles.Config.PrevStage = usageStage;
+
+	mChunk->ImageHandles.RecordedLayout = { mChunk->ImageHandles.Config.CurrLayout,
+		mChunk->ImageHandles.Config.PrevStage };
+
+	return Process;
+}
+
 void VK_NAMESPACE::Image::BeginCommands(vk::CommandBuffer commandBuffer) const
 {
 	DefaultBegin(commandBuffer);
@@ -0,0 +1,73 @@
+#include "Core/vkpch.h"
+#include "Memory/LinearRingAllocator.h"
+
+VK_NAMESPACE::VK_CORE::LinearRingAllocator::LinearRingAllocator(uint64_t capacity)
+	: mCapacity(capacity) {}
+
+uint64_t VK_NAMESPACE::VK_CORE::LinearRingAllocator::Allocate(uint64_t size, uint64_t alignment /*= 1*/)
+{
+	_STL_ASSERT(std::has_single_bit(alignment), "LinearRingAllocator alignment must be a power of two");
+
+	if (size == 0 || size > mCapacity || mUsed == mCapacity)
+		return sInvalidOffset;
+
+	// everything got reclaimed, start over at the front for the largest contiguous run
+	if (mUsed == 0)
+		mHead = mTail = 0;
+
+	if (mHead >= mTail)
+	{
+		// free space is [head, capacity) followed by [0, tail)
+		uint64_t offset = AlignUp(mHead, alignment);
+
+		if (offset <= mCapacity && size <= mCapacity - offset)
+			return Commit(offset, size, offset + size - mHead);
+
+		// skip the tail of the ring, the wasted bytes belong to the open frame
+		if (size <= mTail)
+			return Commit(0, size, mCapacity - mHead + size);
+
+		return sInvalidOffset;
+	}
+
+	// wrapped, free space is [head, tail)
+	uint64_t offset = AlignUp(mHead, alignment);
+
+	if (offset < mTail && size <= mTail - offset)
+		return Commit(offset, size, offset + size - mHead);
+
+	return sInvalidOffset;
+}
+
+void VK_NAMESPACE::VK_CORE::LinearRingAllocator::EndFrame(uint64_t frameValue)
+{
+	_STL_ASSERT(mFrames.empty() || mFrames.back().Value <= frameValue,
+		"LinearRingAllocator frame values must not go backwards");
+
+	// an empty frame has nothing to release, don't make anyone wait on it
+	if (mOpenFrameSize == 0)
+		return;
+
+	mFrames.push_back({ frameValue, mHead, mOpenFrameSize });
+	mOpenFrameSize = 0;
+}
+
+void VK_NAMESPACE::VK_CORE::LinearRingAllocator::Reclaim(uint64_t completedValue)
+{
+	while (!mFrames.empty() && mFrames.front().Value <= completedValue)
+	{
+		mTail = mFrames.front().End;
+		mUsed -= mFrames.front().Size;
+
+		mFrames.pop_front();
+	}
+}
+
+uint64_t VK_NAMESPACE::VK_CORE::LinearRingAllocator::Commit(uint64_t offset, uint64_t size, uint64_t consumed)
+{
+	mHead = offset + size;
+	mUsed += consumed;
+	mOpenFrameSize += consumed;
+
+	return offset;
+}
@@ -0,0 +1,337 @@
+#include "Core/vkpch.h"
+#include "Memory/MemoryTelemetry.h"
+
+namespace
+{
+	void WriteJsonString(std::ostringstream& stream, std::string_view text)
+	{
+		stream << '"';
+
+		for (char c : text)
+		{
+			switch (c)
+			{
+				case '"':  stream << "\\\""; break;
+				case '\\': stream << "\\\\"; break;
+				case '\n': stream << "\\n"; break;
+				case '\r': stream << "\\r"; break;
+				case '\t': stream << "\\t"; break;
+
+				default:
+					if (static_cast<unsigned char>(c) < 0x20)
+						stream << "\\u00" << "0123456789abcdef"[c >> 4] << "0123456789abcdef"[c & 0xf];
+					else
+						stream << c;
+			}
+		}
+
+		stream << '"';
+	}
+
+	void WriteJsonUsage(std::ostringstream& stream, const VK_NAMESPACE::VK_CORE::MemoryUsage& usage)
+	{
+		stream << "{\"current\": " << usage.Current << ", \"peak\": " << usage.Peak
+			<< ", \"live_allocations\": " << usage.LiveAllocations
+			<< ", \"total_allocations\": " << usage.TotalAllocations << "}";
+	}
+}
+
+VK_NAMESPACE::VK_CORE::MemoryTelemetry::MemoryTelemetry(std::vector<uint32_t> memoryTypeHeaps, std::vector<HeapBudget> heaps)
+	: mMemoryTypeHeaps(std::move(memoryTypeHeaps))
+{
+	mHeaps.resize(heaps.size());
+
+	for (size_t i = 0; i < heaps.size(); i++)
+		mHeaps[i].Budget = heaps[i];
+
+	RegisterTag(sUntagged);
+}
+
+VK_NAMESPACE::VK_CORE::MemoryTelemetry::MemoryTelemetry(const vk::PhysicalDeviceMemoryProperties& memoryProps)
+	: MemoryTelemetry({}, {})
+{
+	for (uint32_t i = 0; i < memoryProps.memoryTypeCount; i++)
+		mMemoryTypeHeaps.push_back(memoryProps.memoryTypes[i].heapIndex);
+
+	mHeaps.resize(memoryProps.memoryHeapCount);
+
+	for (uint32_t i = 0; i < memoryProps.memoryHeapCount; i++)
+	{
+		HeapBudget& budget = mHeaps[i].Budget;
+		budget.Size = memoryProps.memoryHeaps[i].size;
+		budget.Budget = budget.Size;
+		budget.DeviceLocal = static_cast<bool>(memoryProps.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+	}
+}
+
+uint32_t VK_NAMESPACE::VK_CORE::MemoryTelemetry::RegisterTag(std::string_view name)
+{
+	if (name.empty())
+		return 0;
+
+	std::scoped_lock locker(mLock);
+
+	auto found = mTagIDs.find(std::string(name));
+
+	if (found != mTagIDs.end())
+		return found->second;
+
+	uint32_t id = static_cast<uint32_t>(mTagNames.size());
+
+	mTagNames.emplace_back(name);
+	mTagUsages.emplace_back();
+	mTagIDs.emplace(name, id);
+
+	return id;
+}
+
+void VK_NAMESPACE::VK_CORE::MemoryTelemetry::RecordAllocation(uint32_t memoryTypeIndex, uint32_t tag, vk::DeviceSize size)
+{
+	std::scoped_lock locker(mLock);
+
+	_STL_ASSERT(tag < mTagUsages.size(), "MemoryTelemetry tag was never registered");
+
+	Add(mTotal, size);
+	Add(mTagUsages[tag], size);
+	Add(mHeaps[GetHeapIndex(memoryTypeIndex)].Resources, size);
+}
+
+void VK_NAMESPACE::VK_CORE::MemoryTelemetry::RecordFree(uint32_t memoryTypeIndex, uint32_t tag, vk::DeviceSize size)
+{
+	std::scoped_lock locker(mLock);
+
+	_STL_ASSERT(tag < mTagUsages.size(), "MemoryTelemetry tag was never registered");
+
+	Remove(mTotal, size);
+	Remove(mTagUsages[tag], size);
+	Remove(mHeaps[GetHeapIndex(memoryTypeIndex)].Resources, size);
+}
+
+void VK_NAMESPACE::VK_CORE::MemoryTelemetry::RecordRetag(uint32_t memoryTypeIndex,
+	uint32_t fromTag, uint32_t toTag, vk::DeviceSize size)
+{
+	if (fromTag == toTag)
+		return;
+
+	std::scoped_lock locker(mLock);
+
+	_STL_ASSERT(fromTag < mTagUsages.size() && toTag < mTagUsages.size(),
+		"MemoryTelemetry tag was never registered");
+
+	Move(mTagUsages[fromTag], mTagUsages[toTag], size);
+}
+
+void VK_NAMESPACE::VK_CORE::MemoryTelemetry::RecordReservation(uint32_t memoryTypeIndex, vk::DeviceSize size)
+{
+	std::scoped_lock locker(mLock);
+	Add(mHeaps[GetHeapIndex(memoryTypeIndex)].Reserved, size);
+}
+
+void VK_NAMESPACE::VK_CORE::MemoryTelemetry::RecordRelease(uint32_t memoryTypeIndex, vk::DeviceSize size)
+{
+	std::scoped_lock locker(mLock);
+	Remove(mHeaps[GetHeapIndex(memoryTypeIndex)].Reserved, size);
+}
+
+void VK_NAMESPACE::VK_CORE::MemoryTelemetry::SetHeapBudgets(std::vector<HeapBudget> heaps)
+{
+	std::scoped_lock locker(mLock);
+
+	_STL_ASSERT(heaps.size() == mHeaps.size(), "MemoryTelemetry heap count changed");
+
+	for (size_t i = 0; i < std::min(heaps.size(), mHeaps.size()); i++)
+		mHeaps[i].Budget = heaps[i];
+}
+
+void VK_NAMESPACE::VK_CORE::MemoryTelemetry::ResetPeaks()
+{
+	std::scoped_lock locker(mLock);
+
+	mTotal.Peak = mTotal.Current;
+
+	for (auto& usage : mTagUsages)
+		usage.Peak = usage.Current;
+
+	for (auto& heap : mHeaps)
+	{
+		heap.Resources.Peak = heap.Resources.Current;
+		heap.Reserved.Peak = heap.Reserved.Current;
+	}
+}
+
+VK_NAMESPACE::VK_CORE::MemoryUsage VK_NAMESPACE::VK_CORE::MemoryTelemetry::GetTotalUsage() const
+{
+	std::scoped_lock locker(mLock);
+	return mTotal;
+}
+
+VK_NAMESPACE::VK_CORE::MemoryUsage VK_NAMESPACE::VK_CORE::MemoryTelemetry::GetHeapUsage(uint32_t heapIndex) const
+{
+	std::scoped_lock locker(mLock);
+	return heapIndex < mHeaps.size() ? mHeaps[heapIndex].Resources : MemoryUsage();
+}
+
+VK_NAMESPACE::VK_CORE::MemoryUsage VK_NAMESPACE::VK_CORE::MemoryTelemetry::GetHeapReservation(uint32_t heapIndex) const
+{
+	std::scoped_lock locker(mLock);
+	return heapIndex < mHeaps.size() ? mHeaps[heapIndex].Reserved : MemoryUsage();
+}
+
+VK_NAMESPACE::VK_CORE::MemoryUsage VK_NAMESPACE::VK_CORE::MemoryTelemetry::GetTagUsage(std::string_view name) const
+{
+	std::scoped_lock locker(mLock);
+
+	auto found = mTagIDs.find(std::string(name.empty() ? sUntagged : name));
+
+	return found != mTagIDs.end() ? mTagUsages[found->second] : MemoryUsage();
+}
+
+std::vector<std::pair<std::string, VK_NAMESPACE::VK_CORE::MemoryUsage>>
+	VK_NAMESPACE::VK_CORE::MemoryTelemetry::GetTagUsages() const
+{
+	std::scoped_lock locker(mLock);
+
+	std::vector<std::pair<std::string, MemoryUsage>> usages;
+	usages.reserve(mTagNames.size());
+
+	for (size_t i = 0; i < mTagNames.size(); i++)
+		usages.emplace_back(mTagNames[i], mTagUsages[i]);
+
+	return usages;
+}
+
+std::vector<VK_NAMESPACE::VK_CORE::HeapBudget> VK_NAMESPACE::VK_CORE::MemoryTelemetry::GetHeapBudgets() const
+{
+	std::scoped_lock locker(mLock);
+
+	std::vector<HeapBudget> budgets;
+	budgets.reserve(mHeaps.size());
+
+	for (const auto& heap : mHeaps)
+	{
+		HeapBudget& budget = budgets.emplace_back(heap.Budget);
+
+		// without the extension our own reservations are the best guess we have
+		if (!budget.FromExtension)
+			budget.Usage = heap.Reserved.Current;
+	}
+
+	return budgets;
+}
+
+std::string VK_NAMESPACE::VK_CORE::MemoryTelemetry::DumpJson() const
+{
+	std::vector<HeapBudget> budgets = GetHeapBudgets();
+
+	std::scoped_lock locker(mLock);
+
+	std::ostringstream stream;
+
+	stream << "{\n\t\"total\": ";
+	WriteJsonUsage(stream, mTotal);
+
+	stream << ",\n\t\"heaps\": [";
+
+	for (size_t i = 0; i < mHeaps.size(); i++)
+	{
+		const HeapBudget& budget = budgets[i];
+
+		stream << (i == 0 ? "\n" : ",\n") << "\t\t{\"index\": " << i
+			<< ", \"size\": " << budget.Size
+			<< ", \"budget\": " << budget.Budget
+			<< ", \"usage\": " << budget.Usage
+			<< ", \"budget_source\": " << (budget.FromExtension ? "\"VK_EXT_memory_budget\"" : "\"heap_size\"")
+			<< ", \"device_local\": " << (budget.DeviceLocal ? "true" : "false")
+			<< ", \"reserved\": ";
+
+		WriteJsonUsage(stream, mHeaps[i].Reserved);
+		stream << ", \"resources\": ";
+		WriteJsonUsage(stream, mHeaps[i].Resources);
+		stream << "}";
+	}
+
+	stream << (mHeaps.empty() ? "]" : "\n\t]") << ",\n\t\"tags\": {";
+
+	for (size_t i = 0; i < mTagNames.size(); i++)
+	{
+		stream << (i == 0 ? "\n\t\t" : ",\n\t\t");
+		WriteJsonString(stream, mTagNames[i]);
+		stream << ": ";
+		WriteJsonUsage(stream, mTagUsages[i]);
+	}
+
+	stream << (mTagNames.empty() ? "}" : "\n\t}") << "\n}\n";
+
+	return stream.str();
+}
+
+std::vector<VK_NAMESPACE::VK_CORE::HeapBudget> VK_NAMESPACE::VK_CORE::MemoryTelemetry::QueryHeapBudgets(
+	vk::PhysicalDevice physicalDevice, bool budgetExtension)
+{
+	std::vector<HeapBudget> heaps;
+
+	if (!budgetExtension)
+	{
+		auto memoryProps = physicalDevice.getMemoryProperties();
+
+		for (uint32_t i = 0; i < memoryProps.memoryHeapCount; i++)
+		{
+			HeapBudget& heap = heaps.emplace_back();
+			heap.Size = memoryProps.memoryHeaps[i].size;
+			heap.Budget = heap.Size;
+			heap.DeviceLocal = static_cast<bool>(memoryProps.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+		}
+
+		return heaps;
+	}
+
+	auto chain = physicalDevice.getMemoryProperties2<vk::PhysicalDeviceMemoryProperties2,
+		vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+
+	const auto& memoryProps = chain.get<vk::PhysicalDeviceMemoryProperties2>().memoryProperties;
+	const auto& budgetProps = chain.get<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+
+	for (uint32_t i = 0; i < memoryProps.memoryHeapCount; i++)
+	{
+		HeapBudget& heap = heaps.emplace_back();
+		heap.Size = memoryProps.memoryHeaps[i].size;
+		heap.Budget = budgetProps.heapBudget[i];
+		heap.Usage = budgetProps.heapUsage[i];
+		heap.FromExtension = true;
+		heap.DeviceLocal = static_cast<bool>(memoryProps.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+	}
+
+	return heaps;
+}
+
+uint32_t VK_NAMESPACE::VK_CORE::MemoryTelemetry::GetHeapIndex(uint32_t memoryTypeIndex) const
+{
+	_STL_ASSERT(memoryTypeIndex < mMemoryTypeHeaps.size(), "MemoryTelemetry got an unknown memory type");
+	return mMemoryTypeHeaps[memoryTypeIndex];
+}
+
+void VK_NAMESPACE::VK_CORE::MemoryTelemetry::Add(MemoryUsage& usage, vk::DeviceSize size)
+{
+	usage.Current += size;
+	usage.Peak = std::max(usage.Peak, usage.Current);
+
+	usage.LiveAllocations++;
+	usage.TotalAllocations++;
+}
+
+void VK_NAMESPACE::VK_CORE::MemoryTelemetry::Remove(MemoryUsage& usage, vk::DeviceSize size)
+{
+	_STL_ASSERT(usage.Current >= size && usage.LiveAllocations > 0, "MemoryTelemetry freed more than was allocated");
+
+	usage.Current -= size;
+	usage.LiveAllocations--;
+}
+
+void VK_NAMESPACE::VK_CORE::MemoryTelemetry::Move(MemoryUsage& from, MemoryUsage& to, vk::DeviceSize size)
+{
+	Remove(from, size);
+
+	to.Current += size;
+	to.Peak = std::max(to.Peak, to.Current);
+	to.LiveAllocations++;
+}
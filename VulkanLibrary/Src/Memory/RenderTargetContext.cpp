@@ -169,13 +169,14 @@ VK_NAMESPACE::VK_CORE::Ref<VK_NAMESPACE::VK_CORE::ImageResource> VK_NAMESPACE::R
 	Core::ImageResource chunk{};
 	chunk.Device = mDevice;
 
+	config.Allocator = mMemoryAllocator;
+	config.Tag = sMemoryTag;
+
 	chunk.ImageHandles = Core::Utils::CreateImage(config);
 	auto Device = mDevice;
 
 	return Core::CreateRef<Core::ImageResource>([Device](Core::ImageResource& handles)
 	{
-		Device->freeMemory(handles.ImageHandles.Memory);
-		Device->destroyImage(handles.ImageHandles.Handle);
-		Device->destroyImageView(handles.ImageHandles.IdentityView);
+		Core::Utils::DestroyImage(*Device, handles.ImageHandles);
 	}, chunk);
 }
@@ -45,6 +45,8 @@ VK_NAMESPACE::Image VK_NAMESPACE::ResourcePool::CreateImage(const ImageCreateInf
 	config.Tiling = info.Tiling;
 	config.Type = info.Type;
 	config.MemProps = info.MemProps;
+	config.Allocator = mMemoryAllocator;
+	config.Tag = info.Tag.empty() ? mMemoryTag : info.Tag;
 	config.Usage = info.Usage | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst;
 
 	Core::Image Handles = Core::Utils::CreateImage(config);
@@ -56,9 +58,7 @@ VK_NAMESPACE::Image VK_NAMESPACE::ResourcePool::CreateImage(const ImageCreateInf
 	Core::Ref<Core::ImageResource> chunkRef = Core::CreateRef<Core::ImageResource>(
 		[](const Core::ImageResource& handles)
 	{
-		handles.Device->freeMemory(handles.ImageHandles.Memory);
-		handles.Device->destroyImage(handles.ImageHandles.Handle);
-		handles.Device->destroyImageView(handles.ImageHandles.IdentityView);
+		Core::Utils::DestroyImage(*handles.Device, handles.ImageHandles);
 	}, chunk);
 
 	Image image(chunkRef);
@@ -70,6 +70,46 @@ VK_NAMESPACE::Image VK_NAMESPACE::ResourcePool::CreateImage(const ImageCreateInf
 	return image;
 }
 
+VK_NAMESPACE::TransientAllocator VK_NAMESPACE::ResourcePool::CreateTransientAllocator(vk::DeviceSize capacity) const
+{
+	GenericBuffer buffer = CreateGenericBuffer(
+		vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer |
+		vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer,
+		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+
+	buffer.Reserve(capacity);
+
+	const auto& limits = mPhysicalDevice.Props.limits;
+
+	vk::DeviceSize alignment = std::max({ limits.minUniformBufferOffsetAlignment,
+		limits.minStorageBufferOffsetAlignment, vk::DeviceSize(16) });
+
+	return TransientAllocator(mDevice, buffer, alignment);
+}
+
+std::shared_ptr<VK_NAMESPACE::TransferUploader> VK_NAMESPACE::ResourcePool::CreateTransferUploader(
+	vk::DeviceSize stagingCapacity) const
+{
+	GenericBuffer staging = CreateGenericBuffer(vk::BufferUsageFlagBits::eTransferSrc,
+		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+
+	staging.Reserve(stagingCapacity);
+
+	// a dedicated transfer family runs the copies next to the graphics work, graphics families can copy too
+	uint32_t transferFamily = mWorkingClass->FindOptimalQueueFamilyIndex(vk::QueueFlagBits::eGraphics);
+
+	if (mWorkingClass->GetFamilyIndicesByCapabilityMap().contains(vk::QueueFlagBits::eTransfer))
+	{
+		uint32_t family = mWorkingClass->FindOptimalQueueFamilyIndex(vk::QueueFlagBits::eTransfer);
+
+		if (mWorkingClass->GetWorkerFamilyIndices().contains(family))
+			transferFamily = family;
+	}
+
+	return std::shared_ptr<TransferUploader>(new TransferUploader(
+		mDevice, mWorkingClass, mBufferCommandPools, staging, transferFamily));
+}
+
 VK_NAMESPACE::SamplerCache VK_NAMESPACE::ResourcePool::CreateSamplerCache() const
 {
 	SamplerCache cache = std::make_shared<BasicSamplerCachePayload<SamplerInfo>>();
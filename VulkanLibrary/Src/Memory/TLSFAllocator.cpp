@@ -0,0 +1,408 @@
+#include "Core/vkpch.h"
+#include "Memory/TLSFAllocator.h"
+
+VK_NAMESPACE::VK_CORE::TLSFAllocator::TLSFAllocator(uint64_t size)
+	: mSize(size), mFreeSize(size)
+{
+	for (auto& heads : mFreeHeads)
+		heads.fill(sInvalidNode);
+
+	if (size == 0)
+		return;
+
+	mFirstNode = CreateNode();
+	mNodes[mFirstNode].Offset = 0;
+	mNodes[mFirstNode].Size = size;
+
+	InsertFree(mFirstNode);
+}
+
+VK_NAMESPACE::VK_CORE::TLSFAllocator::Allocation VK_NAMESPACE::VK_CORE::TLSFAllocator::Allocate(
+	uint64_t size, uint64_t alignment /*= 1*/)
+{
+	_STL_ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0,
+		"TLSFAllocator::Allocate alignment must be a power of two");
+
+	size = std::max<uint64_t>(size, 1);
+
+	if (size > mFreeSize)
+		return {};
+
+	// padding the request by the alignment guarantees the range found can be aligned in place
+	NodeHandle found = FindFreeNode(size + alignment - 1);
+
+	// the padded request might overshoot while an already aligned range of the right size exists
+	if (found == sInvalidNode && alignment > 1)
+		found = FindAlignedInBucket(size, alignment);
+
+	if (found == sInvalidNode)
+		return {};
+
+	RemoveFree(found);
+
+	uint64_t alignedOffset = AlignUp(mNodes[found].Offset, alignment);
+	uint64_t padding = alignedOffset - mNodes[found].Offset;
+
+	// the front padding goes back as its own free range
+	// its previous neighbour can't be free, free ranges are always coalesced
+	if (padding != 0)
+	{
+		NodeHandle front = CreateNode();
+		Node& node = mNodes[found];
+		Node& frontNode = mNodes[front];
+
+		frontNode.Offset = node.Offset;
+		frontNode.Size = padding;
+		frontNode.PrevPhysical = node.PrevPhysical;
+		frontNode.NextPhysical = found;
+
+		if (node.PrevPhysical != sInvalidNode)
+			mNodes[node.PrevPhysical].NextPhysical = front;
+		else
+			mFirstNode = front;
+
+		node.PrevPhysical = front;
+		node.Offset = alignedOffset;
+		node.Size -= padding;
+
+		InsertFree(front);
+	}
+
+	uint64_t remaining = mNodes[found].Size - size;
+
+	if (remaining >= sMinSplitSize)
+	{
+		NodeHandle back = CreateNode();
+		Node& node = mNodes[found];
+		Node& backNode = mNodes[back];
+
+		backNode.Offset = node.Offset + size;
+		backNode.Size = remaining;
+		backNode.PrevPhysical = found;
+		backNode.NextPhysical = node.NextPhysical;
+
+		if (node.NextPhysical != sInvalidNode)
+			mNodes[node.NextPhysical].PrevPhysical = back;
+
+		node.NextPhysical = back;
+		node.Size = size;
+
+		InsertFree(back);
+	}
+
+	Node& node = mNodes[found];
+	node.Free = false;
+
+	mFreeSize -= node.Size;
+	mAllocationCount++;
+
+	return { node.Offset, node.Size, found };
+}
+
+void VK_NAMESPACE::VK_CORE::TLSFAllocator::Free(NodeHandle handle)
+{
+	_STL_ASSERT(handle < mNodes.size() && !mNodes[handle].Free,
+		"TLSFAllocator::Free called with an invalid or already freed node");
+
+	mFreeSize += mNodes[handle].Size;
+	mAllocationCount--;
+
+	// absorb the next range
+	NodeHandle next = mNodes[handle].NextPhysical;
+
+	if (next != sInvalidNode && mNodes[next].Free)
+	{
+		RemoveFree(next);
+
+		mNodes[handle].Size += mNodes[next].Size;
+		mNodes[handle].NextPhysical = mNodes[next].NextPhysical;
+
+		if (mNodes[next].NextPhysical != sInvalidNode)
+			mNodes[mNodes[next].NextPhysical].PrevPhysical = handle;
+
+		RecycleNode(next);
+	}
+
+	// get absorbed by the previous range
+	NodeHandle prev = mNodes[handle].PrevPhysical;
+
+	if (prev != sInvalidNode && mNodes[prev].Free)
+	{
+		RemoveFree(prev);
+
+		mNodes[prev].Size += mNodes[handle].Size;
+		mNodes[prev].NextPhysical = mNodes[handle].NextPhysical;
+
+		if (mNodes[handle].NextPhysical != sInvalidNode)
+			mNodes[mNodes[handle].NextPhysical].PrevPhysical = prev;
+
+		RecycleNode(handle);
+		handle = prev;
+	}
+
+	InsertFree(handle);
+}
+
+uint64_t VK_NAMESPACE::VK_CORE::TLSFAllocator::GetLargestFreeRange() const
+{
+	if (mFirstLevelBitmap == 0)
+		return 0;
+
+	// the largest range lives in the highest non empty bucket, but that bucket isn't sorted
+	uint32_t firstLevel = 63 - std::countl_zero(mFirstLevelBitmap);
+	uint32_t secondLevel = 31 - std::countl_zero(mSecondLevelBitmaps[firstLevel]);
+
+	uint64_t largest = 0;
+
+	for (NodeHandle node = mFreeHeads[firstLevel][secondLevel]; node != sInvalidNode; node = mNodes[node].NextFree)
+		largest = std::max(largest, mNodes[node].Size);
+
+	return largest;
+}
+
+uint32_t VK_NAMESPACE::VK_CORE::TLSFAllocator::GetFreeRangeCount() const
+{
+	uint32_t count = 0;
+
+	for (NodeHandle node = mFirstNode; node != sInvalidNode; node = mNodes[node].NextPhysical)
+		count += mNodes[node].Free ? 1 : 0;
+
+	return count;
+}
+
+bool VK_NAMESPACE::VK_CORE::TLSFAllocator::Validate() const
+{
+	uint64_t expectedOffset = 0;
+	uint64_t freeSize = 0;
+	uint32_t allocations = 0;
+	uint32_t freeRanges = 0;
+
+	NodeHandle prev = sInvalidNode;
+
+	for (NodeHandle node = mFirstNode; node != sInvalidNode; node = mNodes[node].NextPhysical)
+	{
+		const Node& current = mNodes[node];
+
+		// the chain must tile the whole range without gaps
+		if (current.Offset != expectedOffset || current.PrevPhysical != prev || current.Size == 0)
+			return false;
+
+		if (current.Free)
+		{
+			// two neighbouring free ranges means a missed coalesce
+			if (prev != sInvalidNode && mNodes[prev].Free)
+				return false;
+
+			uint32_t firstLevel, secondLevel;
+			Mapping(current.Size, firstLevel, secondLevel);
+
+			bool listed = false;
+
+			for (NodeHandle it = mFreeHeads[firstLevel][secondLevel]; it != sInvalidNode; it = mNodes[it].NextFree)
+				listed = listed || it == node;
+
+			if (!listed)
+				return false;
+
+			freeSize += current.Size;
+			freeRanges++;
+		}
+		else
+			allocations++;
+
+		expectedOffset += current.Size;
+		prev = node;
+	}
+
+	if (expectedOffset != mSize || freeSize != mFreeSize || allocations != mAllocationCount)
+		return false;
+
+	// every listed node must be free and every non empty list must have its bits set
+	uint32_t listedRanges = 0;
+
+	for (uint32_t firstLevel = 0; firstLevel < sFirstLevelCount; firstLevel++)
+	{
+		for (uint32_t secondLevel = 0; secondLevel < sSecondLevelCount; secondLevel++)
+		{
+			NodeHandle head = mFreeHeads[firstLevel][secondLevel];
+
+			bool bitSet = (mSecondLevelBitmaps[firstLevel] >> secondLevel) & 1;
+
+			if ((head != sInvalidNode) != bitSet)
+				return false;
+
+			for (NodeHandle it = head; it != sInvalidNode; it = mNodes[it].NextFree)
+			{
+				if (!mNodes[it].Free)
+					return false;
+
+				listedRanges++;
+			}
+		}
+
+		bool firstBitSet = (mFirstLevelBitmap >> firstLevel) & 1;
+
+		if ((mSecondLevelBitmaps[firstLevel] != 0) != firstBitSet)
+			return false;
+	}
+
+	return listedRanges == freeRanges;
+}
+
+void VK_NAMESPACE::VK_CORE::TLSFAllocator::Mapping(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+{
+	// small sizes get a linear first bucket of their own
+	if (size < sSecondLevelCount)
+	{
+		firstLevel = 0;
+		secondLevel = static_cast<uint32_t>(size);
+		return;
+	}
+
+	uint32_t topBit = 63 - std::countl_zero(size);
+
+	firstLevel = topBit - sSecondLevelLog2 + 1;
+	secondLevel = static_cast<uint32_t>(size >> (topBit - sSecondLevelLog2)) ^ sSecondLevelCount;
+}
+
+uint64_t VK_NAMESPACE::VK_CORE::TLSFAllocator::RoundUpToBucket(uint64_t size)
+{
+	if (size < sSecondLevelCount)
+		return size;
+
+	uint32_t topBit = 63 - std::countl_zero(size);
+	uint64_t round = (uint64_t(1) << (topBit - sSecondLevelLog2)) - 1;
+
+	return size + round;
+}
+
+VK_NAMESPACE::VK_CORE::TLSFAllocator::NodeHandle VK_NAMESPACE::VK_CORE::TLSFAllocator::FindFreeNode(uint64_t size) const
+{
+	uint64_t rounded = RoundUpToBucket(size);
+
+	// the rounded size overflowed past every bucket
+	if (rounded < size)
+		return sInvalidNode;
+
+	uint32_t firstLevel, secondLevel;
+	Mapping(rounded, firstLevel, secondLevel);
+
+	if (firstLevel >= sFirstLevelCount)
+		return sInvalidNode;
+
+	// any non empty bucket at or above (firstLevel, secondLevel) satisfies the request
+	uint32_t secondMap = mSecondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+
+	if (secondMap == 0)
+	{
+		uint64_t firstMap = firstLevel + 1 < 64 ? mFirstLevelBitmap & (~uint64_t(0) << (firstLevel + 1)) : 0;
+
+		if (firstMap == 0)
+			return sInvalidNode;
+
+		firstLevel = std::countr_zero(firstMap);
+		secondMap = mSecondLevelBitmaps[firstLevel];
+	}
+
+	secondLevel = std::countr_zero(secondMap);
+
+	return mFreeHeads[firstLevel][secondLevel];
+}
+
+VK_NAMESPACE::VK_CORE::TLSFAllocator::NodeHandle VK_NAMESPACE::VK_CORE::TLSFAllocator::FindAlignedInBucket(
+	uint64_t size, uint64_t alignment) const
+{
+	uint32_t firstLevel, secondLevel;
+	Mapping(size, firstLevel, secondLevel);
+
+	// the exact bucket may hold ranges either side of the request, walk it
+	for (NodeHandle node = mFreeHeads[firstLevel][secondLevel]; node != sInvalidNode; node = mNodes[node].NextFree)
+	{
+		const Node& current = mNodes[node];
+		uint64_t padding = AlignUp(current.Offset, alignment) - current.Offset;
+
+		if (current.Size >= size + padding)
+			return node;
+	}
+
+	// the head of the next bucket up is big enough for the size, but maybe not once aligned
+	NodeHandle candidate = FindFreeNode(size);
+
+	if (candidate == sInvalidNode)
+		return sInvalidNode;
+
+	const Node& current = mNodes[candidate];
+	uint64_t padding = AlignUp(current.Offset, alignment) - current.Offset;
+
+	return current.Size >= size + padding ? candidate : sInvalidNode;
+}
+
+void VK_NAMESPACE::VK_CORE::TLSFAllocator::InsertFree(NodeHandle handle)
+{
+	Node& node = mNodes[handle];
+
+	uint32_t firstLevel, secondLevel;
+	Mapping(node.Size, firstLevel, secondLevel);
+
+	NodeHandle& head = mFreeHeads[firstLevel][secondLevel];
+
+	node.Free = true;
+	node.PrevFree = sInvalidNode;
+	node.NextFree = head;
+
+	if (head != sInvalidNode)
+		mNodes[head].PrevFree = handle;
+
+	head = handle;
+
+	mFirstLevelBitmap |= uint64_t(1) << firstLevel;
+	mSecondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+}
+
+void VK_NAMESPACE::VK_CORE::TLSFAllocator::RemoveFree(NodeHandle handle)
+{
+	Node& node = mNodes[handle];
+
+	uint32_t firstLevel, secondLevel;
+	Mapping(node.Size, firstLevel, secondLevel);
+
+	if (node.PrevFree != sInvalidNode)
+		mNodes[node.PrevFree].NextFree = node.NextFree;
+	else
+		mFreeHeads[firstLevel][secondLevel] = node.NextFree;
+
+	if (node.NextFree != sInvalidNode)
+		mNodes[node.NextFree].PrevFree = node.PrevFree;
+
+	node.Free = false;
+	node.PrevFree = node.NextFree = sInvalidNode;
+
+	if (mFreeHeads[firstLevel][secondLevel] == sInvalidNode)
+	{
+		mSecondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+
+		if (mSecondLevelBitmaps[firstLevel] == 0)
+			mFirstLevelBitmap &= ~(uint64_t(1) << firstLevel);
+	}
+}
+
+VK_NAMESPACE::VK_CORE::TLSFAllocator::NodeHandle VK_NAMESPACE::VK_CORE::TLSFAllocator::CreateNode()
+{
+	if (!mRecycledNodes.empty())
+	{
+		NodeHandle node = mRecycledNodes.back();
+		mRecycledNodes.pop_back();
+
+		mNodes[node] = Node{};
+		return node;
+	}
+
+	mNodes.emplace_back();
+	return static_cast<NodeHandle>(mNodes.size() - 1);
+}
+
+void VK_NAMESPACE::VK_CORE::TLSFAllocator::RecycleNode(NodeHandle node)
+{
+	mNodes[node] = Node{};
+	mRecycledNodes.push_back(node);
+}
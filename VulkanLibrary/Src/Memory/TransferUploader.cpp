@@ -0,0 +1,390 @@
+#include "Core/vkpch.h"
+#include "Memory/TransferUploader.h"
+
+VK_NAMESPACE::TransferUploader::TransferUploader(Core::Ref<vk::Device> device,
+	std::shared_ptr<const WorkingClass> workingClass, CommandPools commandPools,
+	GenericBuffer staging, uint32_t transferFamily)
+	: mDevice(device), mWorkingClass(workingClass), mCommandPools(commandPools),
+	mStaging(staging), mBatcher(staging.GetCapacity()), mTransferFamily(transferFamily)
+{
+	mMappedData = mStaging.GetMappedSpan<std::byte>().data();
+	mFlushThreshold = mBatcher.GetCapacity() / 2;
+}
+
+VK_NAMESPACE::TransferUploader::~TransferUploader()
+{
+	WaitIdle();
+}
+
+uint64_t VK_NAMESPACE::TransferUploader::Upload(const GenericBuffer& dst,
+	std::span<const std::byte> data, vk::DeviceSize dstOffset /*= 0*/)
+{
+	if (data.empty())
+		return 0;
+
+	const Core::Buffer& handles = dst.GetNativeHandles();
+
+	_STL_ASSERT(dstOffset + data.size() <= handles.Config.DeviceSize, "upload runs past the end of the destination buffer");
+
+	UploadDestination destination{ handles.Handle, handles.Config.ResourceOwner };
+
+	// large uploads go in pieces so they never need the whole ring to be free at once
+	const vk::DeviceSize chunkSize = std::max<vk::DeviceSize>(mBatcher.GetCapacity() / 4, 1);
+
+	uint64_t value = 0;
+	uint64_t stalls = 0;
+
+	for (vk::DeviceSize offset = 0; offset < data.size(); offset += chunkSize)
+	{
+		vk::DeviceSize size = std::min<vk::DeviceSize>(chunkSize, data.size() - offset);
+
+		auto ticket = mBatcher.Reserve(destination, dstOffset + offset, size);
+
+		// the ring is full of batches the GPU is still copying from, push the open one out and wait for the oldest
+		while (!ticket)
+		{
+			{
+				std::scoped_lock locker(mSubmitLock);
+
+				FlushUnlocked();
+				RetireOldestBatchUnlocked(std::chrono::nanoseconds::max());
+			}
+
+			stalls++;
+			ticket = mBatcher.Reserve(destination, dstOffset + offset, size);
+		}
+
+		std::memcpy(mMappedData + ticket->StagingOffset, data.data() + offset, size);
+		mBatcher.Commit(*ticket);
+
+		value = ticket->Value;
+	}
+
+	{
+		std::scoped_lock locker(mStatsLock);
+
+		mStats.Requests++;
+		mStats.BytesUploaded += data.size();
+		mStats.StagingStalls += stalls;
+	}
+
+	vk::DeviceSize threshold = mFlushThreshold;
+
+	if (threshold != 0 && mBatcher.GetOpenSize() >= threshold)
+		Flush();
+
+	return value;
+}
+
+uint64_t VK_NAMESPACE::TransferUploader::Flush()
+{
+	std::scoped_lock locker(mSubmitLock);
+	return FlushUnlocked();
+}
+
+uint64_t VK_NAMESPACE::TransferUploader::GetCompletedValue()
+{
+	std::scoped_lock locker(mSubmitLock);
+	return RetireUnlocked();
+}
+
+bool VK_NAMESPACE::TransferUploader::Wait(uint64_t value,
+	std::chrono::nanoseconds timeOut /*= std::chrono::nanoseconds::max()*/)
+{
+	std::scoped_lock locker(mSubmitLock);
+
+	if (value >= mBatcher.GetOpenValue())
+		FlushUnlocked();
+
+	if (RetireUnlocked() >= value)
+		return true;
+
+	std::vector<vk::Fence> fences;
+
+	for (const auto& batch : mInFlight)
+	{
+		if (batch.Value > value)
+			break;
+
+		for (const auto& [worker, cmdBuffer] : batch.Submissions)
+			fences.push_back(worker.GetFence());
+	}
+
+	if (!fences.empty())
+	{
+		auto result = mDevice->waitForFences(fences, VK_TRUE, timeOut.count());
+
+		if (result != vk::Result::eSuccess)
+			return false;
+	}
+
+	return RetireUnlocked() >= value;
+}
+
+void VK_NAMESPACE::TransferUploader::WaitIdle()
+{
+	std::scoped_lock locker(mSubmitLock);
+
+	FlushUnlocked();
+
+	while (RetireOldestBatchUnlocked(std::chrono::nanoseconds::max()));
+}
+
+uint64_t VK_NAMESPACE::TransferUploader::GetSubmittedValue() const
+{
+	std::scoped_lock locker(mSubmitLock);
+	return mSubmittedValue;
+}
+
+VK_NAMESPACE::TransferUploaderStats VK_NAMESPACE::TransferUploader::GetStats() const
+{
+	std::scoped_lock locker(mStatsLock);
+	return mStats;
+}
+
+uint64_t VK_NAMESPACE::TransferUploader::FlushUnlocked()
+{
+	auto batch = mBatcher.Close();
+
+	if (!batch)
+		return mSubmittedValue;
+
+	// buffers living on another family, the copies are sorted by destination so duplicates are neighbours
+	std::map<uint32_t, std::vector<UploadDestination>> foreignDsts;
+
+	for (const auto& copy : batch->Copies)
+	{
+		if (copy.Dst.OwnerFamily == mTransferFamily)
+			continue;
+
+		auto& dsts = foreignDsts[copy.Dst.OwnerFamily];
+
+		if (dsts.empty() || dsts.back() != copy.Dst)
+			dsts.push_back(copy.Dst);
+	}
+
+	BatchInFlight inFlight{};
+	inFlight.Value = batch->Value;
+
+	std::vector<Core::QueueWaitingPoint> released;
+	std::vector<vk::Semaphore> copied;
+
+	// the owners give the buffers up first, whatever lies outside the copied ranges has to survive
+	for (const auto& [family, dsts] : foreignDsts)
+	{
+		vk::Semaphore releaseDone = mDevice->createSemaphore({});
+		vk::Semaphore copyDone = mDevice->createSemaphore({});
+
+		inFlight.Semaphores.push_back(releaseDone);
+		inFlight.Semaphores.push_back(copyDone);
+
+		released.push_back({ releaseDone, vk::PipelineStageFlagBits::eTransfer });
+		copied.push_back(copyDone);
+
+		auto cmdAlloc = mCommandPools[family];
+		std::scoped_lock locker(cmdAlloc);
+
+		vk::CommandBuffer cmdBuffer = cmdAlloc.Allocate();
+
+		cmdBuffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+		RecordOwnershipBarriers(cmdBuffer, dsts, family, mTransferFamily, family);
+		cmdBuffer.end();
+
+		Core::Worker worker = FetchWorker(family);
+
+		uint32_t submitted = worker.Enqueue(releaseDone, cmdBuffer);
+
+		_STL_VERIFY(submitted != std::numeric_limits<uint32_t>::max(),
+			"TransferUploader couldn't submit an ownership release");
+
+		inFlight.Submissions.emplace_back(worker, cmdBuffer);
+	}
+
+	vk::Buffer stagingHandle = mStaging.GetNativeHandles().Handle;
+
+	{
+		auto cmdAlloc = mCommandPools[mTransferFamily];
+		std::scoped_lock locker(cmdAlloc);
+
+		vk::CommandBuffer cmdBuffer = cmdAlloc.Allocate();
+
+		cmdBuffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+
+		for (const auto& [family, dsts] : foreignDsts)
+			RecordOwnershipBarriers(cmdBuffer, dsts, family, mTransferFamily, mTransferFamily);
+
+		// one vkCmdCopyBuffer per destination with all of its regions
+		std::vector<vk::BufferCopy> regions;
+
+		for (size_t i = 0; i < batch->Copies.size(); i++)
+		{
+			const auto& copy = batch->Copies[i];
+			regions.emplace_back(copy.SrcOffset, copy.DstOffset, copy.Size);
+
+			if (i + 1 == batch->Copies.size() || batch->Copies[i + 1].Dst != copy.Dst)
+			{
+				cmdBuffer.copyBuffer(stagingHandle, copy.Dst.Buffer, regions);
+				regions.clear();
+			}
+		}
+
+		for (const auto& [family, dsts] : foreignDsts)
+			RecordOwnershipBarriers(cmdBuffer, dsts, mTransferFamily, family, mTransferFamily);
+
+		cmdBuffer.end();
+
+		Core::Worker worker = FetchWorker(mTransferFamily);
+
+		uint32_t submitted = worker.Enqueue(released, copied, cmdBuffer);
+
+		_STL_VERIFY(submitted != std::numeric_limits<uint32_t>::max(),
+			"TransferUploader couldn't submit the copies");
+
+		inFlight.Submissions.emplace_back(worker, cmdBuffer);
+	}
+
+	// and take them back once the copies are done
+	size_t semaphoreIndex = 0;
+
+	for (const auto& [family, dsts] : foreignDsts)
+	{
+		auto cmdAlloc = mCommandPools[family];
+		std::scoped_lock locker(cmdAlloc);
+
+		vk::CommandBuffer cmdBuffer = cmdAlloc.Allocate();
+
+		cmdBuffer.begin({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+		RecordOwnershipBarriers(cmdBuffer, dsts, mTransferFamily, family, family);
+		cmdBuffer.end();
+
+		Core::QueueWaitingPoint waitPoint{ copied[semaphoreIndex++], vk::PipelineStageFlagBits::eTopOfPipe };
+
+		Core::Worker worker = FetchWorker(family);
+
+		uint32_t submitted = worker.Enqueue(waitPoint, nullptr, cmdBuffer);
+
+		_STL_VERIFY(submitted != std::numeric_limits<uint32_t>::max(),
+			"TransferUploader couldn't submit an ownership acquire");
+
+		inFlight.Submissions.emplace_back(worker, cmdBuffer);
+	}
+
+	mInFlight.push_back(std::move(inFlight));
+	mSubmittedValue = batch->Value;
+
+	{
+		std::scoped_lock locker(mStatsLock);
+
+		mStats.Batches++;
+		mStats.Copies += batch->Copies.size();
+		mStats.OwnershipTransfers += foreignDsts.empty() ? 0 : 1;
+	}
+
+	return mSubmittedValue;
+}
+
+uint64_t VK_NAMESPACE::TransferUploader::RetireUnlocked()
+{
+	// batches finish in submission order as far as we're concerned, stop at the first one still pending
+	while (!mInFlight.empty())
+	{
+		BatchInFlight& batch = mInFlight.front();
+
+		bool done = std::ranges::all_of(batch.Submissions, [](const auto& submission)
+		{ return submission.first.IsFree(); });
+
+		if (!done)
+			break;
+
+		mCompletedValue = batch.Value;
+
+		Recycle(batch);
+		mInFlight.pop_front();
+	}
+
+	mBatcher.Retire(mCompletedValue);
+
+	return mCompletedValue;
+}
+
+bool VK_NAMESPACE::TransferUploader::RetireOldestBatchUnlocked(std::chrono::nanoseconds timeOut)
+{
+	if (mInFlight.empty())
+		return false;
+
+	std::vector<vk::Fence> fences;
+
+	for (const auto& [worker, cmdBuffer] : mInFlight.front().Submissions)
+		fences.push_back(worker.GetFence());
+
+	auto result = mDevice->waitForFences(fences, VK_TRUE, timeOut.count());
+
+	if (result != vk::Result::eSuccess)
+		return false;
+
+	RetireUnlocked();
+
+	return true;
+}
+
+VK_NAMESPACE::Core::Worker VK_NAMESPACE::TransferUploader::FetchWorker(uint32_t family)
+{
+	auto& idle = mIdleWorkers[family];
+
+	if (idle.empty())
+		return mWorkingClass->FetchWorker(family);
+
+	Core::Worker worker = idle.back();
+	idle.pop_back();
+
+	return worker;
+}
+
+void VK_NAMESPACE::TransferUploader::RecordOwnershipBarriers(vk::CommandBuffer cmdBuffer,
+	const std::vector<UploadDestination>& dsts, uint32_t srcFamily, uint32_t dstFamily, uint32_t recordingFamily) const
+{
+	Core::BufferOwnershipTransferInfo masks{};
+
+	if (recordingFamily == srcFamily)
+		Core::Utils::FillBufferReleaseMasks(masks, mWorkingClass->GetFamilyCapabilities(srcFamily));
+	else
+		Core::Utils::FillBufferAcquireMasks(masks, mWorkingClass->GetFamilyCapabilities(dstFamily));
+
+	std::vector<vk::BufferMemoryBarrier> barriers;
+	barriers.reserve(dsts.size());
+
+	for (const auto& dst : dsts)
+	{
+		auto& barrier = barriers.emplace_back();
+		barrier.setBuffer(dst.Buffer);
+		barrier.setSrcQueueFamilyIndex(srcFamily);
+		barrier.setDstQueueFamilyIndex(dstFamily);
+		barrier.setOffset(0);
+		barrier.setSize(VK_WHOLE_SIZE);
+		barrier.setSrcAccessMask(masks.SrcAccess);
+		barrier.setDstAccessMask(masks.DstAccess);
+	}
+
+	cmdBuffer.pipelineBarrier(masks.SrcStage, masks.DstStage, {}, {}, barriers, {});
+}
+
+void VK_NAMESPACE::TransferUploader::Recycle(BatchInFlight& batch)
+{
+	for (const auto& [worker, cmdBuffer] : batch.Submissions)
+	{
+		auto cmdAlloc = mCommandPools[worker.GetFamilyIndex()];
+
+		{
+			std::scoped_lock locker(cmdAlloc);
+			cmdAlloc.Free(cmdBuffer);
+		}
+
+		mIdleWorkers[worker.GetFamilyIndex()].push_back(worker);
+	}
+
+	for (auto semaphore : batch.Semaphores)
+		mDevice->destroySemaphore(semaphore);
+
+	batch.Submissions.clear();
+	batch.Semaphores.clear();
+}
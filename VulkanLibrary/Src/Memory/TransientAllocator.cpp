@@ -0,0 +1,83 @@
+#include "Core/vkpch.h"
+#include "Memory/TransientAllocator.h"
+
+VK_NAMESPACE::TransientAllocator::TransientAllocator(Core::Ref<vk::Device> device,
+	GenericBuffer buffer, vk::DeviceSize defaultAlignment)
+	: mDevice(device), mBuffer(buffer), mRing(buffer.GetCapacity()), mDefaultAlignment(defaultAlignment)
+{
+	mMappedData = mBuffer.GetMappedSpan<std::byte>().data();
+}
+
+VK_NAMESPACE::TransientAllocation VK_NAMESPACE::TransientAllocator::Allocate(
+	vk::DeviceSize size, vk::DeviceSize alignment /*= 0*/)
+{
+	if (size == 0)
+		return {};
+
+	alignment = alignment == 0 ? mDefaultAlignment : alignment;
+
+	_STL_VERIFY(size <= mRing.GetCapacity(), "transient allocation is larger than the whole ring");
+
+	uint64_t offset = mRing.Allocate(size, alignment);
+
+	// the ring is full of frames the GPU is still reading, wait for the oldest one
+	while (offset == Core::LinearRingAllocator::sInvalidOffset)
+	{
+		bool retired = RetireOldestFrame();
+		_STL_VERIFY(retired, "transient allocation doesn't fit next to the open frame");
+
+		offset = mRing.Allocate(size, alignment);
+	}
+
+	mBuffer.MarkDirty(size, offset);
+
+	TransientAllocation allocation{};
+	allocation.Buffer = mBuffer.GetNativeHandles().Handle;
+	allocation.Offset = offset;
+	allocation.Size = size;
+	allocation.Data = mMappedData + offset;
+
+	return allocation;
+}
+
+void VK_NAMESPACE::TransientAllocator::BeginFrame()
+{
+	// fences signal in submission order, stop at the first one still pending
+	while (!mInFlight.empty())
+	{
+		if (mDevice->getFenceStatus(mInFlight.front().Fence) != vk::Result::eSuccess)
+			break;
+
+		mRing.Reclaim(mInFlight.front().Value);
+		mInFlight.pop_front();
+	}
+}
+
+void VK_NAMESPACE::TransientAllocator::EndFrame(vk::Fence fence)
+{
+	// non coherent writes of the frame reach the device in one flush
+	mBuffer.FlushMappedRanges();
+
+	if (mRing.GetOpenFrameSize() == 0)
+		return;
+
+	mRing.EndFrame(mFrameValue);
+	mInFlight.push_back({ mFrameValue, fence });
+
+	mFrameValue++;
+}
+
+bool VK_NAMESPACE::TransientAllocator::RetireOldestFrame()
+{
+	if (mInFlight.empty())
+		return false;
+
+	auto result = mDevice->waitForFences(mInFlight.front().Fence, VK_TRUE, UINT64_MAX);
+
+	_STL_VERIFY(result == vk::Result::eSuccess, "couldn't wait on a transient frame's fence");
+
+	mRing.Reclaim(mInFlight.front().Value);
+	mInFlight.pop_front();
+
+	return true;
+}
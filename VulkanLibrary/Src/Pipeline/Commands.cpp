@@ -1,5 +1,6 @@
 #include "Core/vkpch.h"
 #include "Process/Commands.h"
+#include "Memory/BufferRecycler.h"
 
 VK_NAMESPACE::ExecutionUnit::~ExecutionUnit()
 {
@@ -37,14 +38,33 @@ void VK_NAMESPACE::CommandBufferAllocator::EndOneTimeCommands(
 	submitInfo.setCommandBuffers(CmdBuffer);
 
 	workers.Enqueue(submitInfo);
+	RetireReleasedBuffers(workers.GetFence());
 	workers.WaitIdle();
 
-	Free(CmdBuffer);
+	Recycle(CmdBuffer);
+}
+
+void VK_NAMESPACE::CommandBufferAllocator::RetireReleasedBuffers(vk::Fence fence) const
+{
+	if (mBufferRecycler)
+		mBufferRecycler->Retire(fence);
 }
 
 vk::CommandBuffer VK_NAMESPACE::CommandBufferAllocator::Allocate(
 	vk::CommandBufferLevel level /*= vk::CommandBufferLevel::ePrimary*/) const
 {
+	auto& recycled = mCommandPool->Recycled;
+
+	if (level == vk::CommandBufferLevel::ePrimary && !recycled.empty())
+	{
+		vk::CommandBuffer CmdBuffer = recycled.back();
+		recycled.pop_back();
+
+		AddInstanceDebug(CmdBuffer);
+
+		return CmdBuffer;
+	}
+
 	vk::CommandBufferAllocateInfo allocInfo{};
 	allocInfo.setCommandPool(mCommandPool->Handle);
 	allocInfo.setCommandBufferCount(1);
@@ -62,6 +82,18 @@ void VK_NAMESPACE::CommandBufferAllocator::Free(vk::CommandBuffer CmdBuffer) con
 	mDevice->freeCommandBuffers(mCommandPool->Handle, CmdBuffer);
 }
 
+void VK_NAMESPACE::CommandBufferAllocator::Recycle(vk::CommandBuffer CmdBuffer) const
+{
+	if (mCommandPool->Recycled.size() >= sMaxRecycledBuffers)
+	{
+		Free(CmdBuffer);
+		return;
+	}
+
+	RemoveInstanceDebug(CmdBuffer);
+	mCommandPool->Recycled.push_back(CmdBuffer);
+}
+
 VK_NAMESPACE::ExecutionUnit VK_NAMESPACE::CommandBufferAllocator::CreateExecUnit(vk::CommandBufferLevel level /*= vk::CommandBufferLevel::ePrimary*/) const
 {
 	ExecutionUnit execUnit;
@@ -114,8 +146,9 @@ void VK_NAMESPACE::CommandBufferAllocator::DestructionChecksDebug() const
 #endif
 }
 
-VK_NAMESPACE::CommandPools::CommandPools(Core::Ref<vk::Device> device, const Core::QueueFamilyIndices& indices, vk::CommandPoolCreateFlags flags, WorkingClassRef workingClass)
-	: mIndices(indices), mCreationFlags(flags), mDevice(device), mWorkingClass(workingClass)
+VK_NAMESPACE::CommandPools::CommandPools(Core::Ref<vk::Device> device, const Core::QueueFamilyIndices& indices, vk::CommandPoolCreateFlags flags,
+	WorkingClassRef workingClass, std::shared_ptr<Core::BufferRecycler> bufferRecycler)
+	: mIndices(indices), mCreationFlags(flags), mDevice(device), mWorkingClass(workingClass), mBufferRecycler(bufferRecycler)
 {
 	for (auto index : mIndices)
 		mCommandPools[index] = CreateAllocator(index);
@@ -171,6 +204,7 @@ VK_NAMESPACE::CommandBufferAllocator VK_NAMESPACE::CommandPools::CreateAllocator
 	Allocator.mFamilyIndex = familyIndex;
 	Allocator.mParentReservoir = this;
 	Allocator.mWorkingClass = mWorkingClass;
+	Allocator.mBufferRecycler = mBufferRecycler;
 
 	AssignTrackerDebug(Allocator);
 
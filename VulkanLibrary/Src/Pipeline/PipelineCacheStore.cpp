@@ -0,0 +1,168 @@
+#include "Core/vkpch.h"
+#include "Pipeline/PipelineCacheStore.h"
+
+VK_NAMESPACE::VK_CORE::PipelineCacheStore::PipelineCacheStore(Ref<vk::Device> device,
+	const vk::PhysicalDeviceProperties& props, const std::filesystem::path& path /*= {}*/)
+	: mDevice(device), mPath(path), mProps(props)
+{
+	std::vector<uint8_t> blob;
+
+	if (!mPath.empty())
+	{
+		auto loaded = ReadBlob(mPath);
+
+		if (loaded)
+			mLoadResult = ValidateBlob(*loaded, mProps);
+		else
+			mLoadResult = loaded.error();
+
+		if (mLoadResult == PipelineCacheError::eNone)
+			blob = std::move(*loaded);
+	}
+
+	vk::PipelineCacheCreateInfo cacheInfo{};
+	cacheInfo.setInitialDataSize(blob.size());
+	cacheInfo.setPInitialData(blob.empty() ? nullptr : blob.data());
+
+	mHandle = mDevice->createPipelineCache(cacheInfo);
+	mLoadedSize = blob.size();
+}
+
+VK_NAMESPACE::VK_CORE::PipelineCacheStore::~PipelineCacheStore()
+{
+	// nothing sensible to do about a failed save this late, the next run just starts cold
+	Save();
+
+	mDevice->destroyPipelineCache(mHandle);
+}
+
+std::expected<size_t, VK_NAMESPACE::VK_CORE::PipelineCacheError> VK_NAMESPACE::VK_CORE::PipelineCacheStore::Save() const
+{
+	if (mPath.empty())
+		return 0;
+
+	std::scoped_lock locker(mSaveLock);
+
+	std::vector<uint8_t> blob = mDevice->getPipelineCacheData(mHandle);
+
+	return WriteBlobAtomic(mPath, blob);
+}
+
+void VK_NAMESPACE::VK_CORE::PipelineCacheStore::Merge(vk::ArrayProxy<const vk::PipelineCache> caches) const
+{
+	if (caches.empty())
+		return;
+
+	mDevice->mergePipelineCaches(mHandle, caches);
+}
+
+std::expected<VK_NAMESPACE::VK_CORE::PipelineCacheHeader, VK_NAMESPACE::VK_CORE::PipelineCacheError>
+	VK_NAMESPACE::VK_CORE::PipelineCacheStore::ParseHeader(std::span<const uint8_t> blob)
+{
+	// the spec lays the header out as four uint32_t followed by the UUID, no padding
+	constexpr size_t sHeaderSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+
+	if (blob.size() < sHeaderSize)
+		return std::unexpected(PipelineCacheError::eTruncated);
+
+	PipelineCacheHeader header{};
+
+	std::memcpy(&header.HeaderSize, blob.data() + 0, sizeof(uint32_t));
+	std::memcpy(&header.HeaderVersion, blob.data() + 4, sizeof(uint32_t));
+	std::memcpy(&header.VendorID, blob.data() + 8, sizeof(uint32_t));
+	std::memcpy(&header.DeviceID, blob.data() + 12, sizeof(uint32_t));
+	std::memcpy(header.CacheUUID.data(), blob.data() + 16, VK_UUID_SIZE);
+
+	if (header.HeaderVersion != static_cast<uint32_t>(vk::PipelineCacheHeaderVersion::eOne))
+		return std::unexpected(PipelineCacheError::eUnknownHeaderVersion);
+
+	if (header.HeaderSize < sHeaderSize || header.HeaderSize > blob.size())
+		return std::unexpected(PipelineCacheError::eTruncated);
+
+	return header;
+}
+
+VK_NAMESPACE::VK_CORE::PipelineCacheError VK_NAMESPACE::VK_CORE::PipelineCacheStore::ValidateBlob(
+	std::span<const uint8_t> blob, const vk::PhysicalDeviceProperties& props)
+{
+	auto header = ParseHeader(blob);
+
+	if (!header)
+		return header.error();
+
+	if (header->VendorID != props.vendorID)
+		return PipelineCacheError::eVendorMismatch;
+
+	if (header->DeviceID != props.deviceID)
+		return PipelineCacheError::eDeviceMismatch;
+
+	// a driver update changes the UUID, the old blob is useless to the new driver
+	if (!std::ranges::equal(header->CacheUUID, props.pipelineCacheUUID))
+		return PipelineCacheError::eUUIDMismatch;
+
+	return PipelineCacheError::eNone;
+}
+
+std::expected<std::vector<uint8_t>, VK_NAMESPACE::VK_CORE::PipelineCacheError>
+	VK_NAMESPACE::VK_CORE::PipelineCacheStore::ReadBlob(const std::filesystem::path& path)
+{
+	std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+
+	if (!file)
+		return std::unexpected(PipelineCacheError::eFileNotFound);
+
+	std::streamsize size = file.tellg();
+
+	if (size < 0)
+		return std::unexpected(PipelineCacheError::eTruncated);
+
+	std::vector<uint8_t> blob(static_cast<size_t>(size));
+
+	file.seekg(0);
+
+	if (!file.read(reinterpret_cast<char*>(blob.data()), size))
+		return std::unexpected(PipelineCacheError::eTruncated);
+
+	return blob;
+}
+
+std::expected<size_t, VK_NAMESPACE::VK_CORE::PipelineCacheError> VK_NAMESPACE::VK_CORE::PipelineCacheStore::WriteBlobAtomic(
+	const std::filesystem::path& path, std::span<const uint8_t> blob)
+{
+	std::error_code error;
+
+	if (path.has_parent_path())
+		std::filesystem::create_directories(path.parent_path(), error);
+
+	std::filesystem::path temporary = path;
+	temporary += ".tmp";
+
+	{
+		std::ofstream file(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		if (!file)
+			return std::unexpected(PipelineCacheError::eWriteFailed);
+
+		file.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+		file.flush();
+
+		if (!file)
+		{
+			file.close();
+			std::filesystem::remove(temporary, error);
+
+			return std::unexpected(PipelineCacheError::eWriteFailed);
+		}
+	}
+
+	// replaces the destination in one step, readers see either the old or the new cache
+	std::filesystem::rename(temporary, path, error);
+
+	if (error)
+	{
+		std::filesystem::remove(temporary, error);
+		return std::unexpected(PipelineCacheError::eWriteFailed);
+	}
+
+	return blob.size();
+}
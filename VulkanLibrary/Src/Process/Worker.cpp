@@ -57,37 +57,74 @@ bool VK_NAMESPACE::VK_CORE::Worker::IsFree() const
 	return WaitIdle(std::chrono::seconds(0)) == vk::Result::eSuccess;
 }
 
-vk::Result VK_NAMESPACE::VK_CORE::Worker::WaitForQueues(size_t beginSpan, size_t endSpan, 
-	bool waitForAll, std::chrono::nanoseconds timeOut) const
+vk::Result VK_NAMESPACE::VK_CORE::Worker::WaitForBusyWorkers(std::chrono::nanoseconds timeOut) const
 {
-	// wait for all of fences but set the variable 'waitAll' to VK_FALSE or VK_TRUE
-	// this will make sure the function returns the moment any fence is signaled
-	// well, now we can poll all the workers to check out which one was freed
+	// slow path, every worker of the family is in flight
+	// wait for any of their idle fences so the next reclaim finds something
+	std::vector<vk::Fence> fences;
+	std::vector<uint32_t> pinned;
+
+	fences.reserve(mFamilyData->Workers.size());
+	pinned.reserve(mFamilyData->Workers.size());
+
+	mFamilyData->FreeWorkers.CollectInFlightFences(fences, pinned);
+
+	// the other submitters hold every worker and haven't submitted yet, there's nothing to wait on
+	if (fences.empty())
+		return vk::Result::eNotReady;
+
+	auto result = mDevice->waitForFences(fences, VK_FALSE, timeOut.count());
+
+	mFamilyData->FreeWorkers.UnpinAll(pinned);
+
+	return result;
+}
+
+uint32_t VK_NAMESPACE::VK_CORE::Worker::ReclaimFreeWorkers() const
+{
+	auto device = *mDevice;
 
-	for (auto queue : mFamilyData->Workers)
+	return mFamilyData->FreeWorkers.Reclaim([device](vk::Fence fence)
 	{
-		auto result = queue->WaitIdle();
+		return device.getFenceStatus(fence) == vk::Result::eSuccess;
+	});
+}
 
-		if (result != vk::Result::eSuccess)
-			return result;
-	}
+uint32_t VK_NAMESPACE::VK_CORE::Worker::TryAcquireFreeWorker() const
+{
+	auto& freeList = mFamilyData->FreeWorkers;
+
+	uint32_t index = freeList.Acquire();
 
-	return vk::Result::eSuccess;
+	if (index == WorkerFreeList::sInvalidIndex && ReclaimFreeWorkers() != 0)
+		index = freeList.Acquire();
+
+	return index;
 }
 
 uint32_t VK_NAMESPACE::VK_CORE::Worker::SubmitRange(const vk::ArrayProxy<vk::SubmitInfo>& submitInfos, std::chrono::nanoseconds timeOut) const
 {
-	auto workers = GetActiveWorkers();
+	auto submitTracked = [this, &submitInfos, timeOut](const Ref<WorkerQueue>& worker)
+	{
+		return worker->SubmitTracked(submitInfos, *mFence, timeOut) == vk::Result::eSuccess;
+	};
+
+	// exclusive families hand every submitter a queue of its own, waiting for one if they're all busy
+	if (mFamilyData->ExclusiveSubmission)
+		return PollFreeWorkers(timeOut, submitTracked);
+
+	uint32_t index = TryAcquireFreeWorker();
 
-	// iterating to the next index and submitting the work to the GPU
-	uint32_t currWorker = mFamilyData->Next() % static_cast<uint32_t>(workers.size());
+	if (index != WorkerFreeList::sInvalidIndex)
+		return SubmitToFreeWorker(index, submitTracked);
 
-	auto result = workers[currWorker]->Submit(submitInfos, *mFence, timeOut);
+	// every queue is busy, share them round robin instead of blocking the submitter
+	uint32_t next = mFamilyData->Next();
 
-	if (result != vk::Result::eSuccess)
+	if (mFamilyData->Workers[next]->Submit(submitInfos, *mFence, timeOut) != vk::Result::eSuccess)
 		return std::numeric_limits<uint32_t>::max();
 
-	return currWorker;
+	return next;
 }
 
 std::span<const VK_NAMESPACE::VK_CORE::Ref<VK_NAMESPACE::VK_CORE::WorkerQueue>> VK_NAMESPACE::VK_CORE::Worker::GetActiveWorkers() const
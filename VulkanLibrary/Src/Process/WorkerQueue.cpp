@@ -29,6 +29,28 @@ vk::Result VK_NAMESPACE::VK_CORE::WorkerQueue::Submit(vk::ArrayProxy<vk::SubmitI
 	return vk::Result::eSuccess;
 }
 
+vk::Result VK_NAMESPACE::VK_CORE::WorkerQueue::SubmitTracked(vk::ArrayProxy<vk::SubmitInfo> submitInfos,
+	vk::Fence fence, std::chrono::nanoseconds timeOut) const
+{
+	// uncontended between workers since the queue was claimed from the free list,
+	// still required against direct users of the queue and PresentKHR
+	std::unique_lock locker(mLock);
+
+	auto result = WaitIdleAsync(timeOut.count(), fence);
+
+	if (result != vk::Result::eSuccess)
+		return result;
+
+	SubmitInternal(submitInfos, fence);
+
+	// an empty batch signals its fence after all prior work on the queue completes
+	// the worker's free list slot is acquired and unpinned, no other thread reads the fence now
+	mDevice.resetFences(mIdleFence);
+	mHandle.submit(nullptr, mIdleFence);
+
+	return vk::Result::eSuccess;
+}
+
 vk::Result VK_NAMESPACE::VK_CORE::WorkerQueue::Submit(vk::ArrayProxy<vk::Semaphore> signalSemaphores,
 	vk::ArrayProxy<vk::CommandBuffer> buffers, vk::Fence fence, std::chrono::nanoseconds timeOut /*= std::chrono::nanoseconds::max()*/)
 {
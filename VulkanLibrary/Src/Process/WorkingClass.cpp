@@ -62,7 +62,7 @@ VK_NAMESPACE::WorkingClass::WorkingClass(
 	const Core::QueueFamilyIndices& queueIndices, 
 	const Core::QueueIndexMap& queueCaps,
 	const std::vector<vk::QueueFamilyProperties> queueProps,
-	Core::Ref<vk::Device> device) 
+	Core::Ref<vk::Device> device, bool exclusiveSubmission) 
 
 	: mWorkerFamilies(), mWorkerIndices(queueIndices),
 	mFamilyIndicesByCapabilities(queueCaps), mDevice(device)
@@ -73,6 +73,7 @@ VK_NAMESPACE::WorkingClass::WorkingClass(
 		mWorkerFamilies[queueFamily.first].Index = queueFamily.first;
 		mWorkerFamilies[queueFamily.first].Workers = std::move(queueFamily.second);
 		mWorkerFamilies[queueFamily.first].Capabilities = queueProps[queueFamily.first].queueFlags;
+		mWorkerFamilies[queueFamily.first].ExclusiveSubmission = exclusiveSubmission;
 	}
 
 	for (auto& workerFamilyInfo : mWorkerFamilies)
@@ -82,5 +83,8 @@ VK_NAMESPACE::WorkingClass::WorkingClass(
 			worker->mFamilyInfo = &workerFamilyInfo.second;
 			worker->mFamilyInfo->mMutexes.emplace_back(&worker->mLock);
 		}
+
+		workerFamilyInfo.second.FreeWorkers.Reset(
+			static_cast<uint32_t>(workerFamilyInfo.second.Workers.size()));
 	}
 }
@@ -0,0 +1,314 @@
+#include "Core/vkpch.h"
+#include "ShaderCompiler/CompileStats.h"
+
+namespace
+{
+	std::mutex sDefaultLock;
+	std::shared_ptr<VK_NAMESPACE::CompileStatsRegistry> sDefaultRegistry;
+
+	constexpr size_t sPhaseCount = static_cast<size_t>(VK_NAMESPACE::CompilePhase::eCount);
+
+	// fixed point, the stream's own precision would turn long compiles into exponents
+	std::string ToMicroseconds(std::chrono::nanoseconds time)
+	{
+		char digits[32];
+		std::snprintf(digits, sizeof(digits), "%.1f", std::chrono::duration<double, std::micro>(time).count());
+		return digits;
+	}
+
+	std::string EscapeCSV(const std::string& field)
+	{
+		if (field.find_first_of(",\"\n") == std::string::npos)
+			return field;
+
+		std::string escaped = "\"";
+
+		for (char val : field)
+		{
+			if (val == '"')
+				escaped += '"';
+
+			escaped += val;
+		}
+
+		return escaped + "\"";
+	}
+
+	std::string EscapeJSON(const std::string& field)
+	{
+		std::string escaped = "\"";
+
+		for (char val : field)
+		{
+			switch (val)
+			{
+				case '"':  escaped += "\\\""; break;
+				case '\\': escaped += "\\\\"; break;
+				case '\n': escaped += "\\n"; break;
+				case '\r': escaped += "\\r"; break;
+				case '\t': escaped += "\\t"; break;
+				default:
+					if (static_cast<uint8_t>(val) < 0x20)
+					{
+						char code[8];
+						std::snprintf(code, sizeof(code), "\\u%04x", val);
+						escaped += code;
+					}
+					else
+						escaped += val;
+					break;
+			}
+		}
+
+		return escaped + "\"";
+	}
+
+	std::string FormatHash(uint64_t hash)
+	{
+		char digits[17];
+		std::snprintf(digits, sizeof(digits), "%016llx", static_cast<unsigned long long>(hash));
+		return digits;
+	}
+
+	void WritePhasesJSON(std::ostream& stream, const VK_NAMESPACE::CompilePhaseTimes& phases)
+	{
+		stream << "{";
+
+		for (size_t i = 0; i < sPhaseCount; i++)
+		{
+			auto name = VK_NAMESPACE::CompileStatsRegistry::GetPhaseName(static_cast<VK_NAMESPACE::CompilePhase>(i));
+			stream << (i ? ", " : "") << "\"" << name << "\": " << ToMicroseconds(phases[i]);
+		}
+
+		stream << "}";
+	}
+}
+
+void VK_NAMESPACE::CompileStatsRegistry::SetSlowCompileThreshold(
+	std::chrono::nanoseconds threshold, SlowCompileHandler handler /*= {}*/)
+{
+	std::scoped_lock locker(mLock);
+
+	mSlowThreshold = threshold;
+	mSlowHandler = handler ? std::make_shared<SlowCompileHandler>(std::move(handler)) : nullptr;
+}
+
+void VK_NAMESPACE::CompileStatsRegistry::Record(const CompileRecord& record)
+{
+	std::shared_ptr<SlowCompileHandler> handler;
+
+	{
+		std::scoped_lock locker(mLock);
+
+		auto& summary = mSummaries[{ record.Name, static_cast<uint32_t>(record.Stage), record.PermutationHash }];
+
+		if (summary.Compilations == 0)
+		{
+			summary.Name = record.Name;
+			summary.Stage = record.Stage;
+			summary.PermutationHash = record.PermutationHash;
+			summary.Macros = record.Macros;
+		}
+
+		summary.Compilations++;
+		summary.Failures += record.Succeeded ? 0 : 1;
+		summary.ArchiveHits += record.Source == CompileSource::eArchive ? 1 : 0;
+		summary.CacheHits += record.Source == CompileSource::eCache ? 1 : 0;
+
+		for (size_t i = 0; i < sPhaseCount; i++)
+		{
+			summary.Phases[i] += record.Phases[i];
+			mPhaseTotals[i] += record.Phases[i];
+		}
+
+		summary.Total += record.Total;
+		summary.Slowest = std::max(summary.Slowest, record.Total);
+		summary.SourceSize = record.SourceSize;
+		summary.SPIRVSize = record.SPIRVSize;
+
+		// a hit carries no counts, keep the ones of the last real compilation
+		if (record.Source == CompileSource::eCompiled)
+		{
+			summary.UnoptimizedInstructions = record.UnoptimizedInstructions;
+			summary.Instructions = record.Instructions;
+		}
+
+		mCompilations++;
+
+		if (mSlowThreshold.count() == 0 || record.Total < mSlowThreshold)
+			return;
+
+		if (mSlowCompiles.size() == sMaxSlowRecords)
+			mSlowCompiles.pop_front();
+
+		mSlowCompiles.push_back(record);
+		handler = mSlowHandler;
+	}
+
+	// outside of the lock, the handler may well query the registry
+	if (handler)
+		(*handler)(record);
+}
+
+std::vector<VK_NAMESPACE::CompileSummary> VK_NAMESPACE::CompileStatsRegistry::GetSummaries() const
+{
+	std::vector<CompileSummary> summaries;
+
+	{
+		std::scoped_lock locker(mLock);
+
+		summaries.reserve(mSummaries.size());
+
+		for (const auto& [key, summary] : mSummaries)
+			summaries.push_back(summary);
+	}
+
+	std::ranges::stable_sort(summaries, std::greater(), &CompileSummary::Total);
+
+	return summaries;
+}
+
+std::vector<VK_NAMESPACE::CompileRecord> VK_NAMESPACE::CompileStatsRegistry::GetSlowCompiles() const
+{
+	std::scoped_lock locker(mLock);
+	return { mSlowCompiles.begin(), mSlowCompiles.end() };
+}
+
+VK_NAMESPACE::CompilePhaseTimes VK_NAMESPACE::CompileStatsRegistry::GetPhaseTotals() const
+{
+	std::scoped_lock locker(mLock);
+	return mPhaseTotals;
+}
+
+uint64_t VK_NAMESPACE::CompileStatsRegistry::GetCompilationCount() const
+{
+	std::scoped_lock locker(mLock);
+	return mCompilations;
+}
+
+void VK_NAMESPACE::CompileStatsRegistry::Clear()
+{
+	std::scoped_lock locker(mLock);
+
+	mSummaries.clear();
+	mSlowCompiles.clear();
+	mPhaseTotals = {};
+	mCompilations = 0;
+}
+
+void VK_NAMESPACE::CompileStatsRegistry::WriteCSV(std::ostream& stream) const
+{
+	stream << "Name,Stage,Permutation,Macros,Compilations,Failures,ArchiveHits,CacheHits";
+
+	for (size_t i = 0; i < sPhaseCount; i++)
+		stream << "," << GetPhaseName(static_cast<CompilePhase>(i)) << "Us";
+
+	stream << ",TotalUs,SlowestUs,SourceBytes,SPIRVBytes,UnoptimizedInstructions,Instructions\n";
+
+	for (const auto& summary : GetSummaries())
+	{
+		stream << EscapeCSV(summary.Name) << "," << vk::to_string(summary.Stage) << ","
+			<< FormatHash(summary.PermutationHash) << "," << EscapeCSV(summary.Macros) << ","
+			<< summary.Compilations << "," << summary.Failures << ","
+			<< summary.ArchiveHits << "," << summary.CacheHits;
+
+		for (auto phase : summary.Phases)
+			stream << "," << ToMicroseconds(phase);
+
+		stream << "," << ToMicroseconds(summary.Total) << "," << ToMicroseconds(summary.Slowest)
+			<< "," << summary.SourceSize << "," << summary.SPIRVSize
+			<< "," << summary.UnoptimizedInstructions << "," << summary.Instructions << "\n";
+	}
+}
+
+void VK_NAMESPACE::CompileStatsRegistry::WriteJSON(std::ostream& stream) const
+{
+	auto summaries = GetSummaries();
+	auto slowCompiles = GetSlowCompiles();
+
+	stream << "{\n\t\"Compilations\": " << GetCompilationCount() << ",\n\t\"Phases\": ";
+	WritePhasesJSON(stream, GetPhaseTotals());
+
+	stream << ",\n\t\"Permutations\": [";
+
+	for (size_t i = 0; i < summaries.size(); i++)
+	{
+		const auto& summary = summaries[i];
+
+		stream << (i ? "," : "") << "\n\t\t{ \"Name\": " << EscapeJSON(summary.Name)
+			<< ", \"Stage\": \"" << vk::to_string(summary.Stage) << "\""
+			<< ", \"Permutation\": \"" << FormatHash(summary.PermutationHash) << "\""
+			<< ", \"Macros\": " << EscapeJSON(summary.Macros)
+			<< ", \"Compilations\": " << summary.Compilations
+			<< ", \"Failures\": " << summary.Failures
+			<< ", \"ArchiveHits\": " << summary.ArchiveHits
+			<< ", \"CacheHits\": " << summary.CacheHits
+			<< ", \"Phases\": ";
+
+		WritePhasesJSON(stream, summary.Phases);
+
+		stream << ", \"Total\": " << ToMicroseconds(summary.Total)
+			<< ", \"Slowest\": " << ToMicroseconds(summary.Slowest)
+			<< ", \"SourceBytes\": " << summary.SourceSize
+			<< ", \"SPIRVBytes\": " << summary.SPIRVSize
+			<< ", \"UnoptimizedInstructions\": " << summary.UnoptimizedInstructions
+			<< ", \"Instructions\": " << summary.Instructions << " }";
+	}
+
+	stream << (summaries.empty() ? "" : "\n\t") << "],\n\t\"SlowCompiles\": [";
+
+	for (size_t i = 0; i < slowCompiles.size(); i++)
+	{
+		const auto& record = slowCompiles[i];
+
+		stream << (i ? "," : "") << "\n\t\t{ \"Name\": " << EscapeJSON(record.Name)
+			<< ", \"Stage\": \"" << vk::to_string(record.Stage) << "\""
+			<< ", \"Permutation\": \"" << FormatHash(record.PermutationHash) << "\""
+			<< ", \"Source\": \"" << GetSourceName(record.Source) << "\""
+			<< ", \"Succeeded\": " << (record.Succeeded ? "true" : "false")
+			<< ", \"Phases\": ";
+
+		WritePhasesJSON(stream, record.Phases);
+
+		stream << ", \"Total\": " << ToMicroseconds(record.Total) << " }";
+	}
+
+	stream << (slowCompiles.empty() ? "" : "\n\t") << "]\n}\n";
+}
+
+const char* VK_NAMESPACE::CompileStatsRegistry::GetPhaseName(CompilePhase phase)
+{
+	switch (phase)
+	{
+		case CompilePhase::eIncludes:       return "Includes";
+		case CompilePhase::ePreprocess:     return "Preprocess";
+		case CompilePhase::eParse:          return "Parse";
+		case CompilePhase::eLink:           return "Link";
+		case CompilePhase::eOptimize:       return "Optimize";
+		case CompilePhase::eReflect:        return "Reflect";
+		default:                            return "Unknown";
+	}
+}
+
+const char* VK_NAMESPACE::CompileStatsRegistry::GetSourceName(CompileSource source)
+{
+	switch (source)
+	{
+		case CompileSource::eCompiled:      return "Compiled";
+		case CompileSource::eArchive:       return "Archive";
+		case CompileSource::eCache:         return "Cache";
+		default:                            return "Unknown";
+	}
+}
+
+void VK_NAMESPACE::CompileStatsRegistry::SetDefault(std::shared_ptr<CompileStatsRegistry> registry)
+{
+	std::scoped_lock locker(sDefaultLock);
+	sDefaultRegistry = std::move(registry);
+}
+
+std::shared_ptr<VK_NAMESPACE::CompileStatsRegistry> VK_NAMESPACE::CompileStatsRegistry::GetDefault()
+{
+	std::scoped_lock locker(sDefaultLock);
+	return sDefaultRegistry;
+}
@@ -18,6 +18,6 @@ std::shared_ptr<VK_NAMESPACE::ShaderIncluder> VK_NAMESPACE::CompilerEnvironment:
 	ShaderDirectory = std::filesystem::canonical(ShaderDirectory.parent_path());
 
 	std::vector<std::filesystem::path> paths(mSystemPaths.begin(), mSystemPaths.end());
-	return std::make_shared<ShaderIncluder>(ShaderDirectory, paths);
+	return std::make_shared<ShaderIncluder>(ShaderDirectory, paths, GetIncludeCache());
 }
 
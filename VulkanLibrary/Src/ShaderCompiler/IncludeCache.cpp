@@ -0,0 +1,212 @@
+#include "Core/vkpch.h"
+#include "ShaderCompiler/IncludeCache.h"
+#include "ShaderCompiler/CompilerUtils.h"
+
+namespace
+{
+	uint64_t HashContents(std::string_view contents)
+	{
+		uint64_t hash = 0xcbf29ce484222325ull;
+
+		for (char c : contents)
+			hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ull;
+
+		return hash;
+	}
+
+	std::mutex sDefaultLock;
+	std::shared_ptr<VK_NAMESPACE::IncludeCache> sDefaultCache = std::make_shared<VK_NAMESPACE::IncludeCache>();
+}
+
+std::shared_ptr<const std::string> VK_NAMESPACE::IncludeCache::Read(const std::filesystem::path& path)
+{
+	auto key = NormalizePath(path);
+
+	std::error_code error;
+
+	auto writeTime = std::filesystem::last_write_time(key, error);
+
+	if (error)
+		return nullptr;
+
+	auto size = std::filesystem::file_size(key, error);
+
+	if (error)
+		return nullptr;
+
+	{
+		std::shared_lock locker(mEntriesLock);
+
+		auto found = mEntries.find(key);
+
+		if (found != mEntries.end() && found->second.WriteTime == writeTime && found->second.Size == size)
+		{
+			mHits++;
+			return found->second.Contents;
+		}
+	}
+
+	// read outside of the lock, other threads keep hitting on the files they need
+	auto contents = ReadFile(key.string());
+
+	if (!contents)
+		return nullptr;
+
+	uint64_t hash = HashContents(*contents);
+
+	std::unique_lock locker(mEntriesLock);
+
+	auto& entry = mEntries[key];
+
+	if (entry.Contents && entry.Hash == hash)
+	{
+		// touched, or another thread got here first
+		entry.WriteTime = writeTime;
+		entry.Size = size;
+
+		mRevalidations++;
+		return entry.Contents;
+	}
+
+	if (entry.Contents)
+		mReloads++;
+	else
+		mMisses++;
+
+	entry.Contents = std::make_shared<const std::string>(std::move(*contents));
+	entry.Hash = hash;
+	entry.WriteTime = writeTime;
+	entry.Size = size;
+
+	return entry.Contents;
+}
+
+void VK_NAMESPACE::IncludeCache::Invalidate(const std::filesystem::path& path)
+{
+	std::unique_lock locker(mEntriesLock);
+	mEntries.erase(NormalizePath(path));
+}
+
+void VK_NAMESPACE::IncludeCache::Clear()
+{
+	std::scoped_lock locker(mEntriesLock, mGraphLock);
+
+	mEntries.clear();
+	mDependencies.clear();
+	mDependents.clear();
+}
+
+void VK_NAMESPACE::IncludeCache::RecordDependencies(
+	const std::filesystem::path& shader, const std::vector<std::filesystem::path>& includes)
+{
+	auto key = NormalizePath(shader);
+
+	std::unique_lock locker(mGraphLock);
+
+	ForgetShaderUnlocked(key);
+
+	auto& dependencies = mDependencies[key];
+
+	for (const auto& include : includes)
+	{
+		auto header = NormalizePath(include);
+
+		dependencies.insert(header);
+		mDependents[header].insert(key);
+	}
+}
+
+void VK_NAMESPACE::IncludeCache::ForgetShader(const std::filesystem::path& shader)
+{
+	std::unique_lock locker(mGraphLock);
+	ForgetShaderUnlocked(NormalizePath(shader));
+}
+
+std::vector<std::filesystem::path> VK_NAMESPACE::IncludeCache::GetDependencies(
+	const std::filesystem::path& shader) const
+{
+	std::shared_lock locker(mGraphLock);
+
+	auto found = mDependencies.find(NormalizePath(shader));
+
+	if (found == mDependencies.end())
+		return {};
+
+	return { found->second.begin(), found->second.end() };
+}
+
+std::vector<std::filesystem::path> VK_NAMESPACE::IncludeCache::GetDependents(
+	const std::filesystem::path& header) const
+{
+	std::shared_lock locker(mGraphLock);
+
+	auto found = mDependents.find(NormalizePath(header));
+
+	if (found == mDependents.end())
+		return {};
+
+	return { found->second.begin(), found->second.end() };
+}
+
+VK_NAMESPACE::IncludeCacheStats VK_NAMESPACE::IncludeCache::GetStats() const
+{
+	IncludeCacheStats stats{};
+	stats.Hits = mHits;
+	stats.Misses = mMisses;
+	stats.Reloads = mReloads;
+	stats.Revalidations = mRevalidations;
+
+	return stats;
+}
+
+size_t VK_NAMESPACE::IncludeCache::GetEntryCount() const
+{
+	std::shared_lock locker(mEntriesLock);
+	return mEntries.size();
+}
+
+std::filesystem::path VK_NAMESPACE::IncludeCache::NormalizePath(const std::filesystem::path& path)
+{
+	std::error_code error;
+	auto normalized = std::filesystem::weakly_canonical(path, error);
+
+	if (error)
+		return std::filesystem::absolute(path, error).lexically_normal();
+
+	return normalized;
+}
+
+void VK_NAMESPACE::IncludeCache::ForgetShaderUnlocked(const std::filesystem::path& shader)
+{
+	auto found = mDependencies.find(shader);
+
+	if (found == mDependencies.end())
+		return;
+
+	for (const auto& header : found->second)
+	{
+		auto dependents = mDependents.find(header);
+
+		if (dependents == mDependents.end())
+			continue;
+
+		dependents->second.erase(shader);
+
+		if (dependents->second.empty())
+			mDependents.erase(dependents);
+	}
+
+	mDependencies.erase(found);
+}
+
+void VK_NAMESPACE::IncludeCache::SetDefault(std::shared_ptr<IncludeCache> cache)
+{
+	std::scoped_lock locker(sDefaultLock);
+	sDefaultCache = std::move(cache);
+}
+
+std::shared_ptr<VK_NAMESPACE::IncludeCache> VK_NAMESPACE::IncludeCache::GetDefault()
+{
+	std::scoped_lock locker(sDefaultLock);
+	return sDefaultCache;
+}
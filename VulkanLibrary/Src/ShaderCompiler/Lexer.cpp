@@ -1,125 +1,211 @@
 #include "Core/vkpch.h"
 #include "ShaderCompiler/Lexer.h"
 
-VK_BEGIN
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define VK_LEXER_SSE2 1
+#else
+	#define VK_LEXER_SSE2 0
+#endif
+
+namespace
+{
+	constexpr size_t sBlockSize = 16;
 
-Lexer::Lexer(const std::string& Source) : mSource(Source)
-{}
+#if VK_LEXER_SSE2
+	// bit i is set when byte i of the block is one of the characters
+	inline uint32_t MatchBlock(const char* block, const char* set, size_t count)
+	{
+		__m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+		__m128i hits = _mm_setzero_si128();
 
-Token& Lexer::NextToken()
-{
-	SkipWhiteSpaces();
-	return mTokens.emplace_back(ReadUntilDelimiterHits());
-}
+		for (size_t i = 0; i < count; i++)
+			hits = _mm_or_si128(hits, _mm_cmpeq_epi8(data, _mm_set1_epi8(set[i])));
 
-const std::vector<Token>& Lexer::CreateTokenStream()
-{
-	Reset();
-	Lex();
-	return mTokens;
-}
+		return static_cast<uint32_t>(_mm_movemask_epi8(hits));
+	}
+#endif
 
-void Lexer::Reset()
-{
-	mTokens.clear();
-	mPlace = 0;
-	mLineNumber = 0;
-	mCharOffset = 0;
+	void CountLines(std::string_view source, size_t begin, size_t end, VK_NAMESPACE::LexerCursor& cursor)
+	{
+		const char* data = source.data();
+
+		while (begin < end)
+		{
+			auto found = static_cast<const char*>(std::memchr(data + begin, '\n', end - begin));
+
+			if (!found)
+				return;
+
+			begin = found - data + 1;
+
+			cursor.LineNumber++;
+			cursor.LineStart = begin;
+		}
+	}
+
+	VK_NAMESPACE::LexerCursor MakeCursor(std::string_view source, size_t position)
+	{
+		VK_NAMESPACE::LexerCursor cursor;
+		CountLines(source, 0, position, cursor);
+		cursor.Position = position;
+
+		return cursor;
+	}
 }
 
-void Lexer::SetWhiteSpacesAndDelimiters(const std::string& spaces, const std::string& delimiters)
+VK_BEGIN
+
+CharClassTable::CharClassTable()
+	: CharClassTable({}, {}) {}
+
+CharClassTable::CharClassTable(std::string_view spaces, std::string_view delimiters)
 {
-	mWhiteSpaces = spaces;
-	mDelimiters = delimiters;
+	for (char val : spaces)
+		mClasses[static_cast<uint8_t>(val)] |= eWhiteSpace | eDelimiter;
+
+	for (char val : delimiters)
+		mClasses[static_cast<uint8_t>(val)] |= eDelimiter;
 
-	mDelimiters.append(mWhiteSpaces);
+	mClasses[0] = eDelimiter;
+
+	for (size_t i = 0; i < mClasses.size(); i++)
+	{
+		if ((mClasses[i] & eWhiteSpace) && mWhiteSpaceCount++ < mWhiteSpaces.size())
+			mWhiteSpaces[mWhiteSpaceCount - 1] = static_cast<char>(i);
+
+		if ((mClasses[i] & eDelimiter) && mDelimiterCount++ < mDelimiters.size())
+			mDelimiters[mDelimiterCount - 1] = static_cast<char>(i);
+	}
 }
 
-void Lexer::Lex()
+size_t CharClassTable::SkipWhiteSpaces(std::string_view source, size_t position) const
 {
-	while (NextToken().Value.front()) {}
+	size_t size = source.size();
+
+	// a single space between two tokens is the common case
+	if (position < size && !IsWhiteSpace(source[position]))
+		return position;
+
+#if VK_LEXER_SSE2
+	if (mWhiteSpaceCount <= sMaxBlockScanSet)
+	{
+		for (; position + sBlockSize <= size; position += sBlockSize)
+		{
+			uint32_t others = ~MatchBlock(source.data() + position, mWhiteSpaces.data(), mWhiteSpaceCount) & 0xffff;
+
+			if (others)
+				return position + std::countr_zero(others);
+		}
+	}
+#endif
+
+	while (position < size && IsWhiteSpace(source[position]))
+		position++;
+
+	return position;
 }
 
-void Lexer::SkipWhiteSpaces()
+size_t CharClassTable::FindDelimiter(std::string_view source, size_t position) const
 {
-	const char* Src = mSource.c_str();
-	char Current = Src[mPlace];
+	size_t size = source.size();
 
-	while (IsInString(Current, mWhiteSpaces) && Current != 0)
+#if VK_LEXER_SSE2
+	if (mDelimiterCount <= sMaxBlockScanSet)
 	{
-		Current = Src[++mPlace];
-		UpdateState(Current);
+		for (; position + sBlockSize <= size; position += sBlockSize)
+		{
+			uint32_t hits = MatchBlock(source.data() + position, mDelimiters.data(), mDelimiterCount);
+
+			if (hits)
+				return position + std::countr_zero(hits);
+		}
 	}
+#endif
+
+	while (position < size && !IsDelimiter(source[position]))
+		position++;
+
+	return position;
 }
 
-Token Lexer::ReadUntilDelimiterHits()
+TokenView CharClassTable::Scan(std::string_view source, LexerCursor& cursor) const
 {
-	Token next;
-	next.LineNumber = static_cast<int>(mLineNumber);
-	next.CharOffset = static_cast<int>(mCharOffset);
+	size_t begin = SkipWhiteSpaces(source, cursor.Position);
 
-	size_t Initial = mPlace;
+	if (IsWhiteSpace('\n'))
+		CountLines(source, cursor.Position, begin, cursor);
 
-	const char* Src = mSource.c_str();
-	char Current = Increment();
+	cursor.Position = begin;
 
-	while (!IsInString(Current, mDelimiters) && Current != 0)
-		Current = Src[mPlace++];
+	TokenView next;
+	next.LineNumber = static_cast<int>(cursor.LineNumber);
+	next.CharOffset = static_cast<int>(begin - cursor.LineStart);
+	next.Position = begin;
 
-	size_t Length = mPlace - Initial;
-	next.Position = Initial;
-
-	if (Length == 1)
-	{
-		next.Value = Current;
+	if (begin == source.size() || source[begin] == 0)
 		return next;
-	}
 
-	mPlace--;
-	next.Value.reserve(--Length);
-	next.Value = mSource.substr(Initial, Length);
+	// every delimiter other than the white spaces stands alone
+	size_t end = IsDelimiter(source[begin]) ? begin + 1 : FindDelimiter(source, begin + 1);
+
+	if (source[begin] == '\n' || !IsDelimiter('\n'))
+		CountLines(source, begin, end, cursor);
+
+	cursor.Position = end;
+	next.Value = source.substr(begin, end - begin);
 
 	return next;
 }
 
-bool Lexer::IsInString(char val, const std::string& str)
+void TokenScanner::SetCursor(size_t position)
 {
-	auto found = std::find(str.begin(), str.end(), val);
-	return found != str.end();
+	mCursor = MakeCursor(mSource, std::min(position, mSource.size()));
 }
 
-void Lexer::SetCursor(size_t position)
+Lexer::Lexer(const std::string& Source) : mSource(Source)
+{}
+
+Token& Lexer::NextToken()
 {
-	_STL_ASSERT(position <= mSource.size(), "Cursor position out of bounds!");
-	mPlace = position;
+	TokenView view = mClasses.Scan(mSource, mCursor);
+
+	Token& next = mTokens.emplace_back();
+	next.Value = view.Value.empty() ? std::string(1, '\0') : std::string(view.Value);
+	next.LineNumber = view.LineNumber;
+	next.CharOffset = view.CharOffset;
+	next.Position = view.Position;
+
+	return next;
 }
 
-const char& Lexer::Increment()
+const std::vector<Token>& Lexer::CreateTokenStream()
 {
-	const char& Current = mSource[mPlace++];
-
-	if (Current == '\n')
-	{
-		mLineNumber++;
-		mCharOffset = 0;
-		return Current;
-	}
+	Reset();
+	Lex();
+	return mTokens;
+}
 
-	mCharOffset++;
+void Lexer::Reset()
+{
+	mTokens.clear();
+	mCursor = {};
+}
 
-	return Current;
+void Lexer::SetWhiteSpacesAndDelimiters(const std::string& spaces, const std::string& delimiters)
+{
+	mClasses = CharClassTable(spaces, delimiters);
 }
 
-void Lexer::UpdateState(char Current)
+void Lexer::Lex()
 {
-	if (Current == '\n')
-	{
-		mLineNumber++;
-		mCharOffset = 0;
-		return;
-	}
+	while (NextToken().Value.front()) {}
+}
 
-	mCharOffset++;
+void Lexer::SetCursor(size_t position)
+{
+	_STL_ASSERT(position <= mSource.size(), "Cursor position out of bounds!");
+	mCursor = MakeCursor(mSource, position);
 }
 
-VK_END
\ No newline at end of file
+VK_END
@@ -0,0 +1,78 @@
+#include "Core/vkpch.h"
+#include "ShaderCompiler/ReflectionCache.h"
+
+VK_NAMESPACE::SPIRVCacheKey VK_NAMESPACE::ReflectionCache::ComputeKey(
+	std::span<const uint32_t> byteCode, vk::ShaderStageFlagBits stage)
+{
+	// word at a time, SPIR-V is already a sequence of 32 bit words
+	uint64_t high = 0xcbf29ce484222325ull ^ static_cast<uint32_t>(stage);
+	uint64_t low = 0x6a09e667f3bcc909ull ^ (uint64_t(byteCode.size()) << 32);
+
+	for (uint32_t word : byteCode)
+	{
+		high = (high ^ word) * 0x100000001b3ull;
+
+		low = (low ^ word) * 0x9e3779b97f4a7c15ull;
+		low ^= low >> 29;
+	}
+
+	low ^= low >> 33;
+	low *= 0xff51afd7ed558ccdull;
+	low ^= low >> 33;
+
+	return { high, low };
+}
+
+std::shared_ptr<const VK_NAMESPACE::ReflectionData> VK_NAMESPACE::ReflectionCache::Find(const SPIRVCacheKey& key) const
+{
+	std::shared_lock locker(mLock);
+
+	auto found = mEntries.find(key);
+
+	if (found == mEntries.end())
+	{
+		mMisses++;
+		return nullptr;
+	}
+
+	mHits++;
+	return found->second;
+}
+
+std::shared_ptr<const VK_NAMESPACE::ReflectionData> VK_NAMESPACE::ReflectionCache::Store(
+	const SPIRVCacheKey& key, ReflectionData data)
+{
+	auto entry = std::make_shared<const ReflectionData>(std::move(data));
+
+	std::unique_lock locker(mLock);
+
+	auto [found, inserted] = mEntries.try_emplace(key, std::move(entry));
+	return found->second;
+}
+
+void VK_NAMESPACE::ReflectionCache::Clear()
+{
+	std::unique_lock locker(mLock);
+	mEntries.clear();
+}
+
+VK_NAMESPACE::ReflectionCacheStats VK_NAMESPACE::ReflectionCache::GetStats() const
+{
+	ReflectionCacheStats stats{};
+	stats.Hits = mHits;
+	stats.Misses = mMisses;
+
+	return stats;
+}
+
+size_t VK_NAMESPACE::ReflectionCache::GetEntryCount() const
+{
+	std::shared_lock locker(mLock);
+	return mEntries.size();
+}
+
+std::shared_ptr<VK_NAMESPACE::ReflectionCache> VK_NAMESPACE::ReflectionCache::GetDefault()
+{
+	static std::shared_ptr<ReflectionCache> sDefaultCache = std::make_shared<ReflectionCache>();
+	return sDefaultCache;
+}
@@ -0,0 +1,312 @@
+#include "Core/vkpch.h"
+#include "ShaderCompiler/SPIRVCache.h"
+
+namespace
+{
+	// two independent 64 bit streams, FNV-1a and a multiply-xorshift, make up the 128 bit key
+	class KeyHasher
+	{
+	public:
+		void Update(const void* data, size_t size)
+		{
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+			for (size_t i = 0; i < size; i++)
+			{
+				mFnv = (mFnv ^ bytes[i]) * 0x100000001b3ull;
+
+				mMix = (mMix ^ bytes[i]) * 0x9e3779b97f4a7c15ull;
+				mMix ^= mMix >> 29;
+			}
+		}
+
+		template <typename T>
+		void UpdateValue(const T& value) { Update(&value, sizeof(T)); }
+
+		// length prefixed so neighbouring fields can't run into each other
+		void UpdateString(std::string_view string)
+		{
+			UpdateValue(static_cast<uint64_t>(string.size()));
+			Update(string.data(), string.size());
+		}
+
+		VK_NAMESPACE::SPIRVCacheKey Finish() const
+		{
+			uint64_t mix = mMix;
+
+			mix ^= mix >> 33;
+			mix *= 0xff51afd7ed558ccdull;
+			mix ^= mix >> 33;
+
+			return { mFnv, mix };
+		}
+
+	private:
+		uint64_t mFnv = 0xcbf29ce484222325ull;
+		uint64_t mMix = 0x6a09e667f3bcc909ull;
+	};
+
+	struct EntryHeader
+	{
+		uint32_t Magic = 0;
+		uint32_t Version = 0;
+
+		uint64_t High = 0;
+		uint64_t Low = 0;
+
+		uint32_t Stage = 0;
+		uint32_t Reserved = 0;
+
+		uint64_t WordCount = 0;
+	};
+
+	constexpr uint32_t sEntryMagic = 0x56435053; // "SPCV"
+
+	std::mutex sDefaultLock;
+	std::shared_ptr<VK_NAMESPACE::SPIRVCache> sDefaultCache;
+}
+
+std::string VK_NAMESPACE::SPIRVCacheKey::ToString() const
+{
+	constexpr const char* sDigits = "0123456789abcdef";
+
+	std::string string(32, '0');
+
+	for (int i = 0; i < 16; i++)
+	{
+		string[15 - i] = sDigits[(High >> (4 * i)) & 0xf];
+		string[31 - i] = sDigits[(Low >> (4 * i)) & 0xf];
+	}
+
+	return string;
+}
+
+VK_NAMESPACE::SPIRVCache::SPIRVCache(const std::filesystem::path& directory /*= {}*/)
+{
+	if (directory.empty())
+		return;
+
+	mDirectory = directory / ("v" + std::to_string(sFormatVersion));
+
+	std::error_code error;
+	std::filesystem::create_directories(mDirectory, error);
+}
+
+VK_NAMESPACE::SPIRVCacheKey VK_NAMESPACE::SPIRVCache::ComputeKey(std::string_view preprocessedCode,
+	vk::ShaderStageFlagBits stage, const PreprocessorDirectives& macros, OptimizerFlag optimization,
+	const CompilerConfig& config)
+{
+	KeyHasher hasher;
+
+	hasher.UpdateValue(sFormatVersion);
+	hasher.UpdateString(preprocessedCode);
+
+	hasher.UpdateValue(static_cast<uint32_t>(stage));
+	hasher.UpdateValue(static_cast<uint32_t>(optimization));
+
+	hasher.UpdateValue(static_cast<int32_t>(config.VulkanVersion));
+	hasher.UpdateValue(static_cast<int32_t>(config.SPV_Version));
+	hasher.UpdateValue(static_cast<int32_t>(config.GlslVersion));
+
+	// the map's iteration order isn't stable, the same set has to produce the same key
+	std::vector<std::pair<std::string_view, std::string_view>> sorted(macros.begin(), macros.end());
+	std::ranges::sort(sorted);
+
+	hasher.UpdateValue(static_cast<uint64_t>(sorted.size()));
+
+	for (const auto& [name, definition] : sorted)
+	{
+		hasher.UpdateString(name);
+		hasher.UpdateString(definition);
+	}
+
+	return hasher.Finish();
+}
+
+std::shared_ptr<const VK_NAMESPACE::CompileResult> VK_NAMESPACE::SPIRVCache::Find(const SPIRVCacheKey& key)
+{
+	std::scoped_lock locker(mLock);
+
+	auto found = mEntries.find(key);
+
+	if (found == mEntries.end())
+		return nullptr;
+
+	mStats.MemoryHits++;
+	return found->second;
+}
+
+std::optional<std::vector<uint32_t>> VK_NAMESPACE::SPIRVCache::Load(
+	const SPIRVCacheKey& key, vk::ShaderStageFlagBits stage)
+{
+	auto miss = [this]()
+	{
+		std::scoped_lock locker(mLock);
+		mStats.Misses++;
+
+		return std::nullopt;
+	};
+
+	auto reject = [this]()
+	{
+		std::scoped_lock locker(mLock);
+		mStats.Misses++;
+		mStats.Rejected++;
+
+		return std::nullopt;
+	};
+
+	if (mDirectory.empty())
+		return miss();
+
+	std::ifstream file(GetEntryPath(key), std::ios::in | std::ios::binary);
+
+	if (!file)
+		return miss();
+
+	EntryHeader header{};
+
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return reject();
+
+	bool valid = header.Magic == sEntryMagic && header.Version == sFormatVersion &&
+		header.High == key.High && header.Low == key.Low &&
+		header.Stage == static_cast<uint32_t>(stage) && header.WordCount != 0;
+
+	if (!valid)
+		return reject();
+
+	std::vector<uint32_t> byteCode(static_cast<size_t>(header.WordCount));
+
+	if (!file.read(reinterpret_cast<char*>(byteCode.data()), byteCode.size() * sizeof(uint32_t)))
+		return reject();
+
+	// trailing bytes mean the entry isn't what the header claims
+	if (file.peek() != std::ifstream::traits_type::eof())
+		return reject();
+
+	std::scoped_lock locker(mLock);
+	mStats.DiskHits++;
+
+	return byteCode;
+}
+
+void VK_NAMESPACE::SPIRVCache::Store(const SPIRVCacheKey& key, const CompileResult& result, bool persist /*= true*/)
+{
+	if (result.Error.Type != ErrorType::eNone || result.SPIR_V.ByteCode.empty())
+		return;
+
+	auto entry = std::make_shared<CompileResult>(result);
+
+	// the sources can be large and differ between hits anyway, callers put their own back
+	entry->Error.SrcCode.clear();
+	entry->Error.PreprocessedCode.clear();
+	entry->Error.FilePath.clear();
+	entry->Error.Info.clear();
+	entry->Error.DebugInfo.clear();
+
+	bool written = persist && !mDirectory.empty() && WriteEntry(key, result.SPIR_V);
+
+	std::scoped_lock locker(mLock);
+
+	mEntries[key] = std::move(entry);
+
+	mStats.Stores++;
+	mStats.DiskWrites += written ? 1 : 0;
+}
+
+void VK_NAMESPACE::SPIRVCache::Clear(bool removeFiles /*= false*/)
+{
+	std::scoped_lock locker(mLock);
+
+	mEntries.clear();
+
+	if (!removeFiles || mDirectory.empty())
+		return;
+
+	std::error_code error;
+
+	for (const auto& file : std::filesystem::directory_iterator(mDirectory, error))
+	{
+		if (file.path().extension() == ".spv")
+			std::filesystem::remove(file.path(), error);
+	}
+}
+
+VK_NAMESPACE::SPIRVCacheStats VK_NAMESPACE::SPIRVCache::GetStats() const
+{
+	std::scoped_lock locker(mLock);
+	return mStats;
+}
+
+size_t VK_NAMESPACE::SPIRVCache::GetEntryCount() const
+{
+	std::scoped_lock locker(mLock);
+	return mEntries.size();
+}
+
+void VK_NAMESPACE::SPIRVCache::SetDefault(std::shared_ptr<SPIRVCache> cache)
+{
+	std::scoped_lock locker(sDefaultLock);
+	sDefaultCache = std::move(cache);
+}
+
+std::shared_ptr<VK_NAMESPACE::SPIRVCache> VK_NAMESPACE::SPIRVCache::GetDefault()
+{
+	std::scoped_lock locker(sDefaultLock);
+	return sDefaultCache;
+}
+
+std::filesystem::path VK_NAMESPACE::SPIRVCache::GetEntryPath(const SPIRVCacheKey& key) const
+{
+	return mDirectory / (key.ToString() + ".spv");
+}
+
+bool VK_NAMESPACE::SPIRVCache::WriteEntry(const SPIRVCacheKey& key, const ShaderSPIR_V& spirv) const
+{
+	EntryHeader header{};
+	header.Magic = sEntryMagic;
+	header.Version = sFormatVersion;
+	header.High = key.High;
+	header.Low = key.Low;
+	header.Stage = static_cast<uint32_t>(spirv.Stage);
+	header.WordCount = spirv.ByteCode.size();
+
+	std::filesystem::path path = GetEntryPath(key);
+
+	// two threads storing the same key mustn't share a temporary
+	std::filesystem::path temporary = path;
+	temporary += "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+
+	std::error_code error;
+
+	{
+		std::ofstream file(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		if (!file)
+			return false;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(spirv.ByteCode.data()),
+			static_cast<std::streamsize>(spirv.ByteCode.size() * sizeof(uint32_t)));
+		file.flush();
+
+		if (!file)
+		{
+			file.close();
+			std::filesystem::remove(temporary, error);
+
+			return false;
+		}
+	}
+
+	std::filesystem::rename(temporary, path, error);
+
+	if (error)
+	{
+		std::filesystem::remove(temporary, error);
+		return false;
+	}
+
+	return true;
+}
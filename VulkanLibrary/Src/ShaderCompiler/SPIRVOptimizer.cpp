@@ -0,0 +1,227 @@
+#include "Core/vkpch.h"
+#include "ShaderCompiler/SPIRVOptimizer.h"
+
+namespace
+{
+	// magic, version, generator, bound, schema
+	constexpr size_t sHeaderWords = 5;
+
+	// calls func(opcode, words) for every instruction, stops at a malformed one
+	template <typename Fn>
+	void ForEachInstruction(std::span<const uint32_t> byteCode, Fn&& func)
+	{
+		size_t position = sHeaderWords;
+
+		while (position < byteCode.size())
+		{
+			uint32_t wordCount = byteCode[position] >> 16;
+
+			if (wordCount == 0 || position + wordCount > byteCode.size())
+				return;
+
+			func(static_cast<spv::Op>(byteCode[position] & 0xffff), byteCode.subspan(position, wordCount));
+			position += wordCount;
+		}
+	}
+
+	bool IsDebugInstruction(spv::Op opcode)
+	{
+		switch (opcode)
+		{
+			case spv::OpSourceContinued:
+			case spv::OpSource:
+			case spv::OpSourceExtension:
+			case spv::OpName:
+			case spv::OpMemberName:
+			case spv::OpString:
+			case spv::OpLine:
+			case spv::OpNoLine:
+			case spv::OpModuleProcessed:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	bool IsReflectedStorage(uint32_t storageClass)
+	{
+		switch (storageClass)
+		{
+			case spv::StorageClassUniformConstant:
+			case spv::StorageClassUniform:
+			case spv::StorageClassStorageBuffer:
+			case spv::StorageClassPushConstant:
+			case spv::StorageClassShaderRecordBufferKHR:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	// the ids whose names reach the reflection, resource variables, the types they point to
+	// and the specialization constants, PShader looks those up by name
+	std::unordered_set<uint32_t> CollectReflectedIDs(std::span<const uint32_t> byteCode)
+	{
+		std::unordered_map<uint32_t, uint32_t> pointees;
+		std::unordered_map<uint32_t, uint32_t> elements;
+		std::vector<uint32_t> pointers;
+
+		std::unordered_set<uint32_t> reflected;
+
+		ForEachInstruction(byteCode, [&](spv::Op opcode, std::span<const uint32_t> words)
+		{
+			if (opcode == spv::OpTypePointer && words.size() >= 4)
+				pointees[words[1]] = words[3];
+			else if ((opcode == spv::OpTypeArray || opcode == spv::OpTypeRuntimeArray) && words.size() >= 3)
+				elements[words[1]] = words[2];
+			else if (opcode == spv::OpVariable && words.size() >= 4 && IsReflectedStorage(words[3]))
+			{
+				reflected.insert(words[2]);
+				pointers.push_back(words[1]);
+			}
+			else if (opcode == spv::OpDecorate && words.size() >= 4 && words[2] == spv::DecorationSpecId)
+				reflected.insert(words[1]);
+		});
+
+		// pointer --> arrays of descriptors --> the block or image type
+		for (uint32_t pointer : pointers)
+		{
+			auto found = pointees.find(pointer);
+
+			if (found == pointees.end())
+				continue;
+
+			uint32_t type = found->second;
+
+			for (auto element = elements.find(type); element != elements.end(); element = elements.find(type))
+			{
+				reflected.insert(type);
+				type = element->second;
+			}
+
+			reflected.insert(type);
+		}
+
+		return reflected;
+	}
+
+	bool ImportsNonSemanticInfo(std::span<const uint32_t> byteCode)
+	{
+		bool imported = false;
+
+		ForEachInstruction(byteCode, [&imported](spv::Op opcode, std::span<const uint32_t> words)
+		{
+			if (opcode != spv::OpExtInstImport || words.size() < 3)
+				return;
+
+			auto name = reinterpret_cast<const char*>(words.data() + 2);
+			size_t length = strnlen(name, (words.size() - 2) * sizeof(uint32_t));
+
+			imported |= std::string_view(name, length).starts_with("NonSemantic.");
+		});
+
+		return imported;
+	}
+}
+
+VK_NAMESPACE::SPIRVModuleStats VK_NAMESPACE::SPIRVOptimizer::Measure(std::span<const uint32_t> byteCode)
+{
+	SPIRVModuleStats stats{};
+	stats.Words = byteCode.size();
+
+	ForEachInstruction(byteCode, [&stats](spv::Op opcode, std::span<const uint32_t>)
+	{
+		stats.Instructions++;
+		stats.DebugInstructions += IsDebugInstruction(opcode) ? 1 : 0;
+	});
+
+	return stats;
+}
+
+VK_NAMESPACE::SPIRVOptimizationReport VK_NAMESPACE::SPIRVOptimizer::Optimize(
+	std::vector<uint32_t>& byteCode, OptimizerFlag recipe, spv_target_env targetEnv /*= SPV_ENV_VULKAN_1_3*/)
+{
+	SPIRVOptimizationReport report{};
+	report.Before = Measure(byteCode);
+	report.After = report.Before;
+
+	if (recipe == OptimizerFlag::eNone)
+		return report;
+
+	std::vector<uint32_t> optimized;
+
+	spvtools::Optimizer optimizer(targetEnv);
+
+	if (recipe & OptimizerFlag::ePerformanceMask)
+		optimizer.RegisterPerformancePasses();
+
+	if (recipe & OptimizerFlag::eSize)
+		optimizer.RegisterSizePasses();
+
+	// a cheaper pipeline when nothing else is asked for, constants first so branching on them folds
+	if ((recipe & OptimizerFlag::eDeadBranches) && !(recipe & (OptimizerFlag::ePerformanceMask | OptimizerFlag::eSize)))
+	{
+		optimizer.RegisterPass(spvtools::CreateEliminateDeadFunctionsPass())
+			.RegisterPass(spvtools::CreateCCPPass())
+			.RegisterPass(spvtools::CreateDeadBranchElimPass())
+			.RegisterPass(spvtools::CreateAggressiveDCEPass())
+			.RegisterPass(spvtools::CreateCFGCleanupPass())
+			.RegisterPass(spvtools::CreateEliminateDeadConstantPass());
+	}
+
+	if (!optimizer.Run(byteCode.data(), byteCode.size(), &optimized))
+	{
+		report.Succeeded = false;
+		return report;
+	}
+
+	if (recipe & OptimizerFlag::eStripDebug)
+		StripDebugInfo(optimized);
+
+	if (!Validate(optimized, targetEnv))
+	{
+		report.Succeeded = false;
+		return report;
+	}
+
+	byteCode = std::move(optimized);
+	report.After = Measure(byteCode);
+
+	return report;
+}
+
+void VK_NAMESPACE::SPIRVOptimizer::StripDebugInfo(std::vector<uint32_t>& byteCode)
+{
+	if (byteCode.size() < sHeaderWords)
+		return;
+
+	auto reflected = CollectReflectedIDs(byteCode);
+
+	// the debug info extended sets refer to the OpStrings
+	bool keepStrings = ImportsNonSemanticInfo(byteCode);
+
+	std::vector<uint32_t> stripped(byteCode.begin(), byteCode.begin() + sHeaderWords);
+	stripped.reserve(byteCode.size());
+
+	ForEachInstruction(byteCode, [&](spv::Op opcode, std::span<const uint32_t> words)
+	{
+		bool keep = !IsDebugInstruction(opcode);
+
+		if ((opcode == spv::OpName || opcode == spv::OpMemberName) && words.size() >= 2)
+			keep = reflected.contains(words[1]);
+
+		if (opcode == spv::OpString)
+			keep = keepStrings;
+
+		if (keep)
+			stripped.insert(stripped.end(), words.begin(), words.end());
+	});
+
+	byteCode = std::move(stripped);
+}
+
+bool VK_NAMESPACE::SPIRVOptimizer::Validate(std::span<const uint32_t> byteCode, spv_target_env targetEnv /*= SPV_ENV_VULKAN_1_3*/)
+{
+	spvtools::SpirvTools tools(targetEnv);
+	return tools.Validate(byteCode.data(), byteCode.size());
+}
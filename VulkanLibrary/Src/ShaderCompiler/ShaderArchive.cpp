@@ -0,0 +1,776 @@
+#include "Core/vkpch.h"
+#include "ShaderCompiler/ShaderArchive.h"
+#include "ShaderCompiler/CompilerUtils.h"
+
+#if _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	constexpr uint32_t sArchiveMagic = 0x52414b56; // "VKAR"
+
+	struct ArchiveHeader
+	{
+		uint32_t Magic = 0;
+		uint32_t Version = 0;
+		uint32_t EntryCount = 0;
+		uint32_t Reserved = 0;
+
+		// the size of the whole file, anything else means it got cut short
+		uint64_t FileSize = 0;
+		uint64_t Reserved2 = 0;
+	};
+
+	// sorted by (NameHash, PermutationHash), directly follows the header
+	struct IndexRecord
+	{
+		uint64_t NameHash = 0;
+		uint64_t PermutationHash = 0;
+
+		uint64_t Offset = 0;
+		uint64_t Size = 0;
+	};
+
+	static_assert(sizeof(ArchiveHeader) == 32 && sizeof(IndexRecord) == 32);
+
+	class Fnv1a
+	{
+	public:
+		void Update(const void* data, size_t size)
+		{
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+			for (size_t i = 0; i < size; i++)
+				mHash = (mHash ^ bytes[i]) * 0x100000001b3ull;
+		}
+
+		template <typename T>
+		void UpdateValue(const T& value) { Update(&value, sizeof(T)); }
+
+		void UpdateString(std::string_view string)
+		{
+			UpdateValue(static_cast<uint64_t>(string.size()));
+			Update(string.data(), string.size());
+		}
+
+		uint64_t Get() const { return mHash; }
+
+	private:
+		uint64_t mHash = 0xcbf29ce484222325ull;
+	};
+
+	class EntryWriter
+	{
+	public:
+		void Write(uint32_t value) { Append(&value, sizeof(value)); }
+
+		void Write(std::string_view string)
+		{
+			Write(static_cast<uint32_t>(string.size()));
+			Append(string.data(), string.size());
+		}
+
+		void Append(const void* data, size_t size)
+		{
+			const std::byte* bytes = static_cast<const std::byte*>(data);
+			mBytes.insert(mBytes.end(), bytes, bytes + size);
+		}
+
+		std::vector<std::byte> Release() { return std::move(mBytes); }
+
+	private:
+		std::vector<std::byte> mBytes;
+	};
+
+	// every read is bounds checked, a corrupted entry turns into a miss rather than a crash
+	class EntryReader
+	{
+	public:
+		EntryReader(const std::byte* data, size_t size)
+			: mData(data), mSize(size) {}
+
+		bool Read(uint32_t& value) { return Copy(&value, sizeof(value)); }
+
+		bool Read(std::string& string)
+		{
+			uint32_t size = 0;
+
+			if (!Read(size) || size > mSize - mCursor)
+				return false;
+
+			string.assign(reinterpret_cast<const char*>(mData + mCursor), size);
+			mCursor += size;
+
+			return true;
+		}
+
+		bool Copy(void* dst, size_t size)
+		{
+			if (size > mSize - mCursor)
+				return false;
+
+			std::memcpy(dst, mData + mCursor, size);
+			mCursor += size;
+
+			return true;
+		}
+
+		bool IsAtEnd() const { return mCursor == mSize; }
+		size_t GetRemaining() const { return mSize - mCursor; }
+
+	private:
+		const std::byte* mData = nullptr;
+		size_t mSize = 0;
+		size_t mCursor = 0;
+	};
+
+	std::vector<std::byte> SerializeEntry(std::string_view name, const VK_NAMESPACE::CompileResult& result,
+		const std::vector<VK_NAMESPACE::ShaderArchiveSource>& sources)
+	{
+		EntryWriter writer;
+
+		writer.Write(name);
+		writer.Write(static_cast<uint32_t>(result.SPIR_V.Stage));
+
+		writer.Write(static_cast<uint32_t>(sources.size()));
+
+		for (const auto& source : sources)
+		{
+			writer.Write(source.Name);
+			writer.Append(&source.Hash, sizeof(source.Hash));
+		}
+
+		writer.Write(result.MetaData.WorkGroupSize.x);
+		writer.Write(result.MetaData.WorkGroupSize.y);
+		writer.Write(result.MetaData.WorkGroupSize.z);
+
+		writer.Write(result.MetaData.WorkGroupSizeIDs.x);
+		writer.Write(result.MetaData.WorkGroupSizeIDs.y);
+		writer.Write(result.MetaData.WorkGroupSizeIDs.z);
+
+		writer.Write(static_cast<uint32_t>(result.MetaData.SpecConstants.size()));
+
+		for (const auto& constant : result.MetaData.SpecConstants)
+		{
+			writer.Write(constant.ConstantID);
+			writer.Write(constant.Name);
+			writer.Write(static_cast<uint32_t>(constant.Type));
+			writer.Append(&constant.DefaultValue, sizeof(constant.DefaultValue));
+		}
+
+		const auto& byteCode = result.SPIR_V.ByteCode;
+
+		writer.Write(static_cast<uint32_t>(byteCode.size()));
+		writer.Append(byteCode.data(), byteCode.size() * sizeof(uint32_t));
+
+		const auto& layout = result.LayoutData;
+
+		writer.Write(static_cast<uint32_t>(layout.DescInfos.size()));
+
+		for (const auto& desc : layout.DescInfos)
+		{
+			writer.Write(desc.SetIndex);
+			writer.Write(desc.BindingIndex);
+			writer.Write(desc.Name);
+			writer.Write(static_cast<uint32_t>(desc.DescType));
+		}
+
+		writer.Write(static_cast<uint32_t>(layout.PushConstantsData.size()));
+
+		for (const auto& range : layout.PushConstantsData)
+		{
+			writer.Write(static_cast<uint32_t>(range.stageFlags));
+			writer.Write(range.offset);
+			writer.Write(range.size);
+		}
+
+		writer.Write(static_cast<uint32_t>(layout.PushConstantSubrangeInfos.size()));
+
+		for (const auto& [subrangeName, range] : layout.PushConstantSubrangeInfos)
+		{
+			writer.Write(subrangeName);
+			writer.Write(static_cast<uint32_t>(range.stageFlags));
+			writer.Write(range.offset);
+			writer.Write(range.size);
+		}
+
+		writer.Write(static_cast<uint32_t>(result.SetLayoutBindingsMap.size()));
+
+		for (const auto& [setIndex, bindings] : result.SetLayoutBindingsMap)
+		{
+			writer.Write(setIndex);
+			writer.Write(static_cast<uint32_t>(bindings.size()));
+
+			for (const auto& binding : bindings)
+			{
+				writer.Write(binding.binding);
+				writer.Write(static_cast<uint32_t>(binding.descriptorType));
+				writer.Write(binding.descriptorCount);
+				writer.Write(static_cast<uint32_t>(binding.stageFlags));
+			}
+		}
+
+		return writer.Release();
+	}
+
+	// the name, the stage and the sources, enough to tell whether the rest is worth reading
+	bool DeserializeHeader(EntryReader& reader, std::string_view name, VK_NAMESPACE::CompileResult& result,
+		std::vector<VK_NAMESPACE::ShaderArchiveSource>& sources)
+	{
+		std::string storedName;
+		uint32_t stage = 0;
+		uint32_t count = 0;
+
+		if (!reader.Read(storedName) || storedName != name || !reader.Read(stage) || !reader.Read(count))
+			return false;
+
+		result.SPIR_V.Stage = static_cast<vk::ShaderStageFlagBits>(stage);
+		result.MetaData.ShaderType = result.SPIR_V.Stage;
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			auto& source = sources.emplace_back();
+
+			if (!reader.Read(source.Name) || !reader.Copy(&source.Hash, sizeof(source.Hash)))
+				return false;
+		}
+
+		return true;
+	}
+
+	bool DeserializeEntry(EntryReader& reader, VK_NAMESPACE::CompileResult& result)
+	{
+
+		auto& workGroup = result.MetaData.WorkGroupSize;
+
+		if (!reader.Read(workGroup.x) || !reader.Read(workGroup.y) || !reader.Read(workGroup.z))
+			return false;
+
+		auto& workGroupIDs = result.MetaData.WorkGroupSizeIDs;
+
+		if (!reader.Read(workGroupIDs.x) || !reader.Read(workGroupIDs.y) || !reader.Read(workGroupIDs.z))
+			return false;
+
+		uint32_t count = 0;
+
+		if (!reader.Read(count))
+			return false;
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			auto& constant = result.MetaData.SpecConstants.emplace_back();
+			uint32_t type = 0;
+
+			if (!reader.Read(constant.ConstantID) || !reader.Read(constant.Name) || !reader.Read(type) ||
+				!reader.Copy(&constant.DefaultValue, sizeof(constant.DefaultValue)))
+				return false;
+
+			constant.Type = static_cast<VK_NAMESPACE::SpecializationType>(type);
+		}
+
+		// checked before sizing anything by it
+		if (!reader.Read(count) || count > reader.GetRemaining() / sizeof(uint32_t))
+			return false;
+
+		result.SPIR_V.ByteCode.resize(count);
+
+		if (!reader.Copy(result.SPIR_V.ByteCode.data(), count * sizeof(uint32_t)))
+			return false;
+
+		auto& layout = result.LayoutData;
+
+		if (!reader.Read(count))
+			return false;
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			auto& desc = layout.DescInfos.emplace_back();
+			uint32_t type = 0;
+
+			if (!reader.Read(desc.SetIndex) || !reader.Read(desc.BindingIndex) ||
+				!reader.Read(desc.Name) || !reader.Read(type))
+				return false;
+
+			desc.DescType = static_cast<vk::DescriptorType>(type);
+		}
+
+		if (!reader.Read(count))
+			return false;
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			auto& range = layout.PushConstantsData.emplace_back();
+			uint32_t stageFlags = 0;
+
+			if (!reader.Read(stageFlags) || !reader.Read(range.offset) || !reader.Read(range.size))
+				return false;
+
+			range.stageFlags = static_cast<vk::ShaderStageFlags>(stageFlags);
+		}
+
+		if (!reader.Read(count))
+			return false;
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			std::string subrangeName;
+			vk::PushConstantRange range{};
+			uint32_t stageFlags = 0;
+
+			if (!reader.Read(subrangeName) || !reader.Read(stageFlags) ||
+				!reader.Read(range.offset) || !reader.Read(range.size))
+				return false;
+
+			range.stageFlags = static_cast<vk::ShaderStageFlags>(stageFlags);
+			layout.PushConstantSubrangeInfos[subrangeName] = range;
+		}
+
+		if (!reader.Read(count))
+			return false;
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			uint32_t setIndex = 0;
+			uint32_t bindingCount = 0;
+
+			if (!reader.Read(setIndex) || !reader.Read(bindingCount))
+				return false;
+
+			auto& bindings = result.SetLayoutBindingsMap[setIndex];
+
+			for (uint32_t j = 0; j < bindingCount; j++)
+			{
+				auto& binding = bindings.emplace_back();
+				uint32_t type = 0;
+				uint32_t stageFlags = 0;
+
+				if (!reader.Read(binding.binding) || !reader.Read(type) ||
+					!reader.Read(binding.descriptorCount) || !reader.Read(stageFlags))
+					return false;
+
+				binding.descriptorType = static_cast<vk::DescriptorType>(type);
+				binding.stageFlags = static_cast<vk::ShaderStageFlags>(stageFlags);
+			}
+		}
+
+		return reader.IsAtEnd();
+	}
+
+	std::mutex sDefaultLock;
+	std::shared_ptr<VK_NAMESPACE::ShaderArchive> sDefaultArchive;
+}
+
+struct VK_NAMESPACE::ShaderArchive::MappedFile
+{
+#if _WIN32
+	HANDLE File = INVALID_HANDLE_VALUE;
+	HANDLE Mapping = nullptr;
+#else
+	int File = -1;
+#endif
+
+	void* Data = nullptr;
+	size_t Size = 0;
+
+	bool Map(const std::filesystem::path& path)
+	{
+	#if _WIN32
+		File = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (File == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER fileSize{};
+
+		if (!GetFileSizeEx(File, &fileSize) || fileSize.QuadPart == 0)
+			return false;
+
+		Mapping = CreateFileMappingW(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (!Mapping)
+			return false;
+
+		Data = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+		Size = static_cast<size_t>(fileSize.QuadPart);
+	#else
+		File = open(path.c_str(), O_RDONLY);
+
+		if (File < 0)
+			return false;
+
+		struct stat status{};
+
+		if (fstat(File, &status) != 0 || status.st_size == 0)
+			return false;
+
+		Data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, File, 0);
+
+		if (Data == MAP_FAILED)
+			Data = nullptr;
+
+		Size = static_cast<size_t>(status.st_size);
+	#endif
+
+		return Data != nullptr;
+	}
+
+	~MappedFile()
+	{
+	#if _WIN32
+		if (Data)
+			UnmapViewOfFile(Data);
+		if (Mapping)
+			CloseHandle(Mapping);
+		if (File != INVALID_HANDLE_VALUE)
+			CloseHandle(File);
+	#else
+		if (Data)
+			munmap(Data, Size);
+		if (File >= 0)
+			close(File);
+	#endif
+	}
+};
+
+VK_NAMESPACE::ShaderArchive::~ShaderArchive() = default;
+
+std::shared_ptr<VK_NAMESPACE::ShaderArchive> VK_NAMESPACE::ShaderArchive::Open(
+	const std::filesystem::path& archivePath, const std::filesystem::path& sourceRoot)
+{
+	auto file = std::make_unique<MappedFile>();
+
+	if (!file->Map(archivePath) || file->Size < sizeof(ArchiveHeader))
+		return nullptr;
+
+	ArchiveHeader header{};
+	std::memcpy(&header, file->Data, sizeof(header));
+
+	bool valid = header.Magic == sArchiveMagic && header.Version == sFormatVersion &&
+		header.FileSize == file->Size &&
+		sizeof(ArchiveHeader) + uint64_t(header.EntryCount) * sizeof(IndexRecord) <= file->Size;
+
+	if (!valid)
+		return nullptr;
+
+	std::shared_ptr<ShaderArchive> archive(new ShaderArchive());
+
+	archive->mData = static_cast<const std::byte*>(file->Data);
+	archive->mSize = file->Size;
+	archive->mEntryCount = header.EntryCount;
+	archive->mFile = std::move(file);
+
+	std::error_code error;
+	archive->mSourceRoot = std::filesystem::weakly_canonical(sourceRoot, error);
+
+	if (error)
+		archive->mSourceRoot = std::filesystem::absolute(sourceRoot).lexically_normal();
+
+	return archive;
+}
+
+uint64_t VK_NAMESPACE::ShaderArchive::HashName(std::string_view name)
+{
+	Fnv1a hasher;
+	hasher.UpdateString(name);
+
+	return hasher.Get();
+}
+
+uint64_t VK_NAMESPACE::ShaderArchive::HashSource(std::string_view contents)
+{
+	Fnv1a hasher;
+	hasher.Update(contents.data(), contents.size());
+
+	return hasher.Get();
+}
+
+uint64_t VK_NAMESPACE::ShaderArchive::HashPermutation(vk::ShaderStageFlagBits stage,
+	const PreprocessorDirectives& macros, OptimizerFlag optimization, const CompilerConfig& config)
+{
+	Fnv1a hasher;
+
+	hasher.UpdateValue(static_cast<uint32_t>(stage));
+	hasher.UpdateValue(static_cast<uint32_t>(optimization));
+
+	hasher.UpdateValue(static_cast<int32_t>(config.VulkanVersion));
+	hasher.UpdateValue(static_cast<int32_t>(config.SPV_Version));
+	hasher.UpdateValue(static_cast<int32_t>(config.GlslVersion));
+
+	std::vector<std::pair<std::string_view, std::string_view>> sorted(macros.begin(), macros.end());
+	std::ranges::sort(sorted);
+
+	hasher.UpdateValue(static_cast<uint64_t>(sorted.size()));
+
+	for (const auto& [macro, definition] : sorted)
+	{
+		hasher.UpdateString(macro);
+		hasher.UpdateString(definition);
+	}
+
+	return hasher.Get();
+}
+
+std::optional<std::string> VK_NAMESPACE::ShaderArchive::GetName(const std::filesystem::path& shaderPath) const
+{
+	std::error_code error;
+	auto absolute = std::filesystem::weakly_canonical(shaderPath, error);
+
+	if (error)
+		return std::nullopt;
+
+	auto relative = absolute.lexically_relative(mSourceRoot);
+
+	if (relative.empty() || *relative.begin() == "..")
+		return std::nullopt;
+
+	return relative.generic_string();
+}
+
+std::optional<VK_NAMESPACE::CompileResult> VK_NAMESPACE::ShaderArchive::Find(std::string_view name,
+	vk::ShaderStageFlagBits stage, const PreprocessorDirectives& macros, OptimizerFlag optimization,
+	const CompilerConfig& config) const
+{
+	{
+		std::shared_lock locker(mStaleLock);
+
+		if (mStale.contains(std::string(name)))
+		{
+			mMisses++;
+			return std::nullopt;
+		}
+	}
+
+	IndexRecord key{};
+	key.NameHash = HashName(name);
+	key.PermutationHash = HashPermutation(stage, macros, optimization, config);
+
+	auto index = reinterpret_cast<const IndexRecord*>(mData + sizeof(ArchiveHeader));
+
+	auto found = std::lower_bound(index, index + mEntryCount, key, [](const IndexRecord& lhs, const IndexRecord& rhs)
+	{
+		return std::tie(lhs.NameHash, lhs.PermutationHash) < std::tie(rhs.NameHash, rhs.PermutationHash);
+	});
+
+	if (found == index + mEntryCount || found->NameHash != key.NameHash ||
+		found->PermutationHash != key.PermutationHash)
+	{
+		mMisses++;
+		return std::nullopt;
+	}
+
+	if (found->Offset > mSize || found->Size > mSize - found->Offset)
+	{
+		mRejected++;
+		mMisses++;
+		return std::nullopt;
+	}
+
+	CompileResult result;
+	result.Config = config;
+	result.Error.ShaderStage = stage;
+
+	EntryReader reader(mData + found->Offset, static_cast<size_t>(found->Size));
+	std::vector<ShaderArchiveSource> sources;
+
+	if (!DeserializeHeader(reader, name, result, sources) || result.SPIR_V.Stage != stage)
+	{
+		mRejected++;
+		mMisses++;
+		return std::nullopt;
+	}
+
+	if (!IsCurrent(sources))
+	{
+		mOutdated++;
+		mMisses++;
+		return std::nullopt;
+	}
+
+	if (!DeserializeEntry(reader, result))
+	{
+		mRejected++;
+		mMisses++;
+		return std::nullopt;
+	}
+
+	mHits++;
+	return result;
+}
+
+bool VK_NAMESPACE::ShaderArchive::IsCurrent(const std::vector<ShaderArchiveSource>& sources) const
+{
+	for (const auto& source : sources)
+	{
+		std::filesystem::path path(source.Name);
+
+		if (path.is_relative())
+			path = mSourceRoot / path;
+
+		auto hash = HashFile(path);
+
+		if (!hash || *hash != source.Hash)
+			return false;
+	}
+
+	return true;
+}
+
+std::optional<uint64_t> VK_NAMESPACE::ShaderArchive::HashFile(const std::filesystem::path& path) const
+{
+	std::error_code error;
+
+	auto writeTime = std::filesystem::last_write_time(path, error);
+
+	if (error)
+		return std::nullopt;
+
+	auto size = std::filesystem::file_size(path, error);
+
+	if (error)
+		return std::nullopt;
+
+	{
+		std::scoped_lock locker(mSourceLock);
+
+		auto found = mSourceStamps.find(path);
+
+		if (found != mSourceStamps.end() && found->second.WriteTime == writeTime && found->second.Size == size)
+			return found->second.Hash;
+	}
+
+	// read in the same mode the include cache reads in, the hashes have to agree
+	auto contents = ReadFile(path.string());
+
+	if (!contents)
+		return std::nullopt;
+
+	uint64_t hash = HashSource(*contents);
+
+	std::scoped_lock locker(mSourceLock);
+	mSourceStamps[path] = { writeTime, size, hash };
+
+	return hash;
+}
+
+void VK_NAMESPACE::ShaderArchive::MarkStale(const std::filesystem::path& shaderPath)
+{
+	auto name = GetName(shaderPath);
+
+	if (!name)
+		return;
+
+	std::unique_lock locker(mStaleLock);
+	mStale.insert(std::move(*name));
+}
+
+VK_NAMESPACE::ShaderArchiveStats VK_NAMESPACE::ShaderArchive::GetStats() const
+{
+	ShaderArchiveStats stats{};
+	stats.Hits = mHits;
+	stats.Misses = mMisses;
+	stats.Rejected = mRejected;
+	stats.Outdated = mOutdated;
+
+	return stats;
+}
+
+void VK_NAMESPACE::ShaderArchive::SetDefault(std::shared_ptr<ShaderArchive> archive)
+{
+	std::scoped_lock locker(sDefaultLock);
+	sDefaultArchive = std::move(archive);
+}
+
+std::shared_ptr<VK_NAMESPACE::ShaderArchive> VK_NAMESPACE::ShaderArchive::GetDefault()
+{
+	std::scoped_lock locker(sDefaultLock);
+	return sDefaultArchive;
+}
+
+bool VK_NAMESPACE::ShaderArchiveWriter::Add(std::string_view name, const PreprocessorDirectives& macros, OptimizerFlag optimization,
+	const CompilerConfig& config, const CompileResult& result, const std::vector<ShaderArchiveSource>& sources)
+{
+	// an entry without sources could never be found outdated
+	if (result.Error.Type != ErrorType::eNone || result.SPIR_V.ByteCode.empty() || sources.empty())
+		return false;
+
+	uint64_t nameHash = ShaderArchive::HashName(name);
+	uint64_t permutationHash = ShaderArchive::HashPermutation(result.SPIR_V.Stage, macros, optimization, config);
+
+	mEntries[{ nameHash, permutationHash }] = SerializeEntry(name, result, sources);
+
+	return true;
+}
+
+bool VK_NAMESPACE::ShaderArchiveWriter::Write(const std::filesystem::path& archivePath) const
+{
+	ArchiveHeader header{};
+	header.Magic = sArchiveMagic;
+	header.Version = ShaderArchive::sFormatVersion;
+	header.EntryCount = static_cast<uint32_t>(mEntries.size());
+
+	std::vector<IndexRecord> index;
+	index.reserve(mEntries.size());
+
+	uint64_t offset = sizeof(ArchiveHeader) + mEntries.size() * sizeof(IndexRecord);
+
+	// the map is already ordered the way the reader searches it
+	for (const auto& [key, bytes] : mEntries)
+	{
+		index.push_back({ key.first, key.second, offset, bytes.size() });
+		offset += bytes.size();
+	}
+
+	header.FileSize = offset;
+
+	std::filesystem::path temporary = archivePath;
+	temporary += ".tmp";
+
+	std::error_code error;
+
+	{
+		std::ofstream file(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		if (!file)
+			return false;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(index.data()),
+			static_cast<std::streamsize>(index.size() * sizeof(IndexRecord)));
+
+		for (const auto& [key, bytes] : mEntries)
+			file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+		file.flush();
+
+		if (!file)
+		{
+			file.close();
+			std::filesystem::remove(temporary, error);
+
+			return false;
+		}
+	}
+
+	std::filesystem::rename(temporary, archivePath, error);
+
+	if (error)
+	{
+		std::filesystem::remove(temporary, error);
+		return false;
+	}
+
+	return true;
+}
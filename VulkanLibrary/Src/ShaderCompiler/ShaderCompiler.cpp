@@ -2,6 +2,7 @@
 #include "ShaderCompiler/ShaderCompiler.h"
 
 #include "ShaderCompiler/Lexer.h"
+#include "ShaderCompiler/SPIRVOptimizer.h"
 
 VK_BEGIN
 
@@ -117,6 +118,25 @@ private:
 
 } const sCompilerInitializer;
 
+// only the tokens of an #include directive matter to the include resolver
+static const CharClassTable sIncludeTokenClasses(" \t", "#<>\"\n");
+
+// the scalars Vulkan can specialize, the 8 and 16 bit ones are left out
+static std::optional<SpecializationType> GetSpecializationType(spirv_cross::SPIRType::BaseType type)
+{
+	switch (type)
+	{
+		case spirv_cross::SPIRType::Boolean:    return SpecializationType::eBool;
+		case spirv_cross::SPIRType::Int:        return SpecializationType::eInt;
+		case spirv_cross::SPIRType::UInt:       return SpecializationType::eUInt;
+		case spirv_cross::SPIRType::Float:      return SpecializationType::eFloat;
+		case spirv_cross::SPIRType::Int64:      return SpecializationType::eInt64;
+		case spirv_cross::SPIRType::UInt64:     return SpecializationType::eUInt64;
+		case spirv_cross::SPIRType::Double:     return SpecializationType::eDouble;
+		default:                                return std::nullopt;
+	}
+}
+
 VK_END
 
 std::string VK_NAMESPACE::ShaderCompiler::GetShaderStageString(vk::ShaderStageFlagBits flag)
@@ -140,13 +160,62 @@ VK_NAMESPACE::ShaderCompiler& VK_NAMESPACE::ShaderCompiler::operator=(const Shad
 }
 
 VK_NAMESPACE::CompileResult VK_NAMESPACE::ShaderCompiler::Compile(ShaderInput&& Input)
+{
+	auto Stats = mEnvironment.GetCompileStats();
+
+	if (!Stats)
+		Stats = CompileStatsRegistry::GetDefault();
+
+	if (!Stats)
+		return CompileInternal(std::move(Input), nullptr);
+
+	auto Macros = mEnvironment.GetMacroDefines();
+
+	std::vector<std::pair<std::string, std::string>> SortedMacros(Macros.begin(), Macros.end());
+	std::ranges::sort(SortedMacros);
+
+	CompileRecord Record;
+	Record.Name = Input.FilePath;
+	Record.Stage = Input.Stage;
+	Record.PermutationHash = ShaderArchive::HashPermutation(Input.Stage, Macros,
+		Input.OptimizationFlag, mEnvironment.GetConfig());
+
+	for (const auto& [Name, Value] : SortedMacros)
+		Record.Macros += (Record.Macros.empty() ? "" : ";") + Name + "=" + Value;
+
+	auto Start = std::chrono::steady_clock::now();
+
+	CompileResult Result = CompileInternal(std::move(Input), &Record);
+
+	Record.Total = std::chrono::steady_clock::now() - Start;
+	Record.Succeeded = Result.Error.Type == ErrorType::eNone;
+	Record.SourceSize = Result.Error.SrcCode.size();
+	Record.SPIRVSize = Result.SPIR_V.ByteCode.size() * sizeof(uint32_t);
+
+	Stats->Record(Record);
+
+	return Result;
+}
+
+VK_NAMESPACE::CompileResult VK_NAMESPACE::ShaderCompiler::CompileInternal(ShaderInput&& Input, CompileRecord* Record)
 {
 	CompileResult Result;
 	Result.Config = mEnvironment.GetConfig();
 	Result.Error.ShaderStage = Input.Stage;
 
+	if (!Input.FilePath.empty() && FetchArchived(Result, Input))
+	{
+		if (Record)
+			Record->Source = CompileSource::eArchive;
+
+		return Result;
+	}
+
 	if (!Input.FilePath.empty())
+	{
+		CompilePhaseTimer Timer(Record, CompilePhase::eIncludes);
 		ReadAndPreprocess(Result, Input);
+	}
 	else
 		Result.Error.SrcCode = std::move(Input.SrcCode);
 
@@ -157,20 +226,181 @@ VK_NAMESPACE::CompileResult VK_NAMESPACE::ShaderCompiler::Compile(ShaderInput&&
 
 	auto EShStage = ConvertShaderStage(Input.Stage);
 
-	if (!PreprocessShader(Result, EShStage))
-		return Result;
+	{
+		CompilePhaseTimer Timer(Record, CompilePhase::ePreprocess);
+
+		if (!PreprocessShader(Result, EShStage))
+			return Result;
+	}
+
+	auto Cache = mEnvironment.GetSPIRVCache();
+
+	if (!Cache)
+		Cache = SPIRVCache::GetDefault();
+
+	SPIRVCacheKey Key{};
+
+	if (Cache)
+	{
+		Key = SPIRVCache::ComputeKey(Result.Error.PreprocessedCode, Input.Stage,
+			mEnvironment.GetMacroDefines(), Input.OptimizationFlag, Result.Config);
+
+		if (FetchCached(Result, *Cache, Key))
+		{
+			if (Record)
+				Record->Source = CompileSource::eCache;
+
+			return Result;
+		}
+	}
 
-	if (!ParseShader(Result, EShStage))
+	if (!ParseShader(Result, EShStage, Record))
 		return Result;
 
-	OptimizeCode(Result, Input.OptimizationFlag);
+	{
+		CompilePhaseTimer Timer(Record, CompilePhase::eOptimize);
+		auto Report = OptimizeCode(Result, Input.OptimizationFlag);
+
+		if (Record)
+		{
+			Record->UnoptimizedInstructions = Report.Before.Instructions;
+			Record->Instructions = Report.After.Instructions;
+		}
+	}
+
+	{
+		CompilePhaseTimer Timer(Record, CompilePhase::eReflect);
+		Reflect(Result);
+	}
 
-	ReflectDescriptorLayouts(Result);
-	ReflectShaderMetaData(Result);
+	if (Cache)
+		Cache->Store(Key, Result);
 
 	return Result;
 }
 
+std::vector<VK_NAMESPACE::CompileResult> VK_NAMESPACE::ShaderCompiler::CompileBatch(
+	std::span<const ShaderInput> Inputs, uint32_t ThreadCount /*= 0*/)
+{
+	std::vector<CompileResult> Results(Inputs.size());
+
+	if (ThreadCount == 0)
+		ThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	ThreadCount = static_cast<uint32_t>(std::min<size_t>(ThreadCount, Inputs.size()));
+
+	if (ThreadCount <= 1)
+	{
+		for (size_t Index = 0; Index < Inputs.size(); Index++)
+			Results[Index] = Compile(Inputs[Index]);
+
+		return Results;
+	}
+
+	std::atomic<size_t> NextIndex = 0;
+
+	std::exception_ptr Failure;
+	std::mutex FailureLock;
+
+	auto Run = [this, Inputs, &Results, &NextIndex, &Failure, &FailureLock]()
+	{
+		// reference counted by glslang, keeps its per thread state alive for the whole batch
+		glslang::InitializeProcess();
+
+		ShaderCompiler Compiler(*this);
+
+		for (size_t Index = NextIndex++; Index < Inputs.size(); Index = NextIndex++)
+		{
+			try
+			{
+				Results[Index] = Compiler.Compile(Inputs[Index]);
+			}
+			catch (...)
+			{
+				std::scoped_lock Locker(FailureLock);
+
+				if (!Failure)
+					Failure = std::current_exception();
+			}
+		}
+
+		glslang::FinalizeProcess();
+	};
+
+	std::vector<std::thread> Threads;
+	Threads.reserve(ThreadCount - 1);
+
+	for (uint32_t Index = 1; Index < ThreadCount; Index++)
+		Threads.emplace_back(Run);
+
+	Run();
+
+	for (auto& Thread : Threads)
+		Thread.join();
+
+	if (Failure)
+		std::rethrow_exception(Failure);
+
+	return Results;
+}
+
+bool VK_NAMESPACE::ShaderCompiler::FetchArchived(CompileResult& Result, const ShaderInput& Input)
+{
+	auto Archive = mEnvironment.GetShaderArchive();
+
+	if (!Archive)
+		Archive = ShaderArchive::GetDefault();
+
+	if (!Archive)
+		return false;
+
+	auto Name = Archive->GetName(Input.FilePath);
+
+	if (!Name)
+		return false;
+
+	auto Entry = Archive->Find(*Name, Input.Stage, mEnvironment.GetMacroDefines(),
+		Input.OptimizationFlag, Result.Config);
+
+	if (!Entry)
+		return false;
+
+	Result = std::move(*Entry);
+	Result.Error.FilePath = Input.FilePath;
+
+	return true;
+}
+
+bool VK_NAMESPACE::ShaderCompiler::FetchCached(CompileResult& Result, SPIRVCache& Cache, const SPIRVCacheKey& Key)
+{
+	auto Stage = Result.Error.ShaderStage;
+
+	if (auto Entry = Cache.Find(Key))
+	{
+		Result.MetaData = Entry->MetaData;
+		Result.LayoutData = Entry->LayoutData;
+		Result.SetLayoutBindingsMap = Entry->SetLayoutBindingsMap;
+		Result.SPIR_V = Entry->SPIR_V;
+
+		return true;
+	}
+
+	auto ByteCode = Cache.Load(Key, Stage);
+
+	if (!ByteCode)
+		return false;
+
+	Result.SPIR_V.ByteCode = std::move(*ByteCode);
+	Result.SPIR_V.Stage = Stage;
+
+	// only the SPIR-V goes to disk, the reflection data is rebuilt from it
+	Reflect(Result);
+
+	Cache.Store(Key, Result, false);
+
+	return true;
+}
+
 VK_NAMESPACE::CompileResult VK_NAMESPACE::ShaderCompiler::PreprocessString(
 	const std::string& shaderString, vk::ShaderStageFlagBits stage)
 {
@@ -235,7 +465,7 @@ bool VK_NAMESPACE::ShaderCompiler::PreprocessShader(
 	return Success;
 }
 
-bool VK_NAMESPACE::ShaderCompiler::ParseShader(CompileResult& Result, EShLanguage Stage)
+bool VK_NAMESPACE::ShaderCompiler::ParseShader(CompileResult& Result, EShLanguage Stage, CompileRecord* Record)
 {
 	auto TShader = MakeGLSLangShader(mEnvironment, Stage);
 	const char* Source = Result.Error.PreprocessedCode.c_str();
@@ -253,8 +483,14 @@ bool VK_NAMESPACE::ShaderCompiler::ParseShader(CompileResult& Result, EShLanguag
 
 	glslang::TShader::ForbidIncluder basicIncluder = glslang::TShader::ForbidIncluder();
 
-	bool Success = TShader.parse(GetDefaultResources(), 100, EProfile::ENoProfile,
-		false, true, EShMsgDefault, basicIncluder);
+	bool Success = false;
+
+	{
+		CompilePhaseTimer Timer(Record, CompilePhase::eParse);
+
+		Success = TShader.parse(GetDefaultResources(), 100, EProfile::ENoProfile,
+			false, true, EShMsgDefault, basicIncluder);
+	}
 
 	if (!Success)
 	{
@@ -265,12 +501,14 @@ bool VK_NAMESPACE::ShaderCompiler::ParseShader(CompileResult& Result, EShLanguag
 		return Success;
 	}
 
-	return GenerateSPIR_V(Result, Stage, TShader);
+	return GenerateSPIR_V(Result, Stage, TShader, Record);
 }
 
 bool VK_NAMESPACE::ShaderCompiler::GenerateSPIR_V(
-	CompileResult& Result, EShLanguage Stage, glslang::TShader& shader)
+	CompileResult& Result, EShLanguage Stage, glslang::TShader& shader, CompileRecord* Record)
 {
+	CompilePhaseTimer Timer(Record, CompilePhase::eLink);
+
 	glslang::TProgram Program;
 	Program.addShader(&shader);
 
@@ -298,27 +536,10 @@ void VK_NAMESPACE::ShaderCompiler::ResetInternal(const CompilerConfig& new_in)
 	// Reset all the fields...
 }
 
-void VK_NAMESPACE::ShaderCompiler::OptimizeCode(CompileResult& Result, OptimizerFlag Flag)
+VK_NAMESPACE::SPIRVOptimizationReport VK_NAMESPACE::ShaderCompiler::OptimizeCode(CompileResult& Result, OptimizerFlag Flag)
 {
-	/********************* OPTIMIZATIONS **************************/
-	// Optimize for performance as much as we can for now
-
-	if (Flag != OptimizerFlag::eNone)
-	{
-
-		std::vector<uint32_t> OptimizedCode;
-
-		spvtools::Optimizer Optimizer(spv_target_env::SPV_ENV_VULKAN_1_3);
-
-		Optimizer.RegisterPerformancePasses();
-
-		bool Success = Optimizer.Run(Result.SPIR_V.ByteCode.data(), Result.SPIR_V.ByteCode.size(), &OptimizedCode);
-
-		if (Success)
-			Result.SPIR_V.ByteCode = std::move(OptimizedCode);
-	}
-
-	/**************************************************************/
+	// the module is validated after the passes, a failure keeps the unoptimized code
+	return SPIRVOptimizer::Optimize(Result.SPIR_V.ByteCode, Flag);
 }
 
 glslang::TShader VK_NAMESPACE::ShaderCompiler::MakeGLSLangShader(
@@ -347,23 +568,69 @@ void VK_NAMESPACE::ShaderCompiler::ReflectShaderMetaData(CompileResult& Result)
 
 	spirv_cross::CompilerGLSL compiler(ByteCode);
 
+	for (const auto& Constant : compiler.get_specialization_constants())
+	{
+		const auto& Value = compiler.get_constant(Constant.id);
+		const auto& ValueType = compiler.get_type(Value.constant_type);
+
+		auto Type = GetSpecializationType(ValueType.basetype);
+
+		if (!Type)
+			continue;
+
+		auto& Info = Result.MetaData.SpecConstants.emplace_back();
+		Info.ConstantID = Constant.constant_id;
+		Info.Name = compiler.get_name(Constant.id);
+		Info.Type = *Type;
+		Info.DefaultValue = ValueType.width == 64 ? Value.scalar_u64() : Value.scalar();
+	}
+
 	if (Result.MetaData.ShaderType == vk::ShaderStageFlagBits::eCompute)
 	{
 		spirv_cross::SPIREntryPoint entryPoint = compiler.get_entry_point("main", spv::ExecutionModelGLCompute);
 		Result.MetaData.WorkGroupSize.x = entryPoint.workgroup_size.x;
 		Result.MetaData.WorkGroupSize.y = entryPoint.workgroup_size.y;
 		Result.MetaData.WorkGroupSize.z = entryPoint.workgroup_size.z;
+
+		std::array<spirv_cross::SpecializationConstant, 3> SizeConstants{};
+		compiler.get_work_group_size_specialization_constants(SizeConstants[0], SizeConstants[1], SizeConstants[2]);
+
+		// the builtin's literal components show up here as well, only the decorated ones are sizes by id
+		for (glm::length_t i = 0; i < 3; i++)
+		{
+			uint32_t ID = SizeConstants[i].id;
+
+			if (ID == 0 || !compiler.has_decoration(ID, spv::DecorationSpecId))
+				continue;
+
+			Result.MetaData.WorkGroupSizeIDs[i] = SizeConstants[i].constant_id;
+			Result.MetaData.WorkGroupSize[i] = compiler.get_constant(ID).scalar();
+		}
 	}
 }
 
 bool VK_NAMESPACE::ShaderCompiler::ReadAndPreprocess(CompileResult& Result, const ShaderInput& Input)
 {
-	auto fileError = ReadFile(Input.FilePath);
+	auto IncludeCache = mEnvironment.GetIncludeCache();
 
-	if (!fileError)
-		return false;
+	if (IncludeCache)
+	{
+		auto Contents = IncludeCache->Read(Input.FilePath);
 
-	Result.Error.SrcCode = *fileError;
+		if (!Contents)
+			return false;
+
+		Result.Error.SrcCode = *Contents;
+	}
+	else
+	{
+		auto fileError = ReadFile(Input.FilePath);
+
+		if (!fileError)
+			return false;
+
+		Result.Error.SrcCode = *fileError;
+	}
 
 	auto Includer = mEnvironment.CreateShaderIncluder(Input.FilePath);
 
@@ -376,48 +643,52 @@ bool VK_NAMESPACE::ShaderCompiler::ReadAndPreprocess(CompileResult& Result, cons
 	if(Result.Error.Type == ErrorType::eNone)
 		Result.Error.SrcCode = Base.Contents;
 
+	// recorded even on failure, fixing a broken header has to find the shaders it broke
+	if (IncludeCache)
+		IncludeCache->RecordDependencies(Input.FilePath, Includer->GetIncludedFiles());
+
 	return true;
 }
 
 void VK_NAMESPACE::ShaderCompiler::ResolveIncludeRecursive(CompileResult& Result, IncludeResult& Base,
 	std::shared_ptr<ShaderIncluder> Includer, uint32_t RecursionDepth)
 {
-	Lexer lexer(Base.Contents);
-	lexer.SetWhiteSpacesAndDelimiters(" \t", "#<>\"\n");
+	TokenScanner scanner(Base.Contents, sIncludeTokenClasses);
 
-	Token token = lexer.NextToken();
+	TokenView token = scanner.Next();
 
-	while (token.Value.front() && Result.Error.Type == ErrorType::eNone)
+	// the tokens view Base.Contents, an include rewrites it and moves the scanner onto the new string
+	while (Result.Error.Type == ErrorType::eNone && !token.Value.empty())
 	{
 		if (token.Value == "#")
 		{
-			Token nextToken = lexer.NextToken();
+			TokenView nextToken = scanner.Next();
 
-			if (!nextToken.Value.front())
+			if (nextToken.Value.empty())
 				break;
 
 			if (nextToken.Value == "include")
-				ParseIncludeDirective(Result, lexer, Base, Includer, RecursionDepth, token);
+				ParseIncludeDirective(Result, scanner, Base, Includer, RecursionDepth, token);
 			else
 				token = nextToken;
 		}
 		else
-			token = lexer.NextToken();
+			token = scanner.Next();
 	}
 }
 
-void VK_NAMESPACE::ShaderCompiler::ParseIncludeDirective(CompileResult& Result, Lexer& lexer, IncludeResult& Base,
-	std::shared_ptr<ShaderIncluder> Includer, uint32_t RecursionDepth, Token& token)
+void VK_NAMESPACE::ShaderCompiler::ParseIncludeDirective(CompileResult& Result, TokenScanner& scanner, IncludeResult& Base,
+	std::shared_ptr<ShaderIncluder> Includer, uint32_t RecursionDepth, TokenView& token)
 {
 	std::string lineString = std::to_string(token.LineNumber);
 	std::string charOffset = std::to_string(token.CharOffset);
 
 	size_t index = 0;
-	std::array<Token, 4> tokens;
+	std::array<TokenView, 4> tokens;
 
 	while (index < tokens.size())
 	{
-		tokens[index] = lexer.NextToken();
+		tokens[index] = scanner.Next();
 		if (tokens[index].Value == "\n")
 			break;
 
@@ -431,7 +702,7 @@ void VK_NAMESPACE::ShaderCompiler::ParseIncludeDirective(CompileResult& Result,
 		return;
 	}
 
-	Token HeaderName = tokens[1];
+	std::string HeaderName(tokens[1].Value);
 	std::string IncluderName = Base.HeaderName;
 
 	IncludeResult* Inclusion = nullptr;
@@ -439,9 +710,9 @@ void VK_NAMESPACE::ShaderCompiler::ParseIncludeDirective(CompileResult& Result,
 	includerPath = includerPath.parent_path();
 
 	if (tokens[0].Value == "<" && tokens[2].Value == ">")
-		Inclusion = Includer->IncludeSystem(HeaderName.Value, includerPath.string(), RecursionDepth);
+		Inclusion = Includer->IncludeSystem(HeaderName, includerPath.string(), RecursionDepth);
 	if (tokens[0].Value == "\"" && tokens[2].Value == "\"")
-		Inclusion = Includer->IncludeLocal(HeaderName.Value, includerPath.string(), RecursionDepth);
+		Inclusion = Includer->IncludeLocal(HeaderName, includerPath.string(), RecursionDepth);
 	else
 	{
 		Result.Error.Type = ErrorType::ePreprocess;
@@ -453,7 +724,7 @@ void VK_NAMESPACE::ShaderCompiler::ParseIncludeDirective(CompileResult& Result,
 	{
 		Result.Error.Type = ErrorType::ePreprocess;
 		Result.Error.Info = "Error: line " + lineString + ", " + charOffset + 
-			": Can't open file at " + HeaderName.Value;
+			": Can't open file at " + HeaderName;
 		return;
 	}
 
@@ -465,8 +736,7 @@ void VK_NAMESPACE::ShaderCompiler::ParseIncludeDirective(CompileResult& Result,
 	Base.Contents.erase(InitPos, FinalPos - InitPos);
 	Base.Contents.insert(InitPos, Inclusion->Contents);
 
-	lexer = Lexer(Base.Contents);
-	lexer.SetWhiteSpacesAndDelimiters(" \t", "#<>\"\n");
+	scanner = TokenScanner(Base.Contents, sIncludeTokenClasses);
 
 	size_t CursorPos = InitPos + Inclusion->Contents.size();
 
@@ -475,8 +745,32 @@ void VK_NAMESPACE::ShaderCompiler::ParseIncludeDirective(CompileResult& Result,
 	if (Result.Error.Type != ErrorType::eNone)
 		return;
 
-	lexer.SetCursor(CursorPos);
-	token = lexer.NextToken();
+	scanner.SetCursor(CursorPos);
+	token = scanner.Next();
+}
+
+void VK_NAMESPACE::ShaderCompiler::Reflect(CompileResult& Result)
+{
+	auto Cache = mEnvironment.GetReflectionCache();
+
+	if (!Cache)
+		Cache = ReflectionCache::GetDefault();
+
+	auto Key = ReflectionCache::ComputeKey(Result.SPIR_V.ByteCode, Result.SPIR_V.Stage);
+	auto Entry = Cache->Find(Key);
+
+	if (!Entry)
+	{
+		ReflectDescriptorLayouts(Result);
+		ReflectShaderMetaData(Result);
+
+		Cache->Store(Key, { Result.MetaData, Result.LayoutData, Result.SetLayoutBindingsMap });
+		return;
+	}
+
+	Result.MetaData = Entry->MetaData;
+	Result.LayoutData = Entry->LayoutData;
+	Result.SetLayoutBindingsMap = Entry->SetLayoutBindingsMap;
 }
 
 void VK_NAMESPACE::ShaderCompiler::ReflectDescriptorLayouts(CompileResult& Result)
@@ -8,17 +8,10 @@ VK_NAMESPACE::IncludeResult* VK_NAMESPACE::ShaderIncluder::IncludeSystem(
 
 	for (const auto& systemPath : mSystemPaths)
 	{
-		auto AbsolutePath = std::filesystem::canonical(systemPath / Header);
+		auto AbsolutePath = systemPath / Header;
 
 		if (std::filesystem::exists(AbsolutePath))
-		{
-			auto Contents = ReadFile(AbsolutePath.string());
-
-			if (!Contents)
-				return  nullptr;
-
-			return new IncludeResult(headerName, *Contents);
-		}
+			return LoadHeader(headerName, std::filesystem::canonical(AbsolutePath));
 	}
 
 	return nullptr;
@@ -38,14 +31,7 @@ VK_NAMESPACE::IncludeResult* VK_NAMESPACE::ShaderIncluder::IncludeLocal(
 	auto Absolute = ResolveLocalPath(Header, IncludePath);
 
 	if (std::filesystem::exists(Absolute))
-	{
-		auto Contents = ReadFile(Absolute.string());
-
-		if (!Contents)
-			return nullptr;
-
-		return new IncludeResult(headerName, *Contents);
-	}
+		return LoadHeader(headerName, std::filesystem::canonical(Absolute));
 
 	return nullptr;
 }
@@ -71,3 +57,28 @@ std::filesystem::path VK_NAMESPACE::ShaderIncluder::ResolveLocalPath(
 
 	return mShaderDirectory / RelativePath / Header;
 }
+
+VK_NAMESPACE::IncludeResult* VK_NAMESPACE::ShaderIncluder::LoadHeader(
+	const std::string& headerName, const std::filesystem::path& path)
+{
+	if (std::find(mIncludedFiles.begin(), mIncludedFiles.end(), path) == mIncludedFiles.end())
+		mIncludedFiles.push_back(path);
+
+	if (mCache)
+	{
+		auto Contents = mCache->Read(path);
+
+		if (!Contents)
+			return nullptr;
+
+		// the compiler splices nested includes into the result, it gets its own copy
+		return new IncludeResult(headerName, *Contents);
+	}
+
+	auto Contents = ReadFile(path.string());
+
+	if (!Contents)
+		return nullptr;
+
+	return new IncludeResult(headerName, *Contents);
+}
@@ -0,0 +1,264 @@
+#include "Core/vkpch.h"
+#include "ShaderCompiler/ShaderReloader.h"
+#include "ShaderCompiler/ShaderArchive.h"
+
+void VK_NAMESPACE::DirectoryWatcher::Watch(const std::filesystem::path& directory)
+{
+	mDirectories.push_back(IncludeCache::NormalizePath(directory));
+
+	Scan(mFiles);
+}
+
+std::vector<std::filesystem::path> VK_NAMESPACE::DirectoryWatcher::Poll()
+{
+	std::map<std::filesystem::path, std::filesystem::file_time_type> files;
+	Scan(files);
+
+	std::vector<std::filesystem::path> changed;
+
+	for (const auto& [path, writeTime] : files)
+	{
+		auto found = mFiles.find(path);
+
+		if (found == mFiles.end() || found->second != writeTime)
+			changed.push_back(path);
+	}
+
+	for (const auto& [path, writeTime] : mFiles)
+	{
+		if (!files.contains(path))
+			changed.push_back(path);
+	}
+
+	mFiles.swap(files);
+
+	return changed;
+}
+
+void VK_NAMESPACE::DirectoryWatcher::Scan(
+	std::map<std::filesystem::path, std::filesystem::file_time_type>& files) const
+{
+	std::error_code error;
+
+	for (const auto& directory : mDirectories)
+	{
+		auto iterator = std::filesystem::recursive_directory_iterator(directory,
+			std::filesystem::directory_options::skip_permission_denied, error);
+
+		// files come and go while an editor saves, whatever fails now is picked up next poll
+		for (auto end = std::filesystem::recursive_directory_iterator(); iterator != end; iterator.increment(error))
+		{
+			if (error)
+				break;
+
+			if (!iterator->is_regular_file(error))
+				continue;
+
+			auto writeTime = iterator->last_write_time(error);
+
+			if (!error)
+				files[iterator->path()] = writeTime;
+		}
+	}
+}
+
+VK_NAMESPACE::ShaderReloadService::ShaderReloadService(std::shared_ptr<IncludeCache> includes,
+	std::chrono::milliseconds quietPeriod, std::chrono::milliseconds pollInterval)
+	: mIncludes(std::move(includes)),
+	mScheduler(std::chrono::steady_clock(), quietPeriod, [includes = mIncludes](const std::filesystem::path& file)
+		{
+			// resolved per lookup, the default cache may be replaced while the service runs
+			auto cache = includes ? includes : IncludeCache::GetDefault();
+			return cache ? cache->GetDependents(file) : std::vector<std::filesystem::path>();
+		}),
+	mPollInterval(pollInterval)
+{
+	mThread = std::thread([this]() { Run(); });
+}
+
+VK_NAMESPACE::ShaderReloadService::~ShaderReloadService()
+{
+	{
+		std::scoped_lock locker(mLock);
+		mStopRequested = true;
+	}
+
+	mNotifier.notify_one();
+	mThread.join();
+}
+
+void VK_NAMESPACE::ShaderReloadService::Watch(const std::filesystem::path& directory)
+{
+	std::scoped_lock locker(mWatcherLock);
+	mWatcher.Watch(directory);
+}
+
+uint64_t VK_NAMESPACE::ShaderReloadService::Register(ShaderReloadTarget target)
+{
+	uint64_t id = mScheduler.Register(target.Sources);
+
+	auto slot = std::make_shared<TargetSlot>();
+	slot->Target = std::move(target);
+
+	std::scoped_lock locker(mLock);
+	mTargets[id] = std::move(slot);
+
+	return id;
+}
+
+void VK_NAMESPACE::ShaderReloadService::Unregister(uint64_t id)
+{
+	mScheduler.Unregister(id);
+
+	std::shared_ptr<TargetSlot> slot;
+
+	{
+		std::scoped_lock locker(mLock);
+
+		auto found = mTargets.find(id);
+
+		if (found == mTargets.end())
+			return;
+
+		slot = std::move(found->second);
+
+		mTargets.erase(found);
+		std::erase(mRebuilt, id);
+	}
+
+	// the owner may destroy what the functions reference once this returns
+	std::scoped_lock locker(slot->Lock);
+}
+
+size_t VK_NAMESPACE::ShaderReloadService::ApplyPending()
+{
+	std::vector<std::pair<uint64_t, std::shared_ptr<TargetSlot>>> candidates;
+
+	{
+		std::scoped_lock locker(mLock);
+
+		if (mRebuilt.empty())
+			return 0;
+
+		for (uint64_t id : mRebuilt)
+		{
+			auto found = mTargets.find(id);
+
+			if (found != mTargets.end())
+				candidates.emplace_back(id, found->second);
+		}
+
+		mRebuilt.clear();
+	}
+
+	size_t commits = 0;
+	std::vector<uint64_t> deferred;
+
+	for (const auto& [id, slot] : candidates)
+	{
+		// the staging slot is being written by a newer rebuild, that one gets committed instead
+		std::unique_lock locker(slot->Lock, std::try_to_lock);
+
+		if (!locker.owns_lock())
+		{
+			deferred.push_back(id);
+			continue;
+		}
+
+		slot->Target.Commit();
+		commits++;
+	}
+
+	std::scoped_lock locker(mLock);
+
+	mStats.Commits += commits;
+	mStats.Deferred += deferred.size();
+
+	for (uint64_t id : deferred)
+	{
+		if (mTargets.contains(id) && std::ranges::find(mRebuilt, id) == mRebuilt.end())
+			mRebuilt.push_back(id);
+	}
+
+	return commits;
+}
+
+VK_NAMESPACE::ShaderReloadStats VK_NAMESPACE::ShaderReloadService::GetStats() const
+{
+	std::scoped_lock locker(mLock);
+	return mStats;
+}
+
+void VK_NAMESPACE::ShaderReloadService::Run()
+{
+	while (true)
+	{
+		{
+			std::unique_lock locker(mLock);
+
+			if (mNotifier.wait_for(locker, mPollInterval, [this]() { return mStopRequested; }))
+				return;
+		}
+
+		{
+			std::scoped_lock locker(mWatcherLock);
+
+			for (const auto& file : mWatcher.Poll())
+				mScheduler.OnFileChanged(file);
+		}
+
+		auto burst = mScheduler.CollectReady();
+
+		if (!burst)
+			continue;
+
+		{
+			std::scoped_lock locker(mLock);
+			mStats.Bursts++;
+		}
+
+		// the archive was built from the old sources
+		if (auto archive = ShaderArchive::GetDefault())
+		{
+			for (const auto& source : burst->Affected)
+				archive->MarkStale(source);
+		}
+
+		RebuildTargets(burst->Targets);
+	}
+}
+
+void VK_NAMESPACE::ShaderReloadService::RebuildTargets(const std::vector<uint64_t>& ids)
+{
+	for (uint64_t id : ids)
+	{
+		std::shared_ptr<TargetSlot> slot;
+
+		{
+			std::scoped_lock locker(mLock);
+
+			auto found = mTargets.find(id);
+
+			if (found == mTargets.end())
+				continue;
+
+			slot = found->second;
+		}
+
+		bool rebuilt = false;
+
+		{
+			std::scoped_lock locker(slot->Lock);
+			rebuilt = slot->Target.Rebuild();
+		}
+
+		std::scoped_lock locker(mLock);
+
+		mStats.Rebuilds++;
+		mStats.Failures += rebuilt ? 0 : 1;
+
+		// unregistered while it was compiling, or already waiting for a commit
+		if (rebuilt && mTargets.contains(id) && std::ranges::find(mRebuilt, id) == mRebuilt.end())
+			mRebuilt.push_back(id);
+	}
+}